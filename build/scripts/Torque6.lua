@@ -52,6 +52,14 @@ function Torque6()
             "zlib",
         }
 
+        if _OPTIONS["dedicated"] then
+            defines     { "TORQUE_DEDICATED" }
+        end
+
+        if _OPTIONS["journaling"] then
+            defines     { "TORQUE_ALLOW_JOURNALING" }
+        end
+
         configuration { "windows", "x32", "Release" }
             targetdir (BUILD_DIR .. "/windows.x32.release")
 
@@ -1,7 +1,21 @@
+newoption {
+    trigger     = "dedicated",
+    description = "Build a headless dedicated server that never initializes video, GUI, fonts or audio.",
+}
+
+newoption {
+    trigger     = "journaling",
+    description = "Enable journal recording and playback, required by the -perfReplay harness.",
+}
+
 solution "Torque6"
     -- Settings
     BUILD_DIR           = "../bin"
     PROJECT_DIR         = "../" .. _ACTION .. "/"
+    if _OPTIONS["dedicated"] then
+        BUILD_DIR       = "../bin-dedicated"
+        PROJECT_DIR     = "../" .. _ACTION .. "-dedicated/"
+    end
     LIB_DIR             = "../../lib/"
     LIB_PROJECT_DIR     = PROJECT_DIR .. "lib"
     LIB_BUILD_DIR       = PROJECT_DIR .. "lib/bin"
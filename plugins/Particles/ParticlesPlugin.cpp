@@ -48,10 +48,19 @@ void create()
 
 	mem = Torque::bgfx.makeRef(&particleIndices[0], sizeof(uint16_t) * 6, NULL, NULL);
 	Scene::ParticleEmitter::indexBuffer = Torque::bgfx.createIndexBuffer(mem, BGFX_BUFFER_NONE);
+
+   // Simulation shared by every emitter.
+   Scene::ParticleEmitterSystem::smInstance = new Scene::ParticleEmitterSystem();
 }
 
 void destroy()
 {
+   if ( Scene::ParticleEmitterSystem::smInstance != NULL )
+   {
+      delete Scene::ParticleEmitterSystem::smInstance;
+      Scene::ParticleEmitterSystem::smInstance = NULL;
+   }
+
    if ( Scene::ParticleEmitter::vertexBuffer.idx != bgfx::invalidHandle )
       Torque::bgfx.destroyVertexBuffer(Scene::ParticleEmitter::vertexBuffer);
 
@@ -31,6 +31,9 @@
 // Debug Profiling.
 #include "debug/profiler.h"
 
+// Job System
+#include "platform/threads/jobSystem.h"
+
 // bgfx/bx
 #include <bgfx/bgfx.h>
 #include <bx/fpumath.h>
@@ -48,17 +51,25 @@ namespace Scene
    bgfx::VertexBufferHandle ParticleEmitter::vertexBuffer = BGFX_INVALID_HANDLE;
    bgfx::IndexBufferHandle  ParticleEmitter::indexBuffer = BGFX_INVALID_HANDLE;
 
+   ParticleEmitterSystem* ParticleEmitterSystem::smInstance = NULL;
+
    ParticleEmitter::ParticleEmitter()
    {
       mCount = 100;
       mRange = 100;
       mSpeed = 0.1f;
+      mEmitter = ParticleSystem::InvalidEmitter;
 
       mShader.idx = bgfx::invalidHandle;
       mRenderData = NULL;
       mTexture.idx = bgfx::invalidHandle;
    }
 
+   ParticleEmitter::~ParticleEmitter()
+   {
+      onRemoveFromScene();
+   }
+
    void ParticleEmitter::initPersistFields()
    {
       // Call parent.
@@ -71,8 +82,6 @@ namespace Scene
 
    void ParticleEmitter::onAddToScene()
    {  
-      setProcessTicks(true);
-
       // Load Shader
       Graphics::ShaderAsset* particleShaderAsset = Torque::Graphics.getShaderAsset("Particles:particleShader");
       if ( particleShaderAsset )
@@ -86,11 +95,30 @@ namespace Scene
       refresh();
    }
 
+   void ParticleEmitter::onRemoveFromScene()
+   {
+      ParticleEmitterSystem* system = ParticleEmitterSystem::smInstance;
+      if ( system != NULL && mEmitter != ParticleSystem::InvalidEmitter )
+      {
+         system->removeEmitter(this);
+         system->simulation.destroyEmitter(mEmitter);
+      }
+      mEmitter = ParticleSystem::InvalidEmitter;
+
+      if ( mRenderData != NULL )
+      {
+         mRenderData->flags |= Rendering::RenderData::Deleted;
+         mRenderData = NULL;
+      }
+   }
+
    void ParticleEmitter::refresh()
    {
       Parent::refresh();
 
-      if ( mShader.idx == bgfx::invalidHandle ||
+      ParticleEmitterSystem* system = ParticleEmitterSystem::smInstance;
+      if ( system == NULL ||
+           mShader.idx == bgfx::invalidHandle ||
            mTexture.idx == bgfx::invalidHandle ||
            mCount < 1 )
          return;
@@ -103,7 +131,7 @@ namespace Scene
 
       // Render in Forward (for now) with our custom terrain shader.
       mRenderData->shader = mShader;
-      mRenderData->flags = 0 | Rendering::RenderData::Transparent;
+      mRenderData->flags = 0 | Rendering::RenderData::Transparent | Rendering::RenderData::Hidden;
       mRenderData->state = 0
          | BGFX_STATE_RGB_WRITE
          | BGFX_STATE_ALPHA_WRITE
@@ -114,16 +142,20 @@ namespace Scene
       mRenderData->transformTable = &mTransformMatrix[0];
       mRenderData->transformCount = 1;
 
-      // Instances
-      mParticles.clear();
-      mRenderData->instances = &mInstanceData;
-   
-      // Generate 50k particle instances for stress testing.
-      for( S32 n = 0; n < mCount; ++n )
+      // Particles, instance data is written by the emitter system each frame.
+      ParticleSystem::EmitterParams params;
+      params.count = (U32)mCount;
+      params.range = (F32)mRange;
+
+      if ( mEmitter == ParticleSystem::InvalidEmitter )
+      {
+         mEmitter = system->simulation.createEmitter(params);
+         system->addEmitter(this);
+      }
+      else
       {
-         Particle part;
-         emitParticle(&part);
-         mParticles.push_back(part);
+         system->simulation.setEmitterParams(mEmitter, params);
+         system->simulation.resetEmitter(mEmitter);
       }
 
       // Textures
@@ -134,44 +166,75 @@ namespace Scene
       texture->uniform = Torque::Graphics.getTextureUniform(0);
    }
 
-   void ParticleEmitter::interpolateTick( F32 delta )
-   {  
-      //
+   //-----------------------------------------------------------------------------
+
+   ParticleEmitterSystem::ParticleEmitterSystem()
+   {
+      setProcessTicks(true);
+      Torque::Rendering.addRenderHook(this);
    }
 
-   void ParticleEmitter::processTick()
-   {  
-      // 
+   ParticleEmitterSystem::~ParticleEmitterSystem()
+   {
+      Torque::Rendering.removeRenderHook(this);
+   }
+
+   void ParticleEmitterSystem::addEmitter(ParticleEmitter* emitter)
+   {
+      mEmitters.push_back(emitter);
+   }
+
+   void ParticleEmitterSystem::removeEmitter(ParticleEmitter* emitter)
+   {
+      for ( S32 n = 0; n < mEmitters.size(); ++n )
+      {
+         if ( mEmitters[n] != emitter )
+            continue;
+
+         mEmitters.erase_fast(n);
+         return;
+      }
    }
 
-   void ParticleEmitter::advanceTime( F32 timeDelta )
+   void ParticleEmitterSystem::advanceTime( F32 timeDelta )
    {  
-      mInstanceData.clear();
+      simulation.update(timeDelta);
+   }
 
-      //
-      for(S32 n = 0; n < mParticles.size(); ++n)
+   void ParticleEmitterSystem::writeInstancesJob(void* data, U32 first, U32 count)
+   {
+      ParticleEmitterSystem* system = (ParticleEmitterSystem*)data;
+      for ( U32 n = first; n < first + count; ++n )
       {
-         Particle* part = &mParticles[n];
-         part->velocity += Point3F(0.0f, 0.0f, -9.81f) * timeDelta;
-         part->position += part->velocity * timeDelta;
-
-         part->lifetime -= timeDelta;
-         if ( part->lifetime < 0 )
-            emitParticle(part);
-
-         Rendering::InstanceData particle;
-         particle.i_data0.set(part->position.x, part->position.y, part->position.z, 0.0f);
-         particle.i_data1.set(part->color.red, part->color.green, part->color.blue, mClampF(part->lifetime, 0.0f, 1.0f));
-         mInstanceData.push_back(particle);
+         Rendering::RenderData* renderData = system->mEmitters[n]->getRenderData();
+         if ( renderData->instanceBuffer != NULL )
+            system->simulation.writeInstances(system->mEmitters[n]->getEmitter(), renderData->instanceBuffer->data);
       }
    }
 
-   void ParticleEmitter::emitParticle(Particle* part)
+   void ParticleEmitterSystem::beginFrame()
    {
-      F32 range = (F32)mRange;
-      part->position.set(mRandF(-range, range), mRandF(-range, range), mRandF(-range, range));
-      part->velocity.set(mRandF(-5.0f, 5.0f), mRandF(-5.0f, 5.0f), mRandF(0.0f, 10.0f));
-      part->color.set(mRandF(0.0f, 1.0f), mRandF(0.0f, 1.0f), mRandF(0.0f, 1.0f), 1.0f);
-      part->lifetime = mRandF(1.0f, 10.0f);
+      PROFILE_SCOPE(ParticleEmitterSystem_BeginFrame);
+
+      // Transient buffers are only valid for this frame and have to be
+      // allocated here on the main thread, filling them can be split up.
+      for ( S32 n = 0; n < mEmitters.size(); ++n )
+      {
+         Rendering::RenderData* renderData = mEmitters[n]->getRenderData();
+         const U32 count = simulation.getParticleCount(mEmitters[n]->getEmitter());
+
+         renderData->instanceBuffer = NULL;
+         if ( count > 0 && Torque::bgfx.checkAvailInstanceDataBuffer(count, ParticleSystem::InstanceStride) )
+         {
+            renderData->instanceBuffer = Torque::bgfx.allocInstanceDataBuffer(count, ParticleSystem::InstanceStride);
+            renderData->flags &= ~Rendering::RenderData::Hidden;
+         }
+         else
+            renderData->flags |= Rendering::RenderData::Hidden;
+      }
+
+      JobCounter counter;
+      JobSystem::parallelFor(mEmitters.size(), ParticleSystem::EmitterGrain, &writeInstancesJob, this, &counter);
+      JobSystem::wait(counter);
    }
 }
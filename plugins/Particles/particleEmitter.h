@@ -39,17 +39,13 @@
 #include "platform/Tickable.h"
 #endif
 
+#ifndef _PARTICLE_SYSTEM_H_
+#include <graphics/particleSystem.h>
+#endif
+
 namespace Scene 
 {
-   struct Particle
-   {
-      Point3F velocity;
-      Point3F position;
-      ColorF  color;
-      F32     lifetime;
-   };
-
-   class ParticleEmitter : public BaseComponent, public virtual Tickable
+   class ParticleEmitter : public BaseComponent
    {
       private:
          typedef BaseComponent Parent;
@@ -58,33 +54,59 @@ namespace Scene
          S32                              mRange;
          F32                              mSpeed;
 
-         Vector<Particle>                 mParticles;
+         S32                              mEmitter;
 
          bgfx::ProgramHandle              mShader;
          Rendering::RenderData*           mRenderData;
          bgfx::TextureHandle              mTexture;
-         Vector<Rendering::InstanceData>  mInstanceData;
          Vector<Rendering::TextureData>   mTextureData;
 
-      protected:
-         virtual void interpolateTick( F32 delta );
-         virtual void processTick();
-         virtual void advanceTime( F32 timeDelta );
-
       public:
          ParticleEmitter();
+         ~ParticleEmitter();
 
          static bgfx::VertexBufferHandle  vertexBuffer;
          static bgfx::IndexBufferHandle   indexBuffer;
 
-         void emitParticle(Particle* part);
          void onAddToScene();
+         void onRemoveFromScene();
          void refresh();
 
+         S32  getEmitter() { return mEmitter; }
+         Rendering::RenderData* getRenderData() { return mRenderData; }
+
          static void initPersistFields();
 
          DECLARE_PLUGIN_CONOBJECT(ParticleEmitter);
    };
+
+   // Simulation shared by every emitter. All emitters are stepped together
+   // once per frame, split across the job system, and each frame their
+   // particles are written straight into transient instance buffers.
+   class ParticleEmitterSystem : public Rendering::RenderHook, public virtual Tickable
+   {
+      protected:
+         Vector<ParticleEmitter*>         mEmitters;
+
+         static void writeInstancesJob(void* data, U32 first, U32 count);
+
+         virtual void interpolateTick( F32 delta ) { }
+         virtual void processTick() { }
+         virtual void advanceTime( F32 timeDelta );
+
+      public:
+         ParticleSystem                   simulation;
+
+         ParticleEmitterSystem();
+         ~ParticleEmitterSystem();
+
+         void addEmitter(ParticleEmitter* emitter);
+         void removeEmitter(ParticleEmitter* emitter);
+
+         virtual void beginFrame();
+
+         static ParticleEmitterSystem* smInstance;
+   };
 }
 
 #endif // _PARTICLE_EMITTER_H_
\ No newline at end of file
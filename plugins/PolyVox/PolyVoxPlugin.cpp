@@ -24,167 +24,216 @@
 #include <plugins/plugins_shared.h>
 
 #include <sim/simObject.h>
-#include <3d/rendering/common.h>
+#include <rendering/rendering.h>
+#include "rendering/renderCamera.h"
 #include <graphics/core.h>
-
-#include "PolyVoxCore/CubicSurfaceExtractorWithNormals.h"
-#include "PolyVoxCore/MarchingCubesSurfaceExtractor.h"
-#include "PolyVoxCore/SurfaceMesh.h"
-#include "PolyVoxCore/SimpleVolume.h"
+#include <graphics/utilities.h>
 
 #include <bx/fpumath.h>
 
-using namespace Plugins;
+// Debug Profiling.
+#include "debug/profiler.h"
 
-// Test PolyVox
-PolyVox::SimpleVolume<U8> volData(PolyVox::Region(PolyVox::Vector3DInt32(0, 0, 0), PolyVox::Vector3DInt32(63, 63, 63)));
+VoxelTerrainPager*   sPager   = NULL;
+VoxelTerrain*        sTerrain = NULL;
 
-PosUVNormalVertex*         mVerts = NULL;
-U32                        mVertCount = 0;
-U32*                       mIndices = NULL;
-U32                        mIndexCount = 0;
-F32                        mTransformMtx[16];
-bgfx::VertexBufferHandle   mVB = BGFX_INVALID_HANDLE;
-bgfx::IndexBufferHandle    mIB = BGFX_INVALID_HANDLE;
-Rendering::RenderData*     mRenderData = NULL;
-bgfx::ProgramHandle        mShader = BGFX_INVALID_HANDLE;
+//-----------------------------------------------------------------------------
+// VoxelTerrainPager
+//-----------------------------------------------------------------------------
 
-void createSphereInVolume(PolyVox::SimpleVolume<U8>& volData, float fRadius)
+VoxelTerrainPager::VoxelTerrainPager()
+   : sphereCenter(32, 32, 32),
+     sphereRadius(30)
 {
-   //This vector hold the position of the center of the volume
-   PolyVox::Vector3DFloat v3dVolCenter(volData.getWidth() / 2, volData.getHeight() / 2, volData.getDepth() / 2);
 
-   //This three-level for loop iterates over every voxel in the volume
-   for (int z = 0; z < volData.getDepth(); z++)
+}
+
+bool VoxelTerrainPager::generate(const Point3I& chunk, U8* voxels)
+{
+   Point3I origin(chunk.x * VoxelWorld::ChunkSize, chunk.y * VoxelWorld::ChunkSize, chunk.z * VoxelWorld::ChunkSize);
+
+   // Skip chunks the sphere doesn't reach.
+   Point3I lo = origin - sphereCenter;
+   Point3I hi = lo + Point3I(VoxelWorld::ChunkMask, VoxelWorld::ChunkMask, VoxelWorld::ChunkMask);
+   S32 dx = getMax(getMax(lo.x, -hi.x), 0);
+   S32 dy = getMax(getMax(lo.y, -hi.y), 0);
+   S32 dz = getMax(getMax(lo.z, -hi.z), 0);
+   if ( dx * dx + dy * dy + dz * dz > sphereRadius * sphereRadius )
+      return false;
+
+   U32 index = 0;
+   for ( S32 z = 0; z < VoxelWorld::ChunkSize; ++z )
    {
-      for (int y = 0; y < volData.getHeight(); y++)
+      for ( S32 y = 0; y < VoxelWorld::ChunkSize; ++y )
       {
-         for (int x = 0; x < volData.getWidth(); x++)
+         for ( S32 x = 0; x < VoxelWorld::ChunkSize; ++x, ++index )
          {
-            //Store our current position as a vector...
-            PolyVox::Vector3DFloat v3dCurrentPos(x, y, z);
-            //And compute how far the current position is from the center of the volume
-            float fDistToCenter = (v3dCurrentPos - v3dVolCenter).length();
-
-            uint8_t uVoxelValue = 0;
-
-            //If the current voxel is less than 'radius' units from the center then we make it solid.
-            if (fDistToCenter <= fRadius)
-            {
-               //Our new voxel value
-               uVoxelValue = 255;
-            }
-
-            //Wrte the voxel value into the volume
-            volData.setVoxelAt(x, y, z, uVoxelValue);
+            Point3I offset = origin + Point3I(x, y, z) - sphereCenter;
+            voxels[index] = (offset.x * offset.x + offset.y * offset.y + offset.z * offset.z) <= sphereRadius * sphereRadius ? 255 : 0;
          }
       }
    }
+
+   return true;
 }
 
-void refreshVertexBuffer()
-{
-   if (mVertCount <= 0) return;
+//-----------------------------------------------------------------------------
+// VoxelTerrain
+//-----------------------------------------------------------------------------
 
-   if (mVB.idx != bgfx::invalidHandle)
-      Link.bgfx.destroyVertexBuffer(mVB);
+VoxelTerrain::VoxelTerrain(VoxelTerrainPager* pager)
+   : VoxelWorld(pager)
+{
+   scale          = 10.0f;
+   loadRadius     = 256.0f;
+   unloadRadius   = 320.0f;
+   meshRadius     = 256.0f;
+   maxLoads       = 16;
+   maxJobs        = 2 * (JobSystem::getWorkerCount() + 1);
+
+   mShader.idx = bgfx::invalidHandle;
+   Graphics::ShaderAsset* shaderAsset = Torque::Graphics.getShaderAsset("PolyVox:renderShader");
+   if ( shaderAsset )
+      mShader = shaderAsset->getProgram();
 
-   const bgfx::Memory* mem;
-   mem = Link.bgfx.makeRef(&mVerts[0], sizeof(PosUVNormalVertex) * mVertCount, NULL, NULL);
-   mVB = Link.bgfx.createVertexBuffer(mem, *Link.Graphics.PosUVNormalVertex, BGFX_BUFFER_NONE);
+   setProcessTicks(true);
+   Torque::Rendering.addRenderHook(this);
 }
 
-void refreshIndexBuffer()
+VoxelTerrain::~VoxelTerrain()
 {
-   if (mIndexCount <= 0) return;
-
-   if (mIB.idx != bgfx::invalidHandle)
-      Link.bgfx.destroyIndexBuffer(mIB);
+   Torque::Rendering.removeRenderHook(this);
 
-   const bgfx::Memory* mem;
-   mem = Link.bgfx.makeRef(&mIndices[0], sizeof(U32) * mIndexCount, NULL, NULL);
-   mIB = Link.bgfx.createIndexBuffer(mem, BGFX_BUFFER_INDEX32);
+   waitForMeshes();
+   for ( U32 n = 0; n < getChunkCount(); ++n )
+      releaseChunk(getChunk(n));
 }
 
-void refresh()
+void VoxelTerrain::advanceTime( F32 timeDelta )
 {
-   refreshVertexBuffer();
-   refreshIndexBuffer();
+   PROFILE_SCOPE(VoxelTerrain_AdvanceTime);
 
-   if (mRenderData == NULL)
-      mRenderData = Link.Rendering.createRenderData();
+   Rendering::RenderCamera* camera = Torque::Rendering.getPriorityRenderCamera();
+   if ( camera == NULL )
+      return;
 
-   mRenderData->indexBuffer = mIB;
-   mRenderData->vertexBuffer = mVB;
+   Point3F focus = camera->position / scale;
+   updateStreaming(focus, loadRadius, unloadRadius, maxLoads);
+   updateMeshes(focus, meshRadius, maxJobs);
+}
 
-   // Render in Deferred
-   mRenderData->shader = mShader;
-   mRenderData->view = Link.Graphics.getView("DeferredGeometry", 1000);
-   mRenderData->state = 0
-                        | BGFX_STATE_RGB_WRITE
-                        | BGFX_STATE_ALPHA_WRITE
-                        | BGFX_STATE_DEPTH_TEST_LESS
-                        | BGFX_STATE_DEPTH_WRITE
-                        | BGFX_STATE_CULL_CCW
-                        | BGFX_STATE_MSAA;
-
-   // Transform
-   bx::mtxSRT(mTransformMtx, 10, 10, 10, 0, 0, 0, 0, 0, 0);
-   mRenderData->transformTable = mTransformMtx;
-   mRenderData->transformCount = 1;
+void VoxelTerrain::beginFrame()
+{
+   // Buffers are created on the main thread as meshes come back.
+   processMeshes();
 }
 
-// Called when the plugin is loaded.
-void create()
+void VoxelTerrain::releaseChunk(Chunk* chunk)
 {
-   // Load Shader
-   Graphics::ShaderAsset* shaderAsset = Link.Graphics.getShaderAsset("PolyVox:renderShader");
-   if (shaderAsset)
-      mShader = shaderAsset->getProgram();
+   ChunkRender* render = (ChunkRender*)chunk->userData;
+   if ( render == NULL )
+      return;
+
+   if ( render->vb.idx != bgfx::invalidHandle )
+      Torque::bgfx.destroyVertexBuffer(render->vb);
+   if ( render->ib.idx != bgfx::invalidHandle )
+      Torque::bgfx.destroyIndexBuffer(render->ib);
+   render->renderData->flags |= Rendering::RenderData::Deleted;
+
+   delete render;
+   chunk->userData = NULL;
+}
 
-   // Generate polyvox sphere.
-   createSphereInVolume(volData, 30);
-   PolyVox::SurfaceMesh<PolyVox::PositionMaterialNormal> surfaceMesh;
-   PolyVox::CubicSurfaceExtractorWithNormals< PolyVox::SimpleVolume<U8> > surfaceExtractor(&volData, volData.getEnclosingRegion(), &surfaceMesh);
-   surfaceExtractor.execute();
+void VoxelTerrain::onChunkUnloaded(Chunk* chunk)
+{
+   releaseChunk(chunk);
+}
 
-   // Verts
-   const std::vector<PolyVox::PositionMaterialNormal>& vecVertices = surfaceMesh.getVertices();
-   mVerts = new PosUVNormalVertex[vecVertices.size()];
-   for (U32 i = 0; i < vecVertices.size(); ++i)
+void VoxelTerrain::onChunkMeshed(Chunk* chunk, const VoxelMesh& mesh)
+{
+   ChunkRender* render = (ChunkRender*)chunk->userData;
+   if ( render == NULL )
    {
-      mVerts[mVertCount].m_x = vecVertices[i].position.getX();
-      mVerts[mVertCount].m_y = vecVertices[i].position.getY();
-      mVerts[mVertCount].m_z = vecVertices[i].position.getZ();
-
-      mVerts[mVertCount].m_u = 0.0f;
-      mVerts[mVertCount].m_v = 0.0f;
-
-      mVerts[mVertCount].m_normal_x = vecVertices[i].normal.getX();
-      mVerts[mVertCount].m_normal_y = vecVertices[i].normal.getY();
-      mVerts[mVertCount].m_normal_z = vecVertices[i].normal.getZ();
-      mVertCount++;
+      if ( mesh.indices.size() == 0 )
+         return;
+
+      render = new ChunkRender();
+      render->vb.idx = bgfx::invalidHandle;
+      render->ib.idx = bgfx::invalidHandle;
+      render->renderData = Torque::Rendering.createRenderData();
+      chunk->userData = render;
    }
 
-   // Indices
-   const std::vector<U32>& vecIndices = surfaceMesh.getIndices();
-   mIndices = new U32[vecIndices.size()];
-   for (U32 i = 0; i < vecIndices.size(); ++i)
+   if ( render->vb.idx != bgfx::invalidHandle )
+      Torque::bgfx.destroyVertexBuffer(render->vb);
+   if ( render->ib.idx != bgfx::invalidHandle )
+      Torque::bgfx.destroyIndexBuffer(render->ib);
+   render->vb.idx = bgfx::invalidHandle;
+   render->ib.idx = bgfx::invalidHandle;
+
+   Rendering::RenderData* renderData = render->renderData;
+   if ( mesh.indices.size() == 0 )
    {
-      mIndices[mIndexCount] = vecIndices[mIndexCount];
-      mIndexCount++;
+      renderData->flags |= Rendering::RenderData::Hidden;
+      return;
    }
 
-   refresh();
+   // The mesh is reused by the next job, so it's copied.
+   const bgfx::Memory* mem;
+   mem = Torque::bgfx.copy(mesh.verts.address(), sizeof(Graphics::PosUVNormalVertex) * mesh.verts.size());
+   render->vb = Torque::bgfx.createVertexBuffer(mem, *Torque::Graphics.PosUVNormalVertex, BGFX_BUFFER_NONE);
+
+   mem = Torque::bgfx.copy(mesh.indices.address(), sizeof(U32) * mesh.indices.size());
+   render->ib = Torque::bgfx.createIndexBuffer(mem, BGFX_BUFFER_INDEX32);
+
+   renderData->flags &= ~Rendering::RenderData::Hidden;
+   renderData->flags |= Rendering::RenderData::HasBounds;
+   renderData->vertexBuffer = render->vb;
+   renderData->indexBuffer = render->ib;
+
+   // Render in Deferred
+   renderData->shader = mShader;
+   renderData->state = 0
+                     | BGFX_STATE_RGB_WRITE
+                     | BGFX_STATE_ALPHA_WRITE
+                     | BGFX_STATE_DEPTH_TEST_LESS
+                     | BGFX_STATE_DEPTH_WRITE
+                     | BGFX_STATE_CULL_CCW
+                     | BGFX_STATE_MSAA;
+
+   // Transform, the mesh is in chunk space.
+   Point3F origin(chunk->coord.x * (F32)ChunkSize, chunk->coord.y * (F32)ChunkSize, chunk->coord.z * (F32)ChunkSize);
+   origin *= scale;
+   bx::mtxSRT(render->transformMtx, scale, scale, scale, 0.0f, 0.0f, 0.0f, origin.x, origin.y, origin.z);
+   renderData->transformTable = render->transformMtx;
+   renderData->transformCount = 1;
+
+   // Bounds
+   Box3F box(origin, origin + Point3F(ChunkSize * scale, ChunkSize * scale, ChunkSize * scale));
+   renderData->boundingBox = box;
+   renderData->boundingSphere = box.getBoundingSphere();
 }
 
-void destroy()
+//-----------------------------------------------------------------------------
+
+// Called when the plugin is loaded.
+void create()
 {
-   
+   sPager = new VoxelTerrainPager();
+   sTerrain = new VoxelTerrain(sPager);
 }
 
-// Per-Frame render function
-void render()
+void destroy()
 {
+   if ( sTerrain != NULL )
+   {
+      delete sTerrain;
+      sTerrain = NULL;
+   }
 
+   if ( sPager != NULL )
+   {
+      delete sPager;
+      sPager = NULL;
+   }
 }
@@ -20,6 +20,9 @@
 // IN THE SOFTWARE.
 //-----------------------------------------------------------------------------
 
+#ifndef _POLYVOX_PLUGIN_H_
+#define _POLYVOX_PLUGIN_H_
+
 #ifndef _PLUGINS_SHARED_H
 #include <plugins/plugins_shared.h>
 #endif
@@ -28,18 +31,65 @@
 #include <sim/simObject.h>
 #endif
 
-struct PosUVNormalVertex
+#ifndef _TICKABLE_H_
+#include "platform/Tickable.h"
+#endif
+
+#ifndef _VOXEL_WORLD_H_
+#include <graphics/voxelWorld.h>
+#endif
+
+// Generates the demo sphere, edited chunks are kept compressed in memory.
+class VoxelTerrainPager : public VoxelMemoryPager
+{
+   public:
+      Point3I  sphereCenter;
+      S32      sphereRadius;
+
+      VoxelTerrainPager();
+
+      virtual bool generate(const Point3I& chunk, U8* voxels);
+};
+
+// Streams chunks around the camera, meshes them on the job system and keeps
+// a vertex and index buffer per chunk.
+class VoxelTerrain : public VoxelWorld, public Rendering::RenderHook, public virtual Tickable
 {
-   F32 m_x;
-   F32 m_y;
-   F32 m_z;
-   F32 m_u;
-   F32 m_v;
-   F32 m_normal_x;
-   F32 m_normal_y;
-   F32 m_normal_z;
+   protected:
+      struct ChunkRender
+      {
+         bgfx::VertexBufferHandle   vb;
+         bgfx::IndexBufferHandle    ib;
+         Rendering::RenderData*     renderData;
+         F32                        transformMtx[16];
+      };
+
+      bgfx::ProgramHandle  mShader;
+
+      void releaseChunk(Chunk* chunk);
+
+      virtual void onChunkMeshed(Chunk* chunk, const VoxelMesh& mesh);
+      virtual void onChunkUnloaded(Chunk* chunk);
+
+      virtual void interpolateTick( F32 delta ) { }
+      virtual void processTick() { }
+      virtual void advanceTime( F32 timeDelta );
+
+   public:
+      F32   scale;
+      F32   loadRadius;       ///< In voxels.
+      F32   unloadRadius;
+      F32   meshRadius;
+      U32   maxLoads;         ///< Per tick.
+      U32   maxJobs;          ///< In flight.
+
+      VoxelTerrain(VoxelTerrainPager* pager);
+      ~VoxelTerrain();
+
+      virtual void beginFrame();
 };
 
 PLUGIN_FUNC(create)
 PLUGIN_FUNC(destroy)
-PLUGIN_FUNC(render)
\ No newline at end of file
+
+#endif // _POLYVOX_PLUGIN_H_
@@ -26,34 +26,34 @@
 #include <sim/simObject.h>
 #include <rendering/rendering.h>
 #include <graphics/core.h>
+#include <graphics/utilities.h>
 
 #include <bx/fpumath.h>
 
 Vector<TerrainCell> terrainGrid;
 
-TerrainCell::TerrainCell(bgfx::TextureHandle* _megaTexture, Vector<Rendering::UniformData>* _uniformData, S32 _gridX, S32 _gridY)
+TerrainCell::TerrainCell(bgfx::TextureHandle* _megaTexture, bgfx::TextureHandle* _pageTable, bgfx::IndexBufferHandle* _chunkIndexBuffers, Vector<Rendering::UniformData>* _uniformData, S32 _gridX, S32 _gridY)
 {
-   mVerts = NULL;
-   mVertCount = 0;
-   mIndices = NULL;
-   mIndexCount = 0;
-
    dirty = false;
    heightMap = NULL;
    blendMap = NULL;
 
    mMegaTexture = _megaTexture;
+   mPageTable = _pageTable;
+   mChunkIndexBuffers = _chunkIndexBuffers;
    mUniformData = _uniformData;
    gridX = _gridX;
    gridY = _gridY;
 
-   mDynamicVB.idx = bgfx::invalidHandle;
-   mDynamicIB.idx = bgfx::invalidHandle;
-   mVB.idx = bgfx::invalidHandle;
-   mIB.idx = bgfx::invalidHandle;
    mBlendTexture.idx = bgfx::invalidHandle;
 
-   mRenderData = NULL;
+   // Allocated on first rebuild, cells are copied around by value before that.
+   mHeightSource = NULL;
+   mQuadTree = NULL;
+   mBuildJobs = NULL;
+   mFrame = 0;
+   mLODRange = TerrainQuadTree::ChunkSize * 4.0f;
+   mLODMorphRatio = 0.66f;
 
    maxTerrainHeight = 0;
 
@@ -65,67 +65,18 @@ TerrainCell::TerrainCell(bgfx::TextureHandle* _megaTexture, Vector<Rendering::Un
 
 TerrainCell::~TerrainCell()
 {
-   SAFE_DELETE(mVerts);
-   SAFE_DELETE(mIndices);
-   SAFE_DELETE(heightMap);
-   SAFE_DELETE(blendMap);
-
-   if ( mVB.idx != bgfx::invalidHandle )
-      Torque::bgfx.destroyVertexBuffer(mVB);
-
-   if ( mIB.idx != bgfx::invalidHandle )
-      Torque::bgfx.destroyIndexBuffer(mIB);
-
-   if ( mDynamicVB.idx != bgfx::invalidHandle )
-      Torque::bgfx.destroyDynamicVertexBuffer(mDynamicVB);
+   releaseChunks();
 
-   if ( mDynamicIB.idx != bgfx::invalidHandle )
-      Torque::bgfx.destroyDynamicIndexBuffer(mDynamicIB);
+   SAFE_DELETE(mQuadTree);
+   SAFE_DELETE(mHeightSource);
+   SAFE_DELETE(mBuildJobs);
+   SAFE_DELETE_ARRAY(heightMap);
+   SAFE_DELETE_ARRAY(blendMap);
 
    if ( mBlendTexture.idx != bgfx::invalidHandle )
       Torque::bgfx.destroyTexture(mBlendTexture);
 }
 
-void TerrainCell::refreshVertexBuffer()
-{
-   if ( mVertCount <= 0 ) return;
-
-   if ( mVB.idx != bgfx::invalidHandle )
-      Torque::bgfx.destroyVertexBuffer(mVB);
-
-   const bgfx::Memory* mem;
-   mem = Torque::bgfx.makeRef(&mVerts[0], sizeof(PosUVNormalVertex) * mVertCount, NULL, NULL );
-   mVB = Torque::bgfx.createVertexBuffer(mem, *Torque::Graphics.PosUVNormalVertex, BGFX_BUFFER_NONE);
-
-   //const bgfx::Memory* mem;
-   //mem = Torque::bgfx.makeRef(&mVerts[0], sizeof(PosUVColorVertex) * mVerts.size(), NULL, NULL );
-
-   //if ( mDynamicVB.idx == bgfx::invalidHandle )
-   //   mDynamicVB = Torque::bgfx.createDynamicVertexBuffer(mem, *Torque::Graphics.PosUVColorVertex, BGFX_BUFFER_NONE);
-   //else
-   //   Torque::bgfx.updateDynamicVertexBuffer(mDynamicVB, mem);
-}
-
-void TerrainCell::refreshIndexBuffer()
-{
-   if ( mIndexCount <= 0 ) return;
-
-   if ( mIB.idx != bgfx::invalidHandle )
-      Torque::bgfx.destroyIndexBuffer(mIB);
-
-   const bgfx::Memory* mem;
-	mem = Torque::bgfx.makeRef(&mIndices[0], sizeof(U32) * mIndexCount, NULL, NULL );
-   mIB = Torque::bgfx.createIndexBuffer(mem, BGFX_BUFFER_INDEX32);
-
-   //const bgfx::Memory* mem;
-	//mem = Torque::bgfx.makeRef(&mIndices[0], sizeof(uint16_t) * mIndices.size(), NULL, NULL );
-
-   //if ( mDynamicIB.idx == bgfx::invalidHandle )
-   //   mDynamicIB = Torque::bgfx.createDynamicIndexBuffer(mem, BGFX_BUFFER_NONE);
-   //else
-   //   Torque::bgfx.updateDynamicIndexBuffer(mDynamicIB, mem);
-}
-
 void TerrainCell::refreshBlendMap()
 {
    const bgfx::Memory* mem;
@@ -142,6 +93,10 @@ void TerrainCell::refreshBlendMap()
 
 void TerrainCell::loadEmptyTerrain(S32 _width, S32 _height)
 {
+   waitForBuilds();
+   SAFE_DELETE_ARRAY(heightMap);
+   SAFE_DELETE_ARRAY(blendMap);
+
    height = _height;
    width = _width;
    heightMap = new F32[height * width];
@@ -155,6 +110,10 @@ void TerrainCell::loadHeightMap(const char* path)
    GBitmap *bmp = dynamic_cast<GBitmap*>(Torque::ResourceManager->loadInstance(path));  
    if(bmp != NULL)
    {
+      waitForBuilds();
+      SAFE_DELETE_ARRAY(heightMap);
+      SAFE_DELETE_ARRAY(blendMap);
+
       height = (bmp->getHeight() / 2) * 2;
       width = (bmp->getWidth() / 2) * 2;
       heightMap = new F32[height * width];
@@ -222,78 +181,279 @@ void TerrainCell::rebuild()
 {
    dirty = true;
 
-   SAFE_DELETE_ARRAY(mVerts);
-   SAFE_DELETE_ARRAY(mIndices);
+   if ( heightMap == NULL )
+      return;
 
-   mVertCount = 0;
-   mVerts = new PosUVNormalVertex[width * height];
-   for(U32 y = 0; y < height; y++ )
+   if ( mQuadTree == NULL )
    {
-      for(U32 x = 0; x < width; x++ )
+      mHeightSource = new TerrainHeightMap();
+      mQuadTree = new TerrainQuadTree();
+      mBuildJobs = new JobCounter();
+   }
+
+   // The chunk table is indexed by node so it's only valid for one layout.
+   waitForBuilds();
+   releaseChunks();
+
+   mHeightSource->mHeights = heightMap;
+   mHeightSource->mWidth = width;
+   mQuadTree->setRanges(mLODRange, mLODMorphRatio);
+   mQuadTree->build(mHeightSource, width, height);
+
+   mChunks.setSize(mQuadTree->getNodeCount());
+   dMemset(mChunks.address(), 0, mChunks.size() * sizeof(TerrainChunk*));
+
+   refreshBlendMap();
+}
+
+void TerrainCell::waitForBuilds()
+{
+   if ( mBuildJobs != NULL )
+      JobSystem::wait(*mBuildJobs);
+
+   uploadBuiltChunks();
+}
+
+void TerrainCell::updateHeights(U32 x, U32 y, U32 _width, U32 _height)
+{
+   if ( mQuadTree == NULL )
+      return;
+
+   dirty = true;
+   mQuadTree->updateHeights(x, y, _width, _height);
+
+   // Visible chunks rebuild in the background on their next updateLOD(), the
+   // others whenever they're selected again.
+   for ( S32 n = 0; n < mChunks.size(); ++n )
+   {
+      TerrainChunk* chunk = mChunks[n];
+      if ( chunk != NULL && mQuadTree->isChunkAffected(chunk->x, chunk->y, chunk->level, x, y, _width, _height) )
+         chunk->stale = true;
+   }
+}
+
+void TerrainCell::setLODRanges(F32 range, F32 morphRatio)
+{
+   mLODRange = range;
+   mLODMorphRatio = morphRatio;
+
+   if ( mQuadTree != NULL )
+      mQuadTree->setRanges(mLODRange, mLODMorphRatio);
+}
+
+Point3F TerrainCell::getOffset()
+{
+   return Point3F((F32)(gridX * width - (1 * gridX)), (F32)(gridY * height - (1 * gridY)), 0.0f);
+}
+
+void TerrainCell::updateLOD(const Point3F& cameraPosition)
+{
+   if ( mQuadTree == NULL || mQuadTree->isEmpty() )
+      return;
+
+   mFrame++;
+   uploadBuiltChunks();
+   mQuadTree->select(cameraPosition - getOffset(), mSelection);
+
+   // Hide last frame's chunks, the ones still selected are shown again below.
+   for ( S32 n = 0; n < mVisibleChunks.size(); ++n )
+      mVisibleChunks[n]->renderData->flags |= Rendering::RenderData::Hidden;
+   mVisibleChunks.clear();
+
+   bool missingChunks = false;
+   for ( S32 n = 0; n < mSelection.size(); ++n )
+   {
+      const TerrainQuadTree::SelectedNode& node = mSelection[n];
+
+      TerrainChunk* chunk = mChunks[node.index];
+      if ( chunk == NULL )
       {
-         mVerts[mVertCount].m_x = (F32)x;
-         mVerts[mVertCount].m_y = (F32)y;
-         mVerts[mVertCount].m_z = heightMap[(y * width) + x];
-         mVerts[mVertCount].m_u = (F32)x / (F32)width;
-         mVerts[mVertCount].m_v = (F32)y / (F32)height;
-
-         Point3F normal = getNormal(x, y);
-         mVerts[mVertCount].m_normal_x = normal.x;
-         mVerts[mVertCount].m_normal_y = normal.y;
-         mVerts[mVertCount].m_normal_z = normal.z;
-         mVertCount++;
+         chunk = createChunk(node);
+         mChunks[node.index] = chunk;
       }
+
+      if ( chunk->vb.idx == bgfx::invalidHandle )
+      {
+         if ( !chunk->building )
+            buildChunk(chunk);
+         missingChunks = true;
+      }
+      else if ( chunk->stale && !chunk->building )
+         buildChunk(chunk);
+
+      chunk->lastUsedFrame = mFrame;
+      chunk->renderData->indexBuffer = mChunkIndexBuffers[node.quadrants];
+      mVisibleChunks.push_back(chunk);
+   }
+
+   // Chunks that have never been built are needed right now, help the workers
+   // with them. Rebuilds after edits don't wait, the old mesh is drawn meanwhile.
+   if ( missingChunks )
+      waitForBuilds();
+
+   for ( S32 n = 0; n < mVisibleChunks.size(); ++n )
+   {
+      if ( mVisibleChunks[n]->vb.idx != bgfx::invalidHandle )
+         mVisibleChunks[n]->renderData->flags &= ~Rendering::RenderData::Hidden;
    }
 
-   mIndexCount = 0;
-   mIndices = new U32[width * height * 6];
-   for(U32 y = 0; y < (height - 1); y++ )
+   // Release chunks that haven't been drawn for a while.
+   if ( (mFrame % 60) == 0 )
    {
-      U32 y_offset = (y * width);
-      for(U32 x = 0; x < (width - 1); x++ )
+      for ( S32 n = 0; n < mChunks.size(); ++n )
       {
-         mIndices[mIndexCount] = y_offset + x;
-         mIndices[mIndexCount + 1] = y_offset + x + width; 
-         mIndices[mIndexCount + 2] = y_offset + x + 1;
-         mIndices[mIndexCount + 3] = y_offset + x + 1;
-         mIndices[mIndexCount + 4] = y_offset + x + width; 
-         mIndices[mIndexCount + 5] = y_offset + x + width + 1;
-         mIndexCount += 6;
+         TerrainChunk* chunk = mChunks[n];
+         if ( chunk == NULL || chunk->building || (mFrame - chunk->lastUsedFrame) < ChunkLifetime )
+            continue;
+
+         destroyChunk(chunk);
+         mChunks[n] = NULL;
       }
    }
+}
 
-   refreshVertexBuffer();
-   refreshIndexBuffer();
-   refreshBlendMap();
-   refresh();
+TerrainChunk* TerrainCell::createChunk(const TerrainQuadTree::SelectedNode& node)
+{
+   TerrainChunk* chunk = new TerrainChunk();
+   chunk->tree = mQuadTree;
+   chunk->built = 0;
+   chunk->x = node.x;
+   chunk->y = node.y;
+   chunk->level = node.level;
+   chunk->verts = NULL;
+   chunk->vb.idx = bgfx::invalidHandle;
+   chunk->building = false;
+   chunk->stale = false;
+   chunk->lastUsedFrame = mFrame;
+
+   chunk->renderData = Torque::Rendering.createRenderData();
+   refreshChunk(chunk);
+   return chunk;
 }
 
-void TerrainCell::refresh()
+void TerrainCell::refreshChunk(TerrainChunk* chunk)
 {
-   if ( mRenderData == NULL )
-      mRenderData = Torque::Rendering.createRenderData();
+   Rendering::RenderData* renderData = chunk->renderData;
+   renderData->flags |= Rendering::RenderData::HasBounds;
+   if ( chunk->vb.idx == bgfx::invalidHandle )
+      renderData->flags |= Rendering::RenderData::Hidden;
+
+   renderData->vertexBuffer = chunk->vb;
 
-   //mRenderData->isDynamic = true;
-   //mRenderData->dynamicIndexBuffer = mDynamicIB;
-   //mRenderData->dynamicVertexBuffer = mDynamicVB;
-   mRenderData->indexBuffer = mIB;
-   mRenderData->vertexBuffer = mVB;
+   chunk->textureData.clear();
+   renderData->textures = &chunk->textureData;
 
-   mTextureData.clear();
-   mRenderData->textures = &mTextureData;
+   // Textures are inserted at the front: megatexture, page table.
+   Rendering::TextureData* pageTable = renderData->addTexture();
+   pageTable->uniform = Torque::Graphics.getTextureUniform(1);
+   pageTable->handle = *mPageTable;
 
-   Rendering::TextureData* layer = mRenderData->addTexture();
-   layer->uniform = Torque::Graphics.getTextureUniform(0);
-   layer->handle = *mMegaTexture;
+   Rendering::TextureData* megaTexture = renderData->addTexture();
+   megaTexture->uniform = Torque::Graphics.getTextureUniform(0);
+   megaTexture->handle = *mMegaTexture;
 
    // Render in Deferred
-   mRenderData->shader = mShader;
-   mRenderData->uniforms.uniforms = mUniformData;
+   renderData->shader = mShader;
+   renderData->uniforms.uniforms = mUniformData;
 
    // Transform
-   bx::mtxSRT(mTransformMtx, 1.0f, 1.0f, 1.0f, 0.0f, 0.0f, 0.0f, (F32)(gridX * width - (1 * gridX)), (F32)(gridY * height - (1 * gridY)), 0.0f);
-   mRenderData->transformTable = mTransformMtx;
-   mRenderData->transformCount = 1;
+   Point3F offset = getOffset();
+   bx::mtxSRT(chunk->transformMtx, 1.0f, 1.0f, 1.0f, 0.0f, 0.0f, 0.0f, offset.x, offset.y, offset.z);
+   renderData->transformTable = chunk->transformMtx;
+   renderData->transformCount = 1;
+
+   // Bounds
+   Box3F box = mQuadTree->getChunkBox(chunk->x, chunk->y, chunk->level);
+   box.minExtents += offset;
+   box.maxExtents += offset;
+   renderData->boundingBox = box;
+   renderData->boundingSphere = box.getBoundingSphere();
+}
+
+void TerrainCell::buildChunk(TerrainChunk* chunk)
+{
+   chunk->building = true;
+   chunk->built = 0;
+   chunk->stale = false;
+   mBuildingChunks.push_back(chunk);
+
+   // Bounds may have changed with the heights.
+   refreshChunk(chunk);
+
+   JobSystem::submit(buildChunkJob, chunk, mBuildJobs);
+}
+
+void TerrainCell::buildChunkJob(void* data, U32 first, U32 count)
+{
+   TerrainChunk* chunk = (TerrainChunk*)data;
+
+   chunk->verts = new Graphics::PosUVNormalMorphVertex[TerrainQuadTree::ChunkVertexCount];
+   chunk->tree->buildChunk(chunk->x, chunk->y, chunk->level, chunk->verts);
+
+   // bgfx calls are only made from the main thread, it uploads the chunk on
+   // its next updateLOD() or waitForBuilds().
+   JobSystem::atomicAdd(&chunk->built, 1);
+}
+
+void TerrainCell::uploadChunk(TerrainChunk* chunk)
+{
+   if ( chunk->vb.idx != bgfx::invalidHandle )
+      Torque::bgfx.destroyVertexBuffer(chunk->vb);
+
+   const bgfx::Memory* mem = Torque::bgfx.copy(chunk->verts, sizeof(Graphics::PosUVNormalMorphVertex) * TerrainQuadTree::ChunkVertexCount);
+   chunk->vb = Torque::bgfx.createVertexBuffer(mem, *Torque::Graphics.PosUVNormalMorphVertex, BGFX_BUFFER_NONE);
+   chunk->renderData->vertexBuffer = chunk->vb;
+
+   SAFE_DELETE_ARRAY(chunk->verts);
+   chunk->building = false;
+}
+
+void TerrainCell::uploadBuiltChunks()
+{
+   for ( S32 n = 0; n < mBuildingChunks.size(); ++n )
+   {
+      TerrainChunk* chunk = mBuildingChunks[n];
+      if ( JobSystem::atomicAdd(&chunk->built, 0) == 0 )
+         continue;
+
+      uploadChunk(chunk);
+      mBuildingChunks.erase_fast(n--);
+   }
+}
+
+void TerrainCell::destroyChunk(TerrainChunk* chunk)
+{
+   if ( chunk->vb.idx != bgfx::invalidHandle )
+      Torque::bgfx.destroyVertexBuffer(chunk->vb);
+
+   chunk->renderData->flags |= Rendering::RenderData::Deleted;
+   SAFE_DELETE_ARRAY(chunk->verts);
+   SAFE_DELETE(chunk);
+}
+
+void TerrainCell::releaseChunks()
+{
+   waitForBuilds();
+
+   for ( S32 n = 0; n < mChunks.size(); ++n )
+   {
+      if ( mChunks[n] != NULL )
+         destroyChunk(mChunks[n]);
+   }
+
+   mChunks.clear();
+   mBuildingChunks.clear();
+   mVisibleChunks.clear();
+   mSelection.clear();
+}
+
+void TerrainCell::refresh()
+{
+   for ( S32 n = 0; n < mChunks.size(); ++n )
+   {
+      if ( mChunks[n] != NULL )
+         refreshChunk(mChunks[n]);
+   }
 }
 
 void TerrainCell::paintLayer(U32 layerNum, U32 x, U32 y, U8 strength)
@@ -324,6 +484,9 @@ void stitchEdges(SimObject *obj, S32 argc, const char *argv[])
          // Left
          if ( compareCell->gridX == (curCell->gridX - 1) && compareCell->gridY == curCell->gridY )
          {
+            compareCell->waitForBuilds();
+            curCell->waitForBuilds();
+
             for(U32 y = 0; y < curCell->height; ++y)
             {
                U32 left_index = ((y + 1) * compareCell->width) - 1;
@@ -334,13 +497,16 @@ void stitchEdges(SimObject *obj, S32 argc, const char *argv[])
                curCell->heightMap[right_index] = average_height;
             }
 
-            compareCell->rebuild();
-            curCell->rebuild();
+            compareCell->updateHeights(compareCell->width - 1, 0, 1, compareCell->height);
+            curCell->updateHeights(0, 0, 1, curCell->height);
          }
 
          // Bottom
          if ( compareCell->gridY == (curCell->gridY - 1) && compareCell->gridX == curCell->gridX )
          {
+            compareCell->waitForBuilds();
+            curCell->waitForBuilds();
+
             for(U32 x = 0; x < curCell->width; ++x)
             {
                U32 bottom_index = (curCell->width * (curCell->height - 2)) + x;
@@ -351,8 +517,8 @@ void stitchEdges(SimObject *obj, S32 argc, const char *argv[])
                curCell->heightMap[top_index] = average_height;
             }
 
-            compareCell->rebuild();
-            curCell->rebuild();
+            compareCell->updateHeights(0, curCell->height - 2, compareCell->width, 1);
+            curCell->updateHeights(0, 0, curCell->width, 1);
          }
       }
    }
@@ -31,39 +31,70 @@
 #include <sim/simObject.h>
 #endif
 
-struct PosUVNormalVertex
+#ifndef _TERRAIN_QUADTREE_H_
+#include <graphics/terrainQuadTree.h>
+#endif
+
+#ifndef _JOB_SYSTEM_H_
+#include <platform/threads/jobSystem.h>
+#endif
+
+// Mesh of one quadtree node. Vertices are built on a worker thread and
+// uploaded from the main thread, the previous vertex buffer is drawn until
+// then.
+struct TerrainChunk
 {
-   F32 m_x;
-	F32 m_y;
-	F32 m_z;
-	F32 m_u;
-	F32 m_v;
-   F32 m_normal_x;
-   F32 m_normal_y;
-   F32 m_normal_z;
+   const TerrainQuadTree*              tree;
+   volatile S32                        built;      ///< Set by the build job once verts are ready.
+   U32                                 x;
+   U32                                 y;
+   U32                                 level;
+   Graphics::PosUVNormalMorphVertex*   verts;
+   bgfx::VertexBufferHandle            vb;
+   Rendering::RenderData*              renderData;
+   Vector<Rendering::TextureData>      textureData;
+   F32                                 transformMtx[16];
+   bool                                building;
+   bool                                stale;
+   U32                                 lastUsedFrame;
 };
 
 class TerrainCell
 {
 protected:
-   PosUVNormalVertex*               mVerts;
-   U32                              mVertCount;
-   U32*                             mIndices;
-   U32                              mIndexCount;
-   F32                              mTransformMtx[16];
-
    bgfx::TextureHandle*             mMegaTexture;
-   Vector<Rendering::TextureData>   mTextureData;
+   bgfx::TextureHandle*             mPageTable;
+   bgfx::IndexBufferHandle*         mChunkIndexBuffers;
    Vector<Rendering::UniformData>*  mUniformData;
    bgfx::ProgramHandle              mShader;
-   Rendering::RenderData*           mRenderData;
-   bgfx::DynamicVertexBufferHandle  mDynamicVB;
-   bgfx::DynamicIndexBufferHandle   mDynamicIB;
-   bgfx::VertexBufferHandle         mVB;
-   bgfx::IndexBufferHandle          mIB;
 
+   // Level of Detail
+   TerrainHeightMap*                mHeightSource;
+   TerrainQuadTree*                 mQuadTree;
+   JobCounter*                      mBuildJobs;
+   Vector<TerrainChunk*>            mBuildingChunks;
+   Vector<TerrainChunk*>            mChunks;
+   Vector<TerrainChunk*>            mVisibleChunks;
+   Vector<TerrainQuadTree::SelectedNode> mSelection;
+   U32                              mFrame;
+   F32                              mLODRange;
+   F32                              mLODMorphRatio;
+
+   TerrainChunk* createChunk(const TerrainQuadTree::SelectedNode& node);
+   void destroyChunk(TerrainChunk* chunk);
+   void buildChunk(TerrainChunk* chunk);
+   void uploadChunk(TerrainChunk* chunk);
+   void uploadBuiltChunks();
+   void refreshChunk(TerrainChunk* chunk);
+   void releaseChunks();
+
+   static void buildChunkJob(void* data, U32 first, U32 count);
 
 public:
+   enum
+   {
+      ChunkLifetime = 300  ///< Frames a chunk is kept after it was last drawn.
+   };
 
    bgfx::TextureHandle              mBlendTexture;
    S32      gridX;
@@ -75,19 +106,27 @@ public:
    F32      maxTerrainHeight;
    bool     dirty;
 
-   TerrainCell(bgfx::TextureHandle* _megaTexture, Vector<Rendering::UniformData>* _uniformData, S32 _gridX, S32 _gridY);
+   TerrainCell(bgfx::TextureHandle* _megaTexture, bgfx::TextureHandle* _pageTable, bgfx::IndexBufferHandle* _chunkIndexBuffers, Vector<Rendering::UniformData>* _uniformData, S32 _gridX, S32 _gridY);
    ~TerrainCell();
 
    Point3F getWorldSpacePos(U32 x, U32 y);
+   Point3F getOffset();
    void loadHeightMap(const char* path);
    void loadEmptyTerrain(S32 _width, S32 _height);
    void refresh();
    void rebuild();
    Point3F getNormal(U32 x, U32 y);
-   void refreshVertexBuffer();
-   void refreshIndexBuffer();
    void refreshBlendMap();
 
+   // Heights must not change while chunks are building, call waitForBuilds()
+   // before editing and updateHeights() with the edited region afterwards.
+   void waitForBuilds();
+   void updateHeights(U32 x, U32 y, U32 _width, U32 _height);
+
+   void setLODRanges(F32 range, F32 morphRatio);
+   void updateLOD(const Point3F& cameraPosition);
+   U32  getSelectedChunkCount() { return mSelection.size(); }
+
    void paintLayer(U32 layerNum, U32 x, U32 y, U8 strength);
 };
 
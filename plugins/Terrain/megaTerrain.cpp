@@ -57,7 +57,10 @@ namespace Scene
       textures[1].idx         = bgfx::invalidHandle;
       textures[2].idx         = bgfx::invalidHandle;
       v_TerrainMegaTexture    = NULL;
-      redrawMegaTexture       = true;
+      pageTable.idx           = bgfx::invalidHandle;
+      pageBudget              = 32;
+      lodRange                = TerrainQuadTree::ChunkSize * 4.0f;
+      lodMorphRatio           = 0.66f;
 
       // Load Shader
       Graphics::ShaderAsset* megaShaderAsset = Torque::Graphics.getShaderAsset("Terrain:megaShader");
@@ -76,22 +79,70 @@ namespace Scene
       megaTexture       = Torque::bgfx.createTexture2D((U16)megaTextureSize, (U16)megaTextureSize, 1, bgfx::TextureFormat::BGRA8, BGFX_TEXTURE_RT | BGFX_TEXTURE_U_CLAMP, NULL);
       megaTextureBuffer = Torque::bgfx.createFrameBuffer(1, &megaTexture, false);
 
-      lastFocusPoint.set(0, 0);
+      // Virtual Texture: 4 levels of 8x8 pages around the focus point, 128
+      // pixel pages with a 1 pixel border.
+      virtualTexture.init(4, 8, 128, megaTextureSize, 1);
+      dMemset(windowData, 0, sizeof(windowData));
+
+      const U32 pageTableFlags = 0
+         | BGFX_TEXTURE_MIN_POINT
+         | BGFX_TEXTURE_MAG_POINT
+         | BGFX_TEXTURE_MIP_POINT
+         | BGFX_TEXTURE_U_CLAMP
+         | BGFX_TEXTURE_V_CLAMP;
+
+      pageTable   = Torque::bgfx.createTexture2D((U16)virtualTexture.getPageTableWidth(), (U16)virtualTexture.getPageTableHeight(), 1, bgfx::TextureFormat::RGBA8, pageTableFlags, NULL);
+      u_pageRect  = Torque::Graphics.getUniformVec4("pageRect", 1);
+
       uniformSet.uniforms = new Vector<Rendering::UniformData>;
 
       // View
       v_TerrainMegaTexture = Torque::Graphics.getView("TerrainMegaTexture", 900, NULL);
+
+      createChunkIndexBuffers();
    }
 
    MegaTerrain::~MegaTerrain()
    {
       Torque::bgfx.destroyFrameBuffer(megaTextureBuffer);
+
+      if (pageTable.idx != bgfx::invalidHandle)
+         Torque::bgfx.destroyTexture(pageTable);
+
+      for (U32 n = 0; n < 16; ++n)
+      {
+         if (chunkIndexBuffers[n].idx != bgfx::invalidHandle)
+            Torque::bgfx.destroyIndexBuffer(chunkIndexBuffers[n]);
+      }
    }
 
    void MegaTerrain::initPersistFields()
    {
       // Call parent.
       Parent::initPersistFields();
+
+      addField("LODRange",       Torque::Con.TypeF32, Offset(lodRange, MegaTerrain), "Distance the most detailed level is drawn to. Doubles with every level.");
+      addField("LODMorphRatio",  Torque::Con.TypeF32, Offset(lodMorphRatio, MegaTerrain), "Where in its range a level starts morphing into the next one, 0 to 1.");
+      addField("PageBudget",     Torque::Con.TypeS32, Offset(pageBudget, MegaTerrain), "Most megatexture pages rendered in a frame.");
+   }
+
+   void MegaTerrain::createChunkIndexBuffers()
+   {
+      // Every chunk is the same grid so they all share these, one for each
+      // combination of quadrants a chunk can be drawn with.
+      chunkIndexBuffers[0].idx = bgfx::invalidHandle;
+
+      // Partial masks only fill the front of this, only what's used is copied.
+      Vector<U16> indices;
+      indices.setSize(TerrainQuadTree::ChunkIndexCount);
+
+      for (U32 quadrants = 1; quadrants < 16; ++quadrants)
+      {
+         U32 indexCount = TerrainQuadTree::buildChunkIndices(quadrants, indices.address());
+
+         const bgfx::Memory* mem = Torque::bgfx.copy(indices.address(), indexCount * sizeof(U16));
+         chunkIndexBuffers[quadrants] = Torque::bgfx.createIndexBuffer(mem, BGFX_BUFFER_NONE);
+      }
    }
 
    void MegaTerrain::onAddToScene()
@@ -104,16 +155,33 @@ namespace Scene
       if (terrainGrid.size() < 1)
          return;
 
+      // Edited cells make every page stale.
+      for (S32 n = 0; n < terrainGrid.size(); ++n)
+      {
+         if (terrainGrid[n].dirty)
+         {
+            virtualTexture.invalidate();
+            pageUpdates.clear();
+            terrainGrid[n].dirty = false;
+         }
+      }
+
       // Calculate focus point.
       Point3F camPos = camera->position;
       Point2F focusPoint;
       focusPoint.set((camPos.x / terrainGrid[0].width) - terrainGrid[0].gridX, (camPos.y / terrainGrid[0].height) - terrainGrid[0].gridY);
-      Point2F diff = lastFocusPoint - focusPoint;
-      if (diff.len() > 0.025f)
+
+      // Pages handed out are marked resident, don't move on before they
+      // have been rendered.
+      if (pageUpdates.size() == 0)
       {
-         lastFocusPoint = focusPoint;
-         refresh();
+         virtualTexture.update(focusPoint, (U32)mClamp(pageBudget, 1, (S32)virtualTexture.getSlotCount()), pageUpdates);
+         updatePageTable();
       }
+
+      // Select the chunks to draw from this camera.
+      for (S32 n = 0; n < terrainGrid.size(); ++n)
+         terrainGrid[n].updateLOD(camPos);
    }
 
    void MegaTerrain::render(Rendering::RenderCamera* camera)
@@ -121,25 +189,50 @@ namespace Scene
       if (terrainGrid.size() < 1)
          return;
 
-      // Check for dirty cells.
-      for (S32 n = 0; n < terrainGrid.size(); ++n)
+      if (pageUpdates.size() > 0)
+         renderPages();
+   }
+
+   void MegaTerrain::updatePageTable()
+   {
+      if (virtualTexture.isPageTableDirty())
       {
-         if (terrainGrid[n].dirty)
-         {
-            redrawMegaTexture = true;
-            terrainGrid[n].dirty = false;
-         }
+         // Only the rows that changed since the last upload.
+         const U32 tableWidth  = virtualTexture.getPageTableWidth();
+         const U32 firstRow    = virtualTexture.getPageTableDirtyRow();
+         const U32 rowCount    = virtualTexture.getPageTableDirtyRowCount();
+
+         const bgfx::Memory* mem = Torque::bgfx.copy(virtualTexture.getPageTable() + (firstRow * tableWidth * 4), rowCount * tableWidth * 4);
+         Torque::bgfx.updateTexture2D(pageTable, 0, 0, (U16)firstRow, (U16)tableWidth, (U16)rowCount, mem, UINT16_MAX);
+         virtualTexture.clearPageTableDirty();
       }
 
-      if (redrawMegaTexture)
+      // Window of each level: origin and pages across the terrain.
+      for (U32 level = 0; level < virtualTexture.getLevelCount(); ++level)
       {
-         redrawMegaTexture = false;
+         const Point2I& origin = virtualTexture.getWindowOrigin(level);
+         windowData[(level * 4) + 0] = (F32)origin.x;
+         windowData[(level * 4) + 1] = (F32)origin.y;
+         windowData[(level * 4) + 2] = (F32)virtualTexture.getPagesAcross(level);
+         windowData[(level * 4) + 3] = 0.0f;
+      }
+   }
 
-         F32 proj[16];
-         bx::mtxOrtho(proj, 0.0f, 1.0f, 1.0f, 0.0f, 0.0f, 100.0f);
-         Torque::bgfx.setViewFrameBuffer(v_TerrainMegaTexture->id, megaTextureBuffer);
-         Torque::bgfx.setViewTransform(v_TerrainMegaTexture->id, NULL, proj, BGFX_VIEW_STEREO, NULL);
-         Torque::bgfx.setViewRect(v_TerrainMegaTexture->id, 0, 0, (U16)megaTextureSize, (U16)megaTextureSize);
+   void MegaTerrain::renderPages()
+   {
+      PROFILE_SCOPE(MegaTerrain_RenderPages);
+
+      F32 proj[16];
+      bx::mtxOrtho(proj, 0.0f, 1.0f, 1.0f, 0.0f, 0.0f, 100.0f);
+      Torque::bgfx.setViewFrameBuffer(v_TerrainMegaTexture->id, megaTextureBuffer);
+      Torque::bgfx.setViewTransform(v_TerrainMegaTexture->id, NULL, proj, BGFX_VIEW_STEREO, NULL);
+      Torque::bgfx.setViewRect(v_TerrainMegaTexture->id, 0, 0, (U16)megaTextureSize, (U16)megaTextureSize);
+
+      const F32 pageSize = (F32)virtualTexture.getPageSize();
+
+      for (S32 i = 0; i < pageUpdates.size(); ++i)
+      {
+         const VirtualTexture::PageUpdate& page = pageUpdates[i];
 
          U8 tex_offset = 0;
          if (terrainGrid[0].mBlendTexture.idx != bgfx::invalidHandle)
@@ -159,17 +252,26 @@ namespace Scene
          // Setup Uniforms
          if (!uniformSet.isEmpty())
          {
-            for (S32 i = 0; i < uniformSet.uniforms->size(); ++i)
+            for (S32 j = 0; j < uniformSet.uniforms->size(); ++j)
             {
-               Rendering::UniformData* uniform = &uniformSet.uniforms->at(i);
+               Rendering::UniformData* uniform = &uniformSet.uniforms->at(j);
                Torque::bgfx.setUniform(uniform->uniform, uniform->_dataPtr, (U16)uniform->count);
             }
          }
 
+         // Area of the terrain this page covers.
+         RectF rect = virtualTexture.getPageRect(page.level, page.x, page.y);
+         Point4F pageRect(rect.point.x, rect.point.y, rect.extent.x, rect.extent.y);
+         Torque::bgfx.setUniform(u_pageRect, &pageRect.x, 1);
+
+         // Drawn into its slot of the megatexture.
+         Point2I slotOrigin = virtualTexture.getSlotOrigin(page.slot);
          Torque::bgfx.setState(BGFX_STATE_RGB_WRITE | BGFX_STATE_ALPHA_WRITE, 0);
-         Torque::Graphics.fullScreenQuad((F32)megaTextureSize, (F32)megaTextureSize, 0.0f);
+         Torque::Graphics.screenSpaceQuad((F32)slotOrigin.x, (F32)slotOrigin.y, pageSize, pageSize, (F32)megaTextureSize, (F32)megaTextureSize);
          Torque::bgfx.submit(v_TerrainMegaTexture->id, megaShader, 0, false);
       }
+
+      pageUpdates.clear();
    }
 
    void MegaTerrain::postRender(Rendering::RenderCamera* camera)
@@ -189,8 +291,9 @@ namespace Scene
       }
 
       // Create new cell
-      TerrainCell cell(&megaTexture, uniformSet.uniforms, gridX, gridY);
+      TerrainCell cell(&megaTexture, &pageTable, chunkIndexBuffers, uniformSet.uniforms, gridX, gridY);
       terrainGrid.push_back(cell);
+      terrainGrid.back().setLODRanges(lodRange, lodMorphRatio);
       terrainGrid.back().loadEmptyTerrain(width, height);
 
       refresh();
@@ -208,8 +311,9 @@ namespace Scene
       }
 
       // Create new cell
-      TerrainCell cell(&megaTexture, uniformSet.uniforms, gridX, gridY);
+      TerrainCell cell(&megaTexture, &pageTable, chunkIndexBuffers, uniformSet.uniforms, gridX, gridY);
       terrainGrid.push_back(cell);
+      terrainGrid.back().setLODRanges(lodRange, lodMorphRatio);
       terrainGrid.back().loadHeightMap(heightMap);
 
       refresh();
@@ -233,21 +337,34 @@ namespace Scene
 
       uniformSet.clear();
 
-      Rendering::UniformData* u_focusPoint = uniformSet.addUniform();
-      u_focusPoint->count = 1;
-      u_focusPoint->uniform = Torque::Graphics.getUniformVec4("focusPoint", 1);
-      u_focusPoint->setValue(Point4F(lastFocusPoint.x, lastFocusPoint.y, 0.0f, 0.0f));
-
-      Rendering::UniformData* u_cascadeSize = uniformSet.addUniform();
-      u_cascadeSize->count = 1;
-      u_cascadeSize->uniform = Torque::Graphics.getUniformVec4("cascadeSize", 1);
-      u_cascadeSize->setValue(Point4F(0.1f, 0.25f, 0.5f, 0.0f));
-
       Rendering::UniformData* u_layerScale = uniformSet.addUniform();
       u_layerScale->count = 1;
       u_layerScale->uniform = Torque::Graphics.getUniformVec4("layerScale", 1);
       u_layerScale->setValue(Point4F(16.0f, 1.0f, 1.0f, 1.0f));
 
-      redrawMegaTexture = true;
+      // Morph ranges, see TerrainQuadTree::getMorphStart().
+      Rendering::UniformData* u_terrainLOD = uniformSet.addUniform();
+      u_terrainLOD->count = 1;
+      u_terrainLOD->uniform = Torque::Graphics.getUniformVec4("terrainLOD", 1);
+      u_terrainLOD->setValue(Point4F(lodRange, lodMorphRatio, 0.0f, 0.0f));
+
+      // Virtual Texture, see VirtualTexture::getPageTable().
+      Rendering::UniformData* u_vtParams = uniformSet.addUniform();
+      u_vtParams->count = 1;
+      u_vtParams->uniform = Torque::Graphics.getUniformVec4("vtParams", 1);
+      u_vtParams->setValue(Point4F((F32)virtualTexture.getWindowSize(), (F32)virtualTexture.getLevelCount(),
+         (F32)virtualTexture.getSlotsPerSide(), (F32)virtualTexture.getBorder() / (F32)virtualTexture.getPageSize()));
+
+      Rendering::UniformData* u_vtWindow = uniformSet.addUniform();
+      u_vtWindow->count = VirtualTexture::MaxLevels;
+      u_vtWindow->uniform = Torque::Graphics.getUniformVec4("vtWindow", VirtualTexture::MaxLevels);
+      u_vtWindow->_dataPtr = windowData;
+
+      for (S32 n = 0; n < terrainGrid.size(); ++n)
+         terrainGrid[n].setLODRanges(lodRange, lodMorphRatio);
+
+      // Layers or blend map may have changed.
+      virtualTexture.invalidate();
+      pageUpdates.clear();
    }
 }
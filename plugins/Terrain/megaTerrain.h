@@ -39,6 +39,10 @@
 #include "platform/Tickable.h"
 #endif
 
+#ifndef _VIRTUAL_TEXTURE_H_
+#include <graphics/virtualTexture.h>
+#endif
+
 namespace Scene
 {
    class MegaTerrain : public BaseComponent, public Rendering::RenderHook
@@ -50,13 +54,23 @@ namespace Scene
          bgfx::TextureHandle             megaTexture;
          bgfx::FrameBufferHandle         megaTextureBuffer;
          bgfx::ProgramHandle             megaShader;
-         bool                            redrawMegaTexture;
+
+         // The megatexture is the physical texture of a virtual texture,
+         // only pages that scroll into view are rendered.
+         VirtualTexture                  virtualTexture;
+         Vector<VirtualTexture::PageUpdate> pageUpdates;
+         S32                             pageBudget;
+         bgfx::TextureHandle             pageTable;
+         bgfx::UniformHandle             u_pageRect;
+         F32                             windowData[VirtualTexture::MaxLevels * 4];
 
          bgfx::TextureHandle             textures[3];
+         bgfx::IndexBufferHandle         chunkIndexBuffers[16];
+         F32                             lodRange;
+         F32                             lodMorphRatio;
          Vector<Rendering::TextureData>  textureData;
 
          Rendering::UniformSet           uniformSet;
-         Point2F                         lastFocusPoint;
          Graphics::ViewTableEntry*       v_TerrainMegaTexture;
 
       public:
@@ -68,6 +82,9 @@ namespace Scene
          void loadTexture(S32 slot, const char* texture);
          void loadEmptyTerrain(S32 gridX, S32 gridY, S32 width, S32 height);
          void loadHeightMap(S32 gridX, S32 gridY, const char* heightMap);
+         void createChunkIndexBuffers();
+         void updatePageTable();
+         void renderPages();
          void refresh();
 
          virtual void preRender(Rendering::RenderCamera* camera);
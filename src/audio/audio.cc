@@ -28,6 +28,8 @@
 #include "game/gameConnection.h"
 #include "io/fileStream.h"
 #include "audio/audioStreamSourceFactory.h"
+#include "audio/audioVoiceScheduler.h"
+#include "audio/audioStreamThread.h"
 
 #ifdef TORQUE_OS_IOS
 #include "platformiOS/SoundEngine.h"
@@ -113,6 +115,38 @@ static AudioSampleEnvironment*        mSampleEnvironment[MAX_AUDIOSOURCES];
 static bool                           mEnvironmentEnabled = false;                    // environment enabled?
 static SimObjectPtr<AudioEnvironment> mCurrentEnvironment;                            // the last environment set
 
+//-------------------------------------------------------------------------
+// One-shots are virtual voices. They play on the sources above whenever
+// no looper or stream holds them, the scheduler decides which voices get
+// one, see audioVoiceScheduler.h.
+class ALVoiceDevice : public AudioVoiceDevice
+{
+public:
+   Vector<Resource<AudioBuffer> >   mBuffers;      // per voice index, keeps the buffers loaded
+
+   void retain(AUDIOVOICE voice, Resource<AudioBuffer> buffer);
+
+   virtual U32 getVoiceCount() const;
+   virtual bool isAvailable(U32 slot);
+   virtual void play(U32 slot, const AudioVoice& voice, U32 offset);
+   virtual void update(U32 slot, const AudioVoice& voice, F32 gain);
+   virtual U32 stop(U32 slot);
+   virtual bool getOffset(U32 slot, U32* offset);
+   virtual void release(const AudioVoice& voice);
+};
+
+static ALVoiceDevice          mVoiceDevice;
+static AudioVoiceScheduler    mVoiceScheduler;
+static U32                    mVoiceUpdateTime = 0;
+
+// decodes and refills the streaming sources
+static AudioStreamThread*     mStreamThread = NULL;
+
+AudioStreamThread* alxGetStreamThread()
+{
+   return mStreamThread;
+}
+
 struct LoopingList : VectorPtr<LoopingImage*>
 {
    LoopingList() : VectorPtr<LoopingImage*>(__FILE__, __LINE__) { }
@@ -145,6 +179,7 @@ static StreamingList mStreamingCulledList;           // sources which have been
 #define AUDIOHANDLE_STREAMING_BIT  (0x40000000)
 #define AUDIOHANDLE_INACTIVE_BIT (0x20000000)
 #define AUDIOHANDLE_LOADING_BIT  (0x10000000)
+#define AUDIOHANDLE_VOICE_BIT    (0x08000000)
 #define HANDLE_MASK             ~(AUDIOHANDLE_LOOPING_BIT | AUDIOHANDLE_INACTIVE_BIT | AUDIOHANDLE_LOADING_BIT)
 
 // keep the 'AUDIOHANDLE_LOOPING_BIT' on the handle returned to the caller so that
@@ -163,6 +198,17 @@ inline bool areEqualHandles(AUDIOHANDLE a, AUDIOHANDLE b)
    return((a & HANDLE_MASK) == (b & HANDLE_MASK));
 }
 
+// virtual voices carry the voice bit, the rest is the scheduler's handle
+inline bool isVoiceHandle(AUDIOHANDLE handle)
+{
+   return((handle & AUDIOHANDLE_VOICE_BIT) != 0);
+}
+
+inline AUDIOVOICE toVoice(AUDIOHANDLE handle)
+{
+   return(handle & ~AUDIOHANDLE_VOICE_BIT);
+}
+
 //-------------------------------------------------------------------------
 // Looping image
 //-------------------------------------------------------------------------
@@ -252,7 +298,7 @@ AudioStreamSource * createStreamingSource(const char* filename)
 static AUDIOHANDLE getNewHandle()
 {
    mLastHandle++;
-   mLastHandle &= HANDLE_MASK;
+   mLastHandle &= HANDLE_MASK & ~AUDIOHANDLE_VOICE_BIT;
    if (mLastHandle == NULL_AUDIOHANDLE)
       mLastHandle++;
    return mLastHandle;
@@ -263,12 +309,13 @@ static AUDIOHANDLE getNewHandle()
 // function declarations
 void alxLoopingUpdate();
 void alxStreamingUpdate();
+void alxVoiceUpdate();
 void alxUpdateScores(bool);
 
 static bool findFreeSource(U32 *index)
 {
    for(U32 i = 0; i < mNumSources; i++)
-      if(mHandle[i] == NULL_AUDIOHANDLE)
+      if(mHandle[i] == NULL_AUDIOHANDLE && !mVoiceScheduler.getSlotVoice(i))
       {
          *index = i;
          return(true);
@@ -280,6 +327,7 @@ static bool findFreeSource(U32 *index)
 // - cull out the min source that is below volume
 // - streams/voice/loading streams are all scored > 2
 // - volumes are attenuated by channel only
+// - sources playing a virtual voice score its rank, culling makes it virtual
 static bool cullSource(U32 *index, F32 volume)
 {
    alGetError();
@@ -288,9 +336,11 @@ static bool cullSource(U32 *index, F32 volume)
    S32 best = -1;
    for(U32 i = 0; i < mNumSources; i++)
    {
-      if(mScore[i] < minVolume)
+      const AudioVoice* voice = mVoiceScheduler.getSlotVoice(i);
+      F32 score = voice ? voice->mRank : mScore[i];
+      if(score < minVolume)
       {
-         minVolume = mScore[i];
+         minVolume = score;
          best = i;
       }
    }
@@ -298,6 +348,13 @@ static bool cullSource(U32 *index, F32 volume)
    if(best == -1)
       return(false);
 
+   if(mVoiceScheduler.getSlotVoice(best))
+   {
+      mVoiceScheduler.evict(best);
+      *index = best;
+      return(true);
+   }
+
    // check if culling a looper
    LoopingList::iterator itr = mLoopingList.findImage(mHandle[best]);
    if(itr)
@@ -398,6 +455,9 @@ bool alxIsValidHandle(AUDIOHANDLE handle)
    if(handle == NULL_AUDIOHANDLE)
       return(false);
 
+   if(isVoiceHandle(handle))
+      return(mVoiceScheduler.isValid(toVoice(handle)));
+
    // inactive sources are valid
    U32 idx = alxFindIndex(handle);
    if(idx != MAX_AUDIOSOURCES)
@@ -428,6 +488,10 @@ bool alxIsPlaying(AUDIOHANDLE handle)
    if(handle == NULL_AUDIOHANDLE)
       return(false);
 
+   // virtual voices play too, they just aren't heard
+   if(isVoiceHandle(handle))
+      return(mVoiceScheduler.isValid(toVoice(handle)) && !mVoiceScheduler.isPaused(toVoice(handle)));
+
    U32 idx = alxFindIndex(handle);
    if(idx == MAX_AUDIOSOURCES)
       return(false);
@@ -877,6 +941,10 @@ extern void threadPlay(AudioBuffer * buffer, AUDIOHANDLE handle);
 
 AUDIOHANDLE alxPlay(AUDIOHANDLE handle)
 {
+   // voices start playing when they are created
+   if(isVoiceHandle(handle))
+      return(mVoiceScheduler.isValid(toVoice(handle)) ? handle : NULL_AUDIOHANDLE);
+
    U32 index = alxFindIndex(handle);
 
    if(index != MAX_AUDIOSOURCES)
@@ -894,7 +962,10 @@ AUDIOHANDLE alxPlay(AUDIOHANDLE handle)
          // make sure the streaming image also clears it's inactive bit
          StreamingList::iterator itr2 = mStreamingList.findImage(handle);
          if(itr2)
+         {
             (*itr2)->mHandle &= ~(AUDIOHANDLE_INACTIVE_BIT | AUDIOHANDLE_LOADING_BIT);
+            (*itr2)->startStream();
+         }
 
          alSourcePlay(mSource[index]);
 
@@ -954,7 +1025,18 @@ AUDIOHANDLE alxPlay(const AudioAsset *profile, const MatrixF *transform, const P
    if(profile == NULL)
       return NULL_AUDIOHANDLE;
 
-   AUDIOHANDLE handle = alxCreateSource(profile->getAudioDescription(), profile->getAudioFile(), transform, NULL);
+   // one-shots are virtual voices, only loopers and streams need a handle
+   // that holds on to a source
+   const Audio::Description& desc = profile->getAudioDescription();
+   if(!desc.mIsLooping && !desc.mIsStreaming)
+   {
+      Point3F position;
+      if(transform)
+         transform->getColumn(3, &position);
+      return alxPlayVoice(profile, transform ? &position : NULL);
+   }
+
+   AUDIOHANDLE handle = alxCreateSource(desc, profile->getAudioFile(), transform, NULL);
    if(handle != NULL_AUDIOHANDLE)
       return(alxPlay(handle));
    return(handle);
@@ -964,6 +1046,13 @@ bool alxPause( AUDIOHANDLE handle )
 {
     if(handle == NULL_AUDIOHANDLE)
         return false;
+
+    if(isVoiceHandle(handle))
+    {
+        mVoiceScheduler.pause(toVoice(handle));
+        return mVoiceScheduler.isPaused(toVoice(handle));
+    }
+
     U32 index = alxFindIndex( handle );
 
     alSourcePause( mSource[index] );
@@ -985,6 +1074,12 @@ void alxUnPause( AUDIOHANDLE handle )
 {
     if(handle == NULL_AUDIOHANDLE)
         return;
+
+    if(isVoiceHandle(handle))
+    {
+        mVoiceScheduler.resume(toVoice(handle));
+        return;
+    }
     
 	U32 index = alxFindIndex(handle);
 	ALuint source = mSource[index];
@@ -1002,6 +1097,12 @@ void alxUnPause( AUDIOHANDLE handle )
 //--------------------------------------------------------------------------
 void alxStop(AUDIOHANDLE handle)
 {
+   if(isVoiceHandle(handle))
+   {
+      mVoiceScheduler.stop(toVoice(handle));
+      return;
+   }
+
    U32 index = alxFindIndex(handle);
 
    // stop it
@@ -1094,6 +1195,9 @@ void alxStopAll()
 // stop all streaming sources
    while(mStreamingList.size())
       alxStop(mStreamingList.last()->mHandle);
+
+   // and the virtual voices
+   mVoiceScheduler.stopAll();
 }
 
 void alxLoopSourcef(AUDIOHANDLE handle, ALenum pname, ALfloat value)
@@ -1376,6 +1480,84 @@ void alxStreamGetSourcei(AUDIOHANDLE handle, ALenum pname, ALint *value)
    }
 }
 
+//------------------------------------------------------
+
+void alxVoiceSourcef(AUDIOHANDLE handle, ALenum pname, ALfloat value)
+{
+   switch(pname)
+   {
+      case AL_GAIN:
+         mVoiceScheduler.setVolume(toVoice(handle), Audio::DBToLinear(value));
+         break;
+      case AL_GAIN_LINEAR:
+         mVoiceScheduler.setVolume(toVoice(handle), value);
+         break;
+      case AL_PITCH:
+         mVoiceScheduler.setPitch(toVoice(handle), value);
+         break;
+   }
+}
+
+void alxVoiceSource3f(AUDIOHANDLE handle, ALenum pname, ALfloat value1, ALfloat value2, ALfloat value3)
+{
+   if(pname == AL_POSITION)
+      mVoiceScheduler.setPosition(toVoice(handle), Point3F(value1, value2, value3));
+}
+
+void alxVoiceGetSourcef(AUDIOHANDLE handle, ALenum pname, ALfloat *value)
+{
+   const AudioVoice* voice = mVoiceScheduler.getVoice(toVoice(handle));
+   if(voice)
+   {
+      switch(pname)
+      {
+         case AL_GAIN:
+            *value = Audio::linearToDB(voice->mDesc.mVolume);
+            break;
+         case AL_GAIN_LINEAR:
+            *value = voice->mDesc.mVolume;
+            break;
+         case AL_PITCH:
+            *value = voice->mPitch;
+            break;
+         case AL_REFERENCE_DISTANCE:
+            *value = voice->mDesc.mReferenceDistance;
+            break;
+         case AL_MAX_DISTANCE:
+            *value = voice->mDesc.mMaxDistance;
+            break;
+      }
+   }
+}
+
+void alxVoiceGetSource3f(AUDIOHANDLE handle, ALenum pname, ALfloat *value1, ALfloat *value2, ALfloat *value3)
+{
+   const AudioVoice* voice = mVoiceScheduler.getVoice(toVoice(handle));
+   if(voice && pname == AL_POSITION)
+   {
+      *value1 = voice->mPosition.x;
+      *value2 = voice->mPosition.y;
+      *value3 = voice->mPosition.z;
+   }
+}
+
+void alxVoiceGetSourcei(AUDIOHANDLE handle, ALenum pname, ALint *value)
+{
+   const AudioVoice* voice = mVoiceScheduler.getVoice(toVoice(handle));
+   if(voice)
+   {
+      switch(pname)
+      {
+         case AL_LOOPING:
+            *value = voice->mDesc.mIsLooping;
+            break;
+         case AL_SOURCE_STATE:
+            *value = (voice->mState == AudioVoiceScheduler::Paused) ? AL_PAUSED : AL_PLAYING;
+            break;
+      }
+   }
+}
+
 //--------------------------------------------------------------------------
 // AL get/set methods: Source
 //--------------------------------------------------------------------------
@@ -1406,6 +1588,12 @@ void alxUpdateTypeGain(U32 type)
 
 void alxSourcef(AUDIOHANDLE handle, ALenum pname, ALfloat value)
 {
+   if(isVoiceHandle(handle))
+   {
+      alxVoiceSourcef(handle, pname, value);
+      return;
+   }
+
    ALuint source = alxFindSource(handle);
 
    if(source != INVALID_SOURCE)
@@ -1453,6 +1641,12 @@ void alxSourcef(AUDIOHANDLE handle, ALenum pname, ALfloat value)
 
 void alxSourcefv(AUDIOHANDLE handle, ALenum pname, ALfloat *values)
 {
+   if(isVoiceHandle(handle))
+   {
+      alxVoiceSource3f(handle, pname, values[0], values[1], values[2]);
+      return;
+   }
+
    ALuint source = alxFindSource(handle);
    if(source != INVALID_SOURCE)
       alSourcefv(source, pname, values);
@@ -1465,6 +1659,12 @@ void alxSourcefv(AUDIOHANDLE handle, ALenum pname, ALfloat *values)
 
 void alxSource3f(AUDIOHANDLE handle, ALenum pname, ALfloat value1, ALfloat value2, ALfloat value3)
 {
+   if(isVoiceHandle(handle))
+   {
+      alxVoiceSource3f(handle, pname, value1, value2, value3);
+      return;
+   }
+
    ALuint source = alxFindSource(handle);
    if(source != INVALID_SOURCE)
    {
@@ -1480,6 +1680,9 @@ void alxSource3f(AUDIOHANDLE handle, ALenum pname, ALfloat value1, ALfloat value
 
 void alxSourcei(AUDIOHANDLE handle, ALenum pname, ALint value)
 {
+   if(isVoiceHandle(handle))
+      return;
+
    ALuint source = alxFindSource(handle);
    if(source != INVALID_SOURCE)
       alSourcei(source, pname, value);
@@ -1490,11 +1693,18 @@ void alxSourcei(AUDIOHANDLE handle, ALenum pname, ALint value)
 // sets the position and direction of the source
 void alxSourceMatrixF(AUDIOHANDLE handle, const MatrixF *transform)
 {
-   ALuint source = alxFindSource(handle);
-
    Point3F pos;
    transform->getColumn(3, &pos);
 
+   // voices point along their cone vector
+   if(isVoiceHandle(handle))
+   {
+      mVoiceScheduler.setPosition(toVoice(handle), pos);
+      return;
+   }
+
+   ALuint source = alxFindSource(handle);
+
    Point3F dir;
    transform->getColumn(1, &dir);
 
@@ -1536,6 +1746,8 @@ void alxGetSourcef(AUDIOHANDLE handle, ALenum pname, ALfloat *value)
       else
          alGetSourcef(source, pname, value);
    }
+   else if(isVoiceHandle(handle))
+      alxVoiceGetSourcef(handle, pname, value);
    else if(handle & AUDIOHANDLE_LOOPING_BIT)
       alxLoopGetSourcef(handle, pname, value);
    else
@@ -1559,6 +1771,8 @@ void alxGetSource3f(AUDIOHANDLE handle, ALenum pname, ALfloat *value1, ALfloat *
       *value2 = values[1];
       *value3 = values[2];
    }
+   else if(isVoiceHandle(handle))
+      alxVoiceGetSource3f(handle, pname, value1, value2, value3);
    else if(handle & AUDIOHANDLE_LOOPING_BIT)
       alxLoopGetSource3f(handle, pname, value1, value2, value3);
    else
@@ -1570,6 +1784,8 @@ void alxGetSourcei(AUDIOHANDLE handle, ALenum pname, ALint *value)
    ALuint source = alxFindSource(handle);
    if(source != INVALID_SOURCE)
       alGetSourcei(source, pname, value);
+   else if(isVoiceHandle(handle))
+      alxVoiceGetSourcei(handle, pname, value);
    else if(handle & AUDIOHANDLE_LOOPING_BIT)
       alxLoopGetSourcei(handle, pname, value);
    else
@@ -1709,6 +1925,7 @@ static void alxGatherMetrics()
    Con::setIntVariable("Audio::numStreamingStreams",          mNumStreamingStreams);
    Con::setIntVariable("Audio::numInactiveStreamingStreams",  mNumInactiveStreamingStreams);
    Con::setIntVariable("Audio::numCulledStreamingStreams",    mNumCulledStreamingStreams);
+   Con::setIntVariable("Audio::numStreamUnderruns",           mStreamThread ? mStreamThread->getUnderrunCount() : 0);
 }
 #endif
 
@@ -1810,14 +2027,24 @@ void alxLoopingUpdate()
 
 void alxStreamingUpdate()
 {
-   // update buffer queues on active streamers
-   // update the loopers
-   for(StreamingList::iterator itr = mStreamingList.begin(); itr != mStreamingList.end(); itr++)
+   // the stream thread keeps the buffer queues filled, pick up the streams
+   // it is done with
+   AudioStreamThread::Event event;
+   while(mStreamThread && mStreamThread->popEvent(event))
    {
-      if((*itr)->mHandle & AUDIOHANDLE_INACTIVE_BIT)
+      if(event.mType != AudioStreamThread::StreamFinished)
          continue;
 
-      (*itr)->updateBuffers();
+      for(StreamingList::iterator itr = mStreamingList.begin(); itr != mStreamingList.end(); itr++)
+      {
+         if((*itr)->mStreamId != event.mStream)
+            continue;
+
+         // already closed by the thread
+         (*itr)->mStreamId = 0;
+         (*itr)->bFinishedPlaying = true;
+         break;
+      }
    }
 
    static StreamingList culledList;
@@ -1886,7 +2113,12 @@ void alxStreamingUpdate()
          StreamingList::iterator tmp = mStreamingCulledList.findImage((*itr)->mHandle);
          AssertFatal(tmp, "alxStreamingUpdate: failed to find culled source");
          mStreamingCulledList.erase_fast(tmp);
+
+         // the stream queues on its new source
+         ALuint source = mSource[index];
+         (*itr)->mSource = mSource[index];
          alxSourcePlay(*itr);
+
          // restore all state data
          mHandle[index] = (*itr)->mHandle;
          mScore[index] = (*itr)->mScore;
@@ -1894,9 +2126,6 @@ void alxStreamingUpdate()
          mType[index] = (*itr)->mDescription.mVolumeChannel;
          mSampleEnvironment[index] = (*itr)->mEnvironment;
 
-         ALuint source = mSource[index];
-         (*itr)->mSource = mSource[index];
-
          // setup play info
          alGetError();
 
@@ -1924,6 +2153,15 @@ void alxCloseHandles()
       if(state == AL_PLAYING || state == AL_PAUSED)
          continue;
 
+      // a stream is stopped until its first buffers are queued, or when it
+      // ran dry, the stream thread restarts it
+      if(mHandle[i] & AUDIOHANDLE_STREAMING_BIT)
+      {
+         StreamingList::iterator itr = mStreamingList.findImage(mHandle[i]);
+         if(itr && (*itr)->bIsValid && !(*itr)->bFinishedPlaying)
+            continue;
+      }
+
       if(!(mHandle[i] & AUDIOHANDLE_INACTIVE_BIT))
       {
          // should be playing? must have encounted an error.. remove
@@ -2130,6 +2368,7 @@ void alxUpdate()
    alxUpdateScores(false);
    alxLoopingUpdate();
    alxStreamingUpdate();
+   alxVoiceUpdate();
 
 #ifdef TORQUE_GATHER_METRICS
    alxGatherMetrics();
@@ -2342,6 +2581,197 @@ F32 alxGetStreamDuration( AUDIOHANDLE handle )
    return (*itr)->getTotalTime();
 }
 
+//--------------------------------------------------------------------------
+// Virtual voices
+//--------------------------------------------------------------------------
+U32 ALVoiceDevice::getVoiceCount() const
+{
+   return mNumSources;
+}
+
+bool ALVoiceDevice::isAvailable(U32 slot)
+{
+   return mHandle[slot] == NULL_AUDIOHANDLE;
+}
+
+void ALVoiceDevice::retain(AUDIOVOICE voice, Resource<AudioBuffer> buffer)
+{
+   U32 index = (voice & AudioVoiceScheduler::IndexMask) - 1;
+   if(index >= (U32)mBuffers.size())
+      mBuffers.setSize(index + 1);
+   mBuffers[index] = buffer;
+}
+
+void ALVoiceDevice::play(U32 slot, const AudioVoice& voice, U32 offset)
+{
+   ALuint source = mSource[slot];
+   const AudioVoiceDesc& desc = voice.mDesc;
+
+   alGetError();
+   alSourcei(source, AL_BUFFER, desc.mBuffer);
+   alSourcei(source, AL_LOOPING, desc.mIsLooping ? AL_TRUE : AL_FALSE);
+
+   // the source may have played a looper or a stream before
+   alSourcei(source, AL_CONE_INNER_ANGLE, desc.mConeInsideAngle);
+   alSourcei(source, AL_CONE_OUTER_ANGLE, desc.mConeOutsideAngle);
+   alSourcef(source, AL_CONE_OUTER_GAIN, desc.mConeOutsideVolume);
+
+   if(desc.mIs3D)
+   {
+#ifdef REL_WORKAROUND
+      alSourcei(source, AL_SOURCE_ABSOLUTE, AL_TRUE);
+#else
+      alSourcei(source, AL_SOURCE_RELATIVE, AL_FALSE);
+#endif
+      alSource3f(source, AL_DIRECTION, desc.mConeVector.x, desc.mConeVector.y, desc.mConeVector.z);
+   }
+   else
+   {
+      // 2D sound
+      alSourcei(source, AL_SOURCE_RELATIVE, AL_TRUE);
+      alSource3f(source, AL_POSITION, 0.0f, 0.0f, 1.0f);
+   }
+
+   alSourcef(source, AL_REFERENCE_DISTANCE, desc.mReferenceDistance);
+   alSourcef(source, AL_MAX_DISTANCE, desc.mMaxDistance);
+
+   // resume where the voice would be had it never lost its source
+   alSourcei(source, AL_SAMPLE_OFFSET, offset);
+   alSourcePlay(source);
+   alxCheckError("ALVoiceDevice::play()", "alSourcePlay");
+}
+
+void ALVoiceDevice::update(U32 slot, const AudioVoice& voice, F32 gain)
+{
+   ALuint source = mSource[slot];
+
+   alSourcef(source, AL_GAIN, Audio::linearToDB(gain));
+   alSourcef(source, AL_PITCH, voice.mPitch);
+   if(voice.mDesc.mIs3D)
+      alSource3f(source, AL_POSITION, voice.mPosition.x, voice.mPosition.y, voice.mPosition.z);
+}
+
+U32 ALVoiceDevice::stop(U32 slot)
+{
+   ALuint source = mSource[slot];
+
+   ALint offset = 0;
+   alGetSourcei(source, AL_SAMPLE_OFFSET, &offset);
+   alSourceStop(source);
+   alSourcei(source, AL_BUFFER, AL_NONE);
+   return offset;
+}
+
+bool ALVoiceDevice::getOffset(U32 slot, U32* offset)
+{
+   ALint state = AL_STOPPED;
+   alGetSourcei(mSource[slot], AL_SOURCE_STATE, &state);
+   if(state != AL_PLAYING)
+      return false;
+
+   ALint value = 0;
+   alGetSourcei(mSource[slot], AL_SAMPLE_OFFSET, &value);
+   *offset = value;
+   return true;
+}
+
+void ALVoiceDevice::release(const AudioVoice& voice)
+{
+   if(voice.mIndex < (U32)mBuffers.size())
+      mBuffers[voice.mIndex] = 0;
+}
+
+//--------------------------------------------------------------------------
+AUDIOHANDLE alxPlayVoice(const AudioAsset *profile, const Point3F *position, S32 priority)
+{
+   if(!mContext || profile == NULL)
+      return NULL_AUDIOHANDLE;
+
+   const Audio::Description& desc = profile->getAudioDescription();
+   if(desc.mIsStreaming)
+   {
+      Con::warnf("alxPlayVoice - '%s' is streamed, streams can't be virtual voices.", profile->getAudioFile());
+      return NULL_AUDIOHANDLE;
+   }
+
+   AssertFatal(desc.mVolumeChannel < Audio::AudioVolumeChannels, "alxPlayVoice: invalid volume channel for source");
+   if(desc.mVolumeChannel >= Audio::AudioVolumeChannels)
+      return NULL_AUDIOHANDLE;
+
+   Resource<AudioBuffer> buffer = AudioBuffer::find(profile->getAudioFile());
+   if(!(bool)buffer)
+      return NULL_AUDIOHANDLE;
+
+   ALuint alBuffer = buffer->getALBuffer();
+   ALint frequency = 0;
+   ALint bits = 0;
+   ALint channels = 0;
+   ALint size = 0;
+   alGetBufferi(alBuffer, AL_FREQUENCY, &frequency);
+   alGetBufferi(alBuffer, AL_BITS, &bits);
+   alGetBufferi(alBuffer, AL_CHANNELS, &channels);
+   alGetBufferi(alBuffer, AL_SIZE, &size);
+   if(!frequency || !bits || !channels)
+   {
+      Con::errorf(ConsoleLogEntry::General, "alxPlayVoice: invalid buffer");
+      return NULL_AUDIOHANDLE;
+   }
+
+   AudioVoiceDesc voiceDesc;
+   voiceDesc.mBuffer             = alBuffer;
+   voiceDesc.mSampleRate         = frequency;
+   voiceDesc.mSampleCount        = size / ((bits / 8) * channels);
+   voiceDesc.mVolume             = desc.mVolume;
+   voiceDesc.mVolumeChannel      = desc.mVolumeChannel;
+   voiceDesc.mIsLooping          = desc.mIsLooping;
+   voiceDesc.mIs3D               = desc.mIs3D && position != NULL;
+   voiceDesc.mReferenceDistance  = desc.mReferenceDistance;
+   voiceDesc.mMaxDistance        = desc.mMaxDistance;
+   voiceDesc.mPriority           = priority;
+   voiceDesc.mConeInsideAngle    = desc.mConeInsideAngle;
+   voiceDesc.mConeOutsideAngle   = desc.mConeOutsideAngle;
+   voiceDesc.mConeOutsideVolume  = desc.mConeOutsideVolume;
+   voiceDesc.mConeVector         = desc.mConeVector;
+
+   // ranks against the listener of the last update
+   AUDIOVOICE voice = mVoiceScheduler.play(voiceDesc, position ? *position : Point3F::Zero);
+   if(voice == NULL_AUDIOVOICE)
+      return NULL_AUDIOHANDLE;
+
+   mVoiceDevice.retain(voice, buffer);
+   return voice | AUDIOHANDLE_VOICE_BIT;
+}
+
+void alxVoicePriority(AUDIOHANDLE handle, S32 priority)
+{
+   if(isVoiceHandle(handle))
+      mVoiceScheduler.setPriority(toVoice(handle), priority);
+}
+
+bool alxIsVirtualVoice(AUDIOHANDLE handle)
+{
+   return isVoiceHandle(handle) && mVoiceScheduler.isVirtual(toVoice(handle));
+}
+
+void alxVoiceUpdate()
+{
+   U32 updateTime = Platform::getRealMilliseconds();
+   F32 dt = mVoiceUpdateTime ? (updateTime - mVoiceUpdateTime) * 0.001f : 0.f;
+   mVoiceUpdateTime = updateTime;
+
+   Point3F listener;
+   alxGetListenerPoint3F(AL_POSITION, &listener);
+
+   mVoiceScheduler.setVolumes(mAudioChannelVolumes, Audio::AudioVolumeChannels, mMasterVolume);
+   mVoiceScheduler.update(dt, listener);
+
+#ifdef TORQUE_GATHER_METRICS
+   Con::setIntVariable("Audio::numVoices",         mVoiceScheduler.getVoiceCount());
+   Con::setIntVariable("Audio::numRealVoices",     mVoiceScheduler.getRealVoiceCount());
+   Con::setIntVariable("Audio::numVoiceSteals",    mVoiceScheduler.getStealCount());
+#endif
+}
+
 // Namespace: Audio ---------------------------------------------------------
 namespace Audio
 {
@@ -2528,6 +2958,14 @@ bool OpenALInit()
    }	
    mNumSources = mRequestSources;
 
+   // virtual voices play on the same sources
+   mVoiceScheduler.setDevice(&mVoiceDevice);
+   mVoiceScheduler.setVolumes(mAudioChannelVolumes, Audio::AudioVolumeChannels, mMasterVolume);
+   mVoiceUpdateTime = 0;
+
+   mStreamThread = new AudioStreamThread();
+   mStreamThread->startThread();
+
    // invalidate all existing handles
    dMemset(mHandle, NULL_AUDIOHANDLE, sizeof(mHandle));
 
@@ -2551,6 +2989,14 @@ void OpenALShutdown()
 {
    alxStopAll();
 
+   // the streams are closed, the thread still holds on to the context
+   if(mStreamThread)
+   {
+      mStreamThread->stopThread();
+      delete mStreamThread;
+      mStreamThread = NULL;
+   }
+
    //if(mInitialized)
    {
       alxEnvironmentDestroy();
@@ -2586,6 +3032,10 @@ void OpenALShutdown()
 	   }
    }
 
+   // the voices let go of the sources before they are deleted
+   mVoiceScheduler.setDevice(NULL);
+   mVoiceDevice.mBuffers.clear();
+
    alDeleteSources(mNumSources, mSource);
 
    if (mContext)
@@ -22,6 +22,7 @@
 
 #include "platform/platformAL.h"
 #include "audio/audioBuffer.h"
+#include "audio/audioStreamDecoder.h"
 #include "io/stream.h"
 #include "console/console.h"
 #include "memory/frameAllocator.h"
@@ -38,66 +39,6 @@
 
 //#define LOG_SOUND_LOADS
 
-/// WAV File-header
-struct WAVFileHdr
-{
-  ALubyte  id[4];
-  ALsizei  size;
-  ALubyte  type[4];
-};
-
-//// WAV Fmt-header
-struct WAVFmtHdr
-{
-  ALushort format;
-  ALushort channels;
-  ALuint   samplesPerSec;
-  ALuint   bytesPerSec;
-  ALushort blockAlign;
-  ALushort bitsPerSample;
-};
-
-/// WAV FmtEx-header
-struct WAVFmtExHdr
-{
-  ALushort size;
-  ALushort samplesPerBlock;
-};
-
-/// WAV Smpl-header
-struct WAVSmplHdr
-{
-  ALuint   manufacturer;
-  ALuint   product;
-  ALuint   samplePeriod;
-  ALuint   note;
-  ALuint   fineTune;
-  ALuint   SMPTEFormat;
-  ALuint   SMPTEOffest;
-  ALuint   loops;
-  ALuint   samplerData;
-  struct
-  {
-    ALuint identifier;
-    ALuint type;
-    ALuint start;
-    ALuint end;
-    ALuint fraction;
-    ALuint count;
-  }      loop[1];
-};
-
-/// WAV Chunk-header
-struct WAVChunkHdr
-{
-  ALubyte  id[4];
-  ALuint   size;
-};
-
-#define CHUNKSIZE 4096
-
-
-
 //--------------------------------------
 AudioBuffer::AudioBuffer(StringTableEntry filename)
 {
@@ -244,143 +185,36 @@ ALuint AudioBuffer::getALBuffer()
    return 0;
 }
 
+ALenum AudioBuffer::getALFormat(U32 channels, U32 bitsPerSample)
+{
+   if (channels == 1)
+      return (bitsPerSample == 8 ? AL_FORMAT_MONO8 : AL_FORMAT_MONO16);
+   return (bitsPerSample == 8 ? AL_FORMAT_STEREO8 : AL_FORMAT_STEREO16);
+}
+
 /*!   The Read a WAV file from the given ResourceObject and initialize
-      an alBuffer with it.
+      an alBuffer with it. PCM and IMA ADPCM are supported, see
+      WavStreamDecoder.
 */
 bool AudioBuffer::readWAV(ResourceObject *obj)
 {
-   WAVChunkHdr chunkHdr;
-   WAVFmtExHdr fmtExHdr;
-   WAVFileHdr  fileHdr;
-   WAVSmplHdr  smplHdr;
-   WAVFmtHdr   fmtHdr;
-
-   ALenum  format = AL_FORMAT_MONO16;
-   char   *data   = NULL;
-   ALsizei size   = 0;
-   ALsizei freq   = 22050;
-   ALboolean loop = AL_FALSE;
-
    Stream *stream = ResourceManager->openStream(obj);
    if (!stream)
       return false;
 
-   stream->read(4, &fileHdr.id[0]);
-   stream->read(&fileHdr.size);
-   stream->read(4, &fileHdr.type[0]);
-
-   fileHdr.size=((fileHdr.size+1)&~1)-4;
-
-   stream->read(4, &chunkHdr.id[0]);
-   stream->read(&chunkHdr.size);
-   // unread chunk data rounded up to nearest WORD
-   S32 chunkRemaining = chunkHdr.size + (chunkHdr.size&1);
-
-   while ((fileHdr.size!=0) && (stream->getStatus() != Stream::EOS))
-   {
-      // WAV Format header
-      if (!dStrncmp((const char*)chunkHdr.id,"fmt ",4))
-      {
-         stream->read(&fmtHdr.format);
-         stream->read(&fmtHdr.channels);
-         stream->read(&fmtHdr.samplesPerSec);
-         stream->read(&fmtHdr.bytesPerSec);
-         stream->read(&fmtHdr.blockAlign);
-         stream->read(&fmtHdr.bitsPerSample);
-
-         if (fmtHdr.format==0x0001)
-         {
-            format=(fmtHdr.channels==1?
-               (fmtHdr.bitsPerSample==8?AL_FORMAT_MONO8:AL_FORMAT_MONO16):
-               (fmtHdr.bitsPerSample==8?AL_FORMAT_STEREO8:AL_FORMAT_STEREO16));
-            freq=fmtHdr.samplesPerSec;
-            chunkRemaining -= sizeof(WAVFmtHdr);
-         }
-         else
-         {
-            stream->read(sizeof(WAVFmtExHdr), &fmtExHdr);
-            chunkRemaining -= sizeof(WAVFmtExHdr);
-         }
-      }
-      // WAV Format header
-      else if (!dStrncmp((const char*)chunkHdr.id,"data",4))
-      {
-         if (fmtHdr.format==0x0001)
-         {
-            size=chunkHdr.size;
-            data=new char[chunkHdr.size];
-            if (data)
-            {
-               stream->read(chunkHdr.size, data);
-#if defined(TORQUE_BIG_ENDIAN)
-               // need to endian-flip the 16-bit data.
-               if (fmtHdr.bitsPerSample==16) // !!!TBD we don't handle stereo, so may be RL flipped.
-               {
-                  U16 *ds = (U16*)data;
-                  U16 *de = (U16*)(data+size);
-                  while (ds<de)
-                  {
-#if defined(TORQUE_BIG_ENDIAN)
-                     *ds = convertLEndianToHost(*ds);
-#else
-                     *ds = convertBEndianToHost(*ds);
-#endif
-                     ds++;
-                  }
-               }
-#endif
-               chunkRemaining -= chunkHdr.size;
-            }
-            else
-               break;
-         }
-         else if (fmtHdr.format==0x0011)
-         {
-            //IMA ADPCM
-         }
-         else if (fmtHdr.format==0x0055)
-         {
-            //MP3 WAVE
-         }
-      }
-      // WAV Loop header
-      else if (!dStrncmp((const char*)chunkHdr.id,"smpl",4))
-      {
-         // this struct read is NOT endian safe but it is ok because
-         // we are only testing the loops field against ZERO
-         stream->read(sizeof(WAVSmplHdr), &smplHdr);
-         loop = (smplHdr.loops ? AL_TRUE : AL_FALSE);
-         chunkRemaining -= sizeof(WAVSmplHdr);
-      }
-
-      // either we have unread chunk data or we found an unknown chunk type
-      // loop and read up to 1K bytes at a time until we have
-      // read to the end of this chunk
-      char buffer[1024];
-      AssertFatal(chunkRemaining >= 0, "AudioBuffer::readWAV: remaining chunk data should never be less than zero.");
-      while (chunkRemaining > 0)
-      {
-         S32 readSize = getMin(1024, chunkRemaining);
-         stream->read(readSize, buffer);
-         chunkRemaining -= readSize;
-      }
-
-      fileHdr.size-=(((chunkHdr.size+1)&~1)+8);
+   WavStreamDecoder decoder(stream, true);
+   if (!decoder.isValid())
+      return false;
 
-      // read next chunk header...
-      stream->read(4, &chunkHdr.id[0]);
-      stream->read(&chunkHdr.size);
-      // unread chunk data rounded up to nearest WORD
-      chunkRemaining = chunkHdr.size + (chunkHdr.size&1);
-   }
+   const AudioStreamFormat& format = decoder.getFormat();
+   U32 size = decoder.getFrameCount() * format.getFrameSize();
+   if (size == 0)
+      return false;
 
-   ResourceManager->closeStream(stream);
-   if (data)
-   {
-      alBufferData(malBuffer, format, data, size, freq);
-      delete [] data;
-      return (alGetError() == AL_NO_ERROR);
-   }
+   char *data = new char[size];
+   size = decoder.read(data, size);
 
-   return false;
-}
\ No newline at end of file
+   alBufferData(malBuffer, getALFormat(format.mChannels, format.mBitsPerSample), data, size, format.mSampleRate);
+   delete [] data;
+   return (size > 0 && alGetError() == AL_NO_ERROR);
+}
@@ -44,7 +44,6 @@ private:
    bool              mLoading;
    ALuint            malBuffer;
 
-   bool readRIFFchunk(Stream &s, const char *seekLabel, U32 *size);
    bool readWAV(ResourceObject *obj);
 
 public:
@@ -56,6 +55,9 @@ public:
    static Resource<AudioBuffer> find(const char *filename);
    static ResourceInstance* construct(Stream& stream);
 
+   /// OpenAL format of interleaved PCM.
+   static ALenum getALFormat(U32 channels, U32 bitsPerSample);
+
 };
 
 
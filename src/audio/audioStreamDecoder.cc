@@ -0,0 +1,324 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2013 GarageGames, LLC
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//-----------------------------------------------------------------------------
+
+#include "audio/audioStreamDecoder.h"
+#include "io/stream.h"
+#include "io/resource/resourceManager.h"
+
+#ifndef _MMATH_H_
+#include "math/mMath.h"
+#endif
+
+//--------------------------------------------------------------------------
+// IMA ADPCM
+//--------------------------------------------------------------------------
+
+static const S32 imaIndexTable[16] =
+{
+   -1, -1, -1, -1, 2, 4, 6, 8,
+   -1, -1, -1, -1, 2, 4, 6, 8
+};
+
+static const S32 imaStepTable[89] =
+{
+   7, 8, 9, 10, 11, 12, 13, 14, 16, 17,
+   19, 21, 23, 25, 28, 31, 34, 37, 41, 45,
+   50, 55, 60, 66, 73, 80, 88, 97, 107, 118,
+   130, 143, 157, 173, 190, 209, 230, 253, 279, 307,
+   337, 371, 408, 449, 494, 544, 598, 658, 724, 796,
+   876, 963, 1060, 1166, 1282, 1411, 1552, 1707, 1878, 2066,
+   2272, 2499, 2749, 3024, 3327, 3660, 4026, 4428, 4871, 5358,
+   5894, 6484, 7132, 7845, 8630, 9493, 10442, 11487, 12635, 13899,
+   15289, 16818, 18500, 20350, 22385, 24623, 27086, 29794, 32767
+};
+
+static inline S16 decodeIMANibble(U32 nibble, S32& predictor, S32& index)
+{
+   S32 step = imaStepTable[index];
+   S32 diff = step >> 3;
+   if(nibble & 1)
+      diff += step >> 2;
+   if(nibble & 2)
+      diff += step >> 1;
+   if(nibble & 4)
+      diff += step;
+
+   predictor += (nibble & 8) ? -diff : diff;
+   predictor = mClamp(predictor, -32768, 32767);
+   index = mClamp(index + imaIndexTable[nibble], 0, 88);
+   return (S16)predictor;
+}
+
+// A block starts with a header per channel (first sample, step index and a
+// reserved byte), then 4 byte words alternate between the channels, each
+// holding 8 samples low nibble first.
+U32 WavStreamDecoder::decodeIMABlock(const U8* data, U32 blockAlign, U32 channels, S16* out)
+{
+   const U32 headerSize = 4 * channels;
+   if(channels == 0 || channels > 2 || blockAlign < headerSize)
+      return 0;
+
+   S32 predictor[2];
+   S32 index[2];
+   for(U32 c = 0; c < channels; c++)
+   {
+      predictor[c] = (S16)(data[0] | (data[1] << 8));
+      index[c] = mClamp((S32)data[2], 0, 88);
+      out[c] = (S16)predictor[c];
+      data += 4;
+   }
+
+   const U32 words = (blockAlign - headerSize) / headerSize;
+   for(U32 w = 0; w < words; w++)
+   {
+      for(U32 c = 0; c < channels; c++)
+      {
+         S16* dst = out + (1 + w * 8) * channels + c;
+         for(U32 b = 0; b < 4; b++)
+         {
+            U8 byte = *data++;
+            dst[(b * 2) * channels]     = decodeIMANibble(byte & 0x0f, predictor[c], index[c]);
+            dst[(b * 2 + 1) * channels] = decodeIMANibble(byte >> 4, predictor[c], index[c]);
+         }
+      }
+   }
+
+   return 1 + words * 8;
+}
+
+//--------------------------------------------------------------------------
+// WavStreamDecoder
+//--------------------------------------------------------------------------
+
+WavStreamDecoder::WavStreamDecoder(Stream* stream, bool closeStream)
+{
+   mStream = stream;
+   mCloseStream = closeStream;
+   mEncoding = 0;
+   mBlockAlign = 0;
+   mSamplesPerBlock = 0;
+   mDataStart = 0;
+   mDataSize = 0;
+   mDataLeft = 0;
+   mFrameCount = 0;
+   mFramesLeft = 0;
+   mBlock = NULL;
+   mBlockData = NULL;
+   mBlockFrames = 0;
+   mBlockPosition = 0;
+   dMemset(&mFormat, 0, sizeof(mFormat));
+
+   mValid = mStream && parseHeader();
+   if(!mValid)
+      return;
+
+   if(mEncoding == FormatIMAADPCM)
+   {
+      mBlock = new S16[mSamplesPerBlock * mFormat.mChannels];
+      mBlockData = new U8[mBlockAlign];
+   }
+
+   rewind();
+}
+
+WavStreamDecoder::~WavStreamDecoder()
+{
+   delete [] mBlock;
+   delete [] mBlockData;
+
+   if(mCloseStream && mStream)
+      ResourceManager->closeStream(mStream);
+}
+
+bool WavStreamDecoder::parseHeader()
+{
+   U8 id[4];
+   U32 size;
+
+   if(!mStream->read(4, id) || dStrncmp((const char*)id, "RIFF", 4))
+      return false;
+   mStream->read(&size);
+   if(!mStream->read(4, id) || dStrncmp((const char*)id, "WAVE", 4))
+      return false;
+
+   bool haveFormat = false;
+   bool haveData = false;
+   bool haveFact = false;
+   U32 factFrames = 0;
+   U32 bitsPerSample = 0;
+
+   // chunks are word aligned, data is the last one we care about
+   while(!haveData && mStream->read(4, id) && mStream->read(&size))
+   {
+      U32 next = mStream->getPosition() + size + (size & 1);
+
+      if(!dStrncmp((const char*)id, "fmt ", 4))
+      {
+         U16 encoding, channels, blockAlign, bits;
+         U32 sampleRate, bytesPerSec;
+         mStream->read(&encoding);
+         mStream->read(&channels);
+         mStream->read(&sampleRate);
+         mStream->read(&bytesPerSec);
+         mStream->read(&blockAlign);
+         mStream->read(&bits);
+
+         mEncoding = encoding;
+         mFormat.mChannels = channels;
+         mFormat.mSampleRate = sampleRate;
+         mBlockAlign = blockAlign;
+         bitsPerSample = bits;
+         haveFormat = true;
+      }
+      else if(!dStrncmp((const char*)id, "fact", 4))
+      {
+         mStream->read(&factFrames);
+         haveFact = true;
+      }
+      else if(!dStrncmp((const char*)id, "data", 4))
+      {
+         mDataStart = mStream->getPosition();
+         mDataSize = size;
+         haveData = true;
+         break;
+      }
+
+      if(!mStream->setPosition(next))
+         return false;
+   }
+
+   if(!haveFormat || !haveData || mFormat.mChannels < 1 || mFormat.mChannels > 2 || mFormat.mSampleRate == 0)
+      return false;
+
+   if(mEncoding == FormatPCM)
+   {
+      if(bitsPerSample != 8 && bitsPerSample != 16)
+         return false;
+
+      mFormat.mBitsPerSample = bitsPerSample;
+      mFrameCount = mDataSize / mFormat.getFrameSize();
+      return true;
+   }
+
+   if(mEncoding == FormatIMAADPCM)
+   {
+      const U32 headerSize = 4 * mFormat.mChannels;
+      if(bitsPerSample != 4 || mBlockAlign <= headerSize)
+         return false;
+
+      // decoded to 16 bit, the fact chunk trims the padding of the last block
+      mFormat.mBitsPerSample = 16;
+      mSamplesPerBlock = 1 + ((mBlockAlign - headerSize) / headerSize) * 8;
+
+      const U32 remainder = mDataSize % mBlockAlign;
+      mFrameCount = (mDataSize / mBlockAlign) * mSamplesPerBlock;
+      if(remainder >= headerSize)
+         mFrameCount += 1 + ((remainder - headerSize) / headerSize) * 8;
+      if(haveFact)
+         mFrameCount = getMin(mFrameCount, factFrames);
+      return true;
+   }
+
+   return false;
+}
+
+bool WavStreamDecoder::rewind()
+{
+   if(!mValid || !mStream->setPosition(mDataStart))
+      return false;
+
+   mDataLeft = mDataSize;
+   mFramesLeft = mFrameCount;
+   mBlockFrames = 0;
+   mBlockPosition = 0;
+   return true;
+}
+
+bool WavStreamDecoder::decodeBlock()
+{
+   U32 bytes = getMin(mBlockAlign, mDataLeft);
+   if(bytes < 4 * mFormat.mChannels || !mStream->read(bytes, mBlockData))
+      return false;
+
+   mDataLeft -= bytes;
+   mBlockFrames = decodeIMABlock(mBlockData, bytes, mFormat.mChannels, mBlock);
+   mBlockPosition = 0;
+   return mBlockFrames > 0;
+}
+
+U32 WavStreamDecoder::readPCM(U8* buffer, U32 frames)
+{
+   U32 bytes = getMin(frames * mFormat.getFrameSize(), mDataLeft);
+   bytes -= bytes % mFormat.getFrameSize();
+   if(bytes == 0 || !mStream->read(bytes, buffer))
+      return 0;
+
+   mDataLeft -= bytes;
+
+#if defined(TORQUE_BIG_ENDIAN)
+   if(mFormat.mBitsPerSample == 16)
+   {
+      U16* samples = (U16*)buffer;
+      for(U32 i = 0; i < bytes / 2; i++)
+         samples[i] = convertLEndianToHost(samples[i]);
+   }
+#endif
+
+   return bytes / mFormat.getFrameSize();
+}
+
+U32 WavStreamDecoder::readADPCM(S16* buffer, U32 frames)
+{
+   const U32 channels = mFormat.mChannels;
+
+   U32 done = 0;
+   while(done < frames)
+   {
+      if(mBlockPosition == mBlockFrames && !decodeBlock())
+         break;
+
+      U32 count = getMin(frames - done, mBlockFrames - mBlockPosition);
+      dMemcpy(buffer + done * channels, mBlock + mBlockPosition * channels, count * channels * sizeof(S16));
+      mBlockPosition += count;
+      done += count;
+   }
+
+   return done;
+}
+
+U32 WavStreamDecoder::read(void* buffer, U32 bytes)
+{
+   if(!mValid)
+      return 0;
+
+   U32 frames = getMin(bytes / mFormat.getFrameSize(), mFramesLeft);
+   if(frames == 0)
+      return 0;
+
+   if(mEncoding == FormatIMAADPCM)
+      frames = readADPCM((S16*)buffer, frames);
+   else
+      frames = readPCM((U8*)buffer, frames);
+
+   mFramesLeft -= frames;
+   return frames * mFormat.getFrameSize();
+}
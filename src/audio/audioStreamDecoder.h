@@ -0,0 +1,124 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2013 GarageGames, LLC
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//-----------------------------------------------------------------------------
+
+#ifndef _AUDIO_STREAM_DECODER_H_
+#define _AUDIO_STREAM_DECODER_H_
+
+#ifndef _PLATFORM_H_
+#include "platform/platform.h"
+#endif
+
+#include "platform/platformLibrary.h"
+
+class Stream;
+
+//--------------------------------------------------------------------------
+
+struct AudioStreamFormat
+{
+   U32 mChannels;
+   U32 mBitsPerSample;
+   U32 mSampleRate;
+
+   U32 getFrameSize() const { return mChannels * (mBitsPerSample / 8); }
+};
+
+// Turns a file into PCM a chunk at a time. Decoders are created on the main
+// thread and then only used by the audio stream thread.
+class DLL_PUBLIC AudioStreamDecoder
+{
+   public:
+      virtual ~AudioStreamDecoder() { }
+
+      virtual bool isValid() const = 0;
+      virtual const AudioStreamFormat& getFormat() const = 0;
+
+      /// Length in sample frames.
+      virtual U32 getFrameCount() const = 0;
+
+      /// Decode up to bytes of PCM, whole frames only. Returns the bytes
+      /// written, zero at the end of the stream.
+      virtual U32 read(void* buffer, U32 bytes) = 0;
+
+      virtual bool rewind() = 0;
+};
+
+//--------------------------------------------------------------------------
+// WAV streams, PCM (8 or 16 bit) and IMA ADPCM (4:1 compressed, decoded to
+// 16 bit). Mono or stereo.
+//--------------------------------------------------------------------------
+
+class DLL_PUBLIC WavStreamDecoder : public AudioStreamDecoder
+{
+   public:
+      enum
+      {
+         FormatPCM      = 0x0001,
+         FormatIMAADPCM = 0x0011
+      };
+
+   protected:
+      Stream*              mStream;
+      bool                 mCloseStream;
+      bool                 mValid;
+
+      AudioStreamFormat    mFormat;
+      U32                  mEncoding;
+      U32                  mBlockAlign;
+      U32                  mSamplesPerBlock;
+
+      U32                  mDataStart;
+      U32                  mDataSize;
+      U32                  mDataLeft;
+      U32                  mFrameCount;
+      U32                  mFramesLeft;
+
+      // decoded ADPCM block, interleaved
+      S16*                 mBlock;
+      U8*                  mBlockData;
+      U32                  mBlockFrames;
+      U32                  mBlockPosition;
+
+      bool parseHeader();
+      bool decodeBlock();
+      U32 readPCM(U8* buffer, U32 frames);
+      U32 readADPCM(S16* buffer, U32 frames);
+
+   public:
+      /// With closeStream the stream goes back to the ResourceManager when
+      /// the decoder is deleted.
+      WavStreamDecoder(Stream* stream, bool closeStream);
+      virtual ~WavStreamDecoder();
+
+      virtual bool isValid() const                       { return mValid; }
+      virtual const AudioStreamFormat& getFormat() const { return mFormat; }
+      virtual U32 getFrameCount() const                  { return mFrameCount; }
+      virtual U32 read(void* buffer, U32 bytes);
+      virtual bool rewind();
+
+      U32 getEncoding() const                            { return mEncoding; }
+
+      /// Decode one IMA ADPCM block of blockAlign bytes.
+      static U32 decodeIMABlock(const U8* data, U32 blockAlign, U32 channels, S16* out);
+};
+
+#endif // _AUDIO_STREAM_DECODER_H_
@@ -56,12 +56,14 @@ class AudioStreamSource
         virtual bool initStream() = 0;
         virtual bool updateBuffers() = 0;
         virtual void freeStream() = 0;
+        virtual void startStream() { }
       virtual F32 getElapsedTime() = 0;
       virtual F32 getTotalTime() = 0;
         //void clear();
 
         AUDIOHANDLE             mHandle;
         ALuint				    mSource;
+        U32                     mStreamId;      // on the audio stream thread, 0 when closed
 
         Audio::Description      mDescription;
         AudioSampleEnvironment *mEnvironment;
@@ -0,0 +1,341 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2013 GarageGames, LLC
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//-----------------------------------------------------------------------------
+
+#include "audio/audioStreamThread.h"
+#include "debug/timelineProfiler.h"
+
+//--------------------------------------------------------------------------
+
+AudioStreamThread::AudioStreamThread(U32 period)
+   : Thread(0, 0, false),
+     mCommands(QueueCapacity),
+     mEvents(QueueCapacity),
+     mFenceSignal(0),
+     mNextStream(0),
+     mPeriod(period),
+     mRunning(false),
+     mUnderruns(0),
+     mBuffersQueued(0)
+{
+   mChunk = new U8[ChunkBytes];
+}
+
+AudioStreamThread::~AudioStreamThread()
+{
+   stopThread();
+   delete [] mChunk;
+}
+
+void AudioStreamThread::startThread()
+{
+   if(mRunning)
+      return;
+
+   mRunning = true;
+   Thread::start();
+}
+
+void AudioStreamThread::stopThread()
+{
+   if(mRunning)
+   {
+      stop();
+      join();
+      mRunning = false;
+   }
+
+   // whatever is left is ours to clean up now
+   processCommands();
+   while(mStreams.size())
+      closeStream(mStreams.size() - 1);
+}
+
+void AudioStreamThread::run(void *arg)
+{
+   TimelineProfiler::setThreadName("Audio Streams");
+
+   while(!checkForStop())
+   {
+      service();
+      Platform::sleep(mPeriod);
+   }
+}
+
+//--------------------------------------------------------------------------
+
+void AudioStreamThread::post(const Command& command)
+{
+   // the thread drains the queue every pass, so this only spins under a flood
+   while(!mCommands.push(command))
+   {
+      if(mRunning)
+         Platform::sleep(1);
+      else
+         processCommands();
+   }
+}
+
+U32 AudioStreamThread::open(AudioStreamDecoder* decoder, AudioStreamQueue* queue, bool looping)
+{
+   AssertFatal(decoder && queue, "AudioStreamThread::open - missing decoder or queue.");
+
+   if(++mNextStream == 0)
+      ++mNextStream;
+
+   Command command;
+   command.mType = OpenStream;
+   command.mStream = mNextStream;
+   command.mDecoder = decoder;
+   command.mQueue = queue;
+   command.mFlag = looping;
+   post(command);
+
+   return mNextStream;
+}
+
+void AudioStreamThread::start(U32 stream)
+{
+   Command command;
+   command.mType = StartStream;
+   command.mStream = stream;
+   command.mDecoder = NULL;
+   command.mQueue = NULL;
+   command.mFlag = true;
+   post(command);
+}
+
+void AudioStreamThread::setLooping(U32 stream, bool looping)
+{
+   Command command;
+   command.mType = LoopStream;
+   command.mStream = stream;
+   command.mDecoder = NULL;
+   command.mQueue = NULL;
+   command.mFlag = looping;
+   post(command);
+}
+
+void AudioStreamThread::close(U32 stream)
+{
+   Command command;
+   command.mType = CloseStream;
+   command.mStream = stream;
+   command.mDecoder = NULL;
+   command.mQueue = NULL;
+   command.mFlag = false;
+   post(command);
+
+   flush();
+}
+
+void AudioStreamThread::flush()
+{
+   if(!mRunning)
+   {
+      processCommands();
+      return;
+   }
+
+   Command command;
+   command.mType = Fence;
+   command.mStream = 0;
+   command.mDecoder = NULL;
+   command.mQueue = NULL;
+   command.mFlag = false;
+   post(command);
+
+   mFenceSignal.acquire();
+}
+
+//--------------------------------------------------------------------------
+
+S32 AudioStreamThread::findStream(U32 id) const
+{
+   for(U32 i = 0; i < mStreams.size(); i++)
+   {
+      if(mStreams[i].mId == id)
+         return i;
+   }
+
+   return -1;
+}
+
+void AudioStreamThread::closeStream(U32 index)
+{
+   StreamState& stream = mStreams[index];
+   stream.mQueue->stop();
+   delete stream.mQueue;
+   delete stream.mDecoder;
+   mStreams.erase_fast(index);
+}
+
+void AudioStreamThread::processCommands()
+{
+   Command command;
+   while(mCommands.pop(command))
+   {
+      if(command.mType == OpenStream)
+      {
+         StreamState stream;
+         stream.mId = command.mStream;
+         stream.mDecoder = command.mDecoder;
+         stream.mQueue = command.mQueue;
+         stream.mLooping = command.mFlag;
+         stream.mPlaying = false;
+         stream.mStarted = false;
+         stream.mDecoded = false;
+         mStreams.push_back(stream);
+         continue;
+      }
+
+      if(command.mType == Fence)
+      {
+         mFenceSignal.release();
+         continue;
+      }
+
+      S32 index = findStream(command.mStream);
+      if(index < 0)
+         continue;
+
+      switch(command.mType)
+      {
+         case StartStream:
+            mStreams[index].mPlaying = true;
+            break;
+         case LoopStream:
+            mStreams[index].mLooping = command.mFlag;
+            break;
+         case CloseStream:
+            closeStream(index);
+            break;
+      }
+   }
+}
+
+// Fills mChunk, wrapping around looping streams.
+U32 AudioStreamThread::decodeChunk(StreamState& stream)
+{
+   const U32 frameSize = stream.mDecoder->getFormat().getFrameSize();
+   const U32 capacity = ChunkBytes - (ChunkBytes % frameSize);
+
+   U32 filled = 0;
+   bool rewound = false;
+   while(filled < capacity)
+   {
+      U32 bytes = stream.mDecoder->read(mChunk + filled, capacity - filled);
+      if(bytes)
+      {
+         filled += bytes;
+         rewound = false;
+         continue;
+      }
+
+      // nothing right after a rewind, a corrupt file would loop forever
+      if(!stream.mLooping || rewound || stream.mDecoder->getFrameCount() == 0 || !stream.mDecoder->rewind())
+      {
+         stream.mDecoded = true;
+         break;
+      }
+
+      rewound = true;
+   }
+
+   return filled;
+}
+
+// Returns false once the stream has played to the end.
+bool AudioStreamThread::serviceStream(StreamState& stream)
+{
+   AudioStreamQueue* queue = stream.mQueue;
+
+   U32 free = queue->reclaim();
+   while(free && !stream.mDecoded)
+   {
+      U32 bytes = decodeChunk(stream);
+      if(bytes == 0)
+         break;
+
+      if(!queue->submit(mChunk, bytes, stream.mDecoder->getFormat()))
+      {
+         stream.mDecoded = true;
+         break;
+      }
+
+      JobSystem::atomicAdd(&mBuffersQueued, 1);
+      free--;
+   }
+
+   if(!stream.mPlaying || !queue->isStopped())
+      return true;
+
+   if(queue->getQueuedCount())
+   {
+      // a device that stops with data left to play has run dry
+      if(stream.mStarted)
+      {
+         JobSystem::atomicAdd(&mUnderruns, 1);
+
+         Event event;
+         event.mType = StreamUnderrun;
+         event.mStream = stream.mId;
+         mEvents.push(event);
+      }
+
+      queue->play();
+      stream.mStarted = true;
+      return true;
+   }
+
+   return !stream.mDecoded;
+}
+
+void AudioStreamThread::service()
+{
+   PROFILE_SCOPE(AudioStreamThread_Service);
+
+   processCommands();
+
+   U32 i = 0;
+   while(i < mStreams.size())
+   {
+      if(serviceStream(mStreams[i]))
+      {
+         i++;
+         continue;
+      }
+
+      // the finished event is only sent once the queue is gone, retry next
+      // pass when there is no room for it
+      if(mEvents.getCount() >= mEvents.getCapacity())
+      {
+         i++;
+         continue;
+      }
+
+      Event event;
+      event.mType = StreamFinished;
+      event.mStream = mStreams[i].mId;
+      closeStream(i);
+      mEvents.push(event);
+   }
+}
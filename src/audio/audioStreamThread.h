@@ -0,0 +1,200 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2013 GarageGames, LLC
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//-----------------------------------------------------------------------------
+
+#ifndef _AUDIO_STREAM_THREAD_H_
+#define _AUDIO_STREAM_THREAD_H_
+
+#ifndef _PLATFORM_H_
+#include "platform/platform.h"
+#endif
+
+#ifndef _PLATFORM_THREADS_THREAD_H_
+#include "platform/threads/thread.h"
+#endif
+
+#ifndef _PLATFORM_THREAD_SEMAPHORE_H_
+#include "platform/threads/semaphore.h"
+#endif
+
+#ifndef _RING_BUFFER_H_
+#include "collection/ringBuffer.h"
+#endif
+
+#ifndef _AUDIO_STREAM_DECODER_H_
+#include "audio/audioStreamDecoder.h"
+#endif
+
+//--------------------------------------------------------------------------
+// Audio stream thread
+//--------------------------------------------------------------------------
+//
+//   Streams used to be refilled from alxUpdate, so a main loop frame longer
+//   than the queued audio starved them. Now a dedicated thread decodes and
+//   refills every stream every few milliseconds, however long the frames of
+//   the main thread are.
+//
+//   The main thread talks to the thread through a lock-free command queue.
+//   It gets events back (stream finished, stream ran dry) through another
+//   one and never waits, except close(), which returns once the thread has
+//   let go of the stream's device queue so its source can be reused.
+//
+//   Decoders and queues are handed over on open() and deleted by the thread.
+//
+//--------------------------------------------------------------------------
+
+// Device side of a stream, an OpenAL source and its buffers in the engine.
+// Only used from the stream thread.
+class DLL_PUBLIC AudioStreamQueue
+{
+   public:
+      virtual ~AudioStreamQueue() { }
+
+      /// Take back the buffers the device is done with. Returns how many
+      /// buffers can be filled.
+      virtual U32 reclaim() = 0;
+
+      /// Fill a free buffer and queue it.
+      virtual bool submit(const void* data, U32 bytes, const AudioStreamFormat& format) = 0;
+
+      /// Buffers queued and not reclaimed yet.
+      virtual U32 getQueuedCount() = 0;
+
+      /// Stopped or never started, but not paused.
+      virtual bool isStopped() = 0;
+
+      virtual void play() = 0;
+
+      /// Stop and drop everything queued.
+      virtual void stop() = 0;
+};
+
+class DLL_PUBLIC AudioStreamThread : public Thread
+{
+   public:
+      enum Constants
+      {
+         ChunkBytes        = 16384,    // about 90ms of 16 bit stereo at 44.1kHz
+         QueueCapacity     = 256,
+         DefaultPeriod     = 5         // ms between passes
+      };
+
+      enum EventType
+      {
+         StreamFinished,
+         StreamUnderrun
+      };
+
+      struct Event
+      {
+         U32   mType;
+         U32   mStream;
+      };
+
+   protected:
+      enum CommandType
+      {
+         OpenStream,
+         StartStream,
+         CloseStream,
+         LoopStream,
+         Fence
+      };
+
+      struct Command
+      {
+         U32                  mType;
+         U32                  mStream;
+         AudioStreamDecoder*  mDecoder;
+         AudioStreamQueue*    mQueue;
+         bool                 mFlag;
+      };
+
+      struct StreamState
+      {
+         U32                  mId;
+         AudioStreamDecoder*  mDecoder;
+         AudioStreamQueue*    mQueue;
+         bool                 mLooping;
+         bool                 mPlaying;      // asked to play
+         bool                 mStarted;      // the device has been started
+         bool                 mDecoded;      // no more data to queue
+      };
+
+      RingBuffer<Command>  mCommands;
+      RingBuffer<Event>    mEvents;
+      Semaphore            mFenceSignal;
+      U32                  mNextStream;
+      U32                  mPeriod;
+      bool                 mRunning;
+
+      // stream thread only
+      Vector<StreamState>  mStreams;
+      U8*                  mChunk;
+
+      volatile S32         mUnderruns;
+      volatile S32         mBuffersQueued;
+
+      void post(const Command& command);
+      void processCommands();
+      S32 findStream(U32 id) const;
+      void closeStream(U32 index);
+      U32 decodeChunk(StreamState& stream);
+      bool serviceStream(StreamState& stream);
+
+   public:
+      AudioStreamThread(U32 period = DefaultPeriod);
+      virtual ~AudioStreamThread();
+
+      /// Start and stop the thread. While it isn't running the caller does
+      /// the work in service().
+      void startThread();
+      void stopThread();
+      bool isRunning() const                    { return mRunning; }
+
+      virtual void run(void *arg = 0);
+
+      /// One pass over the commands and every stream.
+      void service();
+
+      /// @name Main thread
+      /// @{
+
+      /// Queue up a stream. It starts playing after start().
+      U32 open(AudioStreamDecoder* decoder, AudioStreamQueue* queue, bool looping);
+      void start(U32 stream);
+      void setLooping(U32 stream, bool looping);
+
+      /// Stop a stream. Blocks until the stream thread has stopped its queue.
+      void close(U32 stream);
+
+      /// Wait for every command posted so far to be processed.
+      void flush();
+
+      bool popEvent(Event& event)               { return mEvents.pop(event); }
+
+      /// @}
+
+      S32 getUnderrunCount() const              { return mUnderruns; }
+      S32 getBuffersQueued() const              { return mBuffersQueued; }
+};
+
+#endif // _AUDIO_STREAM_THREAD_H_
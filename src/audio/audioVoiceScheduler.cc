@@ -0,0 +1,620 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2013 GarageGames, LLC
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//-----------------------------------------------------------------------------
+
+#include "audio/audioVoiceScheduler.h"
+
+const F32 AudioVoiceScheduler::MinAudibility = 0.01f;
+const F32 AudioVoiceScheduler::StealMargin   = 0.05f;
+
+// Each priority step outranks the whole audibility range.
+#define VOICE_PRIORITY_SCALE  4.0f
+
+//--------------------------------------------------------------------------
+// AudioVoiceDesc
+//--------------------------------------------------------------------------
+
+AudioVoiceDesc::AudioVoiceDesc()
+{
+   mBuffer              = 0;
+   mSampleCount         = 0;
+   mSampleRate          = 44100;
+   mVolume              = 1.0f;
+   mVolumeChannel       = 0;
+   mIsLooping           = false;
+   mIs3D                = false;
+   mReferenceDistance   = 1.0f;
+   mMaxDistance         = 100.0f;
+   mPriority            = 0;
+   mConeInsideAngle     = 360;
+   mConeOutsideAngle    = 360;
+   mConeOutsideVolume   = 1.0f;
+   mConeVector.set(0.0f, 0.0f, 1.0f);
+}
+
+//--------------------------------------------------------------------------
+// AudioNullVoiceDevice
+//--------------------------------------------------------------------------
+
+AudioNullVoiceDevice::AudioNullVoiceDevice(U32 voiceCount)
+{
+   mPlayCount = 0;
+   mStopCount = 0;
+
+   mSlots.setSize(voiceCount);
+   for(U32 i = 0; i < voiceCount; i++)
+   {
+      dMemset(&mSlots[i], 0, sizeof(Slot));
+   }
+}
+
+void AudioNullVoiceDevice::advance(F32 seconds)
+{
+   for(U32 i = 0; i < mSlots.size(); i++)
+   {
+      Slot& slot = mSlots[i];
+      if(!slot.playing)
+         continue;
+
+      slot.offset += seconds * slot.rate;
+      if(slot.offset < slot.sampleCount)
+         continue;
+
+      if(slot.looping && slot.sampleCount > 0)
+         slot.offset = mFmodD(slot.offset, slot.sampleCount);
+      else
+         slot.playing = false;
+   }
+}
+
+void AudioNullVoiceDevice::play(U32 slot, const AudioVoice& voice, U32 offset)
+{
+   Slot& s        = mSlots[slot];
+   s.playing      = true;
+   s.looping      = voice.mDesc.mIsLooping;
+   s.offset       = offset;
+   s.rate         = voice.mDesc.mSampleRate * voice.mPitch;
+   s.sampleCount  = voice.mDesc.mSampleCount;
+   mPlayCount++;
+}
+
+void AudioNullVoiceDevice::update(U32 slot, const AudioVoice& voice, F32 gain)
+{
+   mSlots[slot].rate = voice.mDesc.mSampleRate * voice.mPitch;
+}
+
+U32 AudioNullVoiceDevice::stop(U32 slot)
+{
+   Slot& s     = mSlots[slot];
+   s.playing   = false;
+   mStopCount++;
+   return (U32)s.offset;
+}
+
+bool AudioNullVoiceDevice::getOffset(U32 slot, U32* offset)
+{
+   const Slot& s = mSlots[slot];
+   *offset = (U32)s.offset;
+   return s.playing;
+}
+
+//--------------------------------------------------------------------------
+// AudioVoiceScheduler
+//--------------------------------------------------------------------------
+
+AudioVoiceScheduler::AudioVoiceScheduler()
+{
+   mDevice           = NULL;
+   mChannelVolumes   = NULL;
+   mChannelCount     = 0;
+   mMasterVolume     = 1.0f;
+   mListener.set(0.0f, 0.0f, 0.0f);
+   mUpdateStamp      = 0;
+   mStealCount       = 0;
+   mResumeCount      = 0;
+}
+
+AudioVoiceScheduler::~AudioVoiceScheduler()
+{
+   stopAll();
+}
+
+void AudioVoiceScheduler::setDevice(AudioVoiceDevice* device)
+{
+   // Everything that was real goes virtual and keeps its position.
+   for(U32 i = 0; i < mSlotVoice.size(); i++)
+   {
+      if(mSlotVoice[i] >= 0)
+         unbind(mVoices[mSlotVoice[i]]);
+   }
+
+   mDevice = device;
+
+   U32 count = mDevice ? mDevice->getVoiceCount() : 0;
+   mSlotVoice.setSize(count);
+   mFreeSlots.setSize(count);
+   for(U32 i = 0; i < count; i++)
+   {
+      mSlotVoice[i] = -1;
+      mFreeSlots[i] = count - 1 - i;
+   }
+}
+
+void AudioVoiceScheduler::setVolumes(const F32* channelVolumes, U32 channelCount, F32 masterVolume)
+{
+   mChannelVolumes   = channelVolumes;
+   mChannelCount     = channelCount;
+   mMasterVolume     = masterVolume;
+}
+
+//--------------------------------------------------------------------------
+
+AudioVoice* AudioVoiceScheduler::find(AUDIOVOICE voice)
+{
+   U32 index = (voice & IndexMask) - 1;
+   if(voice == NULL_AUDIOVOICE || index >= mVoices.size())
+      return NULL;
+
+   AudioVoice& v = mVoices[index];
+   if(v.mState == Free || v.mGeneration != ((voice >> IndexBits) & GenerationMask))
+      return NULL;
+
+   return &v;
+}
+
+F32 AudioVoiceScheduler::getChannelVolume(U32 channel) const
+{
+   if(!mChannelVolumes || channel >= mChannelCount)
+      return 1.0f;
+
+   return mChannelVolumes[channel];
+}
+
+F32 AudioVoiceScheduler::computeAudibility(const AudioVoice& voice, const Point3F& listener) const
+{
+   const AudioVoiceDesc& desc = voice.mDesc;
+   F32 audibility = desc.mVolume * getChannelVolume(desc.mVolumeChannel);
+
+   // Linear falloff between the reference and max distance, like the
+   // source scores in audio.cc.
+   if(desc.mIs3D && audibility > 0.0f)
+   {
+      F32 distSq = (voice.mPosition - listener).lenSquared();
+      if(distSq >= desc.mMaxDistance * desc.mMaxDistance)
+         return 0.0f;
+
+      if(distSq > desc.mReferenceDistance * desc.mReferenceDistance)
+      {
+         F32 dist = mSqrt(distSq);
+         audibility *= (desc.mMaxDistance - dist) / (desc.mMaxDistance - desc.mReferenceDistance);
+      }
+   }
+
+   return audibility;
+}
+
+F32 AudioVoiceScheduler::computeRank(const AudioVoice& voice) const
+{
+   if(voice.mState != Playing || voice.mAudibility <= MinAudibility)
+      return -1.0f;
+
+   F32 rank = voice.mDesc.mPriority * VOICE_PRIORITY_SCALE + getMin(voice.mAudibility, 1.0f);
+   if(voice.mSlot >= 0)
+      rank += StealMargin;
+
+   return rank;
+}
+
+// Free slots the device hasn't lent out, -1 if there are none.
+S32 AudioVoiceScheduler::findFreeSlot() const
+{
+   for(S32 i = mFreeSlots.size() - 1; i >= 0; i--)
+   {
+      if(mDevice->isAvailable(mFreeSlots[i]))
+         return i;
+   }
+
+   return -1;
+}
+
+//--------------------------------------------------------------------------
+
+void AudioVoiceScheduler::bind(AudioVoice& voice)
+{
+   S32 free = findFreeSlot();
+   AssertFatal(voice.mSlot < 0 && free >= 0, "AudioVoiceScheduler::bind - no free slot.");
+
+   U32 slot = mFreeSlots[free];
+   mFreeSlots.erase_fast(free);
+
+   if(voice.mOffset > 0.0)
+      mResumeCount++;
+
+   voice.mSlot = slot;
+   mSlotVoice[slot] = voice.mIndex;
+
+   F32 gain = voice.mDesc.mVolume * getChannelVolume(voice.mDesc.mVolumeChannel) * mMasterVolume;
+   mDevice->play(slot, voice, (U32)voice.mOffset);
+   mDevice->update(slot, voice, gain);
+}
+
+void AudioVoiceScheduler::unbind(AudioVoice& voice)
+{
+   if(voice.mSlot < 0)
+      return;
+
+   U32 slot = voice.mSlot;
+   voice.mOffset = mDevice->stop(slot);
+   voice.mSlot = -1;
+
+   mSlotVoice[slot] = -1;
+   mFreeSlots.push_back(slot);
+}
+
+// Bind right away instead of waiting for the next update, stealing from the
+// weakest real voice when it is clearly outranked.
+bool AudioVoiceScheduler::tryBind(AudioVoice& voice)
+{
+   voice.mAudibility = computeAudibility(voice, mListener);
+   voice.mRank = computeRank(voice);
+   if(voice.mRank < 0.0f || mSlotVoice.empty())
+      return false;
+
+   if(findFreeSlot() < 0)
+   {
+      S32 weakest = -1;
+      for(U32 i = 0; i < mSlotVoice.size(); i++)
+      {
+         if(mSlotVoice[i] < 0)
+            continue;
+
+         if(weakest < 0 || mVoices[mSlotVoice[i]].mRank < mVoices[mSlotVoice[weakest]].mRank)
+            weakest = i;
+      }
+
+      // everything is lent out
+      if(weakest < 0)
+         return false;
+
+      AudioVoice& victim = mVoices[mSlotVoice[weakest]];
+      if(voice.mRank <= victim.mRank)
+         return false;
+
+      unbind(victim);
+      mStealCount++;
+   }
+
+   bind(voice);
+   voice.mRank += StealMargin;
+   return true;
+}
+
+void AudioVoiceScheduler::freeVoice(AudioVoice& voice)
+{
+   unbind(voice);
+
+   if(mDevice)
+      mDevice->release(voice);
+
+   voice.mState = Free;
+   voice.mGeneration = (voice.mGeneration + 1) & GenerationMask;
+
+   U32 activeIndex = voice.mActiveIndex;
+   mActive.erase_fast(activeIndex);
+   if(activeIndex < mActive.size())
+      mVoices[mActive[activeIndex]].mActiveIndex = activeIndex;
+
+   mFreeVoices.push_back(voice.mIndex);
+}
+
+//--------------------------------------------------------------------------
+
+AUDIOVOICE AudioVoiceScheduler::play(const AudioVoiceDesc& desc, const Point3F& position, F32 pitch)
+{
+   U32 index;
+   if(mFreeVoices.size())
+   {
+      index = mFreeVoices.last();
+      mFreeVoices.pop_back();
+   }
+   else
+   {
+      if(mVoices.size() >= IndexMask)
+         return NULL_AUDIOVOICE;
+
+      index = mVoices.size();
+      mVoices.increment();
+      mVoices[index].mGeneration = 0;
+   }
+
+   AudioVoice& voice = mVoices[index];
+   voice.mDesc = desc;
+   voice.mDesc.mPriority = mClamp(desc.mPriority, 0, (S32)MaxPriority);
+   voice.mPosition = position;
+   voice.mPitch = pitch;
+   voice.mOffset = 0.0;
+   voice.mAudibility = 0.0f;
+   voice.mRank = -1.0f;
+   voice.mSlot = -1;
+   voice.mIndex = index;
+   voice.mActiveIndex = mActive.size();
+   voice.mSelectStamp = 0;
+   voice.mState = Playing;
+   mActive.push_back(index);
+
+   tryBind(voice);
+
+   return (voice.mGeneration << IndexBits) | (index + 1);
+}
+
+void AudioVoiceScheduler::stop(AUDIOVOICE voice)
+{
+   AudioVoice* v = find(voice);
+   if(v)
+      freeVoice(*v);
+}
+
+void AudioVoiceScheduler::stopAll()
+{
+   while(mActive.size())
+      freeVoice(mVoices[mActive.last()]);
+}
+
+void AudioVoiceScheduler::pause(AUDIOVOICE voice)
+{
+   AudioVoice* v = find(voice);
+   if(!v || v->mState != Playing)
+      return;
+
+   // Paused voices give their real voice back.
+   unbind(*v);
+   v->mState = Paused;
+   v->mRank = -1.0f;
+}
+
+void AudioVoiceScheduler::resume(AUDIOVOICE voice)
+{
+   AudioVoice* v = find(voice);
+   if(!v || v->mState != Paused)
+      return;
+
+   v->mState = Playing;
+   tryBind(*v);
+}
+
+void AudioVoiceScheduler::setPosition(AUDIOVOICE voice, const Point3F& position)
+{
+   AudioVoice* v = find(voice);
+   if(v)
+      v->mPosition = position;
+}
+
+void AudioVoiceScheduler::setVolume(AUDIOVOICE voice, F32 volume)
+{
+   AudioVoice* v = find(voice);
+   if(v)
+      v->mDesc.mVolume = volume;
+}
+
+void AudioVoiceScheduler::setPitch(AUDIOVOICE voice, F32 pitch)
+{
+   AudioVoice* v = find(voice);
+   if(v)
+      v->mPitch = pitch;
+}
+
+void AudioVoiceScheduler::setPriority(AUDIOVOICE voice, S32 priority)
+{
+   AudioVoice* v = find(voice);
+   if(v)
+      v->mDesc.mPriority = mClamp(priority, 0, (S32)MaxPriority);
+}
+
+void AudioVoiceScheduler::evict(U32 slot)
+{
+   if(slot >= mSlotVoice.size() || mSlotVoice[slot] < 0)
+      return;
+
+   unbind(mVoices[mSlotVoice[slot]]);
+   mStealCount++;
+}
+
+const AudioVoice* AudioVoiceScheduler::getSlotVoice(U32 slot) const
+{
+   if(slot >= mSlotVoice.size() || mSlotVoice[slot] < 0)
+      return NULL;
+
+   return &mVoices[mSlotVoice[slot]];
+}
+
+bool AudioVoiceScheduler::isVirtual(AUDIOVOICE voice)
+{
+   AudioVoice* v = find(voice);
+   return v && v->mSlot < 0;
+}
+
+bool AudioVoiceScheduler::isPaused(AUDIOVOICE voice)
+{
+   AudioVoice* v = find(voice);
+   return v && v->mState == Paused;
+}
+
+U32 AudioVoiceScheduler::getOffset(AUDIOVOICE voice)
+{
+   AudioVoice* v = find(voice);
+   if(!v)
+      return 0;
+
+   U32 offset;
+   if(v->mSlot >= 0 && mDevice->getOffset(v->mSlot, &offset))
+      return offset;
+
+   return (U32)v->mOffset;
+}
+
+U32 AudioVoiceScheduler::getRealVoiceCount() const
+{
+   return mSlotVoice.size() - mFreeSlots.size();
+}
+
+//--------------------------------------------------------------------------
+
+// Keeps the best ranked voices in mSelected, a min heap the size of the
+// device, so ranking is O(voices * log(real voices)) with no full sort.
+void AudioVoiceScheduler::select(U32 capacity)
+{
+   mSelected.clear();
+   if(capacity == 0)
+      return;
+
+   for(U32 i = 0; i < mActive.size(); i++)
+   {
+      U32 index = mActive[i];
+      F32 rank = mVoices[index].mRank;
+      if(rank < 0.0f)
+         continue;
+
+      U32 pos;
+      if(mSelected.size() < capacity)
+      {
+         // sift up
+         pos = mSelected.size();
+         mSelected.push_back(index);
+         while(pos > 0)
+         {
+            U32 parent = (pos - 1) >> 1;
+            if(mVoices[mSelected[parent]].mRank <= rank)
+               break;
+            mSelected[pos] = mSelected[parent];
+            pos = parent;
+         }
+         mSelected[pos] = index;
+         continue;
+      }
+
+      if(rank <= mVoices[mSelected[0]].mRank)
+         continue;
+
+      // replace the root and sift down
+      pos = 0;
+      const U32 count = mSelected.size();
+      while(true)
+      {
+         U32 child = pos * 2 + 1;
+         if(child >= count)
+            break;
+         if(child + 1 < count && mVoices[mSelected[child + 1]].mRank < mVoices[mSelected[child]].mRank)
+            child++;
+         if(rank <= mVoices[mSelected[child]].mRank)
+            break;
+         mSelected[pos] = mSelected[child];
+         pos = child;
+      }
+      mSelected[pos] = index;
+   }
+}
+
+void AudioVoiceScheduler::update(F32 dt, const Point3F& listener)
+{
+   mListener = listener;
+   mUpdateStamp++;
+
+   // Real voices report their own progress, finished one-shots are dropped.
+   for(U32 slot = 0; slot < mSlotVoice.size(); slot++)
+   {
+      if(mSlotVoice[slot] < 0)
+         continue;
+
+      AudioVoice& voice = mVoices[mSlotVoice[slot]];
+      U32 offset;
+      if(mDevice->getOffset(slot, &offset))
+      {
+         voice.mOffset = offset;
+         continue;
+      }
+
+      voice.mOffset = voice.mDesc.mSampleCount;
+      freeVoice(voice);
+   }
+
+   // Virtual voices keep time on their own.
+   U32 i = 0;
+   while(i < mActive.size())
+   {
+      AudioVoice& voice = mVoices[mActive[i]];
+      if(voice.mState == Playing && voice.mSlot < 0)
+      {
+         voice.mOffset += (F64)dt * voice.mDesc.mSampleRate * voice.mPitch;
+         if(voice.mOffset >= voice.mDesc.mSampleCount)
+         {
+            if(!voice.mDesc.mIsLooping || voice.mDesc.mSampleCount == 0)
+            {
+               // erase_fast moves another voice into this spot
+               freeVoice(voice);
+               continue;
+            }
+            voice.mOffset = mFmodD(voice.mOffset, voice.mDesc.mSampleCount);
+         }
+      }
+
+      voice.mAudibility = computeAudibility(voice, listener);
+      voice.mRank = computeRank(voice);
+      i++;
+   }
+
+   // lent slots are out of the running
+   U32 capacity = 0;
+   for(U32 slot = 0; slot < mSlotVoice.size(); slot++)
+      capacity += (mSlotVoice[slot] >= 0 || mDevice->isAvailable(slot));
+
+   select(capacity);
+   for(U32 j = 0; j < mSelected.size(); j++)
+      mVoices[mSelected[j]].mSelectStamp = mUpdateStamp;
+
+   // Steal first so the winners find free slots.
+   for(U32 slot = 0; slot < mSlotVoice.size(); slot++)
+   {
+      if(mSlotVoice[slot] < 0)
+         continue;
+
+      AudioVoice& voice = mVoices[mSlotVoice[slot]];
+      if(voice.mSelectStamp == mUpdateStamp)
+         continue;
+
+      // Voices that fell below MinAudibility weren't stolen from.
+      if(voice.mRank >= 0.0f)
+         mStealCount++;
+      unbind(voice);
+   }
+
+   for(U32 j = 0; j < mSelected.size(); j++)
+   {
+      AudioVoice& voice = mVoices[mSelected[j]];
+      if(voice.mSlot < 0)
+      {
+         bind(voice);
+         continue;
+      }
+
+      F32 gain = voice.mDesc.mVolume * getChannelVolume(voice.mDesc.mVolumeChannel) * mMasterVolume;
+      mDevice->update(voice.mSlot, voice, gain);
+   }
+}
@@ -0,0 +1,258 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2013 GarageGames, LLC
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//-----------------------------------------------------------------------------
+
+#ifndef _AUDIO_VOICE_SCHEDULER_H_
+#define _AUDIO_VOICE_SCHEDULER_H_
+
+#ifndef _MMATH_H_
+#include "math/mMath.h"
+#endif
+
+#ifndef _TVECTOR_H_
+#include "collection/vector.h"
+#endif
+
+#include "platform/platformLibrary.h"
+
+//--------------------------------------------------------------------------
+// Virtual voices
+//--------------------------------------------------------------------------
+//
+//   The device only has a handful of real voices (OpenAL sources) while a
+//   scene can ask for thousands of sounds. The scheduler hands out any
+//   number of logical voices, ranks them every update by priority and then
+//   by audibility (volume * channel gain * distance attenuation) and binds
+//   the top ones to real voices. The rest stay virtual: their playback
+//   position keeps advancing so a voice that wins a real voice back resumes
+//   where it would have been, and one-shots still end on time.
+//
+//   A voice that already owns a real voice gets a small bonus when ranked so
+//   two voices of about the same audibility don't keep stealing from each
+//   other. Voices below MinAudibility and paused voices never hold a real
+//   voice. Main thread only.
+//
+//   The device may lend real voices to something else, audio.cc shares its
+//   sources with looping and streaming sounds. Lent voices are skipped and
+//   evict() takes one back from the scheduler.
+//
+//--------------------------------------------------------------------------
+
+typedef U32 AUDIOVOICE;
+#define NULL_AUDIOVOICE 0
+
+struct AudioVoiceDesc
+{
+   U32   mBuffer;             // device buffer played by the voice
+   U32   mSampleCount;        // length in sample frames
+   U32   mSampleRate;
+
+   F32   mVolume;
+   U32   mVolumeChannel;
+   bool  mIsLooping;
+
+   bool  mIs3D;
+   F32   mReferenceDistance;
+   F32   mMaxDistance;
+
+   S32   mPriority;           // 0-255, outranks audibility
+
+   S32   mConeInsideAngle;
+   S32   mConeOutsideAngle;
+   F32   mConeOutsideVolume;
+   Point3F mConeVector;
+
+   AudioVoiceDesc();
+};
+
+struct AudioVoice
+{
+   AudioVoiceDesc mDesc;
+   Point3F        mPosition;
+   F32            mPitch;
+   F64            mOffset;    // sample frames played
+   F32            mAudibility;
+   F32            mRank;
+   S32            mSlot;      // real voice, -1 while virtual
+   U32            mIndex;
+   U32            mActiveIndex;
+   U32            mSelectStamp;
+   U16            mGeneration;
+   U8             mState;
+};
+
+// Real voices. AudioNullVoiceDevice plays nothing and stands in when there
+// is no audio device, and in tests.
+class DLL_PUBLIC AudioVoiceDevice
+{
+   public:
+      virtual ~AudioVoiceDevice() { }
+
+      virtual U32 getVoiceCount() const = 0;
+
+      /// False while the slot is lent to something else.
+      virtual bool isAvailable(U32 slot) { return true; }
+
+      /// Start playing a voice on a free slot from a sample offset.
+      virtual void play(U32 slot, const AudioVoice& voice, U32 offset) = 0;
+
+      /// Push position, gain and pitch of a playing voice.
+      virtual void update(U32 slot, const AudioVoice& voice, F32 gain) = 0;
+
+      /// Stop a slot, returns the sample offset it had reached.
+      virtual U32 stop(U32 slot) = 0;
+
+      /// Current sample offset of a slot, false once a one-shot has ended.
+      virtual bool getOffset(U32 slot, U32* offset) = 0;
+
+      /// The scheduler dropped a voice, release what the device held for it.
+      virtual void release(const AudioVoice& voice) { }
+};
+
+class DLL_PUBLIC AudioNullVoiceDevice : public AudioVoiceDevice
+{
+   protected:
+      struct Slot
+      {
+         bool  playing;
+         bool  looping;
+         F64   offset;
+         F64   rate;
+         U32   sampleCount;
+      };
+
+      Vector<Slot>   mSlots;
+
+   public:
+      U32            mPlayCount;
+      U32            mStopCount;
+
+      AudioNullVoiceDevice(U32 voiceCount);
+
+      /// Run the slots for some time, the mixer clock of a real device.
+      void advance(F32 seconds);
+
+      virtual U32 getVoiceCount() const { return mSlots.size(); }
+      virtual void play(U32 slot, const AudioVoice& voice, U32 offset);
+      virtual void update(U32 slot, const AudioVoice& voice, F32 gain);
+      virtual U32 stop(U32 slot);
+      virtual bool getOffset(U32 slot, U32* offset);
+};
+
+class DLL_PUBLIC AudioVoiceScheduler
+{
+   public:
+      enum
+      {
+         MaxPriority    = 255,
+
+         // handles fit in 27 bits, the caller can flag them with the rest
+         IndexBits      = 16,
+         IndexMask      = (1 << IndexBits) - 1,
+         GenerationBits = 11,
+         GenerationMask = (1 << GenerationBits) - 1
+      };
+
+      enum State
+      {
+         Free,
+         Playing,
+         Paused
+      };
+
+      static const F32 MinAudibility;
+      static const F32 StealMargin;
+
+   protected:
+      AudioVoiceDevice*    mDevice;
+      Vector<AudioVoice>   mVoices;
+      Vector<U32>          mFreeVoices;
+      Vector<U32>          mActive;
+      Vector<S32>          mSlotVoice;
+      Vector<U32>          mFreeSlots;
+      Vector<U32>          mSelected;
+
+      const F32*           mChannelVolumes;
+      U32                  mChannelCount;
+      F32                  mMasterVolume;
+
+      Point3F              mListener;
+      U32                  mUpdateStamp;
+      U32                  mStealCount;
+      U32                  mResumeCount;
+
+      AudioVoice* find(AUDIOVOICE voice);
+      F32 getChannelVolume(U32 channel) const;
+      F32 computeAudibility(const AudioVoice& voice, const Point3F& listener) const;
+      F32 computeRank(const AudioVoice& voice) const;
+      S32 findFreeSlot() const;
+      void select(U32 capacity);
+      bool tryBind(AudioVoice& voice);
+      void bind(AudioVoice& voice);
+      void unbind(AudioVoice& voice);
+      void freeVoice(AudioVoice& voice);
+
+   public:
+      AudioVoiceScheduler();
+      ~AudioVoiceScheduler();
+
+      /// Real voices come from the device, NULL runs everything virtual.
+      void setDevice(AudioVoiceDevice* device);
+      AudioVoiceDevice* getDevice() const             { return mDevice; }
+
+      /// Channel gains are read on every update, the array is not copied.
+      void setVolumes(const F32* channelVolumes, U32 channelCount, F32 masterVolume);
+
+      AUDIOVOICE play(const AudioVoiceDesc& desc, const Point3F& position, F32 pitch = 1.0f);
+      void stop(AUDIOVOICE voice);
+      void stopAll();
+      void pause(AUDIOVOICE voice);
+      void resume(AUDIOVOICE voice);
+
+      void setPosition(AUDIOVOICE voice, const Point3F& position);
+      void setVolume(AUDIOVOICE voice, F32 volume);
+      void setPitch(AUDIOVOICE voice, F32 pitch);
+      void setPriority(AUDIOVOICE voice, S32 priority);
+
+      /// Take a real voice back for the device, its voice goes virtual.
+      void evict(U32 slot);
+
+      bool isValid(AUDIOVOICE voice)                  { return find(voice) != NULL; }
+      const AudioVoice* getVoice(AUDIOVOICE voice)    { return find(voice); }
+
+      /// Voice playing on a real voice, NULL if there is none.
+      const AudioVoice* getSlotVoice(U32 slot) const;
+      bool isVirtual(AUDIOVOICE voice);
+      bool isPaused(AUDIOVOICE voice);
+
+      /// Playback position in sample frames, real or virtual.
+      U32 getOffset(AUDIOVOICE voice);
+
+      /// Advance virtual voices by dt seconds and rebind the real voices.
+      void update(F32 dt, const Point3F& listener);
+
+      U32 getVoiceCount() const                       { return mActive.size(); }
+      U32 getRealVoiceCount() const;
+      U32 getStealCount() const                       { return mStealCount; }
+      U32 getResumeCount() const                      { return mResumeCount; }
+};
+
+#endif // _AUDIO_VOICE_SCHEDULER_H_
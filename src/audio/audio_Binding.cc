@@ -42,6 +42,10 @@
 #include "audio/AudioAsset.h"
 #endif
 
+#ifndef _GAMEINTERFACE_H_
+#include "game/gameInterface.h"
+#endif
+
 #ifdef TORQUE_OS_IOS
 #include "platformiOS/iOSStreamSource.h"
 #endif
@@ -175,6 +179,10 @@ ConsoleFunctionGroupBegin(Audio, "Functions dealing with the OpenAL audio layer.
 */
 ConsoleFunctionWithDocs(OpenALInitDriver, ConsoleBool, 1, 1, ())
 {
+   // Headless servers run without audio.
+   if (Game->isHeadless())
+      return false;
+
    if (Audio::OpenALInit())
    {
       static bool registered = false;
@@ -477,6 +485,48 @@ ConsoleFunctionWithDocs(alxPlay, ConsoleInt, 2, 2, (audio-assetId))
     return handle;
 }
 
+/*! Play an audio asset as a virtual voice. Any number of voices can play, the
+    highest priority and most audible ones are heard and the others keep time
+    until they are. alxPlay plays one-shots this way with the lowest priority.
+    Streamed assets can't be played as voices.
+    @param audio-assetId The asset Id to play.
+    @param position Optional "x y z" position of a 3D voice.
+    @param priority Optional priority from 0 to 255, higher priorities are always heard first.
+    @return The handle of the voice or 0 on error.
+    @sa alxStop, alxPlay
+*/
+ConsoleFunctionWithDocs(alxPlayVoice, ConsoleInt, 2, 4, (audio-assetId, [position]?, [priority]?))
+{
+    // Fetch asset Id.
+    const char* pAssetId = argv[1];
+
+    // Acquire audio asset.
+    AudioAsset* pAudioAsset = AssetDatabase.acquireAsset<AudioAsset>( pAssetId );
+
+    // Did we get the audio asset?
+    if ( pAudioAsset == NULL )
+    {
+        // No, so warn.
+        Con::warnf( "alxPlayVoice() - Could not find audio asset '%s'.", pAssetId );
+        return NULL_AUDIOHANDLE;
+    }
+
+    Point3F pos;
+    bool positioned = argc > 2 && dStrlen(argv[2]) > 0;
+    if ( positioned )
+        dSscanf(argv[2], "%g %g %g", &pos.x, &pos.y, &pos.z);
+
+    S32 priority = argc > 3 ? dAtoi(argv[3]) : 0;
+
+    // Fetch voice handle.
+    AUDIOHANDLE handle = alxPlayVoice( pAudioAsset, positioned ? &pos : NULL, priority );
+
+    // Release asset.
+    AssetDatabase.releaseAsset( pAssetId );
+
+    return handle;
+}
+
 /*! Use the alxPause function to pause a currently playing sound as specified by handle.
     @param handle The ID (a non-negative integer) corresponding to a previously set up sound source.
     @return No return value.
@@ -817,6 +867,9 @@ ConsoleFunctionWithDocs(setiOSAudioStreamVolume, ConsoleVoid, 3, 3, setiPhoneAud
 extern "C"{
    DLL_PUBLIC bool Audio_OpenALInitDriver()
    {
+      if (Game->isHeadless())
+         return false;
+
       if (Audio::OpenALInit())
       {
          static bool registered = false;
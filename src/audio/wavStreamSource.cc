@@ -28,89 +28,106 @@
 //--------------------------------------
 
 #include "audio/wavStreamSource.h"
+#include "audio/audioStreamThread.h"
+#include "console/console.h"
 
-#define BUFFERSIZE 32768
-
-typedef struct
-{
-    ALubyte		riff[4];		// 'RIFF'
-    ALsizei		riffSize;
-    ALubyte		wave[4];		// 'WAVE'
-    ALubyte		fmt[4];			// 'fmt '
-    ALuint		fmtSize;
-    ALushort	Format;
-    ALushort	Channels;
-    ALuint		SamplesPerSec;
-    ALuint		BytesPerSec;
-    ALushort	BlockAlign;
-    ALushort	BitsPerSample;
-    ALubyte		data[4];		// 'data'
-    ALuint		dataSize;
-} WAVE_Struct;
-
-/// WAV File-header
-struct WAVFileHdr
-{
-  ALubyte  id[4];
-  ALsizei  size;
-  ALubyte  type[4];
-};
-
-//// WAV Fmt-header
-struct WAVFmtHdr
-{
-  ALushort format;
-  ALushort channels;
-  ALuint   samplesPerSec;
-  ALuint   bytesPerSec;
-  ALushort blockAlign;
-  ALushort bitsPerSample;
-};
-
-/// WAV FmtEx-header
-struct WAVFmtExHdr
-{
-  ALushort size;
-  ALushort samplesPerBlock;
-};
-
-/// WAV Smpl-header
-struct WAVSmplHdr
+//--------------------------------------------------------------------------
+// OpenAL buffer queue of a source, filled from the stream thread.
+class ALStreamQueue : public AudioStreamQueue
 {
-  ALuint   manufacturer;
-  ALuint   product;
-  ALuint   samplePeriod;
-  ALuint   note;
-  ALuint   fineTune;
-  ALuint   SMPTEFormat;
-  ALuint   SMPTEOffest;
-  ALuint   loops;
-  ALuint   samplerData;
-  struct
-  {
-    ALuint identifier;
-    ALuint type;
-    ALuint start;
-    ALuint end;
-    ALuint fraction;
-    ALuint count;
-  }      loop[1];
-};
+   private:
+      ALuint   mSource;
+      ALuint   mBuffers[NUMBUFFERS];
+      ALuint   mFree[NUMBUFFERS];
+      U32      mFreeCount;
+      U32      mQueued;
+      bool     mValid;
+
+      void resetFreeList()
+      {
+         for(U32 i = 0; i < NUMBUFFERS; i++)
+            mFree[i] = mBuffers[NUMBUFFERS - 1 - i];
+         mFreeCount = NUMBUFFERS;
+         mQueued = 0;
+      }
+
+   public:
+      ALStreamQueue(ALuint source) : mSource(source), mFreeCount(0), mQueued(0)
+      {
+         alGetError();
+         alGenBuffers(NUMBUFFERS, mBuffers);
+         mValid = (alGetError() == AL_NO_ERROR);
+         if(mValid)
+            resetFreeList();
+      }
+
+      virtual ~ALStreamQueue()
+      {
+         if(!mValid)
+            return;
+
+         stop();
+         alDeleteBuffers(NUMBUFFERS, mBuffers);
+      }
+
+      bool isValid() const { return mValid; }
+
+      virtual U32 reclaim()
+      {
+         ALint processed = 0;
+         alGetSourcei(mSource, AL_BUFFERS_PROCESSED, &processed);
+         while(processed-- > 0 && mQueued > 0)
+         {
+            ALuint buffer;
+            alSourceUnqueueBuffers(mSource, 1, &buffer);
+            mFree[mFreeCount++] = buffer;
+            mQueued--;
+         }
+         return mFreeCount;
+      }
+
+      virtual bool submit(const void* data, U32 bytes, const AudioStreamFormat& format)
+      {
+         if(mFreeCount == 0)
+            return false;
 
-/// WAV Chunk-header
-struct WAVChunkHdr
-{
-  ALubyte  id[4];
-  ALuint   size;
+         ALuint buffer = mFree[--mFreeCount];
+         alBufferData(buffer, AudioBuffer::getALFormat(format.mChannels, format.mBitsPerSample), data, bytes, format.mSampleRate);
+         alSourceQueueBuffers(mSource, 1, &buffer);
+         mQueued++;
+         return true;
+      }
+
+      virtual U32 getQueuedCount()
+      {
+         return mQueued;
+      }
+
+      virtual bool isStopped()
+      {
+         ALint state = AL_STOPPED;
+         alGetSourcei(mSource, AL_SOURCE_STATE, &state);
+         return (state == AL_STOPPED || state == AL_INITIAL);
+      }
+
+      virtual void play()
+      {
+         alSourcePlay(mSource);
+      }
+
+      virtual void stop()
+      {
+         alSourceStop(mSource);
+         alSourcei(mSource, AL_BUFFER, AL_NONE);
+         resetFreeList();
+      }
 };
 
-
-
+//--------------------------------------------------------------------------
 WavStreamSource::WavStreamSource(const char *filename)  {
-   stream = NULL;
+   bReady = false;
    bIsValid = false;
-   bBuffersAllocated = false;
-   mBufferList[0] = 0;
+   mStreamId = 0;
    clear();
 
    mFilename = filename;
@@ -124,17 +141,12 @@ WavStreamSource::~WavStreamSource() {
 
 void WavStreamSource::clear()
 {
-    if(stream)
+    if(bReady)
         freeStream();
 
     mHandle           = NULL_AUDIOHANDLE;
     mSource			  = NULL;
 
-    if(mBufferList[0] != 0)
-        alDeleteBuffers(NUMBUFFERS, mBufferList);
-    for(int i = 0; i < NUMBUFFERS; i++)
-        mBufferList[i] = 0;
-
     dMemset(&mDescription, 0, sizeof(Audio::Description));
     mEnvironment = 0;
     mPosition.set(0.f,0.f,0.f);
@@ -142,203 +154,78 @@ void WavStreamSource::clear()
     mPitch = 1.f;
     mScore = 0.f;
     mCullTime = 0;
+    mTotalTime = 0.f;
+    mStreamId = 0;
 
     bReady = false;
     bFinishedPlaying = false;
     bIsValid = false;
-    bBuffersAllocated = false;
 }
 
 bool WavStreamSource::initStream() {
-   WAVChunkHdr chunkHdr;
-   WAVFileHdr  fileHdr;
-   WAVFmtHdr   fmtHdr;
-
-   ALint			error;
+   AudioStreamThread* thread = alxGetStreamThread();
+   if(!thread)
+      return false;
 
-   bFinished = false;
-
-   char   data[BUFFERSIZE];
+   if(bReady)
+      freeStream();
 
+   // the stream thread does the queueing, the source itself never loops
    alSourceStop(mSource);
    alSourcei(mSource, AL_BUFFER, 0);
-
-    stream = ResourceManager->openStream(mFilename);
-    if(stream != NULL) {
-       stream->read(4, &fileHdr.id[0]);
-       stream->read(&fileHdr.size);
-       stream->read(4, &fileHdr.type[0]);
-
-       stream->read(4, &chunkHdr.id[0]);
-       stream->read(&chunkHdr.size);
-
-       // WAV Format header
-        stream->read(&fmtHdr.format);
-        stream->read(&fmtHdr.channels);
-        stream->read(&fmtHdr.samplesPerSec);
-        stream->read(&fmtHdr.bytesPerSec);
-        stream->read(&fmtHdr.blockAlign);
-        stream->read(&fmtHdr.bitsPerSample);
-
-        format=(fmtHdr.channels==1?
-           (fmtHdr.bitsPerSample==8?AL_FORMAT_MONO8:AL_FORMAT_MONO16):
-           (fmtHdr.bitsPerSample==8?AL_FORMAT_STEREO8:AL_FORMAT_STEREO16));
-        freq=fmtHdr.samplesPerSec;
-
-         stream->read(4, &chunkHdr.id[0]);
-         stream->read(&chunkHdr.size);
-
-        DataSize = chunkHdr.size;
-        DataLeft = DataSize;
-        dataStart = stream->getPosition();
-
-        // Clear Error Code
-        alGetError();
-
-        alGenBuffers(NUMBUFFERS, mBufferList);
-        if ((error = alGetError()) != AL_NO_ERROR) {
-            return false;
-        }
-
-        bBuffersAllocated = true;
-
-        int numBuffers = 0;
-        for(int loop = 0; loop < NUMBUFFERS; loop++)
-        {
-            ALuint DataToRead = (DataLeft > BUFFERSIZE) ? BUFFERSIZE : DataLeft;
-
-            if (DataToRead == DataLeft)
-                bFinished = AL_TRUE;
-            stream->read(DataToRead, data);
-            DataLeft -= DataToRead;
-            alBufferData(mBufferList[loop], format, data, DataToRead, freq);	
-            if ((error = alGetError()) != AL_NO_ERROR) {
-                return false;
-            }
-            ++numBuffers;
-            if(bFinished)
-                break;
-        }
-
-        // Queue the buffers on the source
-        alSourceQueueBuffers(mSource, numBuffers, mBufferList);
-        if ((error = alGetError()) != AL_NO_ERROR) {
-            return false;
-        }
-
-        buffersinqueue = numBuffers;
-        alSourcei(mSource, AL_LOOPING, AL_FALSE);
-        bReady = true;
-    }
-    else {
-        return false;
-    }
-
-    bIsValid = true;
+   alSourcei(mSource, AL_LOOPING, AL_FALSE);
+
+   Stream* stream = ResourceManager->openStream(mFilename);
+   if(stream == NULL)
+      return false;
+
+   WavStreamDecoder* decoder = new WavStreamDecoder(stream, true);
+   if(!decoder->isValid())
+   {
+      Con::warnf("WavStreamSource::initStream - %s is not a PCM or IMA ADPCM wav file.", mFilename);
+      delete decoder;
+      return false;
+   }
+
+   ALStreamQueue* queue = new ALStreamQueue(mSource);
+   if(!queue->isValid())
+   {
+      delete queue;
+      delete decoder;
+      return false;
+   }
+
+   mTotalTime = (F32)decoder->getFrameCount() / (F32)decoder->getFormat().mSampleRate;
+   mStreamId = thread->open(decoder, queue, mDescription.mIsLooping);
+
+   bFinishedPlaying = false;
+   bReady = true;
+   bIsValid = true;
 
    return true;
 }
 
 bool WavStreamSource::updateBuffers() {
-
-    ALint			processed;
-    ALuint			BufferID;
-    ALint			error;
-    char data[BUFFERSIZE];
-
-    // don't do anything if buffer isn't initialized
-    if(!bIsValid)
-        return false;
-
-    if(bFinished && mDescription.mIsLooping) {
-        resetStream();
-    }
-
-    // reset AL error code
-    alGetError();
-
-    // Get status
-    alGetSourcei(mSource, AL_BUFFERS_PROCESSED, &processed);
-
-    // If some buffers have been played, unqueue them and load new audio into them, then add them to the queue
-    if (processed > 0)
-    {
-
-        while (processed)
-        {
-            alSourceUnqueueBuffers(mSource, 1, &BufferID);
-            if ((error = alGetError()) != AL_NO_ERROR)
-                return false;
-
-            if (!bFinished)
-            {
-                ALuint DataToRead = (DataLeft > BUFFERSIZE) ? BUFFERSIZE : DataLeft;
-
-                if (DataToRead == DataLeft) {
-                    bFinished = AL_TRUE;
-                }
-                    
-                stream->read(DataToRead, data);
-                DataLeft -= DataToRead;
-                    
-                alBufferData(BufferID, format, data, DataToRead, freq);
-                if ((error = alGetError()) != AL_NO_ERROR)
-                    return false;
-
-                // Queue buffer
-                alSourceQueueBuffers(mSource, 1, &BufferID);
-                if ((error = alGetError()) != AL_NO_ERROR)
-                    return false;
-
-                processed--;
-
-                if(bFinished && mDescription.mIsLooping) {
-                    resetStream();
-                }
-            }
-            else
-            {
-                buffersinqueue--;
-                processed--;
-
-                if (buffersinqueue == 0)
-                {
-                    bFinishedPlaying = AL_TRUE;
-                    return AL_FALSE;
-                }
-            }
-        }
-    }
-
-    return AL_TRUE;
+    // the stream thread keeps the queue filled
+    return bIsValid && !bFinishedPlaying;
 }
 
 void WavStreamSource::freeStream() {
     bReady = false;
 
-    
-    if(stream != NULL)
-        ResourceManager->closeStream(stream);
-    stream = NULL;
-
-    if(bBuffersAllocated) {
-        if(mBufferList[0] != 0)
-            alDeleteBuffers(NUMBUFFERS, mBufferList);
-        for(int i = 0; i < NUMBUFFERS; i++)
-            mBufferList[i] = 0;
-
-        bBuffersAllocated = false;
-    }
+    // blocks until the stream thread let go of the source
+    AudioStreamThread* thread = alxGetStreamThread();
+    if(mStreamId != 0 && thread)
+        thread->close(mStreamId);
+    mStreamId = 0;
 }
 
-void WavStreamSource::resetStream() {
-    stream->setPosition(dataStart);
-    DataLeft = DataSize;
-    bFinished = AL_FALSE;
+void WavStreamSource::startStream() {
+    AudioStreamThread* thread = alxGetStreamThread();
+    if(mStreamId != 0 && thread)
+        thread->start(mStreamId);
 }
 
-#include "console/console.h"
-
 F32 WavStreamSource::getElapsedTime()
 {
    Con::warnf( "GetElapsedTime not implemented in WaveStreams yet" );
@@ -347,6 +234,5 @@ F32 WavStreamSource::getElapsedTime()
 
 F32 WavStreamSource::getTotalTime()
 {
-   Con::warnf( "GetTotalTime not implemented in WaveStreams yet" );
-   return -1.f;
+   return bIsValid ? mTotalTime : -1.f;
 }
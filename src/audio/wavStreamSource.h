@@ -27,6 +27,7 @@
 #include "audio/audioStreamSource.h"
 #endif
 
+// Plays WAV files, PCM or IMA ADPCM, through the audio stream thread.
 class WavStreamSource: public AudioStreamSource
 {
     public:
@@ -36,31 +37,15 @@ class WavStreamSource: public AudioStreamSource
         virtual bool initStream();
         virtual bool updateBuffers();
         virtual void freeStream();
+        virtual void startStream();
       virtual F32 getElapsedTime();
       virtual F32 getTotalTime();
 
     private:
-        ALuint				    mBufferList[NUMBUFFERS];
-        S32						mNumBuffers;
-        S32						mBufferSize;
-        Stream				   *stream;
-
         bool					bReady;
-        bool					bFinished;
-
-        ALenum  format;
-        ALsizei size;
-        ALsizei freq;
-
-        ALuint			DataSize;
-        ALuint			DataLeft;
-        ALuint			dataStart;
-        ALuint			buffersinqueue;
-
-        bool			bBuffersAllocated;
+        F32                     mTotalTime;
 
         void clear();
-        void resetStream();
 };
 
 #endif // _AUDIOSTREAMSOURCE_H_
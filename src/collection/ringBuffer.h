@@ -0,0 +1,102 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2013 GarageGames, LLC
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//-----------------------------------------------------------------------------
+
+#ifndef _RING_BUFFER_H_
+#define _RING_BUFFER_H_
+
+#ifndef _TORQUE_TYPES_H_
+#include "platform/types.h"
+#endif
+
+#ifndef _JOB_SYSTEM_H_
+#include "platform/threads/jobSystem.h"
+#endif
+
+//-------------------------------------------------------------------------------------
+// Lock-free single producer, single consumer queue of PODs. One thread pushes, one
+// other thread pops, neither ever blocks. The capacity is rounded up to a power of
+// two and never grows, push() fails when the queue is full.
+//
+// The counters only ever increase (and wrap). Each side publishes its counter with
+// an atomic add after touching the item, which is a full barrier, and reads the
+// other side's counter the same way.
+//-------------------------------------------------------------------------------------
+
+template <class T>
+class RingBuffer
+{
+protected:
+   T*             mItems;
+   U32            mMask;
+   volatile S32   mWrite;
+   volatile S32   mRead;
+
+   static U32 load(volatile S32* value) { return (U32)JobSystem::atomicAdd(value, 0); }
+
+public:
+   RingBuffer(U32 capacity)
+   {
+      U32 size = 1;
+      while(size < capacity)
+         size <<= 1;
+
+      mItems = new T[size];
+      mMask = size - 1;
+      mWrite = 0;
+      mRead = 0;
+   }
+
+   ~RingBuffer()
+   {
+      delete [] mItems;
+   }
+
+   /// Producer side.
+   bool push(const T& item)
+   {
+      U32 write = (U32)mWrite;
+      if(write - load(&mRead) > mMask)
+         return false;
+
+      mItems[write & mMask] = item;
+      JobSystem::atomicAdd(&mWrite, 1);
+      return true;
+   }
+
+   /// Consumer side.
+   bool pop(T& item)
+   {
+      U32 read = (U32)mRead;
+      if(read == load(&mWrite))
+         return false;
+
+      item = mItems[read & mMask];
+      JobSystem::atomicAdd(&mRead, 1);
+      return true;
+   }
+
+   /// Either side, a snapshot that may be stale by the time it returns.
+   U32 getCount() { return load(&mWrite) - load(&mRead); }
+   U32 getCapacity() const { return mMask + 1; }
+};
+
+#endif // _RING_BUFFER_H_
@@ -69,6 +69,46 @@ StringStack STR;
 U32 FLT = 0;
 U32 UINTS = 0;
 
+//------------------------------------------------------------
+
+enum FieldCacheConstants {
+   FieldCacheSize = 4096
+};
+
+/// Field resolved by one OP_SETCURFIELD callsite for one class.
+struct FieldCacheEntry
+{
+   const U32 *site;
+   StringTableEntry name;
+   AbstractClassRep *classRep;
+   const AbstractClassRep::Field *fieldList;
+   const AbstractClassRep::Field *field;
+};
+
+static FieldCacheEntry gFieldCache[FieldCacheSize];
+
+/// Resolve a static field, caching the result per callsite and class. Dynamic
+/// fields are cached too, as a NULL field.
+static const AbstractClassRep::Field *resolveField(const U32 *site, SimObject *object, StringTableEntry name)
+{
+   AbstractClassRep *classRep = object->getClassRep();
+   if(classRep == NULL)
+      return NULL;
+
+   FieldCacheEntry &entry = gFieldCache[(U32(dsize_t(site)) >> 2) & (FieldCacheSize - 1)];
+   // The field list address guards against it having been reallocated.
+   const AbstractClassRep::Field *fieldList = classRep->mFieldList.address();
+   if(entry.site == site && entry.name == name && entry.classRep == classRep && entry.fieldList == fieldList)
+      return entry.field;
+
+   entry.site = site;
+   entry.name = name;
+   entry.classRep = classRep;
+   entry.fieldList = fieldList;
+   entry.field = classRep->findField(name);
+   return entry.field;
+}
+
 static const char *getNamespaceList(Namespace *ns)
 {
    U32 size = 1;
@@ -550,6 +590,7 @@ const char *CodeBlock::exec(U32 ip, const char *functionName, Namespace *thisNam
    SimObject *currentNewObject = 0;
    StringTableEntry prevField = NULL;
    StringTableEntry curField = NULL;
+   const U32 *curFieldSite = NULL;
    SimObject *prevObject = NULL;
    SimObject *curObject = NULL;
    SimObject *saveObject=NULL;
@@ -1222,6 +1263,7 @@ breakContinue:
             prevField = curField;
             dStrcpy( prevFieldArray, curFieldArray );
             curField = CodeToSTE(code, ip);
+            curFieldSite = code + ip;
             curFieldArray[0] = 0;
             ip += 2;
             break;
@@ -1231,7 +1273,16 @@ breakContinue:
             break;
 
          case OP_LOADFIELD_UINT:
-            if(curObject)
+            if(curObject && gScriptFieldCache)
+            {
+               const AbstractClassRep::Field *field = resolveField(curFieldSite, curObject, curField);
+               F64 numeric;
+               if(curObject->getNumericDataField(field, curFieldArray, numeric))
+                  intStack[UINTS+1] = U32(S32(numeric));
+               else
+                  intStack[UINTS+1] = U32(dAtoi(curObject->getDataField(field, curField, curFieldArray)));
+            }
+            else if(curObject)
                intStack[UINTS+1] = U32(dAtoi(curObject->getDataField(curField, curFieldArray)));
             else
             {
@@ -1245,7 +1296,16 @@ breakContinue:
             break;
 
          case OP_LOADFIELD_FLT:
-            if(curObject)
+            if(curObject && gScriptFieldCache)
+            {
+               const AbstractClassRep::Field *field = resolveField(curFieldSite, curObject, curField);
+               F64 numeric;
+               if(curObject->getNumericDataField(field, curFieldArray, numeric))
+                  floatStack[FLT+1] = numeric;
+               else
+                  floatStack[FLT+1] = dAtof(curObject->getDataField(field, curField, curFieldArray));
+            }
+            else if(curObject)
                floatStack[FLT+1] = dAtof(curObject->getDataField(curField, curFieldArray));
             else
             {
@@ -1260,7 +1320,10 @@ breakContinue:
          case OP_LOADFIELD_STR:
             if(curObject)
             {
-               val = curObject->getDataField(curField, curFieldArray);
+               if(gScriptFieldCache)
+                  val = curObject->getDataField(resolveField(curFieldSite, curObject, curField), curField, curFieldArray);
+               else
+                  val = curObject->getDataField(curField, curFieldArray);
                STR.setStringValue( val );
             }
             else
@@ -1275,7 +1338,13 @@ breakContinue:
 
          case OP_SAVEFIELD_UINT:
             STR.setIntValue((U32)intStack[UINTS]);
-            if(curObject)
+            if(curObject && gScriptFieldCache)
+            {
+               const AbstractClassRep::Field *field = resolveField(curFieldSite, curObject, curField);
+               if(!curObject->setNumericDataField(field, curField, curFieldArray, S32(intStack[UINTS]), STR.getStringValue()))
+                  curObject->setDataField(field, curField, curFieldArray, STR.getStringValue());
+            }
+            else if(curObject)
                curObject->setDataField(curField, curFieldArray, STR.getStringValue());
             else
             {
@@ -1288,7 +1357,13 @@ breakContinue:
 
          case OP_SAVEFIELD_FLT:
             STR.setFloatValue(floatStack[FLT]);
-            if(curObject)
+            if(curObject && gScriptFieldCache)
+            {
+               const AbstractClassRep::Field *field = resolveField(curFieldSite, curObject, curField);
+               if(!curObject->setNumericDataField(field, curField, curFieldArray, floatStack[FLT], STR.getStringValue()))
+                  curObject->setDataField(field, curField, curFieldArray, STR.getStringValue());
+            }
+            else if(curObject)
                curObject->setDataField(curField, curFieldArray, STR.getStringValue());
             else
             {
@@ -1300,7 +1375,9 @@ breakContinue:
             break;
 
          case OP_SAVEFIELD_STR:
-            if(curObject)
+            if(curObject && gScriptFieldCache)
+               curObject->setDataField(resolveField(curFieldSite, curObject, curField), curField, curFieldArray, STR.getStringValue());
+            else if(curObject)
                curObject->setDataField(curField, curFieldArray, STR.getStringValue());
             else
             {
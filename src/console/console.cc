@@ -57,6 +57,7 @@ ExprEvalState gEvalState;
 StmtNode *statementList;
 ConsoleConstructor *ConsoleConstructor::first = NULL;
 bool gWarnUndefinedScriptVariables;
+bool gScriptFieldCache = true;
 
 static char scratchBuffer[4096];
 
@@ -256,6 +257,7 @@ void init()
    addVariable("Con::logBufferEnabled", TypeBool, &logBufferEnabled);
    addVariable("Con::printLevel", TypeS32, &printLevel);
    addVariable("Con::warnUndefinedVariables", TypeBool, &gWarnUndefinedScriptVariables);
+   addVariable("Con::fieldCache", TypeBool, &gScriptFieldCache);
 
    // Current script file name and root
    Con::addVariable( "Con::File", TypeString, &gCurrentFile );
@@ -1273,6 +1275,48 @@ StringTableEntry getModNameFromPath(const char *path)
 typedef HashMap<StringTableEntry, StringTableEntry> typePathExpandoMap;
 static typePathExpandoMap PathExpandos;
 
+// Working directories pushed by the main thread, innermost last.
+static Vector<StringTableEntry> WorkingDirectories;
+
+//-----------------------------------------------------------------------------
+
+void pushWorkingDirectory( const char* pPath )
+{
+    // Sanity!
+    AssertFatal( pPath != NULL, "Working directory cannot be NULL." );
+
+    // Ignore other threads.
+    if ( !isMainThread() )
+        return;
+
+    WorkingDirectories.push_back( StringTable->insert( pPath ) );
+}
+
+//-----------------------------------------------------------------------------
+
+void popWorkingDirectory( void )
+{
+    // Ignore other threads.
+    if ( !isMainThread() )
+        return;
+
+    // Sanity!
+    AssertFatal( WorkingDirectories.size() > 0, "No working directory to pop." );
+
+    WorkingDirectories.pop_back();
+}
+
+//-----------------------------------------------------------------------------
+
+StringTableEntry getWorkingDirectory( void )
+{
+    // Other threads always see the process directory.
+    if ( !isMainThread() || WorkingDirectories.size() == 0 )
+        return Platform::getCurrentDirectory();
+
+    return WorkingDirectories.last();
+}
+
 //-----------------------------------------------------------------------------
 
 void addPathExpando( const char* pExpandoName, const char* pPath )
@@ -1589,11 +1633,11 @@ bool expandPath( char* pDstPath, U32 size, const char* pSrcPath, const char* pWo
     //Using a special case here because the code below barfs on trying to build a full path for apk reading
  #ifdef TORQUE_OS_ANDROID
     	if (leadingToken == '/' || strstr(pSrcPath, "/") == NULL)
-    		Platform::makeFullPathName( pSrcPath, pathBuffer, sizeof(pathBuffer), pWorkingDirectoryHint );
+    		Platform::makeFullPathName( pSrcPath, pathBuffer, sizeof(pathBuffer), pWorkingDirectoryHint != NULL ? pWorkingDirectoryHint : getWorkingDirectory() );
     	else
     		dSprintf(pathBuffer, sizeof(pathBuffer), "/%s", pSrcPath);
 #else
- 	  Platform::makeFullPathName( pSrcPath, pathBuffer, sizeof(pathBuffer), pWorkingDirectoryHint );
+ 	  Platform::makeFullPathName( pSrcPath, pathBuffer, sizeof(pathBuffer), pWorkingDirectoryHint != NULL ? pWorkingDirectoryHint : getWorkingDirectory() );
 #endif
 
     // Are we ensuring the trailing slash?
@@ -1675,7 +1719,7 @@ void collapsePath( char* pDstPath, U32 size, const char* pSrcPath, const char* p
     }
 
     // Fetch the working directory.
-    StringTableEntry workingDirectory = pWorkingDirectoryHint != NULL ? pWorkingDirectoryHint : Platform::getCurrentDirectory();
+    StringTableEntry workingDirectory = pWorkingDirectoryHint != NULL ? pWorkingDirectoryHint : getWorkingDirectory();
 
     // Fetch path relative to current directory.
     StringTableEntry relativePath = Platform::makeRelativePathName( pSrcPath, workingDirectory );
@@ -41,6 +41,11 @@ class Namespace;
 /// @note This is set and controlled by script.
 extern bool gWarnUndefinedScriptVariables;
 
+/// Indicates that the script VM caches field lookups per callsite.
+///
+/// @note This is set and controlled by script.
+extern bool gScriptFieldCache;
+
 enum StringTableConstants
 {
    StringTagPrefixByte = 0x01 ///< Magic value prefixed to tagged strings.
@@ -305,6 +310,15 @@ namespace Con
    /// @param  pSrcPath    Original, possibly relative path.
    bool expandPath( char* pDstPath, U32 size, const char* pSrcPath, const char* pWorkingDirectoryHint = NULL, const bool ensureTrailingSlash = false );
    void collapsePath( char* pDstPath, U32 size, const char* pSrcPath, const char* pWorkingDirectoryHint = NULL );
+
+   /// Relative paths expanded or collapsed on the main thread without a working directory
+   /// hint use the innermost pushed working directory, or the process one when none is pushed.
+   /// Unlike changing the process directory this doesn't affect other threads, which always
+   /// use the process directory and ignore pushes and pops.
+   void pushWorkingDirectory( const char* pPath );
+   void popWorkingDirectory( void );
+   StringTableEntry getWorkingDirectory( void );
+
    bool isBasePath( const char* SrcPath, const char* pBasePath );
    void ensureTrailingSlash( char* pDstPath, const char* pSrcPath );
    bool stripRepeatSlashes( char* pDstPath, const char* pSrcPath, S32 dstSize );
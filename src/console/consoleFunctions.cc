@@ -33,10 +33,6 @@
 #include "taggedStrings_Binding.h"
 #include "inputManagement_Binding.h"
 
-#ifdef TORQUE_ALLOW_JOURNALING
-   static U32 journalDepth = 1;
-#endif
-
 //Luma:	Console function to tell if this is a TORQUE_OS_IOS build
 ConsoleFunction(isiPhoneBuild, bool, 1, 1, "Returns true if this is a iPhone build, false otherwise")
 {
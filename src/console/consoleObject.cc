@@ -40,7 +40,32 @@ U32                                AbstractClassRep::classCRC[NetClassGroupsCoun
 bool                               AbstractClassRep::initialized = false;
 
 //--------------------------------------
+static inline U32 hashFieldName(StringTableEntry name)
+{
+   // Field names are string table entries so the pointer is the key.
+   U32 hash = (U32)((dsize_t)name >> 2);
+   hash ^= hash >> 16;
+   hash *= 0x45d9f3b;
+   hash ^= hash >> 16;
+   return hash;
+}
+
 const AbstractClassRep::Field *AbstractClassRep::findField(StringTableEntry name) const
+{
+   if(mFieldTableList != mFieldList.address() || mFieldTableCount != mFieldList.size())
+      return findFieldLinear(name);
+
+   for(U32 slot = hashFieldName(name) & mFieldTableMask; ; slot = (slot + 1) & mFieldTableMask)
+   {
+      const S32 index = mFieldTable[slot];
+      if(index < 0)
+         return NULL;
+      if(mFieldList[index].pFieldname == name)
+         return &mFieldList[index];
+   }
+}
+
+const AbstractClassRep::Field *AbstractClassRep::findFieldLinear(StringTableEntry name) const
 {
    for(U32 i = 0; i < (U32)mFieldList.size(); i++)
       if(mFieldList[i].pFieldname == name)
@@ -49,6 +74,34 @@ const AbstractClassRep::Field *AbstractClassRep::findField(StringTableEntry name
    return NULL;
 }
 
+void AbstractClassRep::buildFieldTable()
+{
+   // At most half full so probes stay short.
+   U32 size = 8;
+   while(size < (U32)mFieldList.size() * 2)
+      size <<= 1;
+
+   mFieldTable.setSize(size);
+   for(U32 i = 0; i < size; i++)
+      mFieldTable[i] = -1;
+   mFieldTableMask = size - 1;
+
+   for(S32 i = 0; i < mFieldList.size(); i++)
+   {
+      StringTableEntry name = mFieldList[i].pFieldname;
+      U32 slot = hashFieldName(name) & mFieldTableMask;
+      while(mFieldTable[slot] >= 0 && mFieldList[mFieldTable[slot]].pFieldname != name)
+         slot = (slot + 1) & mFieldTableMask;
+
+      // Like the linear scan, the first field with a name wins.
+      if(mFieldTable[slot] < 0)
+         mFieldTable[slot] = i;
+   }
+
+   mFieldTableList   = mFieldList.address();
+   mFieldTableCount  = mFieldList.size();
+}
+
 //-----------------------------------------------------------------------------
 
 AbstractClassRep* AbstractClassRep::findFieldRoot( StringTableEntry fieldName )
@@ -204,6 +257,8 @@ void AbstractClassRep::initialize()
 
       // And of course delete it every round.
       sg_tempFieldList.clear();
+
+      walk->buildFieldTable();
    }
 
    // Calculate counts and bit sizes for the various NetClasses.
@@ -251,6 +251,17 @@ public:
 
     bool mDynamicGroupExpand;
 
+protected:
+    /// Open addressed index of mFieldList keyed by field name, which already
+    /// includes the inherited fields. Built once the field list is final;
+    /// findField() scans the list while it's out of date.
+    Vector<S32>    mFieldTable;
+    U32            mFieldTableMask;
+    const Field*   mFieldTableList;
+    S32            mFieldTableCount;
+
+public:
+
     static U32  NetClassCount [NetClassGroupsCount][NetClassTypesCount];
     static U32  NetClassBitSize[NetClassGroupsCount][NetClassTypesCount];
 
@@ -264,7 +275,10 @@ public:
     AbstractClassRep() 
     {
         VECTOR_SET_ASSOCIATION(mFieldList);
-        parentClass  = NULL;
+        parentClass       = NULL;
+        mFieldTableMask   = 0;
+        mFieldTableList   = NULL;
+        mFieldTableCount  = 0;
     }
     virtual ~AbstractClassRep() { }
 
@@ -303,6 +317,8 @@ public:
 public:
     virtual ConsoleObject* create() const = 0;
     const Field *findField(StringTableEntry fieldName) const;
+    const Field *findFieldLinear(StringTableEntry fieldName) const;
+    void buildFieldTable();
     AbstractClassRep* findFieldRoot( StringTableEntry fieldName );
     AbstractClassRep* findContainerChildRoot( AbstractClassRep* pChild );
 
@@ -36,11 +36,19 @@
 
 #include "c-interface/c-interface.h"
 
+#ifdef TORQUE_ALLOW_JOURNALING
+#include "game/gameInterface.h"
+#endif
+
 // Buffer for expanding script filenames.
 static char pathBuffer[1024];
 
 static U32 execDepth = 0;
 
+#ifdef TORQUE_ALLOW_JOURNALING
+static U32 journalDepth = 1;
+#endif
+
 extern S32 QSORT_CALLBACK ACRCompare(const void *aptr, const void *bptr);
 
 ConsoleFunctionGroupBegin(MetaScripting, "Functions that let you manipulate the scripting engine programmatically.");
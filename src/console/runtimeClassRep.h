@@ -129,6 +129,8 @@ public:
       // And of course delete it every round.
       sg_tempFieldList.clear();
 
+      buildFieldTable();
+
       smConRegistered = true;
    }
 
@@ -0,0 +1,483 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2013 GarageGames, LLC
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//-----------------------------------------------------------------------------
+
+#include "debug/perfReplay.h"
+#include "platform/platform.h"
+#include "platform/platformServerScheduler.h"
+#include "game/gameInterface.h"
+#include "game/processList.h"
+#include "console/console.h"
+#include "collection/vector.h"
+#include "io/fileStream.h"
+#include "math/mMathFn.h"
+
+#include "rapidjson/document.h"
+
+// Script bindings.
+#include "perfReplay_Binding.h"
+
+//------------------------------------------------------------------------------
+
+bool PerfReplay::smRecording = false;
+
+struct PerfZoneRecord
+{
+   const char*    name;
+   U32            depth;
+
+   // Accumulated for the frame in progress, in microseconds.
+   U64            frameTime;
+   U32            frameCalls;
+
+   // One entry per finished frame.
+   Vector<F32>    times;
+   Vector<U32>    calls;
+};
+
+struct PerfOpenZone
+{
+   S32 index;
+   U64 start;
+};
+
+struct PerfStats
+{
+   F32 mean;
+   F32 p50;
+   F32 p95;
+   F32 p99;
+   F32 max;
+};
+
+static Vector<PerfZoneRecord*>   sZones;
+static Vector<PerfOpenZone>      sZoneStack;
+static Vector<F32>               sFrameTimes;
+static U64                       sFrameStart    = 0;
+static bool                      sTimeStepped   = false;
+static bool                      sActive        = false;
+
+static char                      sJournal[1024]    = { 0 };
+static char                      sReport[1024]     = { 0 };
+static char                      sBaseline[1024]   = { 0 };
+static F32                       sThreshold        = 10.0f;
+static F32                       sMinMs            = 0.05f;
+static U32                       sTimeStep         = TickMs;
+
+//------------------------------------------------------------------------------
+
+static S32 QSORT_CALLBACK compareSample(const void* a, const void* b)
+{
+   const F32 fa = *(const F32*)a;
+   const F32 fb = *(const F32*)b;
+   return (fa < fb) ? -1 : ((fa > fb) ? 1 : 0);
+}
+
+static void computeStats(const Vector<F32>& samples, PerfStats& stats)
+{
+   dMemset(&stats, 0, sizeof(stats));
+   if (samples.empty())
+      return;
+
+   Vector<F32> sorted(samples);
+   dQsort(sorted.address(), sorted.size(), sizeof(F32), compareSample);
+
+   F64 total = 0.0;
+   for (S32 i = 0; i < sorted.size(); ++i)
+      total += sorted[i];
+
+   const F32 last = F32(sorted.size() - 1);
+   stats.mean  = F32(total / sorted.size());
+   stats.p50   = sorted[(S32)(last * 0.50f + 0.5f)];
+   stats.p95   = sorted[(S32)(last * 0.95f + 0.5f)];
+   stats.p99   = sorted[(S32)(last * 0.99f + 0.5f)];
+   stats.max   = sorted.last();
+}
+
+static void writeText(FileStream& stream, const char* format, ...)
+{
+   char buffer[1024];
+
+   va_list args;
+   va_start(args, format);
+   dVsprintf(buffer, sizeof(buffer), format, args);
+   va_end(args);
+
+   stream.writeStringBuffer(buffer);
+}
+
+static void writeJSONString(FileStream& stream, const char* text)
+{
+   stream.write('"');
+   for (const char* c = text; *c; ++c)
+   {
+      if (*c == '"' || *c == '\\')
+         stream.write('\\');
+      stream.write(*c);
+   }
+   stream.write('"');
+}
+
+static void writeJSONStats(FileStream& stream, const PerfStats& stats)
+{
+   writeText(stream, "\"mean\": %.4f, \"p50\": %.4f, \"p95\": %.4f, \"p99\": %.4f, \"max\": %.4f",
+      stats.mean, stats.p50, stats.p95, stats.p99, stats.max);
+}
+
+static void endFrame()
+{
+   const U64 now = ServerScheduler::getMonotonicTime();
+   sFrameTimes.push_back(F32(now - sFrameStart) / 1000.0f);
+   sFrameStart = now;
+
+   for (S32 i = 0; i < sZones.size(); ++i)
+   {
+      PerfZoneRecord* zone = sZones[i];
+      zone->times.push_back(F32(zone->frameTime) / 1000.0f);
+      zone->calls.push_back(zone->frameCalls);
+      zone->frameTime = 0;
+      zone->frameCalls = 0;
+   }
+
+   sTimeStepped = false;
+}
+
+static void finish()
+{
+   PerfReplay::smRecording = false;
+   sActive = false;
+
+   Con::printf("PerfReplay - Replayed %d frames of '%s' at %ums per step.", sFrameTimes.size(), sJournal, sTimeStep);
+
+   bool failed = !PerfReplay::writeReport(sReport);
+
+   if (sBaseline[0])
+   {
+      S32 regressions = PerfReplay::compareBaseline(sBaseline, sThreshold, sMinMs);
+      if (regressions != 0)
+         failed = true;
+   }
+
+   // Stop the loop and shut down normally, main returns the status.
+   Game->setExitCode(failed ? 1 : 0);
+   Game->setRunning(false);
+}
+
+//------------------------------------------------------------------------------
+
+bool PerfReplay::beginZone(const char* name, S32* zoneIndex)
+{
+   // Only the main thread is recorded, job threads interleave freely.
+   if (!Con::isMainThread())
+      return false;
+
+   S32 index = *zoneIndex;
+   if (index < 0)
+   {
+      PerfZoneRecord* zone = new PerfZoneRecord;
+      zone->name = name;
+      zone->depth = 0;
+      zone->frameTime = 0;
+      zone->frameCalls = 0;
+
+      // Frames recorded before the zone was first seen had no calls.
+      zone->times.setSize(sFrameTimes.size());
+      zone->times.fill(0.0f);
+      zone->calls.setSize(sFrameTimes.size());
+      zone->calls.fill(0);
+
+      index = sZones.size();
+      sZones.push_back(zone);
+      *zoneIndex = index;
+   }
+
+   PerfOpenZone open;
+   open.index = index;
+   open.start = ServerScheduler::getMonotonicTime();
+   sZoneStack.push_back(open);
+
+   sZones[index]->depth++;
+   sZones[index]->frameCalls++;
+   return true;
+}
+
+void PerfReplay::endZone()
+{
+   // Zones opened before recording started are closed with an empty stack.
+   if (sZoneStack.empty() || !Con::isMainThread())
+      return;
+
+   const PerfOpenZone& open = sZoneStack.last();
+   PerfZoneRecord* zone = sZones[open.index];
+
+   // Recursive zones only count their outermost call.
+   if (--zone->depth == 0)
+      zone->frameTime += ServerScheduler::getMonotonicTime() - open.start;
+
+   sZoneStack.pop_back();
+}
+
+//------------------------------------------------------------------------------
+
+bool PerfReplay::processCommandLine(S32 argc, const char** argv)
+{
+   for (S32 i = 1; i < argc - 1; ++i)
+   {
+      const char* arg = argv[i];
+      const char* value = argv[i + 1];
+
+      if (dStricmp(arg, "-perfReplay") == 0)
+         Platform::makeFullPathName(value, sJournal, sizeof(sJournal));
+      else if (dStricmp(arg, "-perfReport") == 0)
+         Platform::makeFullPathName(value, sReport, sizeof(sReport));
+      else if (dStricmp(arg, "-perfBaseline") == 0)
+         Platform::makeFullPathName(value, sBaseline, sizeof(sBaseline));
+      else if (dStricmp(arg, "-perfThreshold") == 0)
+         sThreshold = getMax(dAtof(value), 0.0f);
+      else if (dStricmp(arg, "-perfMinMs") == 0)
+         sMinMs = getMax(dAtof(value), 0.0f);
+      else if (dStricmp(arg, "-perfStep") == 0)
+         sTimeStep = getMax(dAtoi(value), 1);
+      else
+         continue;
+
+      ++i;
+   }
+
+   if (!sJournal[0])
+      return false;
+
+   if (!sReport[0])
+      Platform::makeFullPathName("perfReport", sReport, sizeof(sReport));
+
+   return true;
+}
+
+bool PerfReplay::start()
+{
+#ifdef TORQUE_ALLOW_JOURNALING
+   if (!Platform::isFile(sJournal))
+   {
+      Con::errorf("PerfReplay - Can't find journal '%s'.", sJournal);
+      return false;
+   }
+
+   reset();
+
+   Game->playJournal(sJournal, false);
+
+   sActive = true;
+   smRecording = true;
+   sFrameStart = ServerScheduler::getMonotonicTime();
+   return true;
+#else
+   Con::errorf("PerfReplay - Journal playback isn't compiled in, rebuild with TORQUE_ALLOW_JOURNALING.");
+   return false;
+#endif
+}
+
+bool PerfReplay::isActive()
+{
+   return sActive;
+}
+
+U32 PerfReplay::getTimeStep()
+{
+   return sTimeStep;
+}
+
+void PerfReplay::markTimeStep()
+{
+   sTimeStepped = true;
+}
+
+void PerfReplay::process()
+{
+   if (!smRecording)
+      return;
+
+   if (sTimeStepped)
+      endFrame();
+
+   if (sActive && !Game->isJournalReading())
+      finish();
+}
+
+//------------------------------------------------------------------------------
+
+void PerfReplay::reset()
+{
+   // Zone slots stay registered, call sites keep their cached index.
+   for (S32 i = 0; i < sZones.size(); ++i)
+   {
+      PerfZoneRecord* zone = sZones[i];
+      zone->depth = 0;
+      zone->frameTime = 0;
+      zone->frameCalls = 0;
+      zone->times.clear();
+      zone->calls.clear();
+   }
+
+   sZoneStack.clear();
+   sFrameTimes.clear();
+   sFrameStart = ServerScheduler::getMonotonicTime();
+   sTimeStepped = false;
+}
+
+bool PerfReplay::writeReport(const char* name)
+{
+   char fileName[1024];
+   FileStream stream;
+
+   PerfStats frameStats;
+   computeStats(sFrameTimes, frameStats);
+
+   // JSON : summary per zone, read back by compareBaseline().
+   dSprintf(fileName, sizeof(fileName), "%s.json", name);
+   if (!stream.open(fileName, FileStream::Write))
+   {
+      Con::errorf("PerfReplay - Can't write report '%s'.", fileName);
+      return false;
+   }
+
+   writeText(stream, "{\n  \"journal\": ");
+   writeJSONString(stream, sJournal);
+   writeText(stream, ",\n  \"timeStep\": %u,\n  \"frames\": %d,\n  \"frame\": { ", sTimeStep, sFrameTimes.size());
+   writeJSONStats(stream, frameStats);
+   writeText(stream, " },\n  \"zones\": {");
+
+   for (S32 i = 0; i < sZones.size(); ++i)
+   {
+      const PerfZoneRecord* zone = sZones[i];
+
+      PerfStats stats;
+      computeStats(zone->times, stats);
+
+      U64 calls = 0;
+      for (S32 n = 0; n < zone->calls.size(); ++n)
+         calls += zone->calls[n];
+
+      writeText(stream, i == 0 ? "\n    " : ",\n    ");
+      writeJSONString(stream, zone->name);
+      writeText(stream, ": { ");
+      writeJSONStats(stream, stats);
+      writeText(stream, ", \"calls\": %.2f }", sFrameTimes.empty() ? 0.0 : F64(calls) / sFrameTimes.size());
+   }
+
+   writeText(stream, "\n  }\n}\n");
+   stream.close();
+
+   // CSV : one row per frame, zone times in milliseconds.
+   dSprintf(fileName, sizeof(fileName), "%s.csv", name);
+   if (!stream.open(fileName, FileStream::Write))
+   {
+      Con::errorf("PerfReplay - Can't write report '%s'.", fileName);
+      return false;
+   }
+
+   writeText(stream, "frame,frameMs");
+   for (S32 i = 0; i < sZones.size(); ++i)
+      writeText(stream, ",%s", sZones[i]->name);
+   writeText(stream, "\n");
+
+   for (S32 frame = 0; frame < sFrameTimes.size(); ++frame)
+   {
+      writeText(stream, "%d,%.4f", frame, sFrameTimes[frame]);
+      for (S32 i = 0; i < sZones.size(); ++i)
+         writeText(stream, ",%.4f", sZones[i]->times[frame]);
+      writeText(stream, "\n");
+   }
+
+   stream.close();
+
+   Con::printf("PerfReplay - Wrote '%s.json' and '%s.csv', frame p50 %.3fms p95 %.3fms p99 %.3fms.",
+      name, name, frameStats.p50, frameStats.p95, frameStats.p99);
+   return true;
+}
+
+S32 PerfReplay::compareBaseline(const char* baselineFile, F32 thresholdPercent, F32 minMs)
+{
+   FileStream stream;
+   if (!stream.open(baselineFile, FileStream::Read))
+   {
+      Con::errorf("PerfReplay - Can't open baseline '%s'.", baselineFile);
+      return -1;
+   }
+
+   const U32 size = stream.getStreamSize();
+   char* text = new char[size + 1];
+   stream.read(size, text);
+   text[size] = 0;
+   stream.close();
+
+   rapidjson::Document document;
+   document.Parse<0>(text);
+   delete[] text;
+
+   if (document.HasParseError() || !document.IsObject() || !document.HasMember("zones") || !document["zones"].IsObject())
+   {
+      Con::errorf("PerfReplay - Baseline '%s' isn't a replay report.", baselineFile);
+      return -1;
+   }
+
+   const rapidjson::Value& zones = document["zones"];
+   const F32 limit = 1.0f + thresholdPercent / 100.0f;
+   S32 regressions = 0;
+
+   for (S32 i = 0; i < sZones.size(); ++i)
+   {
+      const PerfZoneRecord* zone = sZones[i];
+      if (!zones.HasMember(zone->name))
+         continue;
+
+      const rapidjson::Value& baseZone = zones[zone->name];
+      if (!baseZone.IsObject() || !baseZone.HasMember("p95") || !baseZone["p95"].IsNumber())
+         continue;
+
+      // Zones this cheap are dominated by timer noise.
+      const F32 baseP95 = (F32)baseZone["p95"].GetDouble();
+      if (baseP95 < minMs)
+         continue;
+
+      PerfStats stats;
+      computeStats(zone->times, stats);
+
+      if (stats.p95 > baseP95 * limit)
+      {
+         Con::warnf("PerfReplay - Regression in %s: p95 %.3fms, baseline %.3fms (+%.1f%%).",
+            zone->name, stats.p95, baseP95, (stats.p95 / baseP95 - 1.0f) * 100.0f);
+         regressions++;
+      }
+   }
+
+   for (rapidjson::Value::ConstMemberIterator itr = zones.MemberBegin(); itr != zones.MemberEnd(); ++itr)
+   {
+      bool found = false;
+      for (S32 i = 0; i < sZones.size() && !found; ++i)
+         found = dStrcmp(sZones[i]->name, itr->name.GetString()) == 0;
+
+      if (!found)
+         Con::warnf("PerfReplay - Zone %s from the baseline wasn't hit.", itr->name.GetString());
+   }
+
+   Con::printf("PerfReplay - %d zone(s) regressed more than %.1f%% against '%s'.", regressions, thresholdPercent, baselineFile);
+   return regressions;
+}
@@ -0,0 +1,117 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2013 GarageGames, LLC
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//-----------------------------------------------------------------------------
+
+#ifndef _PERF_REPLAY_H_
+#define _PERF_REPLAY_H_
+
+#ifndef _TORQUE_TYPES_H_
+#include "platform/types.h"
+#endif
+
+#include "platform/platformLibrary.h"
+
+//------------------------------------------------------------------------------
+
+/// Performance replay harness.
+///
+/// Plays a recorded journal back headlessly at uncapped speed with a fixed
+/// timestep and records the inclusive time and call count of every
+/// PROFILE_START / PROFILE_SCOPE zone on the main thread for each simulated
+/// frame. When the journal runs out a JSON and CSV report is written and,
+/// if a baseline report was given, each zone is compared against it. The
+/// process exits with 1 if any zone regressed beyond the threshold.
+///
+/// Command line:
+/// @code
+/// -perfReplay <journal>     Journal to play back (implies -headless).
+/// -perfReport <name>        Writes <name>.json and <name>.csv (default perfReport).
+/// -perfBaseline <file>      Baseline .json written by an earlier run.
+/// -perfThreshold <percent>  Allowed p95 growth per zone (default 10).
+/// -perfMinMs <ms>           Ignore zones whose baseline p95 is below this (default 0.05).
+/// -perfStep <ms>            Fixed simulation timestep (default 32).
+/// @endcode
+///
+/// Journals can only be played back in builds with TORQUE_ALLOW_JOURNALING.
+struct DLL_PUBLIC PerfReplay
+{
+   /// Checked by the profiler macros before anything else is done.
+   static bool smRecording;
+
+   /// @name Profiler Hooks
+   /// zoneIndex points at a static owned by the call site, it caches the zone
+   /// slot after the first call. Zones opened on other threads are ignored.
+   /// @{
+
+   static bool beginZone(const char* name, S32* zoneIndex);
+   static void endZone();
+
+   /// @}
+
+   /// Parses the command line. Returns true when a replay was requested.
+   static bool processCommandLine(S32 argc, const char** argv);
+
+   /// Starts playing back the journal given on the command line.
+   static bool start();
+
+   static bool isActive();
+   static U32  getTimeStep();
+
+   /// Called for every simulated TimeEvent.
+   static void markTimeStep();
+
+   /// Called at the end of every main loop iteration. While recording it
+   /// closes the frame if a time step was simulated and finishes the replay
+   /// once the journal ends.
+   static void process();
+
+   /// @name Reports
+   /// @{
+
+   static void reset();
+   static bool writeReport(const char* name);
+
+   /// Returns the number of zones whose p95 grew more than thresholdPercent
+   /// over the baseline, or -1 if the baseline can't be read.
+   static S32 compareBaseline(const char* baselineFile, F32 thresholdPercent, F32 minMs);
+
+   /// @}
+};
+
+/// Closes a PerfReplay zone at the end of a scope.
+class PerfReplayScope
+{
+   bool mActive;
+
+public:
+   PerfReplayScope(const char* name, S32* zoneIndex)
+   {
+      mActive = PerfReplay::smRecording && PerfReplay::beginZone(name, zoneIndex);
+   }
+
+   ~PerfReplayScope()
+   {
+      if (mActive)
+         PerfReplay::endZone();
+   }
+};
+
+#endif // _PERF_REPLAY_H_
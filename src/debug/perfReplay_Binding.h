@@ -0,0 +1,75 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2013 GarageGames, LLC
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//-----------------------------------------------------------------------------
+
+ConsoleFunctionGroupBegin( PerfReplay, "Performance replay harness functions.");
+
+/*! @defgroup PerfReplayFunctions Performance Replay
+	@ingroup TorqueScriptFunctions
+	@{
+*/
+
+/*! Returns whether a journal is being replayed by the performance harness.
+    @return True while -perfReplay is running.
+*/
+ConsoleFunctionWithDocs( isPerfReplayActive, ConsoleBool, 1, 1, ())
+{
+   return PerfReplay::isActive();
+}
+
+/*! Writes the zone timings recorded so far to name.json and name.csv.
+    @param name The report path without extension.
+    @return True if both files were written.
+*/
+ConsoleFunctionWithDocs( writePerfReport, ConsoleBool, 2, 2, ( name ))
+{
+   char path[1024];
+   Con::expandPath(path, sizeof(path), argv[1]);
+   return PerfReplay::writeReport(path);
+}
+
+/*! Compares the zone timings recorded so far against a stored report.
+    @param baselineFile A .json report written by an earlier replay.
+    @param thresholdPercent Allowed growth of a zone's p95 frame time. Defaults to 10.
+    @param minMs Zones whose baseline p95 is below this are skipped. Defaults to 0.05.
+    @return The number of regressed zones, or -1 if the baseline can't be read.
+*/
+ConsoleFunctionWithDocs( comparePerfBaseline, ConsoleInt, 2, 4, ( baselineFile, [thresholdPercent], [minMs] ))
+{
+   char path[1024];
+   Con::expandPath(path, sizeof(path), argv[1]);
+
+   const F32 threshold = (argc > 2) ? dAtof(argv[2]) : 10.0f;
+   const F32 minMs = (argc > 3) ? dAtof(argv[3]) : 0.05f;
+   return PerfReplay::compareBaseline(path, threshold, minMs);
+}
+
+/*! Clears the zone timings recorded so far.
+    @return No return value.
+*/
+ConsoleFunctionWithDocs( resetPerfReplay, ConsoleVoid, 1, 1, ())
+{
+   PerfReplay::reset();
+}
+
+/*! @} */ // group PerfReplayFunctions
+
+ConsoleFunctionGroupEnd( PerfReplay );
@@ -195,13 +195,51 @@ public:
 
 #include <remotery/lib/Remotery.h>
 
+// Zones are also fed to the timeline profiler while it captures and to the
+// performance replay harness while it records.
+#ifndef _TIMELINE_PROFILER_H_
+#include "debug/timelineProfiler.h"
+#endif
+
+#ifndef _PERF_REPLAY_H_
+#include "debug/perfReplay.h"
+#endif
+
 #undef PROFILE_START
-#define PROFILE_START(name) rmt_BeginCPUSample(name)
+#define PROFILE_START(name) \
+   do { \
+      rmt_BeginCPUSample(name); \
+      if (TimelineProfiler::smCapturing) \
+         TimelineProfiler::beginZone(#name); \
+      if (PerfReplay::smRecording) { \
+         static S32 perf_zone_##name = -1; \
+         PerfReplay::beginZone(#name, &perf_zone_##name); \
+      } \
+   } while (0)
 
 #undef PROFILE_END
-#define PROFILE_END() rmt_EndCPUSample()
+#define PROFILE_END() \
+   do { \
+      if (PerfReplay::smRecording) \
+         PerfReplay::endZone(); \
+      if (TimelineProfiler::smCapturing) \
+         TimelineProfiler::endZone(); \
+      rmt_EndCPUSample(); \
+   } while (0)
 
 #undef PROFILE_SCOPE
-#define PROFILE_SCOPE(name) rmt_ScopedCPUSample(name)
+#define PROFILE_SCOPE(name) \
+   rmt_ScopedCPUSample(name); \
+   TimelineScope timelineScope##name(#name); \
+   static S32 perf_zone_##name = -1; \
+   PerfReplayScope perfReplayScope##name(#name, &perf_zone_##name)
+
+/// Adds to one of the TimelineProfiler counters, e.g. PROFILE_COUNT(DrawCalls, 1).
+#undef PROFILE_COUNT
+#define PROFILE_COUNT(counter, amount) \
+   do { \
+      if (TimelineProfiler::smCapturing) \
+         TimelineProfiler::addCount(TimelineProfiler::counter, amount); \
+   } while (0)
 
 #endif
\ No newline at end of file
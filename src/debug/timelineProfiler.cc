@@ -0,0 +1,338 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2013 GarageGames, LLC
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//-----------------------------------------------------------------------------
+
+#include "debug/timelineProfiler.h"
+#include "platform/platform.h"
+#include "platform/threads/mutex.h"
+#include "platform/threads/jobSystem.h"
+#include "console/console.h"
+#include "collection/vector.h"
+#include "io/fileStream.h"
+#include "math/mMathFn.h"
+
+#include <bx/timer.h>
+
+// Script bindings.
+#include "timelineProfiler_Binding.h"
+
+//------------------------------------------------------------------------------
+
+bool TimelineProfiler::smCapturing = false;
+
+enum TimelineEventType
+{
+   TimelineBegin,
+   TimelineEnd,
+   TimelineCounter,
+};
+
+struct TimelineEvent
+{
+   S64         time;
+   const char* name;
+   U32         type;
+   S32         value;
+};
+
+struct TimelineThread
+{
+   U32            id;
+   char           name[64];
+
+   // Written only by the owning thread. head counts every event ever pushed,
+   // the slot is head modulo ThreadEventCount.
+   TimelineEvent* events;
+   volatile U32   head;
+
+   // head when the current capture began.
+   U32            captureHead;
+};
+
+static const char* sCounterNames[TimelineProfiler::CounterCount] =
+{
+   "DrawCalls",
+   "Allocations",
+   "EventsPosted",
+};
+
+static Mutex*                    sThreadMutex      = NULL;
+static Vector<TimelineThread*>   sThreads;
+static volatile S32              sCounters[TimelineProfiler::CounterCount];
+
+static char                      sCaptureFile[1024] = { 0 };
+static U32                       sCaptureFrames    = 0;
+static S64                       sCaptureStart     = 0;
+static S64                       sCaptureEnd       = 0;
+
+//------------------------------------------------------------------------------
+
+static TimelineThread* registerThread()
+{
+   TimelineThread* thread = new TimelineThread;
+   thread->events = NULL;
+   thread->head = 0;
+   thread->captureHead = 0;
+
+   sThreadMutex->lock();
+   thread->id = sThreads.size() + 1;
+   sThreads.push_back(thread);
+   sThreadMutex->unlock();
+
+   // Threads that never name themselves get a generic name.
+   dSprintf(thread->name, sizeof(thread->name), "Thread %u", thread->id);
+
+   TimelineProfiler::setThreadData(thread);
+   return thread;
+}
+
+static inline void pushEvent(U32 type, const char* name, S32 value)
+{
+   TimelineThread* thread = (TimelineThread*)TimelineProfiler::getThreadData();
+   if (thread == NULL)
+   {
+      // Capturing before init() or after destroy() isn't possible, but a
+      // thread can race a capture ending.
+      if (sThreadMutex == NULL)
+         return;
+      thread = registerThread();
+   }
+
+   // The ring is only allocated once the thread records something.
+   if (thread->events == NULL)
+      thread->events = new TimelineEvent[TimelineProfiler::ThreadEventCount];
+
+   TimelineEvent& event = thread->events[thread->head & (TimelineProfiler::ThreadEventCount - 1)];
+   event.time = bx::getHPCounter();
+   event.name = name;
+   event.type = type;
+   event.value = value;
+
+   thread->head++;
+}
+
+static void writeText(FileStream& stream, const char* format, ...)
+{
+   char buffer[512];
+
+   va_list args;
+   va_start(args, format);
+   dVsprintf(buffer, sizeof(buffer), format, args);
+   va_end(args);
+
+   stream.writeStringBuffer(buffer);
+}
+
+//------------------------------------------------------------------------------
+
+void TimelineProfiler::init()
+{
+   sThreadMutex = new Mutex();
+   dMemset((void*)sCounters, 0, sizeof(sCounters));
+
+   setThreadName("Main");
+}
+
+void TimelineProfiler::destroy()
+{
+   smCapturing = false;
+
+   for (S32 i = 0; i < sThreads.size(); ++i)
+   {
+      delete[] sThreads[i]->events;
+      delete sThreads[i];
+   }
+   sThreads.clear();
+
+   setThreadData(NULL);
+
+   delete sThreadMutex;
+   sThreadMutex = NULL;
+}
+
+void TimelineProfiler::setThreadName(const char* name)
+{
+   if (sThreadMutex == NULL)
+      return;
+
+   TimelineThread* thread = (TimelineThread*)getThreadData();
+   if (thread == NULL)
+      thread = registerThread();
+
+   dStrncpy(thread->name, name, sizeof(thread->name) - 1);
+   thread->name[sizeof(thread->name) - 1] = 0;
+}
+
+//------------------------------------------------------------------------------
+
+void TimelineProfiler::beginZone(const char* name)
+{
+   pushEvent(TimelineBegin, name, 0);
+}
+
+void TimelineProfiler::endZone()
+{
+   pushEvent(TimelineEnd, NULL, 0);
+}
+
+void TimelineProfiler::addCount(Counter counter, S32 amount)
+{
+   JobSystem::atomicAdd(&sCounters[counter], amount);
+}
+
+void TimelineProfiler::frame()
+{
+   if (!smCapturing)
+      return;
+
+   // Counters are written as totals for the frame that just ended.
+   for (U32 i = 0; i < CounterCount; ++i)
+   {
+      const S32 value = sCounters[i];
+      JobSystem::atomicAdd(&sCounters[i], -value);
+      pushEvent(TimelineCounter, sCounterNames[i], value);
+   }
+
+   if (sCaptureFrames > 0 && --sCaptureFrames == 0)
+      endCapture();
+}
+
+//------------------------------------------------------------------------------
+
+void TimelineProfiler::beginCapture(U32 frameCount, const char* fileName)
+{
+   if (sThreadMutex == NULL)
+      return;
+
+   if (smCapturing)
+      endCapture();
+
+   dStrncpy(sCaptureFile, fileName, sizeof(sCaptureFile) - 1);
+   sCaptureFile[sizeof(sCaptureFile) - 1] = 0;
+   sCaptureFrames = frameCount;
+
+   sThreadMutex->lock();
+   for (S32 i = 0; i < sThreads.size(); ++i)
+      sThreads[i]->captureHead = sThreads[i]->head;
+   sThreadMutex->unlock();
+
+   for (U32 i = 0; i < CounterCount; ++i)
+      JobSystem::atomicAdd(&sCounters[i], -sCounters[i]);
+
+   sCaptureStart = bx::getHPCounter();
+   smCapturing = true;
+
+   Con::printf("TimelineProfiler - Capturing %u frames to '%s'.", frameCount, sCaptureFile);
+}
+
+void TimelineProfiler::endCapture()
+{
+   if (!smCapturing)
+      return;
+
+   smCapturing = false;
+   sCaptureEnd = bx::getHPCounter();
+
+   writeTrace(sCaptureFile);
+}
+
+bool TimelineProfiler::writeTrace(const char* fileName)
+{
+   FileStream stream;
+   if (!stream.open(fileName, FileStream::Write))
+   {
+      Con::errorf("TimelineProfiler - Can't write trace '%s'.", fileName);
+      return false;
+   }
+
+   const F64 toMicroseconds = 1000000.0 / F64(bx::getHPFrequency());
+
+   // Threads still writing when the capture stopped may touch a few of the
+   // oldest slots, so a wrapped ring skips those.
+   const U32 maxEvents = ThreadEventCount - 256;
+
+   U32 eventCount = 0;
+   bool first = true;
+
+   writeText(stream, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[");
+
+   sThreadMutex->lock();
+   for (S32 t = 0; t < sThreads.size(); ++t)
+   {
+      const TimelineThread* thread = sThreads[t];
+
+      writeText(stream, "%s\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":\"%s\"}}",
+         first ? "" : ",", thread->id, thread->name);
+      first = false;
+
+      if (thread->events == NULL)
+         continue;
+
+      const U32 head = thread->head;
+      U32 start = thread->captureHead;
+      if (head - start > maxEvents)
+         start = head - maxEvents;
+
+      U32 depth = 0;
+      for (U32 i = start; i != head; ++i)
+      {
+         const TimelineEvent& event = thread->events[i & (ThreadEventCount - 1)];
+         if (event.time < sCaptureStart || event.time > sCaptureEnd)
+            continue;
+
+         const F64 ts = F64(event.time - sCaptureStart) * toMicroseconds;
+
+         switch (event.type)
+         {
+            case TimelineBegin:
+               writeText(stream, ",\n{\"name\":\"%s\",\"ph\":\"B\",\"pid\":1,\"tid\":%u,\"ts\":%.3f}", event.name, thread->id, ts);
+               depth++;
+               break;
+
+            case TimelineEnd:
+               // Zones opened before the capture (or lost to the ring) have no begin.
+               if (depth == 0)
+                  continue;
+               writeText(stream, ",\n{\"ph\":\"E\",\"pid\":1,\"tid\":%u,\"ts\":%.3f}", thread->id, ts);
+               depth--;
+               break;
+
+            case TimelineCounter:
+               writeText(stream, ",\n{\"name\":\"%s\",\"ph\":\"C\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"args\":{\"value\":%d}}", event.name, thread->id, ts, event.value);
+               break;
+         }
+
+         eventCount++;
+      }
+
+      // Close zones still open when the capture ended.
+      const F64 endTs = F64(sCaptureEnd - sCaptureStart) * toMicroseconds;
+      for (; depth > 0; --depth)
+         writeText(stream, ",\n{\"ph\":\"E\",\"pid\":1,\"tid\":%u,\"ts\":%.3f}", thread->id, endTs);
+   }
+   sThreadMutex->unlock();
+
+   writeText(stream, "\n]}\n");
+   stream.close();
+
+   Con::printf("TimelineProfiler - Wrote %u events to '%s'.", eventCount, fileName);
+   return true;
+}
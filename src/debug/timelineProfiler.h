@@ -0,0 +1,126 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2013 GarageGames, LLC
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//-----------------------------------------------------------------------------
+
+#ifndef _TIMELINE_PROFILER_H_
+#define _TIMELINE_PROFILER_H_
+
+#ifndef _TORQUE_TYPES_H_
+#include "platform/types.h"
+#endif
+
+#include "platform/platformLibrary.h"
+
+//------------------------------------------------------------------------------
+
+/// Timeline profiler.
+///
+/// While a capture runs every PROFILE_START / PROFILE_END / PROFILE_SCOPE on
+/// any thread is written, with a timestamp, into a ring buffer owned by that
+/// thread. No locks are taken on the hot path, a thread only registers its
+/// ring once. When the capture ends the rings are exported as a Chrome
+/// trace-event JSON file, which chrome://tracing and Perfetto can open.
+///
+/// Counters are summed over each frame and written as counter tracks.
+///
+/// Examples of script use:
+/// @code
+/// timelineCapture(120, "capture.json");   // capture the next 120 frames
+/// timelineStop();                         // end a capture early
+/// @endcode
+struct DLL_PUBLIC TimelineProfiler
+{
+   enum Counter
+   {
+      DrawCalls,
+      Allocations,
+      EventsPosted,
+
+      CounterCount
+   };
+
+   enum
+   {
+      /// Events kept per thread, older events are overwritten.
+      ThreadEventCount = 1 << 16,
+   };
+
+   /// Checked by the profiler macros before anything else is done.
+   static bool smCapturing;
+
+   static void init();
+   static void destroy();
+
+   /// Names the calling thread in exported traces.
+   static void setThreadName(const char* name);
+
+   /// @name Profiler Hooks
+   /// @{
+
+   static void beginZone(const char* name);
+   static void endZone();
+   static void addCount(Counter counter, S32 amount);
+
+   /// @}
+
+   /// Called once at the end of every main loop iteration.
+   static void frame();
+
+   /// @name Captures
+   /// @{
+
+   static void beginCapture(U32 frameCount, const char* fileName);
+   static void endCapture();
+   static bool writeTrace(const char* fileName);
+
+   /// @}
+
+   /// @name Platform
+   /// Per thread storage for the thread's ring, implemented per platform.
+   /// @{
+
+   static void* getThreadData();
+   static void setThreadData(void* data);
+
+   /// @}
+};
+
+/// Closes a timeline zone at the end of a scope.
+class TimelineScope
+{
+   bool mActive;
+
+public:
+   TimelineScope(const char* name)
+   {
+      mActive = TimelineProfiler::smCapturing;
+      if (mActive)
+         TimelineProfiler::beginZone(name);
+   }
+
+   ~TimelineScope()
+   {
+      if (mActive)
+         TimelineProfiler::endZone();
+   }
+};
+
+#endif // _TIMELINE_PROFILER_H_
@@ -0,0 +1,60 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2013 GarageGames, LLC
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//-----------------------------------------------------------------------------
+
+ConsoleFunctionGroupBegin( TimelineProfiler, "Timeline profiler functions.");
+
+/*! @defgroup TimelineProfilerFunctions Timeline Profiler
+	@ingroup TorqueScriptFunctions
+	@{
+*/
+
+/*! Captures the profiler zones of every thread for a number of frames and writes them as a Chrome trace-event file. The file can be opened in chrome://tracing or Perfetto.
+    @param frameCount The number of frames to capture.
+    @param fileName The .json file to write when the capture ends.
+    @return No return value.
+*/
+ConsoleFunctionWithDocs( timelineCapture, ConsoleVoid, 3, 3, ( frameCount, fileName ))
+{
+   char path[1024];
+   Con::expandPath(path, sizeof(path), argv[2]);
+   TimelineProfiler::beginCapture(getMax(dAtoi(argv[1]), 1), path);
+}
+
+/*! Ends a running capture early and writes it out.
+    @return No return value.
+*/
+ConsoleFunctionWithDocs( timelineStop, ConsoleVoid, 1, 1, ())
+{
+   TimelineProfiler::endCapture();
+}
+
+/*! Returns whether a timeline capture is running.
+    @return True while capturing.
+*/
+ConsoleFunctionWithDocs( isTimelineCapturing, ConsoleBool, 1, 1, ())
+{
+   return TimelineProfiler::smCapturing;
+}
+
+/*! @} */ // group TimelineProfilerFunctions
+
+ConsoleFunctionGroupEnd( TimelineProfiler );
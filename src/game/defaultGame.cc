@@ -27,6 +27,7 @@
 #include "platform/platformVideo.h"
 #include "platform/platformInput.h"
 #include "platform/platformAudio.h"
+#include "platform/platformServerScheduler.h"
 #include "platform/event.h"
 #include "game/gameInterface.h"
 #include "collection/vector.h"
@@ -54,6 +55,8 @@
 #include "memory/frameAllocator.h"
 #include "game/version.h"
 #include "debug/profiler.h"
+#include "debug/perfReplay.h"
+#include "debug/timelineProfiler.h"
 #include "network/serverQuery.h"
 #include "game/defaultGame.h"
 #include "platform/nativeDialogs/msgBox.h"
@@ -65,8 +68,12 @@
 #include "materials/materials.h"
 #include "scene/scene.h"
 #include "scene/sceneTickable.h"
+#include "scene/transformSystem.h"
+#include "scene/components/animationComponent.h"
 #include "plugins/plugins.h"
 #include "sysgui/sysgui.h"
+#include "rendering/frameSnapshot.h"
+#include "platform/threads/jobSystem.h"
 
 #include <stdio.h>
 
@@ -180,6 +187,12 @@ bool initializeLibraries()
    Processor::init();
    Math::init();
 
+   // Timeline Profiler, before any thread that could record.
+   TimelineProfiler::init();
+
+   // Job System
+   JobSystem::init();
+
    Platform::init();    // platform specific initialization
 
 #if defined(TORQUE_OS_IOS) && defined(_USE_STORE_KIT)
@@ -203,6 +216,10 @@ void shutdownLibraries()
    if (ResourceManager)
       ResourceManager->purge();
 
+   // Finish outstanding jobs while everything they might touch is still alive.
+   JobSystem::destroy();
+   TimelineProfiler::destroy();
+
    TelnetDebugger::destroy();
    TelnetConsole::destroy();
 
@@ -452,6 +469,17 @@ bool DefaultGame::mainInitialize(int argc, const char **argv)
    else
       gRemotery = NULL;
 
+   // Headless servers never bring up video, GUI, fonts or audio. Neither
+   // does the performance replay harness.
+#ifdef TORQUE_DEDICATED
+   setHeadless(true);
+#endif
+   for (S32 i = 1; i < argc; ++i)
+   {
+      if (dStrcmp(argv[i], "-dedicated") == 0 || dStrcmp(argv[i], "-headless") == 0 || dStricmp(argv[i], "-perfReplay") == 0)
+         setHeadless(true);
+   }
+
    if (!initializeLibraries())
       return false;
 
@@ -465,6 +493,10 @@ bool DefaultGame::mainInitialize(int argc, const char **argv)
    U32 i;
    for (i = 0; i < (U32)argc; i++)
       Con::setVariable(avar("$GameProject::argv%d", i), argv[i]);
+
+   // Resolved before the scripts change the current directory.
+   const bool perfReplay = PerfReplay::processCommandLine(argc, argv);
+
    if (initializeGame(argc, argv) == false)
    {
       //Using printf cos Con:: is not around here.
@@ -474,8 +506,21 @@ bool DefaultGame::mainInitialize(int argc, const char **argv)
       return false;
    }
 
+   // Replay the journal at uncapped speed with a fixed timestep.
+   if (perfReplay)
+   {
+      gTimeAdvance = PerfReplay::getTimeStep();
+      if (!PerfReplay::start())
+      {
+         shutdownGame();
+         shutdownLibraries();
+         return false;
+      }
+   }
+
    // Compile all materials.
-   Materials::compileAllMaterials();
+   if (!isHeadless())
+      Materials::compileAllMaterials();
 
    // Start the scene.
    Scene::play();
@@ -574,6 +619,10 @@ void DefaultGame::mainLoop(void)
 #ifdef TORQUE_OS_ANDROID_PROFILE
    AndroidProfilerStart("MAIN_LOOP");
 #endif
+   // A headless server sleeps here until its next tick is due.
+   if (isHeadless())
+      ServerScheduler::process();
+
    PROFILE_START(MainLoop);
 #ifdef TORQUE_ALLOW_JOURNALING
    PROFILE_START(JournalMain);
@@ -586,6 +635,12 @@ void DefaultGame::mainLoop(void)
    PROFILE_START(PlatformProcessMain);
    Platform::process(); // keys, etc.
    PROFILE_END();
+   PROFILE_START(JobSystemProcessMain);
+   JobSystem::processMainThreadJobs();
+   PROFILE_END();
+   PROFILE_START(SceneLoadingMain);
+   Scene::processLoading();
+   PROFILE_END();
    PROFILE_START(TelconsoleProcessMain);
    TelConsole->process();
    PROFILE_END();
@@ -593,13 +648,18 @@ void DefaultGame::mainLoop(void)
    TelDebugger->process();
    PROFILE_END();
    PROFILE_START(TimeManagerProcessMain);
-   TimeManager::process(); // guaranteed to produce an event
+   if (!isHeadless())
+      TimeManager::process(); // guaranteed to produce an event
    PROFILE_END();
    PROFILE_START(GameProcessEvents);
    Game->processEvents(); // process all non-sim posted events.
    PROFILE_END();
    PROFILE_END();
 
+   // Closes the replayed frame and ends the replay with the journal.
+   PerfReplay::process();
+   TimelineProfiler::frame();
+
 #ifdef TORQUE_OS_IOS_PROFILE
    iPhoneProfilerEnd("MAIN_LOOP");
    if (iPhoneProfilerGetCount() >= 60) {
@@ -701,6 +761,8 @@ void DefaultGame::processQuitEvent()
 void DefaultGame::processTimeEvent(TimeEvent *event)
 {
    PROFILE_START(ProcessTimeEvent);
+   Rendering::beginFrameTime();
+   PerfReplay::markTimeStep();
    U32 elapsedTime = event->elapsedTime;
 
    if (elapsedTime > 1024)
@@ -781,7 +843,7 @@ void DefaultGame::processTimeEvent(TimeEvent *event)
    // though it does need to be updated in real time
    static U32 lastAudioUpdate = 0;
    U32 realTime = Platform::getRealMilliseconds();
-   if ((realTime - lastAudioUpdate) >= AudioUpdatePeriod)
+   if (!isHeadless() && (realTime - lastAudioUpdate) >= AudioUpdatePeriod)
    {
       alxUpdate();
       lastAudioUpdate = realTime;
@@ -802,6 +864,16 @@ void DefaultGame::processTimeEvent(TimeEvent *event)
       GNet->processClient();
    PROFILE_END();
 
+   PROFILE_START(TransformUpdate);
+   Scene::updateTransforms();
+   PROFILE_END();
+
+   // Skinning only feeds rendering.
+   PROFILE_START(AnimationUpdate);
+   if (!isHeadless())
+      Scene::AnimationComponent::updateBatch();
+   PROFILE_END();
+
    if (Canvas && TextureManager::mDGLRender)
    {
 #ifdef TORQUE_OS_IOS_PROFILE      
@@ -836,6 +908,7 @@ void DefaultGame::processTimeEvent(TimeEvent *event)
 
       // Swap buffers
       Video::swapBuffers();
+      Rendering::endFrameTime();
 
       gFrameCount++;
 #ifdef TORQUE_OS_IOS_PROFILE
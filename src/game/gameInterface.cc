@@ -26,6 +26,7 @@
 #include "io/fileStream.h"
 #include "console/console.h"
 #include "platform/threads/mutex.h"
+#include "debug/profiler.h"
 
 // Script binding.
 #include "game/gameInterface_Binding.h"
@@ -53,7 +54,9 @@ GameInterface::GameInterface()
    Game = this;
    mJournalMode = JournalOff;
    mRunning = true;
+   mHeadless = false;
    mRequiresRestart = false;
+   mExitCode = 0;
    if(!gGameEventQueueMutex)
       gGameEventQueueMutex = Mutex::createMutex();
    eventQueue = &eventQueue1;
@@ -122,6 +125,8 @@ void GameInterface::postEvent(Event &event)
       return;
 #endif //TORQUE_ALLOW_JOURNALING
 
+   PROFILE_COUNT(EventsPosted, 1);
+
    // Only one thread can post at a time.
    Mutex::lockMutex(gGameEventQueueMutex);
 
@@ -129,7 +134,7 @@ void GameInterface::postEvent(Event &event)
    if(mJournalMode == JournalSave)
    {
       gJournalStream.write(event.size, &event);
-      gJournalStream.flush();
+      gJournalStream.Flush();
    }
 #endif //TORQUE_ALLOW_JOURNALING 
 
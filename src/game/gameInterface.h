@@ -38,8 +38,10 @@ private:
    };
    JournalMode mJournalMode;
    bool mRunning;
+   bool mHeadless;
    bool mJournalBreak;
    bool mRequiresRestart;
+   S32 mExitCode;
 
    /// Events are stored here by any thread, for processing by the main thread.
    Vector<Event*> eventQueue1, eventQueue2, *eventQueue;
@@ -95,6 +97,16 @@ public:
    inline bool isRunning( void ) const { return mRunning; }
    inline void setRestart( const bool restart ) { mRequiresRestart = restart; }
    inline bool requiresRestart( void ) const { return mRequiresRestart; }
+
+   /// Returned from main once the loop stops, for quitting with a status
+   /// without going through postQuitMessage(), which dumps core on Linux.
+   inline void setExitCode( const S32 exitCode ) { mExitCode = exitCode; }
+   inline S32 getExitCode( void ) const { return mExitCode; }
+
+   /// A headless game never initializes video, GUI, fonts or audio and runs
+   /// its ticks from the ServerScheduler. Set by -dedicated and -headless.
+   inline void setHeadless( const bool headless ) { mHeadless = headless; }
+   inline bool isHeadless( void ) const { return mHeadless; }
    /// @}
 
    /// @name Journaling
@@ -20,6 +20,14 @@
 // IN THE SOFTWARE.
 //-----------------------------------------------------------------------------
 
+/*! Check whether the game runs headless, as a dedicated server without video, GUI or audio.
+    @return True when started with -dedicated or -headless, or built with TORQUE_DEDICATED.
+*/
+ConsoleFunctionWithDocs( isHeadless, ConsoleBool, 1, 1, ())
+{
+   return Game->isHeadless();
+}
+
 #ifdef TORQUE_ALLOW_JOURNALING
 
 /*! Use the saveJournal function to save a new journal of the current game.
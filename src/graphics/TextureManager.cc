@@ -37,6 +37,7 @@
 
 #include <nanovg/nanovg.h>
 #include "graphics/dgl.h"
+#include "graphics/dglBatch.h"
 #include <bx/timer.h>
 
 //---------------------------------------------------------------------------------------------------------------------
@@ -402,6 +403,9 @@ void TextureManager::refresh( TextureObject* pTextureObject )
           // This loads the texture into NanoVG (it doesn't create a second copy on the GPU)
           // This is nessicary in order to use textures in NanoVG calls.
           nvgCreateImageBGFX(dglGetNVGContext(), pNewBitmap->getWidth(), pNewBitmap->getHeight(), NVG_TEXTURE_RGBA, pTextureObject->mBGFXTexture);
+
+          // Small bitmaps are also copied into the GUI atlas so the GUI can batch them.
+          pTextureObject->mInAtlas = dglAtlasInsert(pSourceBitmap, pTextureObject->mAtlasRect);
        }
     }
 
@@ -39,6 +39,10 @@
 #include "graphics/gBitmap.h"
 #endif
 
+#ifndef _MRECT_H_
+#include "math/mRect.h"
+#endif
+
 #ifndef BGFX_H_HEADER_GUARD
 #include <bgfx/bgfx.h>
 #endif
@@ -74,6 +78,10 @@ private:
     bgfx::TextureInfo   mBGFXTextureInfo;
     U32                 mFlags;
 
+    // Location in the GUI atlas, if the bitmap was small enough.
+    bool                mInAtlas;
+    RectI               mAtlasRect;
+
     TextureHandle::TextureHandleType mHandleType;
 
 public:
@@ -87,6 +95,8 @@ public:
         mBitmapWidth( 0 ),
         mBitmapHeight( 0 ),
         mClamp( false ),
+        mInAtlas( false ),
+        mAtlasRect( 0, 0, 0, 0 ),
         mHandleType( TextureHandle::InvalidTexture )
     {
        mTempBuf = NULL;
@@ -101,6 +111,8 @@ public:
     inline U32 getBitmapWidth( void ) { return mBitmapWidth; }
     inline U32 getBitmapHeight( void ) { return mBitmapHeight; }
     inline bool getClamp( void ) { return mClamp; }
+    inline bool isInAtlas( void ) { return mInAtlas; }
+    inline const RectI& getAtlasRect( void ) { return mAtlasRect; }
     inline TextureHandle::TextureHandleType getHandleType( void ) { return mHandleType; }
 
     inline bgfx::TextureHandle getBGFXTexture( void ) { return mBGFXTexture; }
@@ -176,6 +176,8 @@ namespace Graphics
          bgfx::init(bgfx::RendererType::Metal, 0, 0, &sBGFXCallback);
       else if (dStrcmp(renderer, "Vulkan") == 0)
          bgfx::init(bgfx::RendererType::Vulkan, 0, 0, &sBGFXCallback);
+      else if (dStrcmp(renderer, "Null") == 0)
+         bgfx::init(bgfx::RendererType::Null, 0, 0, &sBGFXCallback); // No GPU work, for profiling.
       else
          bgfx::init(bgfx::RendererType::Count, 0, 0, &sBGFXCallback); // Auto-select.
 
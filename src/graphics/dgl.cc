@@ -23,6 +23,7 @@
 #include "math/mPoint.h"
 #include "graphics/TextureManager.h"
 #include "graphics/dgl.h"
+#include "graphics/dglBatch.h"
 #include "graphics/color.h"
 #include "graphics/shaders.h"
 #include "graphics/core.h"
@@ -64,14 +65,33 @@ void dglInit()
 {
    v_TorqueGUIBottom = Graphics::getView("TorqueGUIBottom", 0);
    v_TorqueGUITop    = Graphics::getView("TorqueGUITop", S32_MAX - 1000);
+
+   dglBatchInit();
 }
 
 void dglDestroy()
 {
+   dglBatchDestroy();
+
    if ( nvgContext != NULL )
       nvgDelete(nvgContext);
 }
 
+static inline U32 dglColorToABGR(const ColorI& color)
+{
+   return BGFXCOLOR_RGBA(color.alpha, color.blue, color.green, color.red);
+}
+
+static void dglBatchRect(F32 x0, F32 y0, F32 x1, F32 y1, const ColorI& color)
+{
+   Point2F points[4];
+   points[0].set(x0, y0);
+   points[1].set(x1, y0);
+   points[2].set(x1, y1);
+   points[3].set(x0, y1);
+   dglBatchSolidQuad(points, dglColorToABGR(color));
+}
+
 //--------------------------------------------------------------------------
 void dglSetBitmapModulation(const ColorF& in_rColor)
 {
@@ -112,23 +132,56 @@ void dglDrawBitmapStretchSR(TextureObject* texture,
                        F32          fSpin,
                        bool            bSilhouette)
 {   
-   // TODO: I hate loading things this way, will clean up later.
-   if ( dglGUIShader == NULL )
-      dglGUIShader = Graphics::getDefaultShader("gui/gui_vs.tsh", "gui/gui_fs.tsh");
-
    AssertFatal(texture != NULL, "GSurface::drawBitmapStretchSR: NULL Handle");
    if(!dstRect.isValidRect())
       return;
    AssertFatal(srcRect.isValidRect() == true,
                "GSurface::drawBitmapStretchSR: routiin nes assume normal rects");
- 
-   dglScreenQuadSrc(dstRect.point.x, dstRect.point.y, dstRect.extent.x, dstRect.extent.y,
-      (F32)srcRect.point.x, (F32)srcRect.point.y, (F32)srcRect.extent.x, (F32)srcRect.extent.y, 
-      (F32)texture->getTextureWidth(), (F32)texture->getTextureHeight());
 
-   bgfx::setTexture(0, Graphics::Shader::getTextureUniform(0), texture->getBGFXTexture());
-   bgfx::setState(BGFX_STATE_RGB_WRITE | BGFX_STATE_ALPHA_WRITE | BGFX_STATE_BLEND_ALPHA);
-   bgfx::submit(v_TorqueGUITop->id, dglGUIShader->mProgram);
+   const bgfx::RendererType::Enum renderer = bgfx::getRendererType();
+   const bool originBottomLeft = bgfx::RendererType::OpenGL == renderer || bgfx::RendererType::OpenGLES == renderer;
+   const F32 halfTexel = (bgfx::RendererType::Direct3D9 == renderer) ? 0.5f : 0.0f;
+
+   bgfx::TextureHandle textureHandle = texture->getBGFXTexture();
+   F32 textureWidth  = (F32)texture->getTextureWidth();
+   F32 textureHeight = (F32)texture->getTextureHeight();
+   F32 srcX          = (F32)srcRect.point.x;
+   F32 srcY          = (F32)srcRect.point.y;
+
+   // Small bitmaps are drawn from the GUI atlas unless we're tiling past their edges.
+   if ( texture->isInAtlas() )
+   {
+      const RectI& atlasRect = texture->getAtlasRect();
+      if ( srcRect.point.x >= 0 && srcRect.point.y >= 0 
+         && srcRect.point.x + srcRect.extent.x <= atlasRect.extent.x 
+         && srcRect.point.y + srcRect.extent.y <= atlasRect.extent.y )
+      {
+         textureHandle  = dglAtlasGetTexture();
+         textureWidth   = (F32)dglAtlasGetSize();
+         textureHeight  = (F32)dglAtlasGetSize();
+         srcX          += (F32)atlasRect.point.x;
+         srcY          += (F32)atlasRect.point.y;
+      }
+   }
+
+   const F32 texelHalfW = halfTexel / textureWidth;
+   const F32 texelHalfH = halfTexel / textureHeight;
+   F32 u0 = texelHalfW + (srcX / textureWidth);
+   F32 u1 = ((srcX + srcRect.extent.x) / textureWidth) - texelHalfW;
+   F32 v0 = texelHalfH + (srcY / textureHeight);
+   F32 v1 = texelHalfH + ((srcY + srcRect.extent.y) / textureHeight);
+
+   if ( originBottomLeft )
+      mSwap(v0, v1);
+   if ( in_flip & GFlip_X )
+      mSwap(u0, u1);
+   if ( in_flip & GFlip_Y )
+      mSwap(v0, v1);
+
+   dglBatchQuad(textureHandle, 
+      (F32)dstRect.point.x, (F32)dstRect.point.y, 
+      (F32)(dstRect.point.x + dstRect.extent.x), (F32)(dstRect.point.y + dstRect.extent.y),
+      u0, v0, u1, v1, dglColorToABGR(sg_bitmapModulation));
 }
 
 void dglDrawBitmap(TextureObject* texture, const Point2I& in_rAt, const U32 in_flip)
@@ -304,17 +357,23 @@ U32 dglDrawTextN(GFont*          font,
 
 void dglDrawLine(S32 x1, S32 y1, S32 x2, S32 y2, const ColorI &color, F32 lineWidth)
 {
-   NVGcontext* nvg = dglGetNVGContext();
-   if (nvg)
-   {
-      nvgBeginPath(nvg);
-      
-      nvgMoveTo(nvg, (F32)x1, (F32)y1);
-      nvgLineTo(nvg, (F32)x2, (F32)y2);
-      nvgStrokeColor(nvg, nvgRGBA(color.red, color.green, color.blue, color.alpha));
-      nvgStrokeWidth(nvg, lineWidth);
-      nvgStroke(nvg);
-   }
+   F32 dirX = (F32)(x2 - x1);
+   F32 dirY = (F32)(y2 - y1);
+   const F32 len = mSqrt(dirX * dirX + dirY * dirY);
+   if ( len < 0.0001f )
+      return;
+
+   // Extrude the line into a quad.
+   const F32 scale = (lineWidth * 0.5f) / len;
+   const F32 normalX = -dirY * scale;
+   const F32 normalY = dirX * scale;
+
+   Point2F points[4];
+   points[0].set(x1 + normalX, y1 + normalY);
+   points[1].set(x2 + normalX, y2 + normalY);
+   points[2].set(x2 - normalX, y2 - normalY);
+   points[3].set(x1 - normalX, y1 - normalY);
+   dglBatchSolidQuad(points, dglColorToABGR(color));
 }
 
 void dglDrawLine(const Point2I &startPt, const Point2I &endPt, const ColorI &color, F32 lineWidth)
@@ -324,14 +383,18 @@ void dglDrawLine(const Point2I &startPt, const Point2I &endPt, const ColorI &col
 
 void dglDrawRect(const Point2I &upperL, const Point2I &lowerR, const ColorI &color, const float &lineWidth)
 {
-   NVGcontext* nvg = dglGetNVGContext();
-   if (!nvg) return;
-
-   nvgBeginPath(nvg);
-   nvgRect(nvg, (F32)upperL.x, (F32)upperL.y, (F32)(lowerR.x - upperL.x), (F32)(lowerR.y - upperL.y));
-   nvgStrokeColor(nvg, nvgRGBA(color.red, color.green, color.blue, color.alpha));
-   nvgStrokeWidth(nvg, lineWidth);
-   nvgStroke(nvg);
+   const F32 halfWidth = lineWidth * 0.5f;
+   const F32 x0 = (F32)upperL.x;
+   const F32 y0 = (F32)upperL.y;
+   const F32 x1 = (F32)lowerR.x;
+   const F32 y1 = (F32)lowerR.y;
+
+   // Strokes are centered on the edges. The sides don't overlap the top and
+   // bottom so translucent corners aren't blended twice.
+   dglBatchRect(x0 - halfWidth, y0 - halfWidth, x1 + halfWidth, y0 + halfWidth, color);
+   dglBatchRect(x0 - halfWidth, y1 - halfWidth, x1 + halfWidth, y1 + halfWidth, color);
+   dglBatchRect(x0 - halfWidth, y0 + halfWidth, x0 + halfWidth, y1 - halfWidth, color);
+   dglBatchRect(x1 - halfWidth, y0 + halfWidth, x1 + halfWidth, y1 - halfWidth, color);
 }
 
 // the fill convention for lined rects is that they outline the rectangle border of the
@@ -348,13 +411,7 @@ void dglDrawRect(const RectI &rect, const ColorI &color, const float &lineWidth)
 
 void dglDrawRectFill(const Point2I &upperL, const Point2I &lowerR, const ColorI &color)
 {
-   NVGcontext* nvg = dglGetNVGContext();
-   if ( !nvg ) return;
-  
-   nvgBeginPath(nvg);
-   nvgRect(nvg, (F32)upperL.x, (F32)upperL.y, (F32)(lowerR.x - upperL.x), (F32)(lowerR.y - upperL.y));
-   nvgFillColor(nvg, nvgRGBA(color.red, color.green, color.blue, color.alpha));
-   nvgFill(nvg);
+   dglBatchRect((F32)upperL.x, (F32)upperL.y, (F32)lowerR.x, (F32)lowerR.y, color);
 }
 
 void dglDrawRectFill(const RectI &rect, const ColorI &color)
@@ -602,6 +659,9 @@ void dglSolidCube(const Point3F & extent, const Point3F & center)
 
 void dglSetClipRect(const RectI &clipRect)
 {
+   sgCurrentClipRect = clipRect;
+   dglBatchSetScissor(clipRect);
+
 /*   glMatrixMode(GL_PROJECTION);
    glLoadIdentity();
 
@@ -954,7 +1014,11 @@ GLfloat gTextureVerts[8];
 NVGcontext* dglGetNVGContext()
 {
    if ( nvgContext != NULL )
+   {
+      // Anything drawn with NanoVG from here on must land after pending batched quads.
+      dglBatchBeginNVG();
       return nvgContext;
+   }
 
    Point2I size = Platform::getWindowSize();
    nvgContext = nvgCreate(1, v_TorqueGUITop->id);
@@ -975,11 +1039,15 @@ void dglBeginFrame()
    bgfx::setViewTransform(v_TorqueGUITop->id, NULL, ortho);
    bgfx::setViewRect(v_TorqueGUITop->id, 0, 0, size.x, size.y);
    bgfx::setViewSeq(v_TorqueGUITop->id, true);
+
+   dglBatchBeginFrame();
 }
 
 void dglEndFrame()
 {
-   if ( !dglGetNVGContext() ) return;
+   dglBatchEndFrame();
+
+   if ( nvgContext == NULL ) return;
    nvgEndFrame(nvgContext);
 }
 
@@ -1168,6 +1236,7 @@ void drawCircle3D(U8 viewID, Point3F position, F32 radius, U32 segments, ColorI
       bgfx::setTransform(transform);
 
    bgfx::submit(viewID, dglGUIColorShader->mProgram);
+   PROFILE_COUNT(DrawCalls, 1);
 }
 
 void drawCone3D(U8 viewID, Point3F position, F32 length, F32 radius, U32 segments, ColorI baseColor, ColorI tipColor, F32* transform)
@@ -1260,6 +1329,7 @@ void drawCone3D(U8 viewID, Point3F position, F32 length, F32 radius, U32 segment
       bgfx::setTransform(transform);
 
    bgfx::submit(viewID, dglGUIColorShader->mProgram);
+   PROFILE_COUNT(DrawCalls, 1);
 }
 
 void drawLine3D(U8 viewID, Point3F start, Point3F end, ColorI color, F32* transform)
@@ -1301,6 +1371,7 @@ void drawLine3D(U8 viewID, Point3F start, Point3F end, ColorI color, F32* transf
       bgfx::setTransform(transform);
 
    bgfx::submit(viewID, dglGUIColorShader->mProgram);
+   PROFILE_COUNT(DrawCalls, 1);
 }
 
 void drawBox3D(U8 viewID, Box3F box, ColorI color, F32* transform)
@@ -1372,6 +1443,7 @@ void drawBox3D(U8 viewID, Box3F box, ColorI color, F32* transform)
       bgfx::setTransform(transform);
 
    bgfx::submit(viewID, dglGUIColorShader->mProgram);
+   PROFILE_COUNT(DrawCalls, 1);
 }
 
 void drawPlane3D(U8 viewID, Point3F position, F32 width, F32 height, ColorI color, F32* transform)
@@ -1439,6 +1511,7 @@ void drawPlane3D(U8 viewID, Point3F position, F32 width, F32 height, ColorI colo
       bgfx::setTransform(transform);
 
    bgfx::submit(viewID, dglGUIColorShader->mProgram);
+   PROFILE_COUNT(DrawCalls, 1);
 }
 
 void drawBillboard(U8 viewID, TextureObject* texture, Point3F position, F32 width, F32 height, ColorI color, F32* transform)
@@ -1516,6 +1589,7 @@ void drawBillboard(U8 viewID, TextureObject* texture, Point3F position, F32 widt
 
    bgfx::setTexture(0, Graphics::Shader::getTextureUniform(0), texture->getBGFXTexture());
    bgfx::submit(viewID, dglGUIBillboardShader->mProgram);
+   PROFILE_COUNT(DrawCalls, 1);
 }
 
 void screenSpaceQuad(F32 _x, F32 _y, F32 _width, F32 _height, F32 _targetWidth, F32 _targetHeight)
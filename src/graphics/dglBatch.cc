@@ -0,0 +1,387 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2013 GarageGames, LLC
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//-----------------------------------------------------------------------------
+
+#include "graphics/dglBatch.h"
+#include "graphics/dgl.h"
+#include "graphics/gBitmap.h"
+#include "graphics/shaders.h"
+#include "graphics/viewTable.h"
+#include "console/console.h"
+#include "console/consoleTypes.h"
+#include "debug/profiler.h"
+
+#include <bgfx/bgfx.h>
+
+//------------------------------------------------------------------------------
+
+namespace {
+
+struct GuiBatchVertex
+{
+   F32 m_x;
+   F32 m_y;
+   F32 m_u;
+   F32 m_v;
+   U32 m_abgr;
+};
+
+// Indices are 16-bit so a single draw can't reference more than this.
+const U32 MaxBatchQuads = 16384 / 4;
+
+bgfx::VertexDecl           sBatchDecl;
+Graphics::Shader*          sBatchShader = NULL;
+Vector<GuiBatchVertex>     sBatchVertices;
+bgfx::TextureHandle        sBatchTexture = BGFX_INVALID_HANDLE;
+RectI                      sBatchScissor(0, 0, 0, 0);
+RectI                      sScissor(0, 0, 0, 0);
+bool                       sInFrame = false;
+bool                       sNVGPending = false;
+
+// Per-frame statistics, published to the console at the end of each frame.
+S32                        sFrameDrawCalls = 0;
+S32                        sFrameQuads = 0;
+S32                        sFrameNVGFlushes = 0;
+S32                        sDrawCalls = 0;
+S32                        sQuads = 0;
+S32                        sNVGFlushes = 0;
+bool                       sScissorEnabled = false;
+
+// Atlas
+const U32                  AtlasSize = 1024;
+const U32                  AtlasWhiteSize = 4;
+bgfx::TextureHandle        sAtlasTexture = BGFX_INVALID_HANDLE;
+U32                        sAtlasCursorX = 0;
+U32                        sAtlasCursorY = 0;
+U32                        sAtlasRowHeight = 0;
+S32                        sAtlasEntries = 0;
+
+} // namespace {}
+
+//------------------------------------------------------------------------------
+
+static void createAtlas()
+{
+   if ( bgfx::isValid(sAtlasTexture) )
+      return;
+
+   sAtlasTexture = bgfx::createTexture2D(AtlasSize, AtlasSize, 1, bgfx::TextureFormat::RGBA8, BGFX_TEXTURE_U_CLAMP | BGFX_TEXTURE_V_CLAMP);
+
+   // The top left corner is kept white for untextured quads.
+   const bgfx::Memory* mem = bgfx::alloc(AtlasWhiteSize * AtlasWhiteSize * 4);
+   dMemset(mem->data, 0xFF, mem->size);
+   bgfx::updateTexture2D(sAtlasTexture, 0, 0, 0, AtlasWhiteSize, AtlasWhiteSize, mem);
+
+   sAtlasCursorX     = AtlasWhiteSize;
+   sAtlasCursorY     = 0;
+   sAtlasRowHeight   = AtlasWhiteSize;
+   sAtlasEntries     = 0;
+}
+
+static void flushNVG()
+{
+   sNVGPending = false;
+   if ( nvgContext == NULL )
+      return;
+
+   // Render what NanoVG has so far and start a new frame for anything after.
+   Point2I size = Platform::getWindowSize();
+   nvgEndFrame(nvgContext);
+   nvgBeginFrame(nvgContext, size.x, size.y, 1.0f);
+   sFrameNVGFlushes++;
+}
+
+static GuiBatchVertex* allocQuad(bgfx::TextureHandle texture)
+{
+   // Keep painter's order with NanoVG.
+   if ( sNVGPending )
+      flushNVG();
+
+   // Break the batch on state changes.
+   if ( sBatchVertices.size() > 0 )
+   {
+      if ( texture.idx != sBatchTexture.idx 
+         || (sScissorEnabled && sScissor != sBatchScissor) 
+         || sBatchVertices.size() >= (S32)(MaxBatchQuads * 4) )
+         dglBatchFlush();
+   }
+
+   sBatchTexture = texture;
+   sBatchScissor = sScissor;
+
+   sBatchVertices.increment(4);
+   return &sBatchVertices[sBatchVertices.size() - 4];
+}
+
+//------------------------------------------------------------------------------
+
+void dglBatchInit()
+{
+   sBatchDecl
+      .begin()
+      .add(bgfx::Attrib::Position,  2, bgfx::AttribType::Float)
+      .add(bgfx::Attrib::TexCoord0, 2, bgfx::AttribType::Float)
+      .add(bgfx::Attrib::Color0,    4, bgfx::AttribType::Uint8, true)
+      .end();
+
+   sBatchVertices.reserve(MaxBatchQuads * 4);
+
+   sBatchShader = Graphics::getDefaultShader("gui/gui_batch_vs.tsh", "gui/gui_batch_fs.tsh");
+
+   Con::addVariable("$GUI::drawCalls", TypeS32, &sDrawCalls);
+   Con::addVariable("$GUI::batchedQuads", TypeS32, &sQuads);
+   Con::addVariable("$GUI::nvgFlushes", TypeS32, &sNVGFlushes);
+   Con::addVariable("$GUI::atlasEntries", TypeS32, &sAtlasEntries);
+   Con::addVariable("$GUI::scissor", TypeBool, &sScissorEnabled);
+}
+
+void dglBatchDestroy()
+{
+   sBatchVertices.clear();
+   sBatchVertices.compact();
+   sBatchShader = NULL;
+
+   if ( bgfx::isValid(sAtlasTexture) )
+      bgfx::destroyTexture(sAtlasTexture);
+   sAtlasTexture.idx = bgfx::invalidHandle;
+}
+
+void dglBatchBeginFrame()
+{
+   sInFrame          = true;
+   sNVGPending       = false;
+   sFrameDrawCalls   = 0;
+   sFrameQuads       = 0;
+   sFrameNVGFlushes  = 0;
+}
+
+void dglBatchEndFrame()
+{
+   dglBatchFlush();
+   sInFrame = false;
+
+   // The final NanoVG flush happens in dglEndFrame.
+   sDrawCalls  = sFrameDrawCalls;
+   sQuads      = sFrameQuads;
+   sNVGFlushes = sFrameNVGFlushes + 1;
+}
+
+void dglBatchQuad(bgfx::TextureHandle texture, F32 x0, F32 y0, F32 x1, F32 y1, F32 u0, F32 v0, F32 u1, F32 v1, U32 abgr)
+{
+   GuiBatchVertex* vertex = allocQuad(texture);
+
+   vertex[0].m_x = x0;
+   vertex[0].m_y = y0;
+   vertex[0].m_u = u0;
+   vertex[0].m_v = v0;
+   vertex[0].m_abgr = abgr;
+
+   vertex[1].m_x = x1;
+   vertex[1].m_y = y0;
+   vertex[1].m_u = u1;
+   vertex[1].m_v = v0;
+   vertex[1].m_abgr = abgr;
+
+   vertex[2].m_x = x1;
+   vertex[2].m_y = y1;
+   vertex[2].m_u = u1;
+   vertex[2].m_v = v1;
+   vertex[2].m_abgr = abgr;
+
+   vertex[3].m_x = x0;
+   vertex[3].m_y = y1;
+   vertex[3].m_u = u0;
+   vertex[3].m_v = v1;
+   vertex[3].m_abgr = abgr;
+
+   if ( !sInFrame )
+      dglBatchFlush();
+}
+
+void dglBatchSolidQuad(const Point2F* points, U32 abgr)
+{
+   createAtlas();
+   GuiBatchVertex* vertex = allocQuad(sAtlasTexture);
+
+   // Sample the middle of the white block.
+   const F32 whiteUV = (AtlasWhiteSize * 0.5f) / AtlasSize;
+   for ( U32 i = 0; i < 4; ++i )
+   {
+      vertex[i].m_x = points[i].x;
+      vertex[i].m_y = points[i].y;
+      vertex[i].m_u = whiteUV;
+      vertex[i].m_v = whiteUV;
+      vertex[i].m_abgr = abgr;
+   }
+
+   if ( !sInFrame )
+      dglBatchFlush();
+}
+
+void dglBatchFlush()
+{
+   const U32 quadCount = sBatchVertices.size() / 4;
+   if ( quadCount == 0 )
+      return;
+
+   PROFILE_SCOPE(dglBatchFlush);
+
+   const U32 vertexCount = quadCount * 4;
+   const U32 indexCount = quadCount * 6;
+   if ( !bgfx::checkAvailTransientBuffers(vertexCount, sBatchDecl, indexCount) )
+   {
+      sBatchVertices.clear();
+      return;
+   }
+
+   bgfx::TransientVertexBuffer vb;
+   bgfx::TransientIndexBuffer ib;
+   bgfx::allocTransientBuffers(&vb, sBatchDecl, vertexCount, &ib, indexCount);
+   dMemcpy(vb.data, sBatchVertices.address(), vertexCount * sizeof(GuiBatchVertex));
+
+   U16* index = (U16*)ib.data;
+   for ( U32 i = 0; i < quadCount; ++i )
+   {
+      const U16 base = (U16)(i * 4);
+      index[0] = base;
+      index[1] = base + 1;
+      index[2] = base + 2;
+      index[3] = base;
+      index[4] = base + 2;
+      index[5] = base + 3;
+      index += 6;
+   }
+
+   bgfx::setVertexBuffer(&vb);
+   bgfx::setIndexBuffer(&ib);
+   bgfx::setTexture(0, Graphics::Shader::getTextureUniform(0), sBatchTexture);
+
+   if ( sScissorEnabled && sBatchScissor.isValidRect() )
+      bgfx::setScissor(sBatchScissor.point.x, sBatchScissor.point.y, sBatchScissor.extent.x, sBatchScissor.extent.y);
+
+   bgfx::setState(BGFX_STATE_RGB_WRITE | BGFX_STATE_ALPHA_WRITE | BGFX_STATE_BLEND_ALPHA);
+   bgfx::submit(v_TorqueGUITop->id, sBatchShader->mProgram);
+   PROFILE_COUNT(DrawCalls, 1);
+
+   sFrameDrawCalls++;
+   sFrameQuads += quadCount;
+   sBatchVertices.clear();
+}
+
+bool dglBatchHasPending()
+{
+   return sBatchVertices.size() > 0;
+}
+
+void dglBatchBeginNVG()
+{
+   if ( !sInFrame )
+      return;
+
+   dglBatchFlush();
+   sNVGPending = true;
+}
+
+void dglBatchSetScissor(const RectI& rect)
+{
+   sScissor = rect;
+}
+
+//------------------------------------------------------------------------------
+
+bool dglAtlasInsert(const GBitmap* bitmap, RectI& rect)
+{
+   const U32 width = bitmap->getWidth();
+   const U32 height = bitmap->getHeight();
+   if ( width > DGLAtlasMaxBitmapSize || height > DGLAtlasMaxBitmapSize )
+      return false;
+
+   const GBitmap::BitmapFormat format = bitmap->getFormat();
+   if ( format != GBitmap::RGBA && format != GBitmap::RGB )
+      return false;
+
+   createAtlas();
+
+   // Reuse the old location if the size didn't change, otherwise take
+   // the next spot on the current row. The atlas doesn't reclaim space,
+   // once it's full, bitmaps keep using their own textures.
+   const U32 paddedWidth = width + 2;
+   const U32 paddedHeight = height + 2;
+   U32 x, y;
+   if ( rect.extent.x == (S32)width && rect.extent.y == (S32)height )
+   {
+      x = rect.point.x - 1;
+      y = rect.point.y - 1;
+   }
+   else
+   {
+      if ( sAtlasCursorX + paddedWidth > AtlasSize )
+      {
+         sAtlasCursorX = 0;
+         sAtlasCursorY += sAtlasRowHeight;
+         sAtlasRowHeight = 0;
+      }
+
+      if ( sAtlasCursorY + paddedHeight > AtlasSize )
+         return false;
+
+      x = sAtlasCursorX;
+      y = sAtlasCursorY;
+      sAtlasCursorX += paddedWidth;
+      sAtlasRowHeight = getMax(sAtlasRowHeight, paddedHeight);
+      sAtlasEntries++;
+   }
+
+   // Copy with a one pixel border of repeated edge pixels so filtering
+   // doesn't bleed neighbouring entries.
+   const U32 bytesPerPixel = bitmap->bytesPerPixel;
+   const bgfx::Memory* mem = bgfx::alloc(paddedWidth * paddedHeight * 4);
+   U8* dest = mem->data;
+   for ( U32 py = 0; py < paddedHeight; ++py )
+   {
+      const U32 sy = (U32)mClamp((S32)py - 1, 0, (S32)height - 1);
+      for ( U32 px = 0; px < paddedWidth; ++px )
+      {
+         const U32 sx = (U32)mClamp((S32)px - 1, 0, (S32)width - 1);
+         const U8* src = bitmap->getAddress(sx, sy);
+         dest[0] = src[0];
+         dest[1] = src[1];
+         dest[2] = src[2];
+         dest[3] = bytesPerPixel == 4 ? src[3] : 255;
+         dest += 4;
+      }
+   }
+   bgfx::updateTexture2D(sAtlasTexture, 0, (U16)x, (U16)y, (U16)paddedWidth, (U16)paddedHeight, mem);
+
+   rect.set(x + 1, y + 1, width, height);
+   return true;
+}
+
+bgfx::TextureHandle dglAtlasGetTexture()
+{
+   createAtlas();
+   return sAtlasTexture;
+}
+
+U32 dglAtlasGetSize()
+{
+   return AtlasSize;
+}
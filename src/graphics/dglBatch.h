@@ -0,0 +1,93 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2013 GarageGames, LLC
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//-----------------------------------------------------------------------------
+
+#ifndef _DGL_BATCH_H_
+#define _DGL_BATCH_H_
+
+#ifndef _PLATFORM_H_
+#include "platform/platform.h"
+#endif
+
+#ifndef _MPOINT_H_
+#include "math/mPoint.h"
+#endif
+
+#ifndef _MRECT_H_
+#include "math/mRect.h"
+#endif
+
+#ifndef BGFX_H_HEADER_GUARD
+#include <bgfx/bgfx.h>
+#endif
+
+class GBitmap;
+
+//------------------------------------------------------------------------------
+/// GUI batch renderer.
+///
+/// dgl bitmap, rect and line calls are gathered into quads and submitted with
+/// as few draw calls as possible. Consecutive quads that share a texture and
+/// scissor rect go into the same draw, and small GUI bitmaps are copied into a
+/// shared atlas so that most of the GUI shares a single texture.
+///
+/// NanoVG is still used for text and for anything that calls it directly.
+/// Because both submit to the same sequential view, the batch and NanoVG are
+/// flushed whenever drawing switches from one to the other, which keeps the
+/// painter's order of the dgl calls.
+//------------------------------------------------------------------------------
+
+void dglBatchInit();
+void dglBatchDestroy();
+void dglBatchBeginFrame();
+void dglBatchEndFrame();
+
+/// Add a textured quad. UVs are in texture space (0-1).
+void dglBatchQuad(bgfx::TextureHandle texture, F32 x0, F32 y0, F32 x1, F32 y1, F32 u0, F32 v0, F32 u1, F32 v1, U32 abgr);
+
+/// Add an untextured quad with arbitrary corners, in clockwise order.
+void dglBatchSolidQuad(const Point2F* points, U32 abgr);
+
+/// Submit pending quads.
+void dglBatchFlush();
+bool dglBatchHasPending();
+
+/// Called by dglGetNVGContext() so NanoVG drawing lands after pending quads.
+void dglBatchBeginNVG();
+
+/// Scissor rect used for subsequent quads. Only applied when $GUI::scissor is enabled.
+void dglBatchSetScissor(const RectI& rect);
+
+//------------------------------------------------------------------------------
+// GUI Atlas
+//------------------------------------------------------------------------------
+
+/// Largest bitmap dimension that will be placed into the atlas.
+const U32 DGLAtlasMaxBitmapSize = 64;
+
+/// Try to copy a bitmap into the atlas. On success, rect receives the location
+/// of the bitmap in atlas pixels. If rect already holds an atlas location of the
+/// same size, the bitmap is copied over it instead of taking new space.
+bool dglAtlasInsert(const GBitmap* bitmap, RectI& rect);
+bgfx::TextureHandle dglAtlasGetTexture();
+U32 dglAtlasGetSize();
+
+#endif // _DGL_BATCH_H_
@@ -45,6 +45,8 @@
 #include "dgl.h"
 
 S32 GFont::smSheetIdCount = 0;
+S32 GFont::smEmptyRemapPage[GFont::RemapPageSize];
+bool GFont::smEmptyRemapPageReady = GFont::initEmptyRemapPage();
 const U32 GFont::csm_fileVersion = 3;
 
 // TODO: Move this and clean it up properly.
@@ -174,8 +176,8 @@ GFont::GFont()
    VECTOR_SET_ASSOCIATION(mCharInfoList);
    VECTOR_SET_ASSOCIATION(mTextureSheets);
 
-   for (U32 i = 0; i < (sizeof(mRemapTable) / sizeof(S32)); i++)
-      mRemapTable[i] = -1;
+   for (U32 i = 0; i < RemapPageCount; i++)
+      mRemapPages[i] = smEmptyRemapPage;
 
    mCurX = mCurY = mCurSheet = -1;
 
@@ -224,6 +226,8 @@ GFont::~GFont()
    {
        mTextureSheets[i] = 0;
    }
+
+   clearRemap();
    
    SAFE_DELETE(mPlatformFont);
    SAFE_DELETE(mTTFHandle);
@@ -232,19 +236,80 @@ GFont::~GFont()
    Mutex::destroyMutex(mMutex);
 }
 
+bool GFont::initEmptyRemapPage()
+{
+   for (U32 i = 0; i < RemapPageSize; i++)
+      smEmptyRemapPage[i] = -1;
+
+   return true;
+}
+
+void GFont::setRemap(const UTF16 ch, S32 index)
+{
+   S32*& page = mRemapPages[ch >> RemapPageBits];
+   if(page == smEmptyRemapPage)
+   {
+      if(index == -1)
+         return;
+
+      page = new S32[RemapPageSize];
+      dMemcpy(page, smEmptyRemapPage, sizeof(smEmptyRemapPage));
+   }
+
+   page[ch & (RemapPageSize - 1)] = index;
+}
+
+void GFont::clearRemap()
+{
+   for (U32 i = 0; i < RemapPageCount; i++)
+   {
+      if(mRemapPages[i] != smEmptyRemapPage)
+         delete [] mRemapPages[i];
+      mRemapPages[i] = smEmptyRemapPage;
+   }
+}
+
+U32 GFont::getMemoryUsage()
+{
+   U32 bytes = sizeof(GFont);
+
+   for (U32 i = 0; i < RemapPageCount; i++)
+   {
+      if(mRemapPages[i] != smEmptyRemapPage)
+         bytes += sizeof(smEmptyRemapPage);
+   }
+
+   bytes += mCharInfoList.capacity() * sizeof(PlatformFont::CharInfo);
+
+   // Sheets keep their bitmap around, so count it along with the texture.
+   for(S32 i = 0; i < mTextureSheets.size(); i++)
+   {
+      const GBitmap* bmp = mTextureSheets[i].getBitmap();
+      if(bmp)
+         bytes += 2 * bmp->byteSize;
+   }
+
+   return bytes;
+}
+
 void GFont::dumpInfo()
 {
    // Number and extent of mapped characters?
-   U32 mapCount = 0, mapBegin=0xFFFF, mapEnd=0;
+   U32 mapCount = 0, mapBegin=0xFFFF, mapEnd=0, pageCount=0;
    for(U32 i=0; i<0x10000; i++)
    {
-      if(mRemapTable[i] != -1)
+      if(getRemap(i) != -1)
       {
          mapCount++;
          if(i<mapBegin) mapBegin = i;
          if(i>mapEnd)   mapEnd   = i;
       }
    }
+   for(U32 i=0; i<RemapPageCount; i++)
+   {
+      if(mRemapPages[i] != smEmptyRemapPage)
+         pageCount++;
+   }
 
 
    // Let's write out all the info we can on this font.
@@ -256,13 +321,15 @@ void GFont::dumpInfo()
    else
       Con::printf("      - No mapped codepoints.", mapBegin, mapEnd);
    Con::printf("      - Platform font is %s.", (mPlatformFont ? "present" : "not present") );
+   Con::printf("      - %d remap pages.", pageCount);
+   Con::printf("      - Memory: %d KB.", getMemoryUsage() / 1024);
 }
 
 //////////////////////////////////////////////////////////////////////////
 
 bool GFont::loadCharInfo(const UTF16 ch)
 {
-    if(mRemapTable[ch] != -1)
+    if(getRemap(ch) != -1)
         return true;    // Not really an error
 
     // bgfx font manager.
@@ -275,8 +342,9 @@ bool GFont::loadCharInfo(const UTF16 ch)
        ci.xOrigin = (S32)chInfo->offset_x;
        ci.yOrigin = (S32)chInfo->offset_y;
        ci.xIncrement = (S32)chInfo->advance_x;
+       ci.bitmapIndex = -1;
        mCharInfoList.push_back(ci);
-       mRemapTable[ch] = mCharInfoList.size() - 1;
+       setRemap(ch, mCharInfoList.size() - 1);
        return true;
     }
 
@@ -285,11 +353,14 @@ bool GFont::loadCharInfo(const UTF16 ch)
     {
         Mutex::lockMutex(mMutex); // the CharInfo returned by mPlatformFont is static data, must protect from changes.
         PlatformFont::CharInfo &ci = mPlatformFont->getCharInfo(ch);
-        if(ci.bitmapData)
-            addBitmap(ci);
+
+        // Text is drawn by NanoVG, only the metrics are kept. The platform
+        // font allocates the glyph bitmap and leaves it to us.
+        SAFE_DELETE_ARRAY(ci.bitmapData);
+        ci.bitmapIndex = -1;
 
         mCharInfoList.push_back(ci);
-        mRemapTable[ch] = mCharInfoList.size() - 1;
+        setRemap(ch, mCharInfoList.size() - 1);
 //don't save UFTs on the iPhone or android device
 #if !defined(TORQUE_OS_IOS) && !defined(TORQUE_OS_ANDROID) && !defined(TORQUE_OS_EMSCRIPTEN)
         mNeedSave = true;
@@ -302,109 +373,6 @@ bool GFont::loadCharInfo(const UTF16 ch)
     return false;
 }
 
-void GFont::addBitmap(PlatformFont::CharInfo &charInfo)
-{
-   // If this is called inside a glBegin - glEnd block, the texture will not be
-   // updated properly.
-
-   U32 nextCurX = U32(mCurX + charInfo.width ); /*7) & ~0x3;*/
-   U32 nextCurY = U32(mCurY + mPlatformFont->getFontHeight()); // + 7) & ~0x3;
-
-   // These are here for postmortem debugging.
-   bool routeA = false, routeB = false;
-
-   if(mCurSheet == -1 || nextCurY >= TextureSheetSize)
-   {
-      routeA = true;
-      addSheet();
-
-      // Recalc our nexts.
-      nextCurX = U32(mCurX + charInfo.width); // + 7) & ~0x3;
-      nextCurY = U32(mCurY + mPlatformFont->getFontHeight()); // + 7) & ~0x3;
-   }
-
-   if( nextCurX >= TextureSheetSize)
-   {
-      routeB = true;
-      mCurX = 0;
-      mCurY = nextCurY;
-
-      // Recalc our nexts.
-      nextCurX = U32(mCurX + charInfo.width); // + 7) & ~0x3;
-      nextCurY = U32(mCurY + mPlatformFont->getFontHeight()); // + 7) & ~0x3;
-   }
-
-   // Check the Y once more - sometimes we advance to a new row and run off
-   // the end.
-   if(nextCurY >= TextureSheetSize)
-   {
-      routeA = true;
-      addSheet();
-
-      // Recalc our nexts.
-      nextCurX = U32(mCurX + charInfo.width); // + 7) & ~0x3;
-      nextCurY = U32(mCurY + mPlatformFont->getFontHeight()); // + 7) & ~0x3;
-   }
-
-    charInfo.bitmapIndex = mCurSheet;
-    charInfo.xOffset = mCurX;
-    charInfo.yOffset = mCurY;
-
-   mCurX = nextCurX;
-
-   GBitmap *bmp = mTextureSheets[mCurSheet].getBitmap();
-
-   AssertFatal(bmp, "GFont::addBitmap - null texture sheet bitmap!");
-   AssertFatal(bmp->getFormat() == GBitmap::Alpha, "GFont::addBitmap - cannot added characters to non-greyscale textures!");
-   
-   // [neo, 5/7/2007 - #3050]
-   // If we get large font sizes charInfo.height/width will be larger than TextureSheetSize
-   // and as GBitmap::getAddress() does no range checking the following will overrun memory! 
-   // Added checks against TextureSheetSize
-   for( U32 y = 0; y < charInfo.height; y++ )
-   {
-      S32 dy = y + charInfo.yOffset;
-
-      if( dy >= TextureSheetSize )
-         break;
-
-      for( U32 x = 0; x < charInfo.width; x++ )
-      {
-         S32 dx = x + charInfo.xOffset;
-         
-         if( dx >= TextureSheetSize )
-            break;
-
-         *bmp->getAddress( dx, dy ) = charInfo.bitmapData[ y * charInfo.width + x ];
-      }
-   }
-   
-   mTextureSheets[mCurSheet].refresh();
-}
-
-void GFont::addSheet()
-{
-    char buf[30];
-    dSprintf(buf, sizeof(buf), "newfont_%d", smSheetIdCount++);
-
-    GBitmap *bitmap = new GBitmap(TextureSheetSize, TextureSheetSize, false, GBitmap::Alpha);
-
-    // Set everything to transparent.
-    U8 *bits = bitmap->getWritableBits();
-    dMemset(bits, 0, sizeof(U8) *TextureSheetSize*TextureSheetSize);
-
-    TextureHandle handle = TextureHandle(buf, bitmap, TextureHandle::BitmapKeepTexture);
-    //handle.setFilter(GL_NEAREST);
-
-    mTextureSheets.increment();
-    constructInPlace(&mTextureSheets.last());
-    mTextureSheets.last() = handle;
-
-    mCurX = 0;
-    mCurY = 0;
-    mCurSheet = mTextureSheets.size() - 1;
-}
-
 //////////////////////////////////////////////////////////////////////////
 
 const PlatformFont::CharInfo &GFont::getCharInfo(const UTF16 in_charIndex)
@@ -413,20 +381,22 @@ const PlatformFont::CharInfo &GFont::getCharInfo(const UTF16 in_charIndex)
 
    AssertFatal(in_charIndex, "GFont::getCharInfo - can't get info for char 0!");
 
-   if(mRemapTable[in_charIndex] == -1)
+   S32 index = getRemap(in_charIndex);
+   if(index == -1)
    {
       loadCharInfo(in_charIndex);
+      index = getRemap(in_charIndex);
    }
 
-   AssertFatal(mRemapTable[in_charIndex] != -1, "No remap info for this character");
+   AssertFatal(index != -1, "No remap info for this character");
 
    PROFILE_END();
 
    // if we still have no character info, return the default char info.
-   if(mRemapTable[in_charIndex] == -1)
+   if(index == -1)
       return getDefaultCharInfo();
    else
-      return mCharInfoList[mRemapTable[in_charIndex]];
+      return mCharInfoList[index];
 }
 
 const PlatformFont::CharInfo &GFont::getDefaultCharInfo()
@@ -727,18 +697,20 @@ bool GFont::read(Stream& io_rStream)
       FrameTemp<S32> inBuff(buffLen);
       io_rStream.read(buffLen, inBuff);
 
-      // Decompress.
+      // Decompress into a flat range, then spread it over the remap pages.
+      FrameTemp<S32> remap(maxGlyph-minGlyph+1);
       uLongf destLen = (maxGlyph-minGlyph+1)*sizeof(S32);
-      uncompress((Bytef*)&mRemapTable[minGlyph], &destLen, (Bytef*)(S32*)inBuff, buffLen);
+      uncompress((Bytef*)(S32*)remap, &destLen, (Bytef*)(S32*)inBuff, buffLen);
 
       AssertISV(destLen == (maxGlyph-minGlyph+1)*sizeof(S32), "GFont::read - invalid remap table data!");
 
       // Make sure we've got the right endianness.
       for(i = minGlyph; i <= maxGlyph; i++) {
-         mRemapTable[i] = convertBEndianToHost(mRemapTable[i]);
-         if( mRemapTable[i] == -1 ) {
-             Con::errorf( "bogus mRemapTable[i] value in %s %i", mFaceName, mSize );
+         S32 index = convertBEndianToHost(remap[i - minGlyph]);
+         if( index == -1 ) {
+             Con::errorf( "bogus remap value in %s %i", mFaceName, mSize );
          }
+         setRemap(i, index);
       }
    }
    
@@ -767,7 +739,7 @@ bool GFont::write(Stream& stream)
 
    for(i = 0; i < 65536; i++)
    {
-       if(mRemapTable[i] != -1)
+       if(getRemap(i) != -1)
        {
            if(i > maxGlyph) maxGlyph = i;
            if(i < minGlyph) minGlyph = i;
@@ -776,10 +748,10 @@ bool GFont::write(Stream& stream)
 
    //-Mat make sure all our character info is good before writing it
    for(i = minGlyph; i <= maxGlyph; i++) {
-       if( mRemapTable[i] == -1 ) {
+       if( getRemap(i) == -1 ) {
            //-Mat get info and try this again
            getCharInfo(i);
-           if( mRemapTable[i] == -1 ) {
+           if( getRemap(i) == -1 ) {
                Con::errorf( "GFont::write() couldn't get character info for char %i", i);
            }
        }
@@ -816,30 +788,27 @@ bool GFont::write(Stream& stream)
    // Skip it if we don't have any glyphs to do...
    if(maxGlyph >= minGlyph)
    {
-      // Put everything big endian, to be consistent. Do this inplace.
-      for(i = minGlyph; i <= maxGlyph; i++)
-         mRemapTable[i] = convertHostToBEndian(mRemapTable[i]);
+      // Flatten the range, big endian to be consistent.
+      FrameTemp<S32> remap(maxGlyph-minGlyph+1);
+      for(i = minGlyph; i <= maxGlyph; i++) {
+         S32 index = getRemap(i);
+         if( index == -1 ) {
+             Con::errorf( "bogus remap value in %s %i", mFaceName, mSize );
+         }
+         remap[i - minGlyph] = convertHostToBEndian(index);
+      }
 
       {
          // Compress.
          const U32 buffSize = 128 * 1024;
          FrameTemp<S32> outBuff(buffSize);
          uLongf destLen = buffSize * sizeof(S32);
-         compress2((Bytef*)(S32*)outBuff, &destLen, (Bytef*)(S32*)&mRemapTable[minGlyph], (maxGlyph-minGlyph+1)*sizeof(S32), 9);
+         compress2((Bytef*)(S32*)outBuff, &destLen, (Bytef*)(S32*)remap, (maxGlyph-minGlyph+1)*sizeof(S32), 9);
 
          // Write out.
          stream.write((U32)destLen);
          stream.write((U32)destLen, outBuff);
       }
-
-      // Put us back to normal.
-      for(i = minGlyph; i <= maxGlyph; i++) {
-         mRemapTable[i] = convertBEndianToHost(mRemapTable[i]);
-
-         if( mRemapTable[i] == -1 ) {
-             Con::errorf( "bogus mRemapTable[i] value in %s %i", mFaceName, mSize );
-         }
-      }
    }
    
    return (stream.getStatus() == Stream::Ok);
@@ -847,6 +816,13 @@ bool GFont::write(Stream& stream)
 
 void GFont::exportStrip(const char *fileName, U32 padding, U32 kerning)
 {
+   // Only fonts read from a file have glyph sheets.
+   if(mTextureSheets.empty())
+   {
+      Con::errorf("GFont::exportStrip - '%s' %dpt has no glyph sheets to export.", mFaceName, mSize);
+      return;
+   }
+
    // Figure dimensions of our strip by iterating over all the char infos.
    U32 totalHeight = 0;
    U32 totalWidth = 0;
@@ -1079,8 +1055,7 @@ ResourceInstance* constructBMFont(Stream& stream)
 
 bool GFont::readBMFont(Stream& io_rStream)
 {
-    for (U32 i = 0; i < (sizeof(mRemapTable) / sizeof(S32)); i++)
-        mRemapTable[i] = -1;
+    clearRemap();
     
     U32 bmWidth = 0;
     U32 bmHeight = 0;
@@ -1244,7 +1219,7 @@ bool GFont::readBMFont(Stream& io_rStream)
                 currentWordCount++;
             }
             mCharInfoList.push_back(ci);
-            mRemapTable[ CharID ] = mCharInfoList.size()-1;
+            setRemap(CharID, mCharInfoList.size()-1);
         }
     }
     
@@ -101,7 +101,20 @@ private:
    Vector<PlatformFont::CharInfo>  mCharInfoList;       // - List of character info structures, must
                                           //    be accessed through the getCharInfo(U32)
                                           //    function to account for remapping...
-   S32             mRemapTable[65536];    // - Index remapping
+
+   // Index remapping. The UTF16 range is split into pages of RemapPageSize
+   // entries which are only allocated once a character in them is loaded.
+   // Unallocated pages point at smEmptyRemapPage so lookups never branch.
+   enum RemapConstants
+   {
+      RemapPageBits  = 8,
+      RemapPageSize  = 1 << RemapPageBits,
+      RemapPageCount = 0x10000 >> RemapPageBits,
+   };
+   S32*            mRemapPages[RemapPageCount];
+   static S32      smEmptyRemapPage[RemapPageSize];
+   static bool     smEmptyRemapPageReady;
+   static bool     initEmptyRemapPage();
 
    S32             mNVGFontHandle;
    TrueTypeHandle* mTTFHandle;
@@ -112,9 +125,13 @@ public:
 
 protected:
     bool loadCharInfo(const UTF16 ch);
-    void addBitmap(PlatformFont::CharInfo &charInfo);
-    void addSheet(void);
-    void assignSheet(S32 sheetNum, GBitmap *bmp);
+
+    inline S32 getRemap(const UTF16 ch) const
+    {
+       return mRemapPages[ch >> RemapPageBits][ch & (RemapPageSize - 1)];
+    }
+    void setRemap(const UTF16 ch, S32 index);
+    void clearRemap();
 
     void *mMutex;
 
@@ -158,6 +175,9 @@ public:
    /// Dump information about this font to the console.
    void dumpInfo();
 
+   /// Bytes of memory owned by this font.
+   U32 getMemoryUsage();
+
    /// Export to an image strip for image processing.
    void exportStrip(const char *fileName, U32 padding, U32 kerning);
 
@@ -175,7 +195,7 @@ public:
    /// are treated as having 0 for RGB).
    bool isAlphaOnly()
    {
-      return mTextureSheets[0].getBitmap()->getFormat() == GBitmap::Alpha;
+      return mTextureSheets.empty() || mTextureSheets[0].getBitmap()->getFormat() == GBitmap::Alpha;
    }
 
    /// Get the filename for a cached font.
@@ -219,7 +239,7 @@ inline U32 GFont::getCharHeight(const UTF16 in_charIndex)
 
 inline bool GFont::isValidChar(const UTF16 in_charIndex) const
 {
-   if(mRemapTable[in_charIndex] != -1)
+   if(getRemap(in_charIndex) != -1)
       return true;
 
    // TODO: check in nanovg
@@ -99,7 +99,8 @@ ConsoleFunctionWithDocs(populateFontCacheRange, ConsoleVoid, 5, 5, (faceName, si
 }
 
 /*! Dump a full description 
-    of all cached fonts, along with info on the codepoints each contains.
+    of all cached fonts, along with info on the codepoints each contains
+    and the memory each font uses.
     @return No return value
 */
 ConsoleFunctionWithDocs(dumpFontCacheStatus, ConsoleVoid, 1, 1, ())
@@ -110,6 +111,7 @@ ConsoleFunctionWithDocs(dumpFontCacheStatus, ConsoleVoid, 1, 1, ())
    Con::printf("--------------------------------------------------------------------------");
    Con::printf("   Font Cache Usage Report (%d fonts found)", match.numMatches());
 
+   U32 totalBytes = 0;
    for (U32 i = 0; i < (U32)match.numMatches(); i++)
    {
       char *curMatch = match.matchList[i];
@@ -124,7 +126,10 @@ ConsoleFunctionWithDocs(dumpFontCacheStatus, ConsoleVoid, 1, 1, ())
 
       // Ok, dump info!
       font->dumpInfo();
+      totalBytes += font->getMemoryUsage();
    }
+
+   Con::printf("   Fonts use %d KB in total.", totalBytes / 1024);
 }
 
 /*! force all cached fonts to
@@ -0,0 +1,444 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2013 GarageGames, LLC
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//-----------------------------------------------------------------------------
+
+#include "particleSystem.h"
+#include "platform/platform.h"
+#include "platform/threads/jobSystem.h"
+#include "graphics/color.h"
+
+// Debug Profiling.
+#include "debug/profiler.h"
+
+#if defined(__SSE__) || defined(_M_X64) || defined(_M_AMD64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#define TORQUE_PARTICLES_SSE
+#include <xmmintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#define TORQUE_PARTICLES_NEON
+#include <arm_neon.h>
+#endif
+
+//-----------------------------------------------------------------------------
+// Four wide helpers for the update kernels.
+//-----------------------------------------------------------------------------
+
+#if defined(TORQUE_PARTICLES_SSE)
+
+typedef __m128 F32x4;
+
+static inline F32x4 load4(const F32* p)                  { return _mm_loadu_ps(p); }
+static inline void  store4(F32* p, F32x4 v)              { _mm_storeu_ps(p, v); }
+static inline F32x4 splat4(F32 v)                        { return _mm_set1_ps(v); }
+static inline F32x4 add4(F32x4 a, F32x4 b)               { return _mm_add_ps(a, b); }
+static inline F32x4 sub4(F32x4 a, F32x4 b)               { return _mm_sub_ps(a, b); }
+static inline F32x4 madd4(F32x4 a, F32x4 b, F32x4 c)     { return _mm_add_ps(a, _mm_mul_ps(b, c)); }
+static inline F32x4 clamp4(F32x4 v, F32x4 lo, F32x4 hi)  { return _mm_min_ps(_mm_max_ps(v, lo), hi); }
+
+// Any lane below zero.
+static inline bool anyNegative4(F32x4 v)                 { return _mm_movemask_ps(_mm_cmplt_ps(v, _mm_setzero_ps())) != 0; }
+
+static inline void transpose4(F32x4& a, F32x4& b, F32x4& c, F32x4& d)
+{
+   _MM_TRANSPOSE4_PS(a, b, c, d);
+}
+
+#elif defined(TORQUE_PARTICLES_NEON)
+
+typedef float32x4_t F32x4;
+
+static inline F32x4 load4(const F32* p)                  { return vld1q_f32(p); }
+static inline void  store4(F32* p, F32x4 v)              { vst1q_f32(p, v); }
+static inline F32x4 splat4(F32 v)                        { return vdupq_n_f32(v); }
+static inline F32x4 add4(F32x4 a, F32x4 b)               { return vaddq_f32(a, b); }
+static inline F32x4 sub4(F32x4 a, F32x4 b)               { return vsubq_f32(a, b); }
+static inline F32x4 madd4(F32x4 a, F32x4 b, F32x4 c)     { return vmlaq_f32(a, b, c); }
+static inline F32x4 clamp4(F32x4 v, F32x4 lo, F32x4 hi)  { return vminq_f32(vmaxq_f32(v, lo), hi); }
+
+static inline bool anyNegative4(F32x4 v)
+{
+   uint32x4_t mask = vcltq_f32(v, vdupq_n_f32(0.0f));
+   uint32x2_t half = vorr_u32(vget_low_u32(mask), vget_high_u32(mask));
+   return (vget_lane_u32(half, 0) | vget_lane_u32(half, 1)) != 0;
+}
+
+static inline void transpose4(F32x4& a, F32x4& b, F32x4& c, F32x4& d)
+{
+   float32x4x2_t ab = vtrnq_f32(a, b);
+   float32x4x2_t cd = vtrnq_f32(c, d);
+   a = vcombine_f32(vget_low_f32(ab.val[0]), vget_low_f32(cd.val[0]));
+   b = vcombine_f32(vget_low_f32(ab.val[1]), vget_low_f32(cd.val[1]));
+   c = vcombine_f32(vget_high_f32(ab.val[0]), vget_high_f32(cd.val[0]));
+   d = vcombine_f32(vget_high_f32(ab.val[1]), vget_high_f32(cd.val[1]));
+}
+
+#else
+
+struct F32x4
+{
+   F32 v[4];
+};
+
+static inline F32x4 load4(const F32* p)                  { F32x4 r; for (U32 i = 0; i < 4; ++i) r.v[i] = p[i]; return r; }
+static inline void  store4(F32* p, F32x4 v)              { for (U32 i = 0; i < 4; ++i) p[i] = v.v[i]; }
+static inline F32x4 splat4(F32 v)                        { F32x4 r; for (U32 i = 0; i < 4; ++i) r.v[i] = v; return r; }
+static inline F32x4 add4(F32x4 a, F32x4 b)               { for (U32 i = 0; i < 4; ++i) a.v[i] += b.v[i]; return a; }
+static inline F32x4 sub4(F32x4 a, F32x4 b)               { for (U32 i = 0; i < 4; ++i) a.v[i] -= b.v[i]; return a; }
+static inline F32x4 madd4(F32x4 a, F32x4 b, F32x4 c)     { for (U32 i = 0; i < 4; ++i) a.v[i] += b.v[i] * c.v[i]; return a; }
+static inline F32x4 clamp4(F32x4 v, F32x4 lo, F32x4 hi)  { for (U32 i = 0; i < 4; ++i) v.v[i] = getMin(getMax(v.v[i], lo.v[i]), hi.v[i]); return v; }
+
+static inline bool anyNegative4(F32x4 v)
+{
+   return v.v[0] < 0.0f || v.v[1] < 0.0f || v.v[2] < 0.0f || v.v[3] < 0.0f;
+}
+
+static inline void transpose4(F32x4& a, F32x4& b, F32x4& c, F32x4& d)
+{
+   F32x4 rows[4] = { a, b, c, d };
+   for (U32 i = 0; i < 4; ++i)
+   {
+      a.v[i] = rows[i].v[0];
+      b.v[i] = rows[i].v[1];
+      c.v[i] = rows[i].v[2];
+      d.v[i] = rows[i].v[3];
+   }
+}
+
+#endif
+
+//-----------------------------------------------------------------------------
+
+ParticleSystem::EmitterParams::EmitterParams()
+{
+   count       = 100;
+   range       = 100.0f;
+   minVelocity.set(-5.0f, -5.0f, 0.0f);
+   maxVelocity.set(5.0f, 5.0f, 10.0f);
+   minLifetime = 1.0f;
+   maxLifetime = 10.0f;
+   gravity.set(0.0f, 0.0f, -9.81f);
+}
+
+//-----------------------------------------------------------------------------
+
+ParticleSystem::ParticleSystem()
+{
+   mParticleCount = 0;
+}
+
+ParticleSystem::~ParticleSystem()
+{
+   for (S32 n = 0; n < mEmitters.size(); ++n)
+      delete mEmitters[n];
+}
+
+//-----------------------------------------------------------------------------
+
+S32 ParticleSystem::createEmitter(const EmitterParams& params, U32 seed)
+{
+   Emitter* emitter = NULL;
+   S32 handle = InvalidEmitter;
+
+   // Reuse a pooled emitter and its buffers when there is one.
+   if (mFreeEmitters.size() > 0)
+   {
+      handle = mFreeEmitters.last();
+      mFreeEmitters.pop_back();
+      emitter = mEmitters[handle];
+   }
+   else
+   {
+      emitter = new Emitter();
+      emitter->capacity = 0;
+      handle = mEmitters.size();
+      mEmitters.push_back(emitter);
+   }
+
+   if (seed != 0)
+      emitter->random.setSeed((S32)seed);
+   else
+      emitter->random.resetSeed();
+
+   emitter->count       = 0;
+   emitter->emitted     = 0;
+   emitter->activeIndex = mActiveEmitters.size();
+   mActiveEmitters.push_back(handle);
+
+   setEmitterParams(handle, params);
+   resetEmitter(handle);
+   return handle;
+}
+
+void ParticleSystem::destroyEmitter(S32 handle)
+{
+   AssertFatal(handle >= 0 && handle < mEmitters.size() && mEmitters[handle]->activeIndex >= 0, "ParticleSystem::destroyEmitter - invalid emitter.");
+
+   Emitter* emitter = mEmitters[handle];
+   mParticleCount -= getMin(mParticleCount, emitter->count);
+
+   // Swap remove from the active list.
+   const S32 last = mActiveEmitters.last();
+   mActiveEmitters[emitter->activeIndex] = last;
+   mEmitters[last]->activeIndex = emitter->activeIndex;
+   mActiveEmitters.pop_back();
+
+   emitter->activeIndex = -1;
+   emitter->count = 0;
+   mFreeEmitters.push_back(handle);
+}
+
+void ParticleSystem::setEmitterParams(S32 handle, const EmitterParams& params)
+{
+   Emitter* emitter = mEmitters[handle];
+   emitter->params = params;
+
+   reserve(emitter, params.count);
+   emitter->count = getMin(emitter->count, params.count);
+}
+
+void ParticleSystem::resetEmitter(S32 handle)
+{
+   Emitter* emitter = mEmitters[handle];
+   emitter->count = 0;
+   emit(emitter);
+}
+
+//-----------------------------------------------------------------------------
+
+void ParticleSystem::reserve(Emitter* emitter, U32 capacity)
+{
+   capacity = (capacity + 3) & ~3;
+   if (capacity <= emitter->capacity)
+      return;
+
+   // Streams move when the capacity grows, copy them over back to front
+   // so they don't overwrite each other.
+   const U32 oldCapacity = emitter->capacity;
+   emitter->data.setSize(capacity * StreamCount);
+   for (S32 stream = StreamCount - 1; stream >= 0; --stream)
+   {
+      F32* src = emitter->data.address() + (stream * oldCapacity);
+      F32* dst = emitter->data.address() + (stream * capacity);
+      dMemmove(dst, src, oldCapacity * sizeof(F32));
+
+      // Padding lanes are simulated too, keep them from holding NaNs.
+      dMemset(dst + oldCapacity, 0, (capacity - oldCapacity) * sizeof(F32));
+   }
+   emitter->capacity = capacity;
+}
+
+void ParticleSystem::emit(Emitter* emitter)
+{
+   const EmitterParams& params = emitter->params;
+   const U32 count = params.count;
+   emitter->emitted = count - emitter->count;
+   if (emitter->emitted == 0)
+      return;
+
+   F32* px = emitter->getStream(PositionX);
+   F32* py = emitter->getStream(PositionY);
+   F32* pz = emitter->getStream(PositionZ);
+   F32* vx = emitter->getStream(VelocityX);
+   F32* vy = emitter->getStream(VelocityY);
+   F32* vz = emitter->getStream(VelocityZ);
+   F32* cr = emitter->getStream(ColorR);
+   F32* cg = emitter->getStream(ColorG);
+   F32* cb = emitter->getStream(ColorB);
+   F32* life = emitter->getStream(Lifetime);
+
+   RandomLCG& random = emitter->random;
+   const F32 range = params.range;
+   for (U32 n = emitter->count; n < count; ++n)
+   {
+      px[n]    = random.randRangeF(-range, range);
+      py[n]    = random.randRangeF(-range, range);
+      pz[n]    = random.randRangeF(-range, range);
+      vx[n]    = random.randRangeF(params.minVelocity.x, params.maxVelocity.x);
+      vy[n]    = random.randRangeF(params.minVelocity.y, params.maxVelocity.y);
+      vz[n]    = random.randRangeF(params.minVelocity.z, params.maxVelocity.z);
+      cr[n]    = random.randF();
+      cg[n]    = random.randF();
+      cb[n]    = random.randF();
+      life[n]  = random.randRangeF(params.minLifetime, params.maxLifetime);
+   }
+
+   emitter->count = count;
+}
+
+void ParticleSystem::updateEmitter(Emitter* emitter, F32 dt)
+{
+   F32* px = emitter->getStream(PositionX);
+   F32* py = emitter->getStream(PositionY);
+   F32* pz = emitter->getStream(PositionZ);
+   F32* vx = emitter->getStream(VelocityX);
+   F32* vy = emitter->getStream(VelocityY);
+   F32* vz = emitter->getStream(VelocityZ);
+   F32* life = emitter->getStream(Lifetime);
+
+   // Integrate, four particles at a time. Capacity is padded to a multiple
+   // of four so the last group never reads past the streams.
+   const F32x4 dt4 = splat4(dt);
+   const F32x4 gx  = splat4(emitter->params.gravity.x * dt);
+   const F32x4 gy  = splat4(emitter->params.gravity.y * dt);
+   const F32x4 gz  = splat4(emitter->params.gravity.z * dt);
+
+   const U32 count = emitter->count;
+   bool anyDead = false;
+   for (U32 n = 0; n < count; n += 4)
+   {
+      F32x4 velX = add4(load4(vx + n), gx);
+      F32x4 velY = add4(load4(vy + n), gy);
+      F32x4 velZ = add4(load4(vz + n), gz);
+      store4(vx + n, velX);
+      store4(vy + n, velY);
+      store4(vz + n, velZ);
+
+      store4(px + n, madd4(load4(px + n), velX, dt4));
+      store4(py + n, madd4(load4(py + n), velY, dt4));
+      store4(pz + n, madd4(load4(pz + n), velZ, dt4));
+
+      F32x4 lifetime = sub4(load4(life + n), dt4);
+      store4(life + n, lifetime);
+      anyDead |= anyNegative4(lifetime);
+   }
+
+   // Swap remove dead particles. Lanes past count may be negative too, that
+   // only costs a scan here.
+   if (anyDead)
+   {
+      U32 alive = count;
+      for (U32 n = 0; n < alive; )
+      {
+         if (life[n] >= 0.0f)
+         {
+            ++n;
+            continue;
+         }
+
+         --alive;
+         for (U32 stream = 0; stream < StreamCount; ++stream)
+         {
+            F32* data = emitter->getStream(stream);
+            data[n] = data[alive];
+         }
+      }
+      emitter->count = alive;
+   }
+
+   // Refill up to the particle count.
+   emit(emitter);
+}
+
+//-----------------------------------------------------------------------------
+
+void ParticleSystem::updateJob(void* data, U32 first, U32 count)
+{
+   UpdateJob* job = (UpdateJob*)data;
+   ParticleSystem* system = job->system;
+
+   for (U32 n = first; n < first + count; ++n)
+      system->updateEmitter(system->mEmitters[system->mActiveEmitters[n]], job->dt);
+}
+
+void ParticleSystem::update(F32 dt)
+{
+   PROFILE_SCOPE(ParticleSystem_Update);
+
+   UpdateJob job;
+   job.system  = this;
+   job.dt      = dt;
+
+   // Runs inline when the job system isn't running.
+   JobCounter counter;
+   JobSystem::parallelFor(mActiveEmitters.size(), EmitterGrain, &updateJob, &job, &counter);
+   JobSystem::wait(counter);
+
+   mParticleCount = 0;
+   for (S32 n = 0; n < mActiveEmitters.size(); ++n)
+      mParticleCount += mEmitters[mActiveEmitters[n]]->count;
+}
+
+//-----------------------------------------------------------------------------
+
+void ParticleSystem::writeInstances(S32 handle, void* dest) const
+{
+   Emitter* emitter = mEmitters[handle];
+   const F32* px = emitter->getStream(PositionX);
+   const F32* py = emitter->getStream(PositionY);
+   const F32* pz = emitter->getStream(PositionZ);
+   const F32* cr = emitter->getStream(ColorR);
+   const F32* cg = emitter->getStream(ColorG);
+   const F32* cb = emitter->getStream(ColorB);
+   const F32* life = emitter->getStream(Lifetime);
+
+   const F32x4 zero = splat4(0.0f);
+   const F32x4 one  = splat4(1.0f);
+
+   // Transpose four particles at a time into position and color rows.
+   F32* out = (F32*)dest;
+   const U32 count = emitter->count;
+   const U32 groups = count & ~3;
+   for (U32 n = 0; n < groups; n += 4, out += 32)
+   {
+      F32x4 x = load4(px + n);
+      F32x4 y = load4(py + n);
+      F32x4 z = load4(pz + n);
+      F32x4 w = zero;
+      transpose4(x, y, z, w);
+
+      F32x4 r = load4(cr + n);
+      F32x4 g = load4(cg + n);
+      F32x4 b = load4(cb + n);
+      F32x4 a = clamp4(load4(life + n), zero, one);
+      transpose4(r, g, b, a);
+
+      store4(out + 0, x);
+      store4(out + 4, r);
+      store4(out + 8, y);
+      store4(out + 12, g);
+      store4(out + 16, z);
+      store4(out + 20, b);
+      store4(out + 24, w);
+      store4(out + 28, a);
+   }
+
+   for (U32 n = groups; n < count; ++n, out += 8)
+   {
+      out[0] = px[n];
+      out[1] = py[n];
+      out[2] = pz[n];
+      out[3] = 0.0f;
+      out[4] = cr[n];
+      out[5] = cg[n];
+      out[6] = cb[n];
+      out[7] = mClampF(life[n], 0.0f, 1.0f);
+   }
+}
+
+void ParticleSystem::getParticle(S32 handle, U32 index, Point3F& position, Point3F& velocity, ColorF& color, F32& lifetime) const
+{
+   Emitter* emitter = mEmitters[handle];
+   AssertFatal(index < emitter->count, "ParticleSystem::getParticle - index out of range.");
+
+   position.set(emitter->getStream(PositionX)[index], emitter->getStream(PositionY)[index], emitter->getStream(PositionZ)[index]);
+   velocity.set(emitter->getStream(VelocityX)[index], emitter->getStream(VelocityY)[index], emitter->getStream(VelocityZ)[index]);
+   color.set(emitter->getStream(ColorR)[index], emitter->getStream(ColorG)[index], emitter->getStream(ColorB)[index], 1.0f);
+   lifetime = emitter->getStream(Lifetime)[index];
+}
@@ -0,0 +1,164 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2013 GarageGames, LLC
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//-----------------------------------------------------------------------------
+
+#ifndef _PARTICLE_SYSTEM_H_
+#define _PARTICLE_SYSTEM_H_
+
+#ifndef _MMATH_H_
+#include "math/mMath.h"
+#endif
+
+#ifndef _MRANDOM_H_
+#include "math/mRandom.h"
+#endif
+
+#ifndef _TVECTOR_H_
+#include "collection/vector.h"
+#endif
+
+#include "platform/platformLibrary.h"
+
+class ColorF;
+
+// ------------------------------------------------------------------------------
+//  ParticleSystem
+// ------------------------------------------------------------------------------
+//
+//   Simulation of every particle emitter, stored as structure of arrays so
+//   the update kernels process four particles at a time (SSE or NEON, with
+//   a scalar fallback). Dead particles are swap-removed and replaced with
+//   new ones to keep each emitter at its particle count.
+//
+//   Emitters are pooled: destroying one keeps its buffers for the next
+//   emitter created, so emitters coming and going don't allocate. update()
+//   splits the emitters across the job system in batches.
+//
+//   writeInstances() writes an emitter straight into instance data, two
+//   vec4 per particle: position and color with the remaining lifetime in
+//   alpha.
+//
+// ------------------------------------------------------------------------------
+
+class DLL_PUBLIC ParticleSystem
+{
+   public:
+      enum
+      {
+         InvalidEmitter    = -1,
+         EmitterGrain      = 8,     ///< Emitters per job.
+         InstanceStride    = 32     ///< Bytes written per particle by writeInstances().
+      };
+
+      struct EmitterParams
+      {
+         U32      count;            ///< Particles kept alive.
+         F32      range;            ///< Particles spawn within +/- range of the origin.
+         Point3F  minVelocity;
+         Point3F  maxVelocity;
+         F32      minLifetime;
+         F32      maxLifetime;
+         Point3F  gravity;
+
+         EmitterParams();
+      };
+
+   protected:
+      // Structure of arrays, every stream is capacity floats long.
+      enum Streams
+      {
+         PositionX,
+         PositionY,
+         PositionZ,
+         VelocityX,
+         VelocityY,
+         VelocityZ,
+         ColorR,
+         ColorG,
+         ColorB,
+         Lifetime,
+         StreamCount
+      };
+
+      struct Emitter
+      {
+         EmitterParams  params;
+         RandomLCG      random;
+         Vector<F32>    data;
+         U32            capacity;   ///< Multiple of 4 so kernels never need a tail.
+         U32            count;
+         U32            emitted;    ///< Particles spawned by the last update.
+         S32            activeIndex;
+
+         inline F32* getStream(U32 stream) { return data.address() + (stream * capacity); }
+      };
+
+      struct UpdateJob
+      {
+         ParticleSystem*   system;
+         F32               dt;
+      };
+
+      Vector<Emitter*>     mEmitters;
+      Vector<S32>          mFreeEmitters;
+      Vector<S32>          mActiveEmitters;
+      U32                  mParticleCount;
+
+      void reserve(Emitter* emitter, U32 capacity);
+      void emit(Emitter* emitter);
+      void updateEmitter(Emitter* emitter, F32 dt);
+
+      static void updateJob(void* data, U32 first, U32 count);
+
+   public:
+      ParticleSystem();
+      ~ParticleSystem();
+
+      S32  createEmitter(const EmitterParams& params, U32 seed = 0);
+      void destroyEmitter(S32 handle);
+      void setEmitterParams(S32 handle, const EmitterParams& params);
+      const EmitterParams& getEmitterParams(S32 handle) const { return mEmitters[handle]->params; }
+
+      /// Kill every particle and spawn a full set.
+      void resetEmitter(S32 handle);
+
+      /// Advance every emitter, in parallel when the job system is running.
+      void update(F32 dt);
+
+      /// Advance one emitter on the calling thread.
+      void updateEmitter(S32 handle, F32 dt) { updateEmitter(mEmitters[handle], dt); }
+
+      /// Writes getParticleCount(handle) * InstanceStride bytes.
+      void writeInstances(S32 handle, void* dest) const;
+
+      U32  getParticleCount(S32 handle) const   { return mEmitters[handle]->count; }
+      U32  getEmittedCount(S32 handle) const    { return mEmitters[handle]->emitted; }
+      U32  getEmitterCount() const              { return mActiveEmitters.size(); }
+      U32  getPooledEmitterCount() const        { return mFreeEmitters.size(); }
+
+      /// Total of all emitters, as of the last update.
+      U32  getParticleCount() const             { return mParticleCount; }
+
+      /// Copy of a particle for inspection, index < getParticleCount(handle).
+      void getParticle(S32 handle, U32 index, Point3F& position, Point3F& velocity, ColorF& color, F32& lifetime) const;
+};
+
+#endif // _PARTICLE_SYSTEM_H_
@@ -0,0 +1,364 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2013 GarageGames, LLC
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//-----------------------------------------------------------------------------
+
+#include "terrainQuadTree.h"
+#include "graphics/utilities.h"
+#include "platform/threads/jobSystem.h"
+
+//-----------------------------------------------------------------------------
+
+TerrainQuadTree::TerrainQuadTree()
+{
+   mSource           = NULL;
+   mWidth            = 0;
+   mHeight           = 0;
+   mLevelCount       = 0;
+   mFirstRange       = ChunkSize * 4.0f;
+   mMorphStartRatio  = 0.66f;
+}
+
+void TerrainQuadTree::clear()
+{
+   mSource        = NULL;
+   mWidth         = 0;
+   mHeight        = 0;
+   mLevelCount    = 0;
+   mBounds.clear();
+}
+
+void TerrainQuadTree::build(const TerrainHeightSource* source, U32 width, U32 height)
+{
+   clear();
+
+   if ( source == NULL || width < 2 || height < 2 )
+      return;
+
+   mSource  = source;
+   mWidth   = width;
+   mHeight  = height;
+
+   // Add levels until a single node covers the heightfield.
+   const U32 quadsX = mWidth - 1;
+   const U32 quadsY = mHeight - 1;
+   U32 nodeCount = 0;
+   while ( mLevelCount < MaxLevels )
+   {
+      const U32 level   = mLevelCount++;
+      const U32 extent  = getNodeExtent(level);
+
+      mLevelOffset[level]  = nodeCount;
+      mLevelWidth[level]   = (quadsX + extent - 1) / extent;
+      mLevelHeight[level]  = (quadsY + extent - 1) / extent;
+      nodeCount += mLevelWidth[level] * mLevelHeight[level];
+
+      if ( extent >= getMax(quadsX, quadsY) )
+         break;
+   }
+   mBounds.setSize(nodeCount);
+
+   // Leaves read every sample, spread their rows over the job system.
+   JobCounter counter;
+   JobSystem::parallelFor(mLevelHeight[0], 1, computeLeafBoundsJob, this, &counter);
+   JobSystem::wait(counter);
+
+   for ( U32 level = 1; level < mLevelCount; ++level )
+      computeParentBounds(level, 0, 0, mLevelWidth[level] - 1, mLevelHeight[level] - 1);
+}
+
+void TerrainQuadTree::computeLeafBoundsJob(void* data, U32 first, U32 count)
+{
+   TerrainQuadTree* tree = (TerrainQuadTree*)data;
+   tree->computeLeafBounds(0, first, tree->mLevelWidth[0] - 1, first + count - 1);
+}
+
+void TerrainQuadTree::computeLeafBounds(U32 firstX, U32 firstY, U32 lastX, U32 lastY)
+{
+   for ( U32 nodeY = firstY; nodeY <= lastY; ++nodeY )
+   {
+      const U32 y0 = nodeY * ChunkSize;
+      const U32 y1 = getMin(y0 + ChunkSize, mHeight - 1);
+
+      for ( U32 nodeX = firstX; nodeX <= lastX; ++nodeX )
+      {
+         const U32 x0 = nodeX * ChunkSize;
+         const U32 x1 = getMin(x0 + ChunkSize, mWidth - 1);
+
+         NodeBounds& bounds = mBounds[getNodeIndex(nodeX, nodeY, 0)];
+         bounds.minZ = F32_MAX;
+         bounds.maxZ = -F32_MAX;
+
+         for ( U32 y = y0; y <= y1; ++y )
+         {
+            for ( U32 x = x0; x <= x1; ++x )
+            {
+               const F32 z = mSource->getHeight(x, y);
+               bounds.minZ = getMin(bounds.minZ, z);
+               bounds.maxZ = getMax(bounds.maxZ, z);
+            }
+         }
+      }
+   }
+}
+
+void TerrainQuadTree::computeParentBounds(U32 level, U32 firstX, U32 firstY, U32 lastX, U32 lastY)
+{
+   const U32 childLevel = level - 1;
+
+   for ( U32 nodeY = firstY; nodeY <= lastY; ++nodeY )
+   {
+      for ( U32 nodeX = firstX; nodeX <= lastX; ++nodeX )
+      {
+         NodeBounds& bounds = mBounds[getNodeIndex(nodeX, nodeY, level)];
+         bounds.minZ = F32_MAX;
+         bounds.maxZ = -F32_MAX;
+
+         for ( U32 i = 0; i < 4; ++i )
+         {
+            const U32 childX = (nodeX * 2) + (i & 1);
+            const U32 childY = (nodeY * 2) + (i >> 1);
+            if ( childX >= mLevelWidth[childLevel] || childY >= mLevelHeight[childLevel] )
+               continue;
+
+            const NodeBounds& child = mBounds[getNodeIndex(childX, childY, childLevel)];
+            bounds.minZ = getMin(bounds.minZ, child.minZ);
+            bounds.maxZ = getMax(bounds.maxZ, child.maxZ);
+         }
+      }
+   }
+}
+
+void TerrainQuadTree::updateHeights(U32 x, U32 y, U32 width, U32 height)
+{
+   if ( isEmpty() || width == 0 || height == 0 || x >= mWidth || y >= mHeight )
+      return;
+
+   // A sample on a chunk edge belongs to the chunks on both sides.
+   U32 firstX  = (x > 0) ? (x - 1) / ChunkSize : 0;
+   U32 firstY  = (y > 0) ? (y - 1) / ChunkSize : 0;
+   U32 lastX   = getMin(getMin(x + width - 1, mWidth - 1) / ChunkSize, mLevelWidth[0] - 1);
+   U32 lastY   = getMin(getMin(y + height - 1, mHeight - 1) / ChunkSize, mLevelHeight[0] - 1);
+
+   computeLeafBounds(firstX, firstY, lastX, lastY);
+
+   for ( U32 level = 1; level < mLevelCount; ++level )
+   {
+      firstX >>= 1;
+      firstY >>= 1;
+      lastX >>= 1;
+      lastY >>= 1;
+      computeParentBounds(level, firstX, firstY, lastX, lastY);
+   }
+}
+
+bool TerrainQuadTree::isChunkAffected(U32 chunkX, U32 chunkY, U32 level, U32 x, U32 y, U32 width, U32 height) const
+{
+   // Normals and morph targets read one step past the chunk edges.
+   const U32 stride = 1 << level;
+   const U32 extent = getNodeExtent(level);
+
+   return (x <= chunkX + extent + stride) && (x + width + stride > chunkX)
+       && (y <= chunkY + extent + stride) && (y + height + stride > chunkY);
+}
+
+Box3F TerrainQuadTree::getChunkBox(U32 chunkX, U32 chunkY, U32 level) const
+{
+   const U32 extent = getNodeExtent(level);
+   const NodeBounds& bounds = mBounds[getNodeIndex(chunkX / extent, chunkY / extent, level)];
+
+   return Box3F((F32)chunkX, (F32)chunkY, bounds.minZ,
+                (F32)getMin(chunkX + extent, mWidth - 1), (F32)getMin(chunkY + extent, mHeight - 1), bounds.maxZ);
+}
+
+//-----------------------------------------------------------------------------
+
+void TerrainQuadTree::setRanges(F32 firstRange, F32 morphStartRatio)
+{
+   AssertFatal(firstRange > 0.0f, "TerrainQuadTree::setRanges - first range has to be positive.");
+
+   mFirstRange       = firstRange;
+   mMorphStartRatio  = mClampF(morphStartRatio, 0.0f, 0.99f);
+}
+
+F32 TerrainQuadTree::getMorphStart(U32 level) const
+{
+   // Morphing starts part way between the previous range and this one. The
+   // terrain vertex shader uses the same formula.
+   return getRange(level) * (0.5f + (0.5f * mMorphStartRatio));
+}
+
+U32 TerrainQuadTree::getExistingQuadrants(U32 nodeX, U32 nodeY, U32 level) const
+{
+   const U32 extent  = getNodeExtent(level);
+   const U32 half    = extent / 2;
+   U32 quadrants     = 0;
+
+   for ( U32 i = 0; i < 4; ++i )
+   {
+      const U32 x = (nodeX * extent) + ((i & 1) * half);
+      const U32 y = (nodeY * extent) + ((i >> 1) * half);
+      if ( x < mWidth - 1 && y < mHeight - 1 )
+         quadrants |= BIT(i);
+   }
+
+   return quadrants;
+}
+
+void TerrainQuadTree::select(const Point3F& camera, Vector<SelectedNode>& selection) const
+{
+   selection.clear();
+
+   if ( isEmpty() )
+      return;
+
+   const U32 top = mLevelCount - 1;
+   for ( U32 nodeY = 0; nodeY < mLevelHeight[top]; ++nodeY )
+   {
+      for ( U32 nodeX = 0; nodeX < mLevelWidth[top]; ++nodeX )
+         selectNode(nodeX, nodeY, top, camera, selection);
+   }
+}
+
+bool TerrainQuadTree::selectNode(U32 nodeX, U32 nodeY, U32 level, const Point3F& camera, Vector<SelectedNode>& selection) const
+{
+   const U32 extent  = getNodeExtent(level);
+   const Box3F box   = getChunkBox(nodeX * extent, nodeY * extent, level);
+   const F32 sqDist  = box.getSqDistanceToPoint(camera);
+
+   // Out of range, the parent draws this area. The top level has no parent
+   // so it covers everything.
+   const F32 range = getRange(level);
+   if ( level + 1 < mLevelCount && sqDist > range * range )
+      return false;
+
+   U32 quadrants = getExistingQuadrants(nodeX, nodeY, level);
+
+   const F32 childRange = (level > 0) ? getRange(level - 1) : 0.0f;
+   if ( level > 0 && sqDist <= childRange * childRange )
+   {
+      // Children in range draw themselves, this node fills in for the rest.
+      for ( U32 i = 0; i < 4; ++i )
+      {
+         if ( !(quadrants & BIT(i)) )
+            continue;
+
+         if ( selectNode((nodeX * 2) + (i & 1), (nodeY * 2) + (i >> 1), level - 1, camera, selection) )
+            quadrants &= ~BIT(i);
+      }
+   }
+
+   if ( quadrants != 0 )
+   {
+      selection.increment();
+      SelectedNode& node = selection.last();
+      node.x         = nodeX * extent;
+      node.y         = nodeY * extent;
+      node.index     = getNodeIndex(nodeX, nodeY, level);
+      node.level     = (U16)level;
+      node.quadrants = (U16)quadrants;
+   }
+
+   return true;
+}
+
+//-----------------------------------------------------------------------------
+
+void TerrainQuadTree::buildChunk(U32 chunkX, U32 chunkY, U32 level, Graphics::PosUVNormalMorphVertex* verts) const
+{
+   const S32 stride     = 1 << level;
+   const bool morphs    = (level + 1) < mLevelCount;
+   const F32 invWidth   = 1.0f / (F32)mWidth;
+   const F32 invHeight  = 1.0f / (F32)mHeight;
+
+   for ( U32 j = 0; j <= ChunkSize; ++j )
+   {
+      // Past the far edge the grid collapses onto the last sample.
+      const S32 y = (S32)getMin(chunkY + (j * stride), mHeight - 1);
+
+      for ( U32 i = 0; i <= ChunkSize; ++i )
+      {
+         const S32 x = (S32)getMin(chunkX + (i * stride), mWidth - 1);
+         Graphics::PosUVNormalMorphVertex& vert = *verts++;
+
+         vert.m_x = (F32)x;
+         vert.m_y = (F32)y;
+         vert.m_z = sampleHeight(x, y);
+         vert.m_u = (F32)x * invWidth;
+         vert.m_v = (F32)y * invHeight;
+
+         // Central differences at this level's spacing.
+         Point3F normal(sampleHeight(x - stride, y) - sampleHeight(x + stride, y),
+                        sampleHeight(x, y - stride) - sampleHeight(x, y + stride),
+                        2.0f * stride);
+         normal.normalize();
+         vert.m_normal_x = normal.x;
+         vert.m_normal_y = normal.y;
+         vert.m_normal_z = normal.z;
+
+         // Vertices the next level doesn't have morph onto the edge or, for
+         // quad centers, onto the diagonal they lie on. buildChunkIndices()
+         // splits quads from (x + 1, y) to (x, y + 1).
+         const bool oddX = (i & 1) != 0;
+         const bool oddY = (j & 1) != 0;
+         if ( !morphs || (!oddX && !oddY) )
+            vert.m_morph_z = vert.m_z;
+         else if ( oddX && !oddY )
+            vert.m_morph_z = (sampleHeight(x - stride, y) + sampleHeight(x + stride, y)) * 0.5f;
+         else if ( !oddX && oddY )
+            vert.m_morph_z = (sampleHeight(x, y - stride) + sampleHeight(x, y + stride)) * 0.5f;
+         else
+            vert.m_morph_z = (sampleHeight(x + stride, y - stride) + sampleHeight(x - stride, y + stride)) * 0.5f;
+
+         vert.m_morph_level = (F32)level;
+      }
+   }
+}
+
+U32 TerrainQuadTree::buildChunkIndices(U32 quadrants, U16* indices)
+{
+   const U32 half    = ChunkSize / 2;
+   const U32 pitch   = ChunkSize + 1;
+   U32 count         = 0;
+
+   for ( U32 i = 0; i < 4; ++i )
+   {
+      if ( !(quadrants & BIT(i)) )
+         continue;
+
+      const U32 x0 = (i & 1) * half;
+      const U32 y0 = (i >> 1) * half;
+      for ( U32 y = y0; y < y0 + half; ++y )
+      {
+         for ( U32 x = x0; x < x0 + half; ++x )
+         {
+            const U16 index = (U16)((y * pitch) + x);
+            indices[count++] = index;
+            indices[count++] = index + pitch;
+            indices[count++] = index + 1;
+            indices[count++] = index + 1;
+            indices[count++] = index + pitch;
+            indices[count++] = index + pitch + 1;
+         }
+      }
+   }
+
+   return count;
+}
@@ -0,0 +1,179 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2013 GarageGames, LLC
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//-----------------------------------------------------------------------------
+
+#ifndef _TERRAIN_QUADTREE_H_
+#define _TERRAIN_QUADTREE_H_
+
+#ifndef _MMATH_H_
+#include "math/mMath.h"
+#endif
+
+#ifndef _TVECTOR_H_
+#include "collection/vector.h"
+#endif
+
+#include "platform/platformLibrary.h"
+
+namespace Graphics
+{
+   struct PosUVNormalMorphVertex;
+}
+
+// ------------------------------------------------------------------------------
+//  TerrainQuadTree
+// ------------------------------------------------------------------------------
+//
+//   Continuous distance dependent level of detail (CDLOD) for heightfields.
+//   The heightfield is split into a quadtree of chunks. A chunk at any level
+//   is drawn as the same grid of ChunkSize x ChunkSize quads, sampling every
+//   (1 << level) heights, so every chunk shares the same 16 bit index buffers.
+//
+//   Level n is used up to getRange(n) from the camera, ranges double per
+//   level. Towards the end of its range a chunk morphs the vertices that the
+//   next level doesn't have onto the coarser surface, so neighbouring levels
+//   meet without cracks or popping. The morph target height is baked into
+//   the vertices, the vertex shader only computes the morph factor.
+//
+//   A node that is partly within range of the finer level is drawn with only
+//   the quadrants its children don't cover, there's an index buffer for each
+//   quadrant mask.
+//
+// ------------------------------------------------------------------------------
+
+class DLL_PUBLIC TerrainHeightSource
+{
+   public:
+      virtual ~TerrainHeightSource() { }
+      virtual F32 getHeight(U32 x, U32 y) const = 0;
+};
+
+// Heights stored row by row, not owned.
+class DLL_PUBLIC TerrainHeightMap : public TerrainHeightSource
+{
+   public:
+      const F32*  mHeights;
+      U32         mWidth;
+
+      TerrainHeightMap() : mHeights(NULL), mWidth(0) { }
+      TerrainHeightMap(const F32* heights, U32 width) : mHeights(heights), mWidth(width) { }
+
+      virtual F32 getHeight(U32 x, U32 y) const { return mHeights[(y * mWidth) + x]; }
+};
+
+class DLL_PUBLIC TerrainQuadTree
+{
+   public:
+      enum
+      {
+         ChunkSize         = 64,    ///< Quads per chunk side, at every level.
+         ChunkVertexCount  = (ChunkSize + 1) * (ChunkSize + 1),
+         ChunkIndexCount   = ChunkSize * ChunkSize * 6,
+         MaxLevels         = 16,
+         AllQuadrants      = 0xF
+      };
+
+      struct NodeBounds
+      {
+         F32 minZ;
+         F32 maxZ;
+      };
+
+      struct SelectedNode
+      {
+         U32   x;          ///< First sample covered.
+         U32   y;
+         U32   index;      ///< See getNodeIndex().
+         U16   level;
+         U16   quadrants;  ///< Quadrants to draw. Bit 0 is low x/low y, bit 3 high x/high y.
+      };
+
+   protected:
+      const TerrainHeightSource* mSource;
+      U32                  mWidth;
+      U32                  mHeight;
+      U32                  mLevelCount;
+      U32                  mLevelOffset[MaxLevels];
+      U32                  mLevelWidth[MaxLevels];
+      U32                  mLevelHeight[MaxLevels];
+      Vector<NodeBounds>   mBounds;
+
+      F32                  mFirstRange;
+      F32                  mMorphStartRatio;
+
+      static void computeLeafBoundsJob(void* data, U32 first, U32 count);
+
+      void computeLeafBounds(U32 firstX, U32 firstY, U32 lastX, U32 lastY);
+      void computeParentBounds(U32 level, U32 firstX, U32 firstY, U32 lastX, U32 lastY);
+      bool selectNode(U32 nodeX, U32 nodeY, U32 level, const Point3F& camera, Vector<SelectedNode>& selection) const;
+      U32  getExistingQuadrants(U32 nodeX, U32 nodeY, U32 level) const;
+
+      inline F32 sampleHeight(S32 x, S32 y) const
+      {
+         x = mClamp(x, 0, (S32)mWidth - 1);
+         y = mClamp(y, 0, (S32)mHeight - 1);
+         return mSource->getHeight((U32)x, (U32)y);
+      }
+
+   public:
+      TerrainQuadTree();
+
+      void clear();
+      bool isEmpty() const             { return mLevelCount == 0; }
+
+      /// Build the tree over width x height samples. The source has to outlive
+      /// the tree, or be replaced with another build().
+      void build(const TerrainHeightSource* source, U32 width, U32 height);
+
+      /// Refresh the bounds of the nodes covering a region of changed samples.
+      void updateHeights(U32 x, U32 y, U32 width, U32 height);
+
+      /// Whether the vertices of a chunk depend on a region of samples.
+      bool isChunkAffected(U32 chunkX, U32 chunkY, U32 level, U32 x, U32 y, U32 width, U32 height) const;
+
+      U32  getWidth() const            { return mWidth; }
+      U32  getHeight() const           { return mHeight; }
+      U32  getLevelCount() const       { return mLevelCount; }
+      U32  getNodeCount() const        { return mBounds.size(); }
+      U32  getNodeIndex(U32 nodeX, U32 nodeY, U32 level) const { return mLevelOffset[level] + (nodeY * mLevelWidth[level]) + nodeX; }
+      Box3F getChunkBox(U32 chunkX, U32 chunkY, U32 level) const;
+
+      static U32 getNodeExtent(U32 level) { return ChunkSize << level; }
+
+      // Level Ranges
+      void setRanges(F32 firstRange, F32 morphStartRatio);
+      F32  getFirstRange() const       { return mFirstRange; }
+      F32  getMorphStartRatio() const  { return mMorphStartRatio; }
+      F32  getRange(U32 level) const   { return mFirstRange * (F32)(1 << level); }
+      F32  getMorphStart(U32 level) const;
+
+      /// Chunks to draw for a camera position in heightfield space, coarsest first.
+      void select(const Point3F& camera, Vector<SelectedNode>& selection) const;
+
+      /// Fill ChunkVertexCount vertices for a chunk. Thread safe.
+      void buildChunk(U32 chunkX, U32 chunkY, U32 level, Graphics::PosUVNormalMorphVertex* verts) const;
+
+      /// Fill the indices of the quadrants in mask. indices needs room for
+      /// ChunkIndexCount, returns the number written.
+      static U32 buildChunkIndices(U32 quadrants, U16* indices);
+};
+
+#endif // _TERRAIN_QUADTREE_H_
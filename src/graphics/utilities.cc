@@ -29,6 +29,7 @@ namespace Graphics
    bgfx::VertexDecl PosVertex::ms_decl;
    bgfx::VertexDecl PosUVVertex::ms_decl;
    bgfx::VertexDecl PosUVNormalVertex::ms_decl;
+   bgfx::VertexDecl PosUVNormalMorphVertex::ms_decl;
    bgfx::VertexDecl PosUVBonesVertex::ms_decl;
    bgfx::VertexDecl PosUVNormalBonesVertex::ms_decl;
    bgfx::VertexDecl PosUVTBNBonesVertex::ms_decl;
@@ -136,6 +137,7 @@ namespace Graphics
       PosVertex::init();
       PosUVVertex::init();
       PosUVNormalVertex::init();
+      PosUVNormalMorphVertex::init();
       PosUVBonesVertex::init();
       PosUVNormalBonesVertex::init();
       PosUVTBNBonesVertex::init();
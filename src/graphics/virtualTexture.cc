@@ -0,0 +1,293 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2013 GarageGames, LLC
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//-----------------------------------------------------------------------------
+
+#include "virtualTexture.h"
+#include "platform/platform.h"
+
+//-----------------------------------------------------------------------------
+
+VirtualTexture::VirtualTexture()
+{
+   mLevelCount       = 0;
+   mWindowSize       = 0;
+   mPageSize         = 0;
+   mBorder           = 0;
+   mSlotsPerSide     = 0;
+   mFrame            = 0;
+   mLRUHead          = InvalidSlot;
+   mLRUTail          = InvalidSlot;
+   mDirtyRowBegin    = U32_MAX;
+   mDirtyRowEnd      = 0;
+   dMemset(&mStats, 0, sizeof(mStats));
+}
+
+void VirtualTexture::init(U32 levelCount, U32 windowSize, U32 pageSize, U32 textureSize, U32 border)
+{
+   AssertFatal(levelCount > 0 && levelCount <= MaxLevels, "VirtualTexture::init - invalid level count.");
+   AssertFatal(isPow2(windowSize), "VirtualTexture::init - window size has to be a power of two.");
+   AssertFatal(pageSize > border * 2, "VirtualTexture::init - border doesn't leave any room in the page.");
+
+   mLevelCount    = levelCount;
+   mWindowSize    = windowSize;
+   mPageSize      = pageSize;
+   mBorder        = border;
+   mSlotsPerSide  = textureSize / pageSize;
+   mFrame         = 0;
+
+   // Page table texels store the slot column and row in a byte each.
+   AssertFatal(mSlotsPerSide <= 256, "VirtualTexture::init - too many slots, use larger pages.");
+
+   const U32 slotCount = mSlotsPerSide * mSlotsPerSide;
+   AssertFatal(slotCount >= levelCount * windowSize * windowSize && slotCount < InvalidSlot,
+      "VirtualTexture::init - texture doesn't have a slot for every window page.");
+
+   U32 pageCount = 0;
+   for ( U32 level = 0; level < mLevelCount; ++level )
+   {
+      mLevelOffset[level] = pageCount;
+      mWindowOrigin[level].set(-1, -1);
+      pageCount += getPagesAcross(level) * getPagesAcross(level);
+   }
+   mResident.setSize(pageCount);
+   mSlots.setSize(slotCount);
+   mPageTable.setSize(getPageTableWidth() * getPageTableHeight() * 4);
+
+   invalidate();
+}
+
+void VirtualTexture::invalidate()
+{
+   dMemset(mResident.address(), 0xFF, mResident.size() * sizeof(U16));
+
+   // Free slots are at the front of the LRU list so they're used first.
+   mLRUHead = InvalidSlot;
+   mLRUTail = InvalidSlot;
+   for ( U32 n = 0; n < (U32)mSlots.size(); ++n )
+   {
+      mSlots[n].lastUsed = 0;
+      linkSlotTail((U16)n);
+   }
+
+   // Nothing is resident anymore.
+   dMemset(mPageTable.address(), 0, mPageTable.size());
+   mDirtyRowBegin = 0;
+   mDirtyRowEnd   = getPageTableHeight();
+}
+
+//-----------------------------------------------------------------------------
+
+void VirtualTexture::unlinkSlot(U16 slot)
+{
+   Slot& entry = mSlots[slot];
+
+   if ( entry.prev != InvalidSlot )
+      mSlots[entry.prev].next = entry.next;
+   else
+      mLRUHead = entry.next;
+
+   if ( entry.next != InvalidSlot )
+      mSlots[entry.next].prev = entry.prev;
+   else
+      mLRUTail = entry.prev;
+}
+
+void VirtualTexture::linkSlotTail(U16 slot)
+{
+   Slot& entry = mSlots[slot];
+   entry.prev = mLRUTail;
+   entry.next = InvalidSlot;
+
+   if ( mLRUTail != InvalidSlot )
+      mSlots[mLRUTail].next = slot;
+   else
+      mLRUHead = slot;
+
+   mLRUTail = slot;
+}
+
+void VirtualTexture::touchSlot(U16 slot)
+{
+   mSlots[slot].lastUsed = mFrame;
+   if ( slot == mLRUTail )
+      return;
+
+   unlinkSlot(slot);
+   linkSlotTail(slot);
+}
+
+//-----------------------------------------------------------------------------
+
+S32 QSORT_CALLBACK VirtualTexture::compareRequests(const void* a, const void* b)
+{
+   const Request* requestA = (const Request*)a;
+   const Request* requestB = (const Request*)b;
+
+   // Coarse levels first so there's always something to fall back to, then
+   // closest to the focus point.
+   if ( requestA->level != requestB->level )
+      return (S32)requestB->level - (S32)requestA->level;
+
+   if ( requestA->distance != requestB->distance )
+      return (requestA->distance < requestB->distance) ? -1 : 1;
+
+   return 0;
+}
+
+void VirtualTexture::update(const Point2F& focus, U32 budget, Vector<PageUpdate>& updates)
+{
+   updates.clear();
+   dMemset(&mStats, 0, sizeof(mStats));
+
+   if ( mLevelCount == 0 )
+      return;
+
+   mFrame++;
+   mRequests.clear();
+
+   for ( S32 level = mLevelCount - 1; level >= 0; --level )
+   {
+      // Center the window on the focus, staying inside the texture.
+      const S32 across = (S32)getPagesAcross(level);
+      const S32 focusX = (S32)mFloor(mClampF(focus.x, 0.0f, 1.0f) * across);
+      const S32 focusY = (S32)mFloor(mClampF(focus.y, 0.0f, 1.0f) * across);
+
+      Point2I origin(mClamp(focusX - (S32)(mWindowSize / 2), 0, across - (S32)mWindowSize),
+                     mClamp(focusY - (S32)(mWindowSize / 2), 0, across - (S32)mWindowSize));
+      const Point2I previous = mWindowOrigin[level];
+      mWindowOrigin[level] = origin;
+
+      for ( U32 y = origin.y; y < origin.y + mWindowSize; ++y )
+      {
+         for ( U32 x = origin.x; x < origin.x + mWindowSize; ++x )
+         {
+            // Pages that scrolled in take over the entry of the page that left.
+            if ( previous.x < 0 || (S32)x < previous.x || (S32)x >= previous.x + (S32)mWindowSize ||
+                 (S32)y < previous.y || (S32)y >= previous.y + (S32)mWindowSize )
+               writePageTableEntry(level, x, y);
+
+            const U16 slot = mResident[getResidentIndex(level, x, y)];
+            if ( slot != InvalidSlot )
+            {
+               touchSlot(slot);
+               mStats.resident++;
+               continue;
+            }
+
+            mRequests.increment();
+            Request& request = mRequests.last();
+            request.level     = (U16)level;
+            request.x         = (U16)x;
+            request.y         = (U16)y;
+            request.distance  = (U32)((((S32)x - focusX) * ((S32)x - focusX)) + (((S32)y - focusY) * ((S32)y - focusY)));
+         }
+      }
+   }
+
+   mStats.requested = mRequests.size();
+   if ( mRequests.size() > 1 )
+      dQsort(mRequests.address(), mRequests.size(), sizeof(Request), compareRequests);
+
+   for ( S32 n = 0; n < mRequests.size(); ++n )
+   {
+      // The least recently used slot is only free to take if no window
+      // needs it this frame.
+      const U16 slot = mLRUHead;
+      if ( (U32)updates.size() >= budget || slot == InvalidSlot || mSlots[slot].lastUsed == mFrame )
+      {
+         mStats.pending = mRequests.size() - n;
+         break;
+      }
+
+      Slot& entry = mSlots[slot];
+      if ( entry.lastUsed != 0 )
+      {
+         mResident[getResidentIndex(entry.level, entry.x, entry.y)] = InvalidSlot;
+         mStats.evicted++;
+      }
+
+      const Request& request = mRequests[n];
+      entry.level = request.level;
+      entry.x     = request.x;
+      entry.y     = request.y;
+      mResident[getResidentIndex(request.level, request.x, request.y)] = slot;
+      touchSlot(slot);
+      writePageTableEntry(request.level, request.x, request.y);
+
+      updates.increment();
+      PageUpdate& update = updates.last();
+      update.level   = request.level;
+      update.x       = request.x;
+      update.y       = request.y;
+      update.slot    = slot;
+   }
+
+   mStats.rendered = updates.size();
+}
+
+bool VirtualTexture::isInWindow(U32 level, U32 x, U32 y) const
+{
+   const Point2I& origin = mWindowOrigin[level];
+   return origin.x >= 0 && x >= (U32)origin.x && x < origin.x + mWindowSize &&
+          y >= (U32)origin.y && y < origin.y + mWindowSize;
+}
+
+void VirtualTexture::writePageTableEntry(U32 level, U32 x, U32 y)
+{
+   // The entry belongs to whichever window page wraps around to it.
+   if ( !isInWindow(level, x, y) )
+      return;
+
+   const U32 row = (level * mWindowSize) + (y % mWindowSize);
+   U8* texel = mPageTable.address() + (((row * mWindowSize) + (x % mWindowSize)) * 4);
+
+   const U16 slot = mResident[getResidentIndex(level, x, y)];
+   if ( slot == InvalidSlot )
+   {
+      texel[0] = texel[1] = texel[2] = texel[3] = 0;
+   }
+   else
+   {
+      texel[0] = (U8)(slot % mSlotsPerSide);
+      texel[1] = (U8)(slot / mSlotsPerSide);
+      texel[2] = 255;
+      texel[3] = 255;
+   }
+
+   mDirtyRowBegin = getMin(mDirtyRowBegin, row);
+   mDirtyRowEnd   = getMax(mDirtyRowEnd, row + 1);
+}
+
+//-----------------------------------------------------------------------------
+
+Point2I VirtualTexture::getSlotOrigin(U32 slot) const
+{
+   return Point2I((slot % mSlotsPerSide) * mPageSize, (slot / mSlotsPerSide) * mPageSize);
+}
+
+RectF VirtualTexture::getPageRect(U32 level, U32 x, U32 y) const
+{
+   const F32 pageExtent    = 1.0f / (F32)getPagesAcross(level);
+   const F32 borderExtent  = pageExtent * (F32)mBorder / (F32)(mPageSize - (mBorder * 2));
+
+   return RectF((x * pageExtent) - borderExtent, (y * pageExtent) - borderExtent,
+                pageExtent + (borderExtent * 2.0f), pageExtent + (borderExtent * 2.0f));
+}
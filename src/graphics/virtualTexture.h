@@ -0,0 +1,185 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2013 GarageGames, LLC
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//-----------------------------------------------------------------------------
+
+#ifndef _VIRTUAL_TEXTURE_H_
+#define _VIRTUAL_TEXTURE_H_
+
+#ifndef _MMATH_H_
+#include "math/mMath.h"
+#endif
+
+#ifndef _TVECTOR_H_
+#include "collection/vector.h"
+#endif
+
+#include "platform/platformLibrary.h"
+
+// ------------------------------------------------------------------------------
+//  VirtualTexture
+// ------------------------------------------------------------------------------
+//
+//   Page management for a virtual texture that is rendered on demand, like
+//   the terrain megatexture. The virtual texture is a mip chain of pages.
+//   The top level covers the whole texture with WindowSize x WindowSize pages
+//   and every finer level doubles that.
+//
+//   Each level keeps a WindowSize x WindowSize window of pages around the
+//   focus point resident. The page table holds one entry per window page and
+//   is addressed toroidally (page % WindowSize), so moving a window only
+//   touches the entries of the pages that scrolled in. The shader falls back
+//   to a coarser level while a page isn't resident.
+//
+//   Pages live in the slots of a physical texture, managed as an LRU cache.
+//   Pages that leave their window stay in their slot until it's needed, so
+//   coming back to an area doesn't render it again.
+//
+//   update() returns the pages to render this frame, coarse levels first,
+//   and nothing is drawn here. Pages are rendered with a border so bilinear
+//   filtering doesn't bleed between slots.
+//
+// ------------------------------------------------------------------------------
+
+class DLL_PUBLIC VirtualTexture
+{
+   public:
+      enum
+      {
+         MaxLevels      = 8,
+         InvalidSlot    = 0xFFFF
+      };
+
+      struct PageUpdate
+      {
+         U16   level;
+         U16   x;
+         U16   y;
+         U16   slot;
+      };
+
+      // Counters of the last update().
+      struct Stats
+      {
+         U32   resident;   ///< Window pages already in a slot.
+         U32   requested;  ///< Window pages that weren't.
+         U32   rendered;   ///< Pages handed out to render.
+         U32   evicted;    ///< Cached pages that lost their slot.
+         U32   pending;    ///< Requests left for the next frames.
+      };
+
+   protected:
+      struct Slot
+      {
+         U16   level;
+         U16   x;
+         U16   y;
+         U16   prev;       ///< LRU list, least recently used first.
+         U16   next;
+         U32   lastUsed;   ///< Frame, zero when the slot is free.
+      };
+
+      struct Request
+      {
+         U16   level;
+         U16   x;
+         U16   y;
+         U32   distance;
+      };
+
+      U32               mLevelCount;
+      U32               mWindowSize;
+      U32               mPageSize;
+      U32               mBorder;
+      U32               mSlotsPerSide;
+      U32               mFrame;
+
+      U32               mLevelOffset[MaxLevels];
+      Point2I           mWindowOrigin[MaxLevels];
+
+      Vector<U16>       mResident;     ///< Slot of every virtual page, by level.
+      Vector<Slot>      mSlots;
+      U16               mLRUHead;
+      U16               mLRUTail;
+      Vector<Request>   mRequests;
+
+      Vector<U8>        mPageTable;
+      U32               mDirtyRowBegin;   ///< Page table rows changed since the last upload.
+      U32               mDirtyRowEnd;
+
+      Stats             mStats;
+
+      static S32 QSORT_CALLBACK compareRequests(const void* a, const void* b);
+
+      void unlinkSlot(U16 slot);
+      void linkSlotTail(U16 slot);
+      void touchSlot(U16 slot);
+      bool isInWindow(U32 level, U32 x, U32 y) const;
+      void writePageTableEntry(U32 level, U32 x, U32 y);
+
+      inline U32 getResidentIndex(U32 level, U32 x, U32 y) const { return mLevelOffset[level] + (y * getPagesAcross(level)) + x; }
+
+   public:
+      VirtualTexture();
+
+      /// windowSize is in pages and must be a power of two. The physical
+      /// texture needs a slot for every window page of every level.
+      void init(U32 levelCount, U32 windowSize, U32 pageSize, U32 textureSize, U32 border = 1);
+
+      /// Forget the content of every slot, all pages will render again.
+      void invalidate();
+
+      /// Move the windows to focus (0 to 1 across the virtual texture) and
+      /// hand out slots to at most budget missing pages.
+      void update(const Point2F& focus, U32 budget, Vector<PageUpdate>& updates);
+
+      U32  getLevelCount() const       { return mLevelCount; }
+      U32  getWindowSize() const       { return mWindowSize; }
+      U32  getPageSize() const         { return mPageSize; }
+      U32  getBorder() const           { return mBorder; }
+      U32  getSlotsPerSide() const     { return mSlotsPerSide; }
+      U32  getSlotCount() const        { return mSlots.size(); }
+      U32  getPagesAcross(U32 level) const { return mWindowSize << (mLevelCount - 1 - level); }
+      const Point2I& getWindowOrigin(U32 level) const { return mWindowOrigin[level]; }
+      const Stats& getStats() const    { return mStats; }
+
+      /// InvalidSlot when the page isn't in the cache.
+      U16  getPageSlot(U32 level, U32 x, U32 y) const { return mResident[getResidentIndex(level, x, y)]; }
+
+      /// Top left pixel of a slot in the physical texture.
+      Point2I getSlotOrigin(U32 slot) const;
+
+      /// Area of the virtual texture a page renders, border included.
+      RectF getPageRect(U32 level, U32 x, U32 y) const;
+
+      /// WindowSize x (WindowSize * levels) RGBA8 texels, a level under the
+      /// other. R and G are the slot column and row, B is 255 when resident.
+      const U8* getPageTable() const   { return mPageTable.address(); }
+      U32  getPageTableWidth() const   { return mWindowSize; }
+      U32  getPageTableHeight() const  { return mWindowSize * mLevelCount; }
+
+      /// Rows changed since clearPageTableDirty(), upload only those.
+      bool isPageTableDirty() const    { return mDirtyRowBegin < mDirtyRowEnd; }
+      U32  getPageTableDirtyRow() const      { return mDirtyRowBegin; }
+      U32  getPageTableDirtyRowCount() const { return isPageTableDirty() ? mDirtyRowEnd - mDirtyRowBegin : 0; }
+      void clearPageTableDirty()       { mDirtyRowBegin = U32_MAX; mDirtyRowEnd = 0; }
+};
+
+#endif // _VIRTUAL_TEXTURE_H_
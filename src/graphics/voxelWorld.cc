@@ -0,0 +1,804 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2013 GarageGames, LLC
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//-----------------------------------------------------------------------------
+
+#include "voxelWorld.h"
+#include "platform/platform.h"
+#include "graphics/utilities.h"
+#include "io/stream.h"
+
+// Debug Profiling.
+#include "debug/profiler.h"
+
+static inline U32 voxelIndex(S32 x, S32 y, S32 z)
+{
+   return x + (y << VoxelWorld::ChunkShift) + (z << (VoxelWorld::ChunkShift * 2));
+}
+
+static inline U32 paddedIndex(S32 x, S32 y, S32 z)
+{
+   return (x + 1) + (y + 1) * VoxelWorld::PaddedSize + (z + 1) * VoxelWorld::PaddedSize * VoxelWorld::PaddedSize;
+}
+
+static inline S32 compareCoords(const Point3I& a, const Point3I& b)
+{
+   if ( a.x != b.x ) return a.x < b.x ? -1 : 1;
+   if ( a.y != b.y ) return a.y < b.y ? -1 : 1;
+   if ( a.z != b.z ) return a.z < b.z ? -1 : 1;
+   return 0;
+}
+
+//-----------------------------------------------------------------------------
+// VoxelMemoryPager
+//-----------------------------------------------------------------------------
+
+VoxelMemoryPager::VoxelMemoryPager()
+   : mWasted(0)
+{
+
+}
+
+// Binary search, entries are kept sorted by coordinate. Returns the insert
+// position, negated and minus one, when the chunk isn't there.
+S32 VoxelMemoryPager::findEntry(const Point3I& chunk) const
+{
+   S32 low = 0;
+   S32 high = (S32)mEntries.size() - 1;
+   while ( low <= high )
+   {
+      S32 mid = (low + high) >> 1;
+      S32 result = compareCoords(mEntries[mid].chunk, chunk);
+      if ( result == 0 )
+         return mid;
+      if ( result < 0 )
+         low = mid + 1;
+      else
+         high = mid - 1;
+   }
+   return -low - 1;
+}
+
+void VoxelMemoryPager::compact()
+{
+   Vector<U8> data;
+   data.setSize(mData.size() - mWasted);
+
+   U32 offset = 0;
+   for ( U32 i = 0; i < mEntries.size(); ++i )
+   {
+      Entry& entry = mEntries[i];
+      dMemcpy(data.address() + offset, mData.address() + entry.offset, entry.size);
+      entry.offset = offset;
+      offset += entry.size;
+   }
+
+   mData = data;
+   mWasted = 0;
+}
+
+void VoxelMemoryPager::pageOut(const Point3I& chunk, const U8* data, U32 size)
+{
+   S32 index = findEntry(chunk);
+   if ( index >= 0 )
+   {
+      // Replaced data stays in the buffer until there's enough to compact.
+      mWasted += mEntries[index].size;
+   } else {
+      index = -index - 1;
+      mEntries.insert(index);
+      mEntries[index].chunk = chunk;
+   }
+
+   Entry& entry = mEntries[index];
+   entry.offset = mData.size();
+   entry.size = size;
+   mData.setSize(mData.size() + size);
+   dMemcpy(mData.address() + entry.offset, data, size);
+
+   if ( mWasted > 64 * 1024 && mWasted > mData.size() / 2 )
+      compact();
+}
+
+bool VoxelMemoryPager::pageIn(const Point3I& chunk, Vector<U8>& data)
+{
+   S32 index = findEntry(chunk);
+   if ( index < 0 )
+      return false;
+
+   // The entry is kept so chunks that aren't edited don't need to be paged
+   // out again.
+   const Entry& entry = mEntries[index];
+   data.setSize(entry.size);
+   dMemcpy(data.address(), mData.address() + entry.offset, entry.size);
+   return true;
+}
+
+bool VoxelMemoryPager::write(Stream& stream)
+{
+   if ( !stream.write((U32)mEntries.size()) )
+      return false;
+
+   for ( U32 i = 0; i < mEntries.size(); ++i )
+   {
+      const Entry& entry = mEntries[i];
+      stream.write(entry.chunk.x);
+      stream.write(entry.chunk.y);
+      stream.write(entry.chunk.z);
+      stream.write(entry.size);
+      if ( !stream.write(entry.size, mData.address() + entry.offset) )
+         return false;
+   }
+
+   return true;
+}
+
+bool VoxelMemoryPager::read(Stream& stream)
+{
+   mEntries.clear();
+   mData.clear();
+   mWasted = 0;
+
+   U32 count = 0;
+   if ( !stream.read(&count) )
+      return false;
+
+   for ( U32 i = 0; i < count; ++i )
+   {
+      Entry entry;
+      stream.read(&entry.chunk.x);
+      stream.read(&entry.chunk.y);
+      stream.read(&entry.chunk.z);
+      if ( !stream.read(&entry.size) )
+         return false;
+
+      entry.offset = mData.size();
+      mData.setSize(mData.size() + entry.size);
+      if ( !stream.read(entry.size, mData.address() + entry.offset) )
+         return false;
+
+      // Written in order, but don't trust the file.
+      S32 index = findEntry(entry.chunk);
+      if ( index >= 0 )
+      {
+         mWasted += mEntries[index].size;
+         mEntries[index] = entry;
+      } else {
+         index = -index - 1;
+         mEntries.insert(index);
+         mEntries[index] = entry;
+      }
+   }
+
+   return true;
+}
+
+//-----------------------------------------------------------------------------
+// VoxelWorld
+//-----------------------------------------------------------------------------
+
+VoxelWorld::VoxelWorld(VoxelPager* pager)
+   : mPager(pager)
+{
+   AssertFatal(mPager != NULL, "VoxelWorld - a pager is required.");
+   dMemset(&mStats, 0, sizeof(mStats));
+
+   mTable.setSize(256);
+   for ( U32 i = 0; i < mTable.size(); ++i )
+      mTable[i] = NULL;
+}
+
+VoxelWorld::~VoxelWorld()
+{
+   // Subclasses flush() before this if they want the edits kept. Here the
+   // jobs just have to be finished before their memory goes away.
+   for ( U32 i = 0; i < mJobs.size(); ++i )
+   {
+      JobSystem::wait(mJobs[i]->counter);
+      delete mJobs[i];
+   }
+   for ( U32 i = 0; i < mFreeJobs.size(); ++i )
+      delete mFreeJobs[i];
+
+   for ( U32 i = 0; i < mChunks.size(); ++i )
+   {
+      delete[] mChunks[i]->voxels;
+      delete mChunks[i];
+   }
+}
+
+//-----------------------------------------------------------------------------
+// Chunk table.
+//-----------------------------------------------------------------------------
+
+U32 VoxelWorld::hashCoord(const Point3I& coord)
+{
+   U32 hash = (U32)coord.x * 73856093u;
+   hash ^= (U32)coord.y * 19349663u;
+   hash ^= (U32)coord.z * 83492791u;
+   hash ^= hash >> 15;
+   hash *= 0x2c1b3c6du;
+   hash ^= hash >> 12;
+   return hash;
+}
+
+U32 VoxelWorld::findSlot(const Point3I& coord) const
+{
+   U32 mask = mTable.size() - 1;
+   U32 slot = hashCoord(coord) & mask;
+   while ( mTable[slot] != NULL && mTable[slot]->coord != coord )
+      slot = (slot + 1) & mask;
+   return slot;
+}
+
+VoxelWorld::Chunk* VoxelWorld::findChunk(const Point3I& coord) const
+{
+   return mTable[findSlot(coord)];
+}
+
+void VoxelWorld::growTable()
+{
+   mTable.setSize(mTable.size() * 2);
+   for ( U32 i = 0; i < mTable.size(); ++i )
+      mTable[i] = NULL;
+
+   for ( U32 i = 0; i < mChunks.size(); ++i )
+      mTable[findSlot(mChunks[i]->coord)] = mChunks[i];
+}
+
+void VoxelWorld::insertChunk(Chunk* chunk)
+{
+   // Load factor stays under one half.
+   if ( (mChunks.size() + 1) * 2 > mTable.size() )
+      growTable();
+
+   mTable[findSlot(chunk->coord)] = chunk;
+   mChunks.push_back(chunk);
+}
+
+void VoxelWorld::removeChunk(U32 index)
+{
+   Chunk* chunk = mChunks[index];
+   mChunks.erase_fast(index);
+
+   // Backward shift deletion: move later entries of the probe sequence into
+   // the hole when it's between their home slot and where they are.
+   U32 mask = mTable.size() - 1;
+   U32 hole = findSlot(chunk->coord);
+   mTable[hole] = NULL;
+
+   U32 slot = (hole + 1) & mask;
+   while ( mTable[slot] != NULL )
+   {
+      U32 home = hashCoord(mTable[slot]->coord) & mask;
+      if ( ((slot - home) & mask) >= ((slot - hole) & mask) )
+      {
+         mTable[hole] = mTable[slot];
+         mTable[slot] = NULL;
+         hole = slot;
+      }
+      slot = (slot + 1) & mask;
+   }
+}
+
+//-----------------------------------------------------------------------------
+// Loading and unloading.
+//-----------------------------------------------------------------------------
+
+void VoxelWorld::allocateVoxels(Chunk* chunk)
+{
+   if ( chunk->voxels != NULL )
+      return;
+
+   chunk->voxels = new U8[ChunkVoxelCount];
+   dMemset(chunk->voxels, chunk->uniformValue, ChunkVoxelCount);
+   mStats.allocated++;
+}
+
+void VoxelWorld::makeUniform(Chunk* chunk)
+{
+   const U8* voxels = chunk->voxels;
+   for ( U32 i = 1; i < ChunkVoxelCount; ++i )
+   {
+      if ( voxels[i] != voxels[0] )
+         return;
+   }
+
+   chunk->uniformValue = voxels[0];
+   delete[] chunk->voxels;
+   chunk->voxels = NULL;
+   mStats.allocated--;
+}
+
+VoxelWorld::Chunk* VoxelWorld::loadChunk(const Point3I& coord)
+{
+   PROFILE_SCOPE(VoxelWorld_loadChunk);
+
+   Chunk* chunk = new Chunk();
+   chunk->coord         = coord;
+   chunk->voxels        = NULL;
+   chunk->uniformValue  = 0;
+   chunk->dirty         = true;
+   chunk->meshing       = false;
+   chunk->modified      = false;
+   chunk->userData      = NULL;
+
+   allocateVoxels(chunk);
+   bool loaded = mPager->pageIn(coord, mScratch) && decompress(mScratch.address(), mScratch.size(), chunk->voxels);
+   if ( !loaded && !mPager->generate(coord, chunk->voxels) )
+      dMemset(chunk->voxels, 0, ChunkVoxelCount);
+   makeUniform(chunk);
+
+   insertChunk(chunk);
+   mStats.loaded++;
+   return chunk;
+}
+
+void VoxelWorld::unloadChunk(U32 index)
+{
+   Chunk* chunk = mChunks[index];
+   AssertFatal(!chunk->meshing, "VoxelWorld::unloadChunk - chunk is being meshed.");
+
+   onChunkUnloaded(chunk);
+
+   // Unedited chunks can be paged in or generated again as they are.
+   if ( chunk->modified )
+   {
+      if ( chunk->voxels != NULL )
+      {
+         compress(chunk->voxels, mScratch);
+      } else {
+         U8* voxels = new U8[ChunkVoxelCount];
+         dMemset(voxels, chunk->uniformValue, ChunkVoxelCount);
+         compress(voxels, mScratch);
+         delete[] voxels;
+      }
+      mPager->pageOut(chunk->coord, mScratch.address(), mScratch.size());
+   }
+
+   if ( chunk->voxels != NULL )
+   {
+      delete[] chunk->voxels;
+      mStats.allocated--;
+   }
+
+   removeChunk(index);
+   delete chunk;
+   mStats.unloaded++;
+}
+
+void VoxelWorld::flush()
+{
+   waitForMeshes();
+   while ( mChunks.size() > 0 )
+      unloadChunk(mChunks.size() - 1);
+}
+
+//-----------------------------------------------------------------------------
+// Voxel access.
+//-----------------------------------------------------------------------------
+
+U8 VoxelWorld::getVoxel(S32 x, S32 y, S32 z)
+{
+   Point3I coord = getChunkCoord(x, y, z);
+   Chunk* chunk = findChunk(coord);
+   if ( chunk == NULL )
+      chunk = loadChunk(coord);
+
+   if ( chunk->voxels == NULL )
+      return chunk->uniformValue;
+   return chunk->voxels[voxelIndex(x & ChunkMask, y & ChunkMask, z & ChunkMask)];
+}
+
+void VoxelWorld::markDirty(const Point3I& coord)
+{
+   // Chunks that aren't resident have no mesh to invalidate.
+   Chunk* chunk = findChunk(coord);
+   if ( chunk != NULL )
+      chunk->dirty = true;
+}
+
+void VoxelWorld::setVoxel(S32 x, S32 y, S32 z, U8 value)
+{
+   Point3I coord = getChunkCoord(x, y, z);
+   Chunk* chunk = findChunk(coord);
+   if ( chunk == NULL )
+      chunk = loadChunk(coord);
+
+   S32 lx = x & ChunkMask;
+   S32 ly = y & ChunkMask;
+   S32 lz = z & ChunkMask;
+
+   if ( chunk->voxels == NULL )
+   {
+      if ( chunk->uniformValue == value )
+         return;
+      allocateVoxels(chunk);
+   }
+
+   U8& voxel = chunk->voxels[voxelIndex(lx, ly, lz)];
+   if ( voxel == value )
+      return;
+
+   voxel = value;
+   chunk->dirty = true;
+   chunk->modified = true;
+
+   // Faces on the border belong to whichever side is solid, so both need
+   // to be meshed again.
+   if ( lx == 0 )          markDirty(Point3I(coord.x - 1, coord.y, coord.z));
+   if ( lx == ChunkMask )  markDirty(Point3I(coord.x + 1, coord.y, coord.z));
+   if ( ly == 0 )          markDirty(Point3I(coord.x, coord.y - 1, coord.z));
+   if ( ly == ChunkMask )  markDirty(Point3I(coord.x, coord.y + 1, coord.z));
+   if ( lz == 0 )          markDirty(Point3I(coord.x, coord.y, coord.z - 1));
+   if ( lz == ChunkMask )  markDirty(Point3I(coord.x, coord.y, coord.z + 1));
+}
+
+//-----------------------------------------------------------------------------
+// Streaming.
+//-----------------------------------------------------------------------------
+
+struct VoxelChunkCandidate
+{
+   F32      distance;
+   Point3I  coord;
+   void*    chunk;
+};
+
+static S32 QSORT_CALLBACK compareCandidates(const void* a, const void* b)
+{
+   F32 da = ((const VoxelChunkCandidate*)a)->distance;
+   F32 db = ((const VoxelChunkCandidate*)b)->distance;
+   return da < db ? -1 : (da > db ? 1 : 0);
+}
+
+F32 VoxelWorld::getDistance(const Point3I& coord, const Point3F& focus) const
+{
+   const F32 half = ChunkSize * 0.5f;
+   Point3F center(coord.x * (F32)ChunkSize + half, coord.y * (F32)ChunkSize + half, coord.z * (F32)ChunkSize + half);
+   return (center - focus).len();
+}
+
+void VoxelWorld::updateStreaming(const Point3F& focus, F32 loadRadius, F32 unloadRadius, U32 maxLoads)
+{
+   PROFILE_SCOPE(VoxelWorld_updateStreaming);
+
+   mStats.loaded = 0;
+   mStats.unloaded = 0;
+
+   // Page out first so memory is freed before more gets used.
+   for ( S32 i = mChunks.size() - 1; i >= 0; --i )
+   {
+      Chunk* chunk = mChunks[i];
+      if ( !chunk->meshing && getDistance(chunk->coord, focus) > unloadRadius )
+         unloadChunk(i);
+   }
+
+   Vector<VoxelChunkCandidate> candidates;
+   Point3I center = getChunkCoord((S32)mFloor(focus.x), (S32)mFloor(focus.y), (S32)mFloor(focus.z));
+   S32 range = (S32)mCeil(loadRadius / ChunkSize) + 1;
+   for ( S32 z = center.z - range; z <= center.z + range; ++z )
+   {
+      for ( S32 y = center.y - range; y <= center.y + range; ++y )
+      {
+         for ( S32 x = center.x - range; x <= center.x + range; ++x )
+         {
+            Point3I coord(x, y, z);
+            F32 distance = getDistance(coord, focus);
+            if ( distance > loadRadius || findChunk(coord) != NULL )
+               continue;
+
+            candidates.increment();
+            VoxelChunkCandidate& candidate = candidates.last();
+            candidate.distance   = distance;
+            candidate.coord      = coord;
+            candidate.chunk      = NULL;
+         }
+      }
+   }
+
+   if ( candidates.size() > maxLoads )
+      dQsort(candidates.address(), candidates.size(), sizeof(VoxelChunkCandidate), compareCandidates);
+
+   U32 loads = getMin((U32)candidates.size(), maxLoads);
+   for ( U32 i = 0; i < loads; ++i )
+      loadChunk(candidates[i].coord);
+
+   mStats.resident = mChunks.size();
+}
+
+//-----------------------------------------------------------------------------
+// Meshing.
+//-----------------------------------------------------------------------------
+
+void VoxelWorld::copyPadded(const Chunk* chunk, U8* padded)
+{
+   // Only the faces of the padding are read by extractSurface(), edges and
+   // corners stay empty.
+   dMemset(padded, 0, PaddedVoxelCount);
+
+   for ( S32 z = 0; z < ChunkSize; ++z )
+   {
+      for ( S32 y = 0; y < ChunkSize; ++y )
+      {
+         U8* row = padded + paddedIndex(0, y, z);
+         if ( chunk->voxels != NULL )
+            dMemcpy(row, chunk->voxels + voxelIndex(0, y, z), ChunkSize);
+         else
+            dMemset(row, chunk->uniformValue, ChunkSize);
+      }
+   }
+
+   static const S32 directions[6][3] = {
+      { -1, 0, 0 }, { 1, 0, 0 }, { 0, -1, 0 }, { 0, 1, 0 }, { 0, 0, -1 }, { 0, 0, 1 }
+   };
+
+   for ( U32 face = 0; face < 6; ++face )
+   {
+      const S32* dir = directions[face];
+      Point3I coord(chunk->coord.x + dir[0], chunk->coord.y + dir[1], chunk->coord.z + dir[2]);
+
+      // Neighbours are paged in so border faces are right the first time.
+      Chunk* neighbor = findChunk(coord);
+      if ( neighbor == NULL )
+         neighbor = loadChunk(coord);
+
+      // Axis the face is on, and the layer read from the neighbour.
+      U32 axis = face >> 1;
+      S32 source = dir[axis] < 0 ? ChunkMask : 0;
+      S32 target = dir[axis] < 0 ? -1 : ChunkSize;
+
+      for ( S32 b = 0; b < ChunkSize; ++b )
+      {
+         for ( S32 a = 0; a < ChunkSize; ++a )
+         {
+            S32 s[3], t[3];
+            s[axis] = source;
+            t[axis] = target;
+            s[(axis + 1) % 3] = t[(axis + 1) % 3] = a;
+            s[(axis + 2) % 3] = t[(axis + 2) % 3] = b;
+
+            padded[paddedIndex(t[0], t[1], t[2])] = neighbor->voxels != NULL
+               ? neighbor->voxels[voxelIndex(s[0], s[1], s[2])]
+               : neighbor->uniformValue;
+         }
+      }
+   }
+}
+
+void VoxelWorld::meshJob(void* data, U32 first, U32 count)
+{
+   PROFILE_SCOPE(VoxelWorld_meshJob);
+
+   MeshJob* job = (MeshJob*)data;
+   extractSurface(job->voxels, job->mesh);
+}
+
+void VoxelWorld::updateMeshes(const Point3F& focus, F32 radius, U32 maxJobs)
+{
+   PROFILE_SCOPE(VoxelWorld_updateMeshes);
+
+   Vector<VoxelChunkCandidate> candidates;
+   for ( U32 i = 0; i < mChunks.size(); ++i )
+   {
+      Chunk* chunk = mChunks[i];
+      if ( !chunk->dirty || chunk->meshing )
+         continue;
+
+      F32 distance = getDistance(chunk->coord, focus);
+      if ( distance > radius )
+         continue;
+
+      // Empty chunks can't have faces of their own.
+      if ( chunk->voxels == NULL && chunk->uniformValue == 0 )
+      {
+         static VoxelMesh emptyMesh;
+         chunk->dirty = false;
+         onChunkMeshed(chunk, emptyMesh);
+         continue;
+      }
+
+      candidates.increment();
+      VoxelChunkCandidate& candidate = candidates.last();
+      candidate.distance   = distance;
+      candidate.coord      = chunk->coord;
+      candidate.chunk      = chunk;
+   }
+
+   dQsort(candidates.address(), candidates.size(), sizeof(VoxelChunkCandidate), compareCandidates);
+
+   for ( U32 i = 0; i < candidates.size() && mJobs.size() < maxJobs; ++i )
+   {
+      Chunk* chunk = (Chunk*)candidates[i].chunk;
+
+      MeshJob* job = NULL;
+      if ( mFreeJobs.size() > 0 )
+      {
+         job = mFreeJobs.last();
+         mFreeJobs.pop_back();
+      } else {
+         job = new MeshJob();
+      }
+
+      // The copy is taken here so edits made while the job runs only mark
+      // the chunk dirty again.
+      job->coord = chunk->coord;
+      copyPadded(chunk, job->voxels);
+      chunk->dirty = false;
+      chunk->meshing = true;
+
+      mJobs.push_back(job);
+      JobSystem::submit(meshJob, job, &job->counter);
+   }
+
+   mStats.meshing = mJobs.size();
+   mStats.resident = mChunks.size();
+}
+
+void VoxelWorld::processMeshes()
+{
+   PROFILE_SCOPE(VoxelWorld_processMeshes);
+
+   mStats.meshed = 0;
+   for ( S32 i = mJobs.size() - 1; i >= 0; --i )
+   {
+      MeshJob* job = mJobs[i];
+      if ( !job->counter.isDone() )
+         continue;
+
+      Chunk* chunk = findChunk(job->coord);
+      AssertFatal(chunk != NULL, "VoxelWorld::processMeshes - chunk was unloaded while meshing.");
+      chunk->meshing = false;
+      onChunkMeshed(chunk, job->mesh);
+      mStats.meshed++;
+
+      mJobs.erase_fast(i);
+      mFreeJobs.push_back(job);
+   }
+
+   mStats.meshing = mJobs.size();
+}
+
+void VoxelWorld::waitForMeshes()
+{
+   for ( U32 i = 0; i < mJobs.size(); ++i )
+      JobSystem::wait(mJobs[i]->counter);
+   processMeshes();
+}
+
+//-----------------------------------------------------------------------------
+// Surface extraction.
+//-----------------------------------------------------------------------------
+
+void VoxelWorld::extractSurface(const U8* padded, VoxelMesh& mesh)
+{
+   // Per face: padded index offset of the neighbour, normal, corner offset
+   // and the two edges. u cross v is the normal, so the quads are counter
+   // clockwise seen from outside and the indices below flip them to match
+   // the clockwise front faces the renderer uses.
+   struct Face
+   {
+      S32 offset;
+      F32 normal[3];
+      F32 base[3];
+      F32 u[3];
+      F32 v[3];
+   };
+
+   static const S32 P = PaddedSize;
+   static const Face faces[6] = {
+      {  1,      {  1,  0,  0 }, { 1, 0, 0 }, { 0, 1, 0 }, { 0, 0, 1 } },
+      { -1,      { -1,  0,  0 }, { 0, 0, 0 }, { 0, 0, 1 }, { 0, 1, 0 } },
+      {  P,      {  0,  1,  0 }, { 0, 1, 0 }, { 0, 0, 1 }, { 1, 0, 0 } },
+      { -P,      {  0, -1,  0 }, { 0, 0, 0 }, { 1, 0, 0 }, { 0, 0, 1 } },
+      {  P * P,  {  0,  0,  1 }, { 0, 0, 1 }, { 1, 0, 0 }, { 0, 1, 0 } },
+      { -P * P,  {  0,  0, -1 }, { 0, 0, 0 }, { 0, 1, 0 }, { 1, 0, 0 } },
+   };
+
+   mesh.verts.clear();
+   mesh.indices.clear();
+
+   for ( S32 z = 0; z < ChunkSize; ++z )
+   {
+      for ( S32 y = 0; y < ChunkSize; ++y )
+      {
+         U32 index = paddedIndex(0, y, z);
+         for ( S32 x = 0; x < ChunkSize; ++x, ++index )
+         {
+            U8 value = padded[index];
+            if ( value == 0 )
+               continue;
+
+            for ( U32 f = 0; f < 6; ++f )
+            {
+               const Face& face = faces[f];
+               if ( padded[index + face.offset] != 0 )
+                  continue;
+
+               U32 first = mesh.verts.size();
+               for ( U32 corner = 0; corner < 4; ++corner )
+               {
+                  F32 cu = (corner == 1 || corner == 2) ? 1.0f : 0.0f;
+                  F32 cv = (corner >= 2) ? 1.0f : 0.0f;
+
+                  mesh.verts.increment();
+                  Graphics::PosUVNormalVertex& vert = mesh.verts.last();
+                  vert.m_x = x + face.base[0] + face.u[0] * cu + face.v[0] * cv;
+                  vert.m_y = y + face.base[1] + face.u[1] * cu + face.v[1] * cv;
+                  vert.m_z = z + face.base[2] + face.u[2] * cu + face.v[2] * cv;
+                  vert.m_u = value / 255.0f;
+                  vert.m_v = 0.0f;
+                  vert.m_normal_x = face.normal[0];
+                  vert.m_normal_y = face.normal[1];
+                  vert.m_normal_z = face.normal[2];
+               }
+
+               mesh.indices.push_back(first);
+               mesh.indices.push_back(first + 2);
+               mesh.indices.push_back(first + 1);
+               mesh.indices.push_back(first);
+               mesh.indices.push_back(first + 3);
+               mesh.indices.push_back(first + 2);
+            }
+         }
+      }
+   }
+}
+
+//-----------------------------------------------------------------------------
+// Compression. Runs of (count, value) bytes, chunks are mostly long runs of
+// empty or solid voxels.
+//-----------------------------------------------------------------------------
+
+U32 VoxelWorld::compress(const U8* voxels, Vector<U8>& data)
+{
+   data.clear();
+
+   U32 i = 0;
+   while ( i < ChunkVoxelCount )
+   {
+      U8 value = voxels[i];
+      U32 run = 1;
+      while ( run < 255 && i + run < ChunkVoxelCount && voxels[i + run] == value )
+         run++;
+
+      data.push_back((U8)run);
+      data.push_back(value);
+      i += run;
+   }
+
+   return data.size();
+}
+
+bool VoxelWorld::decompress(const U8* data, U32 size, U8* voxels)
+{
+   U32 count = 0;
+   for ( U32 i = 0; i + 1 < size; i += 2 )
+   {
+      U32 run = data[i];
+      if ( run == 0 || count + run > ChunkVoxelCount )
+         return false;
+
+      dMemset(voxels + count, data[i + 1], run);
+      count += run;
+   }
+
+   return count == ChunkVoxelCount;
+}
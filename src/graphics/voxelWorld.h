@@ -0,0 +1,234 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2013 GarageGames, LLC
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//-----------------------------------------------------------------------------
+
+#ifndef _VOXEL_WORLD_H_
+#define _VOXEL_WORLD_H_
+
+#ifndef _MMATH_H_
+#include "math/mMath.h"
+#endif
+
+#ifndef _TVECTOR_H_
+#include "collection/vector.h"
+#endif
+
+#ifndef _JOB_SYSTEM_H_
+#include "platform/threads/jobSystem.h"
+#endif
+
+#include "platform/platformLibrary.h"
+
+class Stream;
+
+namespace Graphics
+{
+   struct PosUVNormalVertex;
+}
+
+// ------------------------------------------------------------------------------
+//  VoxelPager
+// ------------------------------------------------------------------------------
+//
+//   Backing store of a VoxelWorld. Chunks leaving memory are handed over run
+//   length encoded, chunks that were never paged out come from generate().
+//
+// ------------------------------------------------------------------------------
+
+class DLL_PUBLIC VoxelPager
+{
+   public:
+      virtual ~VoxelPager() { }
+
+      /// Fill a chunk that was never paged out. Return false to leave it empty.
+      virtual bool generate(const Point3I& chunk, U8* voxels) { return false; }
+
+      virtual void pageOut(const Point3I& chunk, const U8* data, U32 size) = 0;
+
+      /// False when the chunk was never paged out.
+      virtual bool pageIn(const Point3I& chunk, Vector<U8>& data) = 0;
+};
+
+// Keeps paged out chunks in memory, compressed, and can serialize them.
+class DLL_PUBLIC VoxelMemoryPager : public VoxelPager
+{
+   protected:
+      struct Entry
+      {
+         Point3I     chunk;
+         U32         offset;
+         U32         size;
+      };
+
+      Vector<Entry>  mEntries;
+      Vector<U8>     mData;
+      U32            mWasted;
+
+      S32 findEntry(const Point3I& chunk) const;
+      void compact();
+
+   public:
+      VoxelMemoryPager();
+
+      virtual void pageOut(const Point3I& chunk, const U8* data, U32 size);
+      virtual bool pageIn(const Point3I& chunk, Vector<U8>& data);
+
+      U32  getChunkCount() const    { return mEntries.size(); }
+      U32  getDataSize() const      { return mData.size() - mWasted; }
+
+      bool write(Stream& stream);
+      bool read(Stream& stream);
+};
+
+// ------------------------------------------------------------------------------
+//  VoxelWorld
+// ------------------------------------------------------------------------------
+//
+//   Unbounded U8 voxel volume made of ChunkSize^3 chunks, zero is empty.
+//   Chunks around the focus point are kept in memory and the rest is paged
+//   out through a VoxelPager. Chunks holding a single value don't allocate.
+//
+//   Edits mark their chunk dirty, and the neighbours too when the voxel is
+//   on a chunk face. Dirty chunks near the focus are meshed on the job
+//   system. Each job meshes a copy of the chunk padded with the face voxels
+//   of its neighbours, so the main thread keeps editing while it runs and
+//   faces on chunk borders come out exactly once.
+//
+//   Subclasses receive meshes and unloads on the main thread, through
+//   onChunkMeshed() and onChunkUnloaded(). Main thread only.
+//
+// ------------------------------------------------------------------------------
+
+struct VoxelMesh
+{
+   Vector<Graphics::PosUVNormalVertex> verts;
+   Vector<U32>                         indices;
+};
+
+class DLL_PUBLIC VoxelWorld
+{
+   public:
+      enum
+      {
+         ChunkShift        = 5,
+         ChunkSize         = 1 << ChunkShift,
+         ChunkMask         = ChunkSize - 1,
+         ChunkVoxelCount   = ChunkSize * ChunkSize * ChunkSize,
+         PaddedSize        = ChunkSize + 2,
+         PaddedVoxelCount  = PaddedSize * PaddedSize * PaddedSize
+      };
+
+      struct Chunk
+      {
+         Point3I     coord;
+         U8*         voxels;        ///< NULL while every voxel is uniformValue.
+         U8          uniformValue;
+         bool        dirty;
+         bool        meshing;       ///< A job holds a copy, don't unload.
+         bool        modified;      ///< Edited since it was loaded.
+         void*       userData;
+      };
+
+      struct Stats
+      {
+         U32   resident;
+         U32   allocated;     ///< Resident chunks that aren't uniform.
+         U32   loaded;        ///< Chunks paged in or generated by the last updateStreaming().
+         U32   unloaded;
+         U32   meshing;       ///< Jobs in flight.
+         U32   meshed;        ///< Meshes delivered by the last processMeshes().
+      };
+
+   protected:
+      struct MeshJob
+      {
+         Point3I     coord;
+         U8          voxels[PaddedVoxelCount];
+         VoxelMesh   mesh;
+         JobCounter  counter;
+      };
+
+      VoxelPager*       mPager;
+      Vector<Chunk*>    mChunks;
+      Vector<Chunk*>    mTable;        ///< Open addressed, linear probing.
+      Vector<MeshJob*>  mJobs;
+      Vector<MeshJob*>  mFreeJobs;
+      Vector<U8>        mScratch;
+      Stats             mStats;
+
+      static U32 hashCoord(const Point3I& coord);
+      U32  findSlot(const Point3I& coord) const;
+      void insertChunk(Chunk* chunk);
+      void removeChunk(U32 index);
+      void growTable();
+
+      Chunk* loadChunk(const Point3I& coord);
+      void unloadChunk(U32 index);
+      void allocateVoxels(Chunk* chunk);
+      void makeUniform(Chunk* chunk);
+      void markDirty(const Point3I& coord);
+      void copyPadded(const Chunk* chunk, U8* padded);
+      F32  getDistance(const Point3I& coord, const Point3F& focus) const;
+
+      static void meshJob(void* data, U32 first, U32 count);
+
+      virtual void onChunkMeshed(Chunk* chunk, const VoxelMesh& mesh) { }
+      virtual void onChunkUnloaded(Chunk* chunk) { }
+
+   public:
+      VoxelWorld(VoxelPager* pager);
+      virtual ~VoxelWorld();
+
+      static Point3I getChunkCoord(S32 x, S32 y, S32 z) { return Point3I(x >> ChunkShift, y >> ChunkShift, z >> ChunkShift); }
+
+      Chunk* findChunk(const Point3I& coord) const;
+
+      /// Pages the chunk in when needed.
+      U8   getVoxel(S32 x, S32 y, S32 z);
+      void setVoxel(S32 x, S32 y, S32 z, U8 value);
+
+      /// Load chunks within loadRadius of focus (in voxels), nearest first and
+      /// at most maxLoads of them. Chunks beyond unloadRadius are paged out.
+      void updateStreaming(const Point3F& focus, F32 loadRadius, F32 unloadRadius, U32 maxLoads = U32_MAX);
+
+      /// Start meshing dirty chunks within radius of focus, nearest first,
+      /// keeping at most maxJobs in flight.
+      void updateMeshes(const Point3F& focus, F32 radius, U32 maxJobs);
+
+      /// Hand finished meshes to onChunkMeshed().
+      void processMeshes();
+      void waitForMeshes();
+
+      /// Wait for the jobs and unload every chunk through the pager.
+      void flush();
+
+      const Stats& getStats() const { return mStats; }
+      U32  getChunkCount() const    { return mChunks.size(); }
+      Chunk* getChunk(U32 index)    { return mChunks[index]; }
+
+      /// Faces between solid and empty voxels of a padded chunk, in chunk space.
+      static void extractSurface(const U8* padded, VoxelMesh& mesh);
+
+      static U32  compress(const U8* voxels, Vector<U8>& data);
+      static bool decompress(const U8* data, U32 size, U8* voxels);
+};
+
+#endif // _VOXEL_WORLD_H_
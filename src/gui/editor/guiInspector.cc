@@ -896,14 +896,14 @@ GuiInspectorDynamicField::GuiInspectorDynamicField( GuiInspectorGroup* parent, S
 
    mParent     = parent;
    mTarget     = target;
-   mDynField   = field;
+   mDynFieldName = field ? field->slotName : NULL;
    mBounds.set(0,0,100,20);
    mRenameCtrl = NULL;
 }
 
 void GuiInspectorDynamicField::setData( const char* data )
 {
-   if( mTarget == NULL || mDynField == NULL )
+   if( mTarget == NULL || mDynFieldName == NULL )
       return;
 
    char buf[1024];
@@ -911,7 +911,7 @@ void GuiInspectorDynamicField::setData( const char* data )
    dStrcpy( buf, newValue ? newValue : "" );
    collapseEscape(buf);
 
-   mTarget->getFieldDictionary()->setFieldValue(mDynField->slotName, buf);
+   mTarget->getFieldDictionary()->setFieldValue(mDynFieldName, buf);
 
    // Force our edit to update
    updateValue( data );
@@ -920,15 +920,15 @@ void GuiInspectorDynamicField::setData( const char* data )
 
 const char* GuiInspectorDynamicField::getData()
 {
-   if( mTarget == NULL || mDynField == NULL )
+   if( mTarget == NULL || mDynFieldName == NULL )
       return "";
 
-   return mTarget->getFieldDictionary()->getFieldValue( mDynField->slotName );
+   return mTarget->getFieldDictionary()->getFieldValue( mDynFieldName );
 }
 
 void GuiInspectorDynamicField::renameField( StringTableEntry newFieldName )
 {
-   if( mTarget == NULL || mDynField == NULL || mParent == NULL || mEdit == NULL )
+   if( mTarget == NULL || mDynFieldName == NULL || mParent == NULL || mEdit == NULL )
    {
       Con::warnf("GuiInspectorDynamicField::renameField - No target object or dynamic field data found!" );
       return;
@@ -971,8 +971,8 @@ void GuiInspectorDynamicField::renameField( StringTableEntry newFieldName )
    // Set our old fields data to "" (which will effectively erase the field)
    mTarget->setDataField( getFieldName(), NULL, "" );
    
-   // Assign our dynamic field pointer (where we retrieve field information from) to our new field pointer
-   mDynField = newEntry;
+   // Assign our dynamic field name (where we retrieve field information from) to our new field
+   mDynFieldName = newFieldName;
 
    // Lastly we need to reassign our Command and AltCommand fields for our value edit control
    char szBuffer[512];
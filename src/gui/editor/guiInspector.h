@@ -177,7 +177,8 @@ private:
    typedef GuiInspectorField Parent;
    SimObjectPtr<GuiControl>     mRenameCtrl;
 public:
-   SimFieldDictionary::Entry*   mDynField;
+   /// Name of the dynamic field; entries move as fields are added and removed.
+   StringTableEntry             mDynFieldName;
 
    GuiInspectorDynamicField( GuiInspectorGroup* parent, SimObjectPtr<SimObject> target, SimFieldDictionary::Entry* field );
    GuiInspectorDynamicField() {};
@@ -187,7 +188,7 @@ public:
    virtual void setData( const char* data );
    virtual const char* getData();
 
-   virtual StringTableEntry getFieldName() { return ( mDynField != NULL ) ? mDynField->slotName : StringTable->EmptyString; };
+   virtual StringTableEntry getFieldName() { return ( mDynFieldName != NULL ) ? mDynFieldName : StringTable->EmptyString; };
 
    // Override onAdd so we can construct our custom field name edit control
    virtual bool onAdd();
@@ -386,6 +386,10 @@ ConsoleFunctionWithDocs( createCanvas, ConsoleBool, 2, 2, ( WindowTitle ))
 {
     AssertISV(!Canvas, "CreateCanvas: canvas has already been instantiated");
 
+    // No window, video or GUI on a headless server.
+    if (Game->isHeadless())
+        return false;
+
     Platform::initWindow(Point2I(MIN_RESOLUTION_X, MIN_RESOLUTION_Y), argv[1]);
 
 
@@ -453,6 +457,9 @@ extern "C" {
    {
       AssertISV(!Canvas, "CreateCanvas: canvas has already been instantiated");
 
+      if (Game->isHeadless())
+         return false;
+
       Platform::initWindow(Point2I(MIN_RESOLUTION_X, MIN_RESOLUTION_Y), windowTitle);
 
 
@@ -637,6 +644,9 @@ extern "C"{
    {
       AssertISV(!Canvas, "CreateCanvas: canvas has already been instantiated");
 
+      if (Game->isHeadless())
+         return false;
+
       Platform::initWindow(Point2I(MIN_RESOLUTION_X, MIN_RESOLUTION_Y), title);
 
 
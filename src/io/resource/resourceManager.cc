@@ -38,6 +38,7 @@
 #include "console/consoleTypes.h"
 
 #include "memory/safeDelete.h"
+#include "platform/threads/jobSystem.h"
 
 #include "resourceManager_Binding.h"
 
@@ -915,27 +916,20 @@ bool ResManager::loadInstanceThreaded(ResourceObject * obj, bool computeCRC)
        return NULL;
    }
 
-   ResourceThread *rt = new ResourceThread(createFunction, obj);
-   if(!rt->isAlive())
-   {
-      delete rt;
-      return false;
-   }
+   ResourceLoadJob *job = new ResourceLoadJob;
+   job->createFunction = createFunction;
+   job->source = obj;
+   JobSystem::submit(&ResourceLoadJob::run, job);
 
-   Con::printf("Resource Load Thread Created!");
+   Con::printf("Resource Load Job Queued!");
    return true;
 }
 
-ResourceThread::ResourceThread(RESOURCE_CREATE_FN _createFunc, ResourceObject* _source)
-{
-   createFunction = _createFunc;
-   source = _source;
-
-   start();
-}
-
-void ResourceThread::run(void *arg)
+void ResourceLoadJob::run(void* data, U32 first, U32 count)
 {
+   ResourceLoadJob* job = static_cast<ResourceLoadJob*>(data);
+   RESOURCE_CREATE_FN createFunction = job->createFunction;
+   ResourceObject* source = job->source;
    ResourceInstance* ret = NULL;
 
    // if disk file
@@ -954,21 +948,21 @@ void ResourceThread::run(void *arg)
       SAFE_DELETE(stream);
    }
 
-   Sim::postEvent(Sim::getRootGroup(), new ResourceThreadCompleteEvent(this, ret), -1);
+   Sim::postEvent(Sim::getRootGroup(), new ResourceLoadCompleteEvent(job, ret), -1);
 }
 
-void ResourceThreadCompleteEvent::process(SimObject *object)
+void ResourceLoadCompleteEvent::process(SimObject *object)
 {
    if ( mResult )
    {
-      Con::printf("ResourceThreadCompleteEvent: Successful load.");
+      Con::printf("ResourceLoadCompleteEvent: Successful load.");
       SAFE_DELETE(mResult);
    }
    else
-      Con::printf("ResourceThreadCompleteEvent: Load failed.");
+      Con::printf("ResourceLoadCompleteEvent: Load failed.");
 
    // Clean Up.
-   SAFE_DELETE(mThread);
+   SAFE_DELETE(mJob);
 }
 
 //------------------------------------------------------------------------------
@@ -329,27 +329,24 @@ public:
    void remove(ResourceObject *obj);
 };
 
-// Loads Resources on a separate thread.
-class ResourceThread : public Thread
+// Loads a Resource on a job system worker.
+struct ResourceLoadJob
 {
    RESOURCE_CREATE_FN createFunction;
    ResourceObject* source;
 
-public:
-   ResourceThread(RESOURCE_CREATE_FN _createFunc, ResourceObject* _source);
-
-   virtual void run(void *arg = 0);
+   static void run(void* data, U32 first, U32 count);
 };
 
-class ResourceThreadCompleteEvent : public SimEvent
+class ResourceLoadCompleteEvent : public SimEvent
 {
-   ResourceThread *mThread;
+   ResourceLoadJob *mJob;
    ResourceInstance* mResult;
 
 public:
-   ResourceThreadCompleteEvent(ResourceThread* thread, ResourceInstance* result)
+   ResourceLoadCompleteEvent(ResourceLoadJob* job, ResourceInstance* result)
    {
-      mThread = thread;
+      mJob = job;
       mResult = result;
    }
 
@@ -0,0 +1,711 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2013 GarageGames, LLC
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//-----------------------------------------------------------------------------
+
+#include "cubemapFilter.h"
+#include "platform/platform.h"
+#include "platform/threads/jobSystem.h"
+#include "memory/safeDelete.h"
+
+#include <bx/uint32_t.h>
+
+// Debug Profiling.
+#include "debug/profiler.h"
+
+#if defined(__SSE__) || defined(_M_X64) || defined(_M_AMD64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#define TORQUE_CUBEMAP_SSE
+#include <xmmintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#define TORQUE_CUBEMAP_NEON
+#include <arm_neon.h>
+#endif
+
+//-----------------------------------------------------------------------------
+// Texels are RGBA, one texel per four wide register.
+//-----------------------------------------------------------------------------
+
+#if defined(TORQUE_CUBEMAP_SSE)
+
+typedef __m128 F32x4;
+
+static inline F32x4 load4(const F32* p)                  { return _mm_loadu_ps(p); }
+static inline void  store4(F32* p, F32x4 v)              { _mm_storeu_ps(p, v); }
+static inline F32x4 splat4(F32 v)                        { return _mm_set1_ps(v); }
+static inline F32x4 add4(F32x4 a, F32x4 b)               { return _mm_add_ps(a, b); }
+static inline F32x4 sub4(F32x4 a, F32x4 b)               { return _mm_sub_ps(a, b); }
+static inline F32x4 mul4(F32x4 a, F32x4 b)               { return _mm_mul_ps(a, b); }
+static inline F32x4 madd4(F32x4 a, F32x4 b, F32x4 c)     { return _mm_add_ps(a, _mm_mul_ps(b, c)); }
+
+#elif defined(TORQUE_CUBEMAP_NEON)
+
+typedef float32x4_t F32x4;
+
+static inline F32x4 load4(const F32* p)                  { return vld1q_f32(p); }
+static inline void  store4(F32* p, F32x4 v)              { vst1q_f32(p, v); }
+static inline F32x4 splat4(F32 v)                        { return vdupq_n_f32(v); }
+static inline F32x4 add4(F32x4 a, F32x4 b)               { return vaddq_f32(a, b); }
+static inline F32x4 sub4(F32x4 a, F32x4 b)               { return vsubq_f32(a, b); }
+static inline F32x4 mul4(F32x4 a, F32x4 b)               { return vmulq_f32(a, b); }
+static inline F32x4 madd4(F32x4 a, F32x4 b, F32x4 c)     { return vmlaq_f32(a, b, c); }
+
+#else
+
+struct F32x4
+{
+   F32 v[4];
+};
+
+static inline F32x4 load4(const F32* p)                  { F32x4 r; for (U32 i = 0; i < 4; ++i) r.v[i] = p[i]; return r; }
+static inline void  store4(F32* p, F32x4 v)              { for (U32 i = 0; i < 4; ++i) p[i] = v.v[i]; }
+static inline F32x4 splat4(F32 v)                        { F32x4 r; for (U32 i = 0; i < 4; ++i) r.v[i] = v; return r; }
+static inline F32x4 add4(F32x4 a, F32x4 b)               { for (U32 i = 0; i < 4; ++i) a.v[i] += b.v[i]; return a; }
+static inline F32x4 sub4(F32x4 a, F32x4 b)               { for (U32 i = 0; i < 4; ++i) a.v[i] -= b.v[i]; return a; }
+static inline F32x4 mul4(F32x4 a, F32x4 b)               { for (U32 i = 0; i < 4; ++i) a.v[i] *= b.v[i]; return a; }
+static inline F32x4 madd4(F32x4 a, F32x4 b, F32x4 c)     { for (U32 i = 0; i < 4; ++i) a.v[i] += b.v[i] * c.v[i]; return a; }
+
+#endif
+
+namespace Lighting
+{
+   // ----------------------------------------------
+   // Utility functions.
+   // ----------------------------------------------
+
+   F32 radicalInverse_VdC(S32 index) {
+      U32 bits = (U32)index;
+      bits = (bits << 16u) | (bits >> 16u);
+      bits = ((bits & 0x55555555u) << 1u) | ((bits & 0xAAAAAAAAu) >> 1u);
+      bits = ((bits & 0x33333333u) << 2u) | ((bits & 0xCCCCCCCCu) >> 2u);
+      bits = ((bits & 0x0F0F0F0Fu) << 4u) | ((bits & 0xF0F0F0F0u) >> 4u);
+      bits = ((bits & 0x00FF00FFu) << 8u) | ((bits & 0xFF00FF00u) >> 8u);
+      return F32(bits) * 2.3283064365386963e-10f; // / 0x100000000
+   }
+
+   // http://holger.dammertz.org/stuff/notes_HammersleyOnHemisphere.html
+   Point2F Hammersley(S32 i, S32 N) {
+      return Point2F(F32(i) / F32(N), radicalInverse_VdC(i));
+   }
+
+   Point3F ImportanceSampleGGX(Point2F Xi, F32 Roughness, Point3F N)
+   {
+      F32 a = Roughness * Roughness; // DISNEY'S ROUGHNESS [see Burley'12 siggraph]
+
+      // Compute distribution direction
+      F32 Phi = 2.0f * M_PI_F * Xi.x;
+      F32 CosTheta = mSqrt((1.0f - Xi.y) / (1.0f + (a*a - 1.0f) * Xi.y));
+      F32 SinTheta = mSqrt(mFabs(1.0f - CosTheta * CosTheta));
+
+      // Convert to spherical direction
+      Point3F H;
+      H.x = SinTheta * mCos(Phi);
+      H.y = SinTheta * mSin(Phi);
+      H.z = CosTheta;
+
+      Point3F UpVector = mFabs(N.z) < 0.999f ? Point3F(0.0f, 0.0f, 1.0f) : Point3F(1.0f, 0.0f, 0.0f);
+      Point3F TangentX = mCross(UpVector, N);
+      TangentX.normalize();
+      Point3F TangentY = mCross(N, TangentX);
+
+      // Tangent to world space
+      return TangentX * H.x + TangentY * H.y + N * H.z;
+   }
+
+   // u, v and face vectors of each face, in bgfx/OpenGL order.
+   static const F32 sFaceUvVectors[6][3][3] =
+   {
+      { {  0.0f,  0.0f, -1.0f }, { 0.0f, -1.0f,  0.0f }, {  1.0f,  0.0f,  0.0f } }, // +x
+      { {  0.0f,  0.0f,  1.0f }, { 0.0f, -1.0f,  0.0f }, { -1.0f,  0.0f,  0.0f } }, // -x
+      { {  1.0f,  0.0f,  0.0f }, { 0.0f,  0.0f,  1.0f }, {  0.0f,  1.0f,  0.0f } }, // +y
+      { {  1.0f,  0.0f,  0.0f }, { 0.0f,  0.0f, -1.0f }, {  0.0f, -1.0f,  0.0f } }, // -y
+      { {  1.0f,  0.0f,  0.0f }, { 0.0f, -1.0f,  0.0f }, {  0.0f,  0.0f,  1.0f } }, // +z
+      { { -1.0f,  0.0f,  0.0f }, { 0.0f, -1.0f,  0.0f }, {  0.0f,  0.0f, -1.0f } }, // -z
+   };
+
+   Point3F texelCoordToVec(Point2F uv, U32 faceID)
+   {
+      // out = u * s_faceUv[0] + v * s_faceUv[1] + s_faceUv[2].
+      const F32 (*face)[3] = sFaceUvVectors[faceID];
+      Point3F result(face[0][0] * uv.x + face[1][0] * uv.y + face[2][0],
+                     face[0][1] * uv.x + face[1][1] * uv.y + face[2][1],
+                     face[0][2] * uv.x + face[1][2] * uv.y + face[2][2]);
+      result.normalize();
+      return result;
+   }
+
+   void vecToTexelCoord(const Point3F& dir, U32& faceID, Point2F& uv)
+   {
+      F32 ax = mFabs(dir.x);
+      F32 ay = mFabs(dir.y);
+      F32 az = mFabs(dir.z);
+      F32 major, u, v;
+
+      if (ax >= ay && ax >= az)
+      {
+         major = ax;
+         faceID = dir.x > 0.0f ? 0 : 1;
+         u = dir.x > 0.0f ? -dir.z : dir.z;
+         v = -dir.y;
+      }
+      else if (ay >= az)
+      {
+         major = ay;
+         faceID = dir.y > 0.0f ? 2 : 3;
+         u = dir.x;
+         v = dir.y > 0.0f ? dir.z : -dir.z;
+      }
+      else
+      {
+         major = az;
+         faceID = dir.z > 0.0f ? 4 : 5;
+         u = dir.z > 0.0f ? dir.x : -dir.x;
+         v = -dir.y;
+      }
+
+      F32 scale = 0.5f / major;
+      uv.x = u * scale + 0.5f;
+      uv.y = v * scale + 0.5f;
+   }
+
+   // Center of a texel in [-1, 1] face coordinates.
+   static inline F32 texelCenter(U32 x, U32 size)
+   {
+      return (2.0f * x + 1.0f) / size - 1.0f;
+   }
+
+   // ----------------------------------------------
+   // CubemapImage
+   // ----------------------------------------------
+
+   CubemapImage::CubemapImage()
+   {
+      mSize       = 0;
+      mMipCount   = 0;
+      mData       = NULL;
+   }
+
+   CubemapImage::~CubemapImage()
+   {
+      SAFE_DELETE_ARRAY(mData);
+   }
+
+   void CubemapImage::init(U32 size, U32 mipCount)
+   {
+      SAFE_DELETE_ARRAY(mData);
+
+      U32 fullChain = getBinLog2(getMax(size, (U32)1)) + 1;
+      mSize       = size;
+      mMipCount   = getMin(mipCount == 0 ? fullChain : getMin(mipCount, fullChain), (U32)MaxMips);
+
+      U32 total = 0;
+      for (U32 mip = 0; mip < mMipCount; ++mip)
+      {
+         mMipOffset[mip] = total;
+         total += getSize(mip) * getSize(mip) * 6 * 4;
+      }
+
+      mData = new F32[total];
+      dMemset(mData, 0, sizeof(F32) * total);
+   }
+
+   void CubemapImage::setFromBGRA8(const U8* data)
+   {
+      const F32 scale = 1.0f / 255.0f;
+      U32 count = mSize * mSize * 6;
+      for (U32 i = 0; i < count; ++i)
+      {
+         mData[i * 4 + 0] = data[i * 4 + 2] * scale;
+         mData[i * 4 + 1] = data[i * 4 + 1] * scale;
+         mData[i * 4 + 2] = data[i * 4 + 0] * scale;
+         mData[i * 4 + 3] = data[i * 4 + 3] * scale;
+      }
+   }
+
+   void CubemapImage::buildMips()
+   {
+      PROFILE_SCOPE(CubemapImage_BuildMips);
+
+      const F32x4 quarter = splat4(0.25f);
+      for (U32 mip = 1; mip < mMipCount; ++mip)
+      {
+         U32 size = getSize(mip);
+         U32 parentSize = getSize(mip - 1);
+         for (U32 face = 0; face < 6; ++face)
+         {
+            const F32* parent = getFace(face, mip - 1);
+            F32* texels = getFace(face, mip);
+            for (U32 y = 0; y < size; ++y)
+            {
+               for (U32 x = 0; x < size; ++x)
+               {
+                  const F32* a = parent + ((y * 2) * parentSize + x * 2) * 4;
+                  const F32* b = a + parentSize * 4;
+                  F32x4 sum = add4(add4(load4(a), load4(a + 4)), add4(load4(b), load4(b + 4)));
+                  store4(texels + (y * size + x) * 4, mul4(sum, quarter));
+               }
+            }
+         }
+      }
+   }
+
+   static inline F32x4 sampleBilinear(const CubemapImage& image, U32 face, U32 mip, const Point2F& uv)
+   {
+      U32 size = image.getSize(mip);
+      const F32* texels = image.getFace(face, mip);
+
+      F32 px = mClampF(uv.x * size - 0.5f, 0.0f, size - 1.0f);
+      F32 py = mClampF(uv.y * size - 0.5f, 0.0f, size - 1.0f);
+      U32 x0 = (U32)px;
+      U32 y0 = (U32)py;
+      U32 x1 = getMin(x0 + 1, size - 1);
+      U32 y1 = getMin(y0 + 1, size - 1);
+      F32x4 fx = splat4(px - x0);
+      F32x4 fy = splat4(py - y0);
+
+      F32x4 a = load4(texels + (y0 * size + x0) * 4);
+      F32x4 b = load4(texels + (y0 * size + x1) * 4);
+      F32x4 c = load4(texels + (y1 * size + x0) * 4);
+      F32x4 d = load4(texels + (y1 * size + x1) * 4);
+
+      F32x4 top = madd4(a, fx, sub4(b, a));
+      F32x4 bottom = madd4(c, fx, sub4(d, c));
+      return madd4(top, fy, sub4(bottom, top));
+   }
+
+   static inline F32x4 sampleTrilinear(const CubemapImage& image, const Point3F& dir, F32 lod)
+   {
+      U32 face;
+      Point2F uv;
+      vecToTexelCoord(dir, face, uv);
+
+      lod = mClampF(lod, 0.0f, (F32)(image.getMipCount() - 1));
+      U32 mip = (U32)lod;
+      F32 blend = lod - mip;
+
+      F32x4 result = sampleBilinear(image, face, mip, uv);
+      if (blend > 0.0f && mip + 1 < image.getMipCount())
+         result = madd4(result, splat4(blend), sub4(sampleBilinear(image, face, mip + 1, uv), result));
+      return result;
+   }
+
+   void CubemapImage::sample(const Point3F& dir, F32 lod, F32* rgba) const
+   {
+      store4(rgba, sampleTrilinear(*this, dir, lod));
+   }
+
+   void CubemapImage::writeRGBA16F(U32 mip, U16* dest) const
+   {
+      U32 count = getSize(mip) * getSize(mip) * 6 * 4;
+      const F32* texels = getFace(0, mip);
+      for (U32 i = 0; i < count; ++i)
+         dest[i] = bx::halfFromFloat(texels[i]);
+   }
+
+   void CubemapImage::writeBGRA8(U32 mip, U8* dest) const
+   {
+      U32 count = getSize(mip) * getSize(mip) * 6;
+      const F32* texels = getFace(0, mip);
+      for (U32 i = 0; i < count; ++i)
+      {
+         dest[i * 4 + 0] = (U8)(mClampF(texels[i * 4 + 2], 0.0f, 1.0f) * 255.0f + 0.5f);
+         dest[i * 4 + 1] = (U8)(mClampF(texels[i * 4 + 1], 0.0f, 1.0f) * 255.0f + 0.5f);
+         dest[i * 4 + 2] = (U8)(mClampF(texels[i * 4 + 0], 0.0f, 1.0f) * 255.0f + 0.5f);
+         dest[i * 4 + 3] = (U8)(mClampF(texels[i * 4 + 3], 0.0f, 1.0f) * 255.0f + 0.5f);
+      }
+   }
+
+   // ----------------------------------------------
+   // Prefiltering.
+   // ----------------------------------------------
+
+   // Direction in the tangent space of N, weight and source lod. With N = V
+   // they only depend on the roughness, so they're computed once per mip.
+   struct PrefilterSample
+   {
+      F32 x, y, z;
+      F32 weight;
+      F32 lod;
+   };
+
+   struct PrefilterJob
+   {
+      const CubemapImage*     source;
+      CubemapImage*           dest;
+      U32                     mip;
+      const PrefilterSample*  samples;
+      U32                     sampleCount;
+      F32                     invWeight;
+   };
+
+   static void prefilterRows(void* data, U32 first, U32 count)
+   {
+      PROFILE_SCOPE(CubemapFilter_PrefilterRows);
+
+      const PrefilterJob* job = (const PrefilterJob*)data;
+      const U32 size = job->dest->getSize(job->mip);
+      const F32x4 invWeight = splat4(job->invWeight);
+
+      for (U32 row = first; row < first + count; ++row)
+      {
+         U32 face = row / size;
+         U32 y = row % size;
+         F32* texels = job->dest->getFace(face, job->mip) + y * size * 4;
+
+         for (U32 x = 0; x < size; ++x)
+         {
+            Point3F N = texelCoordToVec(Point2F(texelCenter(x, size), texelCenter(y, size)), face);
+            Point3F up = mFabs(N.z) < 0.999f ? Point3F(0.0f, 0.0f, 1.0f) : Point3F(1.0f, 0.0f, 0.0f);
+            Point3F tangentX = mCross(up, N);
+            tangentX.normalize();
+            Point3F tangentY = mCross(N, tangentX);
+
+            F32x4 sum = splat4(0.0f);
+            for (U32 n = 0; n < job->sampleCount; ++n)
+            {
+               const PrefilterSample& s = job->samples[n];
+               Point3F L = tangentX * s.x + tangentY * s.y + N * s.z;
+               sum = madd4(sum, splat4(s.weight), sampleTrilinear(*job->source, L, s.lod));
+            }
+
+            store4(texels + x * 4, mul4(sum, invWeight));
+         }
+      }
+   }
+
+   void prefilterGGX(const CubemapImage& source, CubemapImage& dest, U32 mip, F32 roughness, U32 sampleCount)
+   {
+      PROFILE_SCOPE(CubemapFilter_PrefilterGGX);
+
+      const F32 sourceSize = (F32)source.getSize();
+      const U32 destSize = dest.getSize(mip);
+
+      // Without roughness the source mip matching the destination size is
+      // read, averaging every texel underneath.
+      const F32 baseLod = mLog2(sourceSize / destSize);
+
+      Vector<PrefilterSample> samples;
+      if (roughness <= 0.0f || sampleCount < 2)
+      {
+         samples.increment();
+         PrefilterSample& s = samples.last();
+         s.x = 0.0f;
+         s.y = 0.0f;
+         s.z = 1.0f;
+         s.weight = 1.0f;
+         s.lod = baseLod;
+      } else {
+         // Filtered importance sampling: each sample reads the mip whose
+         // texels cover the solid angle the sample stands for.
+         // http://http.developer.nvidia.com/GPUGems3/gpugems3_ch20.html
+         const F32 a = roughness * roughness;
+         const F32 a2 = a * a;
+         const F32 texelSolidAngle = 4.0f * M_PI_F / (6.0f * sourceSize * sourceSize);
+
+         for (U32 n = 0; n < sampleCount; ++n)
+         {
+            Point2F Xi = Hammersley(n, sampleCount);
+            F32 phi = 2.0f * M_PI_F * Xi.x;
+            F32 cosTheta = mSqrt((1.0f - Xi.y) / (1.0f + (a2 - 1.0f) * Xi.y));
+            F32 sinTheta = mSqrt(mFabs(1.0f - cosTheta * cosTheta));
+
+            // Reflect V = N around H.
+            Point3F H(sinTheta * mCos(phi), sinTheta * mSin(phi), cosTheta);
+            Point3F L(2.0f * cosTheta * H.x, 2.0f * cosTheta * H.y, 2.0f * cosTheta * cosTheta - 1.0f);
+            if (L.z <= 0.0f)
+               continue;
+
+            // pdf = D * NdotH / (4 * VdotH), with NdotH == VdotH.
+            F32 d = (a2 - 1.0f) * cosTheta * cosTheta + 1.0f;
+            F32 pdf = a2 / (M_PI_F * d * d) * 0.25f;
+            F32 sampleSolidAngle = 1.0f / (sampleCount * pdf);
+
+            samples.increment();
+            PrefilterSample& s = samples.last();
+            s.x = L.x;
+            s.y = L.y;
+            s.z = L.z;
+            s.weight = L.z;
+            s.lod = getMax(0.5f * mLog2(sampleSolidAngle / texelSolidAngle), 0.0f);
+         }
+      }
+
+      F32 totalWeight = 0.0f;
+      for (U32 n = 0; n < samples.size(); ++n)
+         totalWeight += samples[n].weight;
+
+      PrefilterJob job;
+      job.source        = &source;
+      job.dest          = &dest;
+      job.mip           = mip;
+      job.samples       = samples.address();
+      job.sampleCount   = samples.size();
+      job.invWeight     = 1.0f / totalWeight;
+
+      JobCounter counter;
+      JobSystem::parallelFor(destSize * 6, 0, &prefilterRows, &job, &counter);
+      JobSystem::wait(counter);
+   }
+
+   void prefilterRadiance(const CubemapImage& source, CubemapImage& dest, U32 sampleCount)
+   {
+      for (U32 mip = 0; mip < dest.getMipCount(); ++mip)
+         prefilterGGX(source, dest, mip, (F32)mip / (F32)dest.getMipCount(), sampleCount);
+   }
+
+   // ----------------------------------------------
+   // BRDF lookup.
+   // ----------------------------------------------
+
+   struct BRDFJob
+   {
+      U32   size;
+      U32   sampleCount;
+      F32*  rg;
+   };
+
+   // http://graphicrants.blogspot.com.au/2013/08/specular-brdf-reference.html
+   static inline F32 G_Schlick(F32 NdotV, F32 k)
+   {
+      return NdotV / (NdotV * (1.0f - k) + k);
+   }
+
+   static void integrateBRDFRows(void* data, U32 first, U32 count)
+   {
+      const BRDFJob* job = (const BRDFJob*)data;
+      const Point3F N(0.0f, 0.0f, 1.0f);
+
+      // Same layout as generateBRDF_fs: roughness along x, NdotV along y.
+      for (U32 y = first; y < first + count; ++y)
+      {
+         F32 NoV = (y + 0.5f) / job->size;
+         Point3F V(mSqrt(1.0f - NoV * NoV), 0.0f, NoV);
+
+         for (U32 x = 0; x < job->size; ++x)
+         {
+            F32 roughness = (x + 0.5f) / job->size;
+            F32 k = roughness * roughness * 0.5f;
+            F32 A = 0.0f;
+            F32 B = 0.0f;
+
+            for (U32 n = 0; n < job->sampleCount; ++n)
+            {
+               Point3F H = ImportanceSampleGGX(Hammersley(n, job->sampleCount), roughness, N);
+               Point3F L = H * (2.0f * mDot(V, H)) - V;
+
+               F32 NoL = mClampF(L.z, 0.0f, 1.0f);
+               F32 NoH = mClampF(H.z, 0.0f, 1.0f);
+               F32 VoH = mClampF(mDot(V, H), 0.0f, 1.0f);
+               if (NoL <= 0.0f)
+                  continue;
+
+               F32 G     = G_Schlick(NoL, k) * G_Schlick(NoV, k);
+               F32 G_Vis = G * VoH / (NoH * NoV);
+               F32 Fc    = mPow(1.0f - VoH, 5.0f);
+
+               A += (1.0f - Fc) * G_Vis;
+               B += Fc * G_Vis;
+            }
+
+            job->rg[(y * job->size + x) * 2 + 0] = A / job->sampleCount;
+            job->rg[(y * job->size + x) * 2 + 1] = B / job->sampleCount;
+         }
+      }
+   }
+
+   void integrateBRDF(U32 size, U32 sampleCount, F32* rg)
+   {
+      PROFILE_SCOPE(CubemapFilter_IntegrateBRDF);
+
+      BRDFJob job;
+      job.size          = size;
+      job.sampleCount   = sampleCount;
+      job.rg            = rg;
+
+      JobCounter counter;
+      JobSystem::parallelFor(size, 0, &integrateBRDFRows, &job, &counter);
+      JobSystem::wait(counter);
+   }
+
+   // ----------------------------------------------
+   // Spherical harmonics.
+   // ----------------------------------------------
+
+   static inline void shBasis(const Point3F& d, F32* y)
+   {
+      y[0] = 0.282095f;
+      y[1] = 0.488603f * d.y;
+      y[2] = 0.488603f * d.z;
+      y[3] = 0.488603f * d.x;
+      y[4] = 1.092548f * d.x * d.y;
+      y[5] = 1.092548f * d.y * d.z;
+      y[6] = 0.315392f * (3.0f * d.z * d.z - 1.0f);
+      y[7] = 1.092548f * d.x * d.z;
+      y[8] = 0.546274f * (d.x * d.x - d.y * d.y);
+   }
+
+   Point3F IrradianceSH::evaluate(const Point3F& dir) const
+   {
+      F32 y[9];
+      shBasis(dir, y);
+
+      Point3F result = Point3F::Zero;
+      for (U32 i = 0; i < 9; ++i)
+         result += coeffs[i] * y[i];
+      return result;
+   }
+
+   // Every row writes its own sums so the reduction doesn't depend on how
+   // the rows were split between threads.
+   struct ProjectSHJob
+   {
+      const CubemapImage*  source;
+      F32*                 rowSums;
+   };
+
+   static const U32 sSHRowStride = 9 * 4 + 4;
+
+   static void projectSHRows(void* data, U32 first, U32 count)
+   {
+      PROFILE_SCOPE(CubemapFilter_ProjectSHRows);
+
+      const ProjectSHJob* job = (const ProjectSHJob*)data;
+      const U32 size = job->source->getSize();
+
+      for (U32 row = first; row < first + count; ++row)
+      {
+         U32 face = row / size;
+         U32 y = row % size;
+         const F32* texels = job->source->getFace(face) + y * size * 4;
+         F32 v = texelCenter(y, size);
+
+         F32x4 sums[9];
+         for (U32 i = 0; i < 9; ++i)
+            sums[i] = splat4(0.0f);
+         F32 solidAngle = 0.0f;
+
+         for (U32 x = 0; x < size; ++x)
+         {
+            F32 u = texelCenter(x, size);
+
+            // Solid angle of the texel, its area on the unit cube projected
+            // onto the sphere.
+            F32 t = 1.0f + u * u + v * v;
+            F32 weight = 4.0f / (t * mSqrt(t) * size * size);
+            solidAngle += weight;
+
+            F32 basis[9];
+            shBasis(texelCoordToVec(Point2F(u, v), face), basis);
+
+            F32x4 color = mul4(load4(texels + x * 4), splat4(weight));
+            for (U32 i = 0; i < 9; ++i)
+               sums[i] = madd4(sums[i], splat4(basis[i]), color);
+         }
+
+         F32* out = job->rowSums + row * sSHRowStride;
+         for (U32 i = 0; i < 9; ++i)
+            store4(out + i * 4, sums[i]);
+         out[36] = solidAngle;
+      }
+   }
+
+   void projectIrradianceSH(const CubemapImage& source, IrradianceSH& sh)
+   {
+      PROFILE_SCOPE(CubemapFilter_ProjectIrradianceSH);
+
+      const U32 rows = source.getSize() * 6;
+      Vector<F32> rowSums;
+      rowSums.setSize(rows * sSHRowStride);
+
+      ProjectSHJob job;
+      job.source  = &source;
+      job.rowSums = rowSums.address();
+
+      JobCounter counter;
+      JobSystem::parallelFor(rows, 0, &projectSHRows, &job, &counter);
+      JobSystem::wait(counter);
+
+      F64 totals[9][3];
+      F64 solidAngle = 0.0;
+      dMemset(totals, 0, sizeof(totals));
+      for (U32 row = 0; row < rows; ++row)
+      {
+         const F32* sums = rowSums.address() + row * sSHRowStride;
+         for (U32 i = 0; i < 9; ++i)
+         {
+            totals[i][0] += sums[i * 4 + 0];
+            totals[i][1] += sums[i * 4 + 1];
+            totals[i][2] += sums[i * 4 + 2];
+         }
+         solidAngle += sums[36];
+      }
+
+      // Texel solid angles only add up to 4 pi approximately. The cosine
+      // lobe convolution scales the bands by pi, 2 pi / 3 and pi / 4, and
+      // the result is divided by pi.
+      static const F32 bandScale[9] = { 1.0f, 2.0f / 3.0f, 2.0f / 3.0f, 2.0f / 3.0f, 0.25f, 0.25f, 0.25f, 0.25f, 0.25f };
+      const F64 normalize = 4.0 * M_PI / solidAngle;
+      for (U32 i = 0; i < 9; ++i)
+      {
+         F32 scale = (F32)(normalize * bandScale[i]);
+         sh.coeffs[i].set((F32)totals[i][0] * scale, (F32)totals[i][1] * scale, (F32)totals[i][2] * scale);
+      }
+   }
+
+   struct RenderIrradianceJob
+   {
+      const IrradianceSH*  sh;
+      CubemapImage*        dest;
+   };
+
+   static void renderIrradianceRows(void* data, U32 first, U32 count)
+   {
+      const RenderIrradianceJob* job = (const RenderIrradianceJob*)data;
+      const U32 size = job->dest->getSize();
+
+      for (U32 row = first; row < first + count; ++row)
+      {
+         U32 face = row / size;
+         U32 y = row % size;
+         F32* texels = job->dest->getFace(face) + y * size * 4;
+
+         for (U32 x = 0; x < size; ++x)
+         {
+            Point3F color = job->sh->evaluate(texelCoordToVec(Point2F(texelCenter(x, size), texelCenter(y, size)), face));
+            texels[x * 4 + 0] = getMax(color.x, 0.0f);
+            texels[x * 4 + 1] = getMax(color.y, 0.0f);
+            texels[x * 4 + 2] = getMax(color.z, 0.0f);
+            texels[x * 4 + 3] = 1.0f;
+         }
+      }
+   }
+
+   void renderIrradiance(const IrradianceSH& sh, CubemapImage& dest)
+   {
+      PROFILE_SCOPE(CubemapFilter_RenderIrradiance);
+
+      RenderIrradianceJob job;
+      job.sh   = &sh;
+      job.dest = &dest;
+
+      JobCounter counter;
+      JobSystem::parallelFor(dest.getSize() * 6, 0, &renderIrradianceRows, &job, &counter);
+      JobSystem::wait(counter);
+   }
+}
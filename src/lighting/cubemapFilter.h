@@ -0,0 +1,132 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2013 GarageGames, LLC
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//-----------------------------------------------------------------------------
+
+#ifndef _CUBEMAP_FILTER_H_
+#define _CUBEMAP_FILTER_H_
+
+#ifndef _MMATH_H_
+#include "math/mMath.h"
+#endif
+
+namespace Lighting
+{
+   // ----------------------------------------------
+   // Sampling utilities, shared with the GPU processor.
+   // ----------------------------------------------
+
+   F32 radicalInverse_VdC(S32 bits);
+   Point2F Hammersley(S32 i, S32 N);
+   Point3F ImportanceSampleGGX(Point2F Xi, F32 Roughness, Point3F N);
+
+   /// uv in [-1, 1] on a face, returns a normalized direction.
+   Point3F texelCoordToVec(Point2F uv, U32 faceID);
+
+   /// Inverse of texelCoordToVec, uv in [0, 1].
+   void vecToTexelCoord(const Point3F& dir, U32& faceID, Point2F& uv);
+
+   // ----------------------------------------------
+   // Float cubemap.
+   // ----------------------------------------------
+   //
+   // RGBA F32 texels with a mip chain. Mips are stored one after the other,
+   // each one face after face. Faces are sampled on their own, filtering
+   // doesn't cross edges.
+
+   class CubemapImage
+   {
+      public:
+         enum
+         {
+            MaxMips = 16
+         };
+
+      protected:
+         U32   mSize;
+         U32   mMipCount;
+         F32*  mData;
+         U32   mMipOffset[MaxMips];
+
+      public:
+         CubemapImage();
+         ~CubemapImage();
+
+         /// A mip count of zero allocates the full chain.
+         void init(U32 size, U32 mipCount = 0);
+
+         U32 getSize(U32 mip = 0) const      { return getMax(mSize >> mip, (U32)1); }
+         U32 getMipCount() const             { return mMipCount; }
+
+         F32* getFace(U32 face, U32 mip = 0)             { return mData + mMipOffset[mip] + face * getSize(mip) * getSize(mip) * 4; }
+         const F32* getFace(U32 face, U32 mip = 0) const { return mData + mMipOffset[mip] + face * getSize(mip) * getSize(mip) * 4; }
+
+         /// Mip 0 from six BGRA8 faces.
+         void setFromBGRA8(const U8* data);
+
+         /// Box filter mip 0 down the chain.
+         void buildMips();
+
+         /// Trilinear lookup, lod in mips.
+         void sample(const Point3F& dir, F32 lod, F32* rgba) const;
+
+         void writeRGBA16F(U32 mip, U16* dest) const;
+         void writeBGRA8(U32 mip, U8* dest) const;
+   };
+
+   // ----------------------------------------------
+   // Prefiltering.
+   // ----------------------------------------------
+
+   /// GGX prefilter of source into one mip of dest, assuming N = V = R.
+   /// Samples read the source mip matching their solid angle, so a few
+   /// dozen are enough where point sampling needs hundreds. Runs on the
+   /// job system.
+   void prefilterGGX(const CubemapImage& source, CubemapImage& dest, U32 mip, F32 roughness, U32 sampleCount);
+
+   /// Every mip of dest, roughness going up by 1 / mip count per mip like
+   /// the GPU processor.
+   void prefilterRadiance(const CubemapImage& source, CubemapImage& dest, U32 sampleCount);
+
+   /// Split sum BRDF lookup, scale and bias in RG.
+   void integrateBRDF(U32 size, U32 sampleCount, F32* rg);
+
+   // ----------------------------------------------
+   // Spherical harmonics irradiance.
+   // ----------------------------------------------
+
+   /// Order 2 (9 coefficient) spherical harmonics already convolved with
+   /// the cosine lobe and divided by pi, so evaluate() returns the outgoing
+   /// radiance of a white Lambertian surface.
+   struct IrradianceSH
+   {
+      Point3F coeffs[9];
+
+      Point3F evaluate(const Point3F& dir) const;
+   };
+
+   /// Project mip 0 of source, every texel weighted by its solid angle.
+   void projectIrradianceSH(const CubemapImage& source, IrradianceSH& sh);
+
+   /// Fill mip 0 of dest from the coefficients.
+   void renderIrradiance(const IrradianceSH& sh, CubemapImage& dest);
+}
+
+#endif // _CUBEMAP_FILTER_H_
@@ -31,6 +31,7 @@
 #include "scene/components/cameraComponent.h"
 
 #include <bx/fpumath.h>
+#include <bx/uint32_t.h>
 
 // Controls the size of the tiles the cubemap convolution work
 // is divided into.
@@ -38,88 +39,6 @@ static const U32 sTileSize = 32;
 
 namespace Lighting
 {
-   // ----------------------------------------------
-   // Utility functions.
-   // ----------------------------------------------
-
-   F32 radicalInverse_VdC(S32 bits) {
-      bits = (bits << 16u) | (bits >> 16u);
-      bits = ((bits & 0x55555555u) << 1u) | ((bits & 0xAAAAAAAAu) >> 1u);
-      bits = ((bits & 0x33333333u) << 2u) | ((bits & 0xCCCCCCCCu) >> 2u);
-      bits = ((bits & 0x0F0F0F0Fu) << 4u) | ((bits & 0xF0F0F0F0u) >> 4u);
-      bits = ((bits & 0x00FF00FFu) << 8u) | ((bits & 0xFF00FF00u) >> 8u);
-      return F32(bits) * 2.3283064365386963e-10f; // / 0x100000000
-   }
-
-   // http://holger.dammertz.org/stuff/notes_HammersleyOnHemisphere.html
-   Point2F Hammersley(S32 i, S32 N) {
-      return Point2F(F32(i) / F32(N), radicalInverse_VdC(i));
-   }
-
-   Point3F ImportanceSampleGGX(Point2F Xi, F32 Roughness, Point3F N)
-   {
-      F32 a = Roughness * Roughness; // DISNEY'S ROUGHNESS [see Burley'12 siggraph]
-
-      // Compute distribution direction
-      F32 Phi = 2.0f * M_PI_F * Xi.x;
-      F32 CosTheta = mSqrt((1.0f - Xi.y) / (1.0f + (a*a - 1.0f) * Xi.y));
-      F32 SinTheta = mSqrt((F32)abs(1.0f - CosTheta * CosTheta));
-
-      // Convert to spherical direction
-      Point3F H;
-      H.x = SinTheta * mCos(Phi);
-      H.y = SinTheta * mSin(Phi);
-      H.z = CosTheta;
-
-      Point3F UpVector = abs(N.z) < 0.999 ? Point3F(0.0, 0.0, 1.0) : Point3F(1.0, 0.0, 0.0);
-      Point3F TangentX = mCross(UpVector, N);
-      TangentX.normalize();
-      Point3F TangentY = mCross(N, TangentX);
-
-      // Tangent to world space
-      return TangentX * H.x + TangentY * H.y + N * H.z;
-   }
-
-   Point3F texelCoordToVec(Point2F uv, U32 faceID)
-   {
-      Point3F faceUvVectors[6][3];
-
-      // +x
-      faceUvVectors[0][0] = Point3F(0.0, 0.0, -1.0); // u -> -z
-      faceUvVectors[0][1] = Point3F(0.0, -1.0, 0.0); // v -> -y
-      faceUvVectors[0][2] = Point3F(1.0, 0.0, 0.0);  // +x face
-
-      // -x
-      faceUvVectors[1][0] = Point3F(0.0, 0.0, 1.0);  // u -> +z
-      faceUvVectors[1][1] = Point3F(0.0, -1.0, 0.0); // v -> -y
-      faceUvVectors[1][2] = Point3F(-1.0, 0.0, 0.0); // -x face
-
-      // +y
-      faceUvVectors[2][0] = Point3F(1.0, 0.0, 0.0);  // u -> +x
-      faceUvVectors[2][1] = Point3F(0.0, 0.0, 1.0);  // v -> +z
-      faceUvVectors[2][2] = Point3F(0.0, 1.0, 0.0);  // +y face
-
-      // -y
-      faceUvVectors[3][0] = Point3F(1.0, 0.0, 0.0);  // u -> +x
-      faceUvVectors[3][1] = Point3F(0.0, 0.0, -1.0); // v -> -z
-      faceUvVectors[3][2] = Point3F(0.0, -1.0, 0.0); // -y face
-
-      // +z
-      faceUvVectors[4][0] = Point3F(1.0, 0.0, 0.0);  // u -> +x
-      faceUvVectors[4][1] = Point3F(0.0, -1.0, 0.0); // v -> -y
-      faceUvVectors[4][2] = Point3F(0.0, 0.0, 1.0);  // +z face
-
-      // -z
-      faceUvVectors[5][0] = Point3F(-1.0, 0.0, 0.0); // u -> -x
-      faceUvVectors[5][1] = Point3F(0.0, -1.0, 0.0); // v -> -y
-      faceUvVectors[5][2] = Point3F(0.0, 0.0, -1.0); // -z face
-
-      // out = u * s_faceUv[0] + v * s_faceUv[1] + s_faceUv[2].
-      Point3F result = (faceUvVectors[faceID][0] * uv.x) + (faceUvVectors[faceID][1] * uv.y) + faceUvVectors[faceID][2];
-      result.normalize();
-      return result;
-   }
-
    // ----------------------------------------------
    // GPU Cubemap Processor
    // ----------------------------------------------
@@ -364,27 +283,30 @@ namespace Lighting
    }
 
    // ----------------------------------------------
-   // CPU Cubemap Processor - Currently incomplete.
+   // CPU Cubemap Processor
    // ----------------------------------------------
 
    CPUCubemapProcessor::CPUCubemapProcessor()
    {
       mStage            = 0;
+      mReadFrames       = 0;
       mSourceBuffer     = NULL;
-      mRadianceBuffer   = NULL;
-      mIrradianceBuffer = NULL;
+      mReadBackTexture  = BGFX_INVALID_HANDLE;
+      mBRDFBuffer       = NULL;
+      radianceMips      = 6;
+      sampleCount       = 64;
    }
 
    CPUCubemapProcessor::~CPUCubemapProcessor()
    {
-      if (mSourceBuffer != NULL)
-         SAFE_DELETE_ARRAY(mSourceBuffer);
+      // The filter job uses the buffers.
+      JobSystem::wait(mFilterJobs);
 
-      if (mRadianceBuffer != NULL)
-         SAFE_DELETE_ARRAY(mRadianceBuffer);
+      SAFE_DELETE_ARRAY(mSourceBuffer);
+      SAFE_DELETE_ARRAY(mBRDFBuffer);
 
-      if (mIrradianceBuffer != NULL)
-         SAFE_DELETE_ARRAY(mIrradianceBuffer);
+      if (bgfx::isValid(mReadBackTexture))
+         bgfx::destroyTexture(mReadBackTexture);
    }
 
    void CPUCubemapProcessor::init(bgfx::TextureHandle sourceCubemap, U32 sourceSize,
@@ -392,66 +314,118 @@ namespace Lighting
       bgfx::TextureHandle irradianceCubemap, U32 irradianceSize,
       bgfx::TextureHandle brdfTexture)
    {
+      JobSystem::wait(mFilterJobs);
       CubemapProcessor::init(sourceCubemap, sourceSize, radianceCubemap, radianceSize, irradianceCubemap, irradianceSize, brdfTexture);
 
-      if (mSourceBuffer != NULL)
-         SAFE_DELETE_ARRAY(mSourceBuffer);
+      SAFE_DELETE_ARRAY(mSourceBuffer);
+      SAFE_DELETE_ARRAY(mBRDFBuffer);
+
+      // Filtered black if the faces can't be read back.
+      mSourceBuffer = new U8[mSourceSize * mSourceSize * 6 * 4];
+      dMemset(mSourceBuffer, 0, mSourceSize * mSourceSize * 6 * 4);
+
+      const U64 readBackCaps = BGFX_CAPS_TEXTURE_BLIT | BGFX_CAPS_TEXTURE_READ_BACK;
+      if ((bgfx::getCaps()->supported & readBackCaps) == readBackCaps)
+      {
+         if (bgfx::isValid(mReadBackTexture))
+            bgfx::destroyTexture(mReadBackTexture);
+
+         // The faces one under the other, the same layout as mSourceBuffer.
+         mReadBackTexture = bgfx::createTexture2D(mSourceSize, mSourceSize * 6, 1, bgfx::TextureFormat::BGRA8,
+            BGFX_TEXTURE_BLIT_DST | BGFX_TEXTURE_READ_BACK);
 
-      mSourceBuffer     = new U32[mSourceSize * mSourceSize];
-      mRadianceBuffer   = new U32[mRadianceSize * mRadianceSize];
-      mIrradianceBuffer = new U32[mIrradianceSize * mIrradianceSize];
+         Graphics::ViewTableEntry* readBackView = Graphics::getTemporaryView(StringTable->insert("CubemapReadBack"), 50);
+         for (U16 side = 0; side < 6; ++side)
+            bgfx::blit(readBackView->id, mReadBackTexture, 0, 0, side * mSourceSize, 0, mSourceCubemap, 0, 0, 0, side, mSourceSize, mSourceSize, 1);
+         bgfx::readTexture(mReadBackTexture, mSourceBuffer);
+      }
+      else
+         Con::warnf("CPUCubemapProcessor - texture blit or read back isn't supported, the source can't be filtered.");
 
-      //bgfx::readTexture(mSourceCubemap, 5, mSourceBuffer);
+      mReadFrames = 0;
       mStage = 1;
    }
 
+   void CPUCubemapProcessor::filterJob(void* data, U32 first, U32 count)
+   {
+      CPUCubemapProcessor* processor = (CPUCubemapProcessor*)data;
+
+      // Each step splits its work across the job system again.
+      processor->mSource.buildMips();
+      prefilterRadiance(processor->mSource, processor->mRadiance, processor->sampleCount);
+      projectIrradianceSH(processor->mSource, processor->mIrradianceSH);
+      renderIrradiance(processor->mIrradianceSH, processor->mIrradiance);
+      integrateBRDF(processor->mRadianceSize, processor->sampleCount, processor->mBRDFBuffer);
+   }
+
    void CPUCubemapProcessor::process()
    {
       if (mStage == 1)
       {
+         // Read backs arrive two frames after they're requested.
+         if (++mReadFrames < 2)
+            return;
+
+         if (bgfx::isValid(mReadBackTexture))
+         {
+            bgfx::destroyTexture(mReadBackTexture);
+            mReadBackTexture = BGFX_INVALID_HANDLE;
+         }
+
+         mSource.init(mSourceSize);
+         mSource.setFromBGRA8(mSourceBuffer);
+         mRadiance.init(mRadianceSize, radianceMips);
+         mIrradiance.init(mIrradianceSize, 1);
+         mBRDFBuffer = new F32[mRadianceSize * mRadianceSize * 2];
+
+         JobSystem::submit(&filterJob, this, &mFilterJobs);
          mStage = 2;
          return;
       }
 
-      if (mStage == 2)
+      if (mStage == 2 && mFilterJobs.isDone())
+      {
+         upload();
+         mStage = 3;
+      }
+   }
+
+   void CPUCubemapProcessor::upload()
+   {
+      Vector<U16> halfs;
+      for (U32 mip = 0; mip < mRadiance.getMipCount(); ++mip)
       {
-         // Texture has been read back by now.
-         for (U32 y = 0; y < mIrradianceSize; ++y)
+         U32 size = mRadiance.getSize(mip);
+         U32 faceSize = size * size * 4 * sizeof(U16);
+         halfs.setSize(size * size * 6 * 4);
+         mRadiance.writeRGBA16F(mip, halfs.address());
+
+         for (U32 side = 0; side < 6; ++side)
          {
-            for (U32 x = 0; x < mIrradianceSize; ++x)
-            {
-               Point3F sum = Point3F::Zero;
-               Point3F N = texelCoordToVec(Point2F(x / mIrradianceSize, y / mIrradianceSize), 5);
-
-               for (U32 n = 0; n < 512; n++)
-               {
-                  Point2F pt = Hammersley(n, 512);
-                  Point3F H = ImportanceSampleGGX(pt, 1.0f, N);
-                  Point3F V = N;
-                  Point3F L = 2.0f * mDot(V, H) * H - V;
-
-                  F32 ndotl = getMax(0.0f, mDot(N, L));
-
-                  // Sample
-                  U32 rawColor      = mSourceBuffer[(y * mIrradianceSize) + x];
-                  Point3F sample    = Point3F((F32)BGFXCOLOR_GET_R(rawColor) / 255.0f, (F32)BGFXCOLOR_GET_R(rawColor) / 255.0f, (F32)BGFXCOLOR_GET_R(rawColor) / 255.0f);
-                  sample            *= ndotl;
-                  sum               += sample;
-               }
-
-               sum /= 512.0f;
-               mIrradianceBuffer[(y * mIrradianceSize) + x] = BGFXCOLOR_RGBA((U8)(sum.x * 255.0f), (U8)(sum.y * 255.0f), (U8)(sum.z * 255.0f), 255);
-            }
+            const bgfx::Memory* mem = bgfx::copy((U8*)halfs.address() + side * faceSize, faceSize);
+            bgfx::updateTextureCube(mRadianceCubemap, side, mip, 0, 0, size, size, mem);
          }
+      }
 
-         const bgfx::Memory* mem = bgfx::makeRef(mIrradianceBuffer, sizeof(U32) * mIrradianceSize * mIrradianceSize);
-         bgfx::updateTextureCube(mIrradianceCubemap, 0, 0, 0, 0, mIrradianceSize, mIrradianceSize, mem);
-         mStage = 3;
+      Vector<U8> bytes;
+      U32 faceSize = mIrradianceSize * mIrradianceSize * 4;
+      bytes.setSize(faceSize * 6);
+      mIrradiance.writeBGRA8(0, bytes.address());
+      for (U32 side = 0; side < 6; ++side)
+      {
+         const bgfx::Memory* mem = bgfx::copy(bytes.address() + side * faceSize, faceSize);
+         bgfx::updateTextureCube(mIrradianceCubemap, side, 0, 0, 0, mIrradianceSize, mIrradianceSize, mem);
       }
+
+      const bgfx::Memory* mem = bgfx::alloc(mRadianceSize * mRadianceSize * 2 * sizeof(U16));
+      U16* brdf = (U16*)mem->data;
+      for (U32 i = 0; i < mRadianceSize * mRadianceSize * 2; ++i)
+         brdf[i] = bx::halfFromFloat(mBRDFBuffer[i]);
+      bgfx::updateTexture2D(mBRDFTexture, 0, 0, 0, mRadianceSize, mRadianceSize, mem);
    }
 
    bool CPUCubemapProcessor::isFinished()
    {
-      return false;
+      return (mStage > 2);
    }
 }
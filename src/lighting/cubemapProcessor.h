@@ -44,6 +44,14 @@
 #include "rendering/renderCamera.h"
 #endif
 
+#ifndef _JOB_SYSTEM_H_
+#include "platform/threads/jobSystem.h"
+#endif
+
+#ifndef _CUBEMAP_FILTER_H_
+#include "lighting/cubemapFilter.h"
+#endif
+
 namespace Lighting
 {
    class CubemapProcessor
@@ -112,18 +120,36 @@ namespace Lighting
          virtual bool isFinished();
    };
 
+   // Reads the source back and filters it on the job system, the main
+   // thread only converts and uploads. The source has to be BGRA8. Its faces
+   // are blitted one under the other into a read back texture, bgfx can't
+   // read a cubemap back directly.
    class CPUCubemapProcessor : public CubemapProcessor
    {
       protected:
-         U32* mSourceBuffer;
-         U32* mRadianceBuffer;
-         U32* mIrradianceBuffer;
-         U32  mStage;
+         U8*                  mSourceBuffer;
+         bgfx::TextureHandle  mReadBackTexture;
+         CubemapImage   mSource;
+         CubemapImage   mRadiance;
+         CubemapImage   mIrradiance;
+         IrradianceSH   mIrradianceSH;
+         F32*           mBRDFBuffer;
+         U32            mStage;
+         U32            mReadFrames;
+         JobCounter     mFilterJobs;
+
+         static void filterJob(void* data, U32 first, U32 count);
+         void upload();
 
       public:
+         U32            radianceMips;
+         U32            sampleCount;
+
          CPUCubemapProcessor();
          ~CPUCubemapProcessor();
 
+         const IrradianceSH& getIrradianceSH() const { return mIrradianceSH; }
+
          virtual void init(bgfx::TextureHandle sourceCubemap, U32 sourceSize,
             bgfx::TextureHandle radianceCubemap, U32 radianceSize,
             bgfx::TextureHandle irradianceCubemap, U32 irradianceSize,
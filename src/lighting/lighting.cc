@@ -89,6 +89,7 @@ namespace Lighting
 
       // Reset Values
       light->flags = 0;
+      light->generation++;
       light->color[0] = 0.0f;
       light->color[1] = 0.0f;
       light->color[2] = 0.0f;
@@ -99,6 +100,16 @@ namespace Lighting
       return light;
    }
 
+   LightData* getLightDataList()
+   {
+      return &lightList[0];
+   }
+
+   U32 getLightDataCount()
+   {
+      return lightCount;
+   }
+
    Vector<LightData*> getLightList()
    {
       Vector<LightData*> results;
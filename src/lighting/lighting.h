@@ -59,6 +59,10 @@ namespace Lighting
       };
 
       U32      flags;
+
+      // Bumped whenever the slot is handed out by createLightData().
+      U32      generation;
+
       Point3F  position;
       F32      color[3];
       F32      attenuation;
@@ -66,6 +70,8 @@ namespace Lighting
    };
 
    LightData* createLightData();
+   LightData* getLightDataList();
+   U32 getLightDataCount();
    Vector<LightData*> getLightList();
    Vector<LightData*> getNearestLights(Point3F position);
 
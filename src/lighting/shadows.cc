@@ -29,6 +29,7 @@
 #include "rendering/rendering.h"
 #include "rendering/renderCamera.h"
 #include "scene/components/cameraComponent.h"
+#include "debug/profiler.h"
 
 #include <bx/fpumath.h>
 
@@ -358,6 +359,7 @@ namespace Lighting
                bgfx::submit(mCascadeViews[i]->id, mPCFSkinnedShader->mProgram);
             else
                bgfx::submit(mCascadeViews[i]->id, mPCFShader->mProgram);
+            PROFILE_COUNT(DrawCalls, 1);
          }
       }
 
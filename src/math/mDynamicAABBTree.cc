@@ -0,0 +1,439 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2013 GarageGames, LLC
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//-----------------------------------------------------------------------------
+
+#include "math/mDynamicAABBTree.h"
+#include "platform/platform.h"
+
+//-----------------------------------------------------------------------------
+
+DynamicAABBTree::DynamicAABBTree( F32 margin )
+{
+   mRoot = NullNode;
+   mNodeCount = 0;
+   mNodeCapacity = 0;
+   mNodes = NULL;
+   mFreeList = NullNode;
+   mProxyCount = 0;
+   mMargin = margin;
+}
+
+//-----------------------------------------------------------------------------
+
+DynamicAABBTree::~DynamicAABBTree()
+{
+   dFree( mNodes );
+}
+
+//-----------------------------------------------------------------------------
+
+void DynamicAABBTree::clear()
+{
+   dFree( mNodes );
+   mNodes = NULL;
+   mRoot = NullNode;
+   mNodeCount = 0;
+   mNodeCapacity = 0;
+   mFreeList = NullNode;
+   mProxyCount = 0;
+}
+
+//-----------------------------------------------------------------------------
+
+F32 DynamicAABBTree::_surfaceArea( const Box3F& box )
+{
+   const Point3F extents = box.getExtents();
+   return 2.0f * ( extents.x * extents.y + extents.y * extents.z + extents.z * extents.x );
+}
+
+//-----------------------------------------------------------------------------
+
+Box3F DynamicAABBTree::_combine( const Box3F& a, const Box3F& b )
+{
+   // Box3F::intersect() grows the box to contain the other one.
+   Box3F result = a;
+   result.intersect( b );
+   return result;
+}
+
+//-----------------------------------------------------------------------------
+
+S32 DynamicAABBTree::_allocateNode()
+{
+   // Grow the node pool if the free list is empty.
+   if ( mFreeList == NullNode )
+   {
+      AssertFatal( mNodeCount == mNodeCapacity, "DynamicAABBTree::_allocateNode - Free list out of sync." );
+
+      const S32 oldCapacity = mNodeCapacity;
+      mNodeCapacity = oldCapacity == 0 ? 16 : oldCapacity * 2;
+      mNodes = (Node*)dRealloc( mNodes, mNodeCapacity * sizeof(Node) );
+
+      // Build a linked list for the free list.
+      for ( S32 i = oldCapacity; i < mNodeCapacity - 1; ++i )
+      {
+         mNodes[i].parent = i + 1;
+         mNodes[i].height = -1;
+      }
+      mNodes[mNodeCapacity - 1].parent = NullNode;
+      mNodes[mNodeCapacity - 1].height = -1;
+      mFreeList = oldCapacity;
+   }
+
+   const S32 nodeId = mFreeList;
+   mFreeList = mNodes[nodeId].parent;
+
+   Node& node = mNodes[nodeId];
+   node.parent = NullNode;
+   node.child1 = NullNode;
+   node.child2 = NullNode;
+   node.height = 0;
+   node.userData = NULL;
+   ++mNodeCount;
+
+   return nodeId;
+}
+
+//-----------------------------------------------------------------------------
+
+void DynamicAABBTree::_freeNode( S32 nodeId )
+{
+   AssertFatal( nodeId >= 0 && nodeId < mNodeCapacity, "DynamicAABBTree::_freeNode - Invalid node id." );
+   AssertFatal( mNodeCount > 0, "DynamicAABBTree::_freeNode - No nodes allocated." );
+
+   mNodes[nodeId].parent = mFreeList;
+   mNodes[nodeId].height = -1;
+   mFreeList = nodeId;
+   --mNodeCount;
+}
+
+//-----------------------------------------------------------------------------
+
+S32 DynamicAABBTree::createProxy( const Box3F& box, void* userData )
+{
+   const S32 proxyId = _allocateNode();
+
+   const Point3F margin( mMargin, mMargin, mMargin );
+   mNodes[proxyId].box.set( box.minExtents - margin, box.maxExtents + margin );
+   mNodes[proxyId].userData = userData;
+   mNodes[proxyId].height = 0;
+
+   _insertLeaf( proxyId );
+   ++mProxyCount;
+
+   return proxyId;
+}
+
+//-----------------------------------------------------------------------------
+
+void DynamicAABBTree::destroyProxy( S32 proxyId )
+{
+   AssertFatal( proxyId >= 0 && proxyId < mNodeCapacity, "DynamicAABBTree::destroyProxy - Invalid proxy id." );
+   AssertFatal( mNodes[proxyId].isLeaf(), "DynamicAABBTree::destroyProxy - Not a proxy." );
+
+   _removeLeaf( proxyId );
+   _freeNode( proxyId );
+   --mProxyCount;
+}
+
+//-----------------------------------------------------------------------------
+
+bool DynamicAABBTree::moveProxy( S32 proxyId, const Box3F& box )
+{
+   AssertFatal( proxyId >= 0 && proxyId < mNodeCapacity, "DynamicAABBTree::moveProxy - Invalid proxy id." );
+   AssertFatal( mNodes[proxyId].isLeaf(), "DynamicAABBTree::moveProxy - Not a proxy." );
+
+   if ( mNodes[proxyId].box.isContained( box ) )
+   {
+      // Don't let the enlarged box linger if the object shrank a lot.
+      const Box3F& fatBox = mNodes[proxyId].box;
+      const Point3F slack = ( fatBox.getExtents() - box.getExtents() );
+      const F32 maxSlack = mMargin * 4.0f + 0.5f * box.len_max();
+      if ( slack.x <= maxSlack && slack.y <= maxSlack && slack.z <= maxSlack )
+         return false;
+   }
+
+   _removeLeaf( proxyId );
+
+   const Point3F margin( mMargin, mMargin, mMargin );
+   mNodes[proxyId].box.set( box.minExtents - margin, box.maxExtents + margin );
+
+   _insertLeaf( proxyId );
+   return true;
+}
+
+//-----------------------------------------------------------------------------
+
+void DynamicAABBTree::_insertLeaf( S32 leaf )
+{
+   if ( mRoot == NullNode )
+   {
+      mRoot = leaf;
+      mNodes[mRoot].parent = NullNode;
+      return;
+   }
+
+   // Find the best sibling for this node using the surface area heuristic.
+   const Box3F leafBox = mNodes[leaf].box;
+   S32 index = mRoot;
+   while ( !mNodes[index].isLeaf() )
+   {
+      const S32 child1 = mNodes[index].child1;
+      const S32 child2 = mNodes[index].child2;
+
+      const F32 area = _surfaceArea( mNodes[index].box );
+      const F32 combinedArea = _surfaceArea( _combine( mNodes[index].box, leafBox ) );
+
+      // Cost of creating a new parent for this node and the new leaf.
+      const F32 cost = 2.0f * combinedArea;
+
+      // Minimum cost of pushing the leaf further down the tree.
+      const F32 inheritanceCost = 2.0f * ( combinedArea - area );
+
+      F32 cost1 = _surfaceArea( _combine( leafBox, mNodes[child1].box ) ) + inheritanceCost;
+      if ( !mNodes[child1].isLeaf() )
+         cost1 -= _surfaceArea( mNodes[child1].box );
+
+      F32 cost2 = _surfaceArea( _combine( leafBox, mNodes[child2].box ) ) + inheritanceCost;
+      if ( !mNodes[child2].isLeaf() )
+         cost2 -= _surfaceArea( mNodes[child2].box );
+
+      if ( cost < cost1 && cost < cost2 )
+         break;
+
+      index = cost1 < cost2 ? child1 : child2;
+   }
+
+   const S32 sibling = index;
+
+   // Create a new parent.
+   const S32 oldParent = mNodes[sibling].parent;
+   const S32 newParent = _allocateNode();
+   mNodes[newParent].parent = oldParent;
+   mNodes[newParent].userData = NULL;
+   mNodes[newParent].box = _combine( leafBox, mNodes[sibling].box );
+   mNodes[newParent].height = mNodes[sibling].height + 1;
+   mNodes[newParent].child1 = sibling;
+   mNodes[newParent].child2 = leaf;
+   mNodes[sibling].parent = newParent;
+   mNodes[leaf].parent = newParent;
+
+   if ( oldParent != NullNode )
+   {
+      if ( mNodes[oldParent].child1 == sibling )
+         mNodes[oldParent].child1 = newParent;
+      else
+         mNodes[oldParent].child2 = newParent;
+   }
+   else
+   {
+      mRoot = newParent;
+   }
+
+   // Walk back up the tree fixing heights and boxes.
+   index = mNodes[leaf].parent;
+   while ( index != NullNode )
+   {
+      index = _balance( index );
+
+      const S32 child1 = mNodes[index].child1;
+      const S32 child2 = mNodes[index].child2;
+
+      mNodes[index].height = 1 + getMax( mNodes[child1].height, mNodes[child2].height );
+      mNodes[index].box = _combine( mNodes[child1].box, mNodes[child2].box );
+
+      index = mNodes[index].parent;
+   }
+}
+
+//-----------------------------------------------------------------------------
+
+void DynamicAABBTree::_removeLeaf( S32 leaf )
+{
+   if ( leaf == mRoot )
+   {
+      mRoot = NullNode;
+      return;
+   }
+
+   const S32 parent = mNodes[leaf].parent;
+   const S32 grandParent = mNodes[parent].parent;
+   const S32 sibling = mNodes[parent].child1 == leaf ? mNodes[parent].child2 : mNodes[parent].child1;
+
+   if ( grandParent != NullNode )
+   {
+      // Destroy parent and connect sibling to grandParent.
+      if ( mNodes[grandParent].child1 == parent )
+         mNodes[grandParent].child1 = sibling;
+      else
+         mNodes[grandParent].child2 = sibling;
+
+      mNodes[sibling].parent = grandParent;
+      _freeNode( parent );
+
+      // Adjust ancestor bounds.
+      S32 index = grandParent;
+      while ( index != NullNode )
+      {
+         index = _balance( index );
+
+         const S32 child1 = mNodes[index].child1;
+         const S32 child2 = mNodes[index].child2;
+
+         mNodes[index].box = _combine( mNodes[child1].box, mNodes[child2].box );
+         mNodes[index].height = 1 + getMax( mNodes[child1].height, mNodes[child2].height );
+
+         index = mNodes[index].parent;
+      }
+   }
+   else
+   {
+      mRoot = sibling;
+      mNodes[sibling].parent = NullNode;
+      _freeNode( parent );
+   }
+}
+
+//-----------------------------------------------------------------------------
+
+S32 DynamicAABBTree::_balance( S32 iA )
+{
+   // Perform a left or right rotation if node A is imbalanced.
+   // Returns the new root index.
+   Node* A = mNodes + iA;
+   if ( A->isLeaf() || A->height < 2 )
+      return iA;
+
+   const S32 iB = A->child1;
+   const S32 iC = A->child2;
+   Node* B = mNodes + iB;
+   Node* C = mNodes + iC;
+
+   const S32 balance = C->height - B->height;
+
+   // Rotate C up
+   if ( balance > 1 )
+   {
+      const S32 iF = C->child1;
+      const S32 iG = C->child2;
+      Node* F = mNodes + iF;
+      Node* G = mNodes + iG;
+
+      // Swap A and C
+      C->child1 = iA;
+      C->parent = A->parent;
+      A->parent = iC;
+
+      // A's old parent should point to C
+      if ( C->parent != NullNode )
+      {
+         if ( mNodes[C->parent].child1 == iA )
+            mNodes[C->parent].child1 = iC;
+         else
+            mNodes[C->parent].child2 = iC;
+      }
+      else
+      {
+         mRoot = iC;
+      }
+
+      // Rotate
+      if ( F->height > G->height )
+      {
+         C->child2 = iF;
+         A->child2 = iG;
+         G->parent = iA;
+         A->box = _combine( B->box, G->box );
+         C->box = _combine( A->box, F->box );
+
+         A->height = 1 + getMax( B->height, G->height );
+         C->height = 1 + getMax( A->height, F->height );
+      }
+      else
+      {
+         C->child2 = iG;
+         A->child2 = iF;
+         F->parent = iA;
+         A->box = _combine( B->box, F->box );
+         C->box = _combine( A->box, G->box );
+
+         A->height = 1 + getMax( B->height, F->height );
+         C->height = 1 + getMax( A->height, G->height );
+      }
+
+      return iC;
+   }
+
+   // Rotate B up
+   if ( balance < -1 )
+   {
+      const S32 iD = B->child1;
+      const S32 iE = B->child2;
+      Node* D = mNodes + iD;
+      Node* E = mNodes + iE;
+
+      // Swap A and B
+      B->child1 = iA;
+      B->parent = A->parent;
+      A->parent = iB;
+
+      // A's old parent should point to B
+      if ( B->parent != NullNode )
+      {
+         if ( mNodes[B->parent].child1 == iA )
+            mNodes[B->parent].child1 = iB;
+         else
+            mNodes[B->parent].child2 = iB;
+      }
+      else
+      {
+         mRoot = iB;
+      }
+
+      // Rotate
+      if ( D->height > E->height )
+      {
+         B->child2 = iD;
+         A->child1 = iE;
+         E->parent = iA;
+         A->box = _combine( C->box, E->box );
+         B->box = _combine( A->box, D->box );
+
+         A->height = 1 + getMax( C->height, E->height );
+         B->height = 1 + getMax( A->height, D->height );
+      }
+      else
+      {
+         B->child2 = iE;
+         A->child1 = iD;
+         D->parent = iA;
+         A->box = _combine( C->box, D->box );
+         B->box = _combine( A->box, E->box );
+
+         A->height = 1 + getMax( C->height, D->height );
+         B->height = 1 + getMax( A->height, E->height );
+      }
+
+      return iB;
+   }
+
+   return iA;
+}
@@ -0,0 +1,266 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2013 GarageGames, LLC
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//-----------------------------------------------------------------------------
+
+#ifndef _MDYNAMICAABBTREE_H_
+#define _MDYNAMICAABBTREE_H_
+
+#ifndef _MBOX_H_
+#include "math/mBox.h"
+#endif
+
+#ifndef _PLATFORMASSERT_H_
+#include "platform/platformAssert.h"
+#endif
+
+
+/// Dynamic bounding volume tree of axis aligned boxes.
+///
+/// Each proxy stores a box enlarged by a margin so that small movements don't
+/// require the tree to be updated.  Leaves are inserted using a surface area
+/// heuristic and the tree is kept balanced with AVL style rotations, so
+/// inserts, removals and moves are O(log n).
+///
+/// Queries take a callback object rather than returning a result list so the
+/// caller decides what to collect and when to stop.
+class DynamicAABBTree
+{
+   public:
+
+      enum
+      {
+         NullNode = -1,
+         MaxQueryStack = 256
+      };
+
+   protected:
+
+      struct Node
+      {
+         /// Enlarged box.
+         Box3F box;
+
+         void* userData;
+
+         /// Parent when in the tree, next free node when in the free list.
+         S32 parent;
+
+         S32 child1;
+         S32 child2;
+
+         /// Leaf = 0, free node = -1.
+         S32 height;
+
+         bool isLeaf() const { return child1 == NullNode; }
+      };
+
+      Node* mNodes;
+      S32   mRoot;
+      S32   mNodeCount;
+      S32   mNodeCapacity;
+      S32   mFreeList;
+      U32   mProxyCount;
+      F32   mMargin;
+
+      S32 _allocateNode();
+      void _freeNode( S32 nodeId );
+      void _insertLeaf( S32 leaf );
+      void _removeLeaf( S32 leaf );
+      S32 _balance( S32 nodeId );
+
+      static F32 _surfaceArea( const Box3F& box );
+      static Box3F _combine( const Box3F& a, const Box3F& b );
+
+   public:
+
+      DynamicAABBTree( F32 margin = 0.1f );
+      ~DynamicAABBTree();
+
+      /// Insert a box, returns the proxy id.
+      S32 createProxy( const Box3F& box, void* userData );
+
+      /// Remove a proxy created with createProxy().
+      void destroyProxy( S32 proxyId );
+
+      /// Update the box of a proxy.  Returns true if the proxy had to be
+      /// reinserted, false if the new box was still inside the enlarged one.
+      bool moveProxy( S32 proxyId, const Box3F& box );
+
+      /// Remove all proxies.
+      void clear();
+
+      void* getUserData( S32 proxyId ) const
+      {
+         AssertFatal( proxyId >= 0 && proxyId < mNodeCapacity, "DynamicAABBTree::getUserData - Invalid proxy id." );
+         return mNodes[proxyId].userData;
+      }
+
+      const Box3F& getFatBox( S32 proxyId ) const
+      {
+         AssertFatal( proxyId >= 0 && proxyId < mNodeCapacity, "DynamicAABBTree::getFatBox - Invalid proxy id." );
+         return mNodes[proxyId].box;
+      }
+
+      U32 getProxyCount() const { return mProxyCount; }
+      S32 getHeight() const { return mRoot == NullNode ? 0 : mNodes[mRoot].height; }
+      bool isEmpty() const { return mRoot == NullNode; }
+
+      /// Bounds of every proxy in the tree (including margins).
+      Box3F getRootBox() const { return mRoot == NullNode ? Box3F::Zero : mNodes[mRoot].box; }
+
+      /// Visit every proxy whose enlarged box overlaps @a box.
+      ///
+      /// The callback must implement <tt>bool queryCallback( S32 proxyId )</tt>
+      /// returning false to stop the query.
+      template< typename T > void query( const Box3F& box, T* callback ) const;
+
+      /// Visit every proxy whose enlarged box passes a custom node test.
+      ///
+      /// The callback must implement <tt>bool testNode( const Box3F& box )</tt>
+      /// and <tt>bool queryCallback( S32 proxyId )</tt>.  This is used to walk
+      /// the tree with planes, spheres or frustums.
+      template< typename T > void queryCustom( T* callback ) const;
+
+      /// Visit every proxy whose enlarged box is hit by the segment start -> end
+      /// in order of the tree, clipping the segment as the callback reports hits.
+      ///
+      /// The callback must implement <tt>F32 raycastCallback( S32 proxyId, F32 maxFraction )</tt>
+      /// returning the new maximum fraction: 0 terminates the raycast, maxFraction
+      /// leaves it unchanged and any value in between clips it.
+      template< typename T > void raycast( const Point3F& start, const Point3F& end, T* callback ) const;
+};
+
+//-----------------------------------------------------------------------------
+
+template< typename T >
+inline void DynamicAABBTree::query( const Box3F& box, T* callback ) const
+{
+   if ( mRoot == NullNode )
+      return;
+
+   S32 stack[MaxQueryStack];
+   S32 stackSize = 0;
+   stack[stackSize++] = mRoot;
+
+   while ( stackSize > 0 )
+   {
+      const Node& node = mNodes[stack[--stackSize]];
+      if ( !node.box.isOverlapped( box ) )
+         continue;
+
+      if ( node.isLeaf() )
+      {
+         if ( !callback->queryCallback( (S32)( &node - mNodes ) ) )
+            return;
+         continue;
+      }
+
+      AssertFatal( stackSize + 2 <= MaxQueryStack, "DynamicAABBTree::query - Stack overflow." );
+      stack[stackSize++] = node.child1;
+      stack[stackSize++] = node.child2;
+   }
+}
+
+//-----------------------------------------------------------------------------
+
+template< typename T >
+inline void DynamicAABBTree::queryCustom( T* callback ) const
+{
+   if ( mRoot == NullNode )
+      return;
+
+   S32 stack[MaxQueryStack];
+   S32 stackSize = 0;
+   stack[stackSize++] = mRoot;
+
+   while ( stackSize > 0 )
+   {
+      const Node& node = mNodes[stack[--stackSize]];
+      if ( !callback->testNode( node.box ) )
+         continue;
+
+      if ( node.isLeaf() )
+      {
+         if ( !callback->queryCallback( (S32)( &node - mNodes ) ) )
+            return;
+         continue;
+      }
+
+      AssertFatal( stackSize + 2 <= MaxQueryStack, "DynamicAABBTree::queryCustom - Stack overflow." );
+      stack[stackSize++] = node.child1;
+      stack[stackSize++] = node.child2;
+   }
+}
+
+//-----------------------------------------------------------------------------
+
+template< typename T >
+inline void DynamicAABBTree::raycast( const Point3F& start, const Point3F& end, T* callback ) const
+{
+   if ( mRoot == NullNode )
+      return;
+
+   const Point3F dir = end - start;
+   F32 invDir[3];
+   for ( U32 i = 0; i < 3; ++i )
+      invDir[i] = mFabs( dir[i] ) < 1e-30f ? ( dir[i] < 0.0f ? -1e30f : 1e30f ) : 1.0f / dir[i];
+
+   F32 maxFraction = 1.0f;
+
+   S32 stack[MaxQueryStack];
+   S32 stackSize = 0;
+   stack[stackSize++] = mRoot;
+
+   while ( stackSize > 0 )
+   {
+      const Node& node = mNodes[stack[--stackSize]];
+
+      // Slab test against the enlarged box.
+      F32 tNear = 0.0f;
+      F32 tFar = maxFraction;
+      for ( U32 i = 0; i < 3; ++i )
+      {
+         F32 t1 = ( node.box.minExtents[i] - start[i] ) * invDir[i];
+         F32 t2 = ( node.box.maxExtents[i] - start[i] ) * invDir[i];
+         tNear = getMax( tNear, getMin( t1, t2 ) );
+         tFar = getMin( tFar, getMax( t1, t2 ) );
+      }
+
+      if ( tNear > tFar )
+         continue;
+
+      if ( node.isLeaf() )
+      {
+         F32 value = callback->raycastCallback( (S32)( &node - mNodes ), maxFraction );
+         if ( value <= 0.0f )
+            return;
+
+         maxFraction = getMin( maxFraction, value );
+         continue;
+      }
+
+      AssertFatal( stackSize + 2 <= MaxQueryStack, "DynamicAABBTree::raycast - Stack overflow." );
+      stack[stackSize++] = node.child1;
+      stack[stackSize++] = node.child2;
+   }
+}
+
+#endif // _MDYNAMICAABBTREE_H_
@@ -95,6 +95,28 @@ extern void (*m_matF_x_point4F)(const F32 *m, const F32 *p, F32 *presult);
 extern void (*m_matF_x_scale_x_planeF)(const F32 *m, const F32* s, const F32 *p, F32 *presult);
 extern void (*m_matF_x_box3F)(const F32 *m, F32 *min, F32 *max);
 
+// Batch versions. Points are packed Point3F, boxes packed Box3F (min, max),
+// spheres packed SphereF (center, radius) and planes (x, y, z, d). Results
+// may alias the inputs.
+extern void (*m_matF_x_point3F_batch)(const F32 *m, const F32 *points, U32 count, F32 *presult);
+extern void (*m_matF_x_matF_batch)(const F32 *a, const F32 *b, U32 count, F32 *mresult);   // mresult[i] = a * b[i]
+extern void (*m_matF_x_box3F_batch)(const F32 *m, const F32 *boxes, U32 count, F32 *bresult);
+// Sets outside[i] when sphere i is entirely behind any of the planes and
+// returns how many were.
+extern U32  (*m_sphereF_x_planes_batch)(const F32 *planes, U32 planeCount, const F32 *spheres, U32 count, U8 *outside);
+
+// SIMD versions of the table above for x86, picked from cpuid. See mMathSIMD.cc.
+enum MathSIMDLevel
+{
+   MathSIMD_None,
+   MathSIMD_SSE41,
+   MathSIMD_AVX2,
+};
+
+extern U32         mGetSIMDSupport();
+extern const char* mGetSIMDName(U32 level);
+extern void        mInstallLibrary_SIMD(U32 level);
+
 // Note that x must point to at least 4 values for quartics, and 3 for cubics
 extern U32 (*mSolveQuadratic)(F32 a, F32 b, F32 c, F32* x);
 extern U32 (*mSolveCubic)(F32 a, F32 b, F32 c, F32 d, F32* x);
@@ -0,0 +1,484 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2013 GarageGames, LLC
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//-----------------------------------------------------------------------------
+
+#include "math/mMathFn.h"
+
+//-----------------------------------------------------------------------------
+// SSE4.1 and AVX2 versions of the installable math library.
+//
+// Every kernel is compiled for its own instruction set through a target
+// attribute (GCC/Clang) or simply by using the intrinsics (MSVC), so the
+// rest of the engine keeps its baseline flags. mInstallLibrary_SIMD() only
+// installs what cpuid says the machine and OS support.
+//-----------------------------------------------------------------------------
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+#define TORQUE_MATH_SIMD
+#endif
+
+#ifdef TORQUE_MATH_SIMD
+
+#include <immintrin.h>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#define SIMD_TARGET_SSE41
+#define SIMD_TARGET_AVX2
+#else
+#include <cpuid.h>
+#define SIMD_TARGET_SSE41 __attribute__((target("sse4.1")))
+#define SIMD_TARGET_AVX2  __attribute__((target("avx2,fma")))
+#endif
+
+extern U32 m_sphereF_x_planes_batch_C(const F32 *planes, U32 planeCount, const F32 *spheres, U32 count, U8 *outside);
+
+//-----------------------------------------------------------------------------
+// CPU Detection
+//-----------------------------------------------------------------------------
+
+static void cpuid(S32 leaf, S32 subLeaf, U32 regs[4])
+{
+#if defined(_MSC_VER)
+   __cpuidex((int*)regs, leaf, subLeaf);
+#else
+   __cpuid_count(leaf, subLeaf, regs[0], regs[1], regs[2], regs[3]);
+#endif
+}
+
+static U64 readXCR0()
+{
+#if defined(_MSC_VER)
+   return _xgetbv(0);
+#else
+   U32 lo, hi;
+   __asm__ __volatile__("xgetbv" : "=a"(lo), "=d"(hi) : "c"(0));
+   return ((U64)hi << 32) | lo;
+#endif
+}
+
+U32 mGetSIMDSupport()
+{
+   U32 regs[4];
+   cpuid(0, 0, regs);
+   const U32 maxLeaf = regs[0];
+   if (maxLeaf < 1)
+      return MathSIMD_None;
+
+   cpuid(1, 0, regs);
+   const bool sse41   = (regs[2] & (1 << 19)) != 0;
+   const bool fma     = (regs[2] & (1 << 12)) != 0;
+   const bool osxsave = (regs[2] & (1 << 27)) != 0;
+   const bool avx     = (regs[2] & (1 << 28)) != 0;
+
+   if (!sse41)
+      return MathSIMD_None;
+
+   // AVX needs the OS to save the YMM registers as well.
+   if (!avx || !fma || !osxsave || (readXCR0() & 0x6) != 0x6 || maxLeaf < 7)
+      return MathSIMD_SSE41;
+
+   cpuid(7, 0, regs);
+   const bool avx2 = (regs[1] & (1 << 5)) != 0;
+
+   return avx2 ? MathSIMD_AVX2 : MathSIMD_SSE41;
+}
+
+//-----------------------------------------------------------------------------
+// SSE4.1
+//-----------------------------------------------------------------------------
+
+static inline SIMD_TARGET_SSE41 void store3(F32* out, __m128 v)
+{
+   _mm_storel_pi((__m64*)out, v);
+   _mm_store_ss(out + 2, _mm_movehl_ps(v, v));
+}
+
+static SIMD_TARGET_SSE41 void m_matF_x_matF_SSE41(const F32 *a, const F32 *b, F32 *mresult)
+{
+   // b is loaded up front and each row of a is read before its result row is
+   // written, so mresult may alias either input.
+   const __m128 b0 = _mm_loadu_ps(b);
+   const __m128 b1 = _mm_loadu_ps(b + 4);
+   const __m128 b2 = _mm_loadu_ps(b + 8);
+   const __m128 b3 = _mm_loadu_ps(b + 12);
+
+   for (U32 i = 0; i < 16; i += 4)
+   {
+      __m128 row = _mm_mul_ps(_mm_set1_ps(a[i]), b0);
+      row = _mm_add_ps(row, _mm_mul_ps(_mm_set1_ps(a[i + 1]), b1));
+      row = _mm_add_ps(row, _mm_mul_ps(_mm_set1_ps(a[i + 2]), b2));
+      row = _mm_add_ps(row, _mm_mul_ps(_mm_set1_ps(a[i + 3]), b3));
+      _mm_storeu_ps(mresult + i, row);
+   }
+}
+
+static SIMD_TARGET_SSE41 void m_matF_x_point4F_SSE41(const F32 *m, const F32 *p, F32 *presult)
+{
+   const __m128 v = _mm_loadu_ps(p);
+
+   __m128 result = _mm_dp_ps(_mm_loadu_ps(m), v, 0xF1);
+   result = _mm_or_ps(result, _mm_dp_ps(_mm_loadu_ps(m + 4), v, 0xF2));
+   result = _mm_or_ps(result, _mm_dp_ps(_mm_loadu_ps(m + 8), v, 0xF4));
+   result = _mm_or_ps(result, _mm_dp_ps(_mm_loadu_ps(m + 12), v, 0xF8));
+
+   _mm_storeu_ps(presult, result);
+}
+
+static SIMD_TARGET_SSE41 void m_matF_transpose_SSE41(F32 *m)
+{
+   __m128 r0 = _mm_loadu_ps(m);
+   __m128 r1 = _mm_loadu_ps(m + 4);
+   __m128 r2 = _mm_loadu_ps(m + 8);
+   __m128 r3 = _mm_loadu_ps(m + 12);
+
+   _MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+
+   _mm_storeu_ps(m, r0);
+   _mm_storeu_ps(m + 4, r1);
+   _mm_storeu_ps(m + 8, r2);
+   _mm_storeu_ps(m + 12, r3);
+}
+
+// Columns of the upper 3x4 of m, used to transform points and boxes.
+struct AffineColumns
+{
+   __m128 c0, c1, c2, c3;
+};
+
+static inline SIMD_TARGET_SSE41 void loadColumns(const F32 *m, AffineColumns& cols)
+{
+   cols.c0 = _mm_setr_ps(m[0], m[4], m[8],  0.0f);
+   cols.c1 = _mm_setr_ps(m[1], m[5], m[9],  0.0f);
+   cols.c2 = _mm_setr_ps(m[2], m[6], m[10], 0.0f);
+   cols.c3 = _mm_setr_ps(m[3], m[7], m[11], 0.0f);
+}
+
+static inline SIMD_TARGET_SSE41 void transformBox(const AffineColumns& cols, const F32 *box, F32 *result)
+{
+   // Same min/max expansion as m_matF_x_box3F_C, three axes at once.
+   __m128 rMin = cols.c3;
+   __m128 rMax = cols.c3;
+
+   const __m128* col[3] = { &cols.c0, &cols.c1, &cols.c2 };
+   for (U32 j = 0; j < 3; j++)
+   {
+      const __m128 a = _mm_mul_ps(*col[j], _mm_set1_ps(box[j]));
+      const __m128 b = _mm_mul_ps(*col[j], _mm_set1_ps(box[j + 3]));
+      rMin = _mm_add_ps(rMin, _mm_min_ps(a, b));
+      rMax = _mm_add_ps(rMax, _mm_max_ps(a, b));
+   }
+
+   store3(result, rMin);
+   store3(result + 3, rMax);
+}
+
+static SIMD_TARGET_SSE41 void m_matF_x_box3F_SSE41(const F32 *m, F32 *min, F32 *max)
+{
+   AffineColumns cols;
+   loadColumns(m, cols);
+
+   F32 box[6] = { min[0], min[1], min[2], max[0], max[1], max[2] };
+   transformBox(cols, box, box);
+
+   min[0] = box[0]; min[1] = box[1]; min[2] = box[2];
+   max[0] = box[3]; max[1] = box[4]; max[2] = box[5];
+}
+
+static SIMD_TARGET_SSE41 void m_point3F_bulk_dot_SSE41(const F32* refVector,
+                                                       const F32* dotPoints,
+                                                       const U32  numPoints,
+                                                       const U32  pointStride,
+                                                       F32*       output)
+{
+   const __m128 rx = _mm_set1_ps(refVector[0]);
+   const __m128 ry = _mm_set1_ps(refVector[1]);
+   const __m128 rz = _mm_set1_ps(refVector[2]);
+
+   const U8* base = (const U8*)dotPoints;
+
+   U32 i = 0;
+   for (; i + 4 <= numPoints; i += 4)
+   {
+      const F32* p0 = (const F32*)(base + pointStride * (i + 0));
+      const F32* p1 = (const F32*)(base + pointStride * (i + 1));
+      const F32* p2 = (const F32*)(base + pointStride * (i + 2));
+      const F32* p3 = (const F32*)(base + pointStride * (i + 3));
+
+      const __m128 x = _mm_setr_ps(p0[0], p1[0], p2[0], p3[0]);
+      const __m128 y = _mm_setr_ps(p0[1], p1[1], p2[1], p3[1]);
+      const __m128 z = _mm_setr_ps(p0[2], p1[2], p2[2], p3[2]);
+
+      __m128 dot = _mm_add_ps(_mm_mul_ps(rx, x), _mm_mul_ps(ry, y));
+      dot = _mm_add_ps(dot, _mm_mul_ps(rz, z));
+      _mm_storeu_ps(output + i, dot);
+   }
+
+   for (; i < numPoints; i++)
+   {
+      const F32* p = (const F32*)(base + pointStride * i);
+      output[i] = (refVector[0] * p[0]) + (refVector[1] * p[1]) + (refVector[2] * p[2]);
+   }
+}
+
+static SIMD_TARGET_SSE41 void m_matF_x_point3F_batch_SSE41(const F32 *m, const F32 *points, U32 count, F32 *presult)
+{
+   AffineColumns cols;
+   loadColumns(m, cols);
+
+   for (U32 i = 0; i < count; i++, points += 3, presult += 3)
+   {
+      __m128 r = _mm_add_ps(_mm_mul_ps(cols.c0, _mm_set1_ps(points[0])), _mm_mul_ps(cols.c1, _mm_set1_ps(points[1])));
+      r = _mm_add_ps(r, _mm_mul_ps(cols.c2, _mm_set1_ps(points[2])));
+      r = _mm_add_ps(r, cols.c3);
+      store3(presult, r);
+   }
+}
+
+static SIMD_TARGET_SSE41 void m_matF_x_matF_batch_SSE41(const F32 *a, const F32 *b, U32 count, F32 *mresult)
+{
+   for (U32 i = 0; i < count; i++, b += 16, mresult += 16)
+      m_matF_x_matF_SSE41(a, b, mresult);
+}
+
+static SIMD_TARGET_SSE41 void m_matF_x_box3F_batch_SSE41(const F32 *m, const F32 *boxes, U32 count, F32 *bresult)
+{
+   AffineColumns cols;
+   loadColumns(m, cols);
+
+   for (U32 i = 0; i < count; i++, boxes += 6, bresult += 6)
+      transformBox(cols, boxes, bresult);
+}
+
+static SIMD_TARGET_SSE41 U32 m_sphereF_x_planes_batch_SSE41(const F32 *planes, U32 planeCount, const F32 *spheres, U32 count, U8 *outside)
+{
+   const __m128 zero = _mm_setzero_ps();
+   U32 outsideCount = 0;
+
+   U32 i = 0;
+   for (; i + 4 <= count; i += 4)
+   {
+      // Four spheres, transposed to x, y, z, radius.
+      __m128 x = _mm_loadu_ps(spheres + i * 4);
+      __m128 y = _mm_loadu_ps(spheres + i * 4 + 4);
+      __m128 z = _mm_loadu_ps(spheres + i * 4 + 8);
+      __m128 r = _mm_loadu_ps(spheres + i * 4 + 12);
+      _MM_TRANSPOSE4_PS(x, y, z, r);
+
+      __m128 out = zero;
+      for (U32 p = 0; p < planeCount; p++)
+      {
+         const F32* plane = planes + p * 4;
+         __m128 distance = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(plane[0]), x), _mm_mul_ps(_mm_set1_ps(plane[1]), y));
+         distance = _mm_add_ps(distance, _mm_mul_ps(_mm_set1_ps(plane[2]), z));
+         distance = _mm_add_ps(distance, _mm_set1_ps(plane[3]));
+         out = _mm_or_ps(out, _mm_cmplt_ps(_mm_add_ps(distance, r), zero));
+      }
+
+      const S32 mask = _mm_movemask_ps(out);
+      for (U32 k = 0; k < 4; k++)
+      {
+         outside[i + k] = (mask >> k) & 1;
+         outsideCount += outside[i + k];
+      }
+   }
+
+   if (i < count)
+      outsideCount += m_sphereF_x_planes_batch_C(planes, planeCount, spheres + i * 4, count - i, outside + i);
+
+   return outsideCount;
+}
+
+//-----------------------------------------------------------------------------
+// AVX2 + FMA
+//-----------------------------------------------------------------------------
+
+static inline SIMD_TARGET_AVX2 __m256 set2(F32 lo, F32 hi)
+{
+   return _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_set1_ps(lo)), _mm_set1_ps(hi), 1);
+}
+
+static SIMD_TARGET_AVX2 void m_matF_x_matF_AVX2(const F32 *a, const F32 *b, F32 *mresult)
+{
+   // Two result rows per iteration, alias safe like the SSE4.1 version.
+   const __m256 b0 = _mm256_broadcast_ps((const __m128*)b);
+   const __m256 b1 = _mm256_broadcast_ps((const __m128*)(b + 4));
+   const __m256 b2 = _mm256_broadcast_ps((const __m128*)(b + 8));
+   const __m256 b3 = _mm256_broadcast_ps((const __m128*)(b + 12));
+
+   for (U32 i = 0; i < 16; i += 8)
+   {
+      __m256 rows = _mm256_mul_ps(set2(a[i], a[i + 4]), b0);
+      rows = _mm256_fmadd_ps(set2(a[i + 1], a[i + 5]), b1, rows);
+      rows = _mm256_fmadd_ps(set2(a[i + 2], a[i + 6]), b2, rows);
+      rows = _mm256_fmadd_ps(set2(a[i + 3], a[i + 7]), b3, rows);
+      _mm256_storeu_ps(mresult + i, rows);
+   }
+}
+
+static SIMD_TARGET_AVX2 void m_matF_x_matF_batch_AVX2(const F32 *a, const F32 *b, U32 count, F32 *mresult)
+{
+   // a stays in registers, broadcast per element, and b[i] changes.
+   __m256 a01[4], a23[4];
+   for (U32 k = 0; k < 4; k++)
+   {
+      a01[k] = set2(a[k], a[4 + k]);
+      a23[k] = set2(a[8 + k], a[12 + k]);
+   }
+
+   for (U32 i = 0; i < count; i++, b += 16, mresult += 16)
+   {
+      const __m256 b0 = _mm256_broadcast_ps((const __m128*)b);
+      const __m256 b1 = _mm256_broadcast_ps((const __m128*)(b + 4));
+      const __m256 b2 = _mm256_broadcast_ps((const __m128*)(b + 8));
+      const __m256 b3 = _mm256_broadcast_ps((const __m128*)(b + 12));
+
+      __m256 r01 = _mm256_mul_ps(a01[0], b0);
+      __m256 r23 = _mm256_mul_ps(a23[0], b0);
+      r01 = _mm256_fmadd_ps(a01[1], b1, r01);
+      r23 = _mm256_fmadd_ps(a23[1], b1, r23);
+      r01 = _mm256_fmadd_ps(a01[2], b2, r01);
+      r23 = _mm256_fmadd_ps(a23[2], b2, r23);
+      r01 = _mm256_fmadd_ps(a01[3], b3, r01);
+      r23 = _mm256_fmadd_ps(a23[3], b3, r23);
+
+      _mm256_storeu_ps(mresult, r01);
+      _mm256_storeu_ps(mresult + 8, r23);
+   }
+}
+
+static SIMD_TARGET_AVX2 void m_matF_x_point3F_batch_AVX2(const F32 *m, const F32 *points, U32 count, F32 *presult)
+{
+   AffineColumns cols;
+   loadColumns(m, cols);
+
+   const __m256 c0 = _mm256_broadcast_ps(&cols.c0);
+   const __m256 c1 = _mm256_broadcast_ps(&cols.c1);
+   const __m256 c2 = _mm256_broadcast_ps(&cols.c2);
+   const __m256 c3 = _mm256_broadcast_ps(&cols.c3);
+
+   // Two points per iteration, one per lane.
+   U32 i = 0;
+   for (; i + 2 <= count; i += 2, points += 6, presult += 6)
+   {
+      __m256 r = _mm256_fmadd_ps(c0, set2(points[0], points[3]), c3);
+      r = _mm256_fmadd_ps(c1, set2(points[1], points[4]), r);
+      r = _mm256_fmadd_ps(c2, set2(points[2], points[5]), r);
+
+      store3(presult, _mm256_castps256_ps128(r));
+      store3(presult + 3, _mm256_extractf128_ps(r, 1));
+   }
+
+   if (i < count)
+      m_matF_x_point3F_batch_SSE41(m, points, count - i, presult);
+}
+
+static SIMD_TARGET_AVX2 U32 m_sphereF_x_planes_batch_AVX2(const F32 *planes, U32 planeCount, const F32 *spheres, U32 count, U8 *outside)
+{
+   const __m256 zero = _mm256_setzero_ps();
+   const __m256i stride = _mm256_setr_epi32(0, 4, 8, 12, 16, 20, 24, 28);
+   U32 outsideCount = 0;
+
+   U32 i = 0;
+   for (; i + 8 <= count; i += 8)
+   {
+      const F32* s = spheres + i * 4;
+      const __m256 x = _mm256_i32gather_ps(s,     stride, 4);
+      const __m256 y = _mm256_i32gather_ps(s + 1, stride, 4);
+      const __m256 z = _mm256_i32gather_ps(s + 2, stride, 4);
+      const __m256 r = _mm256_i32gather_ps(s + 3, stride, 4);
+
+      __m256 out = zero;
+      for (U32 p = 0; p < planeCount; p++)
+      {
+         const F32* plane = planes + p * 4;
+         __m256 distance = _mm256_fmadd_ps(_mm256_set1_ps(plane[0]), x, _mm256_set1_ps(plane[3]));
+         distance = _mm256_fmadd_ps(_mm256_set1_ps(plane[1]), y, distance);
+         distance = _mm256_fmadd_ps(_mm256_set1_ps(plane[2]), z, distance);
+         out = _mm256_or_ps(out, _mm256_cmp_ps(_mm256_add_ps(distance, r), zero, _CMP_LT_OQ));
+      }
+
+      const S32 mask = _mm256_movemask_ps(out);
+      for (U32 k = 0; k < 8; k++)
+      {
+         outside[i + k] = (mask >> k) & 1;
+         outsideCount += outside[i + k];
+      }
+   }
+
+   if (i < count)
+      outsideCount += m_sphereF_x_planes_batch_SSE41(planes, planeCount, spheres + i * 4, count - i, outside + i);
+
+   return outsideCount;
+}
+
+//-----------------------------------------------------------------------------
+
+void mInstallLibrary_SIMD(U32 level)
+{
+   if (level > mGetSIMDSupport())
+      level = mGetSIMDSupport();
+
+   if (level >= MathSIMD_SSE41)
+   {
+      m_matF_x_matF              = m_matF_x_matF_SSE41;
+      m_matF_x_point4F           = m_matF_x_point4F_SSE41;
+      m_matF_transpose           = m_matF_transpose_SSE41;
+      m_matF_x_box3F             = m_matF_x_box3F_SSE41;
+      m_point3F_bulk_dot         = m_point3F_bulk_dot_SSE41;
+
+      m_matF_x_point3F_batch     = m_matF_x_point3F_batch_SSE41;
+      m_matF_x_matF_batch        = m_matF_x_matF_batch_SSE41;
+      m_matF_x_box3F_batch       = m_matF_x_box3F_batch_SSE41;
+      m_sphereF_x_planes_batch   = m_sphereF_x_planes_batch_SSE41;
+   }
+
+   if (level >= MathSIMD_AVX2)
+   {
+      m_matF_x_matF              = m_matF_x_matF_AVX2;
+      m_matF_x_point3F_batch     = m_matF_x_point3F_batch_AVX2;
+      m_matF_x_matF_batch        = m_matF_x_matF_batch_AVX2;
+      m_sphereF_x_planes_batch   = m_sphereF_x_planes_batch_AVX2;
+   }
+}
+
+#else // TORQUE_MATH_SIMD
+
+U32 mGetSIMDSupport()
+{
+   return MathSIMD_None;
+}
+
+void mInstallLibrary_SIMD(U32 level)
+{
+}
+
+#endif // TORQUE_MATH_SIMD
+
+const char* mGetSIMDName(U32 level)
+{
+   switch (level)
+   {
+      case MathSIMD_SSE41: return "SSE4.1";
+      case MathSIMD_AVX2:  return "AVX2";
+      default:             return "C";
+   }
+}
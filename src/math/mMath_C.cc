@@ -742,6 +742,65 @@ void m_point3F_bulk_dot_indexed_C(const F32* refVector,
 }
 
 
+//--------------------------------------
+// Batch versions. These are the reference the SIMD kernels are tested against.
+
+void m_matF_x_point3F_batch_C(const F32 *m, const F32 *points, U32 count, F32 *presult)
+{
+   for (U32 i = 0; i < count; i++, points += 3, presult += 3)
+   {
+      const F32 x = points[0];
+      const F32 y = points[1];
+      const F32 z = points[2];
+      presult[0] = m[0]*x + m[1]*y + m[2]*z  + m[3];
+      presult[1] = m[4]*x + m[5]*y + m[6]*z  + m[7];
+      presult[2] = m[8]*x + m[9]*y + m[10]*z + m[11];
+   }
+}
+
+void m_matF_x_matF_batch_C(const F32 *a, const F32 *b, U32 count, F32 *mresult)
+{
+   // mresult may alias b.
+   F32 temp[16];
+   for (U32 i = 0; i < count; i++, b += 16, mresult += 16)
+   {
+      default_matF_x_matF_C(a, b, temp);
+      dMemcpy(mresult, temp, sizeof(temp));
+   }
+}
+
+void m_matF_x_box3F_batch_C(const F32 *m, const F32 *boxes, U32 count, F32 *bresult)
+{
+   for (U32 i = 0; i < count; i++, boxes += 6, bresult += 6)
+   {
+      if (bresult != boxes)
+         dMemcpy(bresult, boxes, sizeof(F32) * 6);
+      m_matF_x_box3F_C(m, bresult, bresult + 3);
+   }
+}
+
+U32 m_sphereF_x_planes_batch_C(const F32 *planes, U32 planeCount, const F32 *spheres, U32 count, U8 *outside)
+{
+   U32 outsideCount = 0;
+   for (U32 i = 0; i < count; i++, spheres += 4)
+   {
+      outside[i] = 0;
+      for (U32 p = 0; p < planeCount; p++)
+      {
+         const F32* plane = planes + p * 4;
+         const F32 distance = plane[0]*spheres[0] + plane[1]*spheres[1] + plane[2]*spheres[2] + plane[3];
+         if (distance + spheres[3] < 0.0f)
+         {
+            outside[i] = 1;
+            outsideCount++;
+            break;
+         }
+      }
+   }
+   return outsideCount;
+}
+
+
 //------------------------------------------------------------------------------
 // Math function pointer declarations
 
@@ -792,6 +851,11 @@ void (*m_matF_x_point4F)(const F32 *m, const F32 *p, F32 *presult) = m_matF_x_po
 void (*m_matF_x_scale_x_planeF)(const F32 *m, const F32* s, const F32 *p, F32 *presult) = m_matF_x_scale_x_planeF_C;
 void (*m_matF_x_box3F)(const F32 *m, F32 *min, F32 *max)    = m_matF_x_box3F_C;
 
+void (*m_matF_x_point3F_batch)(const F32 *m, const F32 *points, U32 count, F32 *presult) = m_matF_x_point3F_batch_C;
+void (*m_matF_x_matF_batch)(const F32 *a, const F32 *b, U32 count, F32 *mresult) = m_matF_x_matF_batch_C;
+void (*m_matF_x_box3F_batch)(const F32 *m, const F32 *boxes, U32 count, F32 *bresult) = m_matF_x_box3F_batch_C;
+U32  (*m_sphereF_x_planes_batch)(const F32 *planes, U32 planeCount, const F32 *spheres, U32 count, U8 *outside) = m_sphereF_x_planes_batch_C;
+
 
 //------------------------------------------------------------------------------
 void mInstallLibrary_C()
@@ -832,5 +896,10 @@ void mInstallLibrary_C()
    m_matF_x_point4F        = m_matF_x_point4F_C;
    m_matF_x_scale_x_planeF = m_matF_x_scale_x_planeF_C;
    m_matF_x_box3F          = m_matF_x_box3F_C;
+
+   m_matF_x_point3F_batch  = m_matF_x_point3F_batch_C;
+   m_matF_x_matF_batch     = m_matF_x_matF_batch_C;
+   m_matF_x_box3F_batch    = m_matF_x_box3F_batch_C;
+   m_sphereF_x_planes_batch = m_sphereF_x_planes_batch_C;
 }
 
@@ -29,6 +29,12 @@
 #ifndef _MPOINT_H_
 #include "math/mPoint.h"
 #endif
+#ifndef _MBOX_H_
+#include "math/mBox.h"
+#endif
+#ifndef _MSPHERE_H_
+#include "math/mSphere.h"
+#endif
 
 //---------------------------------------------------------------------------
 
@@ -85,6 +91,8 @@ public:
    };
 
    Side whichSide(const Point3F& cp) const;
+   Side whichSide(const Box3F& aabb) const;
+   Side whichSide(const SphereF& sphere) const;
    F32  intersect(const Point3F &start, const Point3F &end) const;
 
    /// Compute the intersection between two planes.
@@ -229,6 +237,33 @@ inline PlaneF::Side PlaneF::whichSide(const Point3F& cp) const
       return On;                       //    return Back;
 }
 
+inline PlaneF::Side PlaneF::whichSide(const Box3F& aabb) const
+{
+   // Project the box half-extents onto the plane normal.
+   const Point3F center = aabb.getCenter();
+   const Point3F extents = (aabb.maxExtents - aabb.minExtents) * 0.5f;
+   const F32 radius = extents.x * mFabs(x) + extents.y * mFabs(y) + extents.z * mFabs(z);
+
+   const F32 dist = distToPlane(center);
+   if (dist > radius)
+      return Front;
+   else if (dist < -radius)
+      return Back;
+   else
+      return On;
+}
+
+inline PlaneF::Side PlaneF::whichSide(const SphereF& sphere) const
+{
+   const F32 dist = distToPlane(sphere.center);
+   if (dist > sphere.radius)
+      return Front;
+   else if (dist < -sphere.radius)
+      return Back;
+   else
+      return On;
+}
+
 inline void PlaneF::set(const F32 _x, const F32 _y, const F32 _z)
 {
     Point3F::set(_x,_y,_z);
@@ -44,7 +44,7 @@
 #include <assimp/types.h>
 
 // Binary Mesh Version Number
-U8 MeshAsset::BinVersion = 105;
+U8 MeshAsset::BinVersion = 106;
 
 MeshAsset* getMeshAsset(const char* id)
 {
@@ -122,7 +122,6 @@ MeshAsset::MeshAsset() :
    mMeshFile(StringTable->EmptyString),
    mScene ( NULL )
 {
-   mImportThread = NULL;
    mBoundingBox.minExtents.set(0, 0, 0);
    mBoundingBox.maxExtents.set(0, 0, 0);
    mIsAnimated = false;
@@ -134,6 +133,9 @@ MeshAsset::MeshAsset() :
 
 MeshAsset::~MeshAsset()
 {
+   // Don't pull the mesh out from under a threaded import.
+   JobSystem::wait(mImportJob);
+
    for ( S32 m = 0; m < mMeshList.size(); ++m )
    {
       if ( mMeshList[m].vertexBuffer.idx != bgfx::invalidHandle )
@@ -207,9 +209,8 @@ void MeshAsset::initializeAsset( void )
 
    mMeshFile = expandAssetFilePath( mMeshFile );
 
-   //Con::printf("MESH IMPORT THREAD CREATED!");
-   //mImportThread = new MeshImportThread(this);
-   //mImportThread->start();
+   //Con::printf("MESH IMPORT JOB QUEUED!");
+   //JobSystem::submit(&MeshAsset::importJob, this, &mImportJob);
    loadMesh();
 }
 
@@ -242,6 +243,7 @@ void MeshAsset::loadMesh()
    if ( !loadBin() )
    {
       importMesh();
+      buildBVH();
       processMesh();
       saveBin();
    } else {
@@ -579,6 +581,10 @@ bool MeshAsset::loadBin()
       // Materials: Material Count
       stream.read(&mMaterialCount);
 
+      // Raycast BVH
+      if ( !mBVH.read(stream) )
+         buildBVH();
+
       stream.close();
 
       //U64 endTime = bx::getHPCounter();
@@ -696,6 +702,9 @@ void MeshAsset::saveBin()
    // Materials: Material Count
    stream.write(mMaterialCount);
 
+   // Raycast BVH
+   mBVH.write(stream);
+
    stream.close();
 }
 
@@ -742,8 +751,9 @@ Vector<StringTableEntry> MeshAsset::getAnimationNames()
    return results;
 }
 
-// Returns the number of transformations loaded into transformsOut.
-U32 MeshAsset::getAnimatedTransforms(U32 animationIndex, F64 timeInSeconds, F32* transformsOut)
+// Returns the number of transformations loaded into transformsOut, which has
+// room for maxTransforms. Bones past that are skipped.
+U32 MeshAsset::getAnimatedTransforms(U32 animationIndex, F64 timeInSeconds, F32* transformsOut, U32 maxTransforms)
 {
    if ( !mScene ) return 0;
 
@@ -758,11 +768,11 @@ U32 MeshAsset::getAnimatedTransforms(U32 animationIndex, F64 timeInSeconds, F32*
    F64 timeInTicks    = timeInSeconds * ticksPerSecond;
    F64 animationTime  = fmod(timeInTicks, mScene->mAnimations[animationIndex]->mDuration);
 
-   return _readNodeHeirarchy(animationIndex, animationTime, mScene->mRootNode, Identity, globalInverseTransform, transformsOut);
+   return _readNodeHeirarchy(animationIndex, animationTime, mScene->mRootNode, Identity, globalInverseTransform, transformsOut, maxTransforms);
 }
 
 U32 MeshAsset::_readNodeHeirarchy(U32 animationIndex, F64 animationTime, const aiNode* pNode, 
-                                  MatrixF parentTransform, MatrixF globalInverseTransform, F32* transformsOut)
+                                  MatrixF parentTransform, MatrixF globalInverseTransform, F32* transformsOut, U32 maxTransforms)
 { 
    U32 xfrmCount = 0;
    const char* nodeName = pNode->mName.data;
@@ -794,9 +804,11 @@ U32 MeshAsset::_readNodeHeirarchy(U32 animationIndex, F64 animationTime, const a
 
    MatrixF GlobalTransformation = parentTransform * NodeTransformation;
 
-   if ( mBoneMap.find(nodeName) != mBoneMap.end() ) 
+   // Lookup only, this is called from the animation batch workers.
+   HashMap<const char*, U32>::iterator boneItr = mBoneMap.find(nodeName);
+   if ( boneItr != mBoneMap.end() && boneItr->value < maxTransforms ) 
    {
-      U32 BoneIndex = mBoneMap[nodeName];
+      U32 BoneIndex = boneItr->value;
       xfrmCount = BoneIndex + 1;
 
       MatrixF boneTransform = globalInverseTransform * GlobalTransformation * mBoneOffsets[BoneIndex];
@@ -805,7 +817,7 @@ U32 MeshAsset::_readNodeHeirarchy(U32 animationIndex, F64 animationTime, const a
 
    for ( U32 i = 0 ; i < pNode->mNumChildren ; i++ ) 
    {
-      U32 childXfrmCount = _readNodeHeirarchy(animationIndex, animationTime, pNode->mChildren[i], GlobalTransformation, globalInverseTransform, transformsOut);
+      U32 childXfrmCount = _readNodeHeirarchy(animationIndex, animationTime, pNode->mChildren[i], GlobalTransformation, globalInverseTransform, transformsOut, maxTransforms);
       if ( childXfrmCount > xfrmCount )
          xfrmCount = childXfrmCount;
    }
@@ -927,98 +939,50 @@ U32 MeshAsset::_findPosition(F64 AnimationTime, const aiNodeAnim* pNodeAnim)
     return 0;
 }
 
-// MllerTrumbore intersection algorithm
-// https://en.wikipedia.org/wiki/M%C3%B6ller%E2%80%93Trumbore_intersection_algorithm
-
-bool triangle_intersection(const Point3F& V1,
-   const Point3F& V2,
-   const Point3F& V3,
-   const Point3F& O,
-   const Point3F& D,
-   F32* out)
+// Raycasting
+bool MeshAsset::raycast(const Point3F& start, const Point3F& end, Point3F& hitPoint)
 {
-   //Find vectors for two edges sharing V1
-   Point3F e1 = V2 - V1;
-   Point3F e2 = V3 - V1;
-   //Begin calculating determinant - also used to calculate u parameter
-   Point3F P = mCross(D, e2);
-   //if determinant is near zero, ray lies in plane of triangle
-   F32 det = mDot(e1, P);
-   //NOT CULLING
-   if (det > -FLT_EPSILON && det < FLT_EPSILON) return false;
-   F32 inv_det = 1.0f / det;
-
-   //calculate distance from V1 to ray origin
-   Point3F T = O - V1;
-
-   //Calculate u parameter and test bound
-   F32 u = mDot(T, P) * inv_det;
-   //The intersection lies outside of the triangle
-   if (u < 0.0f || u > 1.0f) return false;
-
-   //Prepare to test v parameter
-   Point3F Q = mCross(T, e1);
-
-   //Calculate V parameter and test bound
-   F32 v = mDot(D, Q) * inv_det;
-   //The intersection lies outside of the triangle
-   if (v < 0.f || u + v  > 1.f) return false;
-
-   F32 t = mDot(e2, Q) * inv_det;
-
-   if (t > FLT_EPSILON) { //ray intersection
-      *out = t;
-      return true;
-   }
+   MeshBVH::RayHit hit;
+   if (!mBVH.raycast(start, end, hit))
+      return false;
 
-   // No hit, no win
-   return false;
+   hitPoint = hit.point;
+   return true;
 }
 
-// Raycasting
-bool MeshAsset::raycast(const Point3F& start, const Point3F& end, Point3F& hitPoint)
+U32 MeshAsset::raycast(const Point3F* starts, const Point3F* ends, U32 count, MeshBVH::RayHit* hits)
 {
+   return mBVH.raycast(starts, ends, count, hits);
+}
+
+void MeshAsset::buildBVH()
+{
+   mBVH.clear();
+
    for (S32 n = 0; n < mMeshList.size(); ++n)
    {
-      SubMesh* subMeshData = &mMeshList[n];
-
-      // 
-      for (S32 i = 0; i < subMeshData->meshData.faces.size(); ++i)
+      Graphics::MeshData* meshData = &mMeshList[n].meshData;
+      for (S32 i = 0; i < meshData->faces.size(); ++i)
       {
-         Graphics::MeshFace* face = &subMeshData->meshData.faces[i];
-         Graphics::PosUVTBNBonesVertex* vertA = &subMeshData->meshData.verts[face->verts[0]];
-         Graphics::PosUVTBNBonesVertex* vertB = &subMeshData->meshData.verts[face->verts[1]];
-         Graphics::PosUVTBNBonesVertex* vertC = &subMeshData->meshData.verts[face->verts[2]];
-
-         F32 intersectionPoint = 0.0f;
-         bool result = triangle_intersection( Point3F(vertA->m_x, vertA->m_y, vertA->m_z),
-                                              Point3F(vertB->m_x, vertB->m_y, vertB->m_z),
-                                              Point3F(vertC->m_x, vertC->m_y, vertC->m_z),
-                                              start,
-                                              end,
-                                              &intersectionPoint );
-
-         // For now just exit on intersection.
-         if (result)
-         { 
-            Point3F vec = end - start;
-            hitPoint = start + (vec * intersectionPoint);
-            return true;
-         }
+         Graphics::MeshFace* face = &meshData->faces[i];
+         Graphics::PosUVTBNBonesVertex* vertA = &meshData->verts[face->verts[0]];
+         Graphics::PosUVTBNBonesVertex* vertB = &meshData->verts[face->verts[1]];
+         Graphics::PosUVTBNBonesVertex* vertC = &meshData->verts[face->verts[2]];
+
+         mBVH.addTriangle(Point3F(vertA->m_x, vertA->m_y, vertA->m_z),
+                          Point3F(vertB->m_x, vertB->m_y, vertB->m_z),
+                          Point3F(vertC->m_x, vertC->m_y, vertC->m_z),
+                          n, i);
       }
    }
 
-   return false;
+   mBVH.build();
 }
 
 // Threaded Mesh Import
-MeshImportThread::MeshImportThread(MeshAsset* _meshAsset)
-{
-   mMeshAsset = _meshAsset;
-}
-
-void MeshImportThread::run(void *arg)
+void MeshAsset::importJob(void* data, U32 first, U32 count)
 {
-   mMeshAsset->loadMesh();
-   Con::printf("ASSET LOADED FROM THREAD!");
+   MeshAsset* meshAsset = static_cast<MeshAsset*>(data);
+   meshAsset->loadMesh();
+   Con::printf("ASSET LOADED FROM JOB!");
 }
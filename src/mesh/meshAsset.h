@@ -59,18 +59,13 @@
 #include "collection/hashTable.h"
 #endif
 
-// Threaded Import
-class MeshAsset;
-class MeshImportThread : public Thread
-{
-   protected:
-      MeshAsset*    mMeshAsset;
-
-   public:
-      MeshImportThread(MeshAsset* _meshAsset);
+#ifndef _MESH_BVH_H_
+#include "mesh/meshBVH.h"
+#endif
 
-      virtual void run(void *arg = 0);
-};
+#ifndef _JOB_SYSTEM_H_
+#include "platform/threads/jobSystem.h"
+#endif
 
 //-----------------------------------------------------------------------------
 
@@ -106,7 +101,8 @@ private:
    const aiScene*             mScene;
    Box3F                      mBoundingBox;
    bool                       mIsAnimated;
-   MeshImportThread*          mImportThread;
+   JobCounter                 mImportJob;
+   MeshBVH                    mBVH;
 
 public:
    MeshAsset();
@@ -129,14 +125,16 @@ public:
    U32                        getMaterialCount() { return mMaterialCount; }
    Box3F                      getBoundingBox() { return mBoundingBox; }
    void                       loadMesh();
+   static void                importJob(void* data, U32 first, U32 count);
    void                       importMesh();
    void                       saveBin();
    bool                       loadBin();
    void                       processMesh();
+   void                       buildBVH();
 
    // Animation Functions
    Vector<StringTableEntry> getAnimationNames();
-   U32 getAnimatedTransforms(U32 animationIndex, F64 timeInSeconds, F32* transformsOut);
+   U32 getAnimatedTransforms(U32 animationIndex, F64 timeInSeconds, F32* transformsOut, U32 maxTransforms);
 
    // Buffers
    StringTableEntry          getMeshName(U32 idx)        { return mMeshList[idx].meshName; }
@@ -147,8 +145,10 @@ public:
    U32                       getMaterialIndex(U32 idx)   { return mMeshList[idx].materialIndex; }
    bool                      isSkinned()                 { return mIsAnimated; }
 
-   // Raycasting
+   // Raycasting. Both return the nearest hit along start -> end.
    bool raycast(const Point3F& start, const Point3F& end, Point3F& hitPoint);
+   U32  raycast(const Point3F* starts, const Point3F* ends, U32 count, MeshBVH::RayHit* hits);
+   const MeshBVH& getBVH() { return mBVH; }
 
    /// Declare Console Object.
    DECLARE_CONOBJECT(MeshAsset);
@@ -160,7 +160,7 @@ protected:
    virtual void onAssetRefresh( void );
 
    // Animation Functions.
-   U32 _readNodeHeirarchy(U32 animationIndex, F64 animationTime, const aiNode* pNode, MatrixF parentTransform, MatrixF globalInverseTransform, F32* transformsOut);
+   U32 _readNodeHeirarchy(U32 animationIndex, F64 animationTime, const aiNode* pNode, MatrixF parentTransform, MatrixF globalInverseTransform, F32* transformsOut, U32 maxTransforms);
    aiNodeAnim* _findNodeAnim(const aiAnimation* pAnimation, const char* nodeName);
    void _calcInterpolatedRotation(aiQuaternion& Out, F64 AnimationTime, const aiNodeAnim* pNodeAnim);
    U32 _findRotation(F64 AnimationTime, const aiNodeAnim* pNodeAnim);
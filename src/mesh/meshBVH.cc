@@ -0,0 +1,442 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2015 Andrew Mac
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//-----------------------------------------------------------------------------
+
+#include "meshBVH.h"
+#include "io/stream.h"
+
+#if defined(__SSE__) || defined(_M_X64) || defined(_M_AMD64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#define TORQUE_BVH_SSE
+#include <xmmintrin.h>
+#endif
+
+//-----------------------------------------------------------------------------
+
+static inline F32 safeInverse(F32 value)
+{
+   // Avoid infinities so a ray lying exactly on a slab plane doesn't produce
+   // 0 * inf = NaN in the slab test.
+   if (mFabs(value) < 1e-30f)
+      return (value < 0.0f) ? -1e30f : 1e30f;
+
+   return 1.0f / value;
+}
+
+static inline F32 surfaceArea(const Box3F& box)
+{
+   Point3F extents = box.getExtents();
+   return 2.0f * (extents.x * extents.y + extents.y * extents.z + extents.z * extents.x);
+}
+
+static inline void extendBox(Box3F& box, const MeshBVH::Triangle& tri)
+{
+   box.intersect(tri.v0);
+   box.intersect(tri.v0 + tri.e1);
+   box.intersect(tri.v0 + tri.e2);
+}
+
+// https://en.wikipedia.org/wiki/M%C3%B6ller%E2%80%93Trumbore_intersection_algorithm
+static inline bool intersectTriangle(const MeshBVH::Triangle& tri, const Point3F& origin, const Point3F& dir, F32& t)
+{
+   Point3F P = mCross(dir, tri.e2);
+   F32 det = mDot(tri.e1, P);
+
+   // Ray lies in plane of triangle. Not culling back faces.
+   if (det > -FLT_EPSILON && det < FLT_EPSILON) 
+      return false;
+
+   F32 invDet = 1.0f / det;
+   Point3F T = origin - tri.v0;
+
+   F32 u = mDot(T, P) * invDet;
+   if (u < 0.0f || u > 1.0f) 
+      return false;
+
+   Point3F Q = mCross(T, tri.e1);
+   F32 v = mDot(dir, Q) * invDet;
+   if (v < 0.0f || u + v > 1.0f) 
+      return false;
+
+   t = mDot(tri.e2, Q) * invDet;
+   return t > FLT_EPSILON;
+}
+
+//-----------------------------------------------------------------------------
+
+struct MeshBVHRay
+{
+   Point3F  origin;
+   Point3F  dir;
+   Point3F  invDir;
+
+#ifdef TORQUE_BVH_SSE
+   __m128   origin4;
+   __m128   invDir4;
+#endif
+
+   MeshBVHRay(const Point3F& start, const Point3F& end)
+   {
+      origin   = start;
+      dir      = end - start;
+      invDir.set(safeInverse(dir.x), safeInverse(dir.y), safeInverse(dir.z));
+
+#ifdef TORQUE_BVH_SSE
+      origin4  = _mm_set_ps(0.0f, origin.z, origin.y, origin.x);
+      invDir4  = _mm_set_ps(0.0f, invDir.z, invDir.y, invDir.x);
+#endif
+   }
+
+   // Slab test against the node bounds, limited to [0, tMax].
+   inline bool intersectNode(const MeshBVH::Node& node, F32 tMax) const
+   {
+#ifdef TORQUE_BVH_SSE
+      // The fourth lane holds offset/count bits, only xyz lanes are used below.
+      __m128 t1 = _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(node.minExtents), origin4), invDir4);
+      __m128 t2 = _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(node.maxExtents), origin4), invDir4);
+      __m128 tNear4 = _mm_min_ps(t1, t2);
+      __m128 tFar4  = _mm_max_ps(t1, t2);
+
+      __m128 tNear = _mm_max_ss(_mm_max_ss(tNear4, _mm_shuffle_ps(tNear4, tNear4, _MM_SHUFFLE(1, 1, 1, 1))),
+                                _mm_max_ss(_mm_shuffle_ps(tNear4, tNear4, _MM_SHUFFLE(2, 2, 2, 2)), _mm_setzero_ps()));
+      __m128 tFar  = _mm_min_ss(_mm_min_ss(tFar4, _mm_shuffle_ps(tFar4, tFar4, _MM_SHUFFLE(1, 1, 1, 1))),
+                                _mm_min_ss(_mm_shuffle_ps(tFar4, tFar4, _MM_SHUFFLE(2, 2, 2, 2)), _mm_set_ss(tMax)));
+
+      return _mm_comile_ss(tNear, tFar) != 0;
+#else
+      F32 tNear = 0.0f;
+      F32 tFar  = tMax;
+      for (U32 i = 0; i < 3; ++i)
+      {
+         F32 t1 = (node.minExtents[i] - origin[i]) * invDir[i];
+         F32 t2 = (node.maxExtents[i] - origin[i]) * invDir[i];
+         tNear = getMax(tNear, getMin(t1, t2));
+         tFar  = getMin(tFar, getMax(t1, t2));
+      }
+      return tNear <= tFar;
+#endif
+   }
+};
+
+//-----------------------------------------------------------------------------
+
+void MeshBVH::clear()
+{
+   mNodes.clear();
+   mTriangles.clear();
+}
+
+void MeshBVH::addTriangle(const Point3F& a, const Point3F& b, const Point3F& c, U32 subMesh, U32 face)
+{
+   mTriangles.increment();
+   Triangle& tri = mTriangles.last();
+   tri.v0      = a;
+   tri.e1      = b - a;
+   tri.e2      = c - a;
+   tri.subMesh = subMesh;
+   tri.face    = face;
+}
+
+void MeshBVH::build()
+{
+   mNodes.clear();
+   if (mTriangles.empty())
+      return;
+
+   Vector<Point3F> centroids;
+   centroids.setSize(mTriangles.size());
+   for (S32 i = 0; i < mTriangles.size(); ++i)
+   {
+      const Triangle& tri = mTriangles[i];
+      centroids[i] = tri.v0 + (tri.e1 + tri.e2) / 3.0f;
+   }
+
+   mNodes.reserve(mTriangles.size() * 2);
+   buildRecursive(0, mTriangles.size(), centroids, 0);
+   mNodes.compact();
+}
+
+U32 MeshBVH::buildRecursive(U32 first, U32 count, Vector<Point3F>& centroids, U32 depth)
+{
+   U32 nodeIndex = mNodes.size();
+   mNodes.increment();
+
+   // Bounds of the triangles and of their centroids.
+   Box3F bounds(Point3F(F32_MAX, F32_MAX, F32_MAX), Point3F(-F32_MAX, -F32_MAX, -F32_MAX), true);
+   Box3F centroidBounds = bounds;
+   for (U32 i = first; i < first + count; ++i)
+   {
+      extendBox(bounds, mTriangles[i]);
+      centroidBounds.intersect(centroids[i]);
+   }
+
+   Node& node = mNodes[nodeIndex];
+   for (U32 i = 0; i < 3; ++i)
+   {
+      node.minExtents[i] = bounds.minExtents[i];
+      node.maxExtents[i] = bounds.maxExtents[i];
+   }
+   node.axis = 0;
+
+   if (count <= MaxLeafSize)
+   {
+      node.offset = first;
+      node.count  = (U16)count;
+      return nodeIndex;
+   }
+
+   // Find the cheapest split over all three axes. Past half the maximum
+   // depth we fall back to median splits so the traversal stack can't overflow.
+   S32 bestAxis   = -1;
+   U32 bestBin    = 0;
+   F32 bestCost   = F32_MAX;
+   if (depth < MaxStackDepth / 2)
+   {
+      for (U32 axis = 0; axis < 3; ++axis)
+      {
+         F32 axisMin    = centroidBounds.minExtents[axis];
+         F32 axisExtent = centroidBounds.maxExtents[axis] - axisMin;
+         if (axisExtent <= FLT_EPSILON)
+            continue;
+
+         U32   binCounts[BinCount];
+         Box3F binBounds[BinCount];
+         for (U32 b = 0; b < BinCount; ++b)
+         {
+            binCounts[b] = 0;
+            binBounds[b].set(Point3F(F32_MAX, F32_MAX, F32_MAX), Point3F(-F32_MAX, -F32_MAX, -F32_MAX));
+         }
+
+         F32 binScale = BinCount / axisExtent;
+         for (U32 i = first; i < first + count; ++i)
+         {
+            U32 b = getMin((U32)((centroids[i][axis] - axisMin) * binScale), (U32)BinCount - 1);
+            binCounts[b]++;
+            extendBox(binBounds[b], mTriangles[i]);
+         }
+
+         // Sweep from the right to get the area of every right hand side.
+         F32 rightArea[BinCount];
+         U32 rightCount[BinCount];
+         Box3F sweep(Point3F(F32_MAX, F32_MAX, F32_MAX), Point3F(-F32_MAX, -F32_MAX, -F32_MAX), true);
+         U32 sweepCount = 0;
+         for (S32 b = BinCount - 1; b > 0; --b)
+         {
+            sweep.intersect(binBounds[b]);
+            sweepCount += binCounts[b];
+            rightArea[b]   = sweepCount > 0 ? surfaceArea(sweep) : 0.0f;
+            rightCount[b]  = sweepCount;
+         }
+
+         // Sweep from the left evaluating the cost of splitting before each bin.
+         sweep.set(Point3F(F32_MAX, F32_MAX, F32_MAX), Point3F(-F32_MAX, -F32_MAX, -F32_MAX));
+         sweepCount = 0;
+         for (U32 b = 1; b < BinCount; ++b)
+         {
+            sweep.intersect(binBounds[b - 1]);
+            sweepCount += binCounts[b - 1];
+            if (sweepCount == 0 || rightCount[b] == 0)
+               continue;
+
+            F32 cost = sweepCount * surfaceArea(sweep) + rightCount[b] * rightArea[b];
+            if (cost < bestCost)
+            {
+               bestCost = cost;
+               bestAxis = axis;
+               bestBin  = b;
+            }
+         }
+      }
+   }
+
+   // Partition triangles and their centroids.
+   U32 mid = first;
+   if (bestAxis >= 0)
+   {
+      F32 axisMin  = centroidBounds.minExtents[bestAxis];
+      F32 binScale = BinCount / (centroidBounds.maxExtents[bestAxis] - axisMin);
+      for (U32 i = first; i < first + count; ++i)
+      {
+         U32 b = getMin((U32)((centroids[i][bestAxis] - axisMin) * binScale), (U32)BinCount - 1);
+         if (b < bestBin)
+         {
+            Triangle tempTri     = mTriangles[i];
+            mTriangles[i]        = mTriangles[mid];
+            mTriangles[mid]      = tempTri;
+
+            Point3F tempCentroid = centroids[i];
+            centroids[i]         = centroids[mid];
+            centroids[mid]       = tempCentroid;
+            mid++;
+         }
+      }
+   }
+
+   if (mid == first || mid == first + count)
+   {
+      // No usable split (coincident centroids or too deep), split in the middle.
+      bestAxis = centroidBounds.len_x() >= centroidBounds.len_y() ? (centroidBounds.len_x() >= centroidBounds.len_z() ? 0 : 2) 
+                                                                  : (centroidBounds.len_y() >= centroidBounds.len_z() ? 1 : 2);
+      mid = first + count / 2;
+   }
+
+   buildRecursive(first, mid - first, centroids, depth + 1);
+   U32 secondChild = buildRecursive(mid, first + count - mid, centroids, depth + 1);
+
+   // The vector may have grown, don't reuse the reference from above.
+   mNodes[nodeIndex].offset   = secondChild;
+   mNodes[nodeIndex].count    = 0;
+   mNodes[nodeIndex].axis     = (U16)bestAxis;
+   return nodeIndex;
+}
+
+//-----------------------------------------------------------------------------
+
+bool MeshBVH::raycast(const Point3F& start, const Point3F& end, RayHit& hit) const
+{
+   hit.valid = false;
+   hit.t     = 1.0f;
+
+   if (mNodes.empty())
+      return false;
+
+   MeshBVHRay ray(start, end);
+   const Node* nodes = mNodes.address();
+
+   U32 stack[MaxStackDepth];
+   U32 stackSize = 0;
+   stack[stackSize++] = 0;
+
+   while (stackSize > 0)
+   {
+      const Node& node = nodes[stack[--stackSize]];
+      if (!ray.intersectNode(node, hit.t))
+         continue;
+
+      if (node.isLeaf())
+      {
+         for (U32 i = node.offset; i < node.offset + node.count; ++i)
+         {
+            F32 t;
+            if (intersectTriangle(mTriangles[i], ray.origin, ray.dir, t) && t <= hit.t)
+            {
+               hit.valid   = true;
+               hit.t       = t;
+               hit.subMesh = mTriangles[i].subMesh;
+               hit.face    = mTriangles[i].face;
+            }
+         }
+         continue;
+      }
+
+      // Visit the child nearest to the ray origin first so hit.t shrinks early.
+      U32 firstChild  = (U32)(&node - nodes) + 1;
+      U32 secondChild = node.offset;
+      if (ray.dir[node.axis] < 0.0f)
+      {
+         stack[stackSize++] = firstChild;
+         stack[stackSize++] = secondChild;
+      } else {
+         stack[stackSize++] = secondChild;
+         stack[stackSize++] = firstChild;
+      }
+   }
+
+   if (hit.valid)
+      hit.point = start + (ray.dir * hit.t);
+
+   return hit.valid;
+}
+
+U32 MeshBVH::raycast(const Point3F* starts, const Point3F* ends, U32 count, RayHit* hits) const
+{
+   U32 hitCount = 0;
+   for (U32 n = 0; n < count; ++n)
+   {
+      if (raycast(starts[n], ends[n], hits[n]))
+         hitCount++;
+   }
+
+   return hitCount;
+}
+
+bool MeshBVH::raycastBruteForce(const Point3F& start, const Point3F& end, RayHit& hit) const
+{
+   hit.valid = false;
+   hit.t     = 1.0f;
+
+   Point3F dir = end - start;
+   for (S32 i = 0; i < mTriangles.size(); ++i)
+   {
+      F32 t;
+      if (intersectTriangle(mTriangles[i], start, dir, t) && t <= hit.t)
+      {
+         hit.valid   = true;
+         hit.t       = t;
+         hit.subMesh = mTriangles[i].subMesh;
+         hit.face    = mTriangles[i].face;
+      }
+   }
+
+   if (hit.valid)
+      hit.point = start + (dir * hit.t);
+
+   return hit.valid;
+}
+
+//-----------------------------------------------------------------------------
+
+// The BVH is stored in the local mesh cache so it's written as raw blocks
+// rather than field by field.
+bool MeshBVH::read(Stream& stream)
+{
+   clear();
+
+   U32 nodeCount = 0;
+   U32 triangleCount = 0;
+   if (!stream.read(&nodeCount) || !stream.read(&triangleCount))
+      return false;
+
+   // Sanity!
+   if (nodeCount > triangleCount * 2)
+      return false;
+
+   mNodes.setSize(nodeCount);
+   mTriangles.setSize(triangleCount);
+
+   if (!stream.read(nodeCount * sizeof(Node), mNodes.address()) ||
+       !stream.read(triangleCount * sizeof(Triangle), mTriangles.address()))
+   {
+      clear();
+      return false;
+   }
+
+   return true;
+}
+
+bool MeshBVH::write(Stream& stream) const
+{
+   U32 nodeCount = mNodes.size();
+   U32 triangleCount = mTriangles.size();
+   stream.write(nodeCount);
+   stream.write(triangleCount);
+   stream.write(nodeCount * sizeof(Node), mNodes.address());
+   return stream.write(triangleCount * sizeof(Triangle), mTriangles.address());
+}
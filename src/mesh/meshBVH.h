@@ -0,0 +1,119 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2015 Andrew Mac
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//-----------------------------------------------------------------------------
+
+#ifndef _MESH_BVH_H_
+#define _MESH_BVH_H_
+
+#ifndef _MMATH_H_
+#include "math/mMath.h"
+#endif
+
+#ifndef _TVECTOR_H_
+#include "collection/vector.h"
+#endif
+
+class Stream;
+
+// ------------------------------------------------------------------------------
+//  MeshBVH
+// ------------------------------------------------------------------------------
+//
+//   Triangle bounding volume hierarchy used for raycasting against mesh data.
+//   Built top-down with a binned surface area heuristic and stored as a flat,
+//   depth-first array of nodes: the first child of an interior node always
+//   directly follows it, the second child is at node.offset.
+//
+// ------------------------------------------------------------------------------
+
+class MeshBVH
+{
+   public:
+      struct Node
+      {
+         F32 minExtents[3];
+         U32 offset;          ///< Leaf: first triangle. Interior: second child.
+         F32 maxExtents[3];
+         U16 count;           ///< Triangle count, zero for interior nodes.
+         U16 axis;            ///< Split axis of interior nodes.
+
+         bool isLeaf() const { return count > 0; }
+      };
+
+      // Stored ready for Moller-Trumbore so we don't need the source mesh.
+      struct Triangle
+      {
+         Point3F  v0;
+         Point3F  e1;
+         Point3F  e2;
+         U32      subMesh;
+         U32      face;
+      };
+
+      struct RayHit
+      {
+         bool     valid;
+         F32      t;          ///< Fraction along start -> end.
+         Point3F  point;
+         U32      subMesh;
+         U32      face;
+      };
+
+      enum
+      {
+         MaxLeafSize    = 4,
+         BinCount       = 12,
+         MaxStackDepth  = 64
+      };
+
+   protected:
+      Vector<Node>      mNodes;
+      Vector<Triangle>  mTriangles;
+
+      U32 buildRecursive(U32 first, U32 count, Vector<Point3F>& centroids, U32 depth);
+
+   public:
+      MeshBVH() { }
+
+      void clear();
+      bool isEmpty() const          { return mNodes.empty(); }
+      U32  getNodeCount() const     { return mNodes.size(); }
+      U32  getTriangleCount() const { return mTriangles.size(); }
+
+      // Build
+      void addTriangle(const Point3F& a, const Point3F& b, const Point3F& c, U32 subMesh, U32 face);
+      void build();
+
+      // Returns the nearest hit along the segment start -> end.
+      bool raycast(const Point3F& start, const Point3F& end, RayHit& hit) const;
+
+      // Batched version, returns the number of rays that hit.
+      U32 raycast(const Point3F* starts, const Point3F* ends, U32 count, RayHit* hits) const;
+
+      // Reference implementation, tests every triangle.
+      bool raycastBruteForce(const Point3F& start, const Point3F& end, RayHit& hit) const;
+
+      // Persistence
+      bool read(Stream& stream);
+      bool write(Stream& stream) const;
+};
+
+#endif // _MESH_BVH_H_
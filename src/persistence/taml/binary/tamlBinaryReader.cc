@@ -26,15 +26,19 @@
 #include "io/zip/zipSubStream.h"
 #endif
 
+#ifndef _MEMSTREAM_H_
+#include "io/memstream.h"
+#endif
+
 // Debug Profiling.
 #include "debug/profiler.h"
 
 //-----------------------------------------------------------------------------
 
-SimObject* TamlBinaryReader::read( FileStream& stream )
+bool TamlBinaryReader::parseDocument( FileStream& stream )
 {
     // Debug Profiling.
-    PROFILE_SCOPE(TamlBinaryReader_Read);
+    PROFILE_SCOPE(TamlBinaryReader_ParseDocument);
 
     // Read Taml signature.
     StringTableEntry tamlSignature = stream.readSTString();
@@ -44,18 +48,18 @@ SimObject* TamlBinaryReader::read( FileStream& stream )
     {
         // Warn.
         Con::warnf("Taml: Cannot read binary file as signature is incorrect '%s'.", tamlSignature );
-        return NULL;
+        return false;
     }
 
     // Read version Id.
-    U32 versionId;
-    stream.read( &versionId );
+    stream.read( &mVersionId );
 
     // Read compressed flag.
     bool compressed;
     stream.read( &compressed );
 
-    SimObject* pSimObject = NULL;
+    // Fetch the size of the element data.
+    const U32 dataSize = stream.getStreamSize() - stream.getPosition();
 
     // Is the stream compressed?
     if ( compressed )
@@ -64,18 +68,136 @@ SimObject* TamlBinaryReader::read( FileStream& stream )
         ZipSubRStream zipStream;
         zipStream.attachStream( &stream );
 
-        // Parse element.
-        pSimObject = parseElement( zipStream, versionId );
+        // The uncompressed size isn't stored so grow the buffer until the zip stream runs dry.
+        U32 bufferCapacity = getMax( dataSize * 4, (U32)4096 );
+        mpBuffer = (U8*)dMalloc( bufferCapacity );
+
+        while( true )
+        {
+            // Grow the buffer if it's full.
+            if ( mBufferSize == bufferCapacity )
+            {
+                bufferCapacity *= 2;
+                mpBuffer = (U8*)dRealloc( mpBuffer, bufferCapacity );
+            }
+
+            // Inflate into the rest of the buffer.
+            const U32 position = zipStream.getPosition();
+            if ( !zipStream.read( bufferCapacity - mBufferSize, mpBuffer + mBufferSize ) )
+                break;
+
+            mBufferSize += zipStream.getPosition() - position;
+
+            // Finish on a short read.
+            if ( mBufferSize < bufferCapacity )
+                break;
+        }
 
         // Detach zip stream.
         zipStream.detachStream();
     }
-    else
+    else if ( dataSize > 0 )
     {
-        // No, so parse element.
-        pSimObject = parseElement( stream, versionId );
+        // No, so read the element data as it is.
+        mpBuffer = (U8*)dMalloc( dataSize );
+        mBufferSize = stream.read( dataSize, mpBuffer ) ? dataSize : 0;
     }
 
+    // Did we read any element data?
+    if ( mBufferSize == 0 )
+    {
+        // No, so warn.
+        Con::warnf("Taml: Cannot read binary file as it has no element data." );
+        resetParse();
+        return false;
+    }
+
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+
+SimObject* TamlBinaryReader::beginRoot( void )
+{
+    // Debug Profiling.
+    PROFILE_SCOPE(TamlBinaryReader_BeginRoot);
+
+    // Finish if there's no element data.
+    if ( mpBuffer == NULL )
+        return NULL;
+
+    // Create a stream over the element data.
+    mpStream = new MemStream( mBufferSize, mpBuffer, true, false );
+
+    // Create root object.
+    bool isReference;
+    mpRootObject = createElementObject( *mpStream, mVersionId, isReference );
+
+    // Finish if we couldn't create the type.
+    if ( mpRootObject == NULL )
+        return NULL;
+
+    // Fetch children count.
+    mpStream->read( &mRootChildrenLeft );
+
+    // Finish if no children.
+    if ( mRootChildrenLeft == 0 )
+        return mpRootObject;
+
+    // Fetch the Taml children.
+    mpRootChildren = dynamic_cast<TamlChildren*>( mpRootObject );
+
+    // Is this a sim set?
+    if ( mpRootChildren == NULL )
+    {
+        // No, so warn.
+        Con::warnf("Taml: Child element found under parent but object cannot have children." );
+        mRootChildrenLeft = 0;
+        return mpRootObject;
+    }
+
+    // Fetch any container child class specifier.
+    mpRootContainerChildClass = mpRootObject->getClassRep()->getContainerChildClass( true );
+
+    return mpRootObject;
+}
+
+//-----------------------------------------------------------------------------
+
+bool TamlBinaryReader::readNextChild( void )
+{
+    // Debug Profiling.
+    PROFILE_SCOPE(TamlBinaryReader_ReadNextChild);
+
+    // Finish if there's nothing left to read.
+    if ( mRootChildrenLeft == 0 )
+        return false;
+
+    --mRootChildrenLeft;
+
+    // Parse child element, the rest are skipped if it failed.
+    if ( !parseChild( *mpStream, mpRootObject, mpRootChildren, mpRootContainerChildClass, mVersionId ) )
+        mRootChildrenLeft = 0;
+
+    return mRootChildrenLeft > 0;
+}
+
+//-----------------------------------------------------------------------------
+
+SimObject* TamlBinaryReader::endRoot( void )
+{
+    // Debug Profiling.
+    PROFILE_SCOPE(TamlBinaryReader_EndRoot);
+
+    SimObject* pSimObject = mpRootObject;
+
+    // Finish root object.
+    if ( pSimObject != NULL )
+        finishElementObject( *mpStream, pSimObject, mVersionId );
+
+    // Reset parse.
+    resetParse();
+
     return pSimObject;
 }
 
@@ -88,6 +210,19 @@ void TamlBinaryReader::resetParse( void )
 
     // Clear object reference map.
     mObjectReferenceMap.clear();
+
+    // Clear root state.
+    SAFE_DELETE( mpStream );
+    if ( mpBuffer != NULL )
+    {
+        dFree( mpBuffer );
+        mpBuffer = NULL;
+    }
+    mBufferSize = 0;
+    mpRootObject = NULL;
+    mpRootChildren = NULL;
+    mpRootContainerChildClass = NULL;
+    mRootChildrenLeft = 0;
 }
 
 //-----------------------------------------------------------------------------
@@ -97,6 +232,31 @@ SimObject* TamlBinaryReader::parseElement( Stream& stream, const U32 versionId )
     // Debug Profiling.
     PROFILE_SCOPE(TamlBinaryReader_ParseElement);
 
+    // Create object.
+    bool isReference;
+    SimObject* pSimObject = createElementObject( stream, versionId, isReference );
+
+    // Finish if we couldn't create the type or it's a reference.
+    if ( pSimObject == NULL || isReference )
+        return pSimObject;
+
+    // Parse children.
+    parseChildren( stream, pSimObject, versionId );
+
+    // Finish object.
+    finishElementObject( stream, pSimObject, versionId );
+
+    // Return object.
+    return pSimObject;
+}
+
+//-----------------------------------------------------------------------------
+
+SimObject* TamlBinaryReader::createElementObject( Stream& stream, const U32 versionId, bool& isReference )
+{
+    // Debug Profiling.
+    PROFILE_SCOPE(TamlBinaryReader_CreateElementObject);
+
     SimObject* pSimObject = NULL;
 
 #ifdef TORQUE_DEBUG
@@ -118,7 +278,8 @@ SimObject* TamlBinaryReader::parseElement( Stream& stream, const U32 versionId )
     stream.read( &tamlRefToId );
 
     // Do we have a reference to Id?
-    if ( tamlRefToId != 0 )
+    isReference = tamlRefToId != 0;
+    if ( isReference )
     {
         // Yes, so fetch reference.
         typeObjectReferenceHash::iterator referenceItr = mObjectReferenceMap.find( tamlRefToId );
@@ -190,13 +351,18 @@ SimObject* TamlBinaryReader::parseElement( Stream& stream, const U32 versionId )
         mObjectReferenceMap.insert( tamlRefId, pSimObject );
     }
 
-    // Parse custom elements.
-    TamlCustomNodes customProperties;
+    return pSimObject;
+}
 
-    // Parse children.
-    parseChildren( stream, pCallbacks, pSimObject, versionId );
+//-----------------------------------------------------------------------------
+
+void TamlBinaryReader::finishElementObject( Stream& stream, SimObject* pSimObject, const U32 versionId )
+{
+    // Find Taml callbacks.
+    TamlCallbacks* pCallbacks = dynamic_cast<TamlCallbacks*>( pSimObject );
 
     // Parse custom elements.
+    TamlCustomNodes customProperties;
     parseCustomElements( stream, pCallbacks, customProperties, versionId );
 
     // Are there any Taml callbacks?
@@ -205,9 +371,6 @@ SimObject* TamlBinaryReader::parseElement( Stream& stream, const U32 versionId )
         // Yes, so call it.
         mpTaml->tamlPostRead( pCallbacks, customProperties );
     }
-
-    // Return object.
-    return pSimObject;
 }
 
 //-----------------------------------------------------------------------------
@@ -244,7 +407,7 @@ void TamlBinaryReader::parseAttributes( Stream& stream, SimObject* pSimObject, c
 
 //-----------------------------------------------------------------------------
 
-void TamlBinaryReader::parseChildren( Stream& stream, TamlCallbacks* pCallbacks, SimObject* pSimObject, const U32 versionId )
+void TamlBinaryReader::parseChildren( Stream& stream, SimObject* pSimObject, const U32 versionId )
 {
     // Debug Profiling.
     PROFILE_SCOPE(TamlBinaryReader_ParseChildren);
@@ -277,46 +440,57 @@ void TamlBinaryReader::parseChildren( Stream& stream, TamlCallbacks* pCallbacks,
     // Iterate children.
     for ( U32 index = 0; index < childrenCount; ++ index )
     {
-        // Parse child element.
-        SimObject* pChildSimObject = parseElement( stream, versionId );
-
-        // Finish if child failed.
-        if ( pChildSimObject == NULL )
+        // Parse child element, finish if it failed.
+        if ( !parseChild( stream, pSimObject, pChildren, pContainerChildClass, versionId ) )
             return;
+    }
+}
 
-        // Do we have a container child class?
-        if ( pContainerChildClass != NULL )
+//-----------------------------------------------------------------------------
+
+bool TamlBinaryReader::parseChild( Stream& stream, SimObject* pSimObject, TamlChildren* pChildren, AbstractClassRep* pContainerChildClass, const U32 versionId )
+{
+    // Parse child element.
+    SimObject* pChildSimObject = parseElement( stream, versionId );
+
+    // Fail if child failed.
+    if ( pChildSimObject == NULL )
+        return false;
+
+    // Do we have a container child class?
+    if ( pContainerChildClass != NULL )
+    {
+        // Yes, so is the child object the correctly derived type?
+        if ( !pChildSimObject->getClassRep()->isClass( pContainerChildClass ) )
         {
-            // Yes, so is the child object the correctly derived type?
-            if ( !pChildSimObject->getClassRep()->isClass( pContainerChildClass ) )
-            {
-                // No, so warn.
-                Con::warnf("Taml: Child element '%s' found under parent '%s' but object is restricted to children of type '%s'.",
-                    pChildSimObject->getClassName(),
-                    pSimObject->getClassName(),
-                    pContainerChildClass->getClassName() );
+            // No, so warn.
+            Con::warnf("Taml: Child element '%s' found under parent '%s' but object is restricted to children of type '%s'.",
+                pChildSimObject->getClassName(),
+                pSimObject->getClassName(),
+                pContainerChildClass->getClassName() );
 
-                // NOTE: We can't delete the object as it may be referenced elsewhere!
-                pChildSimObject = NULL;
+            // NOTE: We can't delete the object as it may be referenced elsewhere!
+            pChildSimObject = NULL;
 
-                // Skip.
-                continue;
-            }
+            // Skip.
+            return true;
         }
+    }
 
-        // Add child.
-        pChildren->addTamlChild( pChildSimObject );
+    // Add child.
+    pChildren->addTamlChild( pChildSimObject );
 
-        // Find Taml callbacks for child.
-        TamlCallbacks* pChildCallbacks = dynamic_cast<TamlCallbacks*>( pChildSimObject );
+    // Find Taml callbacks for child.
+    TamlCallbacks* pChildCallbacks = dynamic_cast<TamlCallbacks*>( pChildSimObject );
 
-        // Do we have callbacks on the child?
-        if ( pChildCallbacks != NULL )
-        {
-            // Yes, so perform callback.
-            mpTaml->tamlAddParent( pChildCallbacks, pSimObject );
-        }
+    // Do we have callbacks on the child?
+    if ( pChildCallbacks != NULL )
+    {
+        // Yes, so perform callback.
+        mpTaml->tamlAddParent( pChildCallbacks, pSimObject );
     }
+
+    return true;
 }
 
 //-----------------------------------------------------------------------------
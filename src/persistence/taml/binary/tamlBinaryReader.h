@@ -27,26 +27,41 @@
 #include "collection/hashTable.h"
 #endif
 
-#ifndef _TAML_H_
-#include "persistence/taml/taml.h"
+#ifndef _TAML_READER_H_
+#include "persistence/taml/tamlReader.h"
 #endif
 
 //-----------------------------------------------------------------------------
 
+class MemStream;
+
+//-----------------------------------------------------------------------------
+
 /// @ingroup tamlGroup
 /// @see tamlGroup
-class TamlBinaryReader
+class TamlBinaryReader : public TamlReader
 {
 public:
     TamlBinaryReader( Taml* pTaml ) :
-        mpTaml( pTaml )
+        mpTaml( pTaml ),
+        mVersionId( 0 ),
+        mpBuffer( NULL ),
+        mBufferSize( 0 ),
+        mpStream( NULL ),
+        mpRootObject( NULL ),
+        mpRootChildren( NULL ),
+        mpRootContainerChildClass( NULL ),
+        mRootChildrenLeft( 0 )
     {
     }
 
-    virtual ~TamlBinaryReader() {}
+    virtual ~TamlBinaryReader() { resetParse(); }
 
-    /// Read.
-    SimObject* read( FileStream& stream );
+    /// Read phases.
+    virtual bool parseDocument( FileStream& stream );
+    virtual SimObject* beginRoot( void );
+    virtual bool readNextChild( void );
+    virtual SimObject* endRoot( void );
 
 private:
     Taml* mpTaml;
@@ -55,12 +70,24 @@ private:
 
     typeObjectReferenceHash mObjectReferenceMap;
 
+    U32                 mVersionId;
+    U8*                 mpBuffer;
+    U32                 mBufferSize;
+    MemStream*          mpStream;
+    SimObject*          mpRootObject;
+    TamlChildren*       mpRootChildren;
+    AbstractClassRep*   mpRootContainerChildClass;
+    U32                 mRootChildrenLeft;
+
 private:
     void resetParse( void );
 
     SimObject* parseElement( Stream& stream, const U32 versionId );
+    SimObject* createElementObject( Stream& stream, const U32 versionId, bool& isReference );
+    void finishElementObject( Stream& stream, SimObject* pSimObject, const U32 versionId );
     void parseAttributes( Stream& stream, SimObject* pSimObject, const U32 versionId );
-    void parseChildren( Stream& stream, TamlCallbacks* pCallbacks, SimObject* pSimObject, const U32 versionId );
+    void parseChildren( Stream& stream, SimObject* pSimObject, const U32 versionId );
+    bool parseChild( Stream& stream, SimObject* pSimObject, TamlChildren* pChildren, AbstractClassRep* pContainerChildClass, const U32 versionId );
     void parseCustomElements( Stream& stream, TamlCallbacks* pCallbacks, TamlCustomNodes& customNodes, const U32 versionId );
     void parseCustomNode( Stream& stream, TamlCustomNode* pCustomNode, const U32 versionId );
 };
@@ -0,0 +1,103 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2013 GarageGames, LLC
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//-----------------------------------------------------------------------------
+
+#include "persistence/taml/compiled/tamlCompiledLayout.h"
+
+#ifndef _SIM_OBJECT_H_
+#include "sim/simObject.h"
+#endif
+
+#ifndef _CONSOLETYPES_H_
+#include "console/consoleTypes.h"
+#endif
+
+#ifndef _CRC_H_
+#include "algorithm/crc.h"
+#endif
+
+//-----------------------------------------------------------------------------
+
+namespace TamlCompiledLayout
+{
+
+ValueKind getValueKind( const AbstractClassRep::Field* pField )
+{
+    // Only fields the numeric accessors can write in place are stored natively.
+    if ( !SimObject::isNumericDataField( pField ) )
+        return StringValue;
+
+    if ( pField->type == TypeS32 )
+        return S32Value;
+
+    if ( pField->type == TypeF32 )
+        return F32Value;
+
+    return BoolValue;
+}
+
+//-----------------------------------------------------------------------------
+
+U32 getLayoutHash( const AbstractClassRep* pClassRep )
+{
+    // Sanity!
+    AssertFatal( pClassRep != NULL, "TamlCompiledLayout::getLayoutHash() - Cannot hash a NULL class." );
+
+    // Fetch field list.
+    const AbstractClassRep::FieldList& fieldList = pClassRep->mFieldList;
+
+    U32 crc = INITIAL_CRC_VALUE;
+
+    // Iterate fields.
+    for( S32 index = 0; index < fieldList.size(); ++index )
+    {
+        // Fetch field.
+        const AbstractClassRep::Field& field = fieldList[index];
+
+        // Hash field name.
+        crc = calculateCRC( field.pFieldname, dStrlen(field.pFieldname), crc );
+
+        U32 layout[4];
+        layout[0] = field.type;
+        layout[1] = field.offset;
+        layout[2] = field.elementCount;
+        layout[3] = getValueKind( &field );
+
+        // Group and deprecated fields have no console type.
+        if ( field.type != AbstractClassRep::DepricatedFieldType &&
+            field.type != AbstractClassRep::StartGroupFieldType &&
+            field.type != AbstractClassRep::EndGroupFieldType )
+        {
+            // Type Ids depend on registration order so hash the type name and size instead.
+            ConsoleBaseType* pType = ConsoleBaseType::getType( field.type );
+            AssertFatal( pType != NULL, "TamlCompiledLayout::getLayoutHash() - Could not resolve type Id." );
+            crc = calculateCRC( pType->getTypeName(), dStrlen(pType->getTypeName()), crc );
+            layout[0] = (U32)pType->getTypeSize();
+        }
+
+        // Hash field layout.
+        crc = calculateCRC( layout, sizeof(layout), crc );
+    }
+
+    return crc ^ CRC_POSTCOND_VALUE;
+}
+
+}
@@ -0,0 +1,62 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2013 GarageGames, LLC
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//-----------------------------------------------------------------------------
+
+#ifndef _TAML_COMPILED_LAYOUT_H_
+#define _TAML_COMPILED_LAYOUT_H_
+
+#ifndef _CONSOLEOBJECT_H_
+#include "console/consoleObject.h"
+#endif
+
+//-----------------------------------------------------------------------------
+
+#define TAML_COMPILED_SIGNATURE         "TamlCompiled"
+#define TAML_COMPILED_DYNAMIC_FIELD     0xFFFF
+
+//-----------------------------------------------------------------------------
+
+/// The compiled format stores each class once, along with a hash of its static
+/// field layout.  Fields are then referred to by their index in the class field
+/// list and plain numeric fields are stored in native form.  If the layout hash
+/// no longer matches when reading, the fields are resolved by name and all
+/// values are set through their strings instead.
+///
+/// @ingroup tamlGroup
+/// @see tamlGroup
+namespace TamlCompiledLayout
+{
+    enum ValueKind
+    {
+        StringValue = 0,
+        S32Value,
+        F32Value,
+        BoolValue,
+    };
+
+    /// How a static field value is stored.
+    ValueKind getValueKind( const AbstractClassRep::Field* pField );
+
+    /// Hash of the names, types, offsets and storage of all of a class's static fields.
+    U32 getLayoutHash( const AbstractClassRep* pClassRep );
+}
+
+#endif // _TAML_COMPILED_LAYOUT_H_
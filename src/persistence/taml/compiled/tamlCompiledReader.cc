@@ -0,0 +1,782 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2013 GarageGames, LLC
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//-----------------------------------------------------------------------------
+
+#include "persistence/taml/compiled/tamlCompiledReader.h"
+
+#ifndef _TAML_COMPILED_LAYOUT_H_
+#include "persistence/taml/compiled/tamlCompiledLayout.h"
+#endif
+
+#ifndef _ZIPSUBSTREAM_H_
+#include "io/zip/zipSubStream.h"
+#endif
+
+#ifndef _MEMSTREAM_H_
+#include "io/memstream.h"
+#endif
+
+// Debug Profiling.
+#include "debug/profiler.h"
+
+//-----------------------------------------------------------------------------
+
+bool TamlCompiledReader::parseDocument( FileStream& stream )
+{
+    // Debug Profiling.
+    PROFILE_SCOPE(TamlCompiledReader_ParseDocument);
+
+    // Read Taml signature.
+    StringTableEntry tamlSignature = stream.readSTString();
+
+    // Is the signature correct?
+    if ( tamlSignature != StringTable->insert( TAML_COMPILED_SIGNATURE ) )
+    {
+        // Warn.
+        Con::warnf("Taml: Cannot read compiled file as signature is incorrect '%s'.", tamlSignature );
+        return false;
+    }
+
+    // Read version Id.
+    stream.read( &mVersionId );
+
+    // Read compressed flag.
+    bool compressed;
+    stream.read( &compressed );
+
+    // Fetch the size of the element data.
+    const U32 dataSize = stream.getStreamSize() - stream.getPosition();
+
+    // Is the stream compressed?
+    if ( compressed )
+    {
+        // Yes, so attach zip stream.
+        ZipSubRStream zipStream;
+        zipStream.attachStream( &stream );
+
+        // The uncompressed size isn't stored so grow the buffer until the zip stream runs dry.
+        U32 bufferCapacity = getMax( dataSize * 4, (U32)4096 );
+        mpBuffer = (U8*)dMalloc( bufferCapacity );
+
+        while( true )
+        {
+            // Grow the buffer if it's full.
+            if ( mBufferSize == bufferCapacity )
+            {
+                bufferCapacity *= 2;
+                mpBuffer = (U8*)dRealloc( mpBuffer, bufferCapacity );
+            }
+
+            // Inflate into the rest of the buffer.
+            const U32 position = zipStream.getPosition();
+            if ( !zipStream.read( bufferCapacity - mBufferSize, mpBuffer + mBufferSize ) )
+                break;
+
+            mBufferSize += zipStream.getPosition() - position;
+
+            // Finish on a short read.
+            if ( mBufferSize < bufferCapacity )
+                break;
+        }
+
+        // Detach zip stream.
+        zipStream.detachStream();
+    }
+    else if ( dataSize > 0 )
+    {
+        // No, so read the element data as it is.
+        mpBuffer = (U8*)dMalloc( dataSize );
+        mBufferSize = stream.read( dataSize, mpBuffer ) ? dataSize : 0;
+    }
+
+    // Did we read any element data?
+    if ( mBufferSize == 0 )
+    {
+        // No, so warn.
+        Con::warnf("Taml: Cannot read compiled file as it has no element data." );
+        resetParse();
+        return false;
+    }
+
+    // Create a stream over the element data.
+    mpStream = new MemStream( mBufferSize, mpBuffer, true, false );
+
+    // Resolve the class table.
+    if ( !parseClasses( *mpStream ) )
+    {
+        resetParse();
+        return false;
+    }
+
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+
+SimObject* TamlCompiledReader::beginRoot( void )
+{
+    // Debug Profiling.
+    PROFILE_SCOPE(TamlCompiledReader_BeginRoot);
+
+    // Finish if there's no element data.
+    if ( mpStream == NULL )
+        return NULL;
+
+    // Create root object.
+    bool isReference;
+    mpRootObject = createElementObject( *mpStream, isReference );
+
+    // Finish if we couldn't create the type.
+    if ( mpRootObject == NULL )
+        return NULL;
+
+    // Fetch children count.
+    mpStream->read( &mRootChildrenLeft );
+
+    // Finish if no children.
+    if ( mRootChildrenLeft == 0 )
+        return mpRootObject;
+
+    // Fetch the Taml children.
+    mpRootChildren = dynamic_cast<TamlChildren*>( mpRootObject );
+
+    // Is this a sim set?
+    if ( mpRootChildren == NULL )
+    {
+        // No, so warn.
+        Con::warnf("Taml: Child element found under parent but object cannot have children." );
+        mRootChildrenLeft = 0;
+        return mpRootObject;
+    }
+
+    // Fetch any container child class specifier.
+    mpRootContainerChildClass = mpRootObject->getClassRep()->getContainerChildClass( true );
+
+    return mpRootObject;
+}
+
+//-----------------------------------------------------------------------------
+
+bool TamlCompiledReader::readNextChild( void )
+{
+    // Debug Profiling.
+    PROFILE_SCOPE(TamlCompiledReader_ReadNextChild);
+
+    // Finish if there's nothing left to read.
+    if ( mRootChildrenLeft == 0 )
+        return false;
+
+    --mRootChildrenLeft;
+
+    // Parse child element, the rest are skipped if it failed.
+    if ( !parseChild( *mpStream, mpRootObject, mpRootChildren, mpRootContainerChildClass ) )
+        mRootChildrenLeft = 0;
+
+    return mRootChildrenLeft > 0;
+}
+
+//-----------------------------------------------------------------------------
+
+SimObject* TamlCompiledReader::endRoot( void )
+{
+    // Debug Profiling.
+    PROFILE_SCOPE(TamlCompiledReader_EndRoot);
+
+    SimObject* pSimObject = mpRootObject;
+
+    // Finish root object.
+    if ( pSimObject != NULL )
+        finishElementObject( *mpStream, pSimObject );
+
+    // Reset parse.
+    resetParse();
+
+    return pSimObject;
+}
+
+//-----------------------------------------------------------------------------
+
+void TamlCompiledReader::resetParse( void )
+{
+    // Debug Profiling.
+    PROFILE_SCOPE(TamlCompiledReader_ResetParse);
+
+    // Clear object reference map.
+    mObjectReferenceMap.clear();
+
+    // Clear class table.
+    mClasses.clear();
+    mFields.clear();
+
+    // Clear root state.
+    SAFE_DELETE( mpStream );
+    if ( mpBuffer != NULL )
+    {
+        dFree( mpBuffer );
+        mpBuffer = NULL;
+    }
+    mBufferSize = 0;
+    mpRootObject = NULL;
+    mpRootChildren = NULL;
+    mpRootContainerChildClass = NULL;
+    mRootChildrenLeft = 0;
+}
+
+//-----------------------------------------------------------------------------
+
+bool TamlCompiledReader::parseClasses( Stream& stream )
+{
+    // Debug Profiling.
+    PROFILE_SCOPE(TamlCompiledReader_ParseClasses);
+
+    // Read class count.
+    U32 classCount;
+    stream.read( &classCount );
+
+    // Iterate classes.
+    for ( U32 classIndex = 0; classIndex < classCount; ++classIndex )
+    {
+        // Read class name and layout hash.
+        StringTableEntry className = stream.readSTString();
+        U32 layoutHash;
+        stream.read( &layoutHash );
+
+        // Read field count.
+        U16 fieldCount;
+        stream.read( &fieldCount );
+
+        // Find the class, unknown classes fail when their objects are created.
+        AbstractClassRep* pClassRep = Taml::findType( className );
+
+        // Add the class.
+        mClasses.increment();
+        CompiledClass& compiledClass = mClasses.last();
+        compiledClass.mClassName = className;
+        compiledClass.mLayoutMatch = pClassRep != NULL &&
+            pClassRep->mFieldList.size() == (S32)fieldCount &&
+            TamlCompiledLayout::getLayoutHash( pClassRep ) == layoutHash;
+        compiledClass.mFirstField = (U32)mFields.size();
+        compiledClass.mFieldCount = fieldCount;
+
+        // Warn if the class changed since the file was compiled.
+        if ( pClassRep != NULL && !compiledClass.mLayoutMatch )
+            Con::warnf( "Taml: The fields of type '%s' have changed since the file was compiled, reading its fields by name.", className );
+
+        // Iterate fields.
+        for ( U16 fieldIndex = 0; fieldIndex < fieldCount; ++fieldIndex )
+        {
+            mFields.increment();
+            CompiledField& compiledField = mFields.last();
+
+            // Read field name and value kind.
+            compiledField.mFieldName = stream.readSTString();
+            stream.read( &compiledField.mValueKind );
+
+            // Resolve the field, by index if the layout is unchanged or otherwise by name.
+            if ( compiledClass.mLayoutMatch )
+                compiledField.mpField = &pClassRep->mFieldList[fieldIndex];
+            else if ( pClassRep != NULL )
+                compiledField.mpField = pClassRep->findField( compiledField.mFieldName );
+            else
+                compiledField.mpField = NULL;
+
+            // Fetch the field prefix.
+            compiledField.mFieldPrefix = StringTable->EmptyString;
+            if ( compiledField.mpField != NULL )
+            {
+                ConsoleBaseType* pConsoleBaseType = ConsoleBaseType::getType( compiledField.mpField->type );
+                if ( pConsoleBaseType != NULL )
+                    compiledField.mFieldPrefix = pConsoleBaseType->getTypePrefix();
+            }
+        }
+    }
+
+    // Fail if the class table is truncated.
+    if ( stream.getStatus() != Stream::Ok )
+    {
+        // Warn.
+        Con::warnf("Taml: Cannot read compiled file as its class table is invalid." );
+        return false;
+    }
+
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+
+SimObject* TamlCompiledReader::parseElement( Stream& stream )
+{
+    // Debug Profiling.
+    PROFILE_SCOPE(TamlCompiledReader_ParseElement);
+
+    // Create object.
+    bool isReference;
+    SimObject* pSimObject = createElementObject( stream, isReference );
+
+    // Finish if we couldn't create the type or it's a reference.
+    if ( pSimObject == NULL || isReference )
+        return pSimObject;
+
+    // Parse children.
+    parseChildren( stream, pSimObject );
+
+    // Finish object.
+    finishElementObject( stream, pSimObject );
+
+    // Return object.
+    return pSimObject;
+}
+
+//-----------------------------------------------------------------------------
+
+SimObject* TamlCompiledReader::createElementObject( Stream& stream, bool& isReference )
+{
+    // Debug Profiling.
+    PROFILE_SCOPE(TamlCompiledReader_CreateElementObject);
+
+    SimObject* pSimObject = NULL;
+
+    isReference = false;
+
+#ifdef TORQUE_DEBUG
+    // Format the type location.
+    char typeLocationBuffer[64];
+    dSprintf( typeLocationBuffer, sizeof(typeLocationBuffer), "Taml [format='compiled' offset=%u]", stream.getPosition() );
+#endif
+
+    // Fetch class index.
+    U16 classIndex;
+    stream.read( &classIndex );
+
+    // Is the class index valid?
+    if ( classIndex >= (U16)mClasses.size() )
+    {
+        // No, so warn.
+        Con::warnf( "Taml: Encountered an invalid class index of '%d'.", classIndex );
+        return NULL;
+    }
+
+    // Fetch class.
+    const CompiledClass& compiledClass = mClasses[classIndex];
+    StringTableEntry typeName = compiledClass.mClassName;
+
+    // Fetch object name.
+    StringTableEntry objectName = stream.readSTString();
+
+    // Read references.
+    U32 tamlRefId;
+    U32 tamlRefToId;
+    stream.read( &tamlRefId );
+    stream.read( &tamlRefToId );
+
+    // Do we have a reference to Id?
+    isReference = tamlRefToId != 0;
+    if ( isReference )
+    {
+        // Yes, so fetch reference.
+        typeObjectReferenceHash::iterator referenceItr = mObjectReferenceMap.find( tamlRefToId );
+
+        // Did we find the reference?
+        if ( referenceItr == mObjectReferenceMap.end() )
+        {
+            // No, so warn.
+            Con::warnf( "Taml: Could not find a reference Id of '%d'", tamlRefToId );
+            return NULL;
+        }
+
+        // Return object.
+        return referenceItr->value;
+    }
+
+#ifdef TORQUE_DEBUG
+    // Create type.
+    pSimObject = Taml::createType( typeName, mpTaml, typeLocationBuffer );
+#else
+    // Create type.
+    pSimObject = Taml::createType( typeName, mpTaml );
+#endif
+
+    // Finish if we couldn't create the type.
+    if ( pSimObject == NULL )
+        return NULL;
+
+    // Find Taml callbacks.
+    TamlCallbacks* pCallbacks = dynamic_cast<TamlCallbacks*>( pSimObject );
+
+    // Are there any Taml callbacks?
+    if ( pCallbacks != NULL )
+    {
+        // Yes, so call it.
+        mpTaml->tamlPreRead( pCallbacks );
+    }
+
+    // Parse attributes.
+    parseAttributes( stream, pSimObject, compiledClass );
+
+    // Does the object require a name?
+    if ( objectName == StringTable->EmptyString )
+    {
+        // No, so just register anonymously.
+        pSimObject->registerObject();
+    }
+    else
+    {
+        // Yes, so register a named object.
+        pSimObject->registerObject( objectName );
+
+        // Was the name assigned?
+        if ( pSimObject->getName() != objectName )
+        {
+            // No, so warn that the name was rejected.
+#ifdef TORQUE_DEBUG
+            Con::warnf( "Taml::parseElement() - Registered an instance of type '%s' but a request to name it '%s' was rejected.  This is typically because an object of that name already exists.  '%s'", typeName, objectName, typeLocationBuffer );
+#else
+            Con::warnf( "Taml::parseElement() - Registered an instance of type '%s' but a request to name it '%s' was rejected.  This is typically because an object of that name already exists.", typeName, objectName );
+#endif
+        }
+    }
+
+    // Do we have a reference Id?
+    if ( tamlRefId != 0 )
+    {
+        // Yes, so insert reference.
+        mObjectReferenceMap.insert( tamlRefId, pSimObject );
+    }
+
+    return pSimObject;
+}
+
+//-----------------------------------------------------------------------------
+
+void TamlCompiledReader::finishElementObject( Stream& stream, SimObject* pSimObject )
+{
+    // Find Taml callbacks.
+    TamlCallbacks* pCallbacks = dynamic_cast<TamlCallbacks*>( pSimObject );
+
+    // Parse custom elements.
+    TamlCustomNodes customProperties;
+    parseCustomElements( stream, pCallbacks, customProperties );
+
+    // Are there any Taml callbacks?
+    if ( pCallbacks != NULL )
+    {
+        // Yes, so call it.
+        mpTaml->tamlPostRead( pCallbacks, customProperties );
+    }
+}
+
+//-----------------------------------------------------------------------------
+
+void TamlCompiledReader::parseAttributes( Stream& stream, SimObject* pSimObject, const CompiledClass& compiledClass )
+{
+    // Debug Profiling.
+    PROFILE_SCOPE(TamlCompiledReader_ParseAttributes);
+
+    // Sanity!
+    AssertFatal( pSimObject != NULL, "Taml: Cannot parse attributes on a NULL object." );
+
+    // Fetch attribute count.
+    U32 attributeCount;
+    stream.read( &attributeCount );
+
+    char valueBuffer[4096];
+
+    // Iterate attributes.
+    for ( U32 index = 0; index < attributeCount; ++index )
+    {
+        // Fetch field index.
+        U16 fieldIndex;
+        stream.read( &fieldIndex );
+
+        // Is this a dynamic field?
+        if ( fieldIndex == TAML_COMPILED_DYNAMIC_FIELD )
+        {
+            // Yes, so set it by name.
+            StringTableEntry attributeName = stream.readSTString();
+            stream.readLongString( 4096, valueBuffer );
+            pSimObject->setPrefixedDataField( attributeName, NULL, valueBuffer );
+            continue;
+        }
+
+        // Is the field index valid?
+        if ( fieldIndex >= compiledClass.mFieldCount )
+        {
+            // No, so warn and skip the rest as they can't be read.
+            Con::warnf( "Taml: Encountered an invalid field index of '%d' on type '%s'.", fieldIndex, compiledClass.mClassName );
+            return;
+        }
+
+        // Fetch field.
+        const CompiledField& compiledField = mFields[compiledClass.mFirstField + fieldIndex];
+
+        // Is the value stored natively?
+        if ( compiledField.mValueKind != TamlCompiledLayout::StringValue )
+        {
+            // Yes, so read it.
+            F64 value;
+            if ( compiledField.mValueKind == TamlCompiledLayout::S32Value )
+            {
+                S32 nativeValue;
+                stream.read( &nativeValue );
+                value = nativeValue;
+            }
+            else if ( compiledField.mValueKind == TamlCompiledLayout::F32Value )
+            {
+                F32 nativeValue;
+                stream.read( &nativeValue );
+                value = nativeValue;
+            }
+            else
+            {
+                bool nativeValue;
+                stream.read( &nativeValue );
+                value = nativeValue ? 1.0 : 0.0;
+            }
+
+            // Write the value in place if the layout is unchanged.
+            if ( compiledClass.mLayoutMatch && pSimObject->setNumericDataField( compiledField.mpField, compiledField.mFieldName, NULL, value, NULL ) )
+                continue;
+
+            // Otherwise set it as a string.
+            if ( compiledField.mValueKind == TamlCompiledLayout::S32Value )
+                dSprintf( valueBuffer, sizeof(valueBuffer), "%d", (S32)value );
+            else if ( compiledField.mValueKind == TamlCompiledLayout::F32Value )
+                dSprintf( valueBuffer, sizeof(valueBuffer), "%.9g", value );
+            else
+                dStrcpy( valueBuffer, value != 0.0 ? "true" : "false" );
+        }
+        else
+        {
+            // No, so read the string.
+            stream.readLongString( 4096, valueBuffer );
+        }
+
+        // Set the field by name if it's no longer a static field.
+        if ( compiledField.mpField == NULL )
+        {
+            pSimObject->setPrefixedDataField( compiledField.mFieldName, NULL, valueBuffer );
+            continue;
+        }
+
+        // Skip any field prefix.
+        const char* pValue = valueBuffer;
+        if ( *pValue != 0 && compiledField.mFieldPrefix != StringTable->EmptyString )
+        {
+            const U32 fieldPrefixLength = dStrlen( compiledField.mFieldPrefix );
+            if ( dStrnicmp( pValue, compiledField.mFieldPrefix, fieldPrefixLength ) == 0 )
+                pValue += fieldPrefixLength;
+        }
+
+        // Set the resolved field.
+        pSimObject->setDataField( compiledField.mpField, compiledField.mFieldName, NULL, pValue );
+    }
+}
+
+//-----------------------------------------------------------------------------
+
+void TamlCompiledReader::parseChildren( Stream& stream, SimObject* pSimObject )
+{
+    // Debug Profiling.
+    PROFILE_SCOPE(TamlCompiledReader_ParseChildren);
+
+    // Sanity!
+    AssertFatal( pSimObject != NULL, "Taml: Cannot parse children on a NULL object." );
+
+    // Fetch children count.
+    U32 childrenCount;
+    stream.read( &childrenCount );
+
+    // Finish if no children.
+    if ( childrenCount == 0 )
+        return;
+
+    // Fetch the Taml children.
+    TamlChildren* pChildren = dynamic_cast<TamlChildren*>( pSimObject );
+
+    // Is this a sim set?
+    if ( pChildren == NULL )
+    {
+        // No, so warn.
+        Con::warnf("Taml: Child element found under parent but object cannot have children." );
+        return;
+    }
+
+    // Fetch any container child class specifier.
+    AbstractClassRep* pContainerChildClass = pSimObject->getClassRep()->getContainerChildClass( true );
+
+    // Iterate children.
+    for ( U32 index = 0; index < childrenCount; ++ index )
+    {
+        // Parse child element, finish if it failed.
+        if ( !parseChild( stream, pSimObject, pChildren, pContainerChildClass ) )
+            return;
+    }
+}
+
+//-----------------------------------------------------------------------------
+
+bool TamlCompiledReader::parseChild( Stream& stream, SimObject* pSimObject, TamlChildren* pChildren, AbstractClassRep* pContainerChildClass )
+{
+    // Parse child element.
+    SimObject* pChildSimObject = parseElement( stream );
+
+    // Fail if child failed.
+    if ( pChildSimObject == NULL )
+        return false;
+
+    // Do we have a container child class?
+    if ( pContainerChildClass != NULL )
+    {
+        // Yes, so is the child object the correctly derived type?
+        if ( !pChildSimObject->getClassRep()->isClass( pContainerChildClass ) )
+        {
+            // No, so warn.
+            Con::warnf("Taml: Child element '%s' found under parent '%s' but object is restricted to children of type '%s'.",
+                pChildSimObject->getClassName(),
+                pSimObject->getClassName(),
+                pContainerChildClass->getClassName() );
+
+            // NOTE: We can't delete the object as it may be referenced elsewhere!
+            pChildSimObject = NULL;
+
+            // Skip.
+            return true;
+        }
+    }
+
+    // Add child.
+    pChildren->addTamlChild( pChildSimObject );
+
+    // Find Taml callbacks for child.
+    TamlCallbacks* pChildCallbacks = dynamic_cast<TamlCallbacks*>( pChildSimObject );
+
+    // Do we have callbacks on the child?
+    if ( pChildCallbacks != NULL )
+    {
+        // Yes, so perform callback.
+        mpTaml->tamlAddParent( pChildCallbacks, pSimObject );
+    }
+
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+
+void TamlCompiledReader::parseCustomElements( Stream& stream, TamlCallbacks* pCallbacks, TamlCustomNodes& customNodes )
+{
+    // Debug Profiling.
+    PROFILE_SCOPE(TamlCompiledReader_ParseCustomElement);
+
+    // Read custom node count.
+    U32 customNodeCount;
+    stream.read( &customNodeCount );
+
+    // Finish if no custom nodes.
+    if ( customNodeCount == 0 )
+        return;
+
+    // Iterate custom nodes.
+    for ( U32 nodeIndex = 0; nodeIndex < customNodeCount; ++nodeIndex )
+    {
+        //Read custom node name.
+        StringTableEntry nodeName = stream.readSTString();
+
+        // Add custom node.
+        TamlCustomNode* pCustomNode = customNodes.addNode( nodeName );
+
+        // Read child node count.
+        U32 childNodeCount;
+        stream.read( &childNodeCount );
+
+        // Parse children nodes.
+        for( U32 childIndex = 0; childIndex < childNodeCount; ++childIndex )
+            parseCustomNode( stream, pCustomNode );
+    }
+
+    // Do we have callbacks?
+    if ( pCallbacks == NULL )
+    {
+        // No, so warn.
+        Con::warnf( "Taml: Encountered custom data but object does not support custom data." );
+        return;
+    }
+
+    // Custom read callback.
+    mpTaml->tamlCustomRead( pCallbacks, customNodes );
+}
+
+//-----------------------------------------------------------------------------
+
+void TamlCompiledReader::parseCustomNode( Stream& stream, TamlCustomNode* pCustomNode )
+{
+    // Fetch if a proxy object.
+    bool isProxyObject;
+    stream.read( &isProxyObject );
+
+    // Is this a proxy object?
+    if ( isProxyObject )
+    {
+        // Yes, so parse proxy object.
+        SimObject* pProxyObject = parseElement( stream );
+
+        // Add child node.
+        pCustomNode->addNode( pProxyObject );
+
+        return;
+    }
+
+    // No, so read custom node name.
+    StringTableEntry nodeName = stream.readSTString();
+
+    // Add child node.
+    TamlCustomNode* pChildNode = pCustomNode->addNode( nodeName );
+
+    // Read child node text.
+    char childNodeTextBuffer[MAX_TAML_NODE_FIELDVALUE_LENGTH];
+    stream.readLongString( MAX_TAML_NODE_FIELDVALUE_LENGTH, childNodeTextBuffer );
+    pChildNode->setNodeText( childNodeTextBuffer );
+
+    // Read child node count.
+    U32 childNodeCount;
+    stream.read( &childNodeCount );
+
+    // Parse children nodes.
+    for( U32 childIndex = 0; childIndex < childNodeCount; ++childIndex )
+        parseCustomNode( stream, pChildNode );
+
+    // Read child field count.
+    U32 childFieldCount;
+    stream.read( &childFieldCount );
+
+    // Parse child fields.
+    for( U32 childFieldIndex = 0; childFieldIndex < childFieldCount; ++childFieldIndex )
+    {
+        // Read field name.
+        StringTableEntry fieldName = stream.readSTString();
+
+        // Read field value.
+        char valueBuffer[MAX_TAML_NODE_FIELDVALUE_LENGTH];
+        stream.readLongString( MAX_TAML_NODE_FIELDVALUE_LENGTH, valueBuffer );
+
+        // Add field.
+        pChildNode->addField( fieldName, valueBuffer );
+    }
+}
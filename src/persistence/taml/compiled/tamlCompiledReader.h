@@ -0,0 +1,116 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2013 GarageGames, LLC
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//-----------------------------------------------------------------------------
+
+#ifndef _TAML_COMPILEDREADER_H_
+#define _TAML_COMPILEDREADER_H_
+
+#ifndef HASHTABLE_H
+#include "collection/hashTable.h"
+#endif
+
+#ifndef _TAML_READER_H_
+#include "persistence/taml/tamlReader.h"
+#endif
+
+//-----------------------------------------------------------------------------
+
+class MemStream;
+
+//-----------------------------------------------------------------------------
+
+/// @ingroup tamlGroup
+/// @see tamlGroup
+class TamlCompiledReader : public TamlReader
+{
+public:
+    TamlCompiledReader( Taml* pTaml ) :
+        mpTaml( pTaml ),
+        mVersionId( 0 ),
+        mpBuffer( NULL ),
+        mBufferSize( 0 ),
+        mpStream( NULL ),
+        mpRootObject( NULL ),
+        mpRootChildren( NULL ),
+        mpRootContainerChildClass( NULL ),
+        mRootChildrenLeft( 0 )
+    {
+    }
+
+    virtual ~TamlCompiledReader() { resetParse(); }
+
+    /// Read phases.
+    virtual bool parseDocument( FileStream& stream );
+    virtual SimObject* beginRoot( void );
+    virtual bool readNextChild( void );
+    virtual SimObject* endRoot( void );
+
+private:
+    /// A field of a class in the class table.
+    struct CompiledField
+    {
+        StringTableEntry                mFieldName;
+        const AbstractClassRep::Field*  mpField;
+        StringTableEntry                mFieldPrefix;
+        U8                              mValueKind;
+    };
+
+    /// A class in the class table, its fields are a range of the field table.
+    struct CompiledClass
+    {
+        StringTableEntry        mClassName;
+        bool                    mLayoutMatch;
+        U32                     mFirstField;
+        U32                     mFieldCount;
+    };
+
+    Taml* mpTaml;
+
+    typedef HashMap<SimObjectId, SimObject*> typeObjectReferenceHash;
+
+    typeObjectReferenceHash mObjectReferenceMap;
+
+    Vector<CompiledClass>   mClasses;
+    Vector<CompiledField>   mFields;
+    U32                     mVersionId;
+    U8*                     mpBuffer;
+    U32                     mBufferSize;
+    MemStream*              mpStream;
+    SimObject*              mpRootObject;
+    TamlChildren*           mpRootChildren;
+    AbstractClassRep*       mpRootContainerChildClass;
+    U32                     mRootChildrenLeft;
+
+private:
+    void resetParse( void );
+
+    bool parseClasses( Stream& stream );
+    SimObject* parseElement( Stream& stream );
+    SimObject* createElementObject( Stream& stream, bool& isReference );
+    void finishElementObject( Stream& stream, SimObject* pSimObject );
+    void parseAttributes( Stream& stream, SimObject* pSimObject, const CompiledClass& compiledClass );
+    void parseChildren( Stream& stream, SimObject* pSimObject );
+    bool parseChild( Stream& stream, SimObject* pSimObject, TamlChildren* pChildren, AbstractClassRep* pContainerChildClass );
+    void parseCustomElements( Stream& stream, TamlCallbacks* pCallbacks, TamlCustomNodes& customNodes );
+    void parseCustomNode( Stream& stream, TamlCustomNode* pCustomNode );
+};
+
+#endif // _TAML_COMPILEDREADER_H_
@@ -0,0 +1,413 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2013 GarageGames, LLC
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//-----------------------------------------------------------------------------
+
+#include "persistence/taml/compiled/tamlCompiledWriter.h"
+
+#ifndef _TAML_COMPILED_LAYOUT_H_
+#include "persistence/taml/compiled/tamlCompiledLayout.h"
+#endif
+
+#ifndef _ZIPSUBSTREAM_H_
+#include "io/zip/zipSubStream.h"
+#endif
+
+// Debug Profiling.
+#include "debug/profiler.h"
+
+//-----------------------------------------------------------------------------
+
+bool TamlCompiledWriter::write( FileStream& stream, const TamlWriteNode* pTamlWriteNode, const bool compressed )
+{
+    // Debug Profiling.
+    PROFILE_SCOPE(TamlCompiledWriter_Write);
+
+    // Compile the class table.
+    mClassIndices.clear();
+    mClasses.clear();
+    compileClasses( pTamlWriteNode );
+
+    // Write Taml signature.
+    stream.writeString( StringTable->insert( TAML_COMPILED_SIGNATURE ) );
+
+    // Write version Id.
+    stream.write( mVersionId );
+
+    // Write compressed flag.
+    stream.write( compressed );
+
+    // Are we compressed?
+    if ( compressed )
+    {
+        // yes, so attach zip stream.
+        ZipSubWStream zipStream;
+        zipStream.attachStream( &stream );
+
+        // Write classes and element.
+        writeClasses( zipStream );
+        writeElement( zipStream, pTamlWriteNode );
+
+        // Detach zip stream.
+        zipStream.detachStream();
+    }
+    else
+    {
+        // No, so write classes and element.
+        writeClasses( stream );
+        writeElement( stream, pTamlWriteNode );
+    }
+
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+
+void TamlCompiledWriter::compileClasses( const TamlWriteNode* pTamlWriteNode )
+{
+    // Fetch class.
+    AbstractClassRep* pClassRep = pTamlWriteNode->mpSimObject->getClassRep();
+
+    // Add the class if it's not been seen yet.
+    if ( mClassIndices.find( pClassRep ) == mClassIndices.end() )
+    {
+        mClassIndices.insert( pClassRep, (U32)mClasses.size() );
+        mClasses.push_back( pClassRep );
+    }
+
+    // Finish if this is a reference as it's compiled elsewhere.
+    if ( pTamlWriteNode->mRefToNode != NULL )
+        return;
+
+    // Compile children classes.
+    if ( pTamlWriteNode->mChildren != NULL )
+    {
+        for( Vector<TamlWriteNode*>::iterator itr = pTamlWriteNode->mChildren->begin(); itr != pTamlWriteNode->mChildren->end(); ++itr )
+            compileClasses( *itr );
+    }
+
+    // Compile proxy object classes.
+    const TamlCustomNodeVector& nodes = pTamlWriteNode->mCustomNodes.getNodes();
+    for( TamlCustomNodeVector::const_iterator customNodesItr = nodes.begin(); customNodesItr != nodes.end(); ++customNodesItr )
+    {
+        const TamlCustomNodeVector& nodeChildren = (*customNodesItr)->getChildren();
+        for( TamlCustomNodeVector::const_iterator childNodeItr = nodeChildren.begin(); childNodeItr != nodeChildren.end(); ++childNodeItr )
+            compileCustomNodeClasses( *childNodeItr );
+    }
+}
+
+//-----------------------------------------------------------------------------
+
+void TamlCompiledWriter::compileCustomNodeClasses( const TamlCustomNode* pCustomNode )
+{
+    // Is the node a proxy object?
+    if ( pCustomNode->isProxyObject() )
+    {
+        // Yes, so compile its classes.
+        compileClasses( pCustomNode->getProxyWriteNode() );
+        return;
+    }
+
+    // No, so compile children nodes.
+    const TamlCustomNodeVector& nodeChildren = pCustomNode->getChildren();
+    for( TamlCustomNodeVector::const_iterator childNodeItr = nodeChildren.begin(); childNodeItr != nodeChildren.end(); ++childNodeItr )
+        compileCustomNodeClasses( *childNodeItr );
+}
+
+//-----------------------------------------------------------------------------
+
+void TamlCompiledWriter::writeClasses( Stream& stream )
+{
+    // Debug Profiling.
+    PROFILE_SCOPE(TamlCompiledWriter_WriteClasses);
+
+    // Write class count.
+    stream.write( (U32)mClasses.size() );
+
+    // Iterate classes.
+    for( Vector<AbstractClassRep*>::iterator itr = mClasses.begin(); itr != mClasses.end(); ++itr )
+    {
+        // Fetch class.
+        AbstractClassRep* pClassRep = *itr;
+
+        // Write class name and layout hash.
+        stream.writeString( pClassRep->getClassName() );
+        stream.write( TamlCompiledLayout::getLayoutHash( pClassRep ) );
+
+        // Fetch field list.
+        const AbstractClassRep::FieldList& fieldList = pClassRep->mFieldList;
+
+        // Sanity!
+        AssertFatal( fieldList.size() < TAML_COMPILED_DYNAMIC_FIELD, "TamlCompiledWriter::writeClasses() - Too many fields to index." );
+
+        // Write fields so they can still be found by name if the layout changes.
+        stream.write( (U16)fieldList.size() );
+        for( S32 index = 0; index < fieldList.size(); ++index )
+        {
+            const AbstractClassRep::Field& field = fieldList[index];
+            stream.writeString( field.pFieldname );
+            stream.write( (U8)TamlCompiledLayout::getValueKind( &field ) );
+        }
+    }
+}
+
+//-----------------------------------------------------------------------------
+
+void TamlCompiledWriter::writeElement( Stream& stream, const TamlWriteNode* pTamlWriteNode )
+{
+    // Debug Profiling.
+    PROFILE_SCOPE(TamlCompiledWriter_WriteElement);
+
+    // Fetch object.
+    SimObject* pSimObject = pTamlWriteNode->mpSimObject;
+
+    // Write class index.
+    stream.write( (U16)mClassIndices.find( pSimObject->getClassRep() )->value );
+
+    // Fetch object name.
+    const char* pObjectName = pTamlWriteNode->mpObjectName;
+
+    // Write object name.
+    stream.writeString( pObjectName != NULL ? pObjectName : StringTable->EmptyString );
+
+    // Fetch reference Id.
+    const U32 tamlRefId = pTamlWriteNode->mRefId;
+
+    // Write reference Id.
+    stream.write( tamlRefId );
+
+    // Do we have a reference to node?
+    if ( pTamlWriteNode->mRefToNode != NULL )
+    {
+        // Yes, so fetch reference to Id.
+        const U32 tamlRefToId = pTamlWriteNode->mRefToNode->mRefId;
+
+        // Sanity!
+        AssertFatal( tamlRefToId != 0, "Taml: Invalid reference to Id." );
+
+        // Write reference to Id.
+        stream.write( tamlRefToId );
+
+        // Finished.
+        return;
+    }
+
+    // No, so write no reference to Id.
+    stream.write( 0 );
+
+    // Write attributes.
+    writeAttributes( stream, pTamlWriteNode );
+
+    // Write children.
+    writeChildren( stream, pTamlWriteNode );
+
+    // Write custom elements.
+    writeCustomElements( stream, pTamlWriteNode );
+}
+
+//-----------------------------------------------------------------------------
+
+void TamlCompiledWriter::writeAttributes( Stream& stream, const TamlWriteNode* pTamlWriteNode )
+{
+    // Debug Profiling.
+    PROFILE_SCOPE(TamlCompiledWriter_WriteAttributes);
+
+    // Fetch fields.
+    const Vector<TamlWriteNode::FieldValuePair*>& fields = pTamlWriteNode->mFields;
+
+    // Write attribute count.
+    stream.write( (U32)fields.size() );
+
+    // Finish if no fields.
+    if ( fields.size() == 0 )
+        return;
+
+    // Fetch object and its field list.
+    SimObject* pSimObject = pTamlWriteNode->mpSimObject;
+    AbstractClassRep* pClassRep = pSimObject->getClassRep();
+    const AbstractClassRep::Field* pFirstField = pClassRep->mFieldList.address();
+
+    // Iterate fields.
+    for( Vector<TamlWriteNode::FieldValuePair*>::const_iterator itr = fields.begin(); itr != fields.end(); ++itr )
+    {
+        // Fetch field/value pair.
+        TamlWriteNode::FieldValuePair* pFieldValue = (*itr);
+
+        // Find the static field.
+        const AbstractClassRep::Field* pField = pClassRep->findField( pFieldValue->mName );
+
+        // Is this a dynamic field?
+        if ( pField == NULL )
+        {
+            // Yes, so write it by name.
+            stream.write( (U16)TAML_COMPILED_DYNAMIC_FIELD );
+            stream.writeString( pFieldValue->mName );
+            stream.writeLongString( 4096, pFieldValue->mpValue );
+            continue;
+        }
+
+        // No, so write the field index.
+        stream.write( (U16)(pField - pFirstField) );
+
+        // Fetch how the value is stored.
+        const TamlCompiledLayout::ValueKind valueKind = TamlCompiledLayout::getValueKind( pField );
+
+        // Write strings as they are.
+        if ( valueKind == TamlCompiledLayout::StringValue )
+        {
+            stream.writeLongString( 4096, pFieldValue->mpValue );
+            continue;
+        }
+
+        // Read numeric values directly, falling back to the compiled string.
+        F64 value;
+        if ( !pSimObject->getNumericDataField( pField, NULL, value ) )
+            value = valueKind == TamlCompiledLayout::BoolValue ? (dAtob( pFieldValue->mpValue ) ? 1.0 : 0.0) : dAtof( pFieldValue->mpValue );
+
+        // Write native value.
+        if ( valueKind == TamlCompiledLayout::S32Value )
+            stream.write( (S32)value );
+        else if ( valueKind == TamlCompiledLayout::F32Value )
+            stream.write( (F32)value );
+        else
+            stream.write( value != 0.0 );
+    }
+}
+
+//-----------------------------------------------------------------------------
+
+void TamlCompiledWriter::writeChildren( Stream& stream, const TamlWriteNode* pTamlWriteNode )
+{
+    // Debug Profiling.
+    PROFILE_SCOPE(TamlCompiledWriter_WriteChildren);
+
+    // Fetch children.
+    Vector<TamlWriteNode*>* pChildren = pTamlWriteNode->mChildren;
+
+    // Do we have any children?
+    if ( pChildren == NULL )
+    {
+        // No, so write no children.
+        stream.write( (U32)0 );
+        return;
+    }
+
+    // Write children count.
+    stream.write( (U32)pChildren->size() );
+
+    // Iterate children.
+    for( Vector<TamlWriteNode*>::iterator itr = pChildren->begin(); itr != pChildren->end(); ++itr )
+    {
+        // Write child.
+        writeElement( stream, (*itr) );
+    }
+}
+
+//-----------------------------------------------------------------------------
+
+void TamlCompiledWriter::writeCustomElements( Stream& stream, const TamlWriteNode* pTamlWriteNode )
+{
+    // Debug Profiling.
+    PROFILE_SCOPE(TamlCompiledWriter_WriteCustomElements);
+
+    // Fetch custom nodes.
+    const TamlCustomNodeVector& nodes = pTamlWriteNode->mCustomNodes.getNodes();
+
+    // Write custom node count.
+    stream.write( (U32)nodes.size() );
+
+    // Iterate custom nodes.
+    for( TamlCustomNodeVector::const_iterator customNodesItr = nodes.begin(); customNodesItr != nodes.end(); ++customNodesItr )
+    {
+        // Fetch the custom node.
+        TamlCustomNode* pCustomNode = *customNodesItr;
+
+        // Write custom node name.
+        stream.writeString( pCustomNode->getNodeName() );
+
+        // Fetch node children.
+        const TamlCustomNodeVector& nodeChildren = pCustomNode->getChildren();
+
+        // Write custom node children count.
+        stream.write( (U32)nodeChildren.size() );
+
+        // Iterate children nodes.
+        for( TamlCustomNodeVector::const_iterator childNodeItr = nodeChildren.begin(); childNodeItr != nodeChildren.end(); ++childNodeItr )
+        {
+            // Write the custom node.
+            writeCustomNode( stream, *childNodeItr );
+        }
+    }
+}
+
+//-----------------------------------------------------------------------------
+
+void TamlCompiledWriter::writeCustomNode( Stream& stream, const TamlCustomNode* pCustomNode )
+{
+    // Is the node a proxy object?
+    if ( pCustomNode->isProxyObject() )
+    {
+        // Yes, so flag as proxy object.
+        stream.write( true );
+
+        // Write the element.
+        writeElement( stream, pCustomNode->getProxyWriteNode() );
+        return;
+    }
+
+    // No, so flag as custom node.
+    stream.write( false );
+
+    // Write custom node name.
+    stream.writeString( pCustomNode->getNodeName() );
+
+    // Write custom node text.
+    stream.writeLongString( MAX_TAML_NODE_FIELDVALUE_LENGTH, pCustomNode->getNodeTextField().getFieldValue() );
+
+    // Fetch node children.
+    const TamlCustomNodeVector& nodeChildren = pCustomNode->getChildren();
+
+    // Write custom node count.
+    stream.write( (U32)nodeChildren.size() );
+
+    // Iterate children nodes.
+    for( TamlCustomNodeVector::const_iterator childNodeItr = nodeChildren.begin(); childNodeItr != nodeChildren.end(); ++childNodeItr )
+    {
+        // Write the custom node.
+        writeCustomNode( stream, *childNodeItr );
+    }
+
+    // Fetch fields.
+    const TamlCustomFieldVector& fields = pCustomNode->getFields();
+
+    // Write custom field count.
+    stream.write( (U32)fields.size() );
+
+    // Iterate fields.
+    for ( TamlCustomFieldVector::const_iterator fieldItr = fields.begin(); fieldItr != fields.end(); ++fieldItr )
+    {
+        // Fetch node field.
+        const TamlCustomField* pField = *fieldItr;
+
+        // Write the node field.
+        stream.writeString( pField->getFieldName() );
+        stream.writeLongString( MAX_TAML_NODE_FIELDVALUE_LENGTH, pField->getFieldValue() );
+    }
+}
@@ -24,43 +24,129 @@
 #include "persistence/taml/json/tamlJSONWriter.h"
 #include "io/fileStream.h"
 #include "string/stringUnit.h"
-#include "memory/frameAllocator.h"
 
 // Debug Profiling.
 #include "debug/profiler.h"
 
 //-----------------------------------------------------------------------------
 
-SimObject* TamlJSONReader::read( FileStream& stream )
+bool TamlJSONReader::parseDocument( FileStream& stream )
 {
     // Debug Profiling.
-    PROFILE_SCOPE(TamlJSONReader_Read);
+    PROFILE_SCOPE(TamlJSONReader_ParseDocument);
    
     // Read JSON file.
+    // NOTE: The frame allocator isn't thread-safe so the text is heap allocated.
     const U32 streamSize = stream.getStreamSize();
-    FrameTemp<char> jsonText( streamSize + 1 );
-    if ( !stream.read( streamSize, jsonText ) )
+    char* pJsonText = (char*)dMalloc( streamSize + 1 );
+    if ( !stream.read( streamSize, pJsonText ) )
     {
         // Warn!
         Con::warnf("TamlJSONReader::read() -  Could not load Taml JSON file from stream.");
-        return NULL;
+        dFree( pJsonText );
+        return false;
     }
-    jsonText[streamSize] = NULL;
+    pJsonText[streamSize] = '\0';
 
     // Create JSON document.
-    rapidjson::Document document;
-    document.Parse<0>( jsonText );
+    mpDocument = new rapidjson::Document();
+    mpDocument->Parse<0>( pJsonText );
+
+    // The document keeps its own copy of the strings.
+    dFree( pJsonText );
 
     // Check the document is valid.
-    if ( document.GetType() != rapidjson::kObjectType )
+    if ( mpDocument->GetType() != rapidjson::kObjectType || mpDocument->MemberBegin() == mpDocument->MemberEnd() )
     {
         // Warn!
         Con::warnf("TamlJSONReader::read() -  Load Taml JSON file from stream but was invalid.");
+        resetParse();
+        return false;
+    }
+
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+
+SimObject* TamlJSONReader::beginRoot( void )
+{
+    // Debug Profiling.
+    PROFILE_SCOPE(TamlJSONReader_BeginRoot);
+
+    // Finish if there's no document.
+    if ( mpDocument == NULL )
+        return NULL;
+
+    // Fetch root member.
+    rapidjson::Value::ConstMemberIterator memberItr = mpDocument->MemberBegin();
+
+    // Fetch name and value.
+    const rapidjson::Value& typeName = memberItr->name;
+    const rapidjson::Value& typeValue = memberItr->value;
+
+    // Is value an object?
+    if ( !typeValue.IsObject() )
+    {
+        // No, so warn.
+        Con::warnf( "TamlJSONReader::parseType() -  Cannot process type '%s' as it is not an object.", typeName.GetString() );
         return NULL;
     }
-    
-    // Parse root value.
-    SimObject* pSimObject = parseType( document.MemberBegin() );
+
+    // Fetch reference to Id.
+    const U32 tamlRefToId = getTamlRefToId( typeValue );
+
+    // Do we have a reference to Id?
+    if ( tamlRefToId != 0 )
+    {
+        // Yes, so warn as there's nothing the root could refer to.
+        Con::warnf( "TamlJSONReader::parseType() -  Could not find a reference Id of '%d'", tamlRefToId );
+        return NULL;
+    }
+
+    // Create root object.
+    mpRootObject = createTypeObject( getDemangledName( typeName.GetString() ), typeValue );
+
+    // Finish if we couldn't create the type.
+    if ( mpRootObject == NULL )
+        return NULL;
+
+    // Fetch the children and custom node members.
+    mRootMemberItr = typeValue.MemberBegin();
+    mRootMemberEnd = typeValue.MemberEnd();
+
+    return mpRootObject;
+}
+
+//-----------------------------------------------------------------------------
+
+bool TamlJSONReader::readNextChild( void )
+{
+    // Debug Profiling.
+    PROFILE_SCOPE(TamlJSONReader_ReadNextChild);
+
+    // Finish if there's nothing left to read.
+    if ( mpRootObject == NULL || mRootMemberItr == mRootMemberEnd )
+        return false;
+
+    // Parse member.
+    parseObjectMember( mRootMemberItr, mpRootObject, mRootCustomNodes );
+
+    return ++mRootMemberItr != mRootMemberEnd;
+}
+
+//-----------------------------------------------------------------------------
+
+SimObject* TamlJSONReader::endRoot( void )
+{
+    // Debug Profiling.
+    PROFILE_SCOPE(TamlJSONReader_EndRoot);
+
+    SimObject* pSimObject = mpRootObject;
+
+    // Finish root object.
+    if ( pSimObject != NULL )
+        finishTypeObject( pSimObject, mRootCustomNodes );
 
     // Reset parse.
     resetParse();
@@ -77,6 +163,13 @@ void TamlJSONReader::resetParse( void )
 
     // Clear object reference map.
     mObjectReferenceMap.clear();
+
+    // Clear root state.
+    SAFE_DELETE( mpDocument );
+    mpRootObject = NULL;
+    mRootMemberItr = NULL;
+    mRootMemberEnd = NULL;
+    mRootCustomNodes.resetState();
 }
 
 //-----------------------------------------------------------------------------
@@ -122,7 +215,37 @@ SimObject* TamlJSONReader::parseType( const rapidjson::Value::ConstMemberIterato
         return referenceItr->value;
     }
 
-    // No, so fetch reference Id.
+    // Create object.
+    SimObject* pSimObject = createTypeObject( engineTypeName, typeValue );
+
+    // Finish if we couldn't create the type.
+    if ( pSimObject == NULL )
+        return NULL;
+
+    TamlCustomNodes customNodes;
+
+    // Parse children and custom node members.
+    for( rapidjson::Value::ConstMemberIterator objectMemberItr = typeValue.MemberBegin(); objectMemberItr != typeValue.MemberEnd(); ++objectMemberItr )
+    {
+        // Parse member.
+        parseObjectMember( objectMemberItr, pSimObject, customNodes );
+    }
+
+    // Finish object.
+    finishTypeObject( pSimObject, customNodes );
+
+    // Return object.
+    return pSimObject;
+}
+
+//-----------------------------------------------------------------------------
+
+SimObject* TamlJSONReader::createTypeObject( StringTableEntry engineTypeName, const rapidjson::Value& typeValue )
+{
+    // Debug Profiling.
+    PROFILE_SCOPE(TamlJSONReader_CreateTypeObject);
+
+    // Fetch reference Id.
     const U32 tamlRefId = getTamlRefId( typeValue );
 
     // Create type.
@@ -135,8 +258,6 @@ SimObject* TamlJSONReader::parseType( const rapidjson::Value::ConstMemberIterato
     // Find Taml callbacks.
     TamlCallbacks* pCallbacks = dynamic_cast<TamlCallbacks*>( pSimObject );
 
-    TamlCustomNodes customNodes;
-
     // Are there any Taml callbacks?
     if ( pCallbacks != NULL )
     {
@@ -188,41 +309,49 @@ SimObject* TamlJSONReader::parseType( const rapidjson::Value::ConstMemberIterato
         mObjectReferenceMap.insert( tamlRefId, pSimObject );
     }
 
-    // Parse children and custom node members.
-    for( rapidjson::Value::ConstMemberIterator objectMemberItr = typeValue.MemberBegin(); objectMemberItr != typeValue.MemberEnd(); ++objectMemberItr )
-    {
-        // Fetch name and value.
-        const rapidjson::Value& objectName = objectMemberItr->name;
-        const rapidjson::Value& objectValue = objectMemberItr->value;
-        
-        // Skip if not an object.
-        if ( !objectValue.IsObject() )
-            continue;
+    return pSimObject;
+}
 
-        // Find the period character in the name.
-        const char* pPeriod = dStrchr( objectName.GetString(), '.' );
+//-----------------------------------------------------------------------------
 
-        // Did we find the period?
-        if ( pPeriod == NULL )
-        {
-            // No, so parse child object.
-            parseChild( objectMemberItr, pSimObject );
-            continue;
-        }
+inline void TamlJSONReader::parseObjectMember( rapidjson::Value::ConstMemberIterator& memberItr, SimObject* pSimObject, TamlCustomNodes& customNodes )
+{
+    // Fetch name and value.
+    const rapidjson::Value& objectName = memberItr->name;
+    const rapidjson::Value& objectValue = memberItr->value;
+    
+    // Skip if not an object.
+    if ( !objectValue.IsObject() )
+        return;
+
+    // Find the period character in the name.
+    const char* pPeriod = dStrchr( objectName.GetString(), '.' );
 
-        // Yes, so parse custom object.
-        parseCustom( objectMemberItr, pSimObject, pPeriod+1, customNodes );
+    // Did we find the period?
+    if ( pPeriod == NULL )
+    {
+        // No, so parse child object.
+        parseChild( memberItr, pSimObject );
+        return;
     }
 
+    // Yes, so parse custom object.
+    parseCustom( memberItr, pSimObject, pPeriod+1, customNodes );
+}
+
+//-----------------------------------------------------------------------------
+
+void TamlJSONReader::finishTypeObject( SimObject* pSimObject, TamlCustomNodes& customNodes )
+{
+    // Find Taml callbacks.
+    TamlCallbacks* pCallbacks = dynamic_cast<TamlCallbacks*>( pSimObject );
+
     // Call custom read.
     if ( pCallbacks )
     {
         mpTaml->tamlCustomRead( pCallbacks, customNodes );
         mpTaml->tamlPostRead( pCallbacks, customNodes );
     }
-
-    // Return object.
-    return pSimObject;
 }
 
 //-----------------------------------------------------------------------------
@@ -27,8 +27,8 @@
 #include "collection/hashTable.h"
 #endif
 
-#ifndef _TAML_H_
-#include "persistence/taml/taml.h"
+#ifndef _TAML_READER_H_
+#include "persistence/taml/tamlReader.h"
 #endif
 
 /// RapidJson.
@@ -39,17 +39,24 @@
 
 /// @ingroup tamlGroup
 /// @see tamlGroup
-class TamlJSONReader
+class TamlJSONReader : public TamlReader
 {
 public:
     TamlJSONReader( Taml* pTaml ) :
-        mpTaml( pTaml )
+        mpTaml( pTaml ),
+        mpDocument( NULL ),
+        mpRootObject( NULL ),
+        mRootMemberItr( NULL ),
+        mRootMemberEnd( NULL )
     {}
 
-    virtual ~TamlJSONReader() {}
+    virtual ~TamlJSONReader() { resetParse(); }
 
-    /// Read.
-    SimObject* read( FileStream& stream );
+    /// Read phases.
+    virtual bool parseDocument( FileStream& stream );
+    virtual SimObject* beginRoot( void );
+    virtual bool readNextChild( void );
+    virtual SimObject* endRoot( void );
 
 private:
     Taml* mpTaml;
@@ -57,10 +64,19 @@ private:
     typedef HashMap<SimObjectId, SimObject*> typeObjectReferenceHash;
     typeObjectReferenceHash mObjectReferenceMap;
 
+    rapidjson::Document*                    mpDocument;
+    SimObject*                              mpRootObject;
+    rapidjson::Value::ConstMemberIterator   mRootMemberItr;
+    rapidjson::Value::ConstMemberIterator   mRootMemberEnd;
+    TamlCustomNodes                         mRootCustomNodes;
+
 private:
     void resetParse( void );
 
     SimObject* parseType( const rapidjson::Value::ConstMemberIterator& memberItr );
+    SimObject* createTypeObject( StringTableEntry engineTypeName, const rapidjson::Value& typeValue );
+    inline void parseObjectMember( rapidjson::Value::ConstMemberIterator& memberItr, SimObject* pSimObject, TamlCustomNodes& customNodes );
+    void finishTypeObject( SimObject* pSimObject, TamlCustomNodes& customNodes );
     inline void parseField( rapidjson::Value::ConstMemberIterator& memberItr, SimObject* pSimObject );
     inline void parseChild( rapidjson::Value::ConstMemberIterator& memberItr, SimObject* pSimObject );
     inline void parseCustom( rapidjson::Value::ConstMemberIterator& memberItr, SimObject* pSimObject, const char* pCustomNodeName, TamlCustomNodes& customNodes );
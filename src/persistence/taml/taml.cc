@@ -54,10 +54,22 @@
 #include "persistence/taml/json/tamlJSONParser.h"
 #endif
 
+#ifndef _TAML_COMPILEDWRITER_H_
+#include "persistence/taml/compiled/tamlCompiledWriter.h"
+#endif
+
+#ifndef _TAML_COMPILEDREADER_H_
+#include "persistence/taml/compiled/tamlCompiledReader.h"
+#endif
+
 #ifndef _FRAMEALLOCATOR_H_
 #include "memory/frameAllocator.h"
 #endif
 
+#ifndef _PLATFORM_THREADS_MUTEX_H_
+#include "platform/threads/mutex.h"
+#endif
+
 #ifndef _CONSOLETYPES_H_
 #include "console/consoleTypes.h"
 #endif
@@ -112,7 +124,8 @@ static EnumTable::Enums tamlFormatModeLookup[] =
                 {
                 { Taml::XmlFormat, "xml" },
                 { Taml::BinaryFormat, "binary" },
-                { Taml::JSONFormat, "json" }
+                { Taml::JSONFormat, "json" },
+                { Taml::CompiledFormat, "compiled" }
                 };
 
 EnumTable tamlFormatModeTable(sizeof(tamlFormatModeLookup) / sizeof(EnumTable::Enums), &tamlFormatModeLookup[0]);
@@ -163,7 +176,8 @@ Taml::Taml() :
     mAutoFormat(true),
     mAutoFormatXmlExtension("taml"),    
     mAutoFormatBinaryExtension("baml"),
-    mAutoFormatJSONExtension("json")
+    mAutoFormatJSONExtension("json"),
+    mAutoFormatCompiledExtension("ctaml")
 {
     // Reset the file-path buffer.
     mFilePathBuffer[0] = 0;
@@ -185,6 +199,7 @@ void Taml::initPersistFields()
     addField("AutoFormatXmlExtension", TypeString, Offset(mAutoFormatXmlExtension, Taml), "When using auto-format, this is the extension (end of filename) used to detect the XML format.\n");
     addField("AutoFormatBinaryExtension", TypeString, Offset(mAutoFormatBinaryExtension, Taml), "When using auto-format, this is the extension (end of filename) used to detect the BINARY format.\n");
     addField("AutoFormatJSONExtension", TypeString, Offset(mAutoFormatJSONExtension, Taml), "When using auto-format, this is the extension (end of filename) used to detect the JSON format.\n");
+    addField("AutoFormatCompiledExtension", TypeString, Offset(mAutoFormatCompiledExtension, Taml), "When using auto-format, this is the extension (end of filename) used to detect the COMPILED format.\n");
 }
 
 //-----------------------------------------------------------------------------
@@ -268,16 +283,7 @@ SimObject* Taml::read( const char* pFilename )
     AssertFatal( pFilename != NULL, "Cannot read from a NULL filename." );
 
     // Expand the file-name into the file-path buffer.
-    Con::expandPath( mFilePathBuffer, sizeof(mFilePathBuffer), pFilename );
-
-    // Set current working directory to the path of the file.
-    StringTableEntry previousCWD = Platform::getCurrentDirectory();
-    char fileDirectory[1024], *ptr;
-    dStrcpy(fileDirectory, mFilePathBuffer);
-    ptr = dStrrchr(fileDirectory, '/');
-    if (ptr)
-       *ptr = 0;
-    Platform::setCurrentDirectory(StringTable->insert(fileDirectory));
+    StringTableEntry fileDirectory = expandReadPath( pFilename );
 
     FileStream stream;
 
@@ -295,15 +301,18 @@ SimObject* Taml::read( const char* pFilename )
     // Reset the compilation.
     resetCompilation();
 
-    // Write object.
+    // Relative paths in the file are relative to the file.
+    Con::pushWorkingDirectory( fileDirectory );
+
+    // Read object.
     SimObject* pSimObject = read( stream, formatMode );
 
+    // Restore working directory.
+    Con::popWorkingDirectory();
+
     // Close file.
     stream.close();
 
-    // Reset working directory to previous.
-    Platform::setCurrentDirectory(previousCWD);
-
     // Reset the compilation.
     resetCompilation();
 
@@ -360,6 +369,16 @@ bool Taml::write( FileStream& stream, SimObject* pSimObject, const TamlFormatMod
             return writer.write( stream, pRootNode );
         }
 
+        /// Compiled.
+        case CompiledFormat:
+        {
+            // Create writer.
+            TamlCompiledWriter writer( this );
+
+            // Write.
+            return writer.write( stream, pRootNode, mBinaryCompression );
+        }
+
         /// Invalid.
         case InvalidFormat:
         {
@@ -376,40 +395,43 @@ bool Taml::write( FileStream& stream, SimObject* pSimObject, const TamlFormatMod
 
 //-----------------------------------------------------------------------------
 
-SimObject* Taml::read( FileStream& stream, const TamlFormatMode formatMode )
+StringTableEntry Taml::expandReadPath( const char* pFilename )
+{
+    // Expand the file-name into the file-path buffer.
+    Con::expandPath( mFilePathBuffer, sizeof(mFilePathBuffer), pFilename );
+
+    // Fetch the directory of the file.
+    char fileDirectory[1024];
+    dStrcpy( fileDirectory, mFilePathBuffer );
+    char* pSlash = dStrrchr( fileDirectory, '/' );
+    if ( pSlash != NULL )
+        *pSlash = 0;
+
+    return StringTable->insert( fileDirectory );
+}
+
+//-----------------------------------------------------------------------------
+
+TamlReader* Taml::createReader( const TamlFormatMode formatMode )
 {
     // Format appropriately.
     switch( formatMode )
     {
         /// Xml.
         case XmlFormat:
-        {
-            // Create reader.
-            TamlXmlReader reader( this );
-
-            // Read.
-            return reader.read( stream );
-        }
+            return new TamlXmlReader( this );
 
         /// Binary.
         case BinaryFormat:
-        {
-            // Create reader.
-            TamlBinaryReader reader( this );
-
-            // Read.
-            return reader.read( stream );
-        }
+            return new TamlBinaryReader( this );
 
         /// JSON.
         case JSONFormat:
-        {
-            // Create reader.
-            TamlJSONReader reader( this );
+            return new TamlJSONReader( this );
 
-            // Read.
-            return reader.read( stream );
-        }
+        /// Compiled.
+        case CompiledFormat:
+            return new TamlCompiledReader( this );
         
         /// Invalid.
         case InvalidFormat:
@@ -427,6 +449,25 @@ SimObject* Taml::read( FileStream& stream, const TamlFormatMode formatMode )
 
 //-----------------------------------------------------------------------------
 
+SimObject* Taml::read( FileStream& stream, const TamlFormatMode formatMode )
+{
+    // Create reader.
+    TamlReader* pReader = createReader( formatMode );
+
+    // Finish if the format can't be read.
+    if ( pReader == NULL )
+        return NULL;
+
+    // Read.
+    SimObject* pSimObject = pReader->read( stream );
+
+    delete pReader;
+
+    return pSimObject;
+}
+
+//-----------------------------------------------------------------------------
+
 bool Taml::parse( const char* pFilename, TamlVisitor& visitor )
 {
     // Debug Profiling.
@@ -474,6 +515,7 @@ bool Taml::parse( const char* pFilename, TamlVisitor& visitor )
         }
 
         case BinaryFormat:
+        case CompiledFormat:
         default:
             break;
     }
@@ -525,6 +567,7 @@ Taml::TamlFormatMode Taml::getFileAutoFormatMode( const char* pFilename )
         const U32 xmlExtensionLength = dStrlen( mAutoFormatXmlExtension );
         const U32 binaryExtensionLength = dStrlen( mAutoFormatBinaryExtension );
         const U32 jsonExtensionLength = dStrlen( mAutoFormatJSONExtension );
+        const U32 compiledExtensionLength = dStrlen( mAutoFormatCompiledExtension );
 
         // Fetch filename length.
         const U32 filenameLength = dStrlen( pFilename );
@@ -532,6 +575,10 @@ Taml::TamlFormatMode Taml::getFileAutoFormatMode( const char* pFilename )
         // Fetch end of filename,
         const char* pEndOfFilename = pFilename + filenameLength;
 
+        // Check for the Compiled format first as its extension can end with the XML one.
+        if ( compiledExtensionLength <= filenameLength && dStricmp( pEndOfFilename - compiledExtensionLength, mAutoFormatCompiledExtension ) == 0 )
+            return Taml::CompiledFormat;
+
         // Check for the XML format.
         if ( xmlExtensionLength <= filenameLength && dStricmp( pEndOfFilename - xmlExtensionLength, mAutoFormatXmlExtension ) == 0 )
             return Taml::XmlFormat;
@@ -763,28 +810,27 @@ void Taml::compileDynamicFields( TamlWriteNode* pTamlWriteNode )
     Vector<SimFieldDictionary::Entry*> dynamicFieldList(__FILE__, __LINE__);
 
     // Ensure the dynamic field doesn't conflict with static field.
-    for( U32 hashIndex = 0; hashIndex < SimFieldDictionary::HashTableSize; ++hashIndex )
+    for( SimFieldDictionaryIterator itr(pFieldDictionary); *itr; ++itr )
     {
-        for( SimFieldDictionary::Entry* pEntry = pFieldDictionary->mHashTable[hashIndex]; pEntry; pEntry = pEntry->next )
+        SimFieldDictionary::Entry* pEntry = *itr;
+
+        // Iterate static fields.
+        U32 fieldIndex;
+        for( fieldIndex = 0; fieldIndex < fieldCount; ++fieldIndex )
         {
-            // Iterate static fields.
-            U32 fieldIndex;
-            for( fieldIndex = 0; fieldIndex < fieldCount; ++fieldIndex )
-            {
-                if( fieldList[fieldIndex].pFieldname == pEntry->slotName)
-                    break;
-            }
+            if( fieldList[fieldIndex].pFieldname == pEntry->slotName)
+                break;
+        }
 
-            // Skip if found.
-            if( fieldIndex != (U32)fieldList.size() )
-                continue;
+        // Skip if found.
+        if( fieldIndex != (U32)fieldList.size() )
+            continue;
 
-            // Skip if not writing field.
-            if ( !pSimObject->writeField( pEntry->slotName, pEntry->value) )
-                continue;
+        // Skip if not writing field.
+        if ( !pSimObject->writeField( pEntry->slotName, pEntry->value) )
+            continue;
 
-            dynamicFieldList.push_back( pEntry );
-        }
+        dynamicFieldList.push_back( pEntry );
     }
 
     // Sort Entries to prevent version control conflicts
@@ -924,50 +970,65 @@ void Taml::compileCustomNodeState( TamlCustomNode* pCustomNode )
 
 //-----------------------------------------------------------------------------
 
-SimObject* Taml::createType( StringTableEntry typeName, const Taml* pTaml, const char* pProgenitorSuffix )
+AbstractClassRep* Taml::findType( StringTableEntry typeName )
 {
-    // Debug Profiling.
-    PROFILE_SCOPE(Taml_CreateType);
-
     typedef HashMap<StringTableEntry, AbstractClassRep*> typeClassHash;
     static typeClassHash mClassMap;
+    static Mutex mClassMapMutex;
 
     // Sanity!
     AssertFatal( typeName != NULL, "Taml: Type cannot be NULL" );
 
+    // Lock the class map, readers parse on any thread.
+    MutexHandle mutex;
+    mutex.lock( &mClassMapMutex, true );
+
     // Find type.
     typeClassHash::iterator typeItr = mClassMap.find( typeName );
 
     // Found type?
-    if ( typeItr == mClassMap.end() )
+    if ( typeItr != mClassMap.end() )
+        return typeItr->value;
+
+    // No, so find type.
+    AbstractClassRep* pClassRep = AbstractClassRep::getClassList();
+    while( pClassRep )
     {
-        // No, so find type.
-        AbstractClassRep* pClassRep = AbstractClassRep::getClassList();
-        while( pClassRep )
+        // Is this the type?
+        if( dStricmp( pClassRep->getClassName(), typeName ) == 0 )
         {
-            // Is this the type?
-            if( dStricmp( pClassRep->getClassName(), typeName ) == 0 )
-            {
-                // Yes, so insert it.
-                typeItr = mClassMap.insert( typeName, pClassRep );
-                break;
-            }
-
-            // Next type.
-            pClassRep = pClassRep->getNextClass();
+            // Yes, so insert it.
+            mClassMap.insert( typeName, pClassRep );
+            return pClassRep;
         }
 
-        // Did we find the type?
-        if ( typeItr == mClassMap.end() )
-        {
-            // No, so warn and fail.
-            Con::warnf( "Taml: Failed to create type '%s' as such a registered type could not be found.", typeName );
-            return NULL;
-        }
+        // Next type.
+        pClassRep = pClassRep->getNextClass();
+    }
+
+    return NULL;
+}
+
+//-----------------------------------------------------------------------------
+
+SimObject* Taml::createType( StringTableEntry typeName, const Taml* pTaml, const char* pProgenitorSuffix )
+{
+    // Debug Profiling.
+    PROFILE_SCOPE(Taml_CreateType);
+
+    // Find type.
+    AbstractClassRep* pClassRep = findType( typeName );
+
+    // Did we find the type?
+    if ( pClassRep == NULL )
+    {
+        // No, so warn and fail.
+        Con::warnf( "Taml: Failed to create type '%s' as such a registered type could not be found.", typeName );
+        return NULL;
     }
 
     // Create the object.
-    ConsoleObject* pConsoleObject = typeItr->value->create();
+    ConsoleObject* pConsoleObject = pClassRep->create();
 
     // NOTE: It is important that we don't register the object here as many objects rely on the fact that
     // fields are set prior to the object being registered.  Registering here will invalid those assumptions.
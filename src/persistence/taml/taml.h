@@ -57,6 +57,10 @@
 
 //-----------------------------------------------------------------------------
 
+class TamlReader;
+
+//-----------------------------------------------------------------------------
+
 extern StringTableEntry tamlRefIdName;
 extern StringTableEntry tamlRefToIdName;
 extern StringTableEntry tamlNamedObjectName;
@@ -73,6 +77,8 @@ extern StringTableEntry tamlNamedObjectName;
 /// @see tamlGroup
 class Taml : public SimObject
 {
+    friend class TamlAsyncReader;
+
 public:
     enum TamlFormatMode
     {
@@ -80,6 +86,7 @@ public:
         XmlFormat,
         BinaryFormat,
         JSONFormat,
+        CompiledFormat,
     };
 
 private:
@@ -94,6 +101,7 @@ private:
     StringTableEntry    mAutoFormatXmlExtension;
     StringTableEntry    mAutoFormatBinaryExtension;
     StringTableEntry    mAutoFormatJSONExtension;
+    StringTableEntry    mAutoFormatCompiledExtension;
     bool                mJSONStrict;
     bool                mBinaryCompression;
     bool                mAutoFormat;
@@ -111,6 +119,9 @@ private:
     void compileCustomState( TamlWriteNode* pTamlWriteNode );
     void compileCustomNodeState( TamlCustomNode* pCustomNode );
 
+    StringTableEntry expandReadPath( const char* pFilename );
+    TamlReader* createReader( const TamlFormatMode formatMode );
+
     bool write( FileStream& stream, SimObject* pSimObject, const TamlFormatMode formatMode );
     SimObject* read( FileStream& stream, const TamlFormatMode formatMode );
     template<typename T> inline T* read( FileStream& stream, const TamlFormatMode formatMode )
@@ -156,8 +167,10 @@ public:
     inline StringTableEntry getAutoFormatBinaryExtension( void ) const { return mAutoFormatBinaryExtension; }
     inline void setAutoFormatJSONExtension(const char* pExtension) { mAutoFormatJSONExtension = StringTable->insert(pExtension); }
     inline StringTableEntry getAutoFormatJSONExtension(void) const { return mAutoFormatJSONExtension; }
+    inline void setAutoFormatCompiledExtension( const char* pExtension ) { mAutoFormatCompiledExtension = StringTable->insert( pExtension ); }
+    inline StringTableEntry getAutoFormatCompiledExtension( void ) const { return mAutoFormatCompiledExtension; }
 
-    /// Compression.
+    /// Compression, used by the binary and compiled formats.
     inline void setBinaryCompression( const bool compressed ) { mBinaryCompression = compressed; }
     inline bool getBinaryCompression( void ) const { return mBinaryCompression; }
 
@@ -189,7 +202,8 @@ public:
     /// Parse.
     bool parse( const char* pFilename, TamlVisitor& visitor );
 
-    /// Create type.
+    /// Create type.  The type lookup is thread-safe but objects must be created on the main thread.
+    static AbstractClassRep* findType( StringTableEntry typeName );
     static SimObject* createType( StringTableEntry typeName, const Taml* pTaml, const char* pProgenitorSuffix = NULL );
 
     /// Schema generation.
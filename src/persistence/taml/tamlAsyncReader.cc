@@ -0,0 +1,208 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2013 GarageGames, LLC
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//-----------------------------------------------------------------------------
+
+#include "persistence/taml/tamlAsyncReader.h"
+
+#ifndef _TAML_READER_H_
+#include "persistence/taml/tamlReader.h"
+#endif
+
+// Debug Profiling.
+#include "debug/profiler.h"
+
+//-----------------------------------------------------------------------------
+
+TamlAsyncReader::TamlAsyncReader( Taml* pTaml ) :
+    mpTaml( pTaml ),
+    mpReader( NULL ),
+    mFileDirectory( StringTable->EmptyString ),
+    mState( Idle ),
+    mParsed( false ),
+    mpRootObject( NULL )
+{
+    // Sanity!
+    AssertFatal( pTaml != NULL, "TamlAsyncReader: Taml cannot be NULL." );
+}
+
+//-----------------------------------------------------------------------------
+
+TamlAsyncReader::~TamlAsyncReader()
+{
+    cancel();
+}
+
+//-----------------------------------------------------------------------------
+
+bool TamlAsyncReader::start( const char* pFilename )
+{
+    // Debug Profiling.
+    PROFILE_SCOPE(TamlAsyncReader_Start);
+
+    // Sanity!
+    AssertFatal( pFilename != NULL, "Cannot read from a NULL filename." );
+    AssertFatal( mState != Parsing && mState != Building, "TamlAsyncReader::start() - A read is already in progress." );
+
+    mpRootObject = NULL;
+
+    // Expand the file-name into the file-path buffer.
+    mFileDirectory = mpTaml->expandReadPath( pFilename );
+
+    // File opened?
+    if ( !mStream.open( mpTaml->getFilePathBuffer(), FileStream::Read ) )
+    {
+        // No, so warn.
+        Con::warnf("TamlAsyncReader::start() - Could not open filename '%s' for read.", mpTaml->getFilePathBuffer() );
+        mState = Finished;
+        return false;
+    }
+
+    // Create a reader for the file auto-format mode.
+    mpReader = mpTaml->createReader( mpTaml->getFileAutoFormatMode( mpTaml->getFilePathBuffer() ) );
+
+    // Finish if the format can't be read.
+    if ( mpReader == NULL )
+    {
+        finish();
+        return false;
+    }
+
+    // Parse on a worker.
+    mParsed = false;
+    mState = Parsing;
+    JobSystem::submit( &TamlAsyncReader::parseJob, this, &mParseCounter );
+
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+
+void TamlAsyncReader::parseJob( void* data, U32 first, U32 count )
+{
+    TamlAsyncReader* pAsyncReader = static_cast<TamlAsyncReader*>( data );
+
+    // Parse the document.  This doesn't create any objects.
+    pAsyncReader->mParsed = pAsyncReader->mpReader->parseDocument( pAsyncReader->mStream );
+}
+
+//-----------------------------------------------------------------------------
+
+bool TamlAsyncReader::update( const U32 timeBudgetMs )
+{
+    // Debug Profiling.
+    PROFILE_SCOPE(TamlAsyncReader_Update);
+
+    // Finish if we're not reading.
+    if ( mState == Idle || mState == Finished )
+        return mState == Finished;
+
+    // Is the document still being parsed?
+    if ( mState == Parsing )
+    {
+        // Yes, so finish if the worker isn't done yet.
+        if ( !mParseCounter.isDone() )
+            return false;
+
+        // Did the parse fail?
+        if ( !mParsed )
+        {
+            // Yes, so warn.
+            Con::warnf( "TamlAsyncReader::update() - Failed to load an object from the file '%s'.", mpTaml->getFilePathBuffer() );
+            finish();
+            return true;
+        }
+
+        mState = Building;
+    }
+
+    const U32 startTime = Platform::getRealMilliseconds();
+
+    // Relative paths in the file are relative to the file.
+    Con::pushWorkingDirectory( mFileDirectory );
+
+    // Is the root built?
+    bool moreChildren = true;
+    if ( mpRootObject == NULL )
+    {
+        // No, so build it.
+        mpRootObject = mpReader->beginRoot();
+
+        // Skip the children if it couldn't be built.
+        moreChildren = mpRootObject != NULL;
+    }
+
+    // Read children until the budget is spent.
+    while ( moreChildren )
+    {
+        moreChildren = mpReader->readNextChild();
+
+        if ( Platform::getRealMilliseconds() - startTime >= timeBudgetMs )
+            break;
+    }
+
+    // Have all the children been read?
+    if ( !moreChildren )
+    {
+        // Yes, so finish the root.
+        mpRootObject = mpReader->endRoot();
+
+        // Did we generate an object?
+        if ( mpRootObject == NULL )
+        {
+            // No, so warn.
+            Con::warnf( "TamlAsyncReader::update() - Failed to load an object from the file '%s'.", mpTaml->getFilePathBuffer() );
+        }
+
+        finish();
+    }
+
+    // Restore working directory.
+    Con::popWorkingDirectory();
+
+    return mState == Finished;
+}
+
+//-----------------------------------------------------------------------------
+
+void TamlAsyncReader::cancel( void )
+{
+    // Debug Profiling.
+    PROFILE_SCOPE(TamlAsyncReader_Cancel);
+
+    // The worker uses the stream and reader until it's done.
+    if ( mState == Parsing )
+        JobSystem::wait( mParseCounter );
+
+    // Finish the read without finishing the root.
+    if ( mState == Parsing || mState == Building )
+        finish();
+}
+
+//-----------------------------------------------------------------------------
+
+void TamlAsyncReader::finish( void )
+{
+    // Release the reader and the file.
+    SAFE_DELETE( mpReader );
+    mStream.close();
+
+    mState = Finished;
+}
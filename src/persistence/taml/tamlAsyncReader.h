@@ -0,0 +1,88 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2013 GarageGames, LLC
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//-----------------------------------------------------------------------------
+
+#ifndef _TAML_ASYNC_READER_H_
+#define _TAML_ASYNC_READER_H_
+
+#ifndef _TAML_H_
+#include "persistence/taml/taml.h"
+#endif
+
+#ifndef _JOB_SYSTEM_H_
+#include "platform/threads/jobSystem.h"
+#endif
+
+//-----------------------------------------------------------------------------
+
+/// Reads a Taml file without stalling the main thread for the whole read.
+/// The document is parsed by a job system worker, then update() builds the
+/// objects on the main thread one child of the root at a time until its time
+/// budget runs out.  The Taml object must outlive the read and must not be
+/// used for anything else until it's finished.
+/// @ingroup tamlGroup
+/// @see tamlGroup
+class TamlAsyncReader
+{
+public:
+    enum ReadState
+    {
+        Idle,
+        Parsing,
+        Building,
+        Finished,
+    };
+
+    TamlAsyncReader( Taml* pTaml );
+    virtual ~TamlAsyncReader();
+
+    /// Start reading a file.  Returns false if it couldn't be opened.
+    bool start( const char* pFilename );
+
+    /// Build objects for at most the time budget, at least one child is read per call.
+    /// Returns true once the read has finished.
+    bool update( const U32 timeBudgetMs );
+
+    /// Stop reading.  Objects that were already built are kept but the root isn't finished.
+    void cancel( void );
+
+    inline ReadState getState( void ) const { return mState; }
+    inline bool isFinished( void ) const { return mState == Finished; }
+
+    /// The root object once it's built, NULL if the read failed.
+    inline SimObject* getRootObject( void ) const { return mpRootObject; }
+
+private:
+    Taml*               mpTaml;
+    TamlReader*         mpReader;
+    FileStream          mStream;
+    StringTableEntry    mFileDirectory;
+    ReadState           mState;
+    JobCounter          mParseCounter;
+    bool                mParsed;
+    SimObject*          mpRootObject;
+
+private:
+    static void parseJob( void* data, U32 first, U32 count );
+    void finish( void );
+};
+
+#endif // _TAML_ASYNC_READER_H_
@@ -0,0 +1,71 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2013 GarageGames, LLC
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//-----------------------------------------------------------------------------
+
+#ifndef _TAML_READER_H_
+#define _TAML_READER_H_
+
+#ifndef _TAML_H_
+#include "persistence/taml/taml.h"
+#endif
+
+//-----------------------------------------------------------------------------
+
+/// Reading happens in two phases so that a document can be loaded in the background.
+/// parseDocument() only reads the stream into the format's own document model; it doesn't
+/// create objects so it can run on any thread.  The object phase must run on the main thread.
+/// beginRoot() creates the root object, readNextChild() reads one child of the root along with
+/// its whole sub-tree and endRoot() reads the custom nodes of the root and finishes it.
+/// endRoot() must always be called after beginRoot(), it resets the reader.
+/// @ingroup tamlGroup
+/// @see tamlGroup
+class TamlReader
+{
+public:
+    virtual ~TamlReader() {}
+
+    /// Read.
+    SimObject* read( FileStream& stream )
+    {
+        // Parse the document.
+        if ( !parseDocument( stream ) )
+            return NULL;
+
+        // Build the objects.
+        beginRoot();
+        while( readNextChild() ) {}
+        return endRoot();
+    }
+
+    /// Parse the document without creating any objects.
+    virtual bool parseDocument( FileStream& stream ) = 0;
+
+    /// Create the root object.
+    virtual SimObject* beginRoot( void ) = 0;
+
+    /// Read the next child of the root.  Returns false when there are none left.
+    virtual bool readNextChild( void ) = 0;
+
+    /// Finish the root object.
+    virtual SimObject* endRoot( void ) = 0;
+};
+
+#endif // _TAML_READER_H_
@@ -25,7 +25,7 @@
 ConsoleMethodGroupBeginWithDocs(Taml, SimObject)
 
 /*! Sets the format that Taml should use to read/write.
-    @param format The format to use: 'xml' or 'binary'.
+    @param format The format to use: 'xml', 'binary', 'json' or 'compiled'.
     @return No return value.
 */
 ConsoleMethodWithDocs(Taml, setFormat, ConsoleVoid, 3, 3, (format))
@@ -164,6 +164,27 @@ ConsoleMethodWithDocs(Taml, getAutoFormatBinaryExtension, ConsoleString, 3, 3, (
 
 //-----------------------------------------------------------------------------
 
+/*! Sets the extension (end of filename) used to detect the Compiled format.
+    @param extension The extension (end of filename) used to detect the Compiled format.
+    @return No return value.
+*/
+ConsoleMethodWithDocs(Taml, setAutoFormatCompiledExtension, ConsoleVoid, 3, 3, (extension))
+{
+    object->setAutoFormatCompiledExtension( argv[2] );
+}
+
+//-----------------------------------------------------------------------------
+
+/*! Gets the extension (end of filename) used to detect the Compiled format.
+    @return The extension (end of filename) used to detect the Compiled format.
+*/
+ConsoleMethodWithDocs(Taml, getAutoFormatCompiledExtension, ConsoleString, 3, 3, ())
+{
+    return object->getAutoFormatCompiledExtension();
+}
+
+//-----------------------------------------------------------------------------
+
 /*! Sets whether ZIP compression is used on binary formatting or not.
     @param compressed Whether compression is on or off.
     @return No return value.
@@ -297,8 +318,8 @@ ConsoleFunctionWithDocs(TamlWrite, ConsoleBool, 3, 5, (object, filename, [format
         // Was binary compression specified?
         if ( argc > 4 )
         {
-            // Yes, so is the format mode binary?
-            if ( taml.getFormatMode() == Taml::BinaryFormat )
+            // Yes, so is the format mode binary or compiled?
+            if ( taml.getFormatMode() == Taml::BinaryFormat || taml.getFormatMode() == Taml::CompiledFormat )
             {
                 // Yes, so set binary compression.
                 taml.setBinaryCompression( dAtob(argv[4]) );
@@ -457,6 +478,16 @@ extern "C"{
       return tamlObj->getAutoFormatBinaryExtension();
    }
 
+   DLL_PUBLIC void TamlSetAutoFormatCompiledExtension(Taml* tamlObj, const char* value)
+   {
+      tamlObj->setAutoFormatCompiledExtension(value);
+   }
+
+   DLL_PUBLIC const char* TamlGetAutoFormatCompiledExtension(Taml* tamlObj)
+   {
+      return tamlObj->getAutoFormatCompiledExtension();
+   }
+
    DLL_PUBLIC void TamlSetBinaryCompression(Taml* tamlObj, bool value)
    {
       tamlObj->setBinaryCompression(value);
@@ -506,8 +537,8 @@ extern "C"{
       {
          taml.setFormatMode(Taml::getFormatModeEnum(format));
 
-         // Yes, so is the format mode binary?
-         if (taml.getFormatMode() == Taml::BinaryFormat)
+         // Yes, so is the format mode binary or compiled?
+         if (taml.getFormatMode() == Taml::BinaryFormat || taml.getFormatMode() == Taml::CompiledFormat)
          {
             // Yes, so set binary compression.
             taml.setBinaryCompression(compressed);
@@ -27,24 +27,107 @@
 
 //-----------------------------------------------------------------------------
 
-SimObject* TamlXmlReader::read( FileStream& stream )
+bool TamlXmlReader::parseDocument( FileStream& stream )
 {
     // Debug Profiling.
-    PROFILE_SCOPE(TamlXmlReader_Read);
-
-    // Create document.
-    TiXmlDocument xmlDocument;
+    PROFILE_SCOPE(TamlXmlReader_ParseDocument);
 
     // Load document from stream.
-    if ( !xmlDocument.LoadFile( stream ) )
+    if ( !mDocument.LoadFile( stream ) )
     {
         // Warn!
-        Con::warnf("Taml: XML Error: %s", xmlDocument.ErrorDesc());
+        Con::warnf("Taml: XML Error: %s", mDocument.ErrorDesc());
+        mDocument.Clear();
+        return false;
+    }
+
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+
+SimObject* TamlXmlReader::beginRoot( void )
+{
+    // Debug Profiling.
+    PROFILE_SCOPE(TamlXmlReader_BeginRoot);
+
+    // Fetch root element.
+    TiXmlElement* pRootXmlElement = mDocument.RootElement();
+
+    // Finish if there's no root.
+    if ( pRootXmlElement == NULL )
+        return NULL;
+
+    // Fetch reference to Id.
+    const U32 tamlRefToId = getTamlRefToId( pRootXmlElement );
+
+    // Do we have a reference to Id?
+    if ( tamlRefToId != 0 )
+    {
+        // Yes, so warn as there's nothing the root could refer to.
+        Con::warnf( "Taml: Could not find a reference Id of '%d'", tamlRefToId );
         return NULL;
     }
 
-    // Parse root element.
-    SimObject* pSimObject = parseElement( xmlDocument.RootElement() );
+    // Create root object.
+    mpRootObject = createElementObject( pRootXmlElement );
+
+    // Finish if we couldn't create the type.
+    if ( mpRootObject == NULL )
+        return NULL;
+
+    // Fetch any children.
+    mpRootChildXmlNode = pRootXmlElement->FirstChild();
+    mRootHasChildNodes = mpRootChildXmlNode != NULL;
+
+    // Do we have any element children?
+    if ( mRootHasChildNodes )
+    {
+        // Fetch the Taml children.
+        mpRootChildren = dynamic_cast<TamlChildren*>( mpRootObject );
+
+        // Fetch any container child class specifier.
+        mpRootContainerChildClass = mpRootObject->getClassRep()->getContainerChildClass( true );
+    }
+
+    return mpRootObject;
+}
+
+//-----------------------------------------------------------------------------
+
+bool TamlXmlReader::readNextChild( void )
+{
+    // Debug Profiling.
+    PROFILE_SCOPE(TamlXmlReader_ReadNextChild);
+
+    // Finish if there's nothing left to read.
+    if ( mpRootObject == NULL || mpRootChildXmlNode == NULL )
+        return false;
+
+    // Fetch child node.
+    TiXmlNode* pChildXmlNode = mpRootChildXmlNode;
+
+    // Move to next sibling.
+    mpRootChildXmlNode = pChildXmlNode->NextSibling();
+
+    // Parse child node.
+    parseChildNode( pChildXmlNode, mDocument.RootElement(), mpRootObject, mpRootChildren, mpRootContainerChildClass, mRootCustomNodes );
+
+    return mpRootChildXmlNode != NULL;
+}
+
+//-----------------------------------------------------------------------------
+
+SimObject* TamlXmlReader::endRoot( void )
+{
+    // Debug Profiling.
+    PROFILE_SCOPE(TamlXmlReader_EndRoot);
+
+    SimObject* pSimObject = mpRootObject;
+
+    // Finish root object.
+    if ( pSimObject != NULL )
+        finishElementObject( pSimObject, mRootHasChildNodes, mRootCustomNodes );
 
     // Reset parse.
     resetParse();
@@ -61,6 +144,15 @@ void TamlXmlReader::resetParse( void )
 
     // Clear object reference map.
     mObjectReferenceMap.clear();
+
+    // Clear root state.
+    mDocument.Clear();
+    mpRootObject = NULL;
+    mpRootChildren = NULL;
+    mpRootContainerChildClass = NULL;
+    mpRootChildXmlNode = NULL;
+    mRootHasChildNodes = false;
+    mRootCustomNodes.resetState();
 }
 
 //-----------------------------------------------------------------------------
@@ -70,11 +162,6 @@ SimObject* TamlXmlReader::parseElement( TiXmlElement* pXmlElement )
     // Debug Profiling.
     PROFILE_SCOPE(TamlXmlReader_ParseElement);
 
-    SimObject* pSimObject = NULL;
-
-    // Fetch element name.
-    StringTableEntry typeName = StringTable->insert( pXmlElement->Value() );
-
     // Fetch reference to Id.
     const U32 tamlRefToId = getTamlRefToId( pXmlElement );
 
@@ -96,7 +183,59 @@ SimObject* TamlXmlReader::parseElement( TiXmlElement* pXmlElement )
         return referenceItr->value;
     }
 
-    // No, so fetch reference Id.
+    // Create object.
+    SimObject* pSimObject = createElementObject( pXmlElement );
+
+    // Finish if we couldn't create the type.
+    if ( pSimObject == NULL )
+        return NULL;
+
+    // Fetch any children.
+    TiXmlNode* pChildXmlNode = pXmlElement->FirstChild();
+
+    TamlCustomNodes customProperties;
+
+    // Do we have any element children?
+    if ( pChildXmlNode != NULL )
+    {
+        // Fetch the Taml children.
+        TamlChildren* pChildren = dynamic_cast<TamlChildren*>( pSimObject );
+
+        // Fetch any container child class specifier.
+        AbstractClassRep* pContainerChildClass = pSimObject->getClassRep()->getContainerChildClass( true );
+
+        // Iterate siblings.
+        do
+        {
+            // Parse child node.
+            parseChildNode( pChildXmlNode, pXmlElement, pSimObject, pChildren, pContainerChildClass, customProperties );
+
+            // Move to next sibling.
+            pChildXmlNode = pChildXmlNode->NextSibling();
+        }
+        while( pChildXmlNode != NULL );
+    }
+
+    // Finish object.
+    finishElementObject( pSimObject, pXmlElement->FirstChild() != NULL, customProperties );
+
+    // Return object.
+    return pSimObject;
+}
+
+//-----------------------------------------------------------------------------
+
+SimObject* TamlXmlReader::createElementObject( TiXmlElement* pXmlElement )
+{
+    // Debug Profiling.
+    PROFILE_SCOPE(TamlXmlReader_CreateElementObject);
+
+    SimObject* pSimObject = NULL;
+
+    // Fetch element name.
+    StringTableEntry typeName = StringTable->insert( pXmlElement->Value() );
+
+    // Fetch reference Id.
     const U32 tamlRefId = getTamlRefId( pXmlElement );
 
 #ifdef TORQUE_DEBUG
@@ -163,97 +302,92 @@ SimObject* TamlXmlReader::parseElement( TiXmlElement* pXmlElement )
         mObjectReferenceMap.insert( tamlRefId, pSimObject );
     }
 
-    // Fetch any children.
-    TiXmlNode* pChildXmlNode = pXmlElement->FirstChild();
+    return pSimObject;
+}
 
-    TamlCustomNodes customProperties;
+//-----------------------------------------------------------------------------
 
-    // Do we have any element children?
-    if ( pChildXmlNode != NULL )
+void TamlXmlReader::parseChildNode( TiXmlNode* pChildXmlNode, TiXmlElement* pXmlElement, SimObject* pSimObject, TamlChildren* pChildren, AbstractClassRep* pContainerChildClass, TamlCustomNodes& customProperties )
+{
+    // Fetch element.
+    TiXmlElement* pChildXmlElement = dynamic_cast<TiXmlElement*>( pChildXmlNode );
+
+    // Skip if this is not an element?
+    if ( pChildXmlElement == NULL )
+        return;
+
+    // Is this a standard child element?
+    if ( dStrchr( pChildXmlElement->Value(), '.' ) != NULL )
     {
-        // Fetch the Taml children.
-        TamlChildren* pChildren = dynamic_cast<TamlChildren*>( pSimObject );
+        // No, so parse custom element.
+        parseCustomElement( pChildXmlElement, customProperties );
+        return;
+    }
 
-        // Fetch any container child class specifier.
-        AbstractClassRep* pContainerChildClass = pSimObject->getClassRep()->getContainerChildClass( true );
+    // Is this a Taml child?
+    if ( pChildren == NULL )
+    {
+        // No, so warn.
+        Con::warnf("Taml: Child element '%s' found under parent '%s' but object cannot have children.",
+            pChildXmlElement->Value(),
+            pXmlElement->Value() );
 
-        // Iterate siblings.
-        do
-        {
-            // Fetch element.
-            TiXmlElement* pChildXmlElement = dynamic_cast<TiXmlElement*>( pChildXmlNode );
+        // Skip.
+        return;
+    }
 
-            // Move to next sibling.
-            pChildXmlNode = pChildXmlNode->NextSibling();
+    // Yes, so parse child element.
+    SimObject* pChildSimObject = parseElement( pChildXmlElement );
 
-            // Skip if this is not an element?
-            if ( pChildXmlElement == NULL )
-                continue;
+    // Skip if the child was not created.
+    if ( pChildSimObject == NULL )
+        return;
+
+    // Do we have a container child class?
+    if ( pContainerChildClass != NULL )
+    {
+        // Yes, so is the child object the correctly derived type?
+        if ( !pChildSimObject->getClassRep()->isClass( pContainerChildClass ) )
+        {
+            // No, so warn.
+            Con::warnf("Taml: Child element '%s' found under parent '%s' but object is restricted to children of type '%s'.",
+                pChildSimObject->getClassName(),
+                pSimObject->getClassName(),
+                pContainerChildClass->getClassName() );
 
-            // Is this a standard child element?
-            if ( dStrchr( pChildXmlElement->Value(), '.' ) == NULL )
-            {
-                // Is this a Taml child?
-                if ( pChildren == NULL )
-                {
-                    // No, so warn.
-                    Con::warnf("Taml: Child element '%s' found under parent '%s' but object cannot have children.",
-                        pChildXmlElement->Value(),
-                        pXmlElement->Value() );
-
-                    // Skip.
-                    continue;
-                }
-
-                // Yes, so parse child element.
-                SimObject* pChildSimObject = parseElement( pChildXmlElement );
-
-                // Skip if the child was not created.
-                if ( pChildSimObject == NULL )
-                    continue;
-
-                // Do we have a container child class?
-                if ( pContainerChildClass != NULL )
-                {
-                    // Yes, so is the child object the correctly derived type?
-                    if ( !pChildSimObject->getClassRep()->isClass( pContainerChildClass ) )
-                    {
-                        // No, so warn.
-                        Con::warnf("Taml: Child element '%s' found under parent '%s' but object is restricted to children of type '%s'.",
-                            pChildSimObject->getClassName(),
-                            pSimObject->getClassName(),
-                            pContainerChildClass->getClassName() );
-
-                        // NOTE: We can't delete the object as it may be referenced elsewhere!
-                        pChildSimObject = NULL;
-
-                        // Skip.
-                        continue;
-                    }
-                }
-
-                // Add child.
-                pChildren->addTamlChild( pChildSimObject );
-
-                // Find Taml callbacks for child.
-                TamlCallbacks* pChildCallbacks = dynamic_cast<TamlCallbacks*>( pChildSimObject );
-
-                // Do we have callbacks on the child?
-                if ( pChildCallbacks != NULL )
-                {
-                    // Yes, so perform callback.
-                    mpTaml->tamlAddParent( pChildCallbacks, pSimObject );
-                }
-            }
-            else
-            {
-                // No, so parse custom element.
-                parseCustomElement( pChildXmlElement, customProperties );
-            }
+            // NOTE: We can't delete the object as it may be referenced elsewhere!
+            pChildSimObject = NULL;
+
+            // Skip.
+            return;
         }
-        while( pChildXmlNode != NULL );
+    }
+
+    // Add child.
+    pChildren->addTamlChild( pChildSimObject );
+
+    // Find Taml callbacks for child.
+    TamlCallbacks* pChildCallbacks = dynamic_cast<TamlCallbacks*>( pChildSimObject );
 
-        // Call custom read.
+    // Do we have callbacks on the child?
+    if ( pChildCallbacks != NULL )
+    {
+        // Yes, so perform callback.
+        mpTaml->tamlAddParent( pChildCallbacks, pSimObject );
+    }
+}
+
+//-----------------------------------------------------------------------------
+
+void TamlXmlReader::finishElementObject( SimObject* pSimObject, const bool hasChildNodes, TamlCustomNodes& customProperties )
+{
+    // Find Taml callbacks.
+    TamlCallbacks* pCallbacks = dynamic_cast<TamlCallbacks*>( pSimObject );
+
+    // Did we have any element children?
+    if ( hasChildNodes )
+    {
+        // Yes, so call custom read.
         mpTaml->tamlCustomRead( pCallbacks, customProperties );
     }
 
@@ -263,9 +397,6 @@ SimObject* TamlXmlReader::parseElement( TiXmlElement* pXmlElement )
         // Yes, so call it.
         mpTaml->tamlPostRead( pCallbacks, customProperties );
     }
-
-    // Return object.
-    return pSimObject;
 }
 
 //-----------------------------------------------------------------------------
@@ -27,8 +27,8 @@
 #include "collection/hashTable.h"
 #endif
 
-#ifndef _TAML_H_
-#include "persistence/taml/taml.h"
+#ifndef _TAML_READER_H_
+#include "persistence/taml/tamlReader.h"
 #endif
 
 #ifndef TINYXML_INCLUDED
@@ -39,17 +39,25 @@
 
 /// @ingroup tamlGroup
 /// @see tamlGroup
-class TamlXmlReader
+class TamlXmlReader : public TamlReader
 {
 public:
     TamlXmlReader( Taml* pTaml ) :
-        mpTaml( pTaml )
+        mpTaml( pTaml ),
+        mpRootObject( NULL ),
+        mpRootChildren( NULL ),
+        mpRootContainerChildClass( NULL ),
+        mpRootChildXmlNode( NULL ),
+        mRootHasChildNodes( false )
     {}
 
     virtual ~TamlXmlReader() {}
 
-    /// Read.
-    SimObject* read( FileStream& stream );
+    /// Read phases.
+    virtual bool parseDocument( FileStream& stream );
+    virtual SimObject* beginRoot( void );
+    virtual bool readNextChild( void );
+    virtual SimObject* endRoot( void );
 
 private:
     Taml* mpTaml;
@@ -57,10 +65,21 @@ private:
     typedef HashMap<SimObjectId, SimObject*> typeObjectReferenceHash;
     typeObjectReferenceHash mObjectReferenceMap;
 
+    TiXmlDocument       mDocument;
+    SimObject*          mpRootObject;
+    TamlChildren*       mpRootChildren;
+    AbstractClassRep*   mpRootContainerChildClass;
+    TiXmlNode*          mpRootChildXmlNode;
+    bool                mRootHasChildNodes;
+    TamlCustomNodes     mRootCustomNodes;
+
 private:
     void resetParse( void );
 
     SimObject* parseElement( TiXmlElement* pXmlElement );
+    SimObject* createElementObject( TiXmlElement* pXmlElement );
+    void parseChildNode( TiXmlNode* pChildXmlNode, TiXmlElement* pXmlElement, SimObject* pSimObject, TamlChildren* pChildren, AbstractClassRep* pContainerChildClass, TamlCustomNodes& customProperties );
+    void finishElementObject( SimObject* pSimObject, const bool hasChildNodes, TamlCustomNodes& customProperties );
     void parseAttributes( TiXmlElement* pXmlElement, SimObject* pSimObject );
     void parseCustomElement( TiXmlElement* pXmlElement, TamlCustomNodes& pCustomNode );
     void parseCustomNode( TiXmlElement* pXmlElement, TamlCustomNode* pCustomNode );
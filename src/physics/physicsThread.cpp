@@ -25,6 +25,7 @@
 #include "sim/simBase.h"
 #include "physicsThread.h"
 #include "math/mMath.h"
+#include "debug/profiler.h"
 
 #include <bx/timer.h>
 
@@ -39,6 +40,8 @@ namespace Physics
    // This only executes if TORQUE_MULTITHREAD is defined.
    void PhysicsThread::run(void *arg)
    {
+      TimelineProfiler::setThreadName("Physics");
+
       U64 previousTime = bx::getHPCounter();
 
       while ( !shouldStop )
@@ -82,11 +82,13 @@ class AudioAsset;
 class AudioEnvironment;
 class AudioSampleEnvironment;
 class AudioStreamSource;
+class AudioStreamThread;
 
 AUDIOHANDLE alxCreateSource(const Audio::Description *desc, const char *filename, const MatrixF *transform=NULL, AudioSampleEnvironment * sampleEnvironment = 0);
 AUDIOHANDLE alxCreateSource(AudioDescription *descObject, const char *filename, const MatrixF *transform=NULL, AudioSampleEnvironment * sampleEnvironment = 0);
 AUDIOHANDLE alxCreateSource(const AudioAsset *profile, const MatrixF *transform=NULL);
 AudioStreamSource* alxFindAudioStreamSource(AUDIOHANDLE handle);
+AudioStreamThread* alxGetStreamThread();
 
 AUDIOHANDLE alxPlay(AUDIOHANDLE handle);
 bool alxPause(AUDIOHANDLE handle);
@@ -99,6 +101,14 @@ void alxStopAll();
 // one-shot helper alxPlay functions, create and play in one call
 AUDIOHANDLE alxPlay(const AudioAsset *profile, const MatrixF *transform=NULL, const Point3F *velocity=NULL);
 
+// Virtual voices: any number can play, the highest priority and most audible
+// ones get the real sources and the others keep time until they win one back.
+// alxPlay plays one-shots as voices. Streams are not supported. The handles
+// work with alxStop, alxPause, alxSourcef and friends.
+AUDIOHANDLE alxPlayVoice(const AudioAsset *profile, const Point3F *position=NULL, S32 priority=0);
+void alxVoicePriority(AUDIOHANDLE handle, S32 priority);
+bool alxIsVirtualVoice(AUDIOHANDLE handle);
+
 
 // Source
 void alxSourcef(AUDIOHANDLE handle, ALenum pname, ALfloat value);
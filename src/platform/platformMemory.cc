@@ -32,6 +32,7 @@
 
 void* dMalloc_r(dsize_t in_size, const char* fileName, const dsize_t line)
 {
+   PROFILE_COUNT(Allocations, 1);
    return malloc(in_size);
 }
 
@@ -46,5 +47,6 @@ void dFree(void* in_pFree)
 
 void* dRealloc_r(void* in_pResize, dsize_t in_size, const char* fileName, const dsize_t line)
 {
+   PROFILE_COUNT(Allocations, 1);
    return realloc(in_pResize,in_size);
 }
@@ -25,6 +25,7 @@
 #include "platform/threads/thread.h"
 #include "platform/platformNetAsync.unix.h"
 #include "console/console.h"
+#include "debug/profiler.h"
 
 #include <netdb.h>
 #include <unistd.h>
@@ -108,6 +109,8 @@ void NetAsync::run()
    mRunning = true;
    NameLookupRequest* lookupRequest = NULL;
 
+   TimelineProfiler::setThreadName("NetAsync");
+
    while (isRunning())
    {
       lookupRequest = NULL;
@@ -0,0 +1,230 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2013 GarageGames, LLC
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//-----------------------------------------------------------------------------
+
+#include "platform/platformServerScheduler.h"
+#include "platform/platform.h"
+#include "platform/event.h"
+#include "game/gameInterface.h"
+#include "game/processList.h"
+#include "console/console.h"
+#include "console/consoleTypes.h"
+#include "debug/profiler.h"
+
+// Script binding.
+#include "platform/platformServerScheduler_Binding.h"
+
+//------------------------------------------------------------------------------
+
+enum
+{
+   JitterSamples  = 1024,
+   StatsPeriod    = 1000000, ///< Console variables are refreshed once a second.
+};
+
+static S32  sgServerTickMs = TickMs;
+static bool sInitialized = false;
+static U64  sNextTick = 0;
+static U64  sLastTimeEvent = 0;
+
+// Lifetime statistics.
+static U32  sJitter[JitterSamples];
+static U32  sJitterCount = 0;
+static U32  sJitterNext = 0;
+static U64  sJitterTotal = 0;
+static U32  sJitterMax = 0;
+static U32  sTickCount = 0;
+static U32  sSkippedTicks = 0;
+static U64  sStartTime = 0;
+static U64  sStartCPUTime = 0;
+static U64  sIdleTime = 0;
+
+// Statistics of the current reporting period, exposed as console variables.
+static U64  sPeriodStart = 0;
+static U64  sPeriodCPUStart = 0;
+static U64  sPeriodIdle = 0;
+static U64  sPeriodJitterTotal = 0;
+static U32  sPeriodJitterMax = 0;
+static U32  sPeriodTicks = 0;
+
+static F32  sgTickJitter = 0.0f;
+static F32  sgTickJitterMax = 0.0f;
+static F32  sgCPUUsage = 0.0f;
+static F32  sgIdleTime = 0.0f;
+
+//------------------------------------------------------------------------------
+
+static void initScheduler()
+{
+   // Keep a tick length set from prefs before the variable was bound.
+   if (Con::getIntVariable("$pref::Server::tickMs") > 0)
+      sgServerTickMs = Con::getIntVariable("$pref::Server::tickMs");
+
+   Con::addVariable("$pref::Server::tickMs", TypeS32, &sgServerTickMs);
+   Con::addVariable("$Server::TickJitter", TypeF32, &sgTickJitter);
+   Con::addVariable("$Server::TickJitterMax", TypeF32, &sgTickJitterMax);
+   Con::addVariable("$Server::CPUUsage", TypeF32, &sgCPUUsage);
+   Con::addVariable("$Server::IdleTime", TypeF32, &sgIdleTime);
+
+   ServerScheduler::resetStats();
+
+   sLastTimeEvent = ServerScheduler::getMonotonicTime();
+   sNextTick = sLastTimeEvent;
+   sInitialized = true;
+}
+
+static void updatePeriodStats(U64 now)
+{
+   const U64 wallTime = now - sPeriodStart;
+   if (wallTime < StatsPeriod)
+      return;
+
+   const U64 cpuTime = ServerScheduler::getProcessCPUTime();
+
+   sgCPUUsage        = 100.0f * F32(F64(cpuTime - sPeriodCPUStart) / F64(wallTime));
+   sgIdleTime        = 100.0f * F32(F64(sPeriodIdle) / F64(wallTime));
+   sgTickJitter      = (sPeriodTicks > 0) ? F32(F64(sPeriodJitterTotal) / F64(sPeriodTicks) / 1000.0) : 0.0f;
+   sgTickJitterMax   = F32(sPeriodJitterMax) / 1000.0f;
+
+   sPeriodStart         = now;
+   sPeriodCPUStart      = cpuTime;
+   sPeriodIdle          = 0;
+   sPeriodJitterTotal   = 0;
+   sPeriodJitterMax     = 0;
+   sPeriodTicks         = 0;
+}
+
+//------------------------------------------------------------------------------
+
+void ServerScheduler::process()
+{
+   // Journal playback runs as fast as it can on the recorded time events.
+   if (Game->isJournalReading())
+      return;
+
+   if (!sInitialized)
+      initScheduler();
+
+   const U64 tickLength = U64(getMax(sgServerTickMs, 1)) * 1000;
+
+   U64 now = getMonotonicTime();
+   if (now < sNextTick)
+   {
+      PROFILE_START(ServerSchedulerSleep);
+      sleepUntil(sNextTick);
+      PROFILE_END();
+
+      U64 wake = getMonotonicTime();
+      sIdleTime   += wake - now;
+      sPeriodIdle += wake - now;
+      now = wake;
+   }
+
+   // How late this tick started.
+   const U32 jitter = (now > sNextTick) ? (U32)((now - sNextTick < U32_MAX) ? now - sNextTick : U32_MAX) : 0;
+   sJitter[sJitterNext] = jitter;
+   sJitterNext = (sJitterNext + 1) % JitterSamples;
+   if (sJitterCount < JitterSamples)
+      sJitterCount++;
+   sJitterTotal         += jitter;
+   sJitterMax           = getMax(sJitterMax, jitter);
+   sPeriodJitterTotal   += jitter;
+   sPeriodJitterMax     = getMax(sPeriodJitterMax, jitter);
+   sTickCount++;
+   sPeriodTicks++;
+
+   // Post whole milliseconds and carry the remainder so no time is lost.
+   const U32 elapsedMs = (U32)((now - sLastTimeEvent) / 1000);
+   sLastTimeEvent += U64(elapsedMs) * 1000;
+
+   TimeEvent event;
+   event.elapsedTime = elapsedMs;
+   Game->postEvent(event);
+
+   // Schedule the next tick on the fixed grid. If we fell more than a tick
+   // behind, drop the missed ones rather than running them back to back.
+   sNextTick += tickLength;
+   if (sNextTick + tickLength <= now)
+   {
+      sSkippedTicks += (U32)((now - sNextTick) / tickLength);
+      sNextTick = now + tickLength;
+   }
+
+   updatePeriodStats(now);
+}
+
+//------------------------------------------------------------------------------
+
+void ServerScheduler::resetStats()
+{
+   dMemset(sJitter, 0, sizeof(sJitter));
+   sJitterCount   = 0;
+   sJitterNext    = 0;
+   sJitterTotal   = 0;
+   sJitterMax     = 0;
+   sTickCount     = 0;
+   sSkippedTicks  = 0;
+   sIdleTime      = 0;
+   sStartTime     = getMonotonicTime();
+   sStartCPUTime  = getProcessCPUTime();
+
+   sPeriodStart         = sStartTime;
+   sPeriodCPUStart      = sStartCPUTime;
+   sPeriodIdle          = 0;
+   sPeriodJitterTotal   = 0;
+   sPeriodJitterMax     = 0;
+   sPeriodTicks         = 0;
+}
+
+static S32 QSORT_CALLBACK compareJitter(const void* a, const void* b)
+{
+   U32 jitterA = *((U32*)a);
+   U32 jitterB = *((U32*)b);
+   return (jitterA < jitterB) ? -1 : ((jitterA > jitterB) ? 1 : 0);
+}
+
+void ServerScheduler::dumpStats()
+{
+   if (!sInitialized)
+   {
+      Con::printf("Server Scheduler: not running, only used in headless mode.");
+      return;
+   }
+
+   const U64 now = getMonotonicTime();
+   const U64 wallTime = (now > sStartTime) ? now - sStartTime : 1;
+   const U64 cpuTime = getProcessCPUTime() - sStartCPUTime;
+
+   U32 sorted[JitterSamples];
+   dMemcpy(sorted, sJitter, sizeof(U32) * sJitterCount);
+   dQsort(sorted, sJitterCount, sizeof(U32), compareJitter);
+
+   const U32 p50 = (sJitterCount > 0) ? sorted[(sJitterCount - 1) / 2] : 0;
+   const U32 p99 = (sJitterCount > 0) ? sorted[(sJitterCount - 1) * 99 / 100] : 0;
+
+   Con::printf("Server Scheduler (%dms ticks, %.1fs):", sgServerTickMs, F64(wallTime) / 1000000.0);
+   Con::printf("   Ticks     : %u, %u skipped", sTickCount, sSkippedTicks);
+   Con::printf("   Jitter    : avg %.3fms p50 %.3fms p99 %.3fms max %.3fms",
+      (sTickCount > 0) ? F64(sJitterTotal) / F64(sTickCount) / 1000.0 : 0.0,
+      F64(p50) / 1000.0, F64(p99) / 1000.0, F64(sJitterMax) / 1000.0);
+   Con::printf("   CPU Usage : %.1f%%", 100.0 * F64(cpuTime) / F64(wallTime));
+   Con::printf("   Idle Time : %.1f%%", 100.0 * F64(sIdleTime) / F64(wallTime));
+}
@@ -0,0 +1,55 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2013 GarageGames, LLC
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//-----------------------------------------------------------------------------
+
+#ifndef _PLATFORM_SERVER_SCHEDULER_H_
+#define _PLATFORM_SERVER_SCHEDULER_H_
+
+#ifndef _TORQUE_TYPES_H_
+#include "platform/types.h"
+#endif
+
+//------------------------------------------------------------------------------
+
+/// Replaces TimeManager on a headless server. Instead of polling, the main
+/// loop sleeps on a monotonic clock until the next tick is due and then posts
+/// a TimeEvent covering the time since the last one.
+struct ServerScheduler
+{
+   /// Called from the main loop in headless mode. Returns immediately while a
+   /// journal is played back, the journal supplies the time events then.
+   static void process();
+
+   static void resetStats();
+   static void dumpStats();
+
+   /// @name Platform
+   /// Implemented per platform, all times in microseconds.
+   /// @{
+
+   static U64 getMonotonicTime();
+   static void sleepUntil(U64 deadline);
+   static U64 getProcessCPUTime();
+
+   /// @}
+};
+
+#endif // _PLATFORM_SERVER_SCHEDULER_H_
@@ -0,0 +1,70 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2013 GarageGames, LLC
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//-----------------------------------------------------------------------------
+
+#include "platform/platformServerScheduler.h"
+
+#include <errno.h>
+#include <time.h>
+#include <sys/resource.h>
+
+//-----------------------------------------------------------------------------
+// POSIX implementation of the server scheduler platform layer.
+//-----------------------------------------------------------------------------
+
+U64 ServerScheduler::getMonotonicTime()
+{
+   struct timespec ts;
+   clock_gettime(CLOCK_MONOTONIC, &ts);
+   return U64(ts.tv_sec) * 1000000 + U64(ts.tv_nsec) / 1000;
+}
+
+void ServerScheduler::sleepUntil(U64 deadline)
+{
+#if defined(__APPLE__)
+   // No clock_nanosleep, sleep relative and go around again if woken early.
+   U64 now = getMonotonicTime();
+   while (now < deadline)
+   {
+      struct timespec ts;
+      ts.tv_sec  = (time_t)((deadline - now) / 1000000);
+      ts.tv_nsec = (long)((deadline - now) % 1000000) * 1000;
+      nanosleep(&ts, NULL);
+      now = getMonotonicTime();
+   }
+#else
+   // An absolute deadline doesn't drift when a signal interrupts the sleep.
+   struct timespec ts;
+   ts.tv_sec  = (time_t)(deadline / 1000000);
+   ts.tv_nsec = (long)(deadline % 1000000) * 1000;
+   while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL) == EINTR)
+      ;
+#endif
+}
+
+U64 ServerScheduler::getProcessCPUTime()
+{
+   struct rusage usage;
+   if (getrusage(RUSAGE_SELF, &usage) != 0)
+      return 0;
+
+   return U64(usage.ru_utime.tv_sec + usage.ru_stime.tv_sec) * 1000000 + U64(usage.ru_utime.tv_usec + usage.ru_stime.tv_usec);
+}
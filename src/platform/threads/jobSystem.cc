@@ -0,0 +1,621 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2013 GarageGames, LLC
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//-----------------------------------------------------------------------------
+
+#include "platform/threads/jobSystem.h"
+#include "platform/threads/thread.h"
+#include "platform/threads/mutex.h"
+#include "platform/threads/semaphore.h"
+#include "platform/platform.h"
+#include "console/console.h"
+#include "console/consoleTypes.h"
+#include "memory/safeDelete.h"
+#include "debug/profiler.h"
+
+#include "jobSystem_Binding.h"
+
+//-----------------------------------------------------------------------------
+
+namespace {
+
+// Ring buffer deque. The owner pushes and pops the newest end, thieves and
+// the main thread queue take from the oldest end. Every operation is O(1),
+// the ring only grows when it's full.
+struct JobQueue
+{
+   enum { InitialCapacity = 256 };
+
+   Mutex    mLock;
+   Job*     mJobs;
+   U32      mCapacity;  // power of two
+   U32      mHead;      // oldest job
+   U32      mTail;      // one past the newest job
+
+   JobQueue() : mCapacity(InitialCapacity), mHead(0), mTail(0)
+   {
+      mJobs = new Job[mCapacity];
+   }
+
+   ~JobQueue()
+   {
+      delete [] mJobs;
+   }
+
+   U32 size() const { return mTail - mHead; }
+
+   void push(const Job& job)
+   {
+      if (size() == mCapacity)
+         grow();
+
+      mJobs[mTail & (mCapacity - 1)] = job;
+      mTail++;
+   }
+
+   bool popNewest(Job& job)
+   {
+      if (mHead == mTail)
+         return false;
+
+      mTail--;
+      job = mJobs[mTail & (mCapacity - 1)];
+      return true;
+   }
+
+   bool popOldest(Job& job)
+   {
+      if (mHead == mTail)
+         return false;
+
+      job = mJobs[mHead & (mCapacity - 1)];
+      mHead++;
+      return true;
+   }
+
+   void grow()
+   {
+      U32 count = size();
+      Job* jobs = new Job[mCapacity * 2];
+      for (U32 n = 0; n < count; ++n)
+         jobs[n] = mJobs[(mHead + n) & (mCapacity - 1)];
+
+      delete [] mJobs;
+      mJobs = jobs;
+      mCapacity *= 2;
+      mHead = 0;
+      mTail = count;
+   }
+};
+
+class JobWorker;
+
+bool           sInitialized = false;
+U32            sWorkerCount = 0;
+JobWorker*     sWorkers[JobSystem::MaxWorkers];
+
+// Queue 0 belongs to the main thread, the rest to the workers.
+JobQueue*      sQueues[JobSystem::MaxWorkers + 1];
+JobQueue*      sMainThreadQueue = NULL;
+JobScratch     sScratch[JobSystem::MaxWorkers + 1];
+Mutex*         sContinuationLock = NULL;
+
+Semaphore*     sWakeSignal = NULL;
+volatile S32   sSleepingWorkers = 0;
+
+// Threads blocked in JobSystem::wait().
+Semaphore*     sWaitSignal = NULL;
+volatile S32   sWaitingThreads = 0;
+
+// Per thread statistics, only written by their own thread.
+U32            sJobsRun[JobSystem::MaxWorkers + 1];
+U32            sJobsStolen[JobSystem::MaxWorkers + 1];
+S32            sConsoleWorkerCount = 0;
+
+void finishJob(const Job& job);
+
+void executeJob(S32 index, const Job& job)
+{
+   // Anything the job takes from the scratch arena goes away with it.
+   JobScratch* scratch = index >= 0 ? &sScratch[index] : NULL;
+   U32 waterMark = scratch ? scratch->getWaterMark() : 0;
+
+   job.mFunction(job.mData, job.mFirst, job.mCount);
+
+   if (scratch)
+      scratch->setWaterMark(waterMark);
+
+   if (index >= 0)
+      sJobsRun[index]++;
+
+   finishJob(job);
+}
+
+// Waiters check their own counter, so all of them wake up.
+void wakeWaiters()
+{
+   S32 waiting = JobSystem::atomicAdd(&sWaitingThreads, 0);
+   for (S32 n = 0; n < waiting; ++n)
+      sWaitSignal->release();
+}
+
+void wakeWorkers(U32 jobCount)
+{
+   S32 sleeping = JobSystem::atomicAdd(&sSleepingWorkers, 0);
+   U32 wake = getMin((U32)getMax(sleeping, 0), jobCount);
+   for (U32 n = 0; n < wake; ++n)
+      sWakeSignal->release();
+
+   // Threads waiting on a counter help with new jobs too.
+   wakeWaiters();
+}
+
+void enqueue(const Job& job)
+{
+   if (job.mMainThread)
+   {
+      sMainThreadQueue->mLock.lock();
+      sMainThreadQueue->push(job);
+      sMainThreadQueue->mLock.unlock();
+      return;
+   }
+
+   // Threads outside the job system feed the main thread's queue.
+   S32 index = getMax(JobSystem::getThreadIndex(), 0);
+   JobQueue* queue = sQueues[index];
+   queue->mLock.lock();
+   queue->push(job);
+   queue->mLock.unlock();
+
+   wakeWorkers(1);
+}
+
+void finishJob(const Job& job)
+{
+   JobCounter* counter = job.mCounter;
+   if (counter == NULL)
+      return;
+
+   // The counter isn't done until mFinishing drops too, so a waiter can't
+   // destroy it while the last job is still taking the continuations.
+   JobSystem::atomicAdd(&counter->mFinishing, 1);
+   if (JobSystem::atomicAdd(&counter->mPending, -1) != 0)
+   {
+      // An earlier last job may have left the rest of the counter to us.
+      if (JobSystem::atomicAdd(&counter->mFinishing, -1) == 0)
+         wakeWaiters();
+      return;
+   }
+
+   // Last job of the group, hand over the continuations.
+   Vector<Job> continuations;
+   sContinuationLock->lock();
+   continuations.merge(counter->mContinuations);
+   counter->mContinuations.clear();
+   sContinuationLock->unlock();
+
+   // The counter may be gone after this.
+   if (JobSystem::atomicAdd(&counter->mFinishing, -1) == 0)
+      wakeWaiters();
+
+   for (S32 n = 0; n < continuations.size(); ++n)
+      enqueue(continuations[n]);
+}
+
+bool popJob(JobQueue* queue, Job& job, bool oldest)
+{
+   queue->mLock.lock();
+   bool found = oldest ? queue->popOldest(job) : queue->popNewest(job);
+   queue->mLock.unlock();
+   return found;
+}
+
+bool findJob(S32 index, Job& job)
+{
+   if (index >= 0 && popJob(sQueues[index], job, false))
+      return true;
+
+   // Steal, starting with the next queue so thieves spread out.
+   U32 queueCount = sWorkerCount + 1;
+   U32 start = (U32)(index + 1);
+   for (U32 n = 0; n < queueCount; ++n)
+   {
+      U32 victim = (start + n) % queueCount;
+      if ((S32)victim == index)
+         continue;
+
+      if (popJob(sQueues[victim], job, true))
+      {
+         if (index >= 0)
+            sJobsStolen[index]++;
+         return true;
+      }
+   }
+
+   return false;
+}
+
+class JobWorker : public Thread
+{
+public:
+   S32 mIndex;
+
+   JobWorker(S32 index)
+      : Thread(0, 0, false),
+        mIndex(index)
+   {
+      start();
+   }
+
+   virtual void run(void *arg = 0)
+   {
+      JobSystem::setThreadIndex(mIndex);
+      // avar() shares one buffer and every worker gets here at once.
+      char name[32];
+      dSprintf(name, sizeof(name), "Job Worker %d", mIndex);
+      TimelineProfiler::setThreadName(name);
+
+      while (true)
+      {
+         Job job;
+         if (findJob(mIndex, job))
+         {
+            executeJob(mIndex, job);
+            continue;
+         }
+
+         if (checkForStop())
+            break;
+
+         // Look once more after announcing we're going to sleep, so a job
+         // pushed in between either gets seen here or wakes us up.
+         JobSystem::atomicAdd(&sSleepingWorkers, 1);
+         if (findJob(mIndex, job))
+         {
+            JobSystem::atomicAdd(&sSleepingWorkers, -1);
+            executeJob(mIndex, job);
+            continue;
+         }
+
+         sWakeSignal->acquire();
+         JobSystem::atomicAdd(&sSleepingWorkers, -1);
+      }
+   }
+};
+
+} // namespace {}
+
+//-----------------------------------------------------------------------------
+
+void* JobScratch::alloc(U32 size)
+{
+   U32 start = (mWaterMark + 15) & ~15;
+   AssertFatal(start + size <= mSize, "JobScratch::alloc - out of scratch memory, increase JobSystem::ScratchSize!");
+   if (start + size > mSize)
+      return NULL;
+
+   mWaterMark = start + size;
+   mPeak = getMax(mPeak, mWaterMark);
+   return mBuffer + start;
+}
+
+void JobScratch::setWaterMark(U32 waterMark)
+{
+   AssertFatal(waterMark <= mWaterMark, "JobScratch::setWaterMark - can't move the water mark forward.");
+   mWaterMark = waterMark;
+}
+
+//-----------------------------------------------------------------------------
+
+void JobSystem::init(U32 workerCount)
+{
+   if (sInitialized)
+      return;
+
+   if (workerCount == 0)
+   {
+      U32 cores = getCoreCount();
+      workerCount = cores > 1 ? cores - 1 : 0;
+   }
+   sWorkerCount = getMin(workerCount, (U32)MaxWorkers);
+
+   for (U32 n = 0; n <= sWorkerCount; ++n)
+   {
+      sQueues[n] = new JobQueue();
+      sScratch[n].mBuffer = (U8*)dMalloc(ScratchSize);
+      sScratch[n].mSize = ScratchSize;
+      sScratch[n].mWaterMark = 0;
+      sScratch[n].mPeak = 0;
+      sJobsRun[n] = 0;
+      sJobsStolen[n] = 0;
+   }
+
+   sMainThreadQueue = new JobQueue();
+   sContinuationLock = new Mutex();
+   sWakeSignal = new Semaphore(0);
+   sSleepingWorkers = 0;
+   sWaitSignal = new Semaphore(0);
+   sWaitingThreads = 0;
+
+   setThreadIndex(0);
+   sInitialized = true;
+
+   for (U32 n = 0; n < sWorkerCount; ++n)
+      sWorkers[n] = new JobWorker(n + 1);
+
+   sConsoleWorkerCount = sWorkerCount;
+   Con::addVariable("$Jobs::workerCount", TypeS32, &sConsoleWorkerCount);
+   Con::printf("Job System: %d workers.", sWorkerCount);
+}
+
+void JobSystem::destroy()
+{
+   if (!sInitialized)
+      return;
+
+   // Let the main thread finish what's queued before the workers go.
+   processMainThreadJobs();
+
+   for (U32 n = 0; n < sWorkerCount; ++n)
+      sWorkers[n]->stop();
+   for (U32 n = 0; n < sWorkerCount; ++n)
+      sWakeSignal->release();
+   for (U32 n = 0; n < sWorkerCount; ++n)
+   {
+      sWorkers[n]->join();
+      SAFE_DELETE(sWorkers[n]);
+   }
+
+   // Jobs left in the queues are run here so their counters are released.
+   Job job;
+   while (findJob(0, job))
+      executeJob(0, job);
+   processMainThreadJobs();
+
+   for (U32 n = 0; n <= sWorkerCount; ++n)
+   {
+      SAFE_DELETE(sQueues[n]);
+      dFree(sScratch[n].mBuffer);
+      sScratch[n].mBuffer = NULL;
+      sScratch[n].mSize = 0;
+   }
+
+   SAFE_DELETE(sMainThreadQueue);
+   SAFE_DELETE(sContinuationLock);
+   SAFE_DELETE(sWakeSignal);
+   SAFE_DELETE(sWaitSignal);
+
+   sWorkerCount = 0;
+   sInitialized = false;
+}
+
+bool JobSystem::isInitialized()
+{
+   return sInitialized;
+}
+
+U32 JobSystem::getWorkerCount()
+{
+   return sWorkerCount;
+}
+
+//-----------------------------------------------------------------------------
+
+void JobSystem::submit(JobFunction function, void* data, JobCounter* counter)
+{
+   Job job;
+   job.mFunction     = function;
+   job.mData         = data;
+   job.mFirst        = 0;
+   job.mCount        = 1;
+   job.mCounter      = counter;
+   job.mMainThread   = false;
+
+   if (counter)
+      atomicAdd(&counter->mPending, 1);
+
+   if (!sInitialized || sWorkerCount == 0)
+   {
+      executeJob(getThreadIndex(), job);
+      return;
+   }
+
+   enqueue(job);
+}
+
+void JobSystem::submitMainThread(JobFunction function, void* data, JobCounter* counter)
+{
+   Job job;
+   job.mFunction     = function;
+   job.mData         = data;
+   job.mFirst        = 0;
+   job.mCount        = 1;
+   job.mCounter      = counter;
+   job.mMainThread   = true;
+
+   if (counter)
+      atomicAdd(&counter->mPending, 1);
+
+   // Queued even on the main thread, it may be inside a job or a wait.
+   if (!sInitialized)
+   {
+      executeJob(getThreadIndex(), job);
+      return;
+   }
+
+   enqueue(job);
+}
+
+void JobSystem::parallelFor(U32 count, U32 grain, JobFunction function, void* data, JobCounter* counter)
+{
+   if (count == 0)
+      return;
+
+   if (grain == 0)
+      grain = getMax(count / ((sWorkerCount + 1) * 4), (U32)1);
+
+   U32 jobCount = (count + grain - 1) / grain;
+   if (counter)
+      atomicAdd(&counter->mPending, jobCount);
+
+   Job job;
+   job.mFunction     = function;
+   job.mData         = data;
+   job.mCounter      = counter;
+   job.mMainThread   = false;
+
+   if (!sInitialized || sWorkerCount == 0 || jobCount == 1)
+   {
+      for (U32 first = 0; first < count; first += grain)
+      {
+         job.mFirst = first;
+         job.mCount = getMin(grain, count - first);
+         executeJob(getThreadIndex(), job);
+      }
+      return;
+   }
+
+   // Push the whole range under one lock, in reverse so the owner pops the
+   // first range first and thieves take from the end.
+   S32 index = getMax(getThreadIndex(), 0);
+   JobQueue* queue = sQueues[index];
+   queue->mLock.lock();
+   for (S32 n = jobCount - 1; n >= 0; --n)
+   {
+      job.mFirst = n * grain;
+      job.mCount = getMin(grain, count - job.mFirst);
+      queue->push(job);
+   }
+   queue->mLock.unlock();
+
+   wakeWorkers(jobCount);
+}
+
+void JobSystem::addContinuation(JobCounter& counter, JobFunction function, void* data, JobCounter* continuationCounter, bool mainThread)
+{
+   Job job;
+   job.mFunction     = function;
+   job.mData         = data;
+   job.mFirst        = 0;
+   job.mCount        = 1;
+   job.mCounter      = continuationCounter;
+   job.mMainThread   = mainThread;
+
+   if (continuationCounter)
+      atomicAdd(&continuationCounter->mPending, 1);
+
+   if (sInitialized)
+   {
+      sContinuationLock->lock();
+      bool pending = atomicAdd(&counter.mPending, 0) > 0;
+      if (pending)
+         counter.mContinuations.push_back(job);
+      sContinuationLock->unlock();
+
+      if (pending)
+         return;
+   }
+
+   // Already done.
+   if (!sInitialized || (!mainThread && sWorkerCount == 0))
+      executeJob(getThreadIndex(), job);
+   else
+      enqueue(job);
+}
+
+void JobSystem::wait(JobCounter& counter)
+{
+   PROFILE_SCOPE(JobSystem_Wait);
+
+   // Main thread jobs are left to processMainThreadJobs(), running them here
+   // would re-enter whatever system is waiting.
+   S32 index = getThreadIndex();
+   while (!counter.isDone())
+   {
+      Job job;
+      if (sInitialized && findJob(index, job))
+      {
+         executeJob(index, job);
+         continue;
+      }
+
+      AssertFatal(sInitialized, "JobSystem::wait - counter has jobs but the job system isn't running.");
+      if (!sInitialized)
+         return;
+
+      // Whatever is left is running on other threads. Look once more after
+      // announcing we're going to block, so a job finishing or being pushed
+      // in between either gets seen here or wakes us up.
+      atomicAdd(&sWaitingThreads, 1);
+      if (counter.isDone())
+      {
+         atomicAdd(&sWaitingThreads, -1);
+         break;
+      }
+
+      if (findJob(index, job))
+      {
+         atomicAdd(&sWaitingThreads, -1);
+         executeJob(index, job);
+         continue;
+      }
+
+      sWaitSignal->acquire();
+      atomicAdd(&sWaitingThreads, -1);
+   }
+}
+
+void JobSystem::processMainThreadJobs()
+{
+   if (!sInitialized)
+      return;
+
+   PROFILE_SCOPE(JobSystem_MainThreadJobs);
+
+   // Only run what's queued now, jobs can queue more for the next frame.
+   sMainThreadQueue->mLock.lock();
+   U32 count = sMainThreadQueue->size();
+   sMainThreadQueue->mLock.unlock();
+
+   Job job;
+   while (count-- > 0 && popJob(sMainThreadQueue, job, true))
+      executeJob(0, job);
+}
+
+JobScratch& JobSystem::getScratch()
+{
+   S32 index = getThreadIndex();
+   AssertFatal(sInitialized && index >= 0, "JobSystem::getScratch - only job system threads have a scratch arena.");
+   return sScratch[getMax(index, 0)];
+}
+
+void JobSystem::dumpStats()
+{
+   Con::printf("Job System: %d workers, %d cores.", sWorkerCount, getCoreCount());
+   if (!sInitialized)
+      return;
+
+   for (U32 n = 0; n <= sWorkerCount; ++n)
+   {
+      Con::printf("   - %s %d: %d jobs run, %d stolen, %d queued, scratch peak %d KB.",
+         n == 0 ? "main" : "worker", n, sJobsRun[n], sJobsStolen[n], sQueues[n]->size(), sScratch[n].getPeak() / 1024);
+   }
+   Con::printf("   - %d main thread jobs queued.", sMainThreadQueue->size());
+}
@@ -0,0 +1,183 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2013 GarageGames, LLC
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//-----------------------------------------------------------------------------
+
+#ifndef _JOB_SYSTEM_H_
+#define _JOB_SYSTEM_H_
+
+#ifndef _TORQUE_TYPES_H_
+#include "platform/types.h"
+#endif
+
+#ifndef _PLATFORMASSERT_H_
+#include "platform/platformAssert.h"
+#endif
+
+#ifndef _VECTOR_H_
+#include "collection/vector.h"
+#endif
+
+#include "platform/platformLibrary.h"
+
+//-----------------------------------------------------------------------------
+// Job System
+//
+// A fixed pool of worker threads, sized from the CPU core count, shared by
+// the whole engine. Each worker owns a ring buffer deque; it pops its own
+// jobs newest first and steals the oldest jobs from the other queues when it
+// runs dry.
+// The main thread has a queue too, so jobs it submits are stolen by workers
+// while it keeps going.
+//
+// A job is a function, a data pointer and a [first, first+count) range. Jobs
+// are usually grouped with a JobCounter: every job submitted with the counter
+// increments it, every finished job decrements it. Waiting on a counter runs
+// other jobs and blocks once there are none left, and continuations attached
+// to a counter are submitted as soon as it reaches zero.
+//
+// Jobs submitted with submitMainThread() only run on the main thread, from
+// processMainThreadJobs() once per frame. Waiting never runs them, so the
+// main thread must not wait on a counter of main thread jobs.
+//
+// Every thread that runs jobs has a scratch arena. Allocations made from it
+// during a job are released when the job returns.
+//-----------------------------------------------------------------------------
+
+typedef void (*JobFunction)(void* data, U32 first, U32 count);
+
+class JobCounter;
+
+struct Job
+{
+   JobFunction    mFunction;
+   void*          mData;
+   U32            mFirst;
+   U32            mCount;
+   JobCounter*    mCounter;
+   bool           mMainThread;
+};
+
+//-----------------------------------------------------------------------------
+
+class JobCounter
+{
+public:
+   /// Managed by the job system, don't touch.
+   volatile S32   mPending;
+   volatile S32   mFinishing;    // jobs still touching the counter after their decrement
+   Vector<Job>    mContinuations;
+
+   JobCounter() : mPending(0), mFinishing(0) { }
+   ~JobCounter() { AssertFatal(mPending == 0 && mFinishing == 0, "JobCounter - destroyed with jobs still pending."); }
+
+   /// Pending first, a job enters mFinishing before it leaves mPending.
+   bool isDone() const { return mPending == 0 && mFinishing == 0; }
+   S32 getPending() const { return mPending; }
+};
+
+//-----------------------------------------------------------------------------
+
+class DLL_PUBLIC JobScratch
+{
+   friend class JobSystem;
+
+protected:
+   U8*   mBuffer;
+   U32   mSize;
+   U32   mWaterMark;
+   U32   mPeak;
+
+public:
+   JobScratch() : mBuffer(NULL), mSize(0), mWaterMark(0), mPeak(0) { }
+
+   /// Allocate 16 byte aligned memory that lives until the current job returns.
+   void* alloc(U32 size);
+
+   U32 getWaterMark() const { return mWaterMark; }
+   void setWaterMark(U32 waterMark);
+   U32 getPeak() const { return mPeak; }
+};
+
+//-----------------------------------------------------------------------------
+
+class DLL_PUBLIC JobSystem
+{
+public:
+   enum Constants
+   {
+      MaxWorkers     = 31,
+      ScratchSize    = 256 * 1024,
+   };
+
+   /// Start the workers. A worker count of zero uses one per core, minus one
+   /// for the main thread. The calling thread becomes the main thread.
+   static void init(U32 workerCount = 0);
+   static void destroy();
+   static bool isInitialized();
+
+   static U32 getWorkerCount();
+
+   /// 0 on the main thread, 1 to getWorkerCount() on workers and -1 on
+   /// threads that aren't part of the job system.
+   static S32 getThreadIndex();
+
+   /// Queue a job. When the job system isn't running it's executed right away.
+   static void submit(JobFunction function, void* data, JobCounter* counter = NULL);
+
+   /// Queue a job that will only run on the main thread, from the next
+   /// processMainThreadJobs().
+   static void submitMainThread(JobFunction function, void* data, JobCounter* counter = NULL);
+
+   /// Split [0, count) into jobs of at most grain items. A grain of zero picks
+   /// one that gives every thread a few jobs.
+   static void parallelFor(U32 count, U32 grain, JobFunction function, void* data, JobCounter* counter);
+
+   /// Submit a job once every job of counter has finished. continuationCounter
+   /// is incremented right away so it can be waited on before that happens.
+   static void addContinuation(JobCounter& counter, JobFunction function, void* data, JobCounter* continuationCounter = NULL, bool mainThread = false);
+
+   /// Run jobs until counter reaches zero, blocking while the last ones run
+   /// on other threads. Main thread jobs are never run here.
+   static void wait(JobCounter& counter);
+
+   /// Run the queued main thread jobs. Called once per frame from the main loop.
+   static void processMainThreadJobs();
+
+   /// Scratch arena of the calling thread.
+   static JobScratch& getScratch();
+
+   static void dumpStats();
+
+   /// @name Platform
+   /// Implemented per platform.
+   /// @{
+
+   static U32 getCoreCount();
+
+   /// Atomically add amount to value and return the new value.
+   static S32 atomicAdd(volatile S32* value, S32 amount);
+
+   static void setThreadIndex(S32 index);
+
+   /// @}
+};
+
+#endif // _JOB_SYSTEM_H_
@@ -0,0 +1,63 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2013 GarageGames, LLC
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//-----------------------------------------------------------------------------
+
+#include "platform/threads/jobSystem.h"
+
+#include <pthread.h>
+#include <unistd.h>
+
+//-----------------------------------------------------------------------------
+// pthread implementation of the job system platform layer.
+//-----------------------------------------------------------------------------
+
+static pthread_key_t    sThreadIndexKey;
+static pthread_once_t   sThreadIndexOnce = PTHREAD_ONCE_INIT;
+
+static void createThreadIndexKey()
+{
+   pthread_key_create(&sThreadIndexKey, NULL);
+}
+
+U32 JobSystem::getCoreCount()
+{
+   long cores = sysconf(_SC_NPROCESSORS_ONLN);
+   return cores > 0 ? (U32)cores : 1;
+}
+
+S32 JobSystem::atomicAdd(volatile S32* value, S32 amount)
+{
+   return __sync_add_and_fetch(value, amount);
+}
+
+void JobSystem::setThreadIndex(S32 index)
+{
+   pthread_once(&sThreadIndexOnce, createThreadIndexKey);
+
+   // Stored off by one so that threads which never set it read back -1.
+   pthread_setspecific(sThreadIndexKey, (void*)(size_t)(index + 1));
+}
+
+S32 JobSystem::getThreadIndex()
+{
+   pthread_once(&sThreadIndexOnce, createThreadIndexKey);
+   return (S32)(size_t)pthread_getspecific(sThreadIndexKey) - 1;
+}
@@ -0,0 +1,52 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2013 GarageGames, LLC
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//-----------------------------------------------------------------------------
+
+/*! @defgroup JobSystemFunctions Job System
+	@ingroup TorqueScriptFunctions
+	@{
+*/
+
+/*! Gets the number of job system worker threads.
+    @return The worker count, zero when jobs run on the main thread only.
+*/
+ConsoleFunctionWithDocs( getJobWorkerCount, ConsoleInt, 1, 1, ())
+{
+   return JobSystem::getWorkerCount();
+}
+
+/*! Gets the number of logical CPU cores the job system was sized from.
+    @return The core count.
+*/
+ConsoleFunctionWithDocs( getCPUCoreCount, ConsoleInt, 1, 1, ())
+{
+   return JobSystem::getCoreCount();
+}
+
+/*! Dump per thread job counts, steals and scratch usage to the console.
+    @return No return value.
+*/
+ConsoleFunctionWithDocs( dumpJobSystemStats, ConsoleVoid, 1, 1, ())
+{
+   JobSystem::dumpStats();
+}
+
+/*! @} */ // group JobSystemFunctions
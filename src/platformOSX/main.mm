@@ -90,5 +90,5 @@ int osxmain(int argc, const char **argv)
 
    Game->mainShutdown();
    
-   return 0;
+   return Game->getExitCode();
 }
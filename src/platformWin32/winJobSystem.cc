@@ -0,0 +1,63 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2013 GarageGames, LLC
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//-----------------------------------------------------------------------------
+
+#include "platform/threads/jobSystem.h"
+#include "platformWin32/platformWin32.h"
+
+//-----------------------------------------------------------------------------
+// Win32 implementation of the job system platform layer.
+//-----------------------------------------------------------------------------
+
+static DWORD sThreadIndexSlot = TLS_OUT_OF_INDEXES;
+
+static DWORD getThreadIndexSlot()
+{
+   // The main thread sets its index before any worker exists, so this is
+   // first called from a single thread.
+   if (sThreadIndexSlot == TLS_OUT_OF_INDEXES)
+      sThreadIndexSlot = TlsAlloc();
+
+   return sThreadIndexSlot;
+}
+
+U32 JobSystem::getCoreCount()
+{
+   SYSTEM_INFO info;
+   GetSystemInfo(&info);
+   return info.dwNumberOfProcessors > 0 ? (U32)info.dwNumberOfProcessors : 1;
+}
+
+S32 JobSystem::atomicAdd(volatile S32* value, S32 amount)
+{
+   return InterlockedExchangeAdd((volatile LONG*)value, amount) + amount;
+}
+
+void JobSystem::setThreadIndex(S32 index)
+{
+   // Stored off by one so that threads which never set it read back -1.
+   TlsSetValue(getThreadIndexSlot(), (LPVOID)(size_t)(index + 1));
+}
+
+S32 JobSystem::getThreadIndex()
+{
+   return (S32)(size_t)TlsGetValue(getThreadIndexSlot()) - 1;
+}
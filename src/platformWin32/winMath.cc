@@ -43,6 +43,10 @@ void Math::init(U32 properties)
    Con::printSeparator();
    Con::printf("Math Initialization:");
 
+   // SIMD kernels are picked from cpuid, so only an explicit request that
+   // leaves out SSE keeps them off.
+   const bool allowSIMD = !properties || (properties & CPU_PROP_SSE);
+
    if (!properties)
       // detect what's available
       properties = PlatformSystemInfo.processor.properties;
@@ -77,6 +81,13 @@ void Math::init(U32 properties)
       //mInstall_Library_SSE();
    }
 
+   const U32 simdLevel = mGetSIMDSupport();
+   if (allowSIMD && simdLevel != MathSIMD_None)
+   {
+      Con::printf("   Installing %s extensions", mGetSIMDName(simdLevel));
+      mInstallLibrary_SIMD(simdLevel);
+   }
+
    Con::printf(" ");
 }
 
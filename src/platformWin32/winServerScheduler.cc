@@ -0,0 +1,85 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2013 GarageGames, LLC
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//-----------------------------------------------------------------------------
+
+#include "platform/platformServerScheduler.h"
+#include "platformWin32/platformWin32.h"
+
+#include <mmsystem.h>
+
+//-----------------------------------------------------------------------------
+// Win32 implementation of the server scheduler platform layer.
+//-----------------------------------------------------------------------------
+
+U64 ServerScheduler::getMonotonicTime()
+{
+   static LARGE_INTEGER frequency = { 0 };
+   if (frequency.QuadPart == 0)
+      QueryPerformanceFrequency(&frequency);
+
+   LARGE_INTEGER counter;
+   QueryPerformanceCounter(&counter);
+
+   // Split to avoid overflowing the multiply on long uptimes.
+   U64 seconds = U64(counter.QuadPart / frequency.QuadPart);
+   U64 remainder = U64(counter.QuadPart % frequency.QuadPart);
+   return seconds * 1000000 + remainder * 1000000 / U64(frequency.QuadPart);
+}
+
+void ServerScheduler::sleepUntil(U64 deadline)
+{
+   // Sleep() is only as accurate as the system timer, so ask for 1ms and
+   // yield through the last stretch.
+   static bool timerPeriodSet = false;
+   if (!timerPeriodSet)
+   {
+      timeBeginPeriod(1);
+      timerPeriodSet = true;
+   }
+
+   U64 now = getMonotonicTime();
+   while (now < deadline)
+   {
+      U64 remaining = deadline - now;
+      if (remaining > 2000)
+         Sleep((DWORD)(remaining / 1000) - 1);
+      else
+         SwitchToThread();
+
+      now = getMonotonicTime();
+   }
+}
+
+U64 ServerScheduler::getProcessCPUTime()
+{
+   FILETIME creationTime, exitTime, kernelTime, userTime;
+   if (!GetProcessTimes(GetCurrentProcess(), &creationTime, &exitTime, &kernelTime, &userTime))
+      return 0;
+
+   ULARGE_INTEGER kernel, user;
+   kernel.LowPart  = kernelTime.dwLowDateTime;
+   kernel.HighPart = kernelTime.dwHighDateTime;
+   user.LowPart    = userTime.dwLowDateTime;
+   user.HighPart   = userTime.dwHighDateTime;
+
+   // 100 nanosecond units.
+   return (kernel.QuadPart + user.QuadPart) / 10;
+}
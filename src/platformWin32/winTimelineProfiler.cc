@@ -0,0 +1,50 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2013 GarageGames, LLC
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//-----------------------------------------------------------------------------
+
+#include "debug/timelineProfiler.h"
+#include "platformWin32/platformWin32.h"
+
+//-----------------------------------------------------------------------------
+// Win32 implementation of the timeline profiler platform layer.
+//-----------------------------------------------------------------------------
+
+static DWORD sThreadDataSlot = TLS_OUT_OF_INDEXES;
+
+static DWORD getThreadDataSlot()
+{
+   // TimelineProfiler::init() names the main thread before any other thread
+   // can record, so this is first called from a single thread.
+   if (sThreadDataSlot == TLS_OUT_OF_INDEXES)
+      sThreadDataSlot = TlsAlloc();
+
+   return sThreadDataSlot;
+}
+
+void* TimelineProfiler::getThreadData()
+{
+   return TlsGetValue(getThreadDataSlot());
+}
+
+void TimelineProfiler::setThreadData(void* data)
+{
+   TlsSetValue(getThreadDataSlot(), data);
+}
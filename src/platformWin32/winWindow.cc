@@ -1586,7 +1586,7 @@ static S32 run(S32 argc, const char **argv)
     // Destroy fonts.
     createFontShutdown();
 
-    return 0;
+    return Game->getExitCode();
 }
 
 //--------------------------------------
@@ -81,6 +81,10 @@ ConsoleFunction( MathInit, void, 1, 10, "(detect|C|FPU|MMX|3DNOW|SSE|...)")
 //------------------------------------------------------------------------------
 void Math::init(U32 properties)
 {
+   // SIMD kernels are picked from cpuid, so only an explicit request that
+   // leaves out SSE keeps them off.
+   const bool allowSIMD = !properties || (properties & CPU_PROP_SSE);
+
    if (!properties)
       // detect what's available
       properties = PlatformSystemInfo.processor.properties;
@@ -118,6 +122,13 @@ void Math::init(U32 properties)
    }
 #endif //mwerks>2.4
 
+   const U32 simdLevel = mGetSIMDSupport();
+   if (allowSIMD && simdLevel != MathSIMD_None)
+   {
+      Con::printf("   Installing %s extensions", mGetSIMDName(simdLevel));
+      mInstallLibrary_SIMD(simdLevel);
+   }
+
    Con::printf(" ");
 }
 
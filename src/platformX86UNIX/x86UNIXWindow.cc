@@ -74,7 +74,12 @@ static S32 ParseCommandLine(S32 argc, const char **argv,
    Vector<char*>& newCommandLine)
 {
    x86UNIXState->setExePathName(argv[0]);
+#ifdef TORQUE_DEDICATED
+   // a headless build never brings up SDL or video
+   bool foundDedicated = true;
+#else
    bool foundDedicated = false;
+#endif
 
    for ( int i=0; i < argc; i++ )
    {
@@ -85,7 +90,7 @@ static S32 ParseCommandLine(S32 argc, const char **argv,
          dPrintf("gcc: %s\n", __VERSION__);
          return 1;
       }
-      if (dStrcmp(argv[i], "-dedicated") == 0)
+      if (dStrcmp(argv[i], "-dedicated") == 0 || dStrcmp(argv[i], "-headless") == 0)
       {
          foundDedicated = true;
          // no continue because dedicated is also handled by script
@@ -609,7 +614,8 @@ void Platform::process()
       // there are no players connected.
       // JMQ: recent kernels (such as RH 8.0 2.4.18) reduce the latency
       // to 2-4 ms on average.
-      if (!Game->isJournalReading() && (x86UNIXState->getDSleep() ||
+      // A headless game sleeps in the ServerScheduler instead.
+      if (!Game->isJournalReading() && !Game->isHeadless() && (x86UNIXState->getDSleep() ||
              Con::getIntVariable("Server::PlayerCount") -
              Con::getIntVariable("Server::BotCount") <= 0))
       {
@@ -679,9 +685,13 @@ void Platform::init()
 
    StdConsole::create();
 
+   // The game is headless for -dedicated, -headless, -perfReplay and
+   // TORQUE_DEDICATED builds, none of them brings up SDL, input or video.
+   const bool headless = x86UNIXState->isDedicated() || Game->isHeadless();
+
 #ifndef DEDICATED
    // if we're not dedicated do more initialization
-   if (!x86UNIXState->isDedicated())
+   if (!headless)
    {
       // init SDL
       if (!InitSDL())
@@ -716,7 +726,7 @@ void Platform::init()
    }
 #endif
    // if we are dedicated, do sleep timing and display results
-   if (x86UNIXState->isDedicated())
+   if (headless)
    {
       const S32 MaxSleepIter = 10;
       U32 totalSleepTime = 0;
@@ -879,6 +889,7 @@ int unixmain(int argc, const char **argv)
    }
 
    Game->mainShutdown();
+   returnVal = Game->getExitCode();
 
    // dispose of command line
    for(U32 i = 0; i < newCommandLine.size(); i++)
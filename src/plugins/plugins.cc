@@ -285,6 +285,7 @@ namespace Plugins
 
       // Graphics
       Torque::Graphics.PosUVNormalVertex  = &Graphics::PosUVNormalVertex::ms_decl;
+      Torque::Graphics.PosUVNormalMorphVertex = &Graphics::PosUVNormalMorphVertex::ms_decl;
       Torque::Graphics.PosUVColorVertex   = &Graphics::PosUVColorVertex::ms_decl;
       Torque::Graphics.cubeIB             = &Graphics::cubeIB;
       Torque::Graphics.cubeVB             = &Graphics::cubeVB;
@@ -356,6 +357,8 @@ namespace Plugins
       Torque::bgfx.setViewFrameBuffer           = bgfx::setViewFrameBuffer;
       Torque::bgfx.alloc                        = bgfx::alloc;
       Torque::bgfx.copy                         = bgfx::copy;
+      Torque::bgfx.checkAvailInstanceDataBuffer = bgfx::checkAvailInstanceDataBuffer;
+      Torque::bgfx.allocInstanceDataBuffer      = bgfx::allocInstanceDataBuffer;
       Torque::bgfx.blit                         = bgfx::blit;
       Torque::bgfx.blitA                        = bgfx::blit;
       Torque::bgfx.blitB                        = bgfx::blit;
@@ -351,6 +351,7 @@ namespace Torque
    struct GraphicsWrapper
    {
       bgfx::VertexDecl* PosUVNormalVertex;
+      bgfx::VertexDecl* PosUVNormalMorphVertex;
       bgfx::VertexDecl* PosUVColorVertex;
 
       bgfx::IndexBufferHandle* cubeIB;
@@ -444,6 +445,9 @@ namespace Torque
 
       const bgfx::Memory* (*alloc)(uint32_t _size);
       const bgfx::Memory* (*copy)(const void* _data, uint32_t _size);
+
+      bool (*checkAvailInstanceDataBuffer)(uint32_t _num, uint16_t _stride);
+      const bgfx::InstanceDataBuffer* (*allocInstanceDataBuffer)(uint32_t _num, uint16_t _stride);
    };
 
    struct PluginsWrapper
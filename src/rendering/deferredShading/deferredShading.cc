@@ -30,6 +30,7 @@
 #include "materials/materials.h"
 #include "materials/materialAsset.h"
 #include "debug/debugMode.h"
+#include "debug/profiler.h"
 
 #include <bgfx/bgfx.h>
 #include <bx/fpumath.h>
@@ -274,7 +275,11 @@ namespace Rendering
          bgfx::setTransform(item->transformTable, item->transformCount);
 
          // Instancing Data
-         if (item->instances && item->instances->size() > 0)
+         if (item->instanceBuffer)
+         {
+            bgfx::setInstanceDataBuffer(item->instanceBuffer);
+         }
+         else if (item->instances && item->instances->size() > 0)
          {
             U16 stride = sizeof(Rendering::InstanceData);
             const bgfx::InstanceDataBuffer* idb = bgfx::allocInstanceDataBuffer(item->instances->size(), stride);
@@ -336,6 +341,7 @@ namespace Rendering
                bgfx::submit(mDeferredGeometryView->id, item->shader);
             else
                bgfx::submit(mDeferredGeometryView->id, mDefaultShader->mProgram);
+            PROFILE_COUNT(DrawCalls, 1);
          }
       }
    }
@@ -30,6 +30,7 @@
 #include "materials/materials.h"
 #include "rendering/renderCamera.h"
 #include "scene/scene.h"
+#include "debug/profiler.h"
 
 #include <bgfx/bgfx.h>
 #include <bx/fpumath.h>
@@ -133,7 +134,11 @@ namespace Rendering
          bgfx::setTransform(item->transformTable, item->transformCount);
 
          // Instancing Data
-         if (item->instances && item->instances->size() > 0)
+         if (item->instanceBuffer)
+         {
+            bgfx::setInstanceDataBuffer(item->instanceBuffer);
+         }
+         else if (item->instances && item->instances->size() > 0)
          {
             U16 stride = sizeof(Rendering::InstanceData);
             const bgfx::InstanceDataBuffer* idb = bgfx::allocInstanceDataBuffer(item->instances->size(), stride);
@@ -214,6 +219,7 @@ namespace Rendering
                bgfx::submit(mBackBufferView->id, item->shader);
             else
                bgfx::submit(mBackBufferView->id, mDefaultShader->mProgram);
+            PROFILE_COUNT(DrawCalls, 1);
          }
       }
    }
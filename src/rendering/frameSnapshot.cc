@@ -0,0 +1,542 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2015 Andrew Mac
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//-----------------------------------------------------------------------------
+
+
+#include "frameSnapshot.h"
+#include "console/consoleInternal.h"
+#include "console/consoleTypes.h"
+#include "lighting/lighting.h"
+#include "platform/threads/jobSystem.h"
+#include "renderCamera.h"
+#include "debug/profiler.h"
+
+#include <bgfx/bgfx.h>
+#include <bounds.h>
+#include <bx/fpumath.h>
+#include <bx/timer.h>
+
+#include "frameSnapshot_Binding.h"
+
+namespace Rendering
+{
+   extern Vector<RenderCamera*> renderCameraList;
+
+   // Everything the renderer reads from the simulation, copied at the end of
+   // a simulation step. Only the culling jobs touch it between capture and apply.
+   struct FrameSnapshot
+   {
+      bool                          valid;
+      bool                          applied;
+
+      // Render Data
+      U32                           renderDataCount;
+      Vector<U32>                   flags;
+      Vector<U32>                   generations;
+      Vector<SphereF>               boundingSpheres;
+      Vector<S32>                   transformOffsets;
+      Vector<U8>                    transformCounts;
+      Vector<F32>                   transforms;
+
+      // Cameras, with one culled entry per RenderData for each of them.
+      Vector<CameraSnapshot>        cameras;
+      Vector<U8>                    culled;
+
+      // Lights, copied by slot like the render data.
+      Point3F                       directionalLightDirection;
+      ColorF                        directionalLightColor;
+      U32                           lightCount;
+      Vector<Lighting::LightData>   lights;
+
+      // Live values swapped out while the snapshot is applied.
+      Vector<U8>                    liveApplied;
+      Vector<U32>                   liveFlags;
+      Vector<F32*>                  liveTransformTables;
+      Vector<U8>                    liveTransformCounts;
+      Vector<CameraSnapshot>        liveCameras;
+      Point3F                       liveDirectionalLightDirection;
+      ColorF                        liveDirectionalLightColor;
+      Vector<U8>                    liveLightApplied;
+      Vector<Lighting::LightData>   liveLights;
+
+      FrameSnapshot()
+         : valid(false),
+           applied(false),
+           renderDataCount(0),
+           lightCount(0)
+      {
+         //
+      }
+   };
+
+   static bool          sPipelinedFrame = false;
+   static FrameSnapshot sSnapshot;
+   static JobCounter    sCullCounter;
+
+   enum
+   {
+      CullGrainSize     = 1024,
+      FrameTimeSamples  = 1024
+   };
+
+   struct FrameTimeHistory
+   {
+      F32 samples[FrameTimeSamples];
+      U32 count;
+      U32 next;
+   };
+
+   static FrameTimeHistory sFrameTimes[2];
+   static S64              sFrameStart = 0;
+   static bool             sFrameStartPipelined = false;
+
+   // ----------------------------------------
+   //   Culling
+   // ----------------------------------------
+
+   static void cullJob(void* data, U32 first, U32 count)
+   {
+      CameraSnapshot* camera = (CameraSnapshot*)data;
+      S32 culledCount = 0;
+
+      // Test the whole range against the frustum in one batch, then clear
+      // the items that aren't subject to frustum culling.
+      U8* culled = camera->culled + first;
+      m_sphereF_x_planes_batch(&camera->frustumPlanes[0][0], 6, (const F32*)&camera->_boundingSpheres[first], count, culled);
+
+      for (U32 n = 0; n < count; ++n)
+      {
+         if (!culled[n])
+            continue;
+
+         // Items without bounds are not subject to frustum culling.
+         const U32 flags = camera->_flags[first + n];
+         if ((flags & (RenderData::Deleted | RenderData::Hidden)) || !(flags & RenderData::HasBounds))
+         {
+            culled[n] = 0;
+            continue;
+         }
+
+         culledCount++;
+      }
+
+      if (culledCount > 0)
+         JobSystem::atomicAdd(&camera->culledCount, culledCount);
+   }
+
+   // ----------------------------------------
+   //   Capture / Apply
+   // ----------------------------------------
+
+   static bool isRenderCamera(RenderCamera* camera)
+   {
+      for (S32 n = 0; n < renderCameraList.size(); ++n)
+      {
+         if (renderCameraList[n] == camera)
+            return true;
+      }
+      return false;
+   }
+
+   static void captureSnapshot()
+   {
+      PROFILE_SCOPE(FrameSnapshot_Capture);
+
+      FrameSnapshot& snapshot = sSnapshot;
+
+      // Render Data
+      const U32 count = getRenderDataCount();
+      RenderData* item = getRenderDataList();
+
+      snapshot.renderDataCount = count;
+      snapshot.flags.setSize(count);
+      snapshot.generations.setSize(count);
+      snapshot.boundingSpheres.setSize(count);
+      snapshot.transformOffsets.setSize(count);
+      snapshot.transformCounts.setSize(count);
+      snapshot.transforms.clear();
+
+      for (U32 n = 0; n < count; ++n, ++item)
+      {
+         snapshot.flags[n]             = item->flags;
+         snapshot.generations[n]       = item->generation;
+         snapshot.boundingSpheres[n]   = item->boundingSphere;
+         snapshot.transformCounts[n]   = item->transformCount;
+         snapshot.transformOffsets[n]  = -1;
+
+         if (item->flags & RenderData::Deleted || item->transformTable == NULL || item->transformCount == 0)
+            continue;
+
+         U32 offset = snapshot.transforms.size();
+         snapshot.transforms.increment(item->transformCount * 16);
+         dMemcpy(&snapshot.transforms[offset], item->transformTable, sizeof(F32) * 16 * item->transformCount);
+         snapshot.transformOffsets[n] = offset;
+      }
+
+      // Cameras
+      snapshot.cameras.setSize(renderCameraList.size());
+      snapshot.culled.setSize(renderCameraList.size() * count);
+      for (S32 i = 0; i < renderCameraList.size(); ++i)
+      {
+         RenderCamera* camera = renderCameraList[i];
+         CameraSnapshot& cameraSnapshot = snapshot.cameras[i];
+
+         cameraSnapshot.camera            = camera;
+         cameraSnapshot.position          = camera->position;
+         cameraSnapshot.frustumCull       = false;
+         cameraSnapshot.culledCount       = 0;
+         cameraSnapshot.renderDataCount   = count;
+         cameraSnapshot.culled            = snapshot.culled.address() + (i * count);
+         cameraSnapshot._flags            = snapshot.flags.address();
+         cameraSnapshot._boundingSpheres  = snapshot.boundingSpheres.address();
+         dMemcpy(cameraSnapshot.viewMatrix, camera->viewMatrix, sizeof(cameraSnapshot.viewMatrix));
+
+         // Same projection RenderCamera::render() will build.
+         U32 width   = camera->matchWindowSize ? Rendering::windowWidth : camera->width;
+         U32 height  = camera->matchWindowSize ? Rendering::windowHeight : camera->height;
+         F32 camAspect = (height > 0) ? F32(width) / F32(height) : 1.0f;
+         bx::mtxProj(cameraSnapshot.projectionMatrix, camera->fov, camAspect, camera->nearPlane, camera->farPlane);
+
+         float viewProjMtx[16];
+         bx::mtxMul(viewProjMtx, cameraSnapshot.viewMatrix, cameraSnapshot.projectionMatrix);
+
+         Plane planes[6];
+         buildFrustumPlanes(planes, viewProjMtx);
+         for (U8 p = 0; p < 6; ++p)
+         {
+            cameraSnapshot.frustumPlanes[p][0] = planes[p].m_normal[0];
+            cameraSnapshot.frustumPlanes[p][1] = planes[p].m_normal[1];
+            cameraSnapshot.frustumPlanes[p][2] = planes[p].m_normal[2];
+            cameraSnapshot.frustumPlanes[p][3] = planes[p].m_dist;
+         }
+
+         Vector<RenderFilter*>* filters = camera->getRenderFilterList();
+         for (S32 n = 0; n < filters->size(); ++n)
+            filters->at(n)->captureSnapshot(&cameraSnapshot);
+
+         if (!cameraSnapshot.frustumCull && count > 0)
+            dMemset(cameraSnapshot.culled, 0, count);
+      }
+
+      // Lights
+      snapshot.directionalLightDirection  = Lighting::directionalLight.direction;
+      snapshot.directionalLightColor      = Lighting::directionalLight.color;
+      snapshot.lightCount = Lighting::getLightDataCount();
+      snapshot.lights.setSize(snapshot.lightCount);
+      if (snapshot.lightCount > 0)
+         dMemcpy(snapshot.lights.address(), Lighting::getLightDataList(), sizeof(Lighting::LightData) * snapshot.lightCount);
+
+      snapshot.valid = true;
+
+      // Cull on the job system while the next simulation step runs.
+      for (S32 i = 0; i < snapshot.cameras.size(); ++i)
+      {
+         if (snapshot.cameras[i].frustumCull && count > 0)
+            JobSystem::parallelFor(count, CullGrainSize, &cullJob, &snapshot.cameras[i], &sCullCounter);
+      }
+   }
+
+   static void applySnapshot()
+   {
+      PROFILE_SCOPE(FrameSnapshot_Apply);
+
+      FrameSnapshot& snapshot = sSnapshot;
+
+      // Render Data. Items deleted or recreated since the capture keep their
+      // live data and are never culled by the snapshot.
+      const U32 count = getMin(snapshot.renderDataCount, getRenderDataCount());
+      RenderData* item = getRenderDataList();
+
+      snapshot.liveApplied.setSize(count);
+      snapshot.liveFlags.setSize(count);
+      snapshot.liveTransformTables.setSize(count);
+      snapshot.liveTransformCounts.setSize(count);
+
+      for (U32 n = 0; n < count; ++n, ++item)
+      {
+         snapshot.liveApplied[n] = 0;
+         if (item->flags & RenderData::Deleted || item->generation != snapshot.generations[n])
+         {
+            for (S32 i = 0; i < snapshot.cameras.size(); ++i)
+               snapshot.cameras[i].culled[n] = 0;
+            continue;
+         }
+
+         snapshot.liveApplied[n]          = 1;
+         snapshot.liveFlags[n]            = item->flags;
+         snapshot.liveTransformTables[n]  = item->transformTable;
+         snapshot.liveTransformCounts[n]  = item->transformCount;
+
+         item->flags = (item->flags & ~RenderData::Hidden) | (snapshot.flags[n] & RenderData::Hidden);
+         if (snapshot.transformOffsets[n] >= 0)
+         {
+            item->transformTable = &snapshot.transforms[snapshot.transformOffsets[n]];
+            item->transformCount = snapshot.transformCounts[n];
+         }
+      }
+
+      // Cameras
+      snapshot.liveCameras.setSize(snapshot.cameras.size());
+      for (S32 i = 0; i < snapshot.cameras.size(); ++i)
+      {
+         CameraSnapshot& cameraSnapshot = snapshot.cameras[i];
+         if (!isRenderCamera(cameraSnapshot.camera))
+         {
+            cameraSnapshot.camera = NULL;
+            continue;
+         }
+
+         cameraSnapshot.renderDataCount = count;
+
+         RenderCamera* camera = cameraSnapshot.camera;
+         snapshot.liveCameras[i].position = camera->position;
+         dMemcpy(snapshot.liveCameras[i].viewMatrix, camera->viewMatrix, sizeof(camera->viewMatrix));
+
+         camera->position = cameraSnapshot.position;
+         dMemcpy(camera->viewMatrix, cameraSnapshot.viewMatrix, sizeof(camera->viewMatrix));
+      }
+
+      // Lights
+      snapshot.liveDirectionalLightDirection = Lighting::directionalLight.direction;
+      snapshot.liveDirectionalLightColor     = Lighting::directionalLight.color;
+      Lighting::directionalLight.direction   = snapshot.directionalLightDirection;
+      Lighting::directionalLight.color       = snapshot.directionalLightColor;
+
+      // Lights deleted or recreated since the capture keep their live values.
+      const U32 lightCount = getMin(snapshot.lightCount, Lighting::getLightDataCount());
+      Lighting::LightData* light = Lighting::getLightDataList();
+
+      snapshot.liveLightApplied.setSize(lightCount);
+      snapshot.liveLights.setSize(lightCount);
+
+      for (U32 n = 0; n < lightCount; ++n, ++light)
+      {
+         const Lighting::LightData& captured = snapshot.lights[n];
+
+         snapshot.liveLightApplied[n] = 0;
+         if ((light->flags | captured.flags) & Lighting::LightData::Deleted || light->generation != captured.generation)
+            continue;
+
+         snapshot.liveLightApplied[n]  = 1;
+         snapshot.liveLights[n]        = *light;
+
+         light->position    = captured.position;
+         light->attenuation = captured.attenuation;
+         light->intensity   = captured.intensity;
+         dMemcpy(light->color, captured.color, sizeof(light->color));
+      }
+
+      snapshot.applied = true;
+   }
+
+   static void restoreSnapshot()
+   {
+      FrameSnapshot& snapshot = sSnapshot;
+      if (!snapshot.applied)
+         return;
+
+      RenderData* item = getRenderDataList();
+      for (U32 n = 0; n < (U32)snapshot.liveApplied.size(); ++n, ++item)
+      {
+         if (!snapshot.liveApplied[n])
+            continue;
+
+         item->flags          = snapshot.liveFlags[n];
+         item->transformTable = snapshot.liveTransformTables[n];
+         item->transformCount = snapshot.liveTransformCounts[n];
+      }
+
+      for (S32 i = 0; i < snapshot.cameras.size(); ++i)
+      {
+         RenderCamera* camera = snapshot.cameras[i].camera;
+         if (camera == NULL)
+            continue;
+
+         camera->position = snapshot.liveCameras[i].position;
+         dMemcpy(camera->viewMatrix, snapshot.liveCameras[i].viewMatrix, sizeof(camera->viewMatrix));
+      }
+
+      Lighting::directionalLight.direction   = snapshot.liveDirectionalLightDirection;
+      Lighting::directionalLight.color       = snapshot.liveDirectionalLightColor;
+      Lighting::LightData* light = Lighting::getLightDataList();
+      for (U32 n = 0; n < (U32)snapshot.liveLightApplied.size(); ++n, ++light)
+      {
+         if (snapshot.liveLightApplied[n])
+            *light = snapshot.liveLights[n];
+      }
+
+      snapshot.applied  = false;
+      snapshot.valid    = false;
+   }
+
+   static void flushSnapshot()
+   {
+      JobSystem::wait(sCullCounter);
+      restoreSnapshot();
+      sSnapshot.valid = false;
+   }
+
+   // ----------------------------------------
+   //   Pipelined Frame
+   // ----------------------------------------
+
+   void initPipelinedFrame()
+   {
+      // Keep a value set from prefs before the variable was bound.
+      sPipelinedFrame = Con::getBoolVariable("pref::Video::pipelinedFrame", false);
+      Con::addVariable("pref::Video::pipelinedFrame", TypeBool, &sPipelinedFrame);
+
+      resetFrameTimeStats();
+   }
+
+   void destroyPipelinedFrame()
+   {
+      flushSnapshot();
+   }
+
+   void setPipelinedFrame(bool enabled)
+   {
+      sPipelinedFrame = enabled;
+   }
+
+   bool isPipelinedFrame()
+   {
+      return sPipelinedFrame;
+   }
+
+   bool beginPipelinedFrame()
+   {
+      if (!sPipelinedFrame)
+      {
+         if (sSnapshot.valid)
+            flushSnapshot();
+         return false;
+      }
+
+      PROFILE_START(FrameSnapshot_WaitCull);
+      JobSystem::wait(sCullCounter);
+      PROFILE_END();
+
+      if (sSnapshot.valid)
+         applySnapshot();
+
+      return true;
+   }
+
+   void endPipelinedFrame()
+   {
+      restoreSnapshot();
+      captureSnapshot();
+   }
+
+   const CameraSnapshot* getCameraSnapshot(RenderCamera* camera)
+   {
+      if (!sSnapshot.applied)
+         return NULL;
+
+      for (S32 i = 0; i < sSnapshot.cameras.size(); ++i)
+      {
+         if (sSnapshot.cameras[i].camera == camera)
+            return &sSnapshot.cameras[i];
+      }
+      return NULL;
+   }
+
+   // ----------------------------------------
+   //   Frame Time Statistics
+   // ----------------------------------------
+
+   void beginFrameTime()
+   {
+      sFrameStart          = bx::getHPCounter();
+      sFrameStartPipelined = sPipelinedFrame;
+   }
+
+   void endFrameTime()
+   {
+      if (sFrameStart == 0)
+         return;
+
+      F32 frameTime = F32(F64(bx::getHPCounter() - sFrameStart) * 1000.0 / F64(bx::getHPFrequency()));
+      sFrameStart = 0;
+
+      // Frames that toggled the mode midway don't count towards either.
+      if (sFrameStartPipelined != sPipelinedFrame)
+         return;
+
+      FrameTimeHistory& history = sFrameTimes[sPipelinedFrame ? 1 : 0];
+      history.samples[history.next] = frameTime;
+      history.next = (history.next + 1) % FrameTimeSamples;
+      if (history.count < FrameTimeSamples)
+         history.count++;
+   }
+
+   static S32 QSORT_CALLBACK compareFrameTime(const void* a, const void* b)
+   {
+      F32 timeA = *((F32*)a);
+      F32 timeB = *((F32*)b);
+      return (timeA < timeB) ? -1 : ((timeA > timeB) ? 1 : 0);
+   }
+
+   F32 getFrameTimePercentile(F32 percentile, bool pipelined)
+   {
+      const FrameTimeHistory& history = sFrameTimes[pipelined ? 1 : 0];
+      if (history.count == 0)
+         return 0.0f;
+
+      F32 sorted[FrameTimeSamples];
+      dMemcpy(sorted, history.samples, sizeof(F32) * history.count);
+      dQsort(sorted, history.count, sizeof(F32), compareFrameTime);
+
+      F32 index = mClampF(percentile, 0.0f, 100.0f) / 100.0f * F32(history.count - 1);
+      return sorted[(U32)(index + 0.5f)];
+   }
+
+   void resetFrameTimeStats()
+   {
+      dMemset(sFrameTimes, 0, sizeof(sFrameTimes));
+      sFrameStart = 0;
+   }
+
+   void dumpFrameTimeStats()
+   {
+      Con::printf("Frame Times (%s renderer, pipelined frame %s):", bgfx::getRendererName(bgfx::getRendererType()), sPipelinedFrame ? "on" : "off");
+
+      for (U32 mode = 0; mode < 2; ++mode)
+      {
+         bool pipelined = (mode == 1);
+         if (sFrameTimes[mode].count == 0)
+         {
+            Con::printf("   %-9s : no samples", pipelined ? "Pipelined" : "Serial");
+            continue;
+         }
+
+         Con::printf("   %-9s : %4d frames, p50 %6.2fms p90 %6.2fms p95 %6.2fms p99 %6.2fms max %6.2fms",
+            pipelined ? "Pipelined" : "Serial",
+            sFrameTimes[mode].count,
+            getFrameTimePercentile(50.0f, pipelined),
+            getFrameTimePercentile(90.0f, pipelined),
+            getFrameTimePercentile(95.0f, pipelined),
+            getFrameTimePercentile(99.0f, pipelined),
+            getFrameTimePercentile(100.0f, pipelined));
+      }
+   }
+}
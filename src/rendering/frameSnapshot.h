@@ -0,0 +1,88 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2015 Andrew Mac
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//-----------------------------------------------------------------------------
+
+
+
+#ifndef _FRAME_SNAPSHOT_H_
+#define _FRAME_SNAPSHOT_H_
+
+#ifndef _RENDERING_H_
+#include "rendering/rendering.h"
+#endif
+
+namespace Rendering 
+{
+   class RenderCamera;
+
+   // ----------------------------------------
+   //  Pipelined Frame : With $pref::Video::pipelinedFrame enabled the end of
+   //  each simulation step is captured into a FrameSnapshot. The snapshot is
+   //  culled on the job system while the next simulation step runs and is
+   //  then encoded on the main thread, which is the only thread allowed to
+   //  talk to bgfx. Frames are displayed one simulation step late.
+   // ----------------------------------------
+   struct DLL_PUBLIC CameraSnapshot
+   {
+      RenderCamera*  camera;
+      F32            viewMatrix[16];
+      F32            projectionMatrix[16];
+      Point3F        position;
+
+      // Set by RenderFilters in captureSnapshot().
+      bool           frustumCull;
+      F32            frustumPlanes[6][4];
+
+      // Written by the culling jobs, one entry per RenderData.
+      U32            renderDataCount;
+      U8*            culled;
+      volatile S32   culledCount;
+
+      // Owned by the snapshot, don't touch.
+      const U32*     _flags;
+      const SphereF* _boundingSpheres;
+   };
+
+   // Pipelined Frame Mode
+   void initPipelinedFrame();
+   void destroyPipelinedFrame();
+   void setPipelinedFrame(bool enabled);
+   bool isPipelinedFrame();
+
+   // Called by render(). beginPipelinedFrame() waits for the culling of the
+   // last snapshot and applies it, returning false when pipelining is off.
+   // endPipelinedFrame() restores live data and captures the next snapshot.
+   bool beginPipelinedFrame();
+   void endPipelinedFrame();
+
+   // The snapshot applied for camera while the current frame is encoded, or
+   // NULL when the camera renders live data.
+   const CameraSnapshot* getCameraSnapshot(RenderCamera* camera);
+
+   // Frame Time Statistics, kept separately for serial and pipelined frames.
+   void beginFrameTime();
+   void endFrameTime();
+   F32  getFrameTimePercentile(F32 percentile, bool pipelined);
+   void resetFrameTimeStats();
+   void dumpFrameTimeStats();
+}
+
+#endif
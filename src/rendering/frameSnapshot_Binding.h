@@ -0,0 +1,65 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2015 Andrew Mac
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//-----------------------------------------------------------------------------
+
+
+/*! @defgroup PipelinedFrameFunctions Pipelined Frame
+	@ingroup TorqueScriptFunctions
+	@{
+*/
+
+/*! Enable or disable pipelined frames. Same as setting $pref::Video::pipelinedFrame.
+    @param enabled Whether culling of the last simulation step should overlap the next one.
+    @return No return value.
+*/
+ConsoleFunctionWithDocs( setPipelinedFrame, ConsoleVoid, 2, 2, (bool enabled))
+{
+   Rendering::setPipelinedFrame(dAtob(argv[1]));
+}
+
+/*! Gets the frame time at a percentile of the recorded frames.
+    @param percentile The percentile from 0 to 100.
+    @param pipelined Optional, read pipelined instead of serial frames. Defaults to the current mode.
+    @return The frame time in milliseconds, or zero without samples.
+*/
+ConsoleFunctionWithDocs( getFrameTimePercentile, ConsoleFloat, 2, 3, (percentile, [pipelined]))
+{
+   bool pipelined = (argc > 2) ? dAtob(argv[2]) : Rendering::isPipelinedFrame();
+   return Rendering::getFrameTimePercentile(dAtof(argv[1]), pipelined);
+}
+
+/*! Clear the recorded frame times of both modes.
+    @return No return value.
+*/
+ConsoleFunctionWithDocs( resetFrameTimeStats, ConsoleVoid, 1, 1, ())
+{
+   Rendering::resetFrameTimeStats();
+}
+
+/*! Dump frame time percentiles for serial and pipelined frames to the console.
+    @return No return value.
+*/
+ConsoleFunctionWithDocs( dumpFrameTimeStats, ConsoleVoid, 1, 1, ())
+{
+   Rendering::dumpFrameTimeStats();
+}
+
+/*! @} */ // group PipelinedFrameFunctions
@@ -21,6 +21,7 @@
 //-----------------------------------------------------------------------------
 
 #include "renderCamera.h"
+#include "frameSnapshot.h"
 #include "console/consoleInternal.h"
 #include "deferredShading/deferredShading.h"
 #include "forwardShading/forwardShading.h"
@@ -219,8 +220,13 @@ namespace Rendering
          for (U32 n = 0; n < Rendering::getRenderDataCount(); ++n, ++renderData)
             renderData->flags &= ~Rendering::RenderData::Filtered;
 
+         // Filters can reuse the culling done on the snapshot being rendered.
+         const Rendering::CameraSnapshot* snapshot = Rendering::getCameraSnapshot(this);
          for (S32 n = 0; n < mRenderFilterList.size(); ++n)
-            mRenderFilterList[n]->execute();
+         {
+            if (snapshot == NULL || !mRenderFilterList[n]->applySnapshot(snapshot))
+               mRenderFilterList[n]->execute();
+         }
       }
 
       // PreRender
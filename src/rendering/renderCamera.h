@@ -46,6 +46,7 @@ namespace Rendering
    class DLL_PUBLIC RenderFilter;
    class DLL_PUBLIC RenderPath;
    class DLL_PUBLIC RenderPostProcess;
+   struct DLL_PUBLIC CameraSnapshot;
 
    // ----------------------------------------
    //  Render Cameras
@@ -161,6 +162,12 @@ namespace Rendering
          virtual void onRemoveFromCamera() { }
 
          virtual void execute() { }
+
+         // Pipelined frames: captureSnapshot() runs on the main thread when the
+         // snapshot is taken and can ask for snapshot culling. applySnapshot()
+         // returns true if the snapshot results replace execute() this frame.
+         virtual void captureSnapshot(CameraSnapshot* snapshot) { }
+         virtual bool applySnapshot(const CameraSnapshot* snapshot) { return false; }
    };
 
    // ----------------------------------------
@@ -29,6 +29,7 @@
 #include "scene/scene.h"
 #include "rendering/transparency.h"
 #include "renderCamera.h"
+#include "frameSnapshot.h"
 
 #include <bgfx/bgfx.h>
 #include <bx/fpumath.h>
@@ -53,10 +54,16 @@ namespace Rendering
    void init()
    {
       renderDataList = new RenderData[TORQUE_MAX_RENDER_DATA];
+      for (U32 n = 0; n < TORQUE_MAX_RENDER_DATA; ++n)
+         renderDataList[n].generation = 0;
+
+      initPipelinedFrame();
    }
 
    void destroy()
    {
+      destroyPipelinedFrame();
+
       for (S32 n = 0; n < renderTextureList.size(); ++n)
       {
          RenderTexture* rt = renderTextureList[n];
@@ -96,6 +103,9 @@ namespace Rendering
       if (Scene::isPreprocessingActive(true))
          return;
 
+      // In pipelined mode this applies the snapshot of the last simulation step.
+      bool pipelined = beginPipelinedFrame();
+
       // Render Hooks also get notified about begin/end of frame.
       for (S32 n = 0; n < renderHookList.size(); ++n)
          renderHookList[n]->beginFrame();
@@ -113,6 +123,10 @@ namespace Rendering
       // End of frame
       for (S32 n = 0; n < renderHookList.size(); ++n)
          renderHookList[n]->endFrame();
+
+      // Capture this simulation step and start culling it.
+      if (pipelined)
+         endPipelinedFrame();
    }
 
    void resize()
@@ -144,7 +158,9 @@ namespace Rendering
 
       // Reset Values
       item->flags                   = 0;
+      item->generation++;
       item->instances               = NULL;
+      item->instanceBuffer          = NULL;
       item->dynamicIndexBuffer.idx  = bgfx::invalidHandle;
       item->dynamicVertexBuffer.idx = bgfx::invalidHandle;
       item->indexBuffer.idx         = bgfx::invalidHandle;
@@ -133,10 +133,17 @@ namespace Rendering
       };
       U32                              flags;
 
+      // Bumped whenever the slot is handed out by createRenderData().
+      U32                              generation;
+
       bgfx::VertexBufferHandle         vertexBuffer;
       bgfx::IndexBufferHandle          indexBuffer;
       bgfx::ProgramHandle              shader;
       Vector<InstanceData>*            instances;
+
+      // Instance data the owner already wrote into a transient buffer this
+      // frame, used instead of instances when set.
+      const bgfx::InstanceDataBuffer*  instanceBuffer;
       Vector<TextureData>*             textures;
       UniformSet                       uniforms;
       F32*                             transformTable;
@@ -27,6 +27,8 @@
 #include "scene/components/meshComponent.h"
 #include "scene/scene.h"
 #include "game/gameProcess.h"
+#include "rendering/renderCamera.h"
+#include "platform/threads/jobSystem.h"
 
 // Script bindings.
 #include "animationComponent_Binding.h"
@@ -48,12 +50,32 @@ namespace Scene
 {
    IMPLEMENT_CONOBJECT(AnimationComponent);
 
+   F32 AnimationComponent::smLODDistance     = 25.0f;
+   U32 AnimationComponent::smLODMaxInterval  = 8;
+   U32 AnimationComponent::smEvaluatedCount  = 0;
+   U32 AnimationComponent::smSkippedCount    = 0;
+
+   static Vector<AnimationComponent*>& getBatchList()
+   {
+      // This helps to avoid the static initialization order fiasco
+      static Vector<AnimationComponent*> sBatchList;
+      return sBatchList;
+   }
+
    AnimationComponent::AnimationComponent()
    {
-      mAnimationIndex   = 0;
-      mAnimationTime    = 0.0f;
-      mSpeed            = 1.0f;
-      mTargetName       = StringTable->EmptyString;
+      mAnimationIndex      = 0;
+      mAnimationTime       = 0.0f;
+      mSpeed               = 1.0f;
+      mTargetName          = StringTable->EmptyString;
+      mPaletteCount        = 0;
+      mFramesSinceUpdate   = 0;
+      mInBatch             = false;
+   }
+
+   AnimationComponent::~AnimationComponent()
+   {
+      onRemoveFromScene();
    }
 
    void AnimationComponent::initPersistFields()
@@ -81,12 +103,35 @@ namespace Scene
             ClientProcessList::get()->addObject(mOwnerObject);
 
          setProcessTicks(true);
+
+         if (!mInBatch)
+         {
+            getBatchList().push_back(this);
+            mInBatch = true;
+         }
+
+         // Evaluate on the first batch update regardless of distance.
+         mFramesSinceUpdate = smLODMaxInterval;
       }
    }
 
    void AnimationComponent::onRemoveFromScene()
    {  
       //setProcessTicks(false);
+
+      if (!mInBatch)
+         return;
+
+      Vector<AnimationComponent*>& batchList = getBatchList();
+      for (S32 n = 0; n < batchList.size(); ++n)
+      {
+         if (batchList[n] == this)
+         {
+            batchList.erase_fast(n);
+            break;
+         }
+      }
+      mInBatch = false;
    }
 
    void AnimationComponent::setMesh( const char* pImageAssetId )
@@ -119,11 +164,7 @@ namespace Scene
 
    void AnimationComponent::processMove(const Move* move)
    {  
-      if ( !mTarget.isNull() )
-      {
-         mTarget->mTransformCount = mMeshAsset->getAnimatedTransforms(mAnimationIndex, mAnimationTime, mTarget->mTransformTable[1]) + 1;
-         mTarget->refreshTransforms();
-      }
+      // Poses are evaluated by the animation batch. See updateBatch().
    }
 
    void AnimationComponent::advanceMove( F32 timeDelta )
@@ -145,4 +186,102 @@ namespace Scene
    {
       mAnimationTime += (timeDelta * mSpeed);
    }
+
+   // ----------------------------------------
+   //  Animation Batch
+   // ----------------------------------------
+
+   // Evaluation only reads the mesh asset and writes into this component's
+   // palette so it's safe to run on any thread.
+   void AnimationComponent::evaluatePose()
+   {
+      mPaletteCount = mMeshAsset->getAnimatedTransforms(mAnimationIndex, mAnimationTime, mPalette[0], MeshComponent::MaxBones);
+   }
+
+   // Main thread only: touches the target's render data.
+   void AnimationComponent::publishPose()
+   {
+      dMemcpy(mTarget->mTransformTable[1], mPalette, sizeof(F32) * 16 * mPaletteCount);
+      mTarget->mTransformCount = mPaletteCount + 1;
+      mTarget->refreshTransforms();
+   }
+
+   static Vector<AnimationComponent*> sBatchJobs;
+
+   // Runs on the job system: evaluates a range of sBatchJobs.
+   static void evaluatePoseJob(void* data, U32 first, U32 count)
+   {
+      for (U32 n = first; n < first + count; ++n)
+         sBatchJobs[n]->evaluatePose();
+   }
+
+   void AnimationComponent::initBatch()
+   {
+      Con::addVariable("Animation::LODDistance", TypeF32, &smLODDistance);
+      Con::addVariable("Animation::LODMaxInterval", TypeS32, &smLODMaxInterval);
+      Con::addVariable("Animation::evaluatedCount", TypeS32, &smEvaluatedCount);
+      Con::addVariable("Animation::skippedCount", TypeS32, &smSkippedCount);
+   }
+
+   void AnimationComponent::destroyBatch()
+   {
+      sBatchJobs.clear();
+   }
+
+   void AnimationComponent::updateBatch()
+   {
+      PROFILE_SCOPE(AnimationComponent_UpdateBatch);
+
+      smEvaluatedCount  = 0;
+      smSkippedCount    = 0;
+
+      Rendering::RenderCamera* camera = Rendering::getPriorityRenderCamera();
+      Vector<AnimationComponent*>& batchList = getBatchList();
+
+      // Collect the skeletons that need a new pose this frame. Update rate
+      // halves each time the distance from the camera doubles past smLODDistance.
+      sBatchJobs.clear();
+      for (S32 n = 0; n < batchList.size(); ++n)
+      {
+         AnimationComponent* component = batchList[n];
+         if (component->mTarget.isNull() || !component->mMeshAsset->isLoaded())
+            continue;
+
+         U32 interval = 1;
+         if (camera != NULL && smLODDistance > 0.0f)
+         {
+            Point3F offset = component->mOwnerObject->mTransform.matrix.getPosition() - camera->position;
+            F32 distance = offset.len();
+            while (distance > smLODDistance && interval < smLODMaxInterval)
+            {
+               distance *= 0.5f;
+               interval *= 2;
+            }
+         }
+
+         component->mFramesSinceUpdate++;
+         if (component->mFramesSinceUpdate < interval)
+         {
+            smSkippedCount++;
+            continue;
+         }
+
+         component->mFramesSinceUpdate = 0;
+         sBatchJobs.push_back(component);
+      }
+
+      U32 jobCount = sBatchJobs.size();
+      smEvaluatedCount = jobCount;
+      if (jobCount == 0)
+         return;
+
+      // Evaluate. The main thread helps out while it waits.
+      JobCounter evaluated;
+      JobSystem::parallelFor(jobCount, 0, evaluatePoseJob, NULL, &evaluated);
+      JobSystem::wait(evaluated);
+
+      // Publish.
+      for (U32 n = 0; n < jobCount; ++n)
+         sBatchJobs[n]->publishPose();
+   }
 }
@@ -55,8 +55,16 @@ namespace Scene
 		   F64 mAnimationTime;
 		   F32 mSpeed;
 
+         // Pose evaluated by the animation batch, published to mTarget
+         // on the main thread before rendering.
+         F32 mPalette[MeshComponent::MaxBones][16];
+         U32 mPaletteCount;
+         U32 mFramesSinceUpdate;
+         bool mInBatch;
+
       public:
          AnimationComponent();
+         ~AnimationComponent();
 
          void onAddToScene();
          void onRemoveFromScene();
@@ -83,6 +91,20 @@ namespace Scene
          void setAnimationIndex(U32 index);
          Vector<StringTableEntry> getAnimationNames();
 
+         // Animation Batch. All active AnimationComponents have their poses
+         // evaluated in parallel once per frame, then published before rendering.
+         static F32 smLODDistance;     ///< Distance from the camera before update rate starts to drop.
+         static U32 smLODMaxInterval;  ///< Maximum number of frames between pose updates.
+         static U32 smEvaluatedCount;  ///< Skeletons evaluated last frame.
+         static U32 smSkippedCount;    ///< Skeletons skipped by LOD last frame.
+
+         static void initBatch();
+         static void destroyBatch();
+         static void updateBatch();
+
+         void evaluatePose();
+         void publishPose();
+
       protected:
          static bool setMeshField(void* obj, const char* data) { static_cast<AnimationComponent*>(obj)->setMesh( data ); return false; }
          static bool setAnimationIndexField(void* obj, const char* data) { static_cast<AnimationComponent*>(obj)->setAnimationIndex((U32)dAtoi(data)); return false; }
@@ -35,7 +35,9 @@ namespace Scene
    IMPLEMENT_CONOBJECT(BaseComponent);
 
    BaseComponent::BaseComponent()
-      : mOwnerObject(NULL)
+      : mOwnerObject(NULL),
+        mSceneTypeSlot(-1),
+        mTransformHandle(-1)
    {
       mTypeString = "Base";
       mBoundingBox.minExtents.set(0, 0, 0);
@@ -70,12 +72,41 @@ namespace Scene
       if ( !mOwnerObject ) return;
 
       // Combine local and world.
-      mTransformMatrix = mOwnerObject->mTransform.matrix * mTransform.matrix;
+      if (mTransformHandle >= 0)
+      {
+         // The owner may have been moved without refreshing itself.
+         Scene::setLocalTransform(mOwnerObject->mTransformHandle, mOwnerObject->mTransform.matrix);
+         Scene::setLocalTransform(mTransformHandle, mTransform.matrix);
+         mTransformMatrix = Scene::getWorldTransform(mTransformHandle);
+         Scene::clearTransformDirty(mTransformHandle);
+      }
+      else
+         mTransformMatrix = mOwnerObject->mTransform.matrix * mTransform.matrix;
 
       // Set world position.
       mWorldPosition.set(mTransformMatrix[12], mTransformMatrix[13], mTransformMatrix[14]);
    }
 
+   void BaseComponent::onTransformChanged(const MatrixF& world)
+   {
+      // Components derive all sorts of state from their transform so the
+      // default is a full refresh. Cheaper overrides only publish the matrix.
+      refresh();
+   }
+
+   void BaseComponent::onWorldTransformChanged(void* data, const MatrixF& world)
+   {
+      static_cast<BaseComponent*>(data)->onTransformChanged(world);
+   }
+
+   MatrixF BaseComponent::getTransform()
+   {
+      if (mTransformHandle >= 0)
+         return Scene::getWorldTransform(mTransformHandle);
+
+      return mTransformMatrix;
+   }
+
    void BaseComponent::setUniformVec4(const char* name, Point4F value)
    {
       bgfx::UniformHandle handle = Graphics::Shader::getUniformVec4(StringTable->insert(name));
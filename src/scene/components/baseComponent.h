@@ -51,6 +51,10 @@
 #include "scene/object.h"
 #endif
 
+#ifndef _SCENE_TRANSFORM_SYSTEM_H_
+#include "scene/transformSystem.h"
+#endif
+
 class NetConnection;
 
 namespace Scene 
@@ -75,6 +79,12 @@ namespace Scene
          Scene::SceneObject*  mOwnerObject;
          const char*          mTypeString;
 
+         // Slot in the scene's type index. Managed by the Scene namespace.
+         S32                  mSceneTypeSlot;
+
+         // Transform parented to the owner's in the transform system. Managed by SceneObject.
+         S32                  mTransformHandle;
+
          BaseComponent();
          virtual ~BaseComponent() { }
 
@@ -93,9 +103,14 @@ namespace Scene
          virtual bool boxSearch(const PlaneSetF& planes);
          virtual void refresh();
 
+         // Called by the transform system when the world matrix moved
+         // without a refresh, e.g. the owner was moved by updateTransform().
+         virtual void onTransformChanged(const MatrixF& world);
+         static void onWorldTransformChanged(void* data, const MatrixF& world);
+
          virtual Box3F getBoundingBox();
 
-         virtual MatrixF getTransform()                  { return mTransformMatrix; }
+         virtual MatrixF getTransform();
          virtual Point3F getWorldPosition()              { return mWorldPosition; }
          virtual void    setWorldPosition(Point3F pos)   { mWorldPosition = pos; }
 
@@ -160,7 +160,7 @@ namespace Scene
          if (mPhysicsCharacter == NULL)
          {
             mOwnerObject->mTransform.setPosition(mCurrent.position);
-            mOwnerObject->refresh();
+            mOwnerObject->updateTransform();
          }
       }
    }
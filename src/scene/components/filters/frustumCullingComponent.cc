@@ -28,6 +28,7 @@
 #include "graphics/shaders.h"
 #include "graphics/core.h"
 #include "rendering/rendering.h"
+#include "rendering/frameSnapshot.h"
 #include "scene/scene.h"
 #include "scene/components/cameraComponent.h"
 #include "sysgui/sysgui.h"
@@ -146,6 +147,28 @@ namespace Scene
       mDebugger->updateStats(totalObjects, objectsCulled, objectsCacheCulled);
    }
 
+   void FrustumCullingComponent::captureSnapshot(Rendering::CameraSnapshot* snapshot)
+   {
+      // The snapshot is culled against the same frustum on the job system.
+      snapshot->frustumCull = true;
+   }
+
+   bool FrustumCullingComponent::applySnapshot(const Rendering::CameraSnapshot* snapshot)
+   {
+      if (!snapshot->frustumCull)
+         return false;
+
+      Rendering::RenderData* renderData = Rendering::getRenderDataList();
+      for (U32 n = 0; n < snapshot->renderDataCount; ++n, ++renderData)
+      {
+         if (snapshot->culled[n])
+            renderData->flags |= Rendering::RenderData::Filtered;
+      }
+
+      mDebugger->updateStats(Rendering::getRenderDataCount(), snapshot->culledCount, 0);
+      return true;
+   }
+
    // ----------------------------------------
    //   FrustumCulling Debugger : Displays the bounding spheres that are being tested.
    // ----------------------------------------
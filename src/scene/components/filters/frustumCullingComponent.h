@@ -75,6 +75,8 @@ namespace Scene
          virtual void onRemoveFromCamera();
 
          virtual void execute();
+         virtual void captureSnapshot(Rendering::CameraSnapshot* snapshot);
+         virtual bool applySnapshot(const Rendering::CameraSnapshot* snapshot);
 
          DECLARE_CONOBJECT(FrustumCullingComponent);
    };
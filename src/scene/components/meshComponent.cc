@@ -312,6 +312,18 @@ namespace Scene
       }
    }
 
+   // Moving only needs the transform table and bounds, not materials and lights.
+   void MeshComponent::onTransformChanged(const MatrixF& world)
+   {
+      mTransformMatrix = world;
+      mWorldPosition.set(mTransformMatrix[12], mTransformMatrix[13], mTransformMatrix[14]);
+
+      if ( mOwnerObject == NULL ) return;
+      if ( mMeshAsset.isNull() ) return;
+
+      refreshTransforms();
+   }
+
    // By making this a separate function animations don't need to update everything.
    // That includes skipping getNearestLights call.
    void MeshComponent::refreshTransforms()
@@ -82,8 +82,14 @@ namespace Scene
          bool                                mAddedToScene;
 
       public:
+         enum
+         {
+            MaxTransforms  = 75,                   ///< The object transform followed by the bones.
+            MaxBones       = MaxTransforms - 1
+         };
+
          // TODO: maybe not public?
-         F32 mTransformTable[75][16];
+         F32 mTransformTable[MaxTransforms][16];
          U32 mTransformCount;
 
          MeshComponent();
@@ -96,6 +102,7 @@ namespace Scene
          bool boxSearch(const PlaneSetF& planes);
          void refresh();
          void refreshTransforms();
+         void onTransformChanged(const MatrixF& world);
          void refreshMaterials();
          void setMesh( const char* pMeshAssetId );
          AssetPtr<MeshAsset> getMesh() { return mMeshAsset; }
@@ -167,7 +167,7 @@ namespace Scene
          mExpectedOwnerRotation = mNextOwnerRotation;
       }
 
-      mOwnerObject->refresh();
+      mOwnerObject->updateTransform();
    }
 
    void PhysicsBaseComponent::processTick()
@@ -24,6 +24,8 @@
 #include "console/consoleInternal.h"
 #include "components/baseComponent.h"
 #include "game/moveList.h"
+#include "scene/scene.h"
+#include "scene/transformSystem.h"
 
 #include <bx/fpumath.h>
 
@@ -38,6 +40,8 @@ namespace Scene
    {
       mStatic = true;
       mGhosted = false;
+      mSceneProxy = -1;
+      mTransformHandle = -1;
       mNetFlags.set( Ghostable | ScopeAlways );
 
       mTemplateAssetID = StringTable->EmptyString;
@@ -47,8 +51,12 @@ namespace Scene
 
    SceneObject::~SceneObject()
    {
+      Scene::unindexObject(this);
       clearComponents();
 
+      if (mTransformHandle >= 0)
+         Scene::destroyTransform(mTransformHandle);
+
       if ( mTemplate != NULL )
          mTemplate->deleteObject();
    }
@@ -74,10 +82,16 @@ namespace Scene
    {
       mAddedToScene = true;
 
+      if (mTransformHandle < 0)
+         mTransformHandle = Scene::createTransform(-1, &SceneObject::onWorldTransformChanged, this);
+      Scene::setLocalTransform(mTransformHandle, mTransform.matrix);
+
       for (S32 n = 0; n < mComponents.size(); ++n)
       {
          mComponents[n]->setOwnerObject(this);
+         addComponentTransform(mComponents[n]);
          mComponents[n]->onAddToScene();
+         Scene::indexComponent(mComponents[n]);
       }
 
       refresh();
@@ -88,7 +102,17 @@ namespace Scene
       mAddedToScene = false;
 
       for (S32 n = 0; n < mComponents.size(); ++n)
+      {
          mComponents[n]->onRemoveFromScene();
+         Scene::unindexComponent(mComponents[n]);
+         removeComponentTransform(mComponents[n]);
+      }
+
+      if (mTransformHandle >= 0)
+      {
+         Scene::destroyTransform(mTransformHandle);
+         mTransformHandle = -1;
+      }
    }
 
    void SceneObject::onSceneStart()
@@ -137,7 +161,9 @@ namespace Scene
       
       if (mAddedToScene)
       {
+         addComponentTransform(component);
          component->onAddToScene();
+         Scene::indexComponent(component);
 
          if (Scene::isPlaying())
          {
@@ -155,6 +181,8 @@ namespace Scene
          {
             mComponents.erase(n);
             component->onRemoveFromScene();
+            Scene::unindexComponent(component);
+            removeComponentTransform(component);
             component->unregisterObject();
             SAFE_DELETE(component);
          }
@@ -166,6 +194,8 @@ namespace Scene
       for (S32 n = 0; n < mComponents.size(); ++n)
       {
          mComponents[n]->onRemoveFromScene();
+         Scene::unindexComponent(mComponents[n]);
+         removeComponentTransform(mComponents[n]);
          mComponents[n]->deleteObject();
       }
 
@@ -199,13 +229,25 @@ namespace Scene
 
    bool SceneObject::raycast(const Point3F& start, const Point3F& end, Point3F& hitPoint)
    {
+      // Return the nearest hit of all components.
+      bool result = false;
+      F32 nearestDistSq = F32_MAX;
       for (S32 n = 0; n < mComponents.size(); ++n)
       {
-         if (mComponents[n]->raycast(start, end, hitPoint))
-            return true;
+         Point3F componentHit;
+         if (!mComponents[n]->raycast(start, end, componentHit))
+            continue;
+
+         F32 distSq = (componentHit - start).lenSquared();
+         if (distSq < nearestDistSq)
+         {
+            nearestDistSq = distSq;
+            hitPoint = componentHit;
+            result = true;
+         }
       }
 
-      return false;
+      return result;
    }
 
    bool SceneObject::boxSearch(const PlaneSetF& planes)
@@ -219,12 +261,55 @@ namespace Scene
       return false;
    }
 
+   void SceneObject::addComponentTransform(BaseComponent* component)
+   {
+      if (mTransformHandle < 0 || component->mTransformHandle >= 0)
+         return;
+
+      component->mTransformHandle = Scene::createTransform(mTransformHandle, &BaseComponent::onWorldTransformChanged, component);
+      Scene::setLocalTransform(component->mTransformHandle, component->mTransform.matrix);
+   }
+
+   void SceneObject::removeComponentTransform(BaseComponent* component)
+   {
+      if (component->mTransformHandle < 0)
+         return;
+
+      Scene::destroyTransform(component->mTransformHandle);
+      component->mTransformHandle = -1;
+   }
+
    void SceneObject::refresh()
    {
+      if (mTransformHandle >= 0)
+         Scene::setLocalTransform(mTransformHandle, mTransform.matrix);
+
       // Refresh components
       for (S32 n = 0; n < mComponents.size(); ++n)
          mComponents[n]->refresh();
 
+      // The components are up to date, the next update can skip them.
+      if (mTransformHandle >= 0)
+         Scene::clearTransformDirty(mTransformHandle);
+
+      updateBounds();
+   }
+
+   void SceneObject::updateTransform()
+   {
+      if (mTransformHandle >= 0)
+         Scene::setLocalTransform(mTransformHandle, mTransform.matrix);
+      else
+         refresh();
+   }
+
+   void SceneObject::onWorldTransformChanged(void* data, const MatrixF& world)
+   {
+      static_cast<SceneObject*>(data)->updateBounds();
+   }
+
+   void SceneObject::updateBounds()
+   {
       // Calculate bounding box based on component bounding boxes.
       Box3F newBoundingBox;
       newBoundingBox.set(Point3F(0, 0, 0));
@@ -238,6 +323,10 @@ namespace Scene
       mBoundingBox = newBoundingBox;
       mBoundingBox.transform(mTransform);
 
+      // Keep the scene's spatial index up to date.
+      if (mAddedToScene)
+         Scene::indexObject(this);
+
       //if ( isServerObject() )
       //   setMaskBits(TransformMask);
    }
@@ -343,7 +432,7 @@ namespace Scene
       if ( stream->readFlag() )
       {
          stream->readTransform(&mTransform);
-         refresh();
+         updateTransform();
       }
 
       // Components
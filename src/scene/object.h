@@ -74,6 +74,13 @@ namespace Scene
          Transform   mTransform;
          bool        mStatic;
 
+         // Proxy in the scene's AABB tree. Managed by the Scene namespace.
+         S32         mSceneProxy;
+
+         // Root of this object's transforms in the transform system, valid
+         // while the object is in the scene.
+         S32         mTransformHandle;
+
          // GameObject
          virtual void processMove( const Move *move );
          virtual void interpolateMove( F32 delta );
@@ -84,6 +91,11 @@ namespace Scene
          bool boxSearch(const PlaneSetF& planes);
          virtual void refresh();
 
+         // Cheaper than refresh() for moving an object: pushes mTransform to the
+         // transform system, components and bounds follow at the next update.
+         void updateTransform();
+         static void onWorldTransformChanged(void* data, const MatrixF& world);
+
          static void initPersistFields();
 
          static bool setPositionFn(void* obj, const char* data);
@@ -120,6 +132,10 @@ namespace Scene
          SimObject* findComponent(StringTableEntry internalName);
 
       protected:
+         void updateBounds();
+         void addComponentTransform(BaseComponent* component);
+         void removeComponentTransform(BaseComponent* component);
+
          virtual void onTamlCustomWrite(TamlCustomNodes& customNodes);
          virtual void onTamlCustomRead(const TamlCustomNodes& customNodes);
          static bool setTemplateAsset( void* obj, const char* data ) { static_cast<SceneObject*>(obj)->setTemplateAsset(data); return false; }
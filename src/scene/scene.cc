@@ -28,9 +28,16 @@
 #include "graphics/core.h"
 #include "rendering/rendering.h"
 #include "scene/object.h"
+#include "scene/transformSystem.h"
+#include "scene/components/animationComponent.h"
+#include "math/mDynamicAABBTree.h"
+#include "collection/hashTable.h"
+#include "persistence/taml/tamlAsyncReader.h"
+#include "platform/threads/jobSystem.h"
 
 #include <bgfx/bgfx.h>
 #include <bx/fpumath.h>
+#include <bounds.h>
 
 #include "scene_Binding.h"
 
@@ -40,17 +47,42 @@ namespace Scene
    static Vector<ScenePreprocessor*>   sPreprocessorList;
    static bool                         sIsPlaying = false;
    static bool                         sFirstPlay = true;
+   static DynamicAABBTree              sSceneTree;
+   static Box3F                        sSceneBounds;
+   static bool                         sSceneBoundsDirty = true;
+
+   typedef HashMap<StringTableEntry, Vector<BaseComponent*> > ComponentTypeIndex;
+   static ComponentTypeIndex           sComponentTypeIndex;
+
+   // Streaming load in progress.
+   struct SceneLoad
+   {
+      Taml              taml;
+      TamlAsyncReader   reader;
+
+      SceneLoad() : reader(&taml) { }
+   };
+   static SceneLoad*                   sLoad = NULL;
+   static S32                          sLoadBudget = 4;
 
    // Init/Destroy
    void init()
    {
       sIsPlaying = false;
       sFirstPlay = true;
+
+      initTransforms();
+      AnimationComponent::initBatch();
+
+      Con::addVariable("$Scene::loadBudget", TypeS32, &sLoadBudget);
    }
 
    void destroy()
    {
       clear();
+
+      AnimationComponent::destroyBatch();
+      destroyTransforms();
    }
 
    void play()
@@ -110,6 +142,8 @@ namespace Scene
 
    void clear()
    {
+      cancelLoading();
+
       while (sSceneGroup.size() > 0)
       {
          SceneObject* obj = dynamic_cast<SceneObject*>(sSceneGroup[0]);
@@ -142,6 +176,28 @@ namespace Scene
       }
    }
 
+   // Moves the objects read from a scene file into the scene.
+   static void addLoadedObjects(SimGroup* group)
+   {
+      S32 n = 0;
+      while (n < group->size())
+      {
+         // Anything else stays with the group.
+         SceneObject* obj = dynamic_cast<SceneObject*>(group->at(n));
+         if (!obj)
+         {
+            ++n;
+            continue;
+         }
+
+         sSceneGroup.addObject(obj);
+         obj->onAddToScene();
+
+         if (sIsPlaying)
+            obj->onScenePlay();
+      }
+   }
+
    void append(const char* filename)
    {
        load(filename, true);
@@ -157,21 +213,84 @@ namespace Scene
       Taml tamlReader;
       SimGroup* group = tamlReader.read<SimGroup>(filename);
       if (group)
+         addLoadedObjects(group);
+      refresh();
+   }
+
+   void loadAsync(const char* filename, bool append)
+   {
+      // One streaming load at a time.
+      cancelLoading();
+
+      // Clear old scene if we're not appending.
+      if ( !append )
+        clear();
+
+      sLoad = new SceneLoad;
+      if (!sLoad->reader.start(filename))
       {
-         while (group->size() > 0)
-         {
-            SceneObject* obj = dynamic_cast<SceneObject*>(group->at(0));
-            if (obj)
-            {
-               sSceneGroup.addObject(obj);
-               obj->onAddToScene();
+         SAFE_DELETE(sLoad);
+         return;
+      }
 
-               if (sIsPlaying)
-                  obj->onScenePlay();
-            }
-         }
+      // Without the job system there are no frames to spread the load over.
+      if (!JobSystem::isInitialized())
+      {
+         while (updateLoading(U32_MAX)) { }
+         return;
       }
+   }
+
+   bool isLoading()
+   {
+      return sLoad != NULL;
+   }
+
+   bool updateLoading(U32 budgetMs)
+   {
+      if (!sLoad)
+         return false;
+
+      bool finished = sLoad->reader.update(budgetMs);
+
+      // Add what has been read so far.
+      SimObject* root = sLoad->reader.getRootObject();
+      SimGroup* group = dynamic_cast<SimGroup*>(root);
+      if (group)
+         addLoadedObjects(group);
+
+      if (!finished)
+         return true;
+
+      // The root was only a container.
+      if (root)
+         root->deleteObject();
+
+      SAFE_DELETE(sLoad);
       refresh();
+      return false;
+   }
+
+   // Called once a frame from the main loop, never from inside a job or a
+   // wait, since adding objects creates transforms and components.
+   void processLoading()
+   {
+      updateLoading(getMax(sLoadBudget, 1));
+   }
+
+   void cancelLoading()
+   {
+      if (!sLoad)
+         return;
+
+      sLoad->reader.cancel();
+
+      // Objects that haven't reached the scene go with the root.
+      SimObject* root = sLoad->reader.getRootObject();
+      if (root)
+         root->deleteObject();
+
+      SAFE_DELETE(sLoad);
    }
 
    void save(const char* filename)
@@ -187,11 +306,14 @@ namespace Scene
 
    Box3F getSceneBounds()
    {
-      // TODO: Cache result instead of calculating per call?
+      // The cached result is only recalculated after an object is added, moved or removed.
+      if (!sSceneBoundsDirty)
+         return sSceneBounds;
 
       // Calculate bounding box based on SceneObject bounding boxes.
-      Box3F sceneBounds;
-      sceneBounds.set(Point3F(0, 0, 0));
+      // Note: Box3F::intersect() extends the box, so this is the union.
+      bool first = true;
+      sSceneBounds.set(Point3F(0, 0, 0));
 
       for (S32 n = 0; n < sSceneGroup.size(); ++n)
       {
@@ -199,13 +321,16 @@ namespace Scene
          if (!obj) 
             continue;
          
-         if (n == 0)
-            sceneBounds = obj->mBoundingBox;
+         if (first)
+            sSceneBounds = obj->mBoundingBox;
          else
-            sceneBounds.intersect(obj->mBoundingBox);
+            sSceneBounds.intersect(obj->mBoundingBox);
+
+         first = false;
       }
 
-      return sceneBounds;
+      sSceneBoundsDirty = false;
+      return sSceneBounds;
    }
 
    void addObject(SceneObject* obj, const char* name)
@@ -235,39 +360,35 @@ namespace Scene
    {
       Scene::sSceneGroup.removeObject(obj);
       obj->onRemoveFromScene();
+      unindexObject(obj);
    }
 
    SceneObject* findObject(const char* name)
    {
-       for (S32 n = 0; n < sSceneGroup.size(); ++n)
-       {
-           SceneObject* obj = dynamic_cast<SceneObject*>(sSceneGroup.at(n));
-           if (!obj)
-               continue;
+      if (name == NULL || name[0] == 0)
+         return NULL;
 
-           StringTableEntry objName = obj->getName();
-           if (!objName)
-               continue;
-
-           if (dStrcmp(objName, name) == 0)
-               return obj;
-       }
-
-       return NULL;
+      // The scene group keeps a name dictionary of its children.
+      return dynamic_cast<SceneObject*>(sSceneGroup.findObject(name));
    }
 
    Vector<SimObject*> findComponentsByType(const char* pType)
    {
       Vector<SimObject*> results;
 
-      for (S32 n = 0; n < sSceneGroup.size(); ++n)
-      {
-         SceneObject* obj = dynamic_cast<SceneObject*>(sSceneGroup.at(n));
-         if (!obj)
-            continue;
+      // Types that were never added to the scene won't be in the string table either.
+      StringTableEntry typeName = StringTable->lookup(pType);
+      if (typeName == NULL)
+         return results;
 
-         results.merge(obj->findComponentsByType(pType));
-      }
+      ComponentTypeIndex::iterator itr = sComponentTypeIndex.find(typeName);
+      if (itr == sComponentTypeIndex.end())
+         return results;
+
+      const Vector<BaseComponent*>& components = itr->value;
+      results.reserve(components.size());
+      for (S32 n = 0; n < components.size(); ++n)
+         results.push_back(components[n]);
 
       return results;
    }
@@ -286,49 +407,248 @@ namespace Scene
       }
    }
 
+   // Clips the ray to the nearest SceneObject hit as the tree is walked.
+   struct SceneRaycastCallback
+   {
+      Point3F        start;
+      Point3F        end;
+      F32            rayLength;
+      SceneObject*   result;
+      Point3F        hitPoint;
+
+      F32 raycastCallback(S32 proxyId, F32 maxFraction)
+      {
+         SceneObject* obj = static_cast<SceneObject*>(sSceneTree.getUserData(proxyId));
+
+         Point3F objHitPoint;
+         if (!obj->raycast(start, end, objHitPoint))
+            return maxFraction;
+
+         F32 fraction = rayLength > 0.0f ? (objHitPoint - start).len() / rayLength : 0.0f;
+         if (fraction >= maxFraction)
+            return maxFraction;
+
+         result   = obj;
+         hitPoint = objHitPoint;
+
+         // Zero would terminate the raycast.
+         return getMax(fraction, FLT_EPSILON);
+      }
+   };
+
    SceneObject* raycast(const Point3F& start, const Point3F& end)
    {
-      SceneObject* result = NULL;
-      Point3F hitPoint = end;
-      F32 lastHitDistance = Point3F(hitPoint - start).len();
+      Point3F hitPoint;
+      return raycast(start, end, hitPoint);
+   }
 
-      for(S32 n = 0; n < sSceneGroup.size(); ++n)
+   SceneObject* raycast(const Point3F& start, const Point3F& end, Point3F& hitPoint)
+   {
+      PROFILE_SCOPE(Scene_Raycast);
+
+      SceneRaycastCallback callback;
+      callback.start       = start;
+      callback.end         = end;
+      callback.rayLength   = (end - start).len();
+      callback.result      = NULL;
+      callback.hitPoint    = end;
+
+      sSceneTree.raycast(start, end, &callback);
+
+      hitPoint = callback.hitPoint;
+      return callback.result;
+   }
+
+   U32 raycast(const Point3F* starts, const Point3F* ends, U32 count, SceneObject** results, Point3F* hitPoints)
+   {
+      PROFILE_SCOPE(Scene_RaycastBatch);
+
+      U32 hitCount = 0;
+      for (U32 n = 0; n < count; ++n)
       {
-         SceneObject* obj = dynamic_cast<SceneObject*>(sSceneGroup.at(n));
-         if ( !obj)
-            continue;
+         Point3F hitPoint;
+         results[n] = raycast(starts[n], ends[n], hitPoint);
+         if (hitPoints != NULL)
+            hitPoints[n] = hitPoint;
+
+         if (results[n] != NULL)
+            hitCount++;
+      }
+
+      return hitCount;
+   }
+
+   // Collects SceneObjects from the tree. Plane sets, spheres and boxes
+   // cull whole branches of the tree via testNode().
+   struct SceneQueryCallback
+   {
+      Vector<SceneObject*>*   results;
+      const PlaneSetF*        planes;
+      const SphereF*          sphere;
+      bool                    containedOnly;
 
-         if (obj->raycast(start, end, hitPoint))
+      SceneQueryCallback(Vector<SceneObject*>* _results)
+         : results(_results), planes(NULL), sphere(NULL), containedOnly(false) { }
+
+      bool testNode(const Box3F& box)
+      {
+         if (planes != NULL)
+            return planes->testPotentialIntersection(box) != GeometryOutside;
+
+         if (sphere != NULL)
+            return box.isOverlapped(*sphere);
+
+         return true;
+      }
+
+      bool queryCallback(S32 proxyId)
+      {
+         SceneObject* obj = static_cast<SceneObject*>(sSceneTree.getUserData(proxyId));
+
+         // The tree stores enlarged boxes, so test the real bounds again.
+         if (containedOnly)
          {
-            F32 hitDistance = Point3F(hitPoint - start).len();
-            if (hitDistance < lastHitDistance)
-            {
-               lastHitDistance = hitDistance;
-               result = obj;
-            }
+            if (obj->boxSearch(*planes))
+               results->push_back(obj);
+            return true;
          }
+
+         if (planes != NULL && planes->testPotentialIntersection(obj->mBoundingBox) == GeometryOutside)
+            return true;
+
+         if (sphere != NULL && !obj->mBoundingBox.isOverlapped(*sphere))
+            return true;
+
+         results->push_back(obj);
+         return true;
       }
+   };
 
-      return result;
-   }
+   // Box queries don't need a custom node test.
+   struct SceneBoxQueryCallback
+   {
+      Vector<SceneObject*>*   results;
+      Box3F                   box;
+
+      bool queryCallback(S32 proxyId)
+      {
+         SceneObject* obj = static_cast<SceneObject*>(sSceneTree.getUserData(proxyId));
+         if (obj->mBoundingBox.isOverlapped(box))
+            results->push_back(obj);
+         return true;
+      }
+   };
 
    Vector<SceneObject*> boxSearch(const PlaneSetF& planes)
    {
+      PROFILE_SCOPE(Scene_BoxSearch);
+
       Vector<SceneObject*> results;
 
-      for (S32 n = 0; n < sSceneGroup.size(); ++n)
-      {
-         SceneObject* obj = dynamic_cast<SceneObject*>(sSceneGroup.at(n));
-         if (!obj)
-            continue;
+      SceneQueryCallback callback(&results);
+      callback.planes         = &planes;
+      callback.containedOnly  = true;
+      sSceneTree.queryCustom(&callback);
 
-         if (obj->boxSearch(planes))
-            results.push_back(obj);
-      }
+      return results;
+   }
+
+   Vector<SceneObject*> findObjects(const Box3F& box)
+   {
+      Vector<SceneObject*> results;
+
+      SceneBoxQueryCallback callback;
+      callback.results  = &results;
+      callback.box      = box;
+      sSceneTree.query(box, &callback);
+
+      return results;
+   }
+
+   Vector<SceneObject*> findObjects(const SphereF& sphere)
+   {
+      Vector<SceneObject*> results;
+
+      SceneQueryCallback callback(&results);
+      callback.sphere = &sphere;
+      sSceneTree.queryCustom(&callback);
+
+      return results;
+   }
+
+   Vector<SceneObject*> findObjects(const PlaneSetF& planes)
+   {
+      Vector<SceneObject*> results;
+
+      SceneQueryCallback callback(&results);
+      callback.planes = &planes;
+      sSceneTree.queryCustom(&callback);
 
       return results;
    }
 
+   Vector<SceneObject*> findObjectsInFrustum(const F32* viewProjMtx)
+   {
+      // Frustum planes face inward, same as PlaneSetF expects.
+      Plane frustumPlanes[6];
+      buildFrustumPlanes(frustumPlanes, viewProjMtx);
+
+      PlaneF planes[6];
+      for (U32 i = 0; i < 6; ++i)
+         planes[i].set(frustumPlanes[i].m_normal[0], frustumPlanes[i].m_normal[1], frustumPlanes[i].m_normal[2], frustumPlanes[i].m_dist);
+
+      return findObjects(PlaneSetF(planes, 6));
+   }
+
+   void indexObject(SceneObject* obj)
+   {
+      sSceneBoundsDirty = true;
+
+      if (obj->mSceneProxy == DynamicAABBTree::NullNode)
+         obj->mSceneProxy = sSceneTree.createProxy(obj->mBoundingBox, obj);
+      else
+         sSceneTree.moveProxy(obj->mSceneProxy, obj->mBoundingBox);
+   }
+
+   void unindexObject(SceneObject* obj)
+   {
+      if (obj->mSceneProxy == DynamicAABBTree::NullNode)
+         return;
+
+      sSceneTree.destroyProxy(obj->mSceneProxy);
+      obj->mSceneProxy = DynamicAABBTree::NullNode;
+      sSceneBoundsDirty = true;
+   }
+
+   void indexComponent(BaseComponent* component)
+   {
+      if (component->mSceneTypeSlot != -1)
+         return;
+
+      Vector<BaseComponent*>& components = sComponentTypeIndex[StringTable->insert(component->getClassName())];
+      component->mSceneTypeSlot = components.size();
+      components.push_back(component);
+   }
+
+   void unindexComponent(BaseComponent* component)
+   {
+      if (component->mSceneTypeSlot == -1)
+         return;
+
+      ComponentTypeIndex::iterator itr = sComponentTypeIndex.find(StringTable->insert(component->getClassName()));
+      if (itr != sComponentTypeIndex.end())
+      {
+         // Swap the last component into the vacated slot.
+         Vector<BaseComponent*>& components = itr->value;
+         const S32 slot = component->mSceneTypeSlot;
+         components[slot] = components.last();
+         components[slot]->mSceneTypeSlot = slot;
+         components.pop_back();
+      }
+
+      component->mSceneTypeSlot = -1;
+   }
+
    void onCameraScopeQuery(NetConnection *cr, CameraScopeQuery *camInfo)
    {
       for(S32 n = 0; n < sSceneGroup.size(); ++n)
@@ -39,9 +39,14 @@
 #include "math/mPlaneSet.h"
 #endif
 
+#ifndef _MSPHERE_H_
+#include "math/mSphere.h"
+#endif
+
 namespace Scene
 {
    class SceneObject;
+   class BaseComponent;
 
    // Init/Destroy
    void init();
@@ -59,6 +64,14 @@ namespace Scene
    void load(const char* filename, bool append = false);
    void save(const char* filename);
 
+   // Streaming. The file is parsed on a worker and its objects are added over the
+   // following frames, at most $Scene::loadBudget milliseconds a frame.
+   void loadAsync(const char* filename, bool append = false);
+   bool isLoading();
+   bool updateLoading(U32 budgetMs);
+   void processLoading();
+   void cancelLoading();
+
    // Scene Functions
    SimGroup*      getSceneGroup();
    Box3F          getSceneBounds();
@@ -71,8 +84,24 @@ namespace Scene
    Vector<SimObject*>   findComponentsByType(const char* pType);
    void                 refresh();
    SceneObject*         raycast(const Point3F& start, const Point3F& end);
+   SceneObject*         raycast(const Point3F& start, const Point3F& end, Point3F& hitPoint);
+   U32                  raycast(const Point3F* starts, const Point3F* ends, U32 count, SceneObject** results, Point3F* hitPoints = NULL);
    Vector<SceneObject*> boxSearch(const PlaneSetF& planes);
 
+   // Region Queries. These return every object whose bounds overlap the region.
+   Vector<SceneObject*> findObjects(const Box3F& box);
+   Vector<SceneObject*> findObjects(const SphereF& sphere);
+   Vector<SceneObject*> findObjects(const PlaneSetF& planes);
+   Vector<SceneObject*> findObjectsInFrustum(const F32* viewProjMtx);
+
+   // Spatial Index. SceneObjects update their entry whenever they're refreshed.
+   void                 indexObject(SceneObject* obj);
+   void                 unindexObject(SceneObject* obj);
+
+   // Type Index. SceneObjects update this as components enter and leave the scene.
+   void                 indexComponent(BaseComponent* component);
+   void                 unindexComponent(BaseComponent* component);
+
    // Networking
    void onCameraScopeQuery(NetConnection *cr, CameraScopeQuery *camInfo);
 
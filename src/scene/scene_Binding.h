@@ -54,6 +54,21 @@ ConsoleNamespaceFunction( Scene, load, ConsoleVoid, 2, 2, (""))
    Scene::load(argv[1]);
 }
 
+ConsoleNamespaceFunction( Scene, loadAsync, ConsoleVoid, 2, 3, ("filename, [append = false]"))
+{
+   Scene::loadAsync(argv[1], argc > 2 && dAtob(argv[2]));
+}
+
+ConsoleNamespaceFunction( Scene, isLoading, ConsoleBool, 1, 1, (""))
+{
+   return Scene::isLoading();
+}
+
+ConsoleNamespaceFunction( Scene, cancelLoading, ConsoleVoid, 1, 1, (""))
+{
+   Scene::cancelLoading();
+}
+
 ConsoleNamespaceFunction( Scene, save, ConsoleVoid, 2, 2, (""))
 {
    Scene::save(argv[1]);
@@ -109,6 +124,16 @@ namespace Scene{
          Scene::load(filename);
       }
 
+      DLL_PUBLIC void Scene_LoadAsync(const char* filename, bool append)
+      {
+         Scene::loadAsync(filename, append);
+      }
+
+      DLL_PUBLIC bool Scene_IsLoading()
+      {
+         return Scene::isLoading();
+      }
+
       DLL_PUBLIC void Scene_Save(const char* filename)
       {
          Scene::save(filename);
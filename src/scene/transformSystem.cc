@@ -0,0 +1,461 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2015 Andrew Mac
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//-----------------------------------------------------------------------------
+
+
+#include "transformSystem.h"
+#include "console/console.h"
+#include "console/consoleTypes.h"
+#include "platform/threads/jobSystem.h"
+#include "debug/profiler.h"
+
+namespace Scene
+{
+   enum
+   {
+      TransformGrainSize = 2048
+   };
+
+   // Slot arrays, in hierarchy order once sOrderDirty is cleared.
+   static Vector<S32>               sParents;         // Parent slot or -1.
+   static Vector<S32>               sChildCounts;
+   static Vector<MatrixF>           sLocal;
+   static Vector<MatrixF>           sWorld;
+   static Vector<U8>                sDirty;
+   static Vector<U8>                sChanged;
+   static Vector<S32>               sSlotHandles;     // -1 for destroyed slots.
+   static Vector<TransformCallback> sCallbacks;
+   static Vector<void*>             sCallbackData;
+
+   // Handle to slot, -1 for free handles.
+   static Vector<S32>               sHandleSlots;
+   static Vector<S32>               sFreeHandles;
+
+   // First slot of each depth, plus one past the end.
+   static Vector<U32>               sLevelStarts;
+   static bool                      sOrderDirty = false;
+   static S32                       sDirtyCount = 0;
+
+   static S32                       sTransformCount = 0;
+   static S32                       sTransformsUpdated = 0;
+
+   static inline S32 getSlot(S32 handle)
+   {
+      AssertFatal(handle >= 0 && handle < sHandleSlots.size() && sHandleSlots[handle] >= 0, "Scene::getSlot - invalid transform handle.");
+      return sHandleSlots[handle];
+   }
+
+   static inline void markDirty(S32 slot)
+   {
+      if (!sDirty[slot])
+      {
+         sDirty[slot] = 1;
+         sDirtyCount++;
+      }
+   }
+
+   static inline void computeWorld(S32 slot)
+   {
+      const S32 parent = sParents[slot];
+      if (parent < 0)
+         sWorld[slot] = sLocal[slot];
+      else
+         m_matF_x_matF(sLocal[slot], sWorld[parent], sWorld[slot]);
+   }
+
+   // ----------------------------------------
+   //   Hierarchy Order
+   // ----------------------------------------
+
+   template<class T> static void permute(Vector<T>& values, const Vector<S32>& newSlots, U32 count)
+   {
+      Vector<T> sorted;
+      sorted.setSize(count);
+      for (S32 n = 0; n < values.size(); ++n)
+      {
+         if (newSlots[n] >= 0)
+            sorted[newSlots[n]] = values[n];
+      }
+      values = sorted;
+   }
+
+   // Drops destroyed slots and sorts the rest by depth, keeping the existing
+   // order within each depth.
+   static void rebuildOrder()
+   {
+      PROFILE_SCOPE(Scene_RebuildTransformOrder);
+
+      const S32 slotCount = sParents.size();
+      Vector<S32> depths;
+      depths.setSize(slotCount);
+      for (S32 n = 0; n < slotCount; ++n)
+         depths[n] = -1;
+
+      // Depths. Parents may come after their children after a reparent so
+      // walk up until a known depth is found.
+      S32 maxDepth = -1;
+      for (S32 n = 0; n < slotCount; ++n)
+      {
+         if (sSlotHandles[n] < 0 || depths[n] >= 0)
+            continue;
+
+         S32 depth = 0;
+         S32 slot = sParents[n];
+         while (slot >= 0 && depths[slot] < 0)
+         {
+            depth++;
+            slot = sParents[slot];
+         }
+         if (slot >= 0)
+            depth += depths[slot] + 1;
+
+         // Fill in the chain on the way back down.
+         slot = n;
+         while (slot >= 0 && depths[slot] < 0)
+         {
+            depths[slot] = depth--;
+            slot = sParents[slot];
+         }
+
+         maxDepth = getMax(maxDepth, depths[n]);
+      }
+
+      // Counting sort by depth.
+      sLevelStarts.setSize(maxDepth + 2);
+      dMemset(sLevelStarts.address(), 0, sLevelStarts.memSize());
+      for (S32 n = 0; n < slotCount; ++n)
+      {
+         if (depths[n] >= 0)
+            sLevelStarts[depths[n] + 1]++;
+      }
+      for (S32 n = 1; n < sLevelStarts.size(); ++n)
+         sLevelStarts[n] += sLevelStarts[n - 1];
+
+      Vector<U32> next(sLevelStarts);
+      Vector<S32> newSlots;
+      newSlots.setSize(slotCount);
+      for (S32 n = 0; n < slotCount; ++n)
+         newSlots[n] = (depths[n] >= 0) ? (S32)next[depths[n]]++ : -1;
+
+      const U32 count = sLevelStarts.last();
+      for (S32 n = 0; n < slotCount; ++n)
+      {
+         if (newSlots[n] >= 0 && sParents[n] >= 0)
+            sParents[n] = newSlots[sParents[n]];
+      }
+
+      permute(sParents, newSlots, count);
+      permute(sChildCounts, newSlots, count);
+      permute(sLocal, newSlots, count);
+      permute(sWorld, newSlots, count);
+      permute(sDirty, newSlots, count);
+      permute(sChanged, newSlots, count);
+      permute(sSlotHandles, newSlots, count);
+      permute(sCallbacks, newSlots, count);
+      permute(sCallbackData, newSlots, count);
+
+      for (U32 n = 0; n < count; ++n)
+         sHandleSlots[sSlotHandles[n]] = n;
+
+      sOrderDirty = false;
+   }
+
+   // ----------------------------------------
+   //   Init/Destroy
+   // ----------------------------------------
+
+   void initTransforms()
+   {
+      Con::addVariable("Scene::transformCount", TypeS32, &sTransformCount);
+      Con::addVariable("Scene::transformsUpdated", TypeS32, &sTransformsUpdated);
+   }
+
+   void destroyTransforms()
+   {
+      sParents.clear();
+      sChildCounts.clear();
+      sLocal.clear();
+      sWorld.clear();
+      sDirty.clear();
+      sChanged.clear();
+      sSlotHandles.clear();
+      sCallbacks.clear();
+      sCallbackData.clear();
+      sHandleSlots.clear();
+      sFreeHandles.clear();
+      sLevelStarts.clear();
+      sOrderDirty       = false;
+      sDirtyCount       = 0;
+      sTransformCount   = 0;
+   }
+
+   // ----------------------------------------
+   //   Transforms
+   // ----------------------------------------
+
+   S32 createTransform(S32 parent, TransformCallback callback, void* data)
+   {
+      S32 handle;
+      if (sFreeHandles.size() > 0)
+      {
+         handle = sFreeHandles.last();
+         sFreeHandles.pop_back();
+      }
+      else
+      {
+         handle = sHandleSlots.size();
+         sHandleSlots.push_back(-1);
+      }
+
+      const S32 parentSlot = (parent >= 0) ? getSlot(parent) : -1;
+      if (parentSlot >= 0)
+         sChildCounts[parentSlot]++;
+
+      // Appending keeps parents ahead of children but not the depth order.
+      const S32 slot = sParents.size();
+      sHandleSlots[handle] = slot;
+      sParents.push_back(parentSlot);
+      sChildCounts.push_back(0);
+      sLocal.push_back(MatrixF(true));
+      sWorld.push_back(MatrixF(true));
+      sDirty.push_back(0);
+      sChanged.push_back(0);
+      sSlotHandles.push_back(handle);
+      sCallbacks.push_back(callback);
+      sCallbackData.push_back(data);
+
+      markDirty(slot);
+      sOrderDirty = true;
+      sTransformCount++;
+
+      return handle;
+   }
+
+   void destroyTransform(S32 handle)
+   {
+      const S32 slot = getSlot(handle);
+
+      // Orphaned children become roots.
+      if (sChildCounts[slot] > 0)
+      {
+         for (S32 n = 0; n < sParents.size(); ++n)
+         {
+            if (sParents[n] == slot)
+            {
+               sParents[n] = -1;
+               markDirty(n);
+            }
+         }
+      }
+
+      if (sParents[slot] >= 0)
+         sChildCounts[sParents[slot]]--;
+
+      if (sDirty[slot])
+         sDirtyCount--;
+
+      sParents[slot]       = -1;
+      sChildCounts[slot]   = 0;
+      sDirty[slot]         = 0;
+      sSlotHandles[slot]   = -1;
+      sCallbacks[slot]     = NULL;
+      sCallbackData[slot]  = NULL;
+
+      sHandleSlots[handle] = -1;
+      sFreeHandles.push_back(handle);
+
+      sOrderDirty = true;
+      sTransformCount--;
+   }
+
+   void setTransformParent(S32 handle, S32 parent)
+   {
+      const S32 slot = getSlot(handle);
+      const S32 parentSlot = (parent >= 0) ? getSlot(parent) : -1;
+      if (sParents[slot] == parentSlot)
+         return;
+
+      for (S32 check = parentSlot; check >= 0; check = sParents[check])
+      {
+         if (check == slot)
+         {
+            Con::errorf("Scene::setTransformParent - transform %d can't be parented to its own descendant.", handle);
+            return;
+         }
+      }
+
+      if (sParents[slot] >= 0)
+         sChildCounts[sParents[slot]]--;
+      if (parentSlot >= 0)
+         sChildCounts[parentSlot]++;
+
+      sParents[slot] = parentSlot;
+      markDirty(slot);
+      sOrderDirty = true;
+   }
+
+   S32 getTransformParent(S32 handle)
+   {
+      const S32 parentSlot = sParents[getSlot(handle)];
+      return (parentSlot >= 0) ? sSlotHandles[parentSlot] : -1;
+   }
+
+   void setLocalTransform(S32 handle, const MatrixF& local)
+   {
+      const S32 slot = getSlot(handle);
+      if (dMemcmp(&sLocal[slot], &local, sizeof(MatrixF)) == 0)
+         return;
+
+      sLocal[slot] = local;
+      markDirty(slot);
+   }
+
+   const MatrixF& getLocalTransform(S32 handle)
+   {
+      return sLocal[getSlot(handle)];
+   }
+
+   const MatrixF& getWorldTransform(S32 handle)
+   {
+      const S32 slot = getSlot(handle);
+      if (sDirtyCount == 0)
+         return sWorld[slot];
+
+      // Find the topmost dirty transform above this one and recompute the
+      // chain below it. Dirty flags are left for updateTransforms() since
+      // other descendants of that transform are still stale.
+      S32 chain[64];
+      S32 chainLength = 0;
+      S32 topDirty = -1;
+      for (S32 check = slot; check >= 0; check = sParents[check])
+      {
+         AssertFatal(chainLength < 64, "Scene::getWorldTransform - transform hierarchy is too deep.");
+         if (sDirty[check])
+            topDirty = chainLength;
+         chain[chainLength++] = check;
+      }
+
+      for (S32 n = topDirty; n >= 0; --n)
+         computeWorld(chain[n]);
+
+      return sWorld[slot];
+   }
+
+   bool isTransformDirty(S32 handle)
+   {
+      for (S32 check = getSlot(handle); check >= 0; check = sParents[check])
+      {
+         if (sDirty[check])
+            return true;
+      }
+
+      return false;
+   }
+
+   void clearTransformDirty(S32 handle)
+   {
+      const S32 slot = getSlot(handle);
+      if (!sDirty[slot])
+         return;
+
+      getWorldTransform(handle);
+      sDirty[slot] = 0;
+      sDirtyCount--;
+   }
+
+   U32 getTransformCount()
+   {
+      return sTransformCount;
+   }
+
+   // ----------------------------------------
+   //   Update
+   // ----------------------------------------
+
+   struct TransformLevelJob
+   {
+      U32            start;
+      volatile S32   changed;
+   };
+
+   // Runs on the job system. Every parent is in an earlier level, which is
+   // finished before this one starts.
+   static void updateLevelJob(void* data, U32 first, U32 count)
+   {
+      TransformLevelJob* level = (TransformLevelJob*)data;
+      const U32 begin = level->start + first;
+      const U32 end = begin + count;
+
+      S32 changed = 0;
+      for (U32 slot = begin; slot < end; ++slot)
+      {
+         const S32 parent = sParents[slot];
+         if (!sDirty[slot] && (parent < 0 || !sChanged[parent]))
+         {
+            sChanged[slot] = 0;
+            continue;
+         }
+
+         computeWorld(slot);
+         sDirty[slot] = 0;
+         sChanged[slot] = 1;
+         changed++;
+      }
+
+      if (changed > 0)
+         JobSystem::atomicAdd(&level->changed, changed);
+   }
+
+   U32 updateTransforms()
+   {
+      PROFILE_SCOPE(Scene_UpdateTransforms);
+
+      sTransformsUpdated = 0;
+      if (sDirtyCount == 0 && !sOrderDirty)
+         return 0;
+
+      if (sOrderDirty)
+         rebuildOrder();
+
+      for (S32 n = 0; n < sLevelStarts.size() - 1; ++n)
+      {
+         TransformLevelJob level;
+         level.start    = sLevelStarts[n];
+         level.changed  = 0;
+
+         JobCounter counter;
+         JobSystem::parallelFor(sLevelStarts[n + 1] - level.start, TransformGrainSize, &updateLevelJob, &level, &counter);
+         JobSystem::wait(counter);
+
+         sTransformsUpdated += level.changed;
+      }
+      sDirtyCount = 0;
+
+      // Publish.
+      for (S32 n = 0; n < sParents.size(); ++n)
+      {
+         if (sChanged[n] && sCallbacks[n] != NULL)
+            sCallbacks[n](sCallbackData[n], sWorld[n]);
+      }
+
+      return sTransformsUpdated;
+   }
+}
@@ -0,0 +1,78 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2015 Andrew Mac
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//-----------------------------------------------------------------------------
+
+
+#ifndef _SCENE_TRANSFORM_SYSTEM_H_
+#define _SCENE_TRANSFORM_SYSTEM_H_
+
+#ifndef _MMATH_H_
+#include "math/mMath.h"
+#endif
+
+#ifndef _VECTOR_H_
+#include "collection/vector.h"
+#endif
+
+namespace Scene
+{
+   // ----------------------------------------
+   //   Transform System
+   // ----------------------------------------
+   //
+   // Parent, local and world matrices of every scene transform, packed in
+   // arrays sorted by depth so parents always come before their children.
+   // Setting a local matrix only marks the transform dirty. Once per frame
+   // updateTransforms() recomputes every dirty transform and its descendants
+   // one level at a time, each level split across the job system, then calls
+   // the change callback of every transform whose world matrix moved.
+   //
+   // Handles stay valid until destroyed, slots move whenever the hierarchy
+   // changes. Main thread only.
+
+   typedef void (*TransformCallback)(void* data, const MatrixF& world);
+
+   void              initTransforms();
+   void              destroyTransforms();
+
+   S32               createTransform(S32 parent = -1, TransformCallback callback = NULL, void* data = NULL);
+   void              destroyTransform(S32 handle);
+   void              setTransformParent(S32 handle, S32 parent);
+   S32               getTransformParent(S32 handle);
+
+   void              setLocalTransform(S32 handle, const MatrixF& local);
+   const MatrixF&    getLocalTransform(S32 handle);
+
+   // World matrices are resolved on demand when the transform or one of its
+   // parents is dirty, so reads between updates are never stale.
+   const MatrixF&    getWorldTransform(S32 handle);
+   bool              isTransformDirty(S32 handle);
+
+   // Resolves handle and takes it out of the next update, for callers that
+   // already brought everything below it up to date themselves.
+   void              clearTransformDirty(S32 handle);
+
+   // Returns how many world matrices changed.
+   U32               updateTransforms();
+   U32               getTransformCount();
+}
+
+#endif
@@ -22,67 +22,378 @@
 
 #include "SimObjectList.h"
 #include "collection/findIterator.h"
+#include "collection/hashTable.h"
 #include "simObject.h"
+#include <stdint.h>
+
+//-----------------------------------------------------------------------------
+
+SimObjectList::SimObjectList() :
+   mHead(0),
+   mHoles(0),
+   mIndex(NULL),
+   mIndexMask(0),
+   mNameIndex(NULL),
+   mNameIndexVersion(0)
+{
+}
+
+//-----------------------------------------------------------------------------
+
+SimObjectList::~SimObjectList()
+{
+   if(mIndex)
+      dFree(mIndex);
+
+   delete mNameIndex;
+}
+
+//-----------------------------------------------------------------------------
+
+inline U32 SimObjectList::hashObject(SimObject* obj) const
+{
+   // Objects are allocated on similar boundaries, so mix the address.
+   return (U32)(((U64)(uintptr_t)obj * 0x9E3779B97F4A7C15ULL) >> 32) & mIndexMask;
+}
+
+//-----------------------------------------------------------------------------
+
+S32 SimObjectList::findSlot(SimObject* obj) const
+{
+   if(!mIndex)
+   {
+      for(U32 slot = mHead; slot < (U32)mList.size(); slot++)
+      {
+         if(mList[slot] == obj)
+            return slot;
+      }
+
+      return -1;
+   }
+
+   for(U32 i = hashObject(obj); mIndex[i].object; i = (i + 1) & mIndexMask)
+   {
+      if(mIndex[i].object == obj)
+         return mIndex[i].slot;
+   }
+
+   return -1;
+}
+
+//-----------------------------------------------------------------------------
+
+void SimObjectList::indexInsert(SimObject* obj, U32 slot)
+{
+   if(!mIndex)
+   {
+      if(size() > LinearLimit)
+         rebuildIndex();
+      return;
+   }
+
+   // Keep the index at most half full.
+   if((U32)size() * 2 > mIndexMask + 1)
+   {
+      rebuildIndex();
+      return;
+   }
+
+   U32 i = hashObject(obj);
+   while(mIndex[i].object)
+      i = (i + 1) & mIndexMask;
+
+   mIndex[i].object = obj;
+   mIndex[i].slot = slot;
+}
+
+//-----------------------------------------------------------------------------
+
+void SimObjectList::indexRemove(SimObject* obj)
+{
+   if(!mIndex)
+      return;
+
+   U32 i = hashObject(obj);
+   while(mIndex[i].object != obj)
+   {
+      AssertFatal(mIndex[i].object != NULL, "SimObjectList::indexRemove() - Object is not indexed.");
+      i = (i + 1) & mIndexMask;
+   }
+
+   // Shift back any following entries that probed past this one, so that
+   // lookups never need tombstones.
+   for(U32 next = (i + 1) & mIndexMask; mIndex[next].object; next = (next + 1) & mIndexMask)
+   {
+      const U32 home = hashObject(mIndex[next].object);
+      if(((next - home) & mIndexMask) >= ((next - i) & mIndexMask))
+      {
+         mIndex[i] = mIndex[next];
+         i = next;
+      }
+   }
+
+   mIndex[i].object = NULL;
+}
+
+//-----------------------------------------------------------------------------
+
+void SimObjectList::rebuildIndex()
+{
+   const U32 count = (U32)size();
+
+   if(count <= LinearLimit)
+   {
+      if(mIndex)
+      {
+         dFree(mIndex);
+         mIndex = NULL;
+         mIndexMask = 0;
+      }
+      return;
+   }
+
+   U32 indexSize = MinIndexSize;
+   while(indexSize < count * 4)
+      indexSize <<= 1;
+
+   if(indexSize != mIndexMask + 1 || !mIndex)
+   {
+      if(mIndex)
+         dFree(mIndex);
+
+      mIndex = (IndexEntry*)dMalloc(indexSize * sizeof(IndexEntry));
+      mIndexMask = indexSize - 1;
+   }
+
+   dMemset(mIndex, 0, indexSize * sizeof(IndexEntry));
+
+   for(U32 slot = mHead; slot < (U32)mList.size(); slot++)
+   {
+      SimObject* obj = mList[slot];
+      if(!obj)
+         continue;
+
+      U32 i = hashObject(obj);
+      while(mIndex[i].object)
+         i = (i + 1) & mIndexMask;
+
+      mIndex[i].object = obj;
+      mIndex[i].slot = slot;
+   }
+}
+
+//-----------------------------------------------------------------------------
+
+void SimObjectList::compact()
+{
+   U32 count = 0;
+   for(U32 slot = mHead; slot < (U32)mList.size(); slot++)
+   {
+      if(mList[slot])
+         mList[count++] = mList[slot];
+   }
+
+   mList.setSize(count);
+   mHead = 0;
+   mHoles = 0;
+
+   rebuildIndex();
+}
+
+//-----------------------------------------------------------------------------
+
+void SimObjectList::insertSlot(U32 slot, bool indexed)
+{
+   SimObject* obj = mList[slot];
+
+   if(!indexed)
+      indexInsert(obj, slot);
+
+   if(mNameIndex && mNameIndexVersion == SimObject::getInternalNameChangeCount() && obj->getInternalName())
+      mNameIndex->insertEqual(obj->getInternalName(), obj);
+}
+
+//-----------------------------------------------------------------------------
+
+void SimObjectList::removeSlot(U32 slot)
+{
+   SimObject* obj = mList[slot];
+
+   indexRemove(obj);
+
+   if(mNameIndex && mNameIndexVersion == SimObject::getInternalNameChangeCount() && obj->getInternalName())
+   {
+      for(NameIndex::iterator itr = mNameIndex->find(obj->getInternalName()); itr != mNameIndex->end() && itr->key == obj->getInternalName(); ++itr)
+      {
+         if(itr->value == obj)
+         {
+            mNameIndex->erase(itr);
+            break;
+         }
+      }
+   }
+
+   mList[slot] = NULL;
+   mHoles++;
+
+   // Holes at either end are trimmed straight away.
+   while(mHead < (U32)mList.size() && !mList[mHead])
+   {
+      mHead++;
+      mHoles--;
+   }
+
+   while((U32)mList.size() > mHead && !mList.last())
+   {
+      mList.decrement();
+      mHoles--;
+   }
+
+   if(mHead == (U32)mList.size())
+   {
+      mList.clear();
+      mHead = 0;
+   }
+
+   // Shrink the index along with the list.
+   if(mIndex && (U32)size() * 16 < mIndexMask + 1)
+      rebuildIndex();
+}
+
+//-----------------------------------------------------------------------------
+
+void SimObjectList::push_back(SimObject* obj)
+{
+   // Reclaim the slots freed from the front before growing.
+   if(mHead && mHead * 2 >= (U32)mList.size())
+      compact();
+
+   mList.push_back(obj);
+   insertSlot(mList.size() - 1);
+}
+
+//-----------------------------------------------------------------------------
+
+void SimObjectList::push_front(SimObject* obj)
+{
+   if(mHead)
+   {
+      mList[--mHead] = obj;
+      insertSlot(mHead);
+      return;
+   }
+
+   pack();
+   mList.push_front(obj);
+   rebuildIndex();
+   insertSlot(0, true);
+}
+
+//-----------------------------------------------------------------------------
+
+void SimObjectList::insert(iterator itr, SimObject* obj)
+{
+   pack();
+   const U32 slot = (U32)(itr - mList.begin());
+   mList.insert(itr, obj);
+   rebuildIndex();
+   insertSlot(slot, true);
+}
+
+//-----------------------------------------------------------------------------
+
+void SimObjectList::erase(iterator itr)
+{
+   removeSlot((U32)(itr - mList.begin()));
+}
+
+//-----------------------------------------------------------------------------
+
+void SimObjectList::decrement()
+{
+   removeSlot(mList.size() - 1);
+}
+
+//-----------------------------------------------------------------------------
+
+void SimObjectList::clear()
+{
+   mList.clear();
+   mHead = 0;
+   mHoles = 0;
+   rebuildIndex();
+
+   if(mNameIndex)
+      mNameIndex->clear();
+}
 
 //-----------------------------------------------------------------------------
 
 void SimObjectList::pushBack(SimObject* obj)
 {
-   if (find(begin(),end(),obj) == end())
+   if(!contains(obj))
       push_back(obj);
-}	
+}
 
 //-----------------------------------------------------------------------------
 
 void SimObjectList::pushBackForce(SimObject* obj)
 {
-   iterator itr = find(begin(),end(),obj);
-   if (itr == end()) 
-   {
-      push_back(obj);
-   }
-   else 
+   const S32 slot = findSlot(obj);
+   if(slot >= 0)
    {
-      // Move to the back...
-      //
-      SimObject* pBack = *itr;
-      removeStable(pBack);
-      push_back(pBack);
+      // Already at the back?
+      if(slot == mList.size() - 1)
+         return;
+
+      removeSlot(slot);
    }
-}	
+
+   push_back(obj);
+}
 
 //-----------------------------------------------------------------------------
 
 void SimObjectList::pushFront(SimObject* obj)
 {
-   if (find(begin(),end(),obj) == end())
+   if(!contains(obj))
       push_front(obj);
-}	
+}
 
 //-----------------------------------------------------------------------------
 
 void SimObjectList::remove(SimObject* obj)
 {
-   iterator ptr = find(begin(),end(),obj);
-   if (ptr != end()) 
-      erase(ptr);
+   const S32 slot = findSlot(obj);
+   if(slot >= 0)
+      removeSlot(slot);
+}
+
+//-----------------------------------------------------------------------------
+
+SimObjectList::iterator SimObjectList::find(SimObject* obj)
+{
+   pack();
+
+   const S32 slot = findSlot(obj);
+   return slot >= 0 ? mList.begin() + slot : mList.end();
 }
 
 //-----------------------------------------------------------------------------
 
-void SimObjectList::removeStable(SimObject* obj)
+void SimObjectList::sort(compare_func compare)
 {
-   iterator ptr = find(begin(),end(),obj);
-   if (ptr != end()) 
-      erase(ptr);
+   pack();
+   dQsort(begin(), size(), sizeof(value_type), compare);
+   rebuildIndex();
 }
 
 //-----------------------------------------------------------------------------
 
 void SimObjectList::sortId()
 {
-   dQsort(address(),size(),sizeof(value_type),compareId);
-}	
+   sort(compareId);
+}
 
 //-----------------------------------------------------------------------------
 
@@ -91,3 +402,72 @@ S32 QSORT_CALLBACK SimObjectList::compareId(const void* a,const void* b)
    return (*reinterpret_cast<const SimObject* const*>(a))->getId() -
       (*reinterpret_cast<const SimObject* const*>(b))->getId();
 }
+
+//-----------------------------------------------------------------------------
+
+void SimObjectList::setInternalNameIndex(bool enabled)
+{
+   if(enabled == (mNameIndex != NULL))
+      return;
+
+   if(!enabled)
+   {
+      delete mNameIndex;
+      mNameIndex = NULL;
+      return;
+   }
+
+   mNameIndex = new NameIndex;
+   rebuildNameIndex();
+}
+
+//-----------------------------------------------------------------------------
+
+void SimObjectList::rebuildNameIndex()
+{
+   mNameIndex->clear();
+
+   for(U32 slot = mHead; slot < (U32)mList.size(); slot++)
+   {
+      SimObject* obj = mList[slot];
+      if(obj && obj->getInternalName())
+         mNameIndex->insertEqual(obj->getInternalName(), obj);
+   }
+
+   mNameIndexVersion = SimObject::getInternalNameChangeCount();
+}
+
+//-----------------------------------------------------------------------------
+
+SimObject* SimObjectList::findByInternalName(StringTableEntry internalName)
+{
+   if(!mNameIndex)
+   {
+      for(U32 slot = mHead; slot < (U32)mList.size(); slot++)
+      {
+         if(mList[slot] && mList[slot]->getInternalName() == internalName)
+            return mList[slot];
+      }
+
+      return NULL;
+   }
+
+   // Any rename invalidates the index, as members don't know their sets.
+   if(mNameIndexVersion != SimObject::getInternalNameChangeCount())
+      rebuildNameIndex();
+
+   // Members sharing a name are resolved by their order in the list.
+   SimObject* found = NULL;
+   S32 foundSlot = -1;
+   for(NameIndex::iterator itr = mNameIndex->find(internalName); itr != mNameIndex->end() && itr->key == internalName; ++itr)
+   {
+      const S32 slot = findSlot(itr->value);
+      if(!found || slot < foundSlot)
+      {
+         found = itr->value;
+         foundSlot = slot;
+      }
+   }
+
+   return found;
+}
@@ -30,26 +30,130 @@
 //-----------------------------------------------------------------------------
 
 class SimObject;
+template<typename Key, typename Value> class HashTable;
 
 //-----------------------------------------------------------------------------
 
+/// An ordered list of SimObjects with constant time membership tests and removal.
+///
+/// Members are kept in an array so that iteration and indexing stay as cheap as a
+/// Vector, while an open addressed index maps each member to its slot once the
+/// list outgrows a short linear search. Removing a member leaves a hole which is
+/// packed away the next time the list is read, so tearing down a large set is
+/// linear and the order of the remaining members never changes. Removals from
+/// the front or back of the list don't leave holes at all.
+///
+/// The list can also keep an index of member internal names, see
+/// setInternalNameIndex().
 class DLL_PUBLIC SimObjectList;
-class SimObjectList : public VectorPtr<SimObject*>
+class SimObjectList
 {
+public:
+   typedef SimObject*         value_type;
+   typedef value_type*        iterator;
+   typedef const value_type*  const_iterator;
+   typedef S32 (QSORT_CALLBACK *compare_func)(const void* a, const void* b);
+
+private:
+   enum
+   {
+      /// Lists up to this size are searched rather than indexed.
+      LinearLimit = 16,
+      MinIndexSize = 64,
+   };
+
+   struct IndexEntry
+   {
+      SimObject* object;
+      U32 slot;
+   };
+
+   typedef HashTable<StringTableEntry, SimObject*> NameIndex;
+
+   VectorPtr<SimObject*> mList;  ///< Members from mHead on, with NULL holes left by removals.
+   U32 mHead;
+   U32 mHoles;
+
+   IndexEntry* mIndex;           ///< Member to slot in mList, or NULL while the list is short.
+   U32 mIndexMask;
+
+   NameIndex* mNameIndex;        ///< Internal name to member, if enabled.
+   U32 mNameIndexVersion;        ///< SimObject internal name changes the name index reflects.
+
+   SimObjectList(const SimObjectList&);
+   SimObjectList& operator=(const SimObjectList&);
+
    static S32 QSORT_CALLBACK compareId(const void* a,const void* b);
 
+   inline U32 hashObject(SimObject* obj) const;
+   S32 findSlot(SimObject* obj) const;
+   void indexInsert(SimObject* obj, U32 slot);
+   void indexRemove(SimObject* obj);
+   void rebuildIndex();
+   void rebuildNameIndex();
+
+   void insertSlot(U32 slot, bool indexed = false);
+   void removeSlot(U32 slot);
+   void compact();
+
+   /// Pack away holes before the list is read by position.
+   inline void pack() const { if(mHoles) const_cast<SimObjectList*>(this)->compact(); }
+
 public:
+   SimObjectList();
+   ~SimObjectList();
+
+#ifdef TORQUE_DEBUG
+   void setFileAssociation(const char* file, const U32 line) { mList.setFileAssociation(file, line); }
+#endif
+
+   /// @name Vector Interface
+   /// @{
+
+   S32 size() const { return mList.size() - mHead - mHoles; }
+   bool empty() const { return size() == 0; }
+
+   iterator begin() { pack(); return mList.begin() + mHead; }
+   iterator end() { pack(); return mList.end(); }
+   const_iterator begin() const { pack(); return mList.begin() + mHead; }
+   const_iterator end() const { pack(); return mList.end(); }
+
+   SimObject* operator[](U32 index) const { pack(); return mList[mHead + index]; }
+   SimObject* front() const { pack(); return mList[mHead]; }
+   SimObject* first() const { pack(); return mList[mHead]; }
+   SimObject* last() const { return mList.last(); }
+
+   void push_back(SimObject*);
+   void push_front(SimObject*);
+   void insert(iterator, SimObject*);
+   void erase(iterator);
+   void decrement();
+   void clear();
+
+   /// @}
+
    void pushBack(SimObject*);       ///< Add the SimObject* to the end of the list, unless it's already in the list.
    void pushBackForce(SimObject*);  ///< Add the SimObject* to the end of the list, moving it there if it's already present in the list.
    void pushFront(SimObject*);      ///< Add the SimObject* to the start of the list.
-   void remove(SimObject*);         ///< Remove the SimObject* from the list; may disrupt order of the list.
+   void remove(SimObject*);         ///< Remove the SimObject* from the list.
 
    inline SimObject* at(S32 index) const {  if(index >= 0 && index < size()) return (*this)[index]; return NULL; }
 
    /// Remove the SimObject* from the list; guaranteed to preserve list order.
-   void removeStable(SimObject* pObject);
+   void removeStable(SimObject* pObject) { remove(pObject); }
 
+   bool contains(SimObject* obj) const { return findSlot(obj) >= 0; }
+   iterator find(SimObject* obj);
+
+   void sort(compare_func compare);
    void sortId();                   ///< Sort the list by object ID.
+
+   /// Keep an index of member internal names for findByInternalName().
+   void setInternalNameIndex(bool enabled);
+   bool getInternalNameIndex() const { return mNameIndex != NULL; }
+
+   /// The first member with the given internal name, or NULL.
+   SimObject* findByInternalName(StringTableEntry internalName);
 };
 
-#endif // _SIM_OBJECT_LIST_H_
\ No newline at end of file
+#endif // _SIM_OBJECT_LIST_H_
@@ -162,6 +162,9 @@ namespace Sim
 
    SimObject* findObject(SimObjectId);
    SimObject* findObject(const char* name);
+
+   /// Print the load factor and probe lengths of the object dictionaries.
+   void dumpDictionaryStatistics();
    template<class T> inline bool findObject(SimObjectId id,T*&t)
    {
       t = dynamic_cast<T*>(findObject(id));
@@ -217,6 +217,18 @@ ConsoleFunctionWithDocs(isObject, ConsoleBool, 2, 2, ( handle ) )
       return (Sim::findObject(argv[1]) != NULL);
 }
 
+/*! print the size, load factor and probe lengths of the object id and name dictionaries.
+
+    @return No return value.
+
+	@boundto
+	Sim::dumpDictionaryStatistics
+*/
+ConsoleFunctionWithDocs(dumpSimDictionaryStats, ConsoleVoid, 1, 1, ())
+{
+   Sim::dumpDictionaryStatistics();
+}
+
 //-----------------------------------------------------------------------------
 
 /*! @} */
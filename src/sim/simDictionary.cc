@@ -23,296 +23,398 @@
 #include "sim/simDictionary.h"
 #include "sim/simBase.h"
 
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
 //----------------------------------------------------------------------------
 //----------------------------------------------------------------------------
-extern U32 HashPointer(StringTableEntry e);
 
-SimNameDictionary::SimNameDictionary()
+// Marks a removed slot. Lookups skip it, inserts reuse it.
+static SimObject * const TombstoneObject = (SimObject *)1;
+
+// Slots are published with a release store of the object after its key, and
+// read with an acquire load of the object before its key.
+#if defined(_MSC_VER)
+template<class T> static inline T loadAcquire(const volatile T &value)
+{
+   T ret = value;
+   _ReadWriteBarrier();
+   return ret;
+}
+
+template<class T> static inline void storeRelease(volatile T &value, T newValue)
 {
-   hashTable = NULL;
+   _ReadWriteBarrier();
+   value = newValue;
+}
+#else
+template<class T> static inline T loadAcquire(const volatile T &value)
+{
+   return __atomic_load_n(&value, __ATOMIC_ACQUIRE);
+}
+
+template<class T> static inline void storeRelease(volatile T &value, T newValue)
+{
+   __atomic_store_n(&value, newValue, __ATOMIC_RELEASE);
+}
+#endif
+
+//----------------------------------------------------------------------------
+
+SimObjectHashTable::SimObjectHashTable()
+{
+   mTable = NULL;
+   mRetired = NULL;
+   mEntryCount = 0;
+   mTombstoneCount = 0;
    mutex = Mutex::createMutex();
 }
 
-SimNameDictionary::~SimNameDictionary()
+SimObjectHashTable::~SimObjectHashTable()
 {
-   delete[] hashTable;
+   dFree(mTable);
+
+   while(mRetired)
+   {
+      Table *table = mRetired;
+      mRetired = table->nextRetired;
+      dFree(table);
+   }
+
    Mutex::destroyMutex(mutex);
 }
 
-void SimNameDictionary::insert(SimObject* obj)
+inline U32 SimObjectHashTable::hashKey(const Table *table, Key key)
 {
-   if(!obj->objectName)
-      return;
+   // Fibonacci hashing spreads both sequential ids and string table
+   // pointers, which share their low bits, across the table.
+   return (U32)(((U64)key * 0x9E3779B97F4A7C15ULL) >> table->shift);
+}
 
-   Mutex::lockMutex(mutex);
-   
-   if(!hashTable)
+SimObjectHashTable::Table *SimObjectHashTable::createTable(U32 size)
+{
+   Table *table = (Table *) dMalloc(sizeof(Table) + (size - 1) * sizeof(Slot));
+   table->mask = size - 1;
+   table->shift = 64;
+   for(U32 i = size; i > 1; i >>= 1)
+      table->shift--;
+   table->nextRetired = NULL;
+
+   for(U32 i = 0; i < size; i++)
    {
-      hashTable = new SimObject *[DefaultTableSize];
-      hashTableSize = DefaultTableSize;
-      hashEntryCount = 0;
-      S32 i;
-      for(i = 0; i < hashTableSize; i++)
-         hashTable[i] = NULL;
+      table->slots[i].key = 0;
+      table->slots[i].object = NULL;
    }
-   S32 idx = HashPointer(obj->objectName) % hashTableSize;
-   obj->nextNameObject = hashTable[idx];
-   hashTable[idx] = obj;
-   hashEntryCount++;
-   if(hashEntryCount > hashTableSize)
+
+   return table;
+}
+
+void SimObjectHashTable::grow()
+{
+   // Tables never shrink, so the retired ones add up to less than this one.
+   U32 size = mTable ? (mTable->mask + 1) * 2 : MinTableSize;
+   while(size < (mEntryCount + 1) * 2)
+      size <<= 1;
+
+   Table *table = createTable(size);
+   Table *oldTable = mTable;
+
+   if(oldTable)
    {
-      // resize the hash table
-      S32 i;
-      SimObject *head = NULL, *walk, *temp;
-   	for(i = 0; i < hashTableSize; i++) {
-   		walk = hashTable[i];
-         while(walk)
+      // Start after an empty slot so that every probe run is copied from its
+      // head, keeping objects that share a key newest first.
+      U32 start = 0;
+      while(oldTable->slots[start].object != NULL)
+         start++;
+
+      for(U32 i = 1; i <= oldTable->mask + 1; i++)
+      {
+         const Slot &oldSlot = oldTable->slots[(start + i) & oldTable->mask];
+         if(oldSlot.object == NULL || oldSlot.object == TombstoneObject)
+            continue;
+
+         U32 slot = hashKey(table, oldSlot.key);
+         while(table->slots[slot].object != NULL)
+            slot = (slot + 1) & table->mask;
+
+         table->slots[slot].key = oldSlot.key;
+         table->slots[slot].object = oldSlot.object;
+      }
+
+      // Readers may still be probing the old table, so it's kept until
+      // the dictionary goes away.
+      oldTable->nextRetired = mRetired;
+      mRetired = oldTable;
+   }
+
+   storeRelease(mTable, table);
+   mTombstoneCount = 0;
+}
+
+void SimObjectHashTable::purgeTombstones()
+{
+   // A tombstone can be emptied when no live entry past it in the same run
+   // probed through it. Walk each run backwards from the empty slot that
+   // ends it, tracking how far back the entries seen so far reach.
+   Table *table = mTable;
+   U32 end = 0;
+   while(table->slots[end].object != NULL)
+      end++;
+
+   S32 reach = -1;
+   for(U32 i = 1; i <= table->mask + 1; i++)
+   {
+      const U32 slot = (end - i) & table->mask;
+      Slot &entry = table->slots[slot];
+
+      if(entry.object == NULL)
+         reach = -1;
+      else if(entry.object == TombstoneObject)
+      {
+         if(reach < 0)
          {
-            temp = walk->nextNameObject;
-            walk->nextNameObject = head;
-            head = walk;
-            walk = temp;
+            storeRelease(entry.object, (SimObject *)NULL);
+            mTombstoneCount--;
          }
-   	}
-      delete[] hashTable;
-      hashTableSize = hashTableSize * 2 + 1;
-      hashTable = new SimObject *[hashTableSize];
-
-      for(i = 0; i < hashTableSize;i++)
-         hashTable[i] = NULL;
-      while(head)
+      }
+      else
       {
-         temp = head->nextNameObject;
-         idx = HashPointer(head->objectName) % hashTableSize;
-         head->nextNameObject = hashTable[idx];
-         hashTable[idx] = head;
-         head = temp;
+         const S32 distance = (S32)((slot - hashKey(table, entry.key)) & table->mask);
+         if(distance > reach)
+            reach = distance;
       }
+
+      if(reach >= 0)
+         reach--;
    }
-   Mutex::unlockMutex(mutex);
 }
 
-SimObject* SimNameDictionary::find(StringTableEntry name)
+//----------------------------------------------------------------------------
+
+void SimObjectHashTable::insert(Key key, SimObject *obj)
 {
-   // NULL is a valid lookup - it will always return NULL
-   if(!hashTable)
-      return NULL;
-      
    Mutex::lockMutex(mutex);
 
-   S32 idx = HashPointer(name) % hashTableSize;
-   SimObject *walk = hashTable[idx];
-   while(walk)
+   // Keep live entries and tombstones within three quarters of the table,
+   // emptying what tombstones we can before growing.
+   if(mTable && (mEntryCount + mTombstoneCount + 1) * 4 > (mTable->mask + 1) * 3 && mTombstoneCount)
+      purgeTombstones();
+
+   if(!mTable || (mEntryCount + mTombstoneCount + 1) * 4 > (mTable->mask + 1) * 3)
+      grow();
+
+   Table *table = mTable;
+   SimObject *carry = obj;
+   for(U32 slot = hashKey(table, key); ; slot = (slot + 1) & table->mask)
    {
-      if(walk->objectName == name)
+      Slot &entry = table->slots[slot];
+      SimObject *current = entry.object;
+
+      if(current == NULL || current == TombstoneObject)
       {
-         Mutex::unlockMutex(mutex);
-         return walk;
+         if(current == TombstoneObject)
+            mTombstoneCount--;
+
+         entry.key = key;
+         storeRelease(entry.object, carry);
+         break;
+      }
+
+      // The newest object for a key comes first along its probe sequence,
+      // so the one it displaces moves on to the next free slot.
+      if(entry.key == key)
+      {
+         storeRelease(entry.object, carry);
+         carry = current;
       }
-      walk = walk->nextNameObject;
    }
 
+   mEntryCount++;
+
    Mutex::unlockMutex(mutex);
-   return NULL;
 }
 
-void SimNameDictionary::remove(SimObject* obj)
+void SimObjectHashTable::remove(Key key, SimObject *obj)
 {
-   if(!obj->objectName)
-      return;
-
    Mutex::lockMutex(mutex);
 
-   SimObject **walk = &hashTable[HashPointer(obj->objectName) % hashTableSize];
-   while(*walk)
+   Table *table = mTable;
+   if(table)
    {
-      if(*walk == obj)
+      for(U32 slot = hashKey(table, key); ; slot = (slot + 1) & table->mask)
       {
-         *walk = obj->nextNameObject;
-			obj->nextNameObject = (SimObject*)-1;
-         hashEntryCount--;
+         Slot &entry = table->slots[slot];
+         if(entry.object == NULL)
+            break;
 
-         Mutex::unlockMutex(mutex);
-         return;
+         if(entry.object == obj && entry.key == key)
+         {
+            storeRelease(entry.object, TombstoneObject);
+            mEntryCount--;
+            mTombstoneCount++;
+            break;
+         }
       }
-      walk = &((*walk)->nextNameObject);
    }
 
    Mutex::unlockMutex(mutex);
-}	
-
-//----------------------------------------------------------------------------
-
-SimManagerNameDictionary::SimManagerNameDictionary()
-{
-   hashTable = new SimObject *[DefaultTableSize];
-   hashTableSize = DefaultTableSize;
-   hashEntryCount = 0;
-   S32 i;
-   for(i = 0; i < hashTableSize; i++)
-      hashTable[i] = NULL;
-   mutex = Mutex::createMutex();
-}
-
-SimManagerNameDictionary::~SimManagerNameDictionary()
-{
-   delete[] hashTable;
-   Mutex::destroyMutex(mutex);
 }
 
-void SimManagerNameDictionary::insert(SimObject* obj)
+SimObject *SimObjectHashTable::find(Key key) const
 {
-   if(!obj->objectName)
-      return;
-
-   Mutex::lockMutex(mutex);
+   const Table *table = loadAcquire(mTable);
+   if(!table)
+      return NULL;
 
-   S32 idx = HashPointer(obj->objectName) % hashTableSize;
-   obj->nextManagerNameObject = hashTable[idx];
-   hashTable[idx] = obj;
-   hashEntryCount++;
-   if(hashEntryCount > hashTableSize)
+   for(U32 slot = hashKey(table, key); ; slot = (slot + 1) & table->mask)
    {
-      // resize the hash table
-      S32 i;
-      SimObject *head = NULL, *walk, *temp;
-   	for(i = 0; i < hashTableSize; i++) {
-   		walk = hashTable[i];
-         while(walk)
-         {
-            temp = walk->nextManagerNameObject;
-            walk->nextManagerNameObject = head;
-            head = walk;
-            walk = temp;
-         }
-   	}
-      delete[] hashTable;
-      hashTableSize = hashTableSize * 2 + 1;
-      hashTable = new SimObject *[hashTableSize];
-
-      for(i = 0; i < hashTableSize;i++)
-         hashTable[i] = NULL;
-      while(head)
+      const Slot &entry = table->slots[slot];
+      SimObject *obj = loadAcquire(entry.object);
+      if(obj == NULL)
+         return NULL;
+
+      if(obj != TombstoneObject && loadAcquire(entry.key) == key)
       {
-         temp = head->nextManagerNameObject;
-         idx = HashPointer(head->objectName) % hashTableSize;
-         head->nextManagerNameObject = hashTable[idx];
-         hashTable[idx] = head;
-         head = temp;
+         // The slot may have been reused between the two loads.
+         if(loadAcquire(entry.object) == obj)
+            return obj;
+
+         slot = (slot - 1) & table->mask;
       }
    }
-   
-   Mutex::unlockMutex(mutex);
 }
 
-SimObject* SimManagerNameDictionary::find(StringTableEntry name)
+bool SimObjectHashTable::contains(Key key, SimObject *obj) const
 {
-   // NULL is a valid lookup - it will always return NULL
+   const Table *table = loadAcquire(mTable);
+   if(!table)
+      return false;
+
+   for(U32 slot = hashKey(table, key); ; slot = (slot + 1) & table->mask)
+   {
+      const Slot &entry = table->slots[slot];
+      SimObject *current = loadAcquire(entry.object);
+      if(current == NULL)
+         return false;
 
+      if(current == obj && loadAcquire(entry.key) == key)
+         return true;
+   }
+}
+
+void SimObjectHashTable::getStatistics(Statistics &stats) const
+{
    Mutex::lockMutex(mutex);
 
-   S32 idx = HashPointer(name) % hashTableSize;
-   SimObject *walk = hashTable[idx];
-   while(walk)
+   stats.entryCount = mEntryCount;
+   stats.tombstoneCount = mTombstoneCount;
+   stats.tableSize = mTable ? mTable->mask + 1 : 0;
+   stats.loadFactor = stats.tableSize ? F32(mEntryCount + mTombstoneCount) / F32(stats.tableSize) : 0.0f;
+   stats.averageProbeLength = 0.0f;
+   stats.maxProbeLength = 0;
+
+   if(mTable && mEntryCount)
    {
-      if(walk->objectName == name)
+      U32 totalProbes = 0;
+      for(U32 i = 0; i <= mTable->mask; i++)
       {
-         Mutex::unlockMutex(mutex);
-         return walk;
+         const Slot &entry = mTable->slots[i];
+         if(entry.object == NULL || entry.object == TombstoneObject)
+            continue;
+
+         const U32 probes = ((i - hashKey(mTable, entry.key)) & mTable->mask) + 1;
+         totalProbes += probes;
+         stats.maxProbeLength = getMax(stats.maxProbeLength, probes);
       }
-      walk = walk->nextManagerNameObject;
+
+      stats.averageProbeLength = F32(totalProbes) / F32(mEntryCount);
    }
 
    Mutex::unlockMutex(mutex);
-   return NULL;
 }
 
-void SimManagerNameDictionary::remove(SimObject* obj)
+//----------------------------------------------------------------------------
+
+void SimNameDictionary::insert(SimObject* obj)
 {
    if(!obj->objectName)
       return;
 
-   Mutex::lockMutex(mutex);
+   mTable.insert((SimObjectHashTable::Key)obj->objectName, obj);
+}
 
-   SimObject **walk = &hashTable[HashPointer(obj->objectName) % hashTableSize];
-   while(*walk)
-   {
-      if(*walk == obj)
-      {
-         *walk = obj->nextManagerNameObject;
-			obj->nextManagerNameObject = (SimObject*)-1;
-         hashEntryCount--;
+SimObject* SimNameDictionary::find(StringTableEntry name)
+{
+   // NULL is a valid lookup - it will always return NULL
+   if(!name)
+      return NULL;
 
-         Mutex::unlockMutex(mutex);
-         return;
-      }
-      walk = &((*walk)->nextManagerNameObject);
-   }
+   return mTable.find((SimObjectHashTable::Key)name);
+}
 
-   Mutex::unlockMutex(mutex);
-}	
+void SimNameDictionary::remove(SimObject* obj)
+{
+   if(!obj->objectName)
+      return;
 
-//---------------------------------------------------------------------------
-//---------------------------------------------------------------------------
+   mTable.remove((SimObjectHashTable::Key)obj->objectName, obj);
+}
 
-SimIdDictionary::SimIdDictionary()
+bool SimNameDictionary::contains(SimObject* obj) const
 {
-   for(S32 i = 0; i < DefaultTableSize; i++)
-      table[i] = NULL;
-   mutex = Mutex::createMutex();
+   return obj->objectName && mTable.contains((SimObjectHashTable::Key)obj->objectName, obj);
 }
 
-SimIdDictionary::~SimIdDictionary()
+//----------------------------------------------------------------------------
+
+void SimManagerNameDictionary::insert(SimObject* obj)
 {
-   Mutex::destroyMutex(mutex);
+   if(!obj->objectName)
+      return;
+
+   mTable.insert((SimObjectHashTable::Key)obj->objectName, obj);
 }
 
-void SimIdDictionary::insert(SimObject* obj)
+SimObject* SimManagerNameDictionary::find(StringTableEntry name)
 {
-   Mutex::lockMutex(mutex);
+   // NULL is a valid lookup - it will always return NULL
+   if(!name)
+      return NULL;
 
-   S32 idx = obj->getId() & TableBitMask;
-   obj->nextIdObject = table[idx];
-   AssertFatal( obj->nextIdObject != obj, "SimIdDictionary::insert - Creating Infinite Loop linking to self!" );
-   table[idx] = obj;
+   return mTable.find((SimObjectHashTable::Key)name);
+}
 
-   Mutex::unlockMutex(mutex);
+void SimManagerNameDictionary::remove(SimObject* obj)
+{
+   if(!obj->objectName)
+      return;
+
+   mTable.remove((SimObjectHashTable::Key)obj->objectName, obj);
 }
 
-SimObject* SimIdDictionary::find(S32 id)
+bool SimManagerNameDictionary::contains(SimObject* obj) const
 {
-   Mutex::lockMutex(mutex);
+   return obj->objectName && mTable.contains((SimObjectHashTable::Key)obj->objectName, obj);
+}
 
-   S32 idx = id & TableBitMask;
-   SimObject *walk = table[idx];
-   while(walk)
-   {
-      if(walk->getId() == U32(id))
-      {
-         Mutex::unlockMutex(mutex);
-         return walk;
-      }
-      walk = walk->nextIdObject;
-   }
+//---------------------------------------------------------------------------
+//---------------------------------------------------------------------------
 
-   Mutex::unlockMutex(mutex);
+void SimIdDictionary::insert(SimObject* obj)
+{
+   mTable.insert((SimObjectHashTable::Key)obj->getId(), obj);
+}
 
-   return NULL;
+SimObject* SimIdDictionary::find(S32 id)
+{
+   return mTable.find((SimObjectHashTable::Key)U32(id));
 }
 
 void SimIdDictionary::remove(SimObject* obj)
 {
-   Mutex::lockMutex(mutex);
-
-   SimObject **walk = &table[obj->getId() & TableBitMask];
-   while(*walk && *walk != obj)
-      walk = &((*walk)->nextIdObject);
-   if(*walk)
-      *walk = obj->nextIdObject;
-
-   Mutex::unlockMutex(mutex);
+   mTable.remove((SimObjectHashTable::Key)obj->getId(), obj);
 }
 
 //---------------------------------------------------------------------------
 //---------------------------------------------------------------------------
-
@@ -29,6 +29,8 @@
 #include "string/stringTable.h"
 #endif
 
+#include <stdint.h>
+
 #ifndef _PLATFORMMUTEX_H_
 #include "platform/threads/mutex.h"
 #endif
@@ -36,52 +38,103 @@
 class SimObject;
 
 //----------------------------------------------------------------------------
-/// Map of names to SimObjects
+/// Open addressed map of keys to SimObjects, used by the dictionaries below.
 ///
-/// Provides fast lookup for name->object and
-/// for fast removal of an object given object*
-class SimNameDictionary
+/// Lookups don't lock. Writers are serialized by a mutex and publish each slot
+/// with a release store, so a reader racing a writer sees either the old or
+/// the new state of the slot. Removed entries leave a tombstone so nothing
+/// moves under a reader; tombstones no probe passes through are emptied in
+/// place. Growing publishes a new table, and the old one is kept until the
+/// dictionary is destroyed as a reader may still be using it.
+///
+/// Several objects may share a key. find() returns the most recently
+/// inserted one, which insert() keeps first along the probe sequence.
+class SimObjectHashTable
 {
+public:
+   /// Pointer wide, names are keyed by their string table entry.
+   typedef uintptr_t Key;
+
    enum
    {
-      DefaultTableSize = 29
+      MinTableSize = 64
+   };
+
+   struct Statistics
+   {
+      U32 entryCount;
+      U32 tombstoneCount;
+      U32 tableSize;
+      F32 loadFactor;            ///< Live and removed entries over the table size.
+      F32 averageProbeLength;    ///< Slots visited to find each live entry.
+      U32 maxProbeLength;
    };
 
-   SimObject **hashTable;  // hash the pointers of the names...
-   S32 hashTableSize;
-   S32 hashEntryCount;
+private:
+   struct Slot
+   {
+      volatile Key key;
+      SimObject * volatile object;
+   };
+
+   struct Table
+   {
+      U32 mask;
+      U32 shift;
+      Table *nextRetired;
+      Slot slots[1];
+   };
+
+   Table * volatile mTable;
+   Table *mRetired;
+   U32 mEntryCount;
+   U32 mTombstoneCount;
 
    void *mutex;
 
+   static inline U32 hashKey(const Table* table, Key key);
+   static Table* createTable(U32 size);
+   void grow();
+   void purgeTombstones();
+
+public:
+   void insert(Key key, SimObject* obj);
+   void remove(Key key, SimObject* obj);
+   SimObject* find(Key key) const;
+   bool contains(Key key, SimObject* obj) const;
+   void getStatistics(Statistics& stats) const;
+
+   SimObjectHashTable();
+   ~SimObjectHashTable();
+};
+
+//----------------------------------------------------------------------------
+/// Map of names to SimObjects
+///
+/// Provides fast lookup for name->object and
+/// for fast removal of an object given object*
+class SimNameDictionary
+{
+   SimObjectHashTable mTable;
+
 public:
    void insert(SimObject* obj);
    void remove(SimObject* obj);
    SimObject* find(StringTableEntry name);
-
-   SimNameDictionary();
-   ~SimNameDictionary();
+   bool contains(SimObject* obj) const;
+   void getStatistics(SimObjectHashTable::Statistics& stats) const { mTable.getStatistics(stats); }
 };
 
 class SimManagerNameDictionary
 {
-   enum
-   {
-      DefaultTableSize = 29
-   };
-
-   SimObject **hashTable;  // hash the pointers of the names...
-   S32 hashTableSize;
-   S32 hashEntryCount;
-
-   void *mutex;
+   SimObjectHashTable mTable;
 
 public:
    void insert(SimObject* obj);
    void remove(SimObject* obj);
    SimObject* find(StringTableEntry name);
-
-   SimManagerNameDictionary();
-   ~SimManagerNameDictionary();
+   bool contains(SimObject* obj) const;
+   void getStatistics(SimObjectHashTable::Statistics& stats) const { mTable.getStatistics(stats); }
 };
 
 //----------------------------------------------------------------------------
@@ -91,22 +144,13 @@ public:
 /// for fast removal of an object given object*
 class SimIdDictionary
 {
-   enum
-   {
-      DefaultTableSize = 4096,
-      TableBitMask = 4095
-   };
-   SimObject *table[DefaultTableSize];
-
-   void *mutex;
+   SimObjectHashTable mTable;
 
 public:
    void insert(SimObject* obj);
    void remove(SimObject* obj);
    SimObject* find(S32 id);
-
-   SimIdDictionary();
-   ~SimIdDictionary();
+   void getStatistics(SimObjectHashTable::Statistics& stats) const { mTable.getStatistics(stats); }
 };
 
 #endif //_SIMDICTIONARY_H_
@@ -21,105 +21,244 @@
 //-----------------------------------------------------------------------------
 
 #include "sim/simFieldDictionary.h"
-#include "memory/dataChunker.h"
 #include "console/consoleInternal.h"
 #include "memory/frameAllocator.h"
 
 //-----------------------------------------------------------------------------
 
-SimFieldDictionary::Entry *SimFieldDictionary::mFreeList = NULL;
+SimFieldDictionary::SimFieldDictionary()
+{
+   mEntries = NULL;
+   mEntryCount = 0;
+   mEntryCapacity = 0;
+
+   mIndex = NULL;
+   mIndexMask = 0;
+
+   mStrings = NULL;
+   mStringsUsed = 0;
+   mStringsSize = 0;
+   mStringsWasted = 0;
+
+   mVersion = 0;
+}
 
-static Chunker<SimFieldDictionary::Entry> fieldChunker;
+SimFieldDictionary::~SimFieldDictionary()
+{
+   dFree(mEntries);
+   dFree(mIndex);
+   dFree(mStrings);
+}
 
-SimFieldDictionary::Entry *SimFieldDictionary::allocEntry()
+U32 SimFieldDictionary::getMemoryUsage() const
 {
-   if(mFreeList)
+   U32 bytes = sizeof(SimFieldDictionary);
+   bytes += mEntryCapacity * sizeof(Entry);
+   if(mIndex)
+      bytes += (mIndexMask + 1) * sizeof(S32);
+   bytes += mStringsSize;
+   return bytes;
+}
+
+//-----------------------------------------------------------------------------
+
+S32 SimFieldDictionary::findEntry(StringTableEntry slotName) const
+{
+   if(!mIndex)
    {
-      Entry *ret = mFreeList;
-      mFreeList = ret->next;
-      return ret;
+      for(U32 i = 0; i < mEntryCount; i++)
+         if(mEntries[i].slotName == slotName)
+            return i;
+
+      return -1;
+   }
+
+   for(U32 slot = HashPointer(slotName) & mIndexMask; ; slot = (slot + 1) & mIndexMask)
+   {
+      const S32 index = mIndex[slot];
+      if(index < 0 || mEntries[index].slotName == slotName)
+         return index;
    }
-   else
-      return fieldChunker.alloc();
 }
 
-void SimFieldDictionary::freeEntry(SimFieldDictionary::Entry *ent)
+void SimFieldDictionary::rebuildIndex()
 {
-   ent->next = mFreeList;
-   mFreeList = ent;
+   if(mEntryCount <= LinearLimit)
+   {
+      dFree(mIndex);
+      mIndex = NULL;
+      mIndexMask = 0;
+      return;
+   }
+
+   // Keep the index at most half full.
+   U32 size = 16;
+   while(size < mEntryCount * 2)
+      size <<= 1;
+
+   if(!mIndex || mIndexMask + 1 != size)
+   {
+      dFree(mIndex);
+      mIndex = (S32 *) dMalloc(size * sizeof(S32));
+      mIndexMask = size - 1;
+   }
+
+   for(U32 i = 0; i < size; i++)
+      mIndex[i] = -1;
+
+   for(U32 i = 0; i < mEntryCount; i++)
+   {
+      U32 slot = HashPointer(mEntries[i].slotName) & mIndexMask;
+      while(mIndex[slot] >= 0)
+         slot = (slot + 1) & mIndexMask;
+      mIndex[slot] = i;
+   }
 }
 
-SimFieldDictionary::SimFieldDictionary()
+void SimFieldDictionary::removeEntry(U32 index)
 {
-   for(U32 i = 0; i < HashTableSize; i++)
-      mHashTable[i] = 0;
+   mStringsWasted += mEntries[index].valueSize;
 
-   mVersion = 0;
+   // Order has no meaning, so fill the hole with the last entry.
+   mEntryCount--;
+   if(index != mEntryCount)
+      mEntries[index] = mEntries[mEntryCount];
+
+   if(mEntryCount == 0)
+   {
+      mStringsUsed = 0;
+      mStringsWasted = 0;
+   }
+
+   if(mIndex)
+      rebuildIndex();
 }
 
-SimFieldDictionary::~SimFieldDictionary()
+//-----------------------------------------------------------------------------
+
+char *SimFieldDictionary::allocString(U32 size)
 {
-   for(U32 i = 0; i < HashTableSize; i++)
-   {
-      for(Entry *walk = mHashTable[i]; walk;)
-      {
-         Entry *temp = walk;
-         walk = temp->next;
+   if(mStringsUsed + size > mStringsSize)
+      compactStrings(size);
 
-         dFree(temp->value);
-         freeEntry(temp);
-      }
+   char *ret = mStrings + mStringsUsed;
+   mStringsUsed += size;
+   return ret;
+}
+
+void SimFieldDictionary::compactStrings(U32 extraSize)
+{
+   // Live values are packed to the front of a new arena, dropping the
+   // space held by removed values and by values that outgrew their slot.
+   U32 liveSize = 0;
+   for(U32 i = 0; i < mEntryCount; i++)
+      liveSize += mEntries[i].valueSize ? dStrlen(mEntries[i].value) + 1 : 0;
+
+   U32 size = MinStringsSize;
+   while(size < liveSize + extraSize)
+      size <<= 1;
+
+   char *strings = (char *) dMalloc(size);
+   U32 used = 0;
+   for(U32 i = 0; i < mEntryCount; i++)
+   {
+      // Skip the entry whose value is being replaced.
+      if(mEntries[i].valueSize == 0)
+         continue;
+
+      const U32 valueSize = dStrlen(mEntries[i].value) + 1;
+      dMemcpy(strings + used, mEntries[i].value, valueSize);
+      mEntries[i].value = strings + used;
+      mEntries[i].valueSize = valueSize;
+      used += valueSize;
    }
+
+   dFree(mStrings);
+   mStrings = strings;
+   mStringsUsed = used;
+   mStringsSize = size;
+   mStringsWasted = 0;
 }
 
+//-----------------------------------------------------------------------------
+
 void SimFieldDictionary::setFieldValue(StringTableEntry slotName, const char *value)
 {
-   U32 bucket = HashPointer(slotName) % HashTableSize;
-   Entry **walk = &mHashTable[bucket];
-   while(*walk && (*walk)->slotName != slotName)
-      walk = &((*walk)->next);
+   const S32 index = findEntry(slotName);
 
-   Entry *field = *walk;
    if(!*value)
    {
-      if(field)
+      if(index >= 0)
       {
          mVersion++;
-
-         dFree(field->value);
-         *walk = field->next;
-         freeEntry(field);
+         removeEntry(index);
       }
+      return;
+   }
+
+   const U32 valueSize = dStrlen(value) + 1;
+
+   // Overwrite in place when the new value fits.
+   if(index >= 0 && valueSize <= mEntries[index].valueSize)
+   {
+      dMemmove(mEntries[index].value, value, valueSize);
+      return;
+   }
+
+   // The value may be one of ours, which compacting the arena would move.
+   FrameTemp<char> valueCopy(valueSize);
+   if(mStrings && value >= mStrings && value < mStrings + mStringsSize)
+   {
+      dMemcpy(valueCopy, value, valueSize);
+      value = valueCopy;
+   }
+
+   Entry *field;
+   if(index >= 0)
+   {
+      field = &mEntries[index];
+      mStringsWasted += field->valueSize;
+      field->value = (char *) "";
+      field->valueSize = 0;
    }
    else
    {
-      if(field)
+      mVersion++;
+
+      if(mEntryCount == mEntryCapacity)
       {
-         dFree(field->value);
-         field->value = dStrdup(value);
+         mEntryCapacity = mEntryCapacity ? mEntryCapacity * 2 : MinEntryCapacity;
+         mEntries = (Entry *) dRealloc(mEntries, mEntryCapacity * sizeof(Entry));
       }
-      else
-      {
-         mVersion++;
 
-         field = allocEntry();
-         field->value = dStrdup(value);
-         field->slotName = slotName;
-         field->next = NULL;
-         *walk = field;
+      field = &mEntries[mEntryCount++];
+      field->slotName = slotName;
+      field->value = (char *) "";
+      field->valueSize = 0;
+
+      if(mEntryCount > LinearLimit)
+      {
+         if(!mIndex || mEntryCount * 2 > mIndexMask + 1)
+            rebuildIndex();
+         else
+         {
+            U32 slot = HashPointer(slotName) & mIndexMask;
+            while(mIndex[slot] >= 0)
+               slot = (slot + 1) & mIndexMask;
+            mIndex[slot] = mEntryCount - 1;
+         }
       }
    }
+
+   field->value = allocString(valueSize);
+   field->valueSize = valueSize;
+   dMemcpy(field->value, value, valueSize);
 }
 
 const char *SimFieldDictionary::getFieldValue(StringTableEntry slotName)
 {
-   U32 bucket = HashPointer(slotName) % HashTableSize;
-
-   for(Entry *walk = mHashTable[bucket];walk;walk = walk->next)
-      if(walk->slotName == slotName)
-         return walk->value;
-
-   return NULL;
+   const S32 index = findEntry(slotName);
+   return index >= 0 ? mEntries[index].value : NULL;
 }
 
 
@@ -127,9 +266,8 @@ void SimFieldDictionary::assignFrom(SimFieldDictionary *dict)
 {
    mVersion++;
 
-   for(U32 i = 0; i < HashTableSize; i++)
-      for(Entry *walk = dict->mHashTable[i];walk; walk = walk->next)
-         setFieldValue(walk->slotName, walk->value);
+   for(U32 i = 0; i < dict->mEntryCount; i++)
+      setFieldValue(dict->mEntries[i].slotName, dict->mEntries[i].value);
 }
 
 static S32 QSORT_CALLBACK compareEntries(const void* a,const void* b)
@@ -145,25 +283,22 @@ void SimFieldDictionary::writeFields(SimObject *obj, Stream &stream, U32 tabStop
    const AbstractClassRep::FieldList &list = obj->getFieldList();
    Vector<Entry *> flist(__FILE__, __LINE__);
 
-   for(U32 i = 0; i < HashTableSize; i++)
+   for(U32 e = 0; e < mEntryCount; e++)
    {
-      for(Entry *walk = mHashTable[i];walk; walk = walk->next)
-      {
-         // make sure we haven't written this out yet:
-         U32 i;
-         for(i = 0; i < (U32)list.size(); i++)
-            if(list[i].pFieldname == walk->slotName)
-               break;
+      Entry *walk = &mEntries[e];
+      // make sure we haven't written this out yet:
+      U32 i;
+      for(i = 0; i < (U32)list.size(); i++)
+         if(list[i].pFieldname == walk->slotName)
+            break;
 
-         if(i != list.size())
-            continue;
+      if(i != list.size())
+         continue;
 
+      if (!obj->writeField(walk->slotName, walk->value))
+         continue;
 
-         if (!obj->writeField(walk->slotName, walk->value))
-            continue;
-
-         flist.push_back(walk);
-      }
+      flist.push_back(walk);
    }
 
    // Sort Entries to prevent version control conflicts
@@ -191,21 +326,19 @@ void SimFieldDictionary::printFields(SimObject *obj)
    char expandedBuffer[4096];
    Vector<Entry *> flist(__FILE__, __LINE__);
 
-   for(U32 i = 0; i < HashTableSize; i++)
+   for(U32 e = 0; e < mEntryCount; e++)
    {
-      for(Entry *walk = mHashTable[i];walk; walk = walk->next)
-      {
-         // make sure we haven't written this out yet:
-         U32 i;
-         for(i = 0; i < (U32)list.size(); i++)
-            if(list[i].pFieldname == walk->slotName)
-               break;
+      Entry *walk = &mEntries[e];
+      // make sure we haven't written this out yet:
+      U32 i;
+      for(i = 0; i < (U32)list.size(); i++)
+         if(list[i].pFieldname == walk->slotName)
+            break;
 
-         if(i != list.size())
-            continue;
+      if(i != list.size())
+         continue;
 
-         flist.push_back(walk);
-      }
+      flist.push_back(walk);
    }
    dQsort(flist.address(),flist.size(),sizeof(Entry *),compareEntries);
 
@@ -222,7 +355,7 @@ void SimFieldDictionary::printFields(SimObject *obj)
 SimFieldDictionaryIterator::SimFieldDictionaryIterator(SimFieldDictionary * dictionary)
 {
    mDictionary = dictionary;
-   mHashIndex = -1;
+   mIndex = -1;
    mEntry = 0;
    operator++();
 }
@@ -232,11 +365,10 @@ SimFieldDictionary::Entry* SimFieldDictionaryIterator::operator++()
    if(!mDictionary)
       return(mEntry);
 
-   if(mEntry)
-      mEntry = mEntry->next;
-
-   while(!mEntry && (mHashIndex < (SimFieldDictionary::HashTableSize-1)))
-      mEntry = mDictionary->mHashTable[++mHashIndex];
+   if(++mIndex < (S32)mDictionary->mEntryCount)
+      mEntry = &mDictionary->mEntries[mIndex];
+   else
+      mEntry = 0;
 
    return(mEntry);
 }
@@ -34,6 +34,14 @@ class SimObject;
 //-----------------------------------------------------------------------------
 
 /// Dictionary to keep track of dynamic fields on SimObject.
+///
+/// Most objects carry only a handful of dynamic fields, so the entries are
+/// kept in a small array that is scanned linearly, with an open addressed
+/// index added once there are more than LinearLimit of them. Values live
+/// in a string arena owned by the dictionary.
+///
+/// @note Adding or removing a field may move the entries and values, so
+///       an Entry pointer is only valid until the next change.
 
 class SimFieldDictionary
 {
@@ -44,26 +52,46 @@ class SimFieldDictionary
    {
       StringTableEntry slotName;
       char *value;
-      Entry *next;
+      U32 valueSize;    ///< Bytes reserved for the value in the string arena.
    };
    enum
    {
-      HashTableSize = 19
+      LinearLimit = 8,
+      MinEntryCapacity = 2,
+      MinStringsSize = 32
    };
-   Entry *mHashTable[HashTableSize];
   private:
 
-   static Entry *mFreeList;
-   static void freeEntry(Entry *entry);
-   static Entry *allocEntry();
+   Entry *mEntries;
+   U32 mEntryCount;
+   U32 mEntryCapacity;
+
+   /// Slots index mEntries, -1 when empty. NULL while the count is within LinearLimit.
+   S32 *mIndex;
+   U32 mIndexMask;
+
+   char *mStrings;
+   U32 mStringsUsed;
+   U32 mStringsSize;
+   U32 mStringsWasted;  ///< Arena bytes no longer referenced by any entry.
 
    /// In order to efficiently detect when a dynamic field has been
    /// added or deleted, we increment this every time we add or
    /// remove a field.
    U32 mVersion;
 
+   S32 findEntry(StringTableEntry slotName) const;
+   void removeEntry(U32 index);
+   void rebuildIndex();
+   char *allocString(U32 size);
+   void compactStrings(U32 extraSize);
+
 public:
    const U32 getVersion() const { return mVersion; }
+   U32 getFieldCount() const { return mEntryCount; }
+
+   /// Bytes used by the dictionary, its entries, index and string arena.
+   U32 getMemoryUsage() const;
 
    SimFieldDictionary();
    ~SimFieldDictionary();
@@ -81,7 +109,7 @@ class DLL_PUBLIC SimFieldDictionaryIterator;
 class SimFieldDictionaryIterator
 {
    SimFieldDictionary *          mDictionary;
-   S32                           mHashIndex;
+   S32                           mIndex;
    SimFieldDictionary::Entry *   mEntry;
 
   public:
@@ -383,6 +383,23 @@ SimObject* findObject(SimObjectId id)
     return gIdDictionary->find(id);
 }
 
+static void dumpDictionaryStatistics(const char* name, const SimObjectHashTable::Statistics& stats)
+{
+   Con::printf("%s: %d objects, %d removed, %d slots, load %.2f, average probe %.2f, max probe %d",
+      name, stats.entryCount, stats.tombstoneCount, stats.tableSize, stats.loadFactor, stats.averageProbeLength, stats.maxProbeLength);
+}
+
+void dumpDictionaryStatistics()
+{
+   SimObjectHashTable::Statistics stats;
+
+   gIdDictionary->getStatistics(stats);
+   dumpDictionaryStatistics("Id dictionary", stats);
+
+   gNameDictionary->getStatistics(stats);
+   dumpDictionaryStatistics("Name dictionary", stats);
+}
+
 SimGroup *getRootGroup()
 {
    return gRootGroup;
@@ -449,6 +466,6 @@ void SimDataBlockGroup::sort()
    if(mLastModifiedKey != SimDataBlock::getNextModifiedKey())
    {
       mLastModifiedKey = SimDataBlock::getNextModifiedKey();
-        dQsort(objectList.address(),objectList.size(),sizeof(SimObject *),compareModifiedKey);
+        objectList.sort(compareModifiedKey);
    }
 }
@@ -29,6 +29,7 @@
 #include "io/fileStream.h"
 #include "io/fileObject.h"
 #include "console/ConsoleTypeValidators.h"
+#include "console/consoleTypes.h"
 #include "sim/simPublisher.h"
 
 #include "simObject_Binding.h"
@@ -54,9 +55,6 @@ SimObject::SimObject( const U8 namespaceLinkMask ) : mNSLinkMask( namespaceLinkM
     mFlags.set( ModStaticFields | ModDynamicFields );
     objectName               = NULL;
     mInternalName            = NULL;
-    nextNameObject           = (SimObject*)-1;
-    nextManagerNameObject    = (SimObject*)-1;
-    nextIdObject             = NULL;  
     mId                      = 0;
     mIdString                = StringTable->EmptyString;
     mGroup                   = 0;
@@ -517,8 +515,15 @@ bool SimObject::save(const char* pcFileName, bool bOnlySelected)
 
 void SimObject::setInternalName(const char* newname)
 {
-   if(newname)
-      mInternalName = StringTable->insert(newname);
+   if(!newname)
+      return;
+
+   mInternalName = StringTable->insert(newname);
+
+   // Only registered objects can be in a set, and they're usually named
+   // before being registered.
+   if(isProperlyAdded())
+      mInternalNameChangeCount++;
 }
 
 StringTableEntry SimObject::getInternalName()
@@ -543,53 +548,96 @@ const char *SimObject::tabComplete(const char *prevText, S32 baseLen, bool fForw
 
 //-----------------------------------------------------------------------------
 
-void SimObject::setDataField(StringTableEntry slotName, const char *array, const char *value)
+// S32, F32 and bool fields with no notify callbacks, validator or enum table
+// can be read and written in place, bypassing the type's string conversion.
+static inline bool isPlainNumericField( const AbstractClassRep::Field* fld )
 {
-   // first search the static fields if enabled
-   if(mFlags.test(ModStaticFields))
-   {
-      const AbstractClassRep::Field *fld = findField(slotName);
-      if(fld)
-      {
-         if( fld->type == AbstractClassRep::DepricatedFieldType ||
-            fld->type == AbstractClassRep::StartGroupFieldType ||
-            fld->type == AbstractClassRep::EndGroupFieldType) 
-            return;
+   return (fld->type == TypeS32 || fld->type == TypeF32 || fld->type == TypeBool) &&
+          fld->setDataFn == &defaultProtectedSetFn &&
+          fld->getDataFn == &defaultProtectedGetFn &&
+          fld->validator == NULL &&
+          fld->table == NULL;
+}
 
-         S32 array1 = array ? dAtoi(array) : 0;
+static inline void storeNumericField( const AbstractClassRep::Field* fld, SimObject* object, const S32 index, const F64 value )
+{
+   char* dptr = ((char *)object) + fld->offset;
+   if(fld->type == TypeS32)
+      ((S32 *)dptr)[index] = S32(value);
+   else if(fld->type == TypeF32)
+      ((F32 *)dptr)[index] = F32(value);
+   else
+      ((bool *)dptr)[index] = value != 0.0;
+}
 
-         if(array1 >= 0 && array1 < fld->elementCount && fld->elementCount >= 1)
-         {
-            // If the set data notify callback returns true, then go ahead and
-            // set the data, otherwise, assume the set notify callback has either
-            // already set the data, or has deemed that the data should not
-            // be set at all.
-            FrameTemp<char> buffer(2048);
-            FrameTemp<char> bufferSecure(2048); // This buffer is used to make a copy of the data 
-            // so that if the prep functions or any other functions use the string stack, the data
-            // is not corrupted.
+//-----------------------------------------------------------------------------
+
+void SimObject::setDataField(StringTableEntry slotName, const char *array, const char *value)
+{
+   // first search the static fields if enabled
+   setDataField(mFlags.test(ModStaticFields) ? findField(slotName) : NULL, slotName, array, value);
+}
 
-            ConsoleBaseType *cbt = ConsoleBaseType::getType( fld->type );
-            AssertFatal( cbt != NULL, "Could not resolve Type Id." );
+//-----------------------------------------------------------------------------
 
-            const char* szBuffer = cbt->prepData( value, buffer, 2048 );
-            dMemset( bufferSecure, 0, 2048 );
-            dMemcpy( bufferSecure, szBuffer, dStrlen( szBuffer ) );
+void SimObject::setDataField(const AbstractClassRep::Field* fld, StringTableEntry slotName, const char *array, const char *value)
+{
+   if(fld && mFlags.test(ModStaticFields))
+   {
+      if( fld->type == AbstractClassRep::DepricatedFieldType ||
+         fld->type == AbstractClassRep::StartGroupFieldType ||
+         fld->type == AbstractClassRep::EndGroupFieldType) 
+         return;
 
-            if( (*fld->setDataFn)( this, bufferSecure ) )
-               Con::setData(fld->type, (void *) (((const char *)this) + fld->offset), array1, 1, &value, fld->table);
+      S32 array1 = array ? dAtoi(array) : 0;
 
+      if(array1 >= 0 && array1 < fld->elementCount && fld->elementCount >= 1)
+      {
+         // Plain numeric fields are written directly.
+         if( isPlainNumericField( fld ) )
+         {
+            F64 numeric;
+            if(fld->type == TypeS32)
+               numeric = dAtoi( value );
+            else if(fld->type == TypeF32)
+               numeric = dAtof( value );
+            else
+               numeric = dAtob( value ) ? 1.0 : 0.0;
+
+            storeNumericField( fld, this, array1, numeric );
             onStaticModified( slotName, value );
-
             return;
          }
 
-         if(fld->validator)
-            fld->validator->validateType(this, (void *) (((const char *)this) + fld->offset));
+         // If the set data notify callback returns true, then go ahead and
+         // set the data, otherwise, assume the set notify callback has either
+         // already set the data, or has deemed that the data should not
+         // be set at all.
+         FrameTemp<char> buffer(2048);
+         FrameTemp<char> bufferSecure(2048); // This buffer is used to make a copy of the data 
+         // so that if the prep functions or any other functions use the string stack, the data
+         // is not corrupted.
+
+         ConsoleBaseType *cbt = ConsoleBaseType::getType( fld->type );
+         AssertFatal( cbt != NULL, "Could not resolve Type Id." );
+
+         const char* szBuffer = cbt->prepData( value, buffer, 2048 );
+         dMemset( bufferSecure, 0, 2048 );
+         dMemcpy( bufferSecure, szBuffer, dStrlen( szBuffer ) );
+
+         if( (*fld->setDataFn)( this, bufferSecure ) )
+            Con::setData(fld->type, (void *) (((const char *)this) + fld->offset), array1, 1, &value, fld->table);
 
          onStaticModified( slotName, value );
+
          return;
       }
+
+      if(fld->validator)
+         fld->validator->validateType(this, (void *) (((const char *)this) + fld->offset));
+
+      onStaticModified( slotName, value );
+      return;
    }
 
    if(mFlags.test(ModDynamicFields))
@@ -613,19 +661,36 @@ void SimObject::setDataField(StringTableEntry slotName, const char *array, const
 
 const char *SimObject::getDataField(StringTableEntry slotName, const char *array)
 {
-   if(mFlags.test(ModStaticFields))
+   return getDataField(mFlags.test(ModStaticFields) ? findField(slotName) : NULL, slotName, array);
+}
+
+//-----------------------------------------------------------------------------
+
+const char *SimObject::getDataField(const AbstractClassRep::Field* fld, StringTableEntry slotName, const char *array)
+{
+   if(fld && mFlags.test(ModStaticFields))
    {
       S32 array1 = array ? dAtoi(array) : -1;
-      const AbstractClassRep::Field *fld = findField(slotName);
-   
-      if(fld)
-      {
-         if(array1 == -1 && fld->elementCount == 1)
-            return (*fld->getDataFn)( this, Con::getData(fld->type, (void *) (((const char *)this) + fld->offset), 0, fld->table, fld->flag) );
-         if(array1 >= 0 && array1 < fld->elementCount)
-            return (*fld->getDataFn)( this, Con::getData(fld->type, (void *) (((const char *)this) + fld->offset), array1, fld->table, fld->flag) );// + typeSizes[fld.type] * array1));
+      if(array1 == -1 && fld->elementCount == 1)
+         array1 = 0;
+      else if(array1 < 0 || array1 >= fld->elementCount)
          return "";
+
+      if( isPlainNumericField( fld ) )
+      {
+         const char* dptr = ((const char *)this) + fld->offset;
+         if(fld->type == TypeBool)
+            return ((const bool *)dptr)[array1] ? "1" : "0";
+
+         char* returnBuffer = Con::getReturnBuffer(32);
+         if(fld->type == TypeS32)
+            dSprintf(returnBuffer, 32, "%d", ((const S32 *)dptr)[array1]);
+         else
+            dSprintf(returnBuffer, 32, "%.9g", ((const F32 *)dptr)[array1]);
+         return returnBuffer;
       }
+
+      return (*fld->getDataFn)( this, Con::getData(fld->type, (void *) (((const char *)this) + fld->offset), array1, fld->table, fld->flag) );
    }
 
    if(mFlags.test(ModDynamicFields))
@@ -640,10 +705,14 @@ const char *SimObject::getDataField(StringTableEntry slotName, const char *array
       }
       else
       {
+         // A name that was never interned can't be in the dictionary.
          static char buf[256];
          dStrcpy(buf, slotName);
          dStrcat(buf, array);
-         if (const char* val = mFieldDictionary->getFieldValue(StringTable->insert(buf)))
+         StringTableEntry arrayName = StringTable->lookup(buf);
+         if (arrayName == NULL)
+            return "";
+         if (const char* val = mFieldDictionary->getFieldValue(arrayName))
             return val;
       }
    }
@@ -653,6 +722,51 @@ const char *SimObject::getDataField(StringTableEntry slotName, const char *array
 
 //-----------------------------------------------------------------------------
 
+bool SimObject::isNumericDataField(const AbstractClassRep::Field* fld)
+{
+   return fld != NULL && isPlainNumericField( fld );
+}
+
+//-----------------------------------------------------------------------------
+
+bool SimObject::getNumericDataField(const AbstractClassRep::Field* fld, const char *array, F64& value)
+{
+   if(!fld || !mFlags.test(ModStaticFields) || !isPlainNumericField( fld ))
+      return false;
+
+   S32 array1 = array && array[0] ? dAtoi(array) : 0;
+   if(array1 < 0 || array1 >= fld->elementCount)
+      return false;
+
+   const char* dptr = ((const char *)this) + fld->offset;
+   if(fld->type == TypeS32)
+      value = ((const S32 *)dptr)[array1];
+   else if(fld->type == TypeF32)
+      value = ((const F32 *)dptr)[array1];
+   else
+      value = ((const bool *)dptr)[array1] ? 1.0 : 0.0;
+
+   return true;
+}
+
+//-----------------------------------------------------------------------------
+
+bool SimObject::setNumericDataField(const AbstractClassRep::Field* fld, StringTableEntry slotName, const char *array, F64 value, const char *valueString)
+{
+   if(!fld || !mFlags.test(ModStaticFields) || !isPlainNumericField( fld ))
+      return false;
+
+   S32 array1 = array && array[0] ? dAtoi(array) : 0;
+   if(array1 < 0 || array1 >= fld->elementCount)
+      return false;
+
+   storeNumericField( fld, this, array1, value );
+   onStaticModified( slotName, valueString );
+   return true;
+}
+
+//-----------------------------------------------------------------------------
+
 const char *SimObject::getPrefixedDataField(StringTableEntry fieldName, const char *array)
 {
     // Sanity!
@@ -882,10 +996,10 @@ SimObject::~SimObject()
 
    delete mFieldDictionary;
 
-   AssertFatal(nextNameObject == (SimObject*)-1,avar(
+   AssertFatal(!Sim::gIdDictionary || Sim::gIdDictionary->find(mId) != this,avar(
                   "SimObject::~SimObject:  Not removed from dictionary: name %s, id %i",
                   objectName, mId));
-   AssertFatal(nextManagerNameObject == (SimObject*)-1,avar(
+   AssertFatal(!Sim::gNameDictionary || !Sim::gNameDictionary->contains(this),avar(
                   "SimObject::~SimObject:  Not removed from manager dictionary: name %s, id %i",
                   objectName,mId));
    AssertFatal(mFlags.test(Added) == 0, "SimObject::object "
@@ -992,6 +1106,7 @@ bool SimObject::isChildOfGroup(SimGroup* pGroup)
 
 static Chunker<SimObject::Notify> notifyChunker(128000);
 SimObject::Notify *SimObject::mNotifyFreeList = NULL;
+U32 SimObject::mInternalNameChangeCount = 0;
 
 SimObject::Notify *SimObject::allocNotify()
 {
@@ -1129,7 +1244,7 @@ void SimObject::initPersistFields()
    Parent::initPersistFields();
    addGroup("SimBase");
    addField("canSaveDynamicFields",		TypeBool,		   Offset(mCanSaveFieldDictionary, SimObject), &writeCanSaveDynamicFields, "");
-   addField("internalName",            TypeString,       Offset(mInternalName, SimObject), &writeInternalName, "");   
+   addProtectedField("internalName",   TypeString,       Offset(mInternalName, SimObject), &setInternalNameFn, &defaultProtectedGetFn, &writeInternalName, "");
    addProtectedField("parentGroup",    TypeSimObjectPtr, Offset(mGroup, SimObject), &setParentGroup, &defaultProtectedGetFn, &writeParentGroup, "Group hierarchy parent of the object." );
    endGroup("SimBase");
 
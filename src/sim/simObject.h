@@ -277,9 +277,6 @@ public:
 private:
     // dictionary information stored on the object
     StringTableEntry objectName;
-    SimObject*       nextNameObject;
-    SimObject*       nextManagerNameObject;
-    SimObject*       nextIdObject;
 
     SimGroup*   mGroup;  ///< SimGroup we're contained in, if any.
     BitSet32    mFlags;
@@ -310,6 +307,7 @@ protected:
     /// @{
 
     static SimObject::Notify *mNotifyFreeList;
+    static U32 mInternalNameChangeCount;
     static SimObject::Notify *allocNotify();     ///< Get a free Notify structure.
     static void freeNotify(SimObject::Notify*);  ///< Mark a Notify structure as free.
 
@@ -339,6 +337,7 @@ protected:
     static bool setClass(void* obj, const char* data)                                { static_cast<SimObject*>(obj)->setClassNamespace(data); return false; };
     static bool setSuperClass(void* obj, const char* data)                           { static_cast<SimObject*>(obj)->setSuperClassNamespace(data); return false; };
     static bool writeCanSaveDynamicFields( void* obj, StringTableEntry pFieldName )  { return static_cast<SimObject*>(obj)->mCanSaveFieldDictionary == false; }
+    static bool setInternalNameFn( void* obj, const char* data )                     { static_cast<SimObject*>(obj)->setInternalName(data); return false; }
     static bool writeInternalName( void* obj, StringTableEntry pFieldName )          { SimObject* simObject = static_cast<SimObject*>(obj); return simObject->mInternalName != NULL && simObject->mInternalName != StringTable->EmptyString; }
     static bool setParentGroup(void* obj, const char* data);
     static bool writeParentGroup( void* obj, StringTableEntry pFieldName )           { return static_cast<SimObject*>(obj)->mGroup != NULL; }
@@ -400,6 +399,33 @@ public:
     /// @param   value       Value to store.
     void setDataField(StringTableEntry slotName, const char *array, const char *value);
 
+    /// Same as getDataField() but with the static field already resolved.
+    ///
+    /// @param   field       Result of findField(slotName), or NULL for a dynamic field.
+    const char *getDataField(const AbstractClassRep::Field* field, StringTableEntry slotName, const char *array);
+
+    /// Same as setDataField() but with the static field already resolved.
+    ///
+    /// @param   field       Result of findField(slotName), or NULL for a dynamic field.
+    void setDataField(const AbstractClassRep::Field* field, StringTableEntry slotName, const char *array, const char *value);
+
+    /// Whether a static field is an S32, F32 or bool field that the numeric
+    /// accessors below can read and write in place.
+    static bool isNumericDataField(const AbstractClassRep::Field* field);
+
+    /// Read an S32, F32 or bool static field without converting through a string.
+    ///
+    /// @return False if the field isn't a plain numeric field, in which case the
+    ///         string accessors must be used.
+    bool getNumericDataField(const AbstractClassRep::Field* field, const char *array, F64& value);
+
+    /// Write an S32, F32 or bool static field without converting through a string.
+    ///
+    /// @param   valueString The same value as a string, passed on to onStaticModified().
+    /// @return False if the field isn't a plain numeric field, in which case the
+    ///         string accessors must be used.
+    bool setNumericDataField(const AbstractClassRep::Field* field, StringTableEntry slotName, const char *array, F64 value, const char *valueString);
+
     const char *getPrefixedDataField(StringTableEntry fieldName, const char *array);
 
     void setPrefixedDataField(StringTableEntry fieldName, const char *array, const char *value);
@@ -441,6 +467,10 @@ public:
     /// Get the internal of of this control
     StringTableEntry getInternalName();
 
+    /// Bumped whenever a registered object's internal name changes, so that
+    /// sets can tell when their internal name index is stale.
+    static U32 getInternalNameChangeCount() { return mInternalNameChangeCount; }
+
     /// Save object as a TorqueScript File.
     virtual bool		save(const char* pcFilePath, bool bOnlySelected=false);
 
@@ -113,7 +113,7 @@ bool SimSet::reOrder( SimObject *obj, SimObject *target )
    handle.lock(mMutex);
 
    iterator itrS, itrD;
-   if ( (itrS = find(begin(),end(),obj)) == end() )
+   if ( (itrS = find(obj)) == end() )
    {
       return false;  // object must be in list
    }
@@ -133,13 +133,13 @@ bool SimSet::reOrder( SimObject *obj, SimObject *target )
    }
    else              // if target, insert object in front of target
    {
-      if ( (itrD = find(begin(),end(),target)) == end() )
+      if ( (itrD = find(target)) == end() )
          return false;              // target must be in list
 
       objectList.erase(itrS);
 
       //Tinman - once itrS has been erased, itrD won't be pointing at the same place anymore - re-find...
-      itrD = find(begin(),end(),target);
+      itrD = find(target);
       objectList.insert(itrD,obj);
    }
 
@@ -226,6 +226,15 @@ void SimSet::clear()
 
 SimObject* SimSet::findObjectByInternalName(const char* internalName, bool searchChildren)
 {
+   // A direct member can be looked up, but a nested one found first takes precedence.
+   if (!searchChildren)
+   {
+      lock();
+      SimObject* found = objectList.findByInternalName(internalName);
+      unlock();
+      return found;
+   }
+
    iterator i;
    for (i = begin(); i != end(); i++)
    {
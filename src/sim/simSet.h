@@ -139,7 +139,8 @@ public:
    value operator[] (S32 index) { return objectList[U32(index)]; }
 
    inline iterator find( iterator first, iterator last, SimObject *obj ) { return ::find(first, last, obj); }
-   inline iterator find( SimObject *obj ) { return ::find(begin(), end(), obj); }
+   inline iterator find( SimObject *obj ) { return objectList.find(obj); }
+   inline bool contains( SimObject *obj ) const { return objectList.contains(obj); }
 
    template <typename T> inline bool containsType( void )
    {
@@ -213,6 +214,11 @@ public:
    virtual SimObject *findObject(const char *name);
    SimObject*	findObjectByInternalName(const char* internalName, bool searchChildren = false);
 
+   /// Keep a hash of the members' internal names so findObjectByInternalName()
+   /// doesn't search the set. Worthwhile for large sets that are searched often.
+   void setInternalNameIndex( bool enabled ) { lock(); objectList.setInternalNameIndex(enabled); unlock(); }
+   bool getInternalNameIndex( void ) const { return objectList.getInternalNameIndex(); }
+
    virtual bool writeObject(Stream *stream);
    virtual bool readObject(Stream *stream);
 
@@ -337,17 +337,10 @@ ConsoleMethodWithDocs(SimSet, isMember, ConsoleBool, 3, 3, (object))
    }
 
    object->lock();
-   for(SimSet::iterator i = object->begin(); i != object->end(); i++)
-   {
-      if(*i == testObject)
-      {
-         object->unlock();
-         return true;
-      }
-   }
+   const bool isMember = object->contains(testObject);
    object->unlock();
 
-   return false;
+   return isMember;
 }
 
 /*! Returns the object with given internal name
@@ -369,6 +362,16 @@ ConsoleMethodWithDocs( SimSet, findObjectByInternalName, ConsoleInt, 3, 4, (stri
    return 0;
 }
 
+/*! Sets whether the set keeps a hash of its members' internal names.
+    This makes findObjectByInternalName() constant time for direct members of large sets.
+    @param enabled Whether to keep the index.
+    @return No return value.
+*/
+ConsoleMethodWithDocs( SimSet, setInternalNameIndex, ConsoleVoid, 3, 3, (bool enabled))
+{
+   object->setInternalNameIndex(dAtob(argv[2]));
+}
+
 /*! Brings SimObject to front of set.
 	If the SimObject is not in the set, do nothing.
     @return No return value.
@@ -485,13 +488,10 @@ extern "C"{
    DLL_PUBLIC bool SimSetIsMember(SimSet* set, SimObject* obj)
    {
       set->lock();
-      for (SimSet::iterator i = set->begin(); i != set->end(); i++)
+      if (set->contains(obj))
       {
-         if (*i == obj)
-         {
-            set->unlock();
-            return true;
-         }
+         set->unlock();
+         return true;
       }
       set->unlock();
 
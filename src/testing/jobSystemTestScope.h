@@ -0,0 +1,55 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2013 GarageGames, LLC
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//-----------------------------------------------------------------------------
+
+
+#ifndef _JOB_SYSTEM_TEST_SCOPE_H_
+#define _JOB_SYSTEM_TEST_SCOPE_H_
+
+#ifndef TORQUE_SHIPPING
+
+#ifndef _JOB_SYSTEM_H_
+#include "platform/threads/jobSystem.h"
+#endif
+
+// Starts the job system for a test when the engine hasn't. The worker count
+// is the one of JobSystem::init().
+class JobSystemTestScope
+{
+    bool mOwner;
+
+public:
+    explicit JobSystemTestScope( U32 workerCount = 0 ) : mOwner( !JobSystem::isInitialized() )
+    {
+        if ( mOwner )
+            JobSystem::init( workerCount );
+    }
+
+    ~JobSystemTestScope()
+    {
+        if ( mOwner )
+            JobSystem::destroy();
+    }
+};
+
+#endif // TORQUE_SHIPPING
+
+#endif // _JOB_SYSTEM_TEST_SCOPE_H_
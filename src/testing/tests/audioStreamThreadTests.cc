@@ -0,0 +1,437 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2013 GarageGames, LLC
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//-----------------------------------------------------------------------------
+
+// We don't want tests in a shipping version.
+#ifndef TORQUE_SHIPPING
+
+#ifndef _UNIT_TESTING_H_
+#include "testing/unitTesting.h"
+#endif
+
+#ifndef _PLATFORM_H_
+#include "platform/platform.h"
+#endif
+
+#ifndef _AUDIO_STREAM_THREAD_H_
+#include "audio/audioStreamThread.h"
+#endif
+
+#ifndef _MEMSTREAM_H_
+#include "io/memstream.h"
+#endif
+
+#ifndef _MMATH_H_
+#include "math/mMath.h"
+#endif
+
+#ifndef _CONSOLE_H_
+#include "console/console.h"
+#endif
+
+//-----------------------------------------------------------------------------
+
+#define AUDIOSTREAM_UNITTEST_SAMPLE_RATE     176400
+#define AUDIOSTREAM_UNITTEST_FRAMES          176400    // one second, mono
+#define AUDIOSTREAM_UNITTEST_BUFFERS         4         // about 186ms queued
+#define AUDIOSTREAM_UNITTEST_FRAME_TIME      250       // ms, longer than the queue
+#define AUDIOSTREAM_UNITTEST_TIMEOUT         10000
+#define AUDIOSTREAM_UNITTEST_ADPCM_BLOCK     512
+#define AUDIOSTREAM_UNITTEST_ADPCM_FRAMES    1700      // three blocks and a bit
+
+//-----------------------------------------------------------------------------
+
+// Everything a test queue played, outlives the queue which the stream thread
+// deletes.
+struct AudioStreamTestOutput
+{
+    Vector<S16> mSamples;
+};
+
+// Plays 16 bit mono buffers back against the wall clock like a device would.
+// Runs dry when the stream thread doesn't keep up.
+class AudioStreamTestQueue : public AudioStreamQueue
+{
+public:
+    S16 mData[AUDIOSTREAM_UNITTEST_BUFFERS][AudioStreamThread::ChunkBytes / sizeof(S16)];
+    U32 mFrames[AUDIOSTREAM_UNITTEST_BUFFERS];
+    U32 mHead;
+    U32 mCount;
+    U32 mHeadStart;
+    bool mPlaying;
+    AudioStreamTestOutput* mOutput;
+
+    AudioStreamTestQueue( AudioStreamTestOutput* output ) : mHead( 0 ), mCount( 0 ), mHeadStart( 0 ), mPlaying( false ), mOutput( output ) { }
+
+    void advance()
+    {
+        if ( !mPlaying )
+            return;
+
+        const U32 now = Platform::getRealMilliseconds();
+        while ( mCount > 0 )
+        {
+            const U32 length = mFrames[mHead] * 1000 / AUDIOSTREAM_UNITTEST_SAMPLE_RATE;
+            if ( now - mHeadStart < length )
+                return;
+
+            for ( U32 i = 0; i < mFrames[mHead]; i++ )
+                mOutput->mSamples.push_back( mData[mHead][i] );
+
+            mHeadStart += length;
+            mHead = ( mHead + 1 ) % AUDIOSTREAM_UNITTEST_BUFFERS;
+            mCount--;
+        }
+
+        mPlaying = false;
+    }
+
+    virtual U32 reclaim()
+    {
+        advance();
+        return AUDIOSTREAM_UNITTEST_BUFFERS - mCount;
+    }
+
+    virtual bool submit( const void* data, U32 bytes, const AudioStreamFormat& format )
+    {
+        if ( mCount == AUDIOSTREAM_UNITTEST_BUFFERS )
+            return false;
+
+        const U32 slot = ( mHead + mCount ) % AUDIOSTREAM_UNITTEST_BUFFERS;
+        dMemcpy( mData[slot], data, bytes );
+        mFrames[slot] = bytes / format.getFrameSize();
+        mCount++;
+        return true;
+    }
+
+    virtual U32 getQueuedCount()
+    {
+        return mCount;
+    }
+
+    virtual bool isStopped()
+    {
+        advance();
+        return !mPlaying;
+    }
+
+    virtual void play()
+    {
+        mPlaying = true;
+        mHeadStart = Platform::getRealMilliseconds();
+    }
+
+    virtual void stop()
+    {
+        mPlaying = false;
+        mCount = 0;
+    }
+};
+
+//-----------------------------------------------------------------------------
+
+static void writeTestWav( Stream& stream, U16 encoding, U16 channels, U16 bits, U16 blockAlign, const void* data, U32 bytes, U32 factFrames )
+{
+    const bool adpcm = ( encoding == WavStreamDecoder::FormatIMAADPCM );
+    const U32 fmtSize = adpcm ? 20 : 16;
+
+    stream.write( 4, "RIFF" );
+    stream.write( (U32)( 4 + ( 8 + fmtSize ) + ( adpcm ? 12 : 0 ) + ( 8 + bytes ) ) );
+    stream.write( 4, "WAVE" );
+
+    stream.write( 4, "fmt " );
+    stream.write( fmtSize );
+    stream.write( encoding );
+    stream.write( channels );
+    stream.write( (U32)AUDIOSTREAM_UNITTEST_SAMPLE_RATE );
+    stream.write( (U32)( AUDIOSTREAM_UNITTEST_SAMPLE_RATE * channels * bits / 8 ) );
+    stream.write( blockAlign );
+    stream.write( bits );
+    if ( adpcm )
+    {
+        stream.write( (U16)2 );
+        stream.write( (U16)( 1 + ( blockAlign - 4 * channels ) * 2 / channels ) );
+
+        stream.write( 4, "fact" );
+        stream.write( (U32)4 );
+        stream.write( factFrames );
+    }
+
+    stream.write( 4, "data" );
+    stream.write( bytes );
+    stream.write( bytes, data );
+    stream.setPosition( 0 );
+}
+
+static S16 getTestSample( U32 frame )
+{
+    return (S16)( frame & 0x7fff );
+}
+
+// Plays a one second ramp, the main thread only looks at the events every
+// frameTime ms. Returns the underruns.
+static S32 playTestStream( bool threaded, AudioStreamTestOutput& output )
+{
+    const U32 bytes = AUDIOSTREAM_UNITTEST_FRAMES * sizeof(S16);
+    S16* samples = new S16[AUDIOSTREAM_UNITTEST_FRAMES];
+    for ( U32 i = 0; i < AUDIOSTREAM_UNITTEST_FRAMES; i++ )
+        samples[i] = getTestSample( i );
+
+    U8* file = new U8[bytes + 64];
+    MemStream stream( bytes + 64, file );
+    writeTestWav( stream, WavStreamDecoder::FormatPCM, 1, 16, 2, samples, bytes, 0 );
+    delete [] samples;
+
+    AudioStreamThread* thread = new AudioStreamThread();
+    if ( threaded )
+        thread->startThread();
+
+    const U32 id = thread->open( new WavStreamDecoder( &stream, false ), new AudioStreamTestQueue( &output ), false );
+    thread->start( id );
+
+    bool finished = false;
+    const U32 startTime = Platform::getRealMilliseconds();
+    while ( !finished && Platform::getRealMilliseconds() - startTime < AUDIOSTREAM_UNITTEST_TIMEOUT )
+    {
+        if ( !threaded )
+            thread->service();
+
+        // a long main loop frame
+        Platform::sleep( AUDIOSTREAM_UNITTEST_FRAME_TIME );
+
+        AudioStreamThread::Event event;
+        while ( thread->popEvent( event ) )
+            finished |= ( event.mType == AudioStreamThread::StreamFinished && event.mStream == id );
+    }
+
+    EXPECT_TRUE( finished );
+
+    const S32 underruns = thread->getUnderrunCount();
+    delete thread;
+    delete [] file;
+    return underruns;
+}
+
+//-----------------------------------------------------------------------------
+
+TEST( AudioStreamThreadTests, mainThreadStallTest )
+{
+    AudioStreamTestOutput output;
+    const S32 underruns = playTestStream( true, output );
+
+    // the stream thread kept the queue from running dry
+    EXPECT_EQ( 0, underruns );
+
+    // and every sample made it, once and in order
+    ASSERT_EQ( (U32)AUDIOSTREAM_UNITTEST_FRAMES, output.mSamples.size() );
+    U32 mismatches = 0;
+    for ( U32 i = 0; i < output.mSamples.size(); i++ )
+        mismatches += ( output.mSamples[i] != getTestSample( i ) );
+    EXPECT_EQ( 0U, mismatches );
+}
+
+TEST( AudioStreamThreadTests, mainLoopStarvesTest )
+{
+    // refilled once per main loop frame, the way streams used to be
+    AudioStreamTestOutput output;
+    const S32 underruns = playTestStream( false, output );
+
+    Con::printf( "Refilled every %dms: %d underruns.", AUDIOSTREAM_UNITTEST_FRAME_TIME, underruns );
+    EXPECT_GT( underruns, 0 );
+
+    ASSERT_EQ( (U32)AUDIOSTREAM_UNITTEST_FRAMES, output.mSamples.size() );
+    U32 mismatches = 0;
+    for ( U32 i = 0; i < output.mSamples.size(); i++ )
+        mismatches += ( output.mSamples[i] != getTestSample( i ) );
+    EXPECT_EQ( 0U, mismatches );
+}
+
+TEST( AudioStreamThreadTests, corruptLoopTest )
+{
+    // The data chunk claims more than the file holds, every read comes back
+    // empty, rewound or not.
+    U8 file[64];
+    MemStream stream( sizeof(file), file );
+    S16 silence[8] = { 0 };
+    writeTestWav( stream, WavStreamDecoder::FormatPCM, 1, 16, 2, silence, sizeof(silence), 0 );
+
+    const U32 dataSize = 4096;
+    dMemcpy( file + 40, &dataSize, sizeof(dataSize) );
+    MemStream truncated( 44, file );
+
+    AudioStreamTestOutput output;
+    AudioStreamThread thread;
+    const U32 id = thread.open( new WavStreamDecoder( &truncated, false ), new AudioStreamTestQueue( &output ), true );
+    thread.start( id );
+    thread.service();
+
+    AudioStreamThread::Event event;
+    bool finished = false;
+    while ( thread.popEvent( event ) )
+        finished |= ( event.mType == AudioStreamThread::StreamFinished && event.mStream == id );
+    EXPECT_TRUE( finished );
+    EXPECT_EQ( 0U, output.mSamples.size() );
+}
+
+//-----------------------------------------------------------------------------
+
+static const S32 testIndexTable[16] =
+{
+    -1, -1, -1, -1, 2, 4, 6, 8,
+    -1, -1, -1, -1, 2, 4, 6, 8
+};
+
+static const S32 testStepTable[89] =
+{
+    7, 8, 9, 10, 11, 12, 13, 14, 16, 17,
+    19, 21, 23, 25, 28, 31, 34, 37, 41, 45,
+    50, 55, 60, 66, 73, 80, 88, 97, 107, 118,
+    130, 143, 157, 173, 190, 209, 230, 253, 279, 307,
+    337, 371, 408, 449, 494, 544, 598, 658, 724, 796,
+    876, 963, 1060, 1166, 1282, 1411, 1552, 1707, 1878, 2066,
+    2272, 2499, 2749, 3024, 3327, 3660, 4026, 4428, 4871, 5358,
+    5894, 6484, 7132, 7845, 8630, 9493, 10442, 11487, 12635, 13899,
+    15289, 16818, 18500, 20350, 22385, 24623, 27086, 29794, 32767
+};
+
+// Reference IMA ADPCM encoder. Returns the nibble and updates the state the
+// way a decoder would, so reconstructed is what a decoder must output.
+static U32 encodeTestNibble( S32 sample, S32& predictor, S32& index, S16& reconstructed )
+{
+    S32 step = testStepTable[index];
+    S32 diff = sample - predictor;
+
+    U32 nibble = 0;
+    if ( diff < 0 )
+    {
+        nibble = 8;
+        diff = -diff;
+    }
+
+    S32 delta = step >> 3;
+    if ( diff >= step )         { nibble |= 4; diff -= step; delta += step; }
+    if ( diff >= ( step >> 1 ) ) { nibble |= 2; diff -= step >> 1; delta += step >> 1; }
+    if ( diff >= ( step >> 2 ) ) { nibble |= 1; delta += step >> 2; }
+
+    predictor += ( nibble & 8 ) ? -delta : delta;
+    predictor = mClamp( predictor, -32768, 32767 );
+    index = mClamp( index + testIndexTable[nibble], 0, 88 );
+    reconstructed = (S16)predictor;
+    return nibble;
+}
+
+TEST( AudioStreamThreadTests, adpcmDecodeTest )
+{
+    const U32 channels = 2;
+    const U32 blockAlign = AUDIOSTREAM_UNITTEST_ADPCM_BLOCK;
+    const U32 blockFrames = 1 + ( blockAlign - 4 * channels ) * 2 / channels;
+    const U32 frames = AUDIOSTREAM_UNITTEST_ADPCM_FRAMES;
+    const U32 blocks = ( frames + blockFrames - 1 ) / blockFrames;
+
+    // a different tone on each channel
+    S16* source = new S16[blocks * blockFrames * channels];
+    S16* reference = new S16[blocks * blockFrames * channels];
+    for ( U32 i = 0; i < blocks * blockFrames; i++ )
+    {
+        source[i * 2] = (S16)( 12000.0f * mSin( i * 0.031f ) );
+        source[i * 2 + 1] = (S16)( 9000.0f * mSin( i * 0.077f ) );
+    }
+
+    U8* data = new U8[blocks * blockAlign];
+    dMemset( data, 0, blocks * blockAlign );
+    for ( U32 b = 0; b < blocks; b++ )
+    {
+        U8* block = data + b * blockAlign;
+        const S16* in = source + b * blockFrames * channels;
+        S16* out = reference + b * blockFrames * channels;
+
+        S32 predictor[2];
+        S32 index[2];
+        for ( U32 c = 0; c < channels; c++ )
+        {
+            predictor[c] = in[c];
+            index[c] = 20;
+            out[c] = in[c];
+            block[c * 4] = (U8)( in[c] & 0xff );
+            block[c * 4 + 1] = (U8)( ( in[c] >> 8 ) & 0xff );
+            block[c * 4 + 2] = (U8)index[c];
+        }
+
+        U8* word = block + 4 * channels;
+        for ( U32 w = 0; w < ( blockFrames - 1 ) / 8; w++ )
+        {
+            for ( U32 c = 0; c < channels; c++ )
+            {
+                for ( U32 s = 0; s < 8; s++ )
+                {
+                    const U32 frame = 1 + w * 8 + s;
+                    const U32 nibble = encodeTestNibble( in[frame * channels + c], predictor[c], index[c], out[frame * channels + c] );
+                    word[s / 2] |= ( s & 1 ) ? ( nibble << 4 ) : nibble;
+                }
+                word += 4;
+            }
+        }
+    }
+
+    const U32 bytes = blocks * blockAlign;
+    U8* file = new U8[bytes + 64];
+    MemStream stream( bytes + 64, file );
+    writeTestWav( stream, WavStreamDecoder::FormatIMAADPCM, channels, 4, blockAlign, data, bytes, frames );
+
+    WavStreamDecoder decoder( &stream, false );
+    ASSERT_TRUE( decoder.isValid() );
+    EXPECT_EQ( 16U, decoder.getFormat().mBitsPerSample );
+    EXPECT_EQ( channels, decoder.getFormat().mChannels );
+    EXPECT_EQ( frames, decoder.getFrameCount() );
+
+    // odd sized reads cross the blocks anywhere, twice to check rewind
+    S16* decoded = new S16[frames * channels];
+    for ( U32 pass = 0; pass < 2; pass++ )
+    {
+        dMemset( decoded, 0, frames * channels * sizeof(S16) );
+
+        U32 total = 0;
+        U32 read;
+        while ( ( read = decoder.read( (U8*)decoded + total, getMin( 1000U, frames * channels * 2 - total ) ) ) > 0 )
+            total += read;
+        EXPECT_EQ( frames * channels * 2, total );
+
+        U32 mismatches = 0;
+        S32 maxError = 0;
+        for ( U32 i = 0; i < frames * channels; i++ )
+        {
+            mismatches += ( decoded[i] != reference[i] );
+            maxError = getMax( maxError, mAbs( decoded[i] - source[i] ) );
+        }
+        EXPECT_EQ( 0U, mismatches );
+        EXPECT_LT( maxError, 2048 );
+
+        EXPECT_TRUE( decoder.rewind() );
+    }
+
+    delete [] decoded;
+    delete [] file;
+    delete [] data;
+    delete [] reference;
+    delete [] source;
+}
+
+#endif // TORQUE_SHIPPING
@@ -0,0 +1,385 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2013 GarageGames, LLC
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//-----------------------------------------------------------------------------
+
+
+// We don't want tests in a shipping version.
+#ifndef TORQUE_SHIPPING
+
+#ifndef _UNIT_TESTING_H_
+#include "testing/unitTesting.h"
+#endif
+
+#ifndef _PLATFORM_H_
+#include "platform/platform.h"
+#endif
+
+#ifndef _AUDIO_VOICE_SCHEDULER_H_
+#include "audio/audioVoiceScheduler.h"
+#endif
+
+#ifndef _MRANDOM_H_
+#include "math/mRandom.h"
+#endif
+
+#ifndef _CONSOLE_H_
+#include "console/console.h"
+#endif
+
+//-----------------------------------------------------------------------------
+
+#define AUDIOVOICE_UNITTEST_VOICES        10000
+#define AUDIOVOICE_UNITTEST_REAL_VOICES   32
+#define AUDIOVOICE_UNITTEST_SAMPLE_RATE   44100
+#define AUDIOVOICE_UNITTEST_UPDATE        0.125f
+#define AUDIOVOICE_UNITTEST_UPDATES       200
+#define AUDIOVOICE_UNITTEST_AREA          400.0f
+
+//-----------------------------------------------------------------------------
+
+// Null device that checks every voice it is asked to play starts where it
+// would be had it played the whole time. All voices start at time zero.
+class AudioVoiceTestDevice : public AudioNullVoiceDevice
+{
+public:
+    F64 mTime;
+    F64 mMaxResumeError;
+    U32 mResumes;
+
+    AudioVoiceTestDevice( U32 voiceCount ) : AudioNullVoiceDevice( voiceCount ), mTime( 0.0 ), mMaxResumeError( 0.0 ), mResumes( 0 ) { }
+
+    static F64 getExpectedOffset( const AudioVoice& voice, F64 time )
+    {
+        F64 offset = time * voice.mDesc.mSampleRate * voice.mPitch;
+        if ( voice.mDesc.mIsLooping )
+            offset = mFmodD( offset, voice.mDesc.mSampleCount );
+        return offset;
+    }
+
+    virtual void play( U32 slot, const AudioVoice& voice, U32 offset )
+    {
+        AudioNullVoiceDevice::play( slot, voice, offset );
+        if ( offset == 0 )
+            return;
+
+        F64 error = mFabsD( getExpectedOffset( voice, mTime ) - offset );
+        if ( voice.mDesc.mIsLooping )
+            error = getMin( error, voice.mDesc.mSampleCount - error );
+        mMaxResumeError = getMax( mMaxResumeError, error );
+        mResumes++;
+    }
+};
+
+static AudioVoiceDesc makeTestVoiceDesc( RandomLCG& random, S32 priority )
+{
+    AudioVoiceDesc desc;
+    desc.mSampleRate = AUDIOVOICE_UNITTEST_SAMPLE_RATE;
+    desc.mSampleCount = (U32)(random.randRangeF( 0.5f, 20.0f ) * AUDIOVOICE_UNITTEST_SAMPLE_RATE);
+    desc.mIsLooping = random.randF() < 0.75f;
+    desc.mIs3D = true;
+    desc.mReferenceDistance = 5.0f;
+    desc.mMaxDistance = 100.0f;
+    desc.mVolume = random.randRangeF( 0.2f, 1.0f );
+    desc.mPriority = priority;
+    return desc;
+}
+
+static Point3F getTestListener( U32 update )
+{
+    F32 angle = update * 0.02f;
+    return Point3F( mCos( angle ) * 120.0f, mSin( angle ) * 120.0f, 0.0f );
+}
+
+//-----------------------------------------------------------------------------
+
+TEST( AudioVoiceSchedulerTests, stealTest )
+{
+    AudioNullVoiceDevice device( 4 );
+    AudioVoiceScheduler scheduler;
+    scheduler.setDevice( &device );
+
+    AudioVoiceDesc desc;
+    desc.mSampleCount = AUDIOVOICE_UNITTEST_SAMPLE_RATE * 10;
+    desc.mIsLooping = true;
+    desc.mVolume = 0.5f;
+
+    AUDIOVOICE quiet[4];
+    for ( U32 i = 0; i < 4; ++i )
+        quiet[i] = scheduler.play( desc, Point3F::Zero );
+    EXPECT_EQ( scheduler.getRealVoiceCount(), 4 );
+
+    // Louder than the others but not by much, waits for the next update.
+    desc.mVolume = 0.52f;
+    AUDIOVOICE close = scheduler.play( desc, Point3F::Zero );
+    EXPECT_TRUE( scheduler.isVirtual( close ) );
+    EXPECT_EQ( scheduler.getStealCount(), 0 );
+
+    // A higher priority takes a real voice right away.
+    desc.mPriority = 1;
+    desc.mVolume = 0.1f;
+    AUDIOVOICE important = scheduler.play( desc, Point3F::Zero );
+    EXPECT_FALSE( scheduler.isVirtual( important ) );
+    EXPECT_EQ( scheduler.getStealCount(), 1 );
+
+    // Play a second, then make one of the quiet voices the loudest.
+    device.advance( 1.0f );
+    scheduler.update( 1.0f, Point3F::Zero );
+
+    U32 victim = 0;
+    for ( U32 i = 0; i < 4; ++i )
+    {
+        if ( scheduler.isVirtual( quiet[i] ) )
+            victim = i;
+    }
+    EXPECT_EQ( scheduler.getOffset( quiet[victim] ), AUDIOVOICE_UNITTEST_SAMPLE_RATE );
+
+    scheduler.setVolume( quiet[victim], 1.0f );
+    device.advance( 0.5f );
+    scheduler.update( 0.5f, Point3F::Zero );
+    EXPECT_FALSE( scheduler.isVirtual( quiet[victim] ) );
+    EXPECT_FALSE( scheduler.isVirtual( important ) );
+    EXPECT_EQ( scheduler.getOffset( quiet[victim] ), AUDIOVOICE_UNITTEST_SAMPLE_RATE * 3 / 2 );
+    EXPECT_EQ( scheduler.getRealVoiceCount(), 4 );
+
+    // Paused voices hand their real voice over and resume where they left.
+    scheduler.pause( important );
+    EXPECT_TRUE( scheduler.isVirtual( important ) );
+    device.advance( 2.0f );
+    scheduler.update( 2.0f, Point3F::Zero );
+    EXPECT_EQ( scheduler.getRealVoiceCount(), 4 );
+    EXPECT_EQ( scheduler.getOffset( important ), AUDIOVOICE_UNITTEST_SAMPLE_RATE * 3 / 2 );
+    scheduler.resume( important );
+    EXPECT_FALSE( scheduler.isVirtual( important ) );
+
+    // A virtual one-shot ends on time.
+    desc.mPriority = 0;
+    desc.mVolume = 0.01f;
+    desc.mIsLooping = false;
+    desc.mSampleCount = AUDIOVOICE_UNITTEST_SAMPLE_RATE;
+    AUDIOVOICE oneShot = scheduler.play( desc, Point3F::Zero );
+    EXPECT_TRUE( scheduler.isVirtual( oneShot ) );
+    scheduler.update( 0.75f, Point3F::Zero );
+    EXPECT_TRUE( scheduler.isValid( oneShot ) );
+    scheduler.update( 0.5f, Point3F::Zero );
+    EXPECT_FALSE( scheduler.isValid( oneShot ) );
+
+    scheduler.stopAll();
+    EXPECT_EQ( scheduler.getVoiceCount(), 0 );
+    EXPECT_EQ( scheduler.getRealVoiceCount(), 0 );
+    EXPECT_EQ( device.mPlayCount, device.mStopCount );
+}
+
+//-----------------------------------------------------------------------------
+
+// Null device whose slots can be lent to something else, the way audio.cc
+// shares its sources with loopers and streams.
+class AudioVoiceLendingDevice : public AudioNullVoiceDevice
+{
+public:
+    bool mLent[4];
+
+    AudioVoiceLendingDevice() : AudioNullVoiceDevice( 4 ) { dMemset( mLent, 0, sizeof(mLent) ); }
+
+    virtual bool isAvailable( U32 slot ) { return !mLent[slot]; }
+};
+
+TEST( AudioVoiceSchedulerTests, lentSlotTest )
+{
+    AudioVoiceLendingDevice device;
+    device.mLent[0] = true;
+    device.mLent[1] = true;
+
+    AudioVoiceScheduler scheduler;
+    scheduler.setDevice( &device );
+
+    AudioVoiceDesc desc;
+    desc.mSampleCount = AUDIOVOICE_UNITTEST_SAMPLE_RATE * 10;
+    desc.mIsLooping = true;
+
+    AUDIOVOICE voices[4];
+    for ( U32 i = 0; i < 4; ++i )
+        voices[i] = scheduler.play( desc, Point3F::Zero );
+
+    // Lent slots are left alone.
+    EXPECT_EQ( scheduler.getRealVoiceCount(), 2 );
+    EXPECT_TRUE( scheduler.getSlotVoice( 0 ) == NULL );
+    EXPECT_TRUE( scheduler.getSlotVoice( 1 ) == NULL );
+    scheduler.update( 0.5f, Point3F::Zero );
+    EXPECT_EQ( scheduler.getRealVoiceCount(), 2 );
+
+    // Taking one back makes its voice virtual until the slot is returned.
+    const AudioVoice* evicted = scheduler.getSlotVoice( 2 );
+    ASSERT_TRUE( evicted != NULL );
+    const U32 index = evicted->mIndex;
+    device.mLent[2] = true;
+    scheduler.evict( 2 );
+    EXPECT_TRUE( scheduler.getSlotVoice( 2 ) == NULL );
+    EXPECT_EQ( scheduler.getRealVoiceCount(), 1 );
+
+    scheduler.update( 0.5f, Point3F::Zero );
+    EXPECT_EQ( scheduler.getRealVoiceCount(), 1 );
+
+    dMemset( device.mLent, 0, sizeof(device.mLent) );
+    scheduler.update( 0.5f, Point3F::Zero );
+    EXPECT_EQ( scheduler.getRealVoiceCount(), 4 );
+    for ( U32 i = 0; i < 4; ++i )
+    {
+        if ( scheduler.getVoice( voices[i] )->mIndex == index )
+        {
+            EXPECT_EQ( scheduler.getOffset( voices[i] ), AUDIOVOICE_UNITTEST_SAMPLE_RATE );
+        }
+    }
+
+    // Every slot is lent, nothing plays but the voices keep time.
+    for ( U32 i = 0; i < 4; ++i )
+        device.mLent[i] = true;
+    for ( U32 i = 0; i < 4; ++i )
+        scheduler.evict( i );
+    EXPECT_EQ( scheduler.getRealVoiceCount(), 0 );
+    EXPECT_TRUE( scheduler.isVirtual( scheduler.play( desc, Point3F::Zero ) ) );
+    scheduler.update( 0.5f, Point3F::Zero );
+    EXPECT_EQ( scheduler.getRealVoiceCount(), 0 );
+    EXPECT_EQ( scheduler.getVoiceCount(), 5 );
+
+    scheduler.stopAll();
+    EXPECT_EQ( device.mPlayCount, device.mStopCount );
+}
+
+//-----------------------------------------------------------------------------
+
+TEST( AudioVoiceSchedulerTests, resumeTest )
+{
+    AudioVoiceTestDevice device( AUDIOVOICE_UNITTEST_REAL_VOICES );
+    AudioVoiceScheduler scheduler;
+    scheduler.setDevice( &device );
+
+    RandomLCG random( 1234 );
+    Vector<AUDIOVOICE> handles;
+    Vector<AudioVoiceDesc> descs;
+    Vector<Point3F> positions;
+    for ( U32 i = 0; i < AUDIOVOICE_UNITTEST_VOICES; ++i )
+    {
+        descs.push_back( makeTestVoiceDesc( random, i % 4 ) );
+        positions.push_back( Point3F( random.randRangeF( -AUDIOVOICE_UNITTEST_AREA, AUDIOVOICE_UNITTEST_AREA ) * 0.5f,
+                                      random.randRangeF( -AUDIOVOICE_UNITTEST_AREA, AUDIOVOICE_UNITTEST_AREA ) * 0.5f, 0.0f ) );
+        handles.push_back( scheduler.play( descs.last(), positions.last() ) );
+        ASSERT_NE( handles.last(), NULL_AUDIOVOICE );
+    }
+    EXPECT_EQ( scheduler.getVoiceCount(), AUDIOVOICE_UNITTEST_VOICES );
+
+    // Walk the listener around, the real voices keep changing hands.
+    U32 misranked = 0;
+    for ( U32 update = 1; update <= AUDIOVOICE_UNITTEST_UPDATES; ++update )
+    {
+        device.advance( AUDIOVOICE_UNITTEST_UPDATE );
+        device.mTime += AUDIOVOICE_UNITTEST_UPDATE;
+        const Point3F listener = getTestListener( update );
+        scheduler.update( AUDIOVOICE_UNITTEST_UPDATE, listener );
+
+        // No audible virtual voice may outrank a real one by priority.
+        S32 lowestReal = AudioVoiceScheduler::MaxPriority;
+        S32 highestVirtual = -1;
+        for ( U32 i = 0; i < handles.size(); ++i )
+        {
+            if ( !scheduler.isValid( handles[i] ) )
+                continue;
+
+            if ( !scheduler.isVirtual( handles[i] ) )
+            {
+                lowestReal = getMin( lowestReal, descs[i].mPriority );
+                continue;
+            }
+
+            F32 dist = ( positions[i] - listener ).len();
+            if ( dist < descs[i].mMaxDistance * 0.9f )
+                highestVirtual = getMax( highestVirtual, descs[i].mPriority );
+        }
+        misranked += highestVirtual > lowestReal;
+    }
+    EXPECT_EQ( misranked, 0 );
+    EXPECT_EQ( scheduler.getRealVoiceCount(), AUDIOVOICE_UNITTEST_REAL_VOICES );
+
+    // Every voice, real or virtual, is where it would be had it never stopped.
+    const F64 time = device.mTime;
+    U32 ended = 0;
+    U32 wrong = 0;
+    for ( U32 i = 0; i < handles.size(); ++i )
+    {
+        const F64 length = (F64)descs[i].mSampleCount / descs[i].mSampleRate;
+        if ( !descs[i].mIsLooping && time >= length )
+        {
+            ended += !scheduler.isValid( handles[i] );
+            continue;
+        }
+
+        AudioVoice voice;
+        voice.mDesc = descs[i];
+        voice.mPitch = 1.0f;
+        F64 error = mFabsD( AudioVoiceTestDevice::getExpectedOffset( voice, time ) - scheduler.getOffset( handles[i] ) );
+        if ( descs[i].mIsLooping )
+            error = getMin( error, descs[i].mSampleCount - error );
+        wrong += error > 32.0;
+    }
+
+    U32 oneShots = 0;
+    for ( U32 i = 0; i < descs.size(); ++i )
+        oneShots += !descs[i].mIsLooping && time >= (F64)descs[i].mSampleCount / descs[i].mSampleRate;
+
+    EXPECT_EQ( ended, oneShots );
+    EXPECT_EQ( wrong, 0 );
+    EXPECT_GT( device.mResumes, 0 );
+    EXPECT_LE( device.mMaxResumeError, 32.0 );
+    EXPECT_EQ( scheduler.getVoiceCount(), AUDIOVOICE_UNITTEST_VOICES - oneShots );
+}
+
+//-----------------------------------------------------------------------------
+
+TEST( AudioVoiceSchedulerTests, updateBenchmarkTest )
+{
+    AudioNullVoiceDevice device( AUDIOVOICE_UNITTEST_REAL_VOICES );
+    AudioVoiceScheduler scheduler;
+    scheduler.setDevice( &device );
+
+    RandomLCG random( 4321 );
+    for ( U32 i = 0; i < AUDIOVOICE_UNITTEST_VOICES; ++i )
+    {
+        AudioVoiceDesc desc = makeTestVoiceDesc( random, i % 4 );
+        desc.mIsLooping = true;
+        scheduler.play( desc, Point3F( random.randRangeF( -AUDIOVOICE_UNITTEST_AREA, AUDIOVOICE_UNITTEST_AREA ) * 0.5f,
+                                       random.randRangeF( -AUDIOVOICE_UNITTEST_AREA, AUDIOVOICE_UNITTEST_AREA ) * 0.5f, 0.0f ) );
+    }
+
+    U32 startTime = Platform::getRealMilliseconds();
+    for ( U32 update = 1; update <= AUDIOVOICE_UNITTEST_UPDATES; ++update )
+    {
+        device.advance( AUDIOVOICE_UNITTEST_UPDATE );
+        scheduler.update( AUDIOVOICE_UNITTEST_UPDATE, getTestListener( update ) );
+    }
+    const U32 updateTime = Platform::getRealMilliseconds() - startTime;
+
+    EXPECT_EQ( scheduler.getRealVoiceCount(), AUDIOVOICE_UNITTEST_REAL_VOICES );
+
+    Con::printf( "AudioVoiceScheduler: %d voices on %d real voices, %.3fms per update, %d steals over %d updates.",
+        AUDIOVOICE_UNITTEST_VOICES, AUDIOVOICE_UNITTEST_REAL_VOICES, (F32)updateTime / AUDIOVOICE_UNITTEST_UPDATES,
+        scheduler.getStealCount(), AUDIOVOICE_UNITTEST_UPDATES );
+}
+
+#endif // TORQUE_SHIPPING
@@ -0,0 +1,363 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2013 GarageGames, LLC
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//-----------------------------------------------------------------------------
+
+
+// We don't want tests in a shipping version.
+#ifndef TORQUE_SHIPPING
+
+#ifndef _UNIT_TESTING_H_
+#include "testing/unitTesting.h"
+#endif
+
+#ifndef _PLATFORM_H_
+#include "platform/platform.h"
+#endif
+
+#ifndef _JOB_SYSTEM_H_
+#include "platform/threads/jobSystem.h"
+#endif
+
+#ifndef _JOB_SYSTEM_TEST_SCOPE_H_
+#include "testing/jobSystemTestScope.h"
+#endif
+
+#ifndef _CUBEMAP_FILTER_H_
+#include "lighting/cubemapFilter.h"
+#endif
+
+#ifndef _CONSOLE_H_
+#include "console/console.h"
+#endif
+
+//-----------------------------------------------------------------------------
+
+#define CUBEMAPFILTER_UNITTEST_SOURCESIZE    32
+#define CUBEMAPFILTER_UNITTEST_DESTSIZE      8
+#define CUBEMAPFILTER_UNITTEST_SAMPLES       64
+#define CUBEMAPFILTER_UNITTEST_ROUGHNESS     0.5f
+
+//-----------------------------------------------------------------------------
+
+using namespace Lighting;
+
+typedef Point3F (*CubemapFilterTestFunction)( const Point3F& dir );
+
+static F32 cubemapFilterTexelCenter( U32 x, U32 size )
+{
+    return (2.0f * x + 1.0f) / size - 1.0f;
+}
+
+static void fillCubemap( CubemapImage& image, CubemapFilterTestFunction function )
+{
+    const U32 size = image.getSize();
+    for ( U32 face = 0; face < 6; ++face )
+    {
+        F32* texels = image.getFace( face );
+        for ( U32 y = 0; y < size; ++y )
+        {
+            for ( U32 x = 0; x < size; ++x, texels += 4 )
+            {
+                Point3F color = function( texelCoordToVec( Point2F( cubemapFilterTexelCenter( x, size ), cubemapFilterTexelCenter( y, size ) ), face ) );
+                texels[0] = color.x;
+                texels[1] = color.y;
+                texels[2] = color.z;
+                texels[3] = 1.0f;
+            }
+        }
+    }
+    image.buildMips();
+}
+
+// Brute force integral over every source texel, weight(L) * dOmega.
+template<typename Weight>
+static Point3F integrateCubemap( const CubemapImage& image, const Weight& weight )
+{
+    const U32 size = image.getSize();
+    F64 sum[3] = { 0.0, 0.0, 0.0 };
+    F64 total = 0.0;
+
+    for ( U32 face = 0; face < 6; ++face )
+    {
+        const F32* texels = image.getFace( face );
+        for ( U32 y = 0; y < size; ++y )
+        {
+            for ( U32 x = 0; x < size; ++x, texels += 4 )
+            {
+                F32 u = cubemapFilterTexelCenter( x, size );
+                F32 v = cubemapFilterTexelCenter( y, size );
+                F32 t = 1.0f + u * u + v * v;
+                F64 w = weight( texelCoordToVec( Point2F( u, v ), face ) ) * 4.0 / (t * mSqrt( t ) * size * size);
+
+                sum[0] += texels[0] * w;
+                sum[1] += texels[1] * w;
+                sum[2] += texels[2] * w;
+                total += w;
+            }
+        }
+    }
+
+    return Point3F( (F32)(sum[0] / weight.normalize( total )), (F32)(sum[1] / weight.normalize( total )), (F32)(sum[2] / weight.normalize( total )) );
+}
+
+// What prefilterGGX() estimates: radiance weighted by NdotL and the GGX
+// distribution of the half vector.
+struct CubemapFilterGGXWeight
+{
+    Point3F N;
+    F32     a2;
+
+    F64 operator()( const Point3F& L ) const
+    {
+        F32 NoL = mDot( N, L );
+        if ( NoL <= 0.0f )
+            return 0.0;
+
+        Point3F H = N + L;
+        H.normalize();
+        F32 NoH = mDot( N, H );
+        F32 d = (a2 - 1.0f) * NoH * NoH + 1.0f;
+        return NoL * a2 / (M_PI_F * d * d);
+    }
+
+    F64 normalize( F64 total ) const { return total; }
+};
+
+// Cosine convolution divided by pi.
+struct CubemapFilterLambertWeight
+{
+    Point3F N;
+
+    F64 operator()( const Point3F& L ) const { return getMax( mDot( N, L ), 0.0f ); }
+    F64 normalize( F64 total ) const { return M_PI; }
+};
+
+static Point3F cubemapFilterConstant( const Point3F& dir )
+{
+    return Point3F( 0.25f, 0.5f, 0.75f );
+}
+
+// Sky gradient with a bright sun and detail a few texels wide, which point
+// sampling with few samples aliases.
+static Point3F cubemapFilterSky( const Point3F& dir )
+{
+    Point3F sunDir( 0.3f, 0.8f, 0.52f );
+    sunDir.normalize();
+    F32 sun = 8.0f * mPow( getMax( mDot( dir, sunDir ), 0.0f ), 64.0f );
+    F32 sky = 0.5f + 0.5f * dir.y + 0.4f * mSin( 37.0f * dir.x ) * mSin( 41.0f * dir.y ) * mSin( 43.0f * dir.z );
+    return Point3F( 0.2f * sky + sun, 0.4f * sky + sun, 0.8f * sky + 0.9f * sun );
+}
+
+// Order 2 polynomial, exactly representable by 9 SH coefficients.
+static Point3F cubemapFilterPolynomial( const Point3F& dir )
+{
+    return Point3F( 1.0f + 0.5f * dir.y, 0.5f + 0.3f * dir.x * dir.x, 0.8f + 0.2f * dir.x * dir.z - 0.4f * dir.z );
+}
+
+static F32 cubemapFilterError( const Point3F& a, const Point3F& b )
+{
+    Point3F delta = a - b;
+    return delta.len() / getMax( b.len(), 0.001f );
+}
+
+//-----------------------------------------------------------------------------
+
+TEST( CubemapFilterTests, faceMappingTest )
+{
+    // Texel centers map to directions and back to the same face and uv.
+    const U32 size = 16;
+    U32 mismatches = 0;
+    for ( U32 face = 0; face < 6; ++face )
+    {
+        for ( U32 y = 0; y < size; ++y )
+        {
+            for ( U32 x = 0; x < size; ++x )
+            {
+                Point2F uv( cubemapFilterTexelCenter( x, size ), cubemapFilterTexelCenter( y, size ) );
+                U32 resultFace;
+                Point2F resultUV;
+                vecToTexelCoord( texelCoordToVec( uv, face ), resultFace, resultUV );
+
+                if ( resultFace != face ||
+                     mFabs( resultUV.x * 2.0f - 1.0f - uv.x ) > 0.0001f ||
+                     mFabs( resultUV.y * 2.0f - 1.0f - uv.y ) > 0.0001f )
+                    mismatches++;
+            }
+        }
+    }
+    EXPECT_EQ( mismatches, 0 );
+}
+
+//-----------------------------------------------------------------------------
+
+TEST( CubemapFilterTests, constantTest )
+{
+    JobSystemTestScope scope;
+
+    CubemapImage source, radiance, irradiance;
+    source.init( CUBEMAPFILTER_UNITTEST_SOURCESIZE );
+    radiance.init( CUBEMAPFILTER_UNITTEST_SOURCESIZE, 6 );
+    irradiance.init( CUBEMAPFILTER_UNITTEST_DESTSIZE, 1 );
+    fillCubemap( source, cubemapFilterConstant );
+
+    // Every mip of a constant environment stays constant, all four
+    // channels included.
+    prefilterRadiance( source, radiance, CUBEMAPFILTER_UNITTEST_SAMPLES );
+    F32 maxError = 0.0f;
+    for ( U32 mip = 0; mip < radiance.getMipCount(); ++mip )
+    {
+        const U32 count = radiance.getSize( mip ) * radiance.getSize( mip ) * 6;
+        const F32* texels = radiance.getFace( 0, mip );
+        for ( U32 i = 0; i < count; ++i, texels += 4 )
+        {
+            maxError = getMax( maxError, mFabs( texels[0] - 0.25f ) );
+            maxError = getMax( maxError, mFabs( texels[1] - 0.5f ) );
+            maxError = getMax( maxError, mFabs( texels[2] - 0.75f ) );
+            maxError = getMax( maxError, mFabs( texels[3] - 1.0f ) );
+        }
+    }
+    EXPECT_LT( maxError, 0.0001f ) << "Constant radiance changed by prefiltering.";
+
+    IrradianceSH sh;
+    projectIrradianceSH( source, sh );
+    renderIrradiance( sh, irradiance );
+    maxError = 0.0f;
+    const F32* texels = irradiance.getFace( 0 );
+    for ( U32 i = 0; i < CUBEMAPFILTER_UNITTEST_DESTSIZE * CUBEMAPFILTER_UNITTEST_DESTSIZE * 6; ++i, texels += 4 )
+    {
+        maxError = getMax( maxError, mFabs( texels[0] - 0.25f ) );
+        maxError = getMax( maxError, mFabs( texels[1] - 0.5f ) );
+        maxError = getMax( maxError, mFabs( texels[2] - 0.75f ) );
+    }
+    EXPECT_LT( maxError, 0.0001f ) << "Constant irradiance changed by the SH projection.";
+}
+
+//-----------------------------------------------------------------------------
+
+TEST( CubemapFilterTests, prefilterReferenceTest )
+{
+    JobSystemTestScope scope;
+
+    CubemapImage source, radiance;
+    source.init( CUBEMAPFILTER_UNITTEST_SOURCESIZE );
+    radiance.init( CUBEMAPFILTER_UNITTEST_DESTSIZE, 1 );
+    fillCubemap( source, cubemapFilterSky );
+
+    prefilterGGX( source, radiance, 0, CUBEMAPFILTER_UNITTEST_ROUGHNESS, CUBEMAPFILTER_UNITTEST_SAMPLES );
+
+    // Reference image: the integral over every source texel.
+    CubemapFilterGGXWeight weight;
+    F32 a = CUBEMAPFILTER_UNITTEST_ROUGHNESS * CUBEMAPFILTER_UNITTEST_ROUGHNESS;
+    weight.a2 = a * a;
+
+    const U32 size = CUBEMAPFILTER_UNITTEST_DESTSIZE;
+    F32 maxError = 0.0f;
+    F32 meanError = 0.0f;
+    for ( U32 face = 0; face < 6; ++face )
+    {
+        const F32* texels = radiance.getFace( face );
+        for ( U32 y = 0; y < size; ++y )
+        {
+            for ( U32 x = 0; x < size; ++x, texels += 4 )
+            {
+                weight.N = texelCoordToVec( Point2F( cubemapFilterTexelCenter( x, size ), cubemapFilterTexelCenter( y, size ) ), face );
+                Point3F expected = integrateCubemap( source, weight );
+                F32 error = cubemapFilterError( Point3F( texels[0], texels[1], texels[2] ), expected );
+                maxError = getMax( maxError, error );
+                meanError += error;
+            }
+        }
+    }
+    meanError /= size * size * 6;
+
+    Con::printf( "CubemapFilter: GGX prefilter with %d samples, mean error %.2f%%, max %.2f%%.",
+        CUBEMAPFILTER_UNITTEST_SAMPLES, meanError * 100.0f, maxError * 100.0f );
+    EXPECT_LT( meanError, 0.03f );
+    EXPECT_LT( maxError, 0.15f );
+}
+
+//-----------------------------------------------------------------------------
+
+TEST( CubemapFilterTests, irradianceReferenceTest )
+{
+    JobSystemTestScope scope;
+
+    CubemapImage source, irradiance;
+    source.init( CUBEMAPFILTER_UNITTEST_SOURCESIZE );
+    irradiance.init( CUBEMAPFILTER_UNITTEST_DESTSIZE, 1 );
+    fillCubemap( source, cubemapFilterPolynomial );
+
+    IrradianceSH sh;
+    projectIrradianceSH( source, sh );
+    renderIrradiance( sh, irradiance );
+
+    CubemapFilterLambertWeight weight;
+    const U32 size = CUBEMAPFILTER_UNITTEST_DESTSIZE;
+    F32 maxError = 0.0f;
+    for ( U32 face = 0; face < 6; ++face )
+    {
+        const F32* texels = irradiance.getFace( face );
+        for ( U32 y = 0; y < size; ++y )
+        {
+            for ( U32 x = 0; x < size; ++x, texels += 4 )
+            {
+                weight.N = texelCoordToVec( Point2F( cubemapFilterTexelCenter( x, size ), cubemapFilterTexelCenter( y, size ) ), face );
+                Point3F expected = integrateCubemap( source, weight );
+                maxError = getMax( maxError, cubemapFilterError( Point3F( texels[0], texels[1], texels[2] ), expected ) );
+            }
+        }
+    }
+
+    EXPECT_LT( maxError, 0.01f ) << "SH irradiance doesn't match the cosine convolution.";
+}
+
+//-----------------------------------------------------------------------------
+
+TEST( CubemapFilterTests, benchmarkTest )
+{
+    JobSystemTestScope scope;
+
+    const U32 sizes[] = { 128, 256, 512 };
+    for ( U32 n = 0; n < 3; ++n )
+    {
+        CubemapImage source, radiance, irradiance;
+        source.init( sizes[n] );
+        radiance.init( sizes[n], 6 );
+        irradiance.init( sizes[n] / 4, 1 );
+        fillCubemap( source, cubemapFilterSky );
+
+        U32 startTime = Platform::getRealMilliseconds();
+        source.buildMips();
+        prefilterRadiance( source, radiance, CUBEMAPFILTER_UNITTEST_SAMPLES );
+        const U32 radianceTime = Platform::getRealMilliseconds() - startTime;
+
+        startTime = Platform::getRealMilliseconds();
+        IrradianceSH sh;
+        projectIrradianceSH( source, sh );
+        renderIrradiance( sh, irradiance );
+        const U32 irradianceTime = Platform::getRealMilliseconds() - startTime;
+
+        Con::printf( "CubemapFilter: %d face size, radiance (%d mips, %d samples) %dms, SH irradiance %dms, %d workers.",
+            sizes[n], radiance.getMipCount(), CUBEMAPFILTER_UNITTEST_SAMPLES, radianceTime, irradianceTime, JobSystem::getWorkerCount() );
+    }
+}
+
+#endif // TORQUE_SHIPPING
@@ -0,0 +1,279 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2013 GarageGames, LLC
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//-----------------------------------------------------------------------------
+
+// We don't want tests in a shipping version.
+#ifndef TORQUE_SHIPPING
+
+#ifndef _UNIT_TESTING_H_
+#include "testing/unitTesting.h"
+#endif
+
+#ifndef _PLATFORM_H_
+#include "platform/platform.h"
+#endif
+
+#ifndef _JOB_SYSTEM_H_
+#include "platform/threads/jobSystem.h"
+#endif
+
+#ifndef _JOB_SYSTEM_TEST_SCOPE_H_
+#include "testing/jobSystemTestScope.h"
+#endif
+
+#ifndef _MMATHFN_H_
+#include "math/mMathFn.h"
+#endif
+
+#ifndef _CONSOLE_H_
+#include "console/console.h"
+#endif
+
+//-----------------------------------------------------------------------------
+
+#define JOBSYSTEM_UNITTEST_RANGE          100000
+#define JOBSYSTEM_UNITTEST_ROOTJOBS       2000
+#define JOBSYSTEM_UNITTEST_CHILDJOBS      8
+#define JOBSYSTEM_UNITTEST_BENCHJOBS      100000
+#define JOBSYSTEM_UNITTEST_BENCHRANGE     (1 << 20)
+
+//-----------------------------------------------------------------------------
+
+static void markRangeJob( void* data, U32 first, U32 count )
+{
+    U8* marks = (U8*)data;
+    for( U32 index = first; index < first + count; ++index )
+        marks[index]++;
+}
+
+static void countJob( void* data, U32 first, U32 count )
+{
+    JobSystem::atomicAdd( (volatile S32*)data, 1 );
+}
+
+struct ContinuationTestData
+{
+    volatile S32    mCount;
+    S32             mSeen;
+};
+
+static void incrementJob( void* data, U32 first, U32 count )
+{
+    JobSystem::atomicAdd( &((ContinuationTestData*)data)->mCount, 1 );
+}
+
+static void continuationJob( void* data, U32 first, U32 count )
+{
+    ContinuationTestData* test = (ContinuationTestData*)data;
+    test->mSeen = test->mCount;
+}
+
+//-----------------------------------------------------------------------------
+
+TEST( JobSystemTests, parallelForCoversRangeTest )
+{
+    JobSystemTestScope scope;
+
+    U8* marks = new U8[JOBSYSTEM_UNITTEST_RANGE];
+    dMemset( marks, 0, JOBSYSTEM_UNITTEST_RANGE );
+
+    JobCounter counter;
+    JobSystem::parallelFor( JOBSYSTEM_UNITTEST_RANGE, 64, markRangeJob, marks, &counter );
+    JobSystem::wait( counter );
+
+    for( U32 index = 0; index < JOBSYSTEM_UNITTEST_RANGE; ++index )
+        ASSERT_EQ( 1, marks[index] ) << "parallelFor didn't visit every index exactly once.";
+
+    delete [] marks;
+}
+
+//-----------------------------------------------------------------------------
+
+TEST( JobSystemTests, continuationTest )
+{
+    JobSystemTestScope scope;
+
+    ContinuationTestData data;
+    data.mCount = 0;
+    data.mSeen = -1;
+
+    JobCounter group;
+    JobCounter continuation;
+    for( U32 index = 0; index < 16; ++index )
+        JobSystem::submit( incrementJob, &data, &group );
+    JobSystem::addContinuation( group, continuationJob, &data, &continuation );
+    JobSystem::wait( continuation );
+
+    ASSERT_TRUE( group.isDone() ) << "Continuation finished before its group.";
+    ASSERT_EQ( 16, data.mSeen ) << "Continuation ran before every job of its group finished.";
+}
+
+//-----------------------------------------------------------------------------
+
+struct StressTestData
+{
+    JobCounter      mCounter;
+    JobCounter      mMainThreadCounter;
+    volatile S32    mRoots;
+    volatile S32    mExecuted;
+    volatile S32    mMainThread;
+    volatile S32    mScratchErrors;
+};
+
+static void stressMainThreadJob( void* data, U32 first, U32 count )
+{
+    StressTestData* test = (StressTestData*)data;
+    if ( JobSystem::getThreadIndex() == 0 )
+        JobSystem::atomicAdd( &test->mMainThread, 1 );
+    JobSystem::atomicAdd( &test->mExecuted, 1 );
+}
+
+static void stressChildJob( void* data, U32 first, U32 count )
+{
+    StressTestData* test = (StressTestData*)data;
+
+    // Scratch memory must be private to the thread running the job.
+    const U32 size = 1024;
+    U8* scratch = (U8*)JobSystem::getScratch().alloc( size );
+    const U8 pattern = (U8)(JobSystem::getThreadIndex() + 1);
+    dMemset( scratch, pattern, size );
+    for( U32 index = 0; index < size; ++index )
+    {
+        if ( scratch[index] != pattern )
+        {
+            JobSystem::atomicAdd( &test->mScratchErrors, 1 );
+            break;
+        }
+    }
+
+    JobSystem::atomicAdd( &test->mExecuted, 1 );
+}
+
+static void stressRootJob( void* data, U32 first, U32 count )
+{
+    StressTestData* test = (StressTestData*)data;
+
+    // Jobs spawned from jobs, and now and then one for the main thread.
+    for( U32 index = 0; index < JOBSYSTEM_UNITTEST_CHILDJOBS; ++index )
+        JobSystem::submit( stressChildJob, test, &test->mCounter );
+
+    if ( (JobSystem::atomicAdd( &test->mRoots, 1 ) % 100) == 0 )
+        JobSystem::submitMainThread( stressMainThreadJob, test, &test->mMainThreadCounter );
+
+    JobSystem::atomicAdd( &test->mExecuted, 1 );
+}
+
+TEST( JobSystemTests, stressTest )
+{
+    JobSystemTestScope scope;
+
+    StressTestData data;
+    data.mRoots = 0;
+    data.mExecuted = 0;
+    data.mMainThread = 0;
+    data.mScratchErrors = 0;
+
+    for( U32 index = 0; index < JOBSYSTEM_UNITTEST_ROOTJOBS; ++index )
+        JobSystem::submit( stressRootJob, &data, &data.mCounter );
+    JobSystem::wait( data.mCounter );
+
+    // Every root has run, so the main thread jobs are all queued. Waiting
+    // mustn't have run them.
+    const S32 mainThreadJobs = JOBSYSTEM_UNITTEST_ROOTJOBS / 100;
+    ASSERT_EQ( mainThreadJobs, data.mMainThreadCounter.getPending() ) << "Main thread jobs ran outside processMainThreadJobs().";
+    JobSystem::processMainThreadJobs();
+    ASSERT_TRUE( data.mMainThreadCounter.isDone() ) << "processMainThreadJobs() left queued jobs.";
+
+    ASSERT_EQ( JOBSYSTEM_UNITTEST_ROOTJOBS * (1 + JOBSYSTEM_UNITTEST_CHILDJOBS) + mainThreadJobs, data.mExecuted ) << "Jobs were lost or run twice.";
+    ASSERT_EQ( mainThreadJobs, data.mMainThread ) << "Main thread job ran on a worker.";
+    ASSERT_EQ( 0, data.mScratchErrors ) << "Scratch memory was shared between threads.";
+}
+
+//-----------------------------------------------------------------------------
+
+static void sleepJob( void* data, U32 first, U32 count )
+{
+    Platform::sleep( 20 );
+    JobSystem::atomicAdd( (volatile S32*)data, 1 );
+}
+
+TEST( JobSystemTests, blockingWaitTest )
+{
+    JobSystemTestScope scope( 2 );
+
+    // Nothing to help with, the main thread blocks until the workers are done.
+    volatile S32 executed = 0;
+    JobCounter counter;
+    for( U32 index = 0; index < 4; ++index )
+        JobSystem::submit( sleepJob, (void*)&executed, &counter );
+    JobSystem::wait( counter );
+
+    ASSERT_TRUE( counter.isDone() );
+    ASSERT_EQ( 4, executed ) << "Wait returned before its jobs finished.";
+}
+
+//-----------------------------------------------------------------------------
+
+static void sqrtRangeJob( void* data, U32 first, U32 count )
+{
+    F32* values = (F32*)data;
+    for( U32 index = first; index < first + count; ++index )
+        values[index] = mSqrt( (F32)index ) * mSin( (F32)index );
+}
+
+TEST( JobSystemTests, schedulerBenchmarkTest )
+{
+    JobSystemTestScope scope;
+
+    // Overhead of single empty jobs.
+    volatile S32 executed = 0;
+    U32 startTime = Platform::getRealMilliseconds();
+    JobCounter counter;
+    for( U32 index = 0; index < JOBSYSTEM_UNITTEST_BENCHJOBS; ++index )
+        JobSystem::submit( countJob, (void*)&executed, &counter );
+    JobSystem::wait( counter );
+    const U32 submitTime = Platform::getRealMilliseconds() - startTime;
+    ASSERT_EQ( JOBSYSTEM_UNITTEST_BENCHJOBS, executed ) << "Benchmark jobs were lost.";
+
+    // Serial against parallel over the same range.
+    F32* serial = new F32[JOBSYSTEM_UNITTEST_BENCHRANGE];
+    F32* parallel = new F32[JOBSYSTEM_UNITTEST_BENCHRANGE];
+
+    startTime = Platform::getRealMilliseconds();
+    sqrtRangeJob( serial, 0, JOBSYSTEM_UNITTEST_BENCHRANGE );
+    const U32 serialTime = Platform::getRealMilliseconds() - startTime;
+
+    startTime = Platform::getRealMilliseconds();
+    JobSystem::parallelFor( JOBSYSTEM_UNITTEST_BENCHRANGE, 0, sqrtRangeJob, parallel, &counter );
+    JobSystem::wait( counter );
+    const U32 parallelTime = Platform::getRealMilliseconds() - startTime;
+
+    Con::printf( "JobSystem: %d workers. %d empty jobs: %dms. parallelFor over %d items: serial %dms, parallel %dms.",
+        JobSystem::getWorkerCount(), JOBSYSTEM_UNITTEST_BENCHJOBS, submitTime, JOBSYSTEM_UNITTEST_BENCHRANGE, serialTime, parallelTime );
+
+    for( U32 index = 0; index < JOBSYSTEM_UNITTEST_BENCHRANGE; ++index )
+        ASSERT_EQ( serial[index], parallel[index] ) << "parallelFor produced a different result.";
+
+    delete [] serial;
+    delete [] parallel;
+}
+
+#endif // TORQUE_SHIPPING
@@ -0,0 +1,268 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2013 GarageGames, LLC
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//-----------------------------------------------------------------------------
+
+
+// We don't want tests in a shipping version.
+#ifndef TORQUE_SHIPPING
+
+#ifndef _UNIT_TESTING_H_
+#include "testing/unitTesting.h"
+#endif
+
+#ifndef _PLATFORM_H_
+#include "platform/platform.h"
+#endif
+
+#ifndef _MMATHFN_H_
+#include "math/mMathFn.h"
+#endif
+
+#ifndef _MRANDOM_H_
+#include "math/mRandom.h"
+#endif
+
+#ifndef _VECTOR_H_
+#include "collection/vector.h"
+#endif
+
+#ifndef _CONSOLE_H_
+#include "console/console.h"
+#endif
+
+//-----------------------------------------------------------------------------
+
+// Not a multiple of 8 so the scalar tails of every kernel are exercised.
+#define MATHSIMD_UNITTEST_COUNT           1003
+#define MATHSIMD_UNITTEST_BENCHCOUNT      4096
+#define MATHSIMD_UNITTEST_BENCHPASSES     500
+#define MATHSIMD_UNITTEST_TOLERANCE       0.0001f
+
+extern void mInstallLibrary_C();
+
+//-----------------------------------------------------------------------------
+
+// Puts back whatever Math::init would have installed when a test is done.
+class MathLibraryTestScope
+{
+public:
+    ~MathLibraryTestScope()
+    {
+        mInstallLibrary_C();
+        mInstallLibrary_SIMD( mGetSIMDSupport() );
+    }
+};
+
+//-----------------------------------------------------------------------------
+
+struct MathSIMDTestData
+{
+    F32         matrix[16];
+    Vector<F32> points;
+    Vector<F32> matrices;
+    Vector<F32> boxes;
+    Vector<F32> spheres;
+    F32         planes[6 * 4];
+
+    MathSIMDTestData( RandomLCG& random, U32 count )
+    {
+        for( U32 index = 0; index < 16; ++index )
+            matrix[index] = random.randRangeF( -2.0f, 2.0f );
+
+        for( U32 index = 0; index < 6 * 4; ++index )
+            planes[index] = random.randRangeF( -1.0f, 1.0f );
+
+        points.setSize( count * 3 );
+        for( U32 index = 0; index < count * 3; ++index )
+            points[index] = random.randRangeF( -100.0f, 100.0f );
+
+        matrices.setSize( count * 16 );
+        for( U32 index = 0; index < count * 16; ++index )
+            matrices[index] = random.randRangeF( -2.0f, 2.0f );
+
+        boxes.setSize( count * 6 );
+        spheres.setSize( count * 4 );
+        for( U32 index = 0; index < count; ++index )
+        {
+            for( U32 axis = 0; axis < 3; ++axis )
+            {
+                const F32 center = random.randRangeF( -100.0f, 100.0f );
+                const F32 extent = random.randRangeF( 0.0f, 10.0f );
+                boxes[index * 6 + axis] = center - extent;
+                boxes[index * 6 + axis + 3] = center + extent;
+                spheres[index * 4 + axis] = center;
+            }
+            spheres[index * 4 + 3] = random.randRangeF( 0.0f, 20.0f );
+        }
+    }
+};
+
+//-----------------------------------------------------------------------------
+
+static void expectNear( const F32* expected, const F32* actual, U32 count, const char* name, U32 level )
+{
+    for( U32 index = 0; index < count; ++index )
+    {
+        const F32 tolerance = MATHSIMD_UNITTEST_TOLERANCE * ( 1.0f + mFabs( expected[index] ) );
+        ASSERT_NEAR( expected[index], actual[index], tolerance ) << name << " differs from C at " << mGetSIMDName( level ) << ", element " << index << ".";
+    }
+}
+
+//-----------------------------------------------------------------------------
+
+TEST( MathSIMDTests, simdMatchesCTest )
+{
+    MathLibraryTestScope scope;
+    RandomLCG random( 1234 );
+    MathSIMDTestData data( random, MATHSIMD_UNITTEST_COUNT );
+    const U32 count = MATHSIMD_UNITTEST_COUNT;
+
+    // Reference results.
+    mInstallLibrary_C();
+
+    Vector<F32> points, matrices, boxes, dots;
+    Vector<U8> outside;
+    points.setSize( count * 3 );
+    matrices.setSize( count * 16 );
+    boxes.setSize( count * 6 );
+    dots.setSize( count );
+    outside.setSize( count );
+
+    F32 product[16], point4[4], transpose[16], box[6];
+    m_matF_x_matF( data.matrix, data.matrices.address(), product );
+    m_matF_x_point4F( data.matrix, data.matrices.address(), point4 );
+    dMemcpy( transpose, data.matrix, sizeof( transpose ) );
+    m_matF_transpose( transpose );
+    dMemcpy( box, data.boxes.address(), sizeof( box ) );
+    m_matF_x_box3F( data.matrix, box, box + 3 );
+    m_point3F_bulk_dot( data.matrix, data.points.address(), count, sizeof( F32 ) * 3, dots.address() );
+    m_matF_x_point3F_batch( data.matrix, data.points.address(), count, points.address() );
+    m_matF_x_matF_batch( data.matrix, data.matrices.address(), count, matrices.address() );
+    m_matF_x_box3F_batch( data.matrix, data.boxes.address(), count, boxes.address() );
+    const U32 outsideCount = m_sphereF_x_planes_batch( data.planes, 6, data.spheres.address(), count, outside.address() );
+
+    // Check.
+    ASSERT_GT( outsideCount, 0u ) << "No sphere outside the planes, test data is too easy.";
+    ASSERT_LT( outsideCount, count ) << "Every sphere outside the planes, test data is too easy.";
+
+    for( U32 level = MathSIMD_SSE41; level <= mGetSIMDSupport(); ++level )
+    {
+        mInstallLibrary_C();
+        mInstallLibrary_SIMD( level );
+
+        Vector<F32> simdPoints, simdMatrices, simdBoxes, simdDots;
+        Vector<U8> simdOutside;
+        simdPoints.setSize( count * 3 );
+        simdMatrices.setSize( count * 16 );
+        simdBoxes.setSize( count * 6 );
+        simdDots.setSize( count );
+        simdOutside.setSize( count );
+
+        F32 simdProduct[16], simdPoint4[4], simdTranspose[16], simdBox[6];
+        m_matF_x_matF( data.matrix, data.matrices.address(), simdProduct );
+        m_matF_x_point4F( data.matrix, data.matrices.address(), simdPoint4 );
+        dMemcpy( simdTranspose, data.matrix, sizeof( simdTranspose ) );
+        m_matF_transpose( simdTranspose );
+        dMemcpy( simdBox, data.boxes.address(), sizeof( simdBox ) );
+        m_matF_x_box3F( data.matrix, simdBox, simdBox + 3 );
+        m_point3F_bulk_dot( data.matrix, data.points.address(), count, sizeof( F32 ) * 3, simdDots.address() );
+        m_matF_x_point3F_batch( data.matrix, data.points.address(), count, simdPoints.address() );
+        m_matF_x_matF_batch( data.matrix, data.matrices.address(), count, simdMatrices.address() );
+        m_matF_x_box3F_batch( data.matrix, data.boxes.address(), count, simdBoxes.address() );
+        const U32 simdOutsideCount = m_sphereF_x_planes_batch( data.planes, 6, data.spheres.address(), count, simdOutside.address() );
+
+        expectNear( product, simdProduct, 16, "m_matF_x_matF", level );
+        expectNear( point4, simdPoint4, 4, "m_matF_x_point4F", level );
+        expectNear( transpose, simdTranspose, 16, "m_matF_transpose", level );
+        expectNear( box, simdBox, 6, "m_matF_x_box3F", level );
+        expectNear( dots.address(), simdDots.address(), count, "m_point3F_bulk_dot", level );
+        expectNear( points.address(), simdPoints.address(), count * 3, "m_matF_x_point3F_batch", level );
+        expectNear( matrices.address(), simdMatrices.address(), count * 16, "m_matF_x_matF_batch", level );
+        expectNear( boxes.address(), simdBoxes.address(), count * 6, "m_matF_x_box3F_batch", level );
+
+        ASSERT_EQ( outsideCount, simdOutsideCount ) << "m_sphereF_x_planes_batch count differs from C at " << mGetSIMDName( level ) << ".";
+        ASSERT_EQ( 0, dMemcmp( outside.address(), simdOutside.address(), count ) ) << "m_sphereF_x_planes_batch flags differ from C at " << mGetSIMDName( level ) << ".";
+
+        // Results written over the inputs.
+        F32 aliasProduct[16];
+        dMemcpy( aliasProduct, data.matrix, sizeof( aliasProduct ) );
+        m_matF_x_matF( aliasProduct, data.matrices.address(), aliasProduct );
+        expectNear( product, aliasProduct, 16, "m_matF_x_matF in place", level );
+
+        Vector<F32> aliasPoints( data.points );
+        m_matF_x_point3F_batch( data.matrix, aliasPoints.address(), count, aliasPoints.address() );
+        expectNear( points.address(), aliasPoints.address(), count * 3, "m_matF_x_point3F_batch in place", level );
+
+        Vector<F32> aliasMatrices( data.matrices );
+        m_matF_x_matF_batch( data.matrix, aliasMatrices.address(), count, aliasMatrices.address() );
+        expectNear( matrices.address(), aliasMatrices.address(), count * 16, "m_matF_x_matF_batch in place", level );
+
+        Vector<F32> aliasBoxes( data.boxes );
+        m_matF_x_box3F_batch( data.matrix, aliasBoxes.address(), count, aliasBoxes.address() );
+        expectNear( boxes.address(), aliasBoxes.address(), count * 6, "m_matF_x_box3F_batch in place", level );
+    }
+}
+
+//-----------------------------------------------------------------------------
+
+TEST( MathSIMDTests, simdBenchmarkTest )
+{
+    MathLibraryTestScope scope;
+    RandomLCG random( 5678 );
+    MathSIMDTestData data( random, MATHSIMD_UNITTEST_BENCHCOUNT );
+    const U32 count = MATHSIMD_UNITTEST_BENCHCOUNT;
+
+    Vector<F32> results;
+    results.setSize( count * 16 );
+    Vector<U8> outside;
+    outside.setSize( count );
+
+    for( U32 level = MathSIMD_None; level <= mGetSIMDSupport(); ++level )
+    {
+        mInstallLibrary_C();
+        mInstallLibrary_SIMD( level );
+
+        U32 startTime = Platform::getRealMilliseconds();
+        for( U32 pass = 0; pass < MATHSIMD_UNITTEST_BENCHPASSES; ++pass )
+            m_matF_x_point3F_batch( data.matrix, data.points.address(), count, results.address() );
+        const U32 pointTime = Platform::getRealMilliseconds() - startTime;
+
+        startTime = Platform::getRealMilliseconds();
+        for( U32 pass = 0; pass < MATHSIMD_UNITTEST_BENCHPASSES; ++pass )
+            m_matF_x_matF_batch( data.matrix, data.matrices.address(), count, results.address() );
+        const U32 matrixTime = Platform::getRealMilliseconds() - startTime;
+
+        startTime = Platform::getRealMilliseconds();
+        for( U32 pass = 0; pass < MATHSIMD_UNITTEST_BENCHPASSES; ++pass )
+            m_matF_x_box3F_batch( data.matrix, data.boxes.address(), count, results.address() );
+        const U32 boxTime = Platform::getRealMilliseconds() - startTime;
+
+        startTime = Platform::getRealMilliseconds();
+        for( U32 pass = 0; pass < MATHSIMD_UNITTEST_BENCHPASSES; ++pass )
+            m_sphereF_x_planes_batch( data.planes, 6, data.spheres.address(), count, outside.address() );
+        const U32 sphereTime = Platform::getRealMilliseconds() - startTime;
+
+        Con::printf( "MathSIMD: %s, %d passes over %d items. Points: %dms, matrices: %dms, boxes: %dms, spheres: %dms.",
+            mGetSIMDName( level ), MATHSIMD_UNITTEST_BENCHPASSES, count, pointTime, matrixTime, boxTime, sphereTime );
+    }
+}
+
+#endif // TORQUE_SHIPPING
@@ -0,0 +1,240 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2013 GarageGames, LLC
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//-----------------------------------------------------------------------------
+
+// We don't want tests in a shipping version.
+#ifndef TORQUE_SHIPPING
+
+#ifndef _UNIT_TESTING_H_
+#include "testing/unitTesting.h"
+#endif
+
+#ifndef _PLATFORM_H_
+#include "platform/platform.h"
+#endif
+
+#ifndef _MRANDOM_H_
+#include "math/mRandom.h"
+#endif
+
+#ifndef _MESH_BVH_H_
+#include "mesh/meshBVH.h"
+#endif
+
+#ifndef _MDYNAMICAABBTREE_H_
+#include "math/mDynamicAABBTree.h"
+#endif
+
+#ifndef _CONSOLE_H_
+#include "console/console.h"
+#endif
+
+//-----------------------------------------------------------------------------
+
+#define MESHBVH_UNITTEST_TRIANGLECOUNT    20000
+#define MESHBVH_UNITTEST_RAYCOUNT         2000
+
+//-----------------------------------------------------------------------------
+
+static void buildRandomMesh( MeshBVH& bvh, RandomLCG& random )
+{
+    bvh.clear();
+
+    for( U32 index = 0; index < MESHBVH_UNITTEST_TRIANGLECOUNT; ++index )
+    {
+        Point3F center( random.randRangeF( -50.0f, 50.0f ), random.randRangeF( -50.0f, 50.0f ), random.randRangeF( -50.0f, 50.0f ) );
+        Point3F a = center + Point3F( random.randRangeF( -1.0f, 1.0f ), random.randRangeF( -1.0f, 1.0f ), random.randRangeF( -1.0f, 1.0f ) );
+        Point3F b = center + Point3F( random.randRangeF( -1.0f, 1.0f ), random.randRangeF( -1.0f, 1.0f ), random.randRangeF( -1.0f, 1.0f ) );
+        Point3F c = center + Point3F( random.randRangeF( -1.0f, 1.0f ), random.randRangeF( -1.0f, 1.0f ), random.randRangeF( -1.0f, 1.0f ) );
+        bvh.addTriangle( a, b, c, 0, index );
+    }
+
+    bvh.build();
+}
+
+//-----------------------------------------------------------------------------
+
+static void buildRandomRays( Vector<Point3F>& starts, Vector<Point3F>& ends, RandomLCG& random )
+{
+    starts.setSize( MESHBVH_UNITTEST_RAYCOUNT );
+    ends.setSize( MESHBVH_UNITTEST_RAYCOUNT );
+
+    for( U32 index = 0; index < MESHBVH_UNITTEST_RAYCOUNT; ++index )
+    {
+        starts[index].set( random.randRangeF( -60.0f, 60.0f ), random.randRangeF( -60.0f, 60.0f ), -80.0f );
+        ends[index].set( random.randRangeF( -60.0f, 60.0f ), random.randRangeF( -60.0f, 60.0f ), 80.0f );
+    }
+}
+
+//-----------------------------------------------------------------------------
+
+TEST( MeshBVHTests, nearestHitMatchesBruteForceTest )
+{
+    RandomLCG random( 1234 );
+
+    MeshBVH bvh;
+    buildRandomMesh( bvh, random );
+
+    // Check.
+    ASSERT_FALSE( bvh.isEmpty() ) << "BVH not built.";
+    ASSERT_EQ( (U32)MESHBVH_UNITTEST_TRIANGLECOUNT, bvh.getTriangleCount() ) << "BVH lost triangles.";
+
+    Vector<Point3F> starts;
+    Vector<Point3F> ends;
+    buildRandomRays( starts, ends, random );
+
+    for( U32 index = 0; index < MESHBVH_UNITTEST_RAYCOUNT; ++index )
+    {
+        MeshBVH::RayHit bvhHit;
+        MeshBVH::RayHit bruteHit;
+        const bool bvhResult = bvh.raycast( starts[index], ends[index], bvhHit );
+        const bool bruteResult = bvh.raycastBruteForce( starts[index], ends[index], bruteHit );
+
+        ASSERT_EQ( bruteResult, bvhResult ) << "BVH and brute force disagree on whether the ray hit.";
+        if ( !bruteResult )
+            continue;
+
+        ASSERT_NEAR( bruteHit.t, bvhHit.t, 0.0001f ) << "BVH did not return the nearest hit.";
+    }
+}
+
+//-----------------------------------------------------------------------------
+
+TEST( MeshBVHTests, batchRaycastTest )
+{
+    RandomLCG random( 4321 );
+
+    MeshBVH bvh;
+    buildRandomMesh( bvh, random );
+
+    Vector<Point3F> starts;
+    Vector<Point3F> ends;
+    buildRandomRays( starts, ends, random );
+
+    Vector<MeshBVH::RayHit> hits;
+    hits.setSize( MESHBVH_UNITTEST_RAYCOUNT );
+    const U32 hitCount = bvh.raycast( starts.address(), ends.address(), MESHBVH_UNITTEST_RAYCOUNT, hits.address() );
+
+    U32 expectedCount = 0;
+    for( U32 index = 0; index < MESHBVH_UNITTEST_RAYCOUNT; ++index )
+    {
+        MeshBVH::RayHit hit;
+        if ( bvh.raycast( starts[index], ends[index], hit ) )
+        {
+            expectedCount++;
+            ASSERT_TRUE( hits[index].valid ) << "Batch raycast missed a hit.";
+            ASSERT_EQ( hit.face, hits[index].face ) << "Batch raycast returned a different face.";
+        }
+    }
+
+    ASSERT_EQ( expectedCount, hitCount ) << "Batch raycast returned the wrong hit count.";
+}
+
+//-----------------------------------------------------------------------------
+
+TEST( MeshBVHTests, raycastBenchmarkTest )
+{
+    RandomLCG random( 5678 );
+
+    MeshBVH bvh;
+    buildRandomMesh( bvh, random );
+
+    Vector<Point3F> starts;
+    Vector<Point3F> ends;
+    buildRandomRays( starts, ends, random );
+
+    Vector<MeshBVH::RayHit> bruteHits;
+    Vector<MeshBVH::RayHit> bvhHits;
+    bruteHits.setSize( MESHBVH_UNITTEST_RAYCOUNT );
+    bvhHits.setSize( MESHBVH_UNITTEST_RAYCOUNT );
+
+    U32 startTime = Platform::getRealMilliseconds();
+    for( U32 index = 0; index < MESHBVH_UNITTEST_RAYCOUNT; ++index )
+        bruteHits[index].valid = bvh.raycastBruteForce( starts[index], ends[index], bruteHits[index] );
+    const U32 bruteTime = Platform::getRealMilliseconds() - startTime;
+
+    startTime = Platform::getRealMilliseconds();
+    for( U32 index = 0; index < MESHBVH_UNITTEST_RAYCOUNT; ++index )
+        bvhHits[index].valid = bvh.raycast( starts[index], ends[index], bvhHits[index] );
+    const U32 bvhTime = Platform::getRealMilliseconds() - startTime;
+
+    Con::printf( "MeshBVH: %d rays against %d triangles. Brute force: %dms, BVH: %dms.",
+        MESHBVH_UNITTEST_RAYCOUNT, MESHBVH_UNITTEST_TRIANGLECOUNT, bruteTime, bvhTime );
+
+    // Check. Timings vary too much between machines to assert on, only the hits are compared.
+    for( U32 index = 0; index < MESHBVH_UNITTEST_RAYCOUNT; ++index )
+    {
+        ASSERT_EQ( bruteHits[index].valid, bvhHits[index].valid ) << "BVH and brute force disagree on whether the ray hit.";
+        if ( bruteHits[index].valid )
+            ASSERT_NEAR( bruteHits[index].t, bvhHits[index].t, 0.0001f ) << "BVH did not return the nearest hit.";
+    }
+}
+
+//-----------------------------------------------------------------------------
+
+struct AABBTreeQueryCallback
+{
+    Vector<S32> results;
+
+    bool queryCallback( S32 proxyId )
+    {
+        results.push_back( proxyId );
+        return true;
+    }
+};
+
+//-----------------------------------------------------------------------------
+
+TEST( DynamicAABBTreeTests, createMoveDestroyTest )
+{
+    DynamicAABBTree tree;
+    ASSERT_TRUE( tree.isEmpty() ) << "New tree not empty.";
+
+    S32 proxies[64];
+    for( S32 index = 0; index < 64; ++index )
+    {
+        Box3F box( Point3F( (F32)index * 4.0f, 0.0f, 0.0f ), Point3F( (F32)index * 4.0f + 1.0f, 1.0f, 1.0f ) );
+        proxies[index] = tree.createProxy( box, (void*)(uintptr_t)(index + 1) );
+    }
+
+    ASSERT_EQ( 64, (S32)tree.getProxyCount() ) << "Wrong proxy count.";
+
+    // Only the first proxy overlaps the origin.
+    AABBTreeQueryCallback callback;
+    tree.query( Box3F( Point3F( -0.5f, -0.5f, -0.5f ), Point3F( 0.5f, 0.5f, 0.5f ) ), &callback );
+    ASSERT_EQ( 1, callback.results.size() ) << "Query returned the wrong number of proxies.";
+    ASSERT_EQ( (void*)1, tree.getUserData( callback.results[0] ) ) << "Query returned the wrong proxy.";
+
+    // Move it away and make sure it's gone.
+    tree.moveProxy( proxies[0], Box3F( Point3F( 1000.0f, 0.0f, 0.0f ), Point3F( 1001.0f, 1.0f, 1.0f ) ) );
+    callback.results.clear();
+    tree.query( Box3F( Point3F( -0.5f, -0.5f, -0.5f ), Point3F( 0.5f, 0.5f, 0.5f ) ), &callback );
+    ASSERT_EQ( 0, callback.results.size() ) << "Moved proxy still found at old position.";
+
+    for( S32 index = 0; index < 64; ++index )
+        tree.destroyProxy( proxies[index] );
+
+    ASSERT_TRUE( tree.isEmpty() ) << "Tree not empty after destroying all proxies.";
+}
+
+//-----------------------------------------------------------------------------
+
+#endif // TORQUE_SHIPPING
@@ -0,0 +1,291 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2013 GarageGames, LLC
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//-----------------------------------------------------------------------------
+
+// We don't want tests in a shipping version.
+#ifndef TORQUE_SHIPPING
+
+#ifndef _UNIT_TESTING_H_
+#include "testing/unitTesting.h"
+#endif
+
+#ifndef _PLATFORM_H_
+#include "platform/platform.h"
+#endif
+
+#ifndef _JOB_SYSTEM_H_
+#include "platform/threads/jobSystem.h"
+#endif
+
+#ifndef _JOB_SYSTEM_TEST_SCOPE_H_
+#include "testing/jobSystemTestScope.h"
+#endif
+
+#ifndef _PARTICLE_SYSTEM_H_
+#include "graphics/particleSystem.h"
+#endif
+
+#ifndef _COLOR_H_
+#include "graphics/color.h"
+#endif
+
+#ifndef _CONSOLE_H_
+#include "console/console.h"
+#endif
+
+//-----------------------------------------------------------------------------
+
+// Not a multiple of 4 so the scalar tails are exercised.
+#define PARTICLESYSTEM_UNITTEST_COUNT           1003
+#define PARTICLESYSTEM_UNITTEST_BENCHEMITTERS   1000
+#define PARTICLESYSTEM_UNITTEST_BENCHPARTICLES  1000
+#define PARTICLESYSTEM_UNITTEST_BENCHFRAMES     30
+#define PARTICLESYSTEM_UNITTEST_TOLERANCE       0.0001f
+
+//-----------------------------------------------------------------------------
+
+TEST( ParticleSystemTests, integrationTest )
+{
+    ParticleSystem system;
+
+    // Nothing dies during the test.
+    ParticleSystem::EmitterParams params;
+    params.count = PARTICLESYSTEM_UNITTEST_COUNT;
+    params.minLifetime = 100.0f;
+    params.maxLifetime = 100.0f;
+    params.gravity.set( 1.0f, -2.0f, -9.81f );
+    const S32 emitter = system.createEmitter( params, 1234 );
+    ASSERT_EQ( PARTICLESYSTEM_UNITTEST_COUNT, system.getParticleCount( emitter ) );
+
+    Vector<Point3F> positions;
+    Vector<Point3F> velocities;
+    for ( U32 n = 0; n < PARTICLESYSTEM_UNITTEST_COUNT; ++n )
+    {
+        Point3F position, velocity;
+        ColorF color;
+        F32 lifetime;
+        system.getParticle( emitter, n, position, velocity, color, lifetime );
+        positions.push_back( position );
+        velocities.push_back( velocity );
+    }
+
+    // Scalar reference.
+    const F32 dt = 1.0f / 30.0f;
+    for ( U32 frame = 0; frame < 10; ++frame )
+    {
+        system.update( dt );
+        EXPECT_EQ( 0, system.getEmittedCount( emitter ) );
+
+        for ( U32 n = 0; n < PARTICLESYSTEM_UNITTEST_COUNT; ++n )
+        {
+            velocities[n] += params.gravity * dt;
+            positions[n] += velocities[n] * dt;
+        }
+    }
+
+    for ( U32 n = 0; n < PARTICLESYSTEM_UNITTEST_COUNT; ++n )
+    {
+        Point3F position, velocity;
+        ColorF color;
+        F32 lifetime;
+        system.getParticle( emitter, n, position, velocity, color, lifetime );
+
+        EXPECT_NEAR( positions[n].x, position.x, PARTICLESYSTEM_UNITTEST_TOLERANCE );
+        EXPECT_NEAR( positions[n].y, position.y, PARTICLESYSTEM_UNITTEST_TOLERANCE );
+        EXPECT_NEAR( positions[n].z, position.z, PARTICLESYSTEM_UNITTEST_TOLERANCE );
+        EXPECT_NEAR( velocities[n].z, velocity.z, PARTICLESYSTEM_UNITTEST_TOLERANCE );
+        EXPECT_NEAR( 100.0f - ( dt * 10.0f ), lifetime, PARTICLESYSTEM_UNITTEST_TOLERANCE );
+    }
+}
+
+//-----------------------------------------------------------------------------
+
+TEST( ParticleSystemTests, swapRemoveTest )
+{
+    ParticleSystem system;
+
+    ParticleSystem::EmitterParams params;
+    params.count = PARTICLESYSTEM_UNITTEST_COUNT;
+    params.minLifetime = 0.01f;
+    params.maxLifetime = 1.0f;
+    const S32 emitter = system.createEmitter( params, 99 );
+
+    // Survivors keep their state, only their order may change.
+    const F32 dt = 0.5f;
+    U32 expectedDead = 0;
+    F32 survivorLifetime = 0.0f;
+    for ( U32 n = 0; n < PARTICLESYSTEM_UNITTEST_COUNT; ++n )
+    {
+        Point3F position, velocity;
+        ColorF color;
+        F32 lifetime;
+        system.getParticle( emitter, n, position, velocity, color, lifetime );
+        if ( lifetime - dt < 0.0f )
+            expectedDead++;
+        else
+            survivorLifetime += lifetime - dt;
+    }
+    ASSERT_GT( expectedDead, 0 );
+
+    system.update( dt );
+    EXPECT_EQ( PARTICLESYSTEM_UNITTEST_COUNT, system.getParticleCount( emitter ) );
+    EXPECT_EQ( expectedDead, system.getEmittedCount( emitter ) );
+
+    // Survivors are packed at the front, new particles follow.
+    const U32 survivors = PARTICLESYSTEM_UNITTEST_COUNT - expectedDead;
+    F32 lifetimeSum = 0.0f;
+    for ( U32 n = 0; n < PARTICLESYSTEM_UNITTEST_COUNT; ++n )
+    {
+        Point3F position, velocity;
+        ColorF color;
+        F32 lifetime;
+        system.getParticle( emitter, n, position, velocity, color, lifetime );
+        EXPECT_GE( lifetime, 0.0f );
+        if ( n < survivors )
+            lifetimeSum += lifetime;
+    }
+    EXPECT_NEAR( survivorLifetime, lifetimeSum, 0.01f );
+
+    // Lowering the count drops particles off the end.
+    params.count = 10;
+    system.setEmitterParams( emitter, params );
+    EXPECT_EQ( 10, system.getParticleCount( emitter ) );
+}
+
+//-----------------------------------------------------------------------------
+
+TEST( ParticleSystemTests, poolTest )
+{
+    ParticleSystem system;
+
+    ParticleSystem::EmitterParams params;
+    params.count = 64;
+
+    S32 emitters[10];
+    for ( U32 n = 0; n < 10; ++n )
+        emitters[n] = system.createEmitter( params, n + 1 );
+    EXPECT_EQ( 10, system.getEmitterCount() );
+
+    for ( U32 n = 0; n < 10; n += 2 )
+        system.destroyEmitter( emitters[n] );
+    EXPECT_EQ( 5, system.getEmitterCount() );
+    EXPECT_EQ( 5, system.getPooledEmitterCount() );
+
+    // New emitters take the pooled ones.
+    for ( U32 n = 0; n < 5; ++n )
+    {
+        S32 handle = system.createEmitter( params, 100 + n );
+        EXPECT_LT( handle, 10 );
+        EXPECT_EQ( 64, system.getParticleCount( handle ) );
+    }
+    EXPECT_EQ( 10, system.getEmitterCount() );
+    EXPECT_EQ( 0, system.getPooledEmitterCount() );
+
+    system.update( 0.1f );
+    EXPECT_EQ( 640, system.getParticleCount() );
+}
+
+//-----------------------------------------------------------------------------
+
+TEST( ParticleSystemTests, writeInstancesTest )
+{
+    ParticleSystem system;
+
+    ParticleSystem::EmitterParams params;
+    params.count = PARTICLESYSTEM_UNITTEST_COUNT;
+    params.minLifetime = 0.5f;
+    params.maxLifetime = 2.0f;
+    const S32 emitter = system.createEmitter( params, 7 );
+    system.update( 0.25f );
+
+    const U32 count = system.getParticleCount( emitter );
+    Vector<F32> instances;
+    instances.setSize( count * ( ParticleSystem::InstanceStride / sizeof(F32) ) );
+    system.writeInstances( emitter, instances.address() );
+
+    for ( U32 n = 0; n < count; ++n )
+    {
+        Point3F position, velocity;
+        ColorF color;
+        F32 lifetime;
+        system.getParticle( emitter, n, position, velocity, color, lifetime );
+
+        const F32* instance = &instances[n * 8];
+        EXPECT_EQ( position.x, instance[0] );
+        EXPECT_EQ( position.y, instance[1] );
+        EXPECT_EQ( position.z, instance[2] );
+        EXPECT_EQ( 0.0f, instance[3] );
+        EXPECT_EQ( color.red, instance[4] );
+        EXPECT_EQ( color.green, instance[5] );
+        EXPECT_EQ( color.blue, instance[6] );
+        EXPECT_EQ( mClampF( lifetime, 0.0f, 1.0f ), instance[7] );
+    }
+}
+
+//-----------------------------------------------------------------------------
+
+TEST( ParticleSystemTests, benchmarkTest )
+{
+    JobSystemTestScope scope;
+    ParticleSystem system;
+
+    ParticleSystem::EmitterParams params;
+    params.count = PARTICLESYSTEM_UNITTEST_BENCHPARTICLES;
+    for ( U32 n = 0; n < PARTICLESYSTEM_UNITTEST_BENCHEMITTERS; ++n )
+        system.createEmitter( params, n + 1 );
+
+    const F32 dt = 1.0f / 60.0f;
+
+    // Serial, one emitter after the other on this thread.
+    U32 startTime = Platform::getRealMilliseconds();
+    for ( U32 frame = 0; frame < PARTICLESYSTEM_UNITTEST_BENCHFRAMES; ++frame )
+    {
+        for ( U32 n = 0; n < PARTICLESYSTEM_UNITTEST_BENCHEMITTERS; ++n )
+            system.updateEmitter( n, dt );
+    }
+    const U32 serialTime = Platform::getRealMilliseconds() - startTime;
+
+    // Batches of emitters across the job system.
+    startTime = Platform::getRealMilliseconds();
+    for ( U32 frame = 0; frame < PARTICLESYSTEM_UNITTEST_BENCHFRAMES; ++frame )
+        system.update( dt );
+    const U32 parallelTime = Platform::getRealMilliseconds() - startTime;
+
+    EXPECT_EQ( PARTICLESYSTEM_UNITTEST_BENCHEMITTERS * PARTICLESYSTEM_UNITTEST_BENCHPARTICLES, system.getParticleCount() );
+
+    // Instance upload of a frame.
+    Vector<U8> instances;
+    instances.setSize( system.getParticleCount() * ParticleSystem::InstanceStride );
+    startTime = Platform::getRealMilliseconds();
+    U8* dest = instances.address();
+    for ( U32 n = 0; n < PARTICLESYSTEM_UNITTEST_BENCHEMITTERS; ++n )
+    {
+        system.writeInstances( n, dest );
+        dest += system.getParticleCount( n ) * ParticleSystem::InstanceStride;
+    }
+    const U32 writeTime = Platform::getRealMilliseconds() - startTime;
+
+    Con::printf( "ParticleSystem: %d particles in %d emitters, %d frames: serial %dms, %d workers %dms. Instance write %dms.",
+        system.getParticleCount(), system.getEmitterCount(), PARTICLESYSTEM_UNITTEST_BENCHFRAMES,
+        serialTime, JobSystem::getWorkerCount(), parallelTime, writeTime );
+}
+
+#endif // TORQUE_SHIPPING
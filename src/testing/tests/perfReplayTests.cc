@@ -0,0 +1,109 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2013 GarageGames, LLC
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//-----------------------------------------------------------------------------
+
+// We don't want tests in a shipping version.
+#ifndef TORQUE_SHIPPING
+
+#ifndef _UNIT_TESTING_H_
+#include "testing/unitTesting.h"
+#endif
+
+#ifndef _PLATFORM_H_
+#include "platform/platform.h"
+#endif
+
+#ifndef _PROFILER_H_
+#include "debug/profiler.h"
+#endif
+
+#ifndef _PERF_REPLAY_H_
+#include "debug/perfReplay.h"
+#endif
+
+//-----------------------------------------------------------------------------
+
+#define PERFREPLAY_UNITTEST_REPORT     "_unitTestPerfReport_RemoveMe"
+#define PERFREPLAY_UNITTEST_FRAMES     8
+
+//-----------------------------------------------------------------------------
+
+// Records frames without a journal, the way the harness does after each step.
+static void recordFrames(U32 sleepMs)
+{
+    PerfReplay::reset();
+    PerfReplay::smRecording = true;
+
+    for (U32 frame = 0; frame < PERFREPLAY_UNITTEST_FRAMES; ++frame)
+    {
+        PROFILE_START(PerfReplayTestOuter);
+        PROFILE_START(PerfReplayTestInner);
+        Platform::sleep(sleepMs);
+        PROFILE_END();
+        PROFILE_END();
+
+        PerfReplay::markTimeStep();
+        PerfReplay::process();
+    }
+
+    PerfReplay::smRecording = false;
+}
+
+//-----------------------------------------------------------------------------
+
+TEST( PerfReplayTests, ReportMatchesItself )
+{
+    recordFrames(1);
+
+    ASSERT_TRUE( PerfReplay::writeReport(PERFREPLAY_UNITTEST_REPORT) ) << "Report was not written.";
+    ASSERT_TRUE( Platform::isFile(PERFREPLAY_UNITTEST_REPORT ".json") ) << "JSON report is missing.";
+    ASSERT_TRUE( Platform::isFile(PERFREPLAY_UNITTEST_REPORT ".csv") ) << "CSV report is missing.";
+
+    ASSERT_EQ( PerfReplay::compareBaseline(PERFREPLAY_UNITTEST_REPORT ".json", 10.0f, 0.0f), 0 ) << "A report regressed against itself.";
+
+    Platform::fileDelete(PERFREPLAY_UNITTEST_REPORT ".json");
+    Platform::fileDelete(PERFREPLAY_UNITTEST_REPORT ".csv");
+}
+
+//-----------------------------------------------------------------------------
+
+TEST( PerfReplayTests, SlowerZonesRegress )
+{
+    recordFrames(1);
+    ASSERT_TRUE( PerfReplay::writeReport(PERFREPLAY_UNITTEST_REPORT) ) << "Report was not written.";
+
+    recordFrames(20);
+
+    // Both the outer and the inner zone got slower.
+    ASSERT_EQ( PerfReplay::compareBaseline(PERFREPLAY_UNITTEST_REPORT ".json", 50.0f, 0.0f), 2 ) << "Slower zones were not flagged.";
+
+    // A high enough noise floor skips both zones.
+    ASSERT_EQ( PerfReplay::compareBaseline(PERFREPLAY_UNITTEST_REPORT ".json", 50.0f, 1000.0f), 0 ) << "Zones below the noise floor were compared.";
+
+    ASSERT_EQ( PerfReplay::compareBaseline("_unitTestPerfReport_Missing.json", 50.0f, 0.0f), -1 ) << "A missing baseline was accepted.";
+
+    Platform::fileDelete(PERFREPLAY_UNITTEST_REPORT ".json");
+    Platform::fileDelete(PERFREPLAY_UNITTEST_REPORT ".csv");
+
+    PerfReplay::reset();
+}
+
+#endif // TORQUE_SHIPPING
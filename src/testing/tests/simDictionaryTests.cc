@@ -0,0 +1,170 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2013 GarageGames, LLC
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//-----------------------------------------------------------------------------
+
+// We don't want tests in a shipping version.
+#ifndef TORQUE_SHIPPING
+
+#ifndef _UNIT_TESTING_H_
+#include "testing/unitTesting.h"
+#endif
+
+#ifndef _PLATFORM_H_
+#include "platform/platform.h"
+#endif
+
+#ifndef _CONSOLE_H_
+#include "console/console.h"
+#endif
+
+#ifndef _STRINGTABLE_H_
+#include "string/stringTable.h"
+#endif
+
+#ifndef _SIMDICTIONARY_H_
+#include "sim/simDictionary.h"
+#endif
+
+#ifndef _SIMBASE_H_
+#include "sim/simBase.h"
+#endif
+
+#ifndef _VECTOR_H_
+#include "collection/vector.h"
+#endif
+
+//-----------------------------------------------------------------------------
+
+#define SIMDICTIONARY_UNITTEST_KEYS           20000
+#define SIMDICTIONARY_UNITTEST_OBJECTS        100000
+#define SIMDICTIONARY_UNITTEST_LOOKUPS        2000000
+
+//-----------------------------------------------------------------------------
+
+// The table only compares object pointers, so these are never dereferenced.
+static SimObject* getTestObject( const U32 index )
+{
+    return (SimObject*)(uintptr_t)( 0x10000 + index * 16 );
+}
+
+//-----------------------------------------------------------------------------
+
+TEST( SimDictionaryTests, insertFindRemoveTest )
+{
+    SimObjectHashTable table;
+
+    for ( U32 i = 1; i <= SIMDICTIONARY_UNITTEST_KEYS; ++i )
+        table.insert( i, getTestObject(i) );
+
+    // Shadow every fourth key with a newer object, as a duplicate name would.
+    for ( U32 i = 4; i <= SIMDICTIONARY_UNITTEST_KEYS; i += 4 )
+        table.insert( i, getTestObject(SIMDICTIONARY_UNITTEST_KEYS + i) );
+
+    for ( U32 i = 1; i <= SIMDICTIONARY_UNITTEST_KEYS; ++i )
+    {
+        SimObject* pExpected = (i % 4) ? getTestObject(i) : getTestObject(SIMDICTIONARY_UNITTEST_KEYS + i);
+        ASSERT_EQ( pExpected, table.find(i) ) << "Key " << i << " found the wrong object.";
+        ASSERT_TRUE( table.contains(i, getTestObject(i)) ) << "Shadowed object " << i << " was lost.";
+    }
+
+    // Remove the odd keys and the newer duplicates.
+    for ( U32 i = 1; i <= SIMDICTIONARY_UNITTEST_KEYS; ++i )
+    {
+        if ( i & 1 )
+            table.remove( i, getTestObject(i) );
+        else if ( (i % 4) == 0 )
+            table.remove( i, getTestObject(SIMDICTIONARY_UNITTEST_KEYS + i) );
+    }
+
+    for ( U32 i = 1; i <= SIMDICTIONARY_UNITTEST_KEYS; ++i )
+    {
+        SimObject* pExpected = (i & 1) ? NULL : getTestObject(i);
+        ASSERT_EQ( pExpected, table.find(i) ) << "Key " << i << " found the wrong object after removal.";
+    }
+
+    // Churn through removed slots without growing without bound.
+    for ( U32 i = 1; i <= SIMDICTIONARY_UNITTEST_KEYS * 4; ++i )
+    {
+        const U32 key = SIMDICTIONARY_UNITTEST_KEYS + i;
+        table.insert( key, getTestObject(key) );
+        table.remove( key, getTestObject(key) );
+    }
+
+    SimObjectHashTable::Statistics stats;
+    table.getStatistics( stats );
+    ASSERT_EQ( (U32)SIMDICTIONARY_UNITTEST_KEYS / 2, stats.entryCount ) << "Entry count mismatch.";
+    ASSERT_LE( stats.loadFactor, 0.75f ) << "Table is over its load limit.";
+    ASSERT_LE( stats.tableSize, (U32)SIMDICTIONARY_UNITTEST_KEYS * 4 ) << "Tombstones grew the table.";
+}
+
+//-----------------------------------------------------------------------------
+
+TEST( SimDictionaryTests, findObjectBenchmarkTest )
+{
+    char nameBuffer[32];
+    Vector<SimObject*> objects;
+    Vector<StringTableEntry> names;
+    objects.reserve( SIMDICTIONARY_UNITTEST_OBJECTS );
+    names.reserve( SIMDICTIONARY_UNITTEST_OBJECTS );
+
+    U32 startTime = Platform::getRealMilliseconds();
+    for ( U32 i = 0; i < SIMDICTIONARY_UNITTEST_OBJECTS; ++i )
+    {
+        dSprintf( nameBuffer, sizeof(nameBuffer), "simDictionaryTest%d", i );
+        SimObject* pObject = new SimObject();
+        ASSERT_TRUE( pObject->registerObject(nameBuffer) ) << "Failed to register object " << i << ".";
+        objects.push_back( pObject );
+        names.push_back( pObject->getName() );
+    }
+    const U32 registerTime = Platform::getRealMilliseconds() - startTime;
+
+    // Stride through the objects so lookups don't walk the table in order.
+    U32 index = 0;
+    U32 misses = 0;
+    startTime = Platform::getRealMilliseconds();
+    for ( U32 i = 0; i < SIMDICTIONARY_UNITTEST_LOOKUPS; ++i )
+    {
+        index = (index + 7919) % SIMDICTIONARY_UNITTEST_OBJECTS;
+        if ( Sim::findObject(objects[index]->getId()) != objects[index] )
+            misses++;
+    }
+    const U32 idTime = Platform::getRealMilliseconds() - startTime;
+
+    startTime = Platform::getRealMilliseconds();
+    for ( U32 i = 0; i < SIMDICTIONARY_UNITTEST_LOOKUPS; ++i )
+    {
+        index = (index + 7919) % SIMDICTIONARY_UNITTEST_OBJECTS;
+        if ( Sim::findObject(names[index]) != objects[index] )
+            misses++;
+    }
+    const U32 nameTime = Platform::getRealMilliseconds() - startTime;
+
+    ASSERT_EQ( 0u, misses ) << "Lookups found the wrong object.";
+
+    Con::printf( "SimDictionary: %d objects registered in %dms. %d lookups by id: %dms, by name: %dms.",
+        SIMDICTIONARY_UNITTEST_OBJECTS, registerTime, SIMDICTIONARY_UNITTEST_LOOKUPS, idTime, nameTime );
+    Sim::dumpDictionaryStatistics();
+
+    for ( U32 i = 0; i < (U32)objects.size(); ++i )
+        objects[i]->deleteObject();
+}
+
+#endif // TORQUE_SHIPPING
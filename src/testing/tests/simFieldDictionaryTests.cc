@@ -0,0 +1,168 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2013 GarageGames, LLC
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//-----------------------------------------------------------------------------
+
+// We don't want tests in a shipping version.
+#ifndef TORQUE_SHIPPING
+
+#ifndef _UNIT_TESTING_H_
+#include "testing/unitTesting.h"
+#endif
+
+#ifndef _PLATFORM_H_
+#include "platform/platform.h"
+#endif
+
+#ifndef _CONSOLE_H_
+#include "console/console.h"
+#endif
+
+#ifndef _STRINGTABLE_H_
+#include "string/stringTable.h"
+#endif
+
+#ifndef _SIM_FIELD_DICTIONARY_H_
+#include "sim/simFieldDictionary.h"
+#endif
+
+#ifndef _VECTOR_H_
+#include "collection/vector.h"
+#endif
+
+//-----------------------------------------------------------------------------
+
+#define FIELDDICTIONARY_UNITTEST_FIELDS       40
+#define FIELDDICTIONARY_UNITTEST_OBJECTS      100000
+
+//-----------------------------------------------------------------------------
+
+static StringTableEntry getTestFieldName( const U32 index )
+{
+    char nameBuffer[32];
+    dSprintf( nameBuffer, sizeof(nameBuffer), "fieldDictionaryTest%d", index );
+    return StringTable->insert( nameBuffer );
+}
+
+//-----------------------------------------------------------------------------
+
+TEST( SimFieldDictionaryTests, setGetRemoveTest )
+{
+    SimFieldDictionary dictionary;
+    char valueBuffer[64];
+
+    // Enough fields to go past the linear scan and grow the string arena.
+    for ( U32 i = 0; i < FIELDDICTIONARY_UNITTEST_FIELDS; ++i )
+    {
+        dSprintf( valueBuffer, sizeof(valueBuffer), "value%d", i );
+        dictionary.setFieldValue( getTestFieldName(i), valueBuffer );
+    }
+
+    ASSERT_EQ( (U32)FIELDDICTIONARY_UNITTEST_FIELDS, dictionary.getFieldCount() ) << "Field count mismatch.";
+
+    // Remove the odd fields and grow the even ones.
+    for ( U32 i = 0; i < FIELDDICTIONARY_UNITTEST_FIELDS; ++i )
+    {
+        dSprintf( valueBuffer, sizeof(valueBuffer), "a longer value for field %d", i );
+        dictionary.setFieldValue( getTestFieldName(i), (i & 1) ? "" : valueBuffer );
+    }
+
+    ASSERT_EQ( (U32)FIELDDICTIONARY_UNITTEST_FIELDS / 2, dictionary.getFieldCount() ) << "Removed fields are still counted.";
+
+    for ( U32 i = 0; i < FIELDDICTIONARY_UNITTEST_FIELDS; ++i )
+    {
+        const char* pValue = dictionary.getFieldValue( getTestFieldName(i) );
+        if ( i & 1 )
+        {
+            ASSERT_TRUE( pValue == NULL ) << "Removed field " << i << " was found.";
+            continue;
+        }
+
+        dSprintf( valueBuffer, sizeof(valueBuffer), "a longer value for field %d", i );
+        ASSERT_STREQ( valueBuffer, pValue ) << "Field " << i << " has the wrong value.";
+    }
+
+    // Setting a field from the dictionary's own storage must survive the arena moving.
+    dictionary.setFieldValue( getTestFieldName(1), dictionary.getFieldValue(getTestFieldName(0)) );
+    ASSERT_STREQ( "a longer value for field 0", dictionary.getFieldValue(getTestFieldName(1)) ) << "Aliased value was corrupted.";
+
+    // The iterator visits every field once.
+    U32 visited = 0;
+    for ( SimFieldDictionaryIterator itr(&dictionary); *itr; ++itr )
+    {
+        ASSERT_STREQ( dictionary.getFieldValue((*itr)->slotName), (*itr)->value ) << "Iterator value mismatch.";
+        ++visited;
+    }
+
+    ASSERT_EQ( dictionary.getFieldCount(), visited ) << "Iterator field count mismatch.";
+
+    SimFieldDictionary copy;
+    copy.assignFrom( &dictionary );
+    ASSERT_EQ( dictionary.getFieldCount(), copy.getFieldCount() ) << "Copied field count mismatch.";
+}
+
+//-----------------------------------------------------------------------------
+
+TEST( SimFieldDictionaryTests, memoryUsageTest )
+{
+    // A typical scene object carries two or three short dynamic fields.
+    StringTableEntry fieldNames[3] = { getTestFieldName(0), getTestFieldName(1), getTestFieldName(2) };
+    const char* fieldValues[3] = { "1", "north", "chest_common" };
+
+    // The chained table held 19 bucket pointers plus a version, and each
+    // field took a node of three pointers plus a separately allocated copy.
+    U32 chainedBytes = 0;
+    U32 chainedAllocations = 0;
+    U32 compactBytes = 0;
+
+    Vector<SimFieldDictionary*> dictionaries;
+    dictionaries.reserve( FIELDDICTIONARY_UNITTEST_OBJECTS );
+
+    const U32 startTime = Platform::getRealMilliseconds();
+    for ( U32 i = 0; i < FIELDDICTIONARY_UNITTEST_OBJECTS; ++i )
+    {
+        SimFieldDictionary* pDictionary = new SimFieldDictionary();
+        const U32 fieldCount = 2 + (i & 1);
+
+        chainedBytes += 19 * sizeof(void*) + sizeof(U32);
+        chainedAllocations += 1 + fieldCount * 2;
+        for ( U32 field = 0; field < fieldCount; ++field )
+        {
+            pDictionary->setFieldValue( fieldNames[field], fieldValues[field] );
+            chainedBytes += 3 * sizeof(void*) + dStrlen( fieldValues[field] ) + 1;
+        }
+
+        compactBytes += pDictionary->getMemoryUsage();
+        dictionaries.push_back( pDictionary );
+    }
+    const U32 elapsedTime = Platform::getRealMilliseconds() - startTime;
+
+    for ( U32 i = 0; i < (U32)dictionaries.size(); ++i )
+        delete dictionaries[i];
+
+    ASSERT_LT( compactBytes, chainedBytes ) << "Compact dictionaries use more memory than the chained table.";
+
+    Con::printf( "SimFieldDictionary: %d objects built in %dms. Chained: %dKB in %d allocations, compact: %dKB in %d allocations.",
+        FIELDDICTIONARY_UNITTEST_OBJECTS, elapsedTime,
+        chainedBytes / 1024, chainedAllocations,
+        compactBytes / 1024, FIELDDICTIONARY_UNITTEST_OBJECTS * 3 );
+}
+
+#endif // TORQUE_SHIPPING
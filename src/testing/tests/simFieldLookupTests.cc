@@ -0,0 +1,213 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2013 GarageGames, LLC
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//-----------------------------------------------------------------------------
+
+// We don't want tests in a shipping version.
+#ifndef TORQUE_SHIPPING
+
+#ifndef _UNIT_TESTING_H_
+#include "testing/unitTesting.h"
+#endif
+
+#ifndef _PLATFORM_H_
+#include "platform/platform.h"
+#endif
+
+#ifndef _CONSOLE_H_
+#include "console/console.h"
+#endif
+
+#ifndef _CONSOLETYPES_H_
+#include "console/consoleTypes.h"
+#endif
+
+#ifndef _SIM_OBJECT_H_
+#include "sim/simObject.h"
+#endif
+
+//-----------------------------------------------------------------------------
+
+#define FIELDLOOKUP_UNITTEST_ITERATIONS       100
+#define FIELDLOOKUP_UNITTEST_BENCHITERATIONS  200000
+#define FIELDLOOKUP_UNITTEST_BENCHLOOKUPS     2000000
+
+//-----------------------------------------------------------------------------
+
+// Object with a spread of numeric fields for the script field tests.
+class FieldLookupTestObject : public SimObject
+{
+    typedef SimObject Parent;
+
+public:
+    S32     mLevel;
+    S32     mCount[4];
+    F32     mSpeed;
+    F32     mScale;
+    bool    mEnabled;
+
+    FieldLookupTestObject() : mLevel( 0 ), mSpeed( 0.0f ), mScale( 1.0f ), mEnabled( false )
+    {
+        for ( U32 i = 0; i < 4; ++i )
+            mCount[i] = 0;
+    }
+
+    static void initPersistFields()
+    {
+        Parent::initPersistFields();
+
+        addField( "level", TypeS32, Offset(mLevel, FieldLookupTestObject) );
+        addField( "count", TypeS32, Offset(mCount, FieldLookupTestObject), 4 );
+        addField( "speed", TypeF32, Offset(mSpeed, FieldLookupTestObject) );
+        addField( "scale", TypeF32, Offset(mScale, FieldLookupTestObject) );
+        addField( "enabled", TypeBool, Offset(mEnabled, FieldLookupTestObject) );
+    }
+
+    DECLARE_CONOBJECT( FieldLookupTestObject );
+};
+
+IMPLEMENT_CONOBJECT( FieldLookupTestObject );
+
+//-----------------------------------------------------------------------------
+
+// Runs a property heavy loop on a new object and returns its id.
+static SimObjectId runFieldScript( const bool fieldCache, const U32 iterations )
+{
+    const bool oldFieldCache = gScriptFieldCache;
+    gScriptFieldCache = fieldCache;
+
+    Con::evaluatef(
+        "$FieldLookupTest::object = new FieldLookupTestObject();"
+        "%%obj = $FieldLookupTest::object;"
+        "for ( %%i = 0; %%i < %d; %%i++ )"
+        "{"
+        "   %%obj.level = %%obj.level + 1;"
+        "   %%obj.count[1] = %%obj.count[1] + 2;"
+        "   %%obj.speed = %%obj.speed + 0.5;"
+        "   %%obj.scale = %%obj.scale * 1;"
+        "   %%obj.enabled = !%%obj.enabled;"
+        "   %%obj.tally = %%obj.tally + 1;"
+        "}",
+        iterations );
+
+    gScriptFieldCache = oldFieldCache;
+
+    return (SimObjectId)Con::getIntVariable( "$FieldLookupTest::object" );
+}
+
+//-----------------------------------------------------------------------------
+
+TEST( SimFieldLookupTests, hashedMatchesLinearTest )
+{
+    StringTableEntry missingName = StringTable->insert( "fieldLookupTestMissingField" );
+
+    for ( AbstractClassRep* pRep = AbstractClassRep::getClassList(); pRep != NULL; pRep = pRep->getNextClass() )
+    {
+        for ( S32 i = 0; i < pRep->mFieldList.size(); ++i )
+        {
+            StringTableEntry fieldName = pRep->mFieldList[i].pFieldname;
+            ASSERT_EQ( pRep->findFieldLinear(fieldName), pRep->findField(fieldName) ) << "Hashed lookup differs for " << pRep->getClassName() << "." << fieldName;
+        }
+
+        ASSERT_TRUE( pRep->findField(missingName) == NULL ) << "Found a missing field on " << pRep->getClassName();
+    }
+}
+
+//-----------------------------------------------------------------------------
+
+TEST( SimFieldLookupTests, scriptFieldAccessTest )
+{
+    for ( U32 pass = 0; pass < 2; ++pass )
+    {
+        const bool fieldCache = pass == 0;
+
+        FieldLookupTestObject* pObject = dynamic_cast<FieldLookupTestObject*>( Sim::findObject( runFieldScript(fieldCache, FIELDLOOKUP_UNITTEST_ITERATIONS) ) );
+        ASSERT_TRUE( pObject != NULL ) << "Script did not create the test object.";
+
+        ASSERT_EQ( (S32)FIELDLOOKUP_UNITTEST_ITERATIONS, pObject->mLevel ) << "S32 field mismatch, cache " << fieldCache;
+        ASSERT_EQ( (S32)FIELDLOOKUP_UNITTEST_ITERATIONS * 2, pObject->mCount[1] ) << "S32 array field mismatch, cache " << fieldCache;
+        ASSERT_EQ( 0, pObject->mCount[0] ) << "S32 array field spilled, cache " << fieldCache;
+        ASSERT_EQ( FIELDLOOKUP_UNITTEST_ITERATIONS * 0.5f, pObject->mSpeed ) << "F32 field mismatch, cache " << fieldCache;
+        ASSERT_EQ( 1.0f, pObject->mScale ) << "F32 field mismatch, cache " << fieldCache;
+        ASSERT_EQ( (FIELDLOOKUP_UNITTEST_ITERATIONS & 1) != 0, pObject->mEnabled ) << "Bool field mismatch, cache " << fieldCache;
+        ASSERT_EQ( (S32)FIELDLOOKUP_UNITTEST_ITERATIONS, dAtoi(pObject->getDataField(StringTable->insert("tally"), NULL)) ) << "Dynamic field mismatch, cache " << fieldCache;
+
+        // The string accessors must agree with the console types.
+        StringTableEntry speedName = StringTable->insert( "speed" );
+        const AbstractClassRep::Field* pField = pObject->findField( speedName );
+        ASSERT_STREQ( Con::getData(TypeF32, &pObject->mSpeed, 0), pObject->getDataField(speedName, NULL) ) << "F32 string mismatch.";
+
+        pObject->setDataField( pField, speedName, NULL, "2.25" );
+        ASSERT_EQ( 2.25f, pObject->mSpeed ) << "Resolved F32 set failed.";
+
+        pObject->setDataField( StringTable->insert("enabled"), NULL, "true" );
+        ASSERT_TRUE( pObject->mEnabled ) << "Bool field did not accept \"true\".";
+
+        pObject->deleteObject();
+    }
+}
+
+//-----------------------------------------------------------------------------
+
+TEST( SimFieldLookupTests, fieldLookupBenchmarkTest )
+{
+    AbstractClassRep* pRep = AbstractClassRep::findClassRep( "FieldLookupTestObject" );
+    ASSERT_TRUE( pRep != NULL ) << "Test class is not registered.";
+
+    // The class's own fields sit at the end of the inherited list and a
+    // dynamic field name misses entirely, the worst cases for a linear scan.
+    StringTableEntry fieldNames[4] =
+    {
+        StringTable->insert( "level" ),
+        StringTable->insert( "speed" ),
+        StringTable->insert( "enabled" ),
+        StringTable->insert( "tally" ),
+    };
+
+    U32 found = 0;
+    U32 startTime = Platform::getRealMilliseconds();
+    for ( U32 i = 0; i < FIELDLOOKUP_UNITTEST_BENCHLOOKUPS; ++i )
+        found += pRep->findFieldLinear( fieldNames[i & 3] ) != NULL;
+    const U32 linearTime = Platform::getRealMilliseconds() - startTime;
+
+    startTime = Platform::getRealMilliseconds();
+    for ( U32 i = 0; i < FIELDLOOKUP_UNITTEST_BENCHLOOKUPS; ++i )
+        found -= pRep->findField( fieldNames[i & 3] ) != NULL;
+    const U32 hashedTime = Platform::getRealMilliseconds() - startTime;
+
+    ASSERT_EQ( 0, found ) << "Hashed and linear lookups found different fields.";
+
+    startTime = Platform::getRealMilliseconds();
+    SimObject* pUncached = Sim::findObject( runFieldScript(false, FIELDLOOKUP_UNITTEST_BENCHITERATIONS) );
+    const U32 uncachedTime = Platform::getRealMilliseconds() - startTime;
+
+    startTime = Platform::getRealMilliseconds();
+    SimObject* pCached = Sim::findObject( runFieldScript(true, FIELDLOOKUP_UNITTEST_BENCHITERATIONS) );
+    const U32 cachedTime = Platform::getRealMilliseconds() - startTime;
+
+    ASSERT_TRUE( pUncached != NULL && pCached != NULL ) << "Script did not create the test objects.";
+    pUncached->deleteObject();
+    pCached->deleteObject();
+
+    Con::printf( "SimFieldLookup: %d lookups. Linear: %dms, hashed: %dms.", FIELDLOOKUP_UNITTEST_BENCHLOOKUPS, linearTime, hashedTime );
+    Con::printf( "SimFieldLookup: %d script iterations. Uncached: %dms, cached: %dms.", FIELDLOOKUP_UNITTEST_BENCHITERATIONS, uncachedTime, cachedTime );
+}
+
+#endif // TORQUE_SHIPPING
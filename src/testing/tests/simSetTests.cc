@@ -0,0 +1,181 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2013 GarageGames, LLC
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//-----------------------------------------------------------------------------
+
+// We don't want tests in a shipping version.
+#ifndef TORQUE_SHIPPING
+
+#ifndef _UNIT_TESTING_H_
+#include "testing/unitTesting.h"
+#endif
+
+#ifndef _PLATFORM_H_
+#include "platform/platform.h"
+#endif
+
+#ifndef _CONSOLE_H_
+#include "console/console.h"
+#endif
+
+#ifndef _STRINGTABLE_H_
+#include "string/stringTable.h"
+#endif
+
+#ifndef _SIMBASE_H_
+#include "sim/simBase.h"
+#endif
+
+#ifndef _VECTOR_H_
+#include "collection/vector.h"
+#endif
+
+//-----------------------------------------------------------------------------
+
+#define SIMSET_UNITTEST_OBJECTS         64
+#define SIMSET_UNITTEST_BENCHOBJECTS    100000
+
+//-----------------------------------------------------------------------------
+
+static void createTestObjects( Vector<SimObject*>& objects, const U32 count, const U32 nameCount )
+{
+    char nameBuffer[32];
+    objects.reserve( count );
+
+    for ( U32 i = 0; i < count; ++i )
+    {
+        SimObject* pObject = new SimObject();
+        pObject->registerObject();
+
+        dSprintf( nameBuffer, sizeof(nameBuffer), "simSetTest%d", i % nameCount );
+        pObject->setInternalName( nameBuffer );
+
+        objects.push_back( pObject );
+    }
+}
+
+//-----------------------------------------------------------------------------
+
+TEST( SimSetTests, membershipOrderTest )
+{
+    Vector<SimObject*> objects;
+    createTestObjects( objects, SIMSET_UNITTEST_OBJECTS, 8 );
+
+    SimSet* pSet = new SimSet();
+    pSet->registerObject();
+
+    for ( U32 i = 0; i < (U32)objects.size(); ++i )
+        pSet->addObject( objects[i] );
+
+    // Remove every third object, which leaves holes to pack.
+    for ( U32 i = 0; i < (U32)objects.size(); i += 3 )
+        pSet->removeObject( objects[i] );
+
+    U32 index = 0;
+    for ( U32 i = 0; i < (U32)objects.size(); ++i )
+    {
+        if ( (i % 3) == 0 )
+        {
+            ASSERT_FALSE( pSet->contains(objects[i]) ) << "Removed object " << i << " is still a member.";
+            continue;
+        }
+
+        ASSERT_TRUE( pSet->contains(objects[i]) ) << "Object " << i << " is missing.";
+        ASSERT_EQ( objects[i], pSet->at(index++) ) << "Object " << i << " is out of order.";
+    }
+
+    ASSERT_EQ( (S32)index, pSet->size() ) << "Set size mismatch.";
+
+    // Reordering and removing from the ends keep the order too.
+    pSet->bringObjectToFront( objects[2] );
+    pSet->pushObjectToBack( objects[1] );
+    pSet->removeObject( pSet->first() );
+    pSet->removeObject( pSet->last() );
+    ASSERT_EQ( objects[4], pSet->first() ) << "Front removal mismatch.";
+    ASSERT_EQ( objects[SIMSET_UNITTEST_OBJECTS - 2], pSet->last() ) << "Back removal mismatch.";
+
+    // The internal name index finds the first member with a name, and follows renames.
+    StringTableEntry internalName = StringTable->insert( "simSetTest5" );
+    SimObject* pExpected = pSet->findObjectByInternalName( internalName );
+    pSet->setInternalNameIndex( true );
+    ASSERT_EQ( pExpected, pSet->findObjectByInternalName(internalName) ) << "Indexed lookup mismatch.";
+
+    pExpected->setInternalName( "simSetTestRenamed" );
+    ASSERT_NE( pExpected, pSet->findObjectByInternalName(internalName) ) << "Renamed object was still found.";
+    ASSERT_EQ( pExpected, pSet->findObjectByInternalName(StringTable->insert("simSetTestRenamed")) ) << "Renamed object was not found.";
+
+    pSet->deleteObject();
+
+    for ( U32 i = 0; i < (U32)objects.size(); ++i )
+        objects[i]->deleteObject();
+}
+
+//-----------------------------------------------------------------------------
+
+TEST( SimSetTests, teardownBenchmarkTest )
+{
+    Vector<SimObject*> objects;
+    createTestObjects( objects, SIMSET_UNITTEST_BENCHOBJECTS, SIMSET_UNITTEST_BENCHOBJECTS );
+
+    SimSet* pSet = new SimSet();
+    pSet->registerObject();
+    SimGroup* pGroup = new SimGroup();
+    pGroup->registerObject();
+
+    U32 startTime = Platform::getRealMilliseconds();
+    for ( U32 i = 0; i < (U32)objects.size(); ++i )
+    {
+        pSet->addObject( objects[i] );
+        pGroup->addObject( objects[i] );
+    }
+    const U32 fillTime = Platform::getRealMilliseconds() - startTime;
+
+    // Membership tests and internal name lookups.
+    U32 misses = 0;
+    pGroup->setInternalNameIndex( true );
+    startTime = Platform::getRealMilliseconds();
+    for ( U32 i = 0; i < (U32)objects.size(); ++i )
+    {
+        if ( !pSet->contains(objects[i]) || pGroup->findObjectByInternalName(objects[i]->getInternalName()) != objects[i] )
+            misses++;
+    }
+    const U32 lookupTime = Platform::getRealMilliseconds() - startTime;
+
+    ASSERT_EQ( 0u, misses ) << "Lookups failed.";
+
+    // Remove from the set in a scattered order, then delete the group's
+    // objects front to back, which notifies the set as well.
+    startTime = Platform::getRealMilliseconds();
+    for ( U32 i = 0; i < (U32)objects.size(); i += 2 )
+        pSet->removeObject( objects[(i * 7919) % objects.size()] );
+    pGroup->deleteObjects();
+    const U32 teardownTime = Platform::getRealMilliseconds() - startTime;
+
+    ASSERT_EQ( 0, pSet->size() ) << "Set was not emptied.";
+    ASSERT_EQ( 0, pGroup->size() ) << "Group was not emptied.";
+
+    Con::printf( "SimSet: %d objects added in %dms, looked up in %dms, torn down in %dms.",
+        SIMSET_UNITTEST_BENCHOBJECTS, fillTime, lookupTime, teardownTime );
+
+    pSet->deleteObject();
+    pGroup->deleteObject();
+}
+
+#endif // TORQUE_SHIPPING
@@ -0,0 +1,239 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2013 GarageGames, LLC
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//-----------------------------------------------------------------------------
+
+// We don't want tests in a shipping version.
+#ifndef TORQUE_SHIPPING
+
+#ifndef _UNIT_TESTING_H_
+#include "testing/unitTesting.h"
+#endif
+
+#ifndef _PLATFORM_H_
+#include "platform/platform.h"
+#endif
+
+#ifndef _CONSOLE_H_
+#include "console/console.h"
+#endif
+
+#ifndef _TAML_H_
+#include "persistence/taml/taml.h"
+#endif
+
+#ifndef _SCENE_OBJECT_H_
+#include "scene/object.h"
+#endif
+
+#ifndef _TEXTURE_ASSET_H_
+#include "graphics/textureAsset.h"
+#endif
+
+//-----------------------------------------------------------------------------
+
+#define TAMLCOMPILED_UNITTEST_OBJECTS       500
+#define TAMLCOMPILED_UNITTEST_ENTITIES      50000
+#define TAMLCOMPILED_UNITTEST_ASSETS        20000
+#define TAMLCOMPILED_UNITTEST_FILE          "_unitTestTamlCompiled_RemoveMe"
+
+static const char* tamlCompiledExtensions[] = { "taml", "json", "baml", "ctaml" };
+
+//-----------------------------------------------------------------------------
+
+// A group of scene objects with a protected, a plain numeric and a dynamic field.
+static SimGroup* createSceneGroup( const U32 objectCount )
+{
+    char valueBuffer[64];
+
+    SimGroup* pGroup = new SimGroup();
+    pGroup->registerObject();
+    for( U32 index = 0; index < objectCount; ++index )
+    {
+        Scene::SceneObject* pObject = new Scene::SceneObject();
+        pObject->registerObject();
+        dSprintf( valueBuffer, sizeof(valueBuffer), "%d %d 0", index % 256, index / 256 );
+        pObject->setDataField( StringTable->insert( "Position" ), NULL, valueBuffer );
+        pObject->setDataField( StringTable->insert( "Static" ), NULL, index % 2 == 0 ? "true" : "false" );
+        dSprintf( valueBuffer, sizeof(valueBuffer), "%d", index );
+        pObject->setDataField( StringTable->insert( "order" ), NULL, valueBuffer );
+        pGroup->addObject( pObject );
+    }
+
+    return pGroup;
+}
+
+//-----------------------------------------------------------------------------
+
+static void checkSceneGroup( SimGroup* pGroup, const U32 objectCount, const char* pFilename )
+{
+    char valueBuffer[64];
+
+    ASSERT_TRUE( pGroup != NULL ) << "No root read from " << pFilename;
+    ASSERT_EQ( (S32)objectCount, pGroup->size() ) << "Object count mismatch in " << pFilename;
+
+    for( S32 index = 0; index < pGroup->size(); ++index )
+    {
+        SimObject* pObject = pGroup->at( index );
+        ASSERT_TRUE( dynamic_cast<Scene::SceneObject*>( pObject ) != NULL ) << "Object type mismatch in " << pFilename;
+        ASSERT_EQ( index, dAtoi( pObject->getDataField( StringTable->insert( "order" ), NULL ) ) ) << "Dynamic field mismatch in " << pFilename;
+        ASSERT_EQ( index % 2 == 0, dAtob( pObject->getDataField( StringTable->insert( "Static" ), NULL ) ) ) << "Numeric field mismatch in " << pFilename;
+
+        Point3F position;
+        dSscanf( pObject->getDataField( StringTable->insert( "Position" ), NULL ), "%g %g %g", &position.x, &position.y, &position.z );
+        ASSERT_EQ( (F32)(index % 256), position.x ) << "Protected field mismatch in " << pFilename;
+        ASSERT_EQ( (F32)(index / 256), position.y ) << "Protected field mismatch in " << pFilename;
+    }
+}
+
+//-----------------------------------------------------------------------------
+
+TEST( TamlCompiledTests, compiledReadTest )
+{
+    char fileBuffer[256];
+    dSprintf( fileBuffer, sizeof(fileBuffer), "%s.ctaml", TAMLCOMPILED_UNITTEST_FILE );
+
+    SimGroup* pGroup = createSceneGroup( TAMLCOMPILED_UNITTEST_OBJECTS );
+
+    // Uncompressed so the class table can be patched below.
+    Taml taml;
+    taml.setBinaryCompression( false );
+    ASSERT_TRUE( taml.write( pGroup, fileBuffer ) ) << "Failed to write " << fileBuffer;
+
+    // Read with the layout unchanged, numeric fields are set in place.
+    SimGroup* pReadGroup = taml.read<SimGroup>( fileBuffer );
+    checkSceneGroup( pReadGroup, TAMLCOMPILED_UNITTEST_OBJECTS, fileBuffer );
+    if ( pReadGroup != NULL )
+        pReadGroup->deleteObject();
+
+    // Change the layout hash of the scene object class as if its fields had changed since writing.
+    FileStream stream;
+    ASSERT_TRUE( stream.open( fileBuffer, FileStream::ReadWrite ) );
+    U32 versionId;
+    bool compressed;
+    U32 classCount;
+    stream.readSTString();
+    stream.read( &versionId );
+    stream.read( &compressed );
+    stream.read( &classCount );
+    bool patched = false;
+    for( U32 classIndex = 0; classIndex < classCount; ++classIndex )
+    {
+        StringTableEntry className = stream.readSTString();
+        const U32 layoutHashPosition = stream.getPosition();
+        U32 layoutHash;
+        stream.read( &layoutHash );
+
+        if ( className == StringTable->insert( "SceneObject" ) )
+        {
+            stream.setPosition( layoutHashPosition );
+            stream.write( ~layoutHash );
+            patched = true;
+            break;
+        }
+
+        // Skip the field table.
+        U16 fieldCount;
+        stream.read( &fieldCount );
+        for( U16 fieldIndex = 0; fieldIndex < fieldCount; ++fieldIndex )
+        {
+            U8 valueKind;
+            stream.readSTString();
+            stream.read( &valueKind );
+        }
+    }
+    stream.close();
+    ASSERT_TRUE( patched ) << "No scene object class in " << fileBuffer;
+
+    // Read again, the fields are now found by name and set through strings.
+    pReadGroup = taml.read<SimGroup>( fileBuffer );
+    checkSceneGroup( pReadGroup, TAMLCOMPILED_UNITTEST_OBJECTS, fileBuffer );
+    if ( pReadGroup != NULL )
+        pReadGroup->deleteObject();
+
+    Platform::fileDelete( fileBuffer );
+    pGroup->deleteObject();
+}
+
+//-----------------------------------------------------------------------------
+
+TEST( TamlCompiledTests, loadBenchmarkTest )
+{
+    char fileBuffer[256];
+    char valueBuffer[64];
+
+    // A large scene.
+    SimGroup* pSceneGroup = createSceneGroup( TAMLCOMPILED_UNITTEST_ENTITIES );
+
+    // A large set of asset declarations.
+    SimGroup* pAssetGroup = new SimGroup();
+    pAssetGroup->registerObject();
+    for( U32 index = 0; index < TAMLCOMPILED_UNITTEST_ASSETS; ++index )
+    {
+        TextureAsset* pAsset = new TextureAsset();
+        dSprintf( valueBuffer, sizeof(valueBuffer), "Texture%d", index );
+        pAsset->setAssetName( valueBuffer );
+        pAsset->setAssetDescription( "A texture declared for the compiled Taml benchmark." );
+        pAsset->setAssetCategory( index % 2 == 0 ? "Terrain" : "Props" );
+        pAsset->setAssetAutoUnload( index % 3 != 0 );
+        pAsset->registerObject();
+        pAssetGroup->addObject( pAsset );
+    }
+
+    SimGroup* pGroups[] = { pSceneGroup, pAssetGroup };
+    const char* pGroupNames[] = { "scene", "asset declaration" };
+
+    for( U32 group = 0; group < 2; ++group )
+    {
+        for( U32 format = 0; format < sizeof(tamlCompiledExtensions) / sizeof(const char*); ++format )
+        {
+            dSprintf( fileBuffer, sizeof(fileBuffer), "%s.%s", TAMLCOMPILED_UNITTEST_FILE, tamlCompiledExtensions[format] );
+
+            Taml taml;
+            ASSERT_TRUE( taml.write( pGroups[group], fileBuffer ) ) << "Failed to write " << fileBuffer;
+
+            const U32 startTime = Platform::getRealMilliseconds();
+            SimGroup* pReadGroup = taml.read<SimGroup>( fileBuffer );
+            const U32 loadTime = Platform::getRealMilliseconds() - startTime;
+
+            ASSERT_TRUE( pReadGroup != NULL ) << "No root read from " << fileBuffer;
+            ASSERT_EQ( pGroups[group]->size(), pReadGroup->size() ) << "Object count mismatch in " << fileBuffer;
+
+            if ( group == 1 )
+            {
+                TextureAsset* pAsset = dynamic_cast<TextureAsset*>( pReadGroup->last() );
+                ASSERT_TRUE( pAsset != NULL ) << "Asset type mismatch in " << fileBuffer;
+                ASSERT_EQ( static_cast<TextureAsset*>( pAssetGroup->last() )->getAssetName(), pAsset->getAssetName() ) << "Asset name mismatch in " << fileBuffer;
+            }
+
+            pReadGroup->deleteObject();
+
+            Con::printf( "Taml: %d object '%s' %s loaded in %dms.",
+                pGroups[group]->size(), tamlCompiledExtensions[format], pGroupNames[group], loadTime );
+
+            Platform::fileDelete( fileBuffer );
+        }
+    }
+
+    pAssetGroup->deleteObject();
+    pSceneGroup->deleteObject();
+}
+
+#endif // TORQUE_SHIPPING
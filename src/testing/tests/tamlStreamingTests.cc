@@ -0,0 +1,227 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2013 GarageGames, LLC
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//-----------------------------------------------------------------------------
+
+// We don't want tests in a shipping version.
+#ifndef TORQUE_SHIPPING
+
+#ifndef _UNIT_TESTING_H_
+#include "testing/unitTesting.h"
+#endif
+
+#ifndef _PLATFORM_H_
+#include "platform/platform.h"
+#endif
+
+#ifndef _CONSOLE_H_
+#include "console/console.h"
+#endif
+
+#ifndef _JOB_SYSTEM_H_
+#include "platform/threads/jobSystem.h"
+#endif
+
+#ifndef _JOB_SYSTEM_TEST_SCOPE_H_
+#include "testing/jobSystemTestScope.h"
+#endif
+
+#ifndef _TAML_ASYNC_READER_H_
+#include "persistence/taml/tamlAsyncReader.h"
+#endif
+
+#ifndef _SCENE_CORE_H_
+#include "scene/scene.h"
+#endif
+
+#ifndef _SCENE_OBJECT_H_
+#include "scene/object.h"
+#endif
+
+//-----------------------------------------------------------------------------
+
+#define TAMLSTREAMING_UNITTEST_OBJECTS      200
+#define TAMLSTREAMING_UNITTEST_ENTITIES     50000
+#define TAMLSTREAMING_UNITTEST_BUDGET       4
+#define TAMLSTREAMING_UNITTEST_FILE         "_unitTestTaml_RemoveMe"
+
+static const char* tamlStreamingExtensions[] = { "taml", "baml", "json", "ctaml" };
+
+//-----------------------------------------------------------------------------
+
+// At least one worker so parsing really happens off the main thread.
+static U32 getTestWorkerCount()
+{
+    return getMax( JobSystem::getCoreCount(), (U32)2 ) - 1;
+}
+
+static void deleteSceneObjects( const S32 keepCount )
+{
+    SimGroup* pSceneGroup = Scene::getSceneGroup();
+    while ( pSceneGroup->size() > keepCount )
+    {
+        Scene::SceneObject* pObject = dynamic_cast<Scene::SceneObject*>( pSceneGroup->last() );
+        Scene::removeObject( pObject );
+        pObject->deleteObject();
+    }
+}
+
+//-----------------------------------------------------------------------------
+
+TEST( TamlStreamingTests, asyncReadMatchesReadTest )
+{
+    JobSystemTestScope scope( getTestWorkerCount() );
+    char fileBuffer[256];
+    char valueBuffer[32];
+
+    // A group of named objects with a nested group, written in every format.
+    SimGroup* pGroup = new SimGroup();
+    pGroup->registerObject();
+    for( U32 index = 0; index < TAMLSTREAMING_UNITTEST_OBJECTS; ++index )
+    {
+        SimObject* pObject = index % 10 == 0 ? new SimGroup() : new SimObject();
+        pObject->registerObject();
+        dSprintf( valueBuffer, sizeof(valueBuffer), "%d", index );
+        pObject->setDataField( StringTable->insert( "order" ), NULL, valueBuffer );
+        pGroup->addObject( pObject );
+
+        if ( index % 10 == 0 )
+        {
+            SimObject* pChild = new SimObject();
+            pChild->registerObject();
+            static_cast<SimGroup*>( pObject )->addObject( pChild );
+        }
+    }
+
+    for( U32 format = 0; format < sizeof(tamlStreamingExtensions) / sizeof(const char*); ++format )
+    {
+        dSprintf( fileBuffer, sizeof(fileBuffer), "%s.%s", TAMLSTREAMING_UNITTEST_FILE, tamlStreamingExtensions[format] );
+
+        Taml taml;
+        ASSERT_TRUE( taml.write( pGroup, fileBuffer ) ) << "Failed to write " << fileBuffer;
+
+        // Read it back in slices.
+        TamlAsyncReader asyncReader( &taml );
+        ASSERT_TRUE( asyncReader.start( fileBuffer ) );
+        U32 updates = 0;
+        while ( !asyncReader.update( 0 ) )
+            ++updates;
+
+        SimGroup* pReadGroup = dynamic_cast<SimGroup*>( asyncReader.getRootObject() );
+        ASSERT_TRUE( pReadGroup != NULL ) << "No root read from " << fileBuffer;
+        ASSERT_EQ( pGroup->size(), pReadGroup->size() ) << "Child count mismatch in " << fileBuffer;
+        ASSERT_GE( updates, (U32)TAMLSTREAMING_UNITTEST_OBJECTS - 1 ) << "Children weren't read one at a time from " << fileBuffer;
+
+        for( S32 index = 0; index < pReadGroup->size(); ++index )
+        {
+            SimObject* pObject = pReadGroup->at( index );
+            ASSERT_EQ( index, dAtoi( pObject->getDataField( StringTable->insert( "order" ), NULL ) ) ) << "Child order mismatch in " << fileBuffer;
+
+            SimGroup* pNestedGroup = dynamic_cast<SimGroup*>( pObject );
+            ASSERT_EQ( index % 10 == 0, pNestedGroup != NULL ) << "Child type mismatch in " << fileBuffer;
+            if ( pNestedGroup != NULL )
+            {
+                ASSERT_EQ( 1, pNestedGroup->size() ) << "Nested child missing in " << fileBuffer;
+            }
+        }
+
+        pReadGroup->deleteObject();
+        Platform::fileDelete( fileBuffer );
+    }
+
+    pGroup->deleteObject();
+}
+
+//-----------------------------------------------------------------------------
+
+TEST( TamlStreamingTests, sceneLoadBenchmarkTest )
+{
+    JobSystemTestScope scope( getTestWorkerCount() );
+    char fileBuffer[256];
+
+    char valueBuffer[64];
+
+    // Generate the scene.
+    SimGroup* pGroup = new SimGroup();
+    pGroup->registerObject();
+    for( U32 index = 0; index < TAMLSTREAMING_UNITTEST_ENTITIES; ++index )
+    {
+        Scene::SceneObject* pObject = new Scene::SceneObject();
+        pObject->registerObject();
+        dSprintf( valueBuffer, sizeof(valueBuffer), "%d %d 0", index % 256, index / 256 );
+        pObject->setDataField( StringTable->insert( "Position" ), NULL, valueBuffer );
+        pGroup->addObject( pObject );
+    }
+
+    // Appending keeps whatever the scene already holds.
+    const S32 sceneSize = Scene::getSceneGroup()->size();
+
+    for( U32 format = 0; format < sizeof(tamlStreamingExtensions) / sizeof(const char*); ++format )
+    {
+        dSprintf( fileBuffer, sizeof(fileBuffer), "%s.%s", TAMLSTREAMING_UNITTEST_FILE, tamlStreamingExtensions[format] );
+
+        Taml taml;
+        ASSERT_TRUE( taml.write( pGroup, fileBuffer ) ) << "Failed to write " << fileBuffer;
+
+        // Synchronous load, the whole load is one frame.
+        U32 startTime = Platform::getRealMilliseconds();
+        Scene::load( fileBuffer, true );
+        const U32 loadTime = Platform::getRealMilliseconds() - startTime;
+
+        ASSERT_EQ( TAMLSTREAMING_UNITTEST_ENTITIES, Scene::getSceneGroup()->size() - sceneSize ) << "Load lost entities from " << fileBuffer;
+        deleteSceneObjects( sceneSize );
+
+        // Streaming load, a frame is one Scene::processLoading() from the main loop.
+        const S32 loadBudget = Con::getIntVariable( "$Scene::loadBudget" );
+        Con::setIntVariable( "$Scene::loadBudget", TAMLSTREAMING_UNITTEST_BUDGET );
+
+        startTime = Platform::getRealMilliseconds();
+        Scene::loadAsync( fileBuffer, true );
+        U32 maxFrameTime = Platform::getRealMilliseconds() - startTime;
+        U32 frames = 1;
+
+        while ( Scene::isLoading() )
+        {
+            const U32 frameTime = Platform::getRealMilliseconds();
+            Scene::processLoading();
+            maxFrameTime = getMax( maxFrameTime, Platform::getRealMilliseconds() - frameTime );
+            ++frames;
+
+            // Let the worker have the core.
+            Platform::sleep( 0 );
+        }
+        const U32 asyncLoadTime = Platform::getRealMilliseconds() - startTime;
+
+        Con::setIntVariable( "$Scene::loadBudget", loadBudget );
+
+        ASSERT_EQ( TAMLSTREAMING_UNITTEST_ENTITIES, Scene::getSceneGroup()->size() - sceneSize ) << "Streaming load lost entities from " << fileBuffer;
+        ASSERT_GT( frames, (U32)2 ) << "Streaming load of " << fileBuffer << " wasn't spread over frames.";
+        deleteSceneObjects( sceneSize );
+
+        Con::printf( "Taml: %d entity '%s' scene loaded in %dms, streamed in %dms over %d frames with a %dms worst frame.",
+            TAMLSTREAMING_UNITTEST_ENTITIES, tamlStreamingExtensions[format], loadTime, asyncLoadTime, frames, maxFrameTime );
+
+        Platform::fileDelete( fileBuffer );
+    }
+
+    pGroup->deleteObject();
+}
+
+#endif // TORQUE_SHIPPING
@@ -0,0 +1,368 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2013 GarageGames, LLC
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//-----------------------------------------------------------------------------
+
+// We don't want tests in a shipping version.
+#ifndef TORQUE_SHIPPING
+
+#ifndef _UNIT_TESTING_H_
+#include "testing/unitTesting.h"
+#endif
+
+#ifndef _PLATFORM_H_
+#include "platform/platform.h"
+#endif
+
+#ifndef _MRANDOM_H_
+#include "math/mRandom.h"
+#endif
+
+#ifndef _JOB_SYSTEM_H_
+#include "platform/threads/jobSystem.h"
+#endif
+
+#ifndef _JOB_SYSTEM_TEST_SCOPE_H_
+#include "testing/jobSystemTestScope.h"
+#endif
+
+#ifndef _TERRAIN_QUADTREE_H_
+#include "graphics/terrainQuadTree.h"
+#endif
+
+#ifndef _GRAPHICS_UTILITIES_H_
+#include "graphics/utilities.h"
+#endif
+
+#ifndef _CONSOLE_H_
+#include "console/console.h"
+#endif
+
+//-----------------------------------------------------------------------------
+
+#define TERRAINQUADTREE_UNITTEST_LARGESIZE      16385
+#define TERRAINQUADTREE_UNITTEST_SMALLSIZE      129
+#define TERRAINQUADTREE_UNITTEST_CAMERAS        1000
+#define TERRAINQUADTREE_UNITTEST_MAXCHUNKS      128
+
+//-----------------------------------------------------------------------------
+
+// Rolling hills without storing 16k x 16k heights.
+class ProceduralHeightSource : public TerrainHeightSource
+{
+public:
+    virtual F32 getHeight( U32 x, U32 y ) const
+    {
+        const S32 hillX = 1024 - mAbs( (S32)( x & 2047 ) - 1024 );
+        const S32 hillY = 512 - mAbs( (S32)( y & 1023 ) - 512 );
+        return ( hillX + hillY ) * 0.25f + ( ( x ^ y ) & 7 ) * 0.5f;
+    }
+};
+
+static ProceduralHeightSource largeSource;
+static TerrainQuadTree largeTree;
+
+static const TerrainQuadTree& getLargeTree()
+{
+    if ( largeTree.isEmpty() )
+        largeTree.build( &largeSource, TERRAINQUADTREE_UNITTEST_LARGESIZE, TERRAINQUADTREE_UNITTEST_LARGESIZE );
+
+    return largeTree;
+}
+
+static Point3F getCamera( U32 x, U32 y )
+{
+    return Point3F( (F32)x, (F32)y, largeSource.getHeight( x, y ) + 20.0f );
+}
+
+// Checks the selection covers every quad once and every level is used
+// within its range only.
+static void checkSelection( const TerrainQuadTree& tree, const Point3F& camera, const Vector<TerrainQuadTree::SelectedNode>& selection )
+{
+    const U32 top = tree.getLevelCount() - 1;
+    U64 area = 0;
+
+    for( S32 n = 0; n < selection.size(); ++n )
+    {
+        const TerrainQuadTree::SelectedNode& node = selection[n];
+        const U32 extent = TerrainQuadTree::getNodeExtent( node.level );
+        const U32 half = extent / 2;
+
+        ASSERT_NE( 0, node.quadrants ) << "Selected a node without quadrants.";
+        ASSERT_EQ( tree.getNodeIndex( node.x / extent, node.y / extent, node.level ), node.index ) << "Wrong node index.";
+
+        const F32 range = tree.getRange( node.level );
+        if ( node.level < top )
+        {
+            ASSERT_LE( tree.getChunkBox( node.x, node.y, node.level ).getSqDistanceToPoint( camera ), range * range ) << "Node selected beyond the range of its level.";
+        }
+
+        for( U32 i = 0; i < 4; ++i )
+        {
+            if ( !( node.quadrants & BIT( i ) ) )
+                continue;
+
+            area += (U64)half * half;
+
+            // The finer level would have been used if it were in range.
+            if ( node.level > 0 )
+            {
+                const F32 childRange = tree.getRange( node.level - 1 );
+                const Box3F childBox = tree.getChunkBox( node.x + ( i & 1 ) * half, node.y + ( i >> 1 ) * half, node.level - 1 );
+                ASSERT_GT( childBox.getSqDistanceToPoint( camera ), childRange * childRange ) << "Quadrant drawn coarser than its range allows.";
+            }
+        }
+    }
+
+    ASSERT_EQ( (U64)( tree.getWidth() - 1 ) * ( tree.getHeight() - 1 ), area ) << "Selection doesn't cover the terrain exactly once.";
+}
+
+struct ChunkBuildData
+{
+    const TerrainQuadTree*                      mTree;
+    const Vector<TerrainQuadTree::SelectedNode>* mSelection;
+    Graphics::PosUVNormalMorphVertex*           mVerts;
+};
+
+static void buildChunksJob( void* data, U32 first, U32 count )
+{
+    ChunkBuildData* build = (ChunkBuildData*)data;
+    for( U32 n = first; n < first + count; ++n )
+    {
+        const TerrainQuadTree::SelectedNode& node = ( *build->mSelection )[n];
+        build->mTree->buildChunk( node.x, node.y, node.level, build->mVerts + ( n * TerrainQuadTree::ChunkVertexCount ) );
+    }
+}
+
+//-----------------------------------------------------------------------------
+
+TEST( TerrainQuadTreeTests, selectionTest )
+{
+    JobSystemTestScope scope;
+    const TerrainQuadTree& tree = getLargeTree();
+
+    // 64 quad chunks doubling up to a single 16k root.
+    ASSERT_EQ( 9, tree.getLevelCount() ) << "Unexpected level count.";
+    ASSERT_LE( (U32)TerrainQuadTree::ChunkVertexCount, (U32)U16_MAX + 1 ) << "Chunks don't fit 16 bit indices.";
+
+    const U32 cameras[][2] = { { 0, 0 }, { 8192, 8192 }, { 100, 16000 }, { 16384, 16384 }, { 5000, 12345 } };
+    Vector<TerrainQuadTree::SelectedNode> selection;
+
+    for( U32 n = 0; n < sizeof( cameras ) / sizeof( cameras[0] ); ++n )
+    {
+        const Point3F camera = getCamera( cameras[n][0], cameras[n][1] );
+        tree.select( camera, selection );
+        checkSelection( tree, camera, selection );
+
+        // Full detail around the camera.
+        bool underCamera = false;
+        for( S32 i = 0; i < selection.size(); ++i )
+        {
+            const TerrainQuadTree::SelectedNode& node = selection[i];
+            const U32 extent = TerrainQuadTree::getNodeExtent( node.level );
+            if ( camera.x >= node.x && camera.x <= node.x + extent && camera.y >= node.y && camera.y <= node.y + extent )
+                underCamera |= ( node.level == 0 );
+        }
+        ASSERT_TRUE( underCamera ) << "Terrain under the camera isn't at full detail.";
+
+        // A tiny fraction of the 268M full resolution vertices.
+        const U64 vertexCount = (U64)selection.size() * TerrainQuadTree::ChunkVertexCount;
+        const U64 fullCount = (U64)tree.getWidth() * tree.getHeight();
+        ASSERT_LT( vertexCount * 100, fullCount ) << "Selection uses too many vertices.";
+
+        Con::printf( "TerrainQuadTree: camera (%d, %d) selected %d chunks, %d vertices (full resolution %d).",
+            cameras[n][0], cameras[n][1], selection.size(), (U32)vertexCount, (U32)fullCount );
+    }
+}
+
+//-----------------------------------------------------------------------------
+
+TEST( TerrainQuadTreeTests, chunkIndicesTest )
+{
+    U16* indices = new U16[TerrainQuadTree::ChunkIndexCount];
+
+    for( U32 quadrants = 1; quadrants <= TerrainQuadTree::AllQuadrants; ++quadrants )
+    {
+        U32 quadrantCount = 0;
+        for( U32 i = 0; i < 4; ++i )
+            quadrantCount += ( quadrants & BIT( i ) ) ? 1 : 0;
+
+        const U32 count = TerrainQuadTree::buildChunkIndices( quadrants, indices );
+        ASSERT_EQ( ( TerrainQuadTree::ChunkIndexCount / 4 ) * quadrantCount, count ) << "Wrong index count for quadrant mask.";
+
+        for( U32 n = 0; n < count; ++n )
+            ASSERT_LT( (U32)indices[n], (U32)TerrainQuadTree::ChunkVertexCount ) << "Index out of the chunk.";
+    }
+
+    delete [] indices;
+}
+
+//-----------------------------------------------------------------------------
+
+TEST( TerrainQuadTreeTests, morphTest )
+{
+    const U32 size = TERRAINQUADTREE_UNITTEST_SMALLSIZE;
+    F32* heights = new F32[size * size];
+    RandomLCG random( 1234 );
+    for( U32 n = 0; n < size * size; ++n )
+        heights[n] = random.randF() * 100.0f;
+
+    TerrainHeightMap source( heights, size );
+    TerrainQuadTree tree;
+    tree.build( &source, size, size );
+    ASSERT_EQ( 2, tree.getLevelCount() ) << "Unexpected level count.";
+
+    Graphics::PosUVNormalMorphVertex* fine = new Graphics::PosUVNormalMorphVertex[TerrainQuadTree::ChunkVertexCount];
+    Graphics::PosUVNormalMorphVertex* coarse = new Graphics::PosUVNormalMorphVertex[TerrainQuadTree::ChunkVertexCount];
+    tree.buildChunk( 64, 0, 0, fine );
+    tree.buildChunk( 0, 0, 1, coarse );
+
+    const U32 pitch = TerrainQuadTree::ChunkSize + 1;
+    for( U32 j = 0; j < pitch; ++j )
+    {
+        for( U32 i = 0; i < pitch; ++i )
+        {
+            const Graphics::PosUVNormalMorphVertex& vert = fine[( j * pitch ) + i];
+            const U32 x = 64 + i;
+            const U32 y = j;
+
+            ASSERT_EQ( (F32)x, vert.m_x );
+            ASSERT_EQ( heights[( y * size ) + x], vert.m_z );
+            ASSERT_EQ( 0.0f, vert.m_morph_level );
+
+            // Fully morphed, fine vertices lie on the coarse chunk's triangles.
+            if ( !( i & 1 ) && !( j & 1 ) )
+            {
+                const Graphics::PosUVNormalMorphVertex& match = coarse[( ( j / 2 ) * pitch ) + ( x / 2 )];
+                ASSERT_EQ( vert.m_x, match.m_x );
+                ASSERT_EQ( vert.m_z, match.m_z );
+                ASSERT_EQ( vert.m_z, vert.m_morph_z );
+            }
+            else if ( !( j & 1 ) )
+            {
+                ASSERT_FLOAT_EQ( ( heights[( y * size ) + x - 1] + heights[( y * size ) + x + 1] ) * 0.5f, vert.m_morph_z );
+            }
+            else if ( !( i & 1 ) )
+            {
+                ASSERT_FLOAT_EQ( ( heights[( ( y - 1 ) * size ) + x] + heights[( ( y + 1 ) * size ) + x] ) * 0.5f, vert.m_morph_z );
+            }
+            else
+            {
+                ASSERT_FLOAT_EQ( ( heights[( ( y - 1 ) * size ) + x + 1] + heights[( ( y + 1 ) * size ) + x - 1] ) * 0.5f, vert.m_morph_z );
+            }
+        }
+    }
+
+    // The top level has nothing to morph into.
+    for( U32 n = 0; n < TerrainQuadTree::ChunkVertexCount; ++n )
+        ASSERT_EQ( coarse[n].m_z, coarse[n].m_morph_z ) << "Top level vertex morphs.";
+
+    delete [] fine;
+    delete [] coarse;
+    delete [] heights;
+}
+
+//-----------------------------------------------------------------------------
+
+TEST( TerrainQuadTreeTests, updateHeightsTest )
+{
+    const U32 size = TERRAINQUADTREE_UNITTEST_SMALLSIZE;
+    F32* heights = new F32[size * size];
+    dMemset( heights, 0, size * size * sizeof( F32 ) );
+
+    TerrainHeightMap source( heights, size );
+    TerrainQuadTree tree;
+    tree.build( &source, size, size );
+
+    // On the edge between the two bottom leaves.
+    heights[( 10 * size ) + 64] = 50.0f;
+    ASSERT_EQ( 0.0f, tree.getChunkBox( 0, 0, 1 ).maxExtents.z ) << "Bounds changed before updateHeights().";
+
+    tree.updateHeights( 64, 10, 1, 1 );
+    ASSERT_EQ( 50.0f, tree.getChunkBox( 0, 0, 0 ).maxExtents.z ) << "Left leaf not updated.";
+    ASSERT_EQ( 50.0f, tree.getChunkBox( 64, 0, 0 ).maxExtents.z ) << "Right leaf not updated.";
+    ASSERT_EQ( 0.0f, tree.getChunkBox( 0, 64, 0 ).maxExtents.z ) << "Unrelated leaf updated.";
+    ASSERT_EQ( 50.0f, tree.getChunkBox( 0, 0, 1 ).maxExtents.z ) << "Root not updated.";
+
+    ASSERT_TRUE( tree.isChunkAffected( 0, 0, 0, 64, 10, 1, 1 ) );
+    ASSERT_TRUE( tree.isChunkAffected( 64, 0, 0, 64, 10, 1, 1 ) );
+    ASSERT_FALSE( tree.isChunkAffected( 0, 64, 0, 64, 10, 1, 1 ) );
+
+    delete [] heights;
+}
+
+//-----------------------------------------------------------------------------
+
+TEST( TerrainQuadTreeTests, benchmarkTest )
+{
+    JobSystemTestScope scope;
+
+    U32 startTime = Platform::getRealMilliseconds();
+    largeTree.clear();
+    const TerrainQuadTree& tree = getLargeTree();
+    const U32 buildTime = Platform::getRealMilliseconds() - startTime;
+
+    // Selection, flying across the terrain.
+    Vector<TerrainQuadTree::SelectedNode> selection;
+    U32 chunkCount = 0;
+    startTime = Platform::getRealMilliseconds();
+    for( U32 n = 0; n < TERRAINQUADTREE_UNITTEST_CAMERAS; ++n )
+    {
+        const U32 position = ( n * ( TERRAINQUADTREE_UNITTEST_LARGESIZE - 1 ) ) / TERRAINQUADTREE_UNITTEST_CAMERAS;
+        tree.select( getCamera( position, position / 2 ), selection );
+        chunkCount += selection.size();
+    }
+    const U32 selectTime = Platform::getRealMilliseconds() - startTime;
+
+    // Chunk rebuilds, serial and on the job system.
+    tree.select( getCamera( 8192, 8192 ), selection );
+    if ( selection.size() > TERRAINQUADTREE_UNITTEST_MAXCHUNKS )
+        selection.setSize( TERRAINQUADTREE_UNITTEST_MAXCHUNKS );
+
+    ChunkBuildData data;
+    data.mTree = &tree;
+    data.mSelection = &selection;
+    data.mVerts = new Graphics::PosUVNormalMorphVertex[selection.size() * TerrainQuadTree::ChunkVertexCount];
+    Graphics::PosUVNormalMorphVertex* serial = new Graphics::PosUVNormalMorphVertex[selection.size() * TerrainQuadTree::ChunkVertexCount];
+
+    startTime = Platform::getRealMilliseconds();
+    for( S32 n = 0; n < selection.size(); ++n )
+        tree.buildChunk( selection[n].x, selection[n].y, selection[n].level, serial + ( n * TerrainQuadTree::ChunkVertexCount ) );
+    const U32 serialTime = Platform::getRealMilliseconds() - startTime;
+
+    JobCounter counter;
+    startTime = Platform::getRealMilliseconds();
+    JobSystem::parallelFor( selection.size(), 1, buildChunksJob, &data, &counter );
+    JobSystem::wait( counter );
+    const U32 parallelTime = Platform::getRealMilliseconds() - startTime;
+
+    ASSERT_EQ( 0, dMemcmp( serial, data.mVerts, selection.size() * TerrainQuadTree::ChunkVertexCount * sizeof( Graphics::PosUVNormalMorphVertex ) ) ) << "Parallel chunk build differs.";
+
+    Con::printf( "TerrainQuadTree: %dx%d build %dms. %d selections: %dms, %d chunks on average. %d chunk rebuilds: serial %dms, %d workers %dms.",
+        TERRAINQUADTREE_UNITTEST_LARGESIZE, TERRAINQUADTREE_UNITTEST_LARGESIZE, buildTime,
+        TERRAINQUADTREE_UNITTEST_CAMERAS, selectTime, chunkCount / TERRAINQUADTREE_UNITTEST_CAMERAS,
+        selection.size(), serialTime, JobSystem::getWorkerCount(), parallelTime );
+
+    delete [] serial;
+    delete [] data.mVerts;
+    largeTree.clear();
+}
+
+#endif // TORQUE_SHIPPING
@@ -0,0 +1,253 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2013 GarageGames, LLC
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//-----------------------------------------------------------------------------
+
+
+// We don't want tests in a shipping version.
+#ifndef TORQUE_SHIPPING
+
+#ifndef _UNIT_TESTING_H_
+#include "testing/unitTesting.h"
+#endif
+
+#ifndef _PLATFORM_H_
+#include "platform/platform.h"
+#endif
+
+#ifndef _JOB_SYSTEM_H_
+#include "platform/threads/jobSystem.h"
+#endif
+
+#ifndef _JOB_SYSTEM_TEST_SCOPE_H_
+#include "testing/jobSystemTestScope.h"
+#endif
+
+#ifndef _SCENE_TRANSFORM_SYSTEM_H_
+#include "scene/transformSystem.h"
+#endif
+
+#ifndef _MRANDOM_H_
+#include "math/mRandom.h"
+#endif
+
+#ifndef _CONSOLE_H_
+#include "console/console.h"
+#endif
+
+//-----------------------------------------------------------------------------
+
+#define TRANSFORM_UNITTEST_ROOTS          200
+#define TRANSFORM_UNITTEST_CHILDREN       3
+#define TRANSFORM_UNITTEST_BENCHOBJECTS   100000
+#define TRANSFORM_UNITTEST_BENCHFRAMES    20
+#define TRANSFORM_UNITTEST_TOLERANCE      0.001f
+
+//-----------------------------------------------------------------------------
+
+static MatrixF randomTransform( RandomLCG& random )
+{
+    MatrixF matrix( EulerF( random.randRangeF( -M_PI_F, M_PI_F ), random.randRangeF( -M_PI_F, M_PI_F ), random.randRangeF( -M_PI_F, M_PI_F ) ) );
+    matrix.setPosition( Point3F( random.randRangeF( -10.0f, 10.0f ), random.randRangeF( -10.0f, 10.0f ), random.randRangeF( -10.0f, 10.0f ) ) );
+    return matrix;
+}
+
+static bool matricesNear( const MatrixF& a, const MatrixF& b )
+{
+    for( U32 index = 0; index < 16; ++index )
+    {
+        if ( mFabs( a[index] - b[index] ) > TRANSFORM_UNITTEST_TOLERANCE )
+            return false;
+    }
+
+    return true;
+}
+
+static void countChanged( void* data, const MatrixF& world )
+{
+    (*(U32*)data)++;
+}
+
+//-----------------------------------------------------------------------------
+
+TEST( TransformSystemTests, worldMatchesParentTimesLocalTest )
+{
+    JobSystemTestScope scope;
+    RandomLCG random( 1234 );
+
+    // Roots, children and grandchildren, created out of depth order.
+    Vector<S32> handles;
+    Vector<S32> parents;
+    for( U32 root = 0; root < TRANSFORM_UNITTEST_ROOTS; ++root )
+    {
+        S32 parent = Scene::createTransform();
+        handles.push_back( parent );
+        parents.push_back( -1 );
+
+        for( U32 child = 0; child < TRANSFORM_UNITTEST_CHILDREN; ++child )
+        {
+            S32 handle = Scene::createTransform( parent );
+            handles.push_back( handle );
+            parents.push_back( parent );
+            parent = handle;
+        }
+    }
+
+    for( S32 index = 0; index < handles.size(); ++index )
+        Scene::setLocalTransform( handles[index], randomTransform( random ) );
+
+    Scene::updateTransforms();
+
+    // Check.
+    for( S32 index = 0; index < handles.size(); ++index )
+    {
+        ASSERT_FALSE( Scene::isTransformDirty( handles[index] ) ) << "Transform still dirty after update.";
+        ASSERT_EQ( parents[index], Scene::getTransformParent( handles[index] ) ) << "Transform lost its parent.";
+
+        MatrixF expected = Scene::getLocalTransform( handles[index] );
+        if ( parents[index] >= 0 )
+            expected = Scene::getWorldTransform( parents[index] ) * expected;
+
+        ASSERT_TRUE( matricesNear( expected, Scene::getWorldTransform( handles[index] ) ) ) << "World matrix is not parent world times local.";
+    }
+
+    for( S32 index = handles.size() - 1; index >= 0; --index )
+        Scene::destroyTransform( handles[index] );
+}
+
+//-----------------------------------------------------------------------------
+
+TEST( TransformSystemTests, dirtyPropagationTest )
+{
+    JobSystemTestScope scope;
+    RandomLCG random( 4321 );
+
+    U32 changed = 0;
+    const S32 root = Scene::createTransform( -1, &countChanged, &changed );
+    const S32 child = Scene::createTransform( root, &countChanged, &changed );
+    const S32 grandChild = Scene::createTransform( child, &countChanged, &changed );
+    const S32 other = Scene::createTransform( -1, &countChanged, &changed );
+    Scene::updateTransforms();
+
+    // Moving the root moves everything below it, and nothing else.
+    changed = 0;
+    Scene::setLocalTransform( root, randomTransform( random ) );
+    ASSERT_TRUE( Scene::isTransformDirty( grandChild ) ) << "Dirty root not seen from a grandchild.";
+    Scene::updateTransforms();
+    ASSERT_EQ( 3u, changed ) << "Moving a root didn't update exactly its hierarchy.";
+
+    // Reads between updates resolve on demand.
+    const MatrixF local = randomTransform( random );
+    Scene::setLocalTransform( child, local );
+    const MatrixF expected = Scene::getWorldTransform( root ) * local;
+    ASSERT_TRUE( matricesNear( expected, Scene::getWorldTransform( child ) ) ) << "Dirty transform read a stale world matrix.";
+
+    changed = 0;
+    Scene::updateTransforms();
+    ASSERT_EQ( 2u, changed ) << "Moving a child didn't update exactly its hierarchy.";
+
+    // Setting the same matrix again is not a change.
+    changed = 0;
+    Scene::setLocalTransform( child, local );
+    Scene::updateTransforms();
+    ASSERT_EQ( 0u, changed ) << "Unchanged local matrix marked dirty.";
+
+    // Orphans become roots.
+    Scene::destroyTransform( child );
+    ASSERT_EQ( -1, Scene::getTransformParent( grandChild ) ) << "Orphaned transform kept a parent.";
+    Scene::updateTransforms();
+    ASSERT_TRUE( matricesNear( Scene::getLocalTransform( grandChild ), Scene::getWorldTransform( grandChild ) ) ) << "Root world matrix is not its local.";
+
+    // Reparenting to a later transform.
+    Scene::setTransformParent( root, other );
+    Scene::updateTransforms();
+    ASSERT_TRUE( matricesNear( Scene::getWorldTransform( other ) * Scene::getLocalTransform( root ), Scene::getWorldTransform( root ) ) ) << "Reparented world matrix is wrong.";
+
+    Scene::destroyTransform( grandChild );
+    Scene::destroyTransform( root );
+    Scene::destroyTransform( other );
+}
+
+//-----------------------------------------------------------------------------
+
+TEST( TransformSystemTests, moveBenchmarkTest )
+{
+    JobSystemTestScope scope;
+    RandomLCG random( 5678 );
+
+    // An object with a single component, the common case in a scene.
+    Vector<S32> objects;
+    Vector<S32> components;
+    Vector<MatrixF> locals;
+    objects.setSize( TRANSFORM_UNITTEST_BENCHOBJECTS );
+    components.setSize( TRANSFORM_UNITTEST_BENCHOBJECTS );
+    locals.setSize( TRANSFORM_UNITTEST_BENCHOBJECTS );
+    for( U32 index = 0; index < TRANSFORM_UNITTEST_BENCHOBJECTS; ++index )
+    {
+        objects[index] = Scene::createTransform();
+        components[index] = Scene::createTransform( objects[index] );
+        Scene::setLocalTransform( components[index], randomTransform( random ) );
+        locals[index] = randomTransform( random );
+    }
+    Scene::updateTransforms();
+
+    // Move every object each frame.
+    U32 updated = 0;
+    U32 startTime = Platform::getRealMilliseconds();
+    for( U32 frame = 0; frame < TRANSFORM_UNITTEST_BENCHFRAMES; ++frame )
+    {
+        for( U32 index = 0; index < TRANSFORM_UNITTEST_BENCHOBJECTS; ++index )
+        {
+            locals[index].setPosition( locals[index].getPosition() + Point3F( 0.0f, 0.0f, 0.01f ) );
+            Scene::setLocalTransform( objects[index], locals[index] );
+        }
+        updated += Scene::updateTransforms();
+    }
+    const U32 systemTime = Platform::getRealMilliseconds() - startTime;
+
+    // The same moves computed one object at a time, the way refresh() does.
+    Vector<MatrixF> worlds;
+    worlds.setSize( TRANSFORM_UNITTEST_BENCHOBJECTS );
+    startTime = Platform::getRealMilliseconds();
+    for( U32 frame = 0; frame < TRANSFORM_UNITTEST_BENCHFRAMES; ++frame )
+    {
+        for( U32 index = 0; index < TRANSFORM_UNITTEST_BENCHOBJECTS; ++index )
+        {
+            locals[index].setPosition( locals[index].getPosition() + Point3F( 0.0f, 0.0f, 0.01f ) );
+            worlds[index] = locals[index] * Scene::getLocalTransform( components[index] );
+        }
+    }
+    const U32 serialTime = Platform::getRealMilliseconds() - startTime;
+
+    Con::printf( "TransformSystem: %d objects moved for %d frames. Transform system: %dms, per object: %dms.",
+        TRANSFORM_UNITTEST_BENCHOBJECTS, TRANSFORM_UNITTEST_BENCHFRAMES, systemTime, serialTime );
+
+    // Check.
+    ASSERT_EQ( (U32)TRANSFORM_UNITTEST_BENCHOBJECTS * 2 * TRANSFORM_UNITTEST_BENCHFRAMES, updated ) << "Not every moved transform was updated.";
+
+    for( U32 index = 0; index < TRANSFORM_UNITTEST_BENCHOBJECTS; ++index )
+    {
+        Scene::destroyTransform( components[index] );
+        Scene::destroyTransform( objects[index] );
+    }
+    Scene::updateTransforms();
+}
+
+#endif // TORQUE_SHIPPING
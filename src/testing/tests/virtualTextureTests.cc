@@ -0,0 +1,258 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2013 GarageGames, LLC
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//-----------------------------------------------------------------------------
+
+// We don't want tests in a shipping version.
+#ifndef TORQUE_SHIPPING
+
+#ifndef _UNIT_TESTING_H_
+#include "testing/unitTesting.h"
+#endif
+
+#ifndef _PLATFORM_H_
+#include "platform/platform.h"
+#endif
+
+#ifndef _VIRTUAL_TEXTURE_H_
+#include "graphics/virtualTexture.h"
+#endif
+
+#ifndef _CONSOLE_H_
+#include "console/console.h"
+#endif
+
+//-----------------------------------------------------------------------------
+
+// Same layout as the terrain megatexture.
+#define VIRTUALTEXTURE_UNITTEST_LEVELS      4
+#define VIRTUALTEXTURE_UNITTEST_WINDOW      8
+#define VIRTUALTEXTURE_UNITTEST_PAGESIZE    128
+#define VIRTUALTEXTURE_UNITTEST_SIZE        4096
+#define VIRTUALTEXTURE_UNITTEST_PATHSTEPS   500
+
+#define VIRTUALTEXTURE_UNITTEST_WINDOWPAGES ( VIRTUALTEXTURE_UNITTEST_LEVELS * VIRTUALTEXTURE_UNITTEST_WINDOW * VIRTUALTEXTURE_UNITTEST_WINDOW )
+
+//-----------------------------------------------------------------------------
+
+static void initVirtualTexture( VirtualTexture& texture )
+{
+    texture.init( VIRTUALTEXTURE_UNITTEST_LEVELS, VIRTUALTEXTURE_UNITTEST_WINDOW, VIRTUALTEXTURE_UNITTEST_PAGESIZE, VIRTUALTEXTURE_UNITTEST_SIZE );
+}
+
+static U32 countMissingPages( const VirtualTexture& texture, U32 level )
+{
+    U32 missing = 0;
+    const Point2I& origin = texture.getWindowOrigin( level );
+    for( U32 y = origin.y; y < origin.y + texture.getWindowSize(); ++y )
+    {
+        for( U32 x = origin.x; x < origin.x + texture.getWindowSize(); ++x )
+            missing += ( texture.getPageSlot( level, x, y ) == VirtualTexture::InvalidSlot ) ? 1 : 0;
+    }
+
+    return missing;
+}
+
+static U32 countMissingPages( const VirtualTexture& texture )
+{
+    U32 missing = 0;
+    for( U32 level = 0; level < texture.getLevelCount(); ++level )
+        missing += countMissingPages( texture, level );
+
+    return missing;
+}
+
+// Toroidal page table: every window page is at (x % window, y % window) of its level.
+static U32 countPageTableErrors( const VirtualTexture& texture )
+{
+    U32 errors = 0;
+    const U8* table = texture.getPageTable();
+    for( U32 level = 0; level < texture.getLevelCount(); ++level )
+    {
+        const Point2I& origin = texture.getWindowOrigin( level );
+        for( U32 y = origin.y; y < origin.y + texture.getWindowSize(); ++y )
+        {
+            for( U32 x = origin.x; x < origin.x + texture.getWindowSize(); ++x )
+            {
+                const U32 row = ( level * texture.getWindowSize() ) + ( y % texture.getWindowSize() );
+                const U8* texel = table + ( ( row * texture.getPageTableWidth() ) + ( x % texture.getWindowSize() ) ) * 4;
+                const U16 slot = texture.getPageSlot( level, x, y );
+
+                if ( slot == VirtualTexture::InvalidSlot )
+                    errors += ( texel[2] != 0 ) ? 1 : 0;
+                else
+                    errors += ( texel[2] != 255 || slot != texel[1] * texture.getSlotsPerSide() + texel[0] ) ? 1 : 0;
+            }
+        }
+    }
+
+    return errors;
+}
+
+//-----------------------------------------------------------------------------
+
+TEST( VirtualTextureTests, pageRequestTest )
+{
+    VirtualTexture texture;
+    initVirtualTexture( texture );
+    Vector<VirtualTexture::PageUpdate> updates;
+
+    // Everything renders once.
+    const Point2F focus( 0.5f, 0.5f );
+    texture.update( focus, U32_MAX, updates );
+    ASSERT_EQ( VIRTUALTEXTURE_UNITTEST_WINDOWPAGES, texture.getStats().rendered ) << "First update didn't render every window page.";
+    ASSERT_EQ( 0, texture.getStats().evicted );
+    ASSERT_EQ( 0, countMissingPages( texture ) );
+
+    // Coarse levels come first.
+    for( S32 n = 1; n < updates.size(); ++n )
+        ASSERT_GE( updates[n - 1].level, updates[n].level ) << "Pages aren't ordered coarse to fine.";
+
+    ASSERT_EQ( 0, texture.getPageTableDirtyRow() );
+    ASSERT_EQ( texture.getPageTableHeight(), texture.getPageTableDirtyRowCount() );
+    texture.clearPageTableDirty();
+
+    // Standing still renders nothing.
+    texture.update( focus, U32_MAX, updates );
+    ASSERT_EQ( 0, texture.getStats().rendered ) << "Rendered pages without moving.";
+    ASSERT_EQ( VIRTUALTEXTURE_UNITTEST_WINDOWPAGES, texture.getStats().resident );
+    ASSERT_FALSE( texture.isPageTableDirty() ) << "Page table changed without moving.";
+
+    // One finest page to the right only exposes a column of finest pages.
+    const Point2F moved( focus.x + 1.0f / texture.getPagesAcross( 0 ), focus.y );
+    texture.update( moved, U32_MAX, updates );
+    ASSERT_EQ( VIRTUALTEXTURE_UNITTEST_WINDOW, texture.getStats().rendered ) << "Moving rendered more than the exposed pages.";
+    for( S32 n = 0; n < updates.size(); ++n )
+    {
+        ASSERT_EQ( 0, updates[n].level );
+        ASSERT_EQ( texture.getWindowOrigin( 0 ).x + VIRTUALTEXTURE_UNITTEST_WINDOW - 1, updates[n].x );
+    }
+
+    // Only the finest level's rows of the page table changed.
+    ASSERT_EQ( 0, texture.getPageTableDirtyRow() );
+    ASSERT_EQ( VIRTUALTEXTURE_UNITTEST_WINDOW, texture.getPageTableDirtyRowCount() ) << "Page table rows of levels that didn't move changed.";
+    texture.clearPageTableDirty();
+
+    // The column that scrolled out is still cached.
+    texture.update( focus, U32_MAX, updates );
+    ASSERT_EQ( 0, texture.getStats().rendered ) << "Coming back rendered cached pages again.";
+
+    ASSERT_EQ( 0, countPageTableErrors( texture ) ) << "Page table doesn't match the resident pages.";
+}
+
+//-----------------------------------------------------------------------------
+
+TEST( VirtualTextureTests, budgetTest )
+{
+    VirtualTexture texture;
+    initVirtualTexture( texture );
+    Vector<VirtualTexture::PageUpdate> updates;
+
+    // The first frame gets the whole top level, the rest waits.
+    const U32 budget = VIRTUALTEXTURE_UNITTEST_WINDOW * VIRTUALTEXTURE_UNITTEST_WINDOW;
+    texture.update( Point2F( 0.3f, 0.6f ), budget, updates );
+    ASSERT_EQ( budget, texture.getStats().rendered );
+    ASSERT_EQ( VIRTUALTEXTURE_UNITTEST_WINDOWPAGES - budget, texture.getStats().pending );
+    ASSERT_EQ( 0, countMissingPages( texture, VIRTUALTEXTURE_UNITTEST_LEVELS - 1 ) ) << "Top level isn't resident first.";
+
+    U32 frames = 1;
+    while( countMissingPages( texture ) > 0 && frames < 100 )
+    {
+        texture.update( Point2F( 0.3f, 0.6f ), budget, updates );
+        ASSERT_LE( texture.getStats().rendered, budget ) << "Update went over budget.";
+        ASSERT_EQ( 0, countPageTableErrors( texture ) ) << "Page table doesn't match the resident pages.";
+        frames++;
+    }
+    ASSERT_EQ( VIRTUALTEXTURE_UNITTEST_LEVELS, frames ) << "Pending pages didn't render within the budget.";
+}
+
+//-----------------------------------------------------------------------------
+
+TEST( VirtualTextureTests, cameraPathTest )
+{
+    VirtualTexture texture;
+    initVirtualTexture( texture );
+    Vector<VirtualTexture::PageUpdate> updates;
+
+    U32 totalRendered = 0;
+    U32 maxRendered = 0;
+    U32 totalEvicted = 0;
+    U32 movingFrames = 0;
+    Point2I lastOrigin = texture.getWindowOrigin( 0 );
+    Point2I oldOrigin = lastOrigin;
+
+    // Fly diagonally across, then back to the middle of the left edge,
+    // wrapping the cache several times.
+    for( U32 step = 0; step <= VIRTUALTEXTURE_UNITTEST_PATHSTEPS * 2; ++step )
+    {
+        Point2F focus;
+        if ( step <= VIRTUALTEXTURE_UNITTEST_PATHSTEPS )
+        {
+            const F32 t = (F32)step / VIRTUALTEXTURE_UNITTEST_PATHSTEPS;
+            focus.set( t, t );
+        }
+        else
+        {
+            const F32 t = (F32)( step - VIRTUALTEXTURE_UNITTEST_PATHSTEPS ) / VIRTUALTEXTURE_UNITTEST_PATHSTEPS;
+            focus.set( 1.0f - t, 1.0f - ( t * 0.5f ) );
+        }
+
+        texture.update( focus, U32_MAX, updates );
+        const VirtualTexture::Stats& stats = texture.getStats();
+
+        // Without a budget every request is served and nothing in view is evicted.
+        ASSERT_EQ( stats.requested, stats.rendered );
+        ASSERT_EQ( 0, stats.pending );
+        ASSERT_EQ( 0, countMissingPages( texture ) ) << "A window page was evicted or not rendered.";
+        ASSERT_EQ( 0, countPageTableErrors( texture ) ) << "Page table doesn't match the resident pages.";
+
+        // Only pages that scrolled into a window render.
+        if ( step > 0 )
+        {
+            ASSERT_LE( stats.rendered, VIRTUALTEXTURE_UNITTEST_LEVELS * VIRTUALTEXTURE_UNITTEST_WINDOW * 2 - VIRTUALTEXTURE_UNITTEST_LEVELS ) << "Rendered more than the exposed rows and columns.";
+        }
+
+        if ( texture.getWindowOrigin( 0 ) != lastOrigin )
+        {
+            oldOrigin = lastOrigin;
+            lastOrigin = texture.getWindowOrigin( 0 );
+            movingFrames++;
+        }
+
+        totalRendered += stats.rendered;
+        totalEvicted += stats.evicted;
+        if ( step > 0 )
+            maxRendered = getMax( maxRendered, stats.rendered );
+    }
+
+    // The path covers more than the cache holds, the least recently used
+    // pages went and the previous window is still there.
+    ASSERT_GT( totalEvicted, 0 ) << "Camera path never filled the cache.";
+    for( U32 y = oldOrigin.y; y < oldOrigin.y + VIRTUALTEXTURE_UNITTEST_WINDOW; ++y )
+    {
+        for( U32 x = oldOrigin.x; x < oldOrigin.x + VIRTUALTEXTURE_UNITTEST_WINDOW; ++x )
+            ASSERT_NE( VirtualTexture::InvalidSlot, texture.getPageSlot( 0, x, y ) ) << "Recently used page was evicted.";
+    }
+
+    Con::printf( "VirtualTexture: %d frames, %d moved the finest window. Pages rendered: %d (max %d per frame after the first, full redraw would be %d per move), evicted: %d.",
+        VIRTUALTEXTURE_UNITTEST_PATHSTEPS * 2 + 1, movingFrames, totalRendered, maxRendered, VIRTUALTEXTURE_UNITTEST_WINDOWPAGES, totalEvicted );
+}
+
+#endif // TORQUE_SHIPPING
@@ -0,0 +1,367 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2013 GarageGames, LLC
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//-----------------------------------------------------------------------------
+
+
+// We don't want tests in a shipping version.
+#ifndef TORQUE_SHIPPING
+
+#ifndef _UNIT_TESTING_H_
+#include "testing/unitTesting.h"
+#endif
+
+#ifndef _PLATFORM_H_
+#include "platform/platform.h"
+#endif
+
+#ifndef _JOB_SYSTEM_H_
+#include "platform/threads/jobSystem.h"
+#endif
+
+#ifndef _JOB_SYSTEM_TEST_SCOPE_H_
+#include "testing/jobSystemTestScope.h"
+#endif
+
+#ifndef _VOXEL_WORLD_H_
+#include "graphics/voxelWorld.h"
+#endif
+
+#ifndef _MEMSTREAM_H_
+#include "io/memstream.h"
+#endif
+
+#ifndef _CONSOLE_H_
+#include "console/console.h"
+#endif
+
+#include "graphics/utilities.h"
+
+//-----------------------------------------------------------------------------
+
+#define VOXELWORLD_UNITTEST_RADIUS        20
+#define VOXELWORLD_UNITTEST_EXTENT        64
+#define VOXELWORLD_UNITTEST_EDITS         200
+#define VOXELWORLD_UNITTEST_STREAMSIZE    (1024 * 1024)
+
+//-----------------------------------------------------------------------------
+
+// A face is the solid voxel it belongs to and the direction it points in.
+static U64 packVoxelFace( S32 x, S32 y, S32 z, U32 direction )
+{
+    return ((U64)(x + 1024) << 35) | ((U64)(y + 1024) << 23) | ((U64)(z + 1024) << 11) | direction;
+}
+
+static S32 QSORT_CALLBACK compareVoxelFaces( const void* a, const void* b )
+{
+    U64 fa = *(const U64*)a;
+    U64 fb = *(const U64*)b;
+    return fa < fb ? -1 : (fa > fb ? 1 : 0);
+}
+
+// Keeps the faces of every chunk mesh, in world space.
+class VoxelWorldTestWorld : public VoxelWorld
+{
+public:
+    Vector<Point3I> mMeshed;
+
+    VoxelWorldTestWorld( VoxelPager* pager ) : VoxelWorld( pager ) { }
+
+    ~VoxelWorldTestWorld()
+    {
+        waitForMeshes();
+        for ( U32 i = 0; i < mChunks.size(); ++i )
+            delete (Vector<U64>*)mChunks[i]->userData;
+    }
+
+    virtual void onChunkMeshed( Chunk* chunk, const VoxelMesh& mesh )
+    {
+        mMeshed.push_back( chunk->coord );
+
+        Vector<U64>* faces = (Vector<U64>*)chunk->userData;
+        if ( faces == NULL )
+        {
+            faces = new Vector<U64>();
+            chunk->userData = faces;
+        }
+        faces->clear();
+
+        for ( U32 i = 0; i < mesh.verts.size(); i += 4 )
+        {
+            const Graphics::PosUVNormalVertex* quad = &mesh.verts[i];
+            F32 corner[3] = { quad[0].m_x, quad[0].m_y, quad[0].m_z };
+            for ( U32 j = 1; j < 4; ++j )
+            {
+                corner[0] = getMin( corner[0], quad[j].m_x );
+                corner[1] = getMin( corner[1], quad[j].m_y );
+                corner[2] = getMin( corner[2], quad[j].m_z );
+            }
+
+            // Faces pointing up an axis sit on the far side of their voxel.
+            F32 normal[3] = { quad[0].m_normal_x, quad[0].m_normal_y, quad[0].m_normal_z };
+            S32 origin[3] = { chunk->coord.x * ChunkSize, chunk->coord.y * ChunkSize, chunk->coord.z * ChunkSize };
+            U32 direction = 0;
+            S32 voxel[3];
+            for ( U32 axis = 0; axis < 3; ++axis )
+            {
+                voxel[axis] = (S32)corner[axis] + origin[axis];
+                if ( normal[axis] > 0.5f )
+                {
+                    voxel[axis] -= 1;
+                    direction = axis * 2 + 1;
+                }
+                else if ( normal[axis] < -0.5f )
+                {
+                    direction = axis * 2;
+                }
+            }
+
+            faces->push_back( packVoxelFace( voxel[0], voxel[1], voxel[2], direction ) );
+        }
+    }
+
+    virtual void onChunkUnloaded( Chunk* chunk )
+    {
+        delete (Vector<U64>*)chunk->userData;
+        chunk->userData = NULL;
+    }
+
+    // Every face of every chunk mesh, sorted.
+    void getMeshFaces( Vector<U64>& faces )
+    {
+        faces.clear();
+        for ( U32 i = 0; i < mChunks.size(); ++i )
+        {
+            Vector<U64>* chunkFaces = (Vector<U64>*)mChunks[i]->userData;
+            if ( chunkFaces != NULL )
+                faces.merge( *chunkFaces );
+        }
+        dQsort( faces.address(), faces.size(), sizeof(U64), compareVoxelFaces );
+    }
+
+    // The faces a single mesh of the whole extent would have.
+    void getExpectedFaces( Vector<U64>& faces )
+    {
+        static const S32 directions[6][3] = {
+            { -1, 0, 0 }, { 1, 0, 0 }, { 0, -1, 0 }, { 0, 1, 0 }, { 0, 0, -1 }, { 0, 0, 1 }
+        };
+
+        faces.clear();
+        const S32 extent = VOXELWORLD_UNITTEST_EXTENT;
+        for ( S32 z = -extent; z < extent; ++z )
+        {
+            for ( S32 y = -extent; y < extent; ++y )
+            {
+                for ( S32 x = -extent; x < extent; ++x )
+                {
+                    if ( getVoxel( x, y, z ) == 0 )
+                        continue;
+
+                    for ( U32 d = 0; d < 6; ++d )
+                    {
+                        if ( getVoxel( x + directions[d][0], y + directions[d][1], z + directions[d][2] ) == 0 )
+                            faces.push_back( packVoxelFace( x, y, z, d ) );
+                    }
+                }
+            }
+        }
+        dQsort( faces.address(), faces.size(), sizeof(U64), compareVoxelFaces );
+    }
+
+    void fillSphere( S32 radius, U8 value )
+    {
+        for ( S32 z = -radius; z <= radius; ++z )
+            for ( S32 y = -radius; y <= radius; ++y )
+                for ( S32 x = -radius; x <= radius; ++x )
+                    if ( x * x + y * y + z * z <= radius * radius )
+                        setVoxel( x, y, z, value );
+    }
+
+    void meshAll()
+    {
+        updateMeshes( Point3F( 0.0f, 0.0f, 0.0f ), 1000.0f, U32_MAX );
+        waitForMeshes();
+    }
+};
+
+static bool compareVoxelFaceSets( const Vector<U64>& a, const Vector<U64>& b )
+{
+    if ( a.size() != b.size() )
+        return false;
+    for ( U32 i = 0; i < a.size(); ++i )
+    {
+        if ( a[i] != b[i] )
+            return false;
+    }
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+
+TEST( VoxelWorldTests, seamlessTest )
+{
+    JobSystemTestScope scope;
+    VoxelMemoryPager pager;
+    VoxelWorldTestWorld world( &pager );
+
+    // The sphere spans the eight chunks around the origin.
+    world.updateStreaming( Point3F( 0.0f, 0.0f, 0.0f ), 100.0f, 200.0f );
+    world.fillSphere( VOXELWORLD_UNITTEST_RADIUS, 1 );
+    world.meshAll();
+
+    Vector<U64> meshFaces, expectedFaces;
+    world.getMeshFaces( meshFaces );
+    world.getExpectedFaces( expectedFaces );
+    ASSERT_GT( expectedFaces.size(), 0 ) << "Sphere has no faces.";
+    EXPECT_TRUE( compareVoxelFaceSets( meshFaces, expectedFaces ) ) << "Chunk meshes don't match the whole volume: "
+        << meshFaces.size() << " faces instead of " << expectedFaces.size() << ".";
+
+    // Edits on faces, edges and the corner shared by eight chunks.
+    const S32 edits[][4] = {
+        { 0, 0, 0, 0 },
+        { -1, -1, -1, 0 },
+        { 31, 0, 0, 2 },
+        { 32, 0, 0, 3 },
+        { 5, 31, 5, 4 },
+        { 5, 32, 5, 4 },
+        { -33, 3, -32, 1 },
+    };
+    const U32 editCount = sizeof(edits) / sizeof(edits[0]);
+
+    world.mMeshed.clear();
+    for ( U32 i = 0; i < editCount; ++i )
+        world.setVoxel( edits[i][0], edits[i][1], edits[i][2], (U8)edits[i][3] );
+    world.meshAll();
+
+    world.getMeshFaces( meshFaces );
+    world.getExpectedFaces( expectedFaces );
+    EXPECT_TRUE( compareVoxelFaceSets( meshFaces, expectedFaces ) ) << "Chunk meshes don't match after editing chunk borders: "
+        << meshFaces.size() << " faces instead of " << expectedFaces.size() << ".";
+
+    // Only the edited chunks and the neighbours they touch are meshed again.
+    EXPECT_GT( world.mMeshed.size(), 0 );
+    EXPECT_LT( world.mMeshed.size(), world.getChunkCount() / 4 ) << "Too many chunks meshed again.";
+    for ( U32 i = 0; i < world.mMeshed.size(); ++i )
+    {
+        const Point3I& coord = world.mMeshed[i];
+        bool touched = false;
+        for ( U32 j = 0; j < editCount && !touched; ++j )
+        {
+            Point3I edited = VoxelWorld::getChunkCoord( edits[j][0], edits[j][1], edits[j][2] );
+            touched = mAbs( coord.x - edited.x ) + mAbs( coord.y - edited.y ) + mAbs( coord.z - edited.z ) <= 1;
+        }
+        EXPECT_TRUE( touched ) << "Chunk " << coord.x << " " << coord.y << " " << coord.z << " meshed without an edit.";
+    }
+}
+
+//-----------------------------------------------------------------------------
+
+TEST( VoxelWorldTests, pagerTest )
+{
+    JobSystemTestScope scope;
+    VoxelMemoryPager pager;
+
+    {
+        VoxelWorldTestWorld world( &pager );
+        world.fillSphere( VOXELWORLD_UNITTEST_RADIUS, 3 );
+        world.setVoxel( 1000, -1000, 500, 7 );
+        world.flush();
+
+        EXPECT_EQ( world.getChunkCount(), 0 );
+        EXPECT_EQ( world.getStats().allocated, 0 );
+    }
+
+    // Only edited chunks are paged out, and they compress well.
+    EXPECT_EQ( pager.getChunkCount(), 9 );
+    EXPECT_LT( pager.getDataSize(), 9 * VoxelWorld::ChunkVoxelCount / 8 );
+
+    U8* buffer = new U8[VOXELWORLD_UNITTEST_STREAMSIZE];
+    {
+        MemStream stream( VOXELWORLD_UNITTEST_STREAMSIZE, buffer, false, true );
+        ASSERT_TRUE( pager.write( stream ) );
+    }
+
+    VoxelMemoryPager loaded;
+    {
+        MemStream stream( VOXELWORLD_UNITTEST_STREAMSIZE, buffer, true, false );
+        ASSERT_TRUE( loaded.read( stream ) );
+    }
+    delete[] buffer;
+    EXPECT_EQ( loaded.getChunkCount(), pager.getChunkCount() );
+
+    VoxelWorldTestWorld world( &loaded );
+    const S32 radius = VOXELWORLD_UNITTEST_RADIUS + 2;
+    U32 mismatches = 0;
+    for ( S32 z = -radius; z <= radius; ++z )
+        for ( S32 y = -radius; y <= radius; ++y )
+            for ( S32 x = -radius; x <= radius; ++x )
+                mismatches += world.getVoxel( x, y, z ) != ( x * x + y * y + z * z <= VOXELWORLD_UNITTEST_RADIUS * VOXELWORLD_UNITTEST_RADIUS ? 3 : 0 );
+    EXPECT_EQ( mismatches, 0 ) << "Voxels changed going through the pager.";
+    EXPECT_EQ( world.getVoxel( 1000, -1000, 500 ), 7 );
+
+    // Moving away pages chunks out, coming back pages them in again.
+    world.updateStreaming( Point3F( 0.0f, 0.0f, 0.0f ), 64.0f, 96.0f );
+    EXPECT_GT( world.getStats().unloaded, 0 );
+    world.setVoxel( 0, 0, 0, 9 );
+    world.updateStreaming( Point3F( 10000.0f, 0.0f, 0.0f ), 64.0f, 96.0f );
+    EXPECT_EQ( world.findChunk( Point3I( 0, 0, 0 ) ), (VoxelWorld::Chunk*)NULL );
+    world.updateStreaming( Point3F( 0.0f, 0.0f, 0.0f ), 64.0f, 96.0f );
+    EXPECT_NE( world.findChunk( Point3I( 0, 0, 0 ) ), (VoxelWorld::Chunk*)NULL );
+    EXPECT_EQ( world.getVoxel( 0, 0, 0 ), 9 );
+    EXPECT_EQ( world.getVoxel( 1, 0, 0 ), 3 );
+}
+
+//-----------------------------------------------------------------------------
+
+TEST( VoxelWorldTests, latencyBenchmarkTest )
+{
+    JobSystemTestScope scope;
+    VoxelMemoryPager pager;
+    VoxelWorldTestWorld world( &pager );
+
+    world.updateStreaming( Point3F( 0.0f, 0.0f, 0.0f ), 100.0f, 200.0f );
+    U32 startTime = Platform::getRealMilliseconds();
+    world.fillSphere( VOXELWORLD_UNITTEST_RADIUS, 1 );
+    world.meshAll();
+    const U32 initialTime = Platform::getRealMilliseconds() - startTime;
+    const U32 chunkCount = world.getChunkCount();
+
+    // Worst case edits, on the corner of eight chunks so four are meshed
+    // again each time.
+    U32 meshed = 0;
+    startTime = Platform::getRealMilliseconds();
+    for ( U32 i = 0; i < VOXELWORLD_UNITTEST_EDITS; ++i )
+    {
+        world.mMeshed.clear();
+        world.setVoxel( 0, 0, 0, (U8)(i & 1) );
+        world.updateMeshes( Point3F( 0.0f, 0.0f, 0.0f ), 1000.0f, U32_MAX );
+        world.waitForMeshes();
+        meshed += world.mMeshed.size();
+    }
+    const U32 editTime = Platform::getRealMilliseconds() - startTime;
+
+    EXPECT_EQ( meshed, VOXELWORLD_UNITTEST_EDITS * 4 );
+
+    Con::printf( "VoxelWorld: %d chunks streamed in and meshed in %dms. %d edits to mesh in %dms, %.2fms each (%d chunks re-meshed), %d workers.",
+        chunkCount, initialTime, VOXELWORLD_UNITTEST_EDITS, editTime, (F32)editTime / VOXELWORLD_UNITTEST_EDITS,
+        meshed, JobSystem::getWorkerCount() );
+}
+
+#endif // TORQUE_SHIPPING
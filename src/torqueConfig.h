@@ -50,6 +50,7 @@
 #define PROFILE_START(name) TORQUE_UNUSED(#name)
 #define PROFILE_END()
 #define PROFILE_SCOPE(name) TORQUE_UNUSED(#name)
+#define PROFILE_COUNT(counter, amount)
 
 //-----------------------------------------------------------------------------
 